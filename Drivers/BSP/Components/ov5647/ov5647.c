@@ -19,56 +19,332 @@
 
 #define ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
 
-/* 25 MHz XCLK (module on-board XO) — used only for reference notes.
-   In this driver we reconstruct pclk from (HTS*VTS*fps_nominal) after loading a mode. */
+/* 25 MHz XCLK (module on-board XO). With PLL 0x3034/0x3035/0x3036 = 0x1A/0x21/0x62
+   the sensor pixel clock is 81.6667 MHz; all modes below share that PLL setting so
+   that the MIPI lane rate (and the DCMIPP CSI PHY setting) stays the same. */
 #define OV5647_XCLK_HZ   (25000000UL)
+#define OV5647_PCLK_HZ   (81666700UL)
 
 /* ---- Small helper struct for register tables ---- */
 struct regval { uint16_t addr; uint8_t val; };
 
+/* ---- Mode descriptors ----
+   Registers that differ from one sensor mode to another, in write order. Each
+   mode gives one value per address so a mode switch only writes the deltas.
+   0x3820/0x3821 hold the binning bits only; the flip bits [2:1] of 0x3820 and
+   the mirror bits [2:1] of 0x3821 are merged in from the current
+   MirrorFlipConfig() setting. */
+#define OV5647_MODE_NB_REGS   37U
+#define OV5647_MODE_IDX_TC20  27U   /* index of 0x3820 in ov5647_mode_addr[] */
+#define OV5647_MODE_IDX_TC21  28U   /* index of 0x3821 in ov5647_mode_addr[] */
+#define OV5647_TC_MIRROR_FLIP_MASK  0x06U
+
+static const uint16_t ov5647_mode_addr[OV5647_MODE_NB_REGS] =
+{
+  0x3034, 0x3035, 0x3036,                          /* PLL                 */
+  0x3612, 0x3618, 0x3708, 0x3709,                  /* analog / binning    */
+  0x3800, 0x3801, 0x3802, 0x3803,                  /* X/Y start           */
+  0x3804, 0x3805, 0x3806, 0x3807,                  /* X/Y end             */
+  0x3808, 0x3809, 0x380A, 0x380B,                  /* X/Y output size     */
+  0x380C, 0x380D, 0x380E, 0x380F,                  /* HTS / VTS           */
+  0x3811, 0x3813, 0x3814, 0x3815,                  /* offsets / subsample */
+  0x3820, 0x3821,                                  /* binning             */
+  0x3A08, 0x3A09, 0x3A0A, 0x3A0B, 0x3A0D, 0x3A0E,  /* 50/60 Hz band steps */
+  0x4004,                                          /* BLC lines           */
+  0x4837,                                          /* MIPI pclk period    */
+};
+
+typedef struct
+{
+  uint32_t Resolution;              /* OV5647_Rxxx identifier                   */
+  uint16_t Width;
+  uint16_t Height;
+  uint16_t Hts;                     /* line length, same as 0x380C/0x380D below */
+  uint16_t Vts;                     /* shortest frame length (0x380E/0x380F)    */
+  uint32_t Pclk;                    /* pixel clock in Hz                        */
+  uint32_t MaxFps;                  /* Pclk / (Hts * Vts)                       */
+  uint8_t  Val[OV5647_MODE_NB_REGS];
+} ov5647_mode_t;
+
+static const ov5647_mode_t ov5647_modes[] =
+{
+  /* 2592x1944 full array, ~14.6 fps */
+  {
+    OV5647_R2592_1944, 2592, 1944, 2844, 1968, OV5647_PCLK_HZ, 14,
+    {
+      0x1A, 0x21, 0x62,
+      0x5B, 0x04, 0x64, 0x12,
+      0x00, 0x00, 0x00, 0x00,
+      0x0A, 0x3F, 0x07, 0xA3,
+      0x0A, 0x20, 0x07, 0x98,
+      0x0B, 0x1C, 0x07, 0xB0,
+      0x10, 0x06, 0x11, 0x11,
+      0x00, 0x00,
+      0x01, 0x28, 0x00, 0xF6, 0x08, 0x06,
+      0x04,
+      0x19,
+    }
+  },
+  /* 1920x1080 center crop, ~30.6 fps */
+  {
+    OV5647_R1920_1080, 1920, 1080, 2416, 1104, OV5647_PCLK_HZ, 30,
+    {
+      0x1A, 0x21, 0x62,
+      0x5B, 0x04, 0x64, 0x12,
+      0x01, 0x5C, 0x01, 0xB2,
+      0x08, 0xE3, 0x05, 0xF1,
+      0x07, 0x80, 0x04, 0x38,
+      0x09, 0x70, 0x04, 0x50,
+      0x04, 0x02, 0x11, 0x11,
+      0x40, 0x00,
+      0x01, 0x4B, 0x01, 0x13, 0x04, 0x03,
+      0x04,
+      0x19,
+    }
+  },
+  /* 1296x972 2x2 binned full field of view, ~43.8 fps */
+  {
+    OV5647_R1296_972, 1296, 972, 1896, 984, OV5647_PCLK_HZ, 43,
+    {
+      0x1A, 0x21, 0x62,
+      0x59, 0x00, 0x64, 0x52,
+      0x00, 0x00, 0x00, 0x00,
+      0x0A, 0x3F, 0x07, 0xA3,
+      0x05, 0x10, 0x03, 0xCC,
+      0x07, 0x68, 0x03, 0xD8,
+      0x0C, 0x06, 0x31, 0x31,
+      0x41, 0x01,
+      0x01, 0x28, 0x00, 0xF6, 0x08, 0x06,
+      0x04,
+      0x16,
+    }
+  },
+  /* 640x480 4x4 binned/skipped full field of view, ~90 fps */
+  {
+    OV5647_R640_480, 640, 480, 1852, 489, OV5647_PCLK_HZ, 90,
+    {
+      0x1A, 0x21, 0x62,
+      0x59, 0x00, 0x64, 0x52,
+      0x00, 0x10, 0x00, 0x00,
+      0x0A, 0x2F, 0x07, 0x9F,
+      0x02, 0x80, 0x01, 0xE0,
+      0x07, 0x3C, 0x01, 0xE9,
+      0x10, 0x06, 0x35, 0x35,
+      0x41, 0x01,
+      0x01, 0x2E, 0x00, 0xFB, 0x02, 0x01,
+      0x02,
+      0x19,
+    }
+  },
+};
+
 /* ---- Timing cache (current mode) ----
-   We keep HTS/VTS and nominal fps to reconstruct pclk = HTS * VTS * fps.
-   This provides a coherent base for exposure/fps calculations without reprogramming PLL. */
+   HTS/VTS and pclk of the loaded mode, used by the exposure and frame rate math. */
+static const ov5647_mode_t *s_mode = NULL;
 static uint16_t s_hts = 0;      /* LINE_LEN_PCK (0x380C/0x380D) */
 static uint16_t s_vts = 0;      /* FRAME_LEN_LINES (0x380E/0x380F) */
-static uint32_t s_pclk = 0;     /* pixel clock (Hz). s_pclk = s_hts * s_vts * s_fps */
-static int32_t  s_fps  = 30;    /* nominal fps of current mode */
+static uint32_t s_pclk = 0;     /* pixel clock (Hz) */
+static int32_t  s_fps  = 30;    /* current fps = s_pclk / (s_hts * s_vts) */
+static uint8_t  s_tc20_flip   = OV5647_TC_MIRROR_FLIP_MASK; /* 0x3820 bits [2:1], V flip   */
+static uint8_t  s_tc21_mirror = OV5647_TC_MIRROR_FLIP_MASK; /* 0x3821 bits [2:1], H mirror */
+static int32_t  s_exposure_us = 0;  /* last requested exposure, re-applied on timing change */
+
+/* ---- Exposure / gain cache ----
+   Register values last programmed (or queued by the application), read back
+   by the getters. Reset values are the ones of ov5647_common_regs[]. */
+#define OV5647_EXPOSURE_INIT_LINES  0x400U   /* 0x3500..0x3502 = 0x00/0x40/0x00 */
+static uint32_t s_exposure_lines = OV5647_EXPOSURE_INIT_LINES;
+static uint16_t s_gain_code = OV5647_GAIN_CODE_UNITY;
+
+/* ---- Gain model ----
+   The gain code is linear in gain, the ISP works in dB. ov5647_gain_q16[n] is
+   the linear gain of n dB (10^(n/20)) in Q16, from 0 up to OV5647_GAIN_MAX_MDB.
+   Between two entries the gain is interpolated linearly, within 0.2% of the
+   exact curve over a 1 dB step, far below one code step (0.5% at 36 dB). */
+#define OV5647_GAIN_LUT_STEP_MDB  1000U
+#define OV5647_GAIN_LUT_SIZE      ((OV5647_GAIN_MAX_MDB / OV5647_GAIN_LUT_STEP_MDB) + 1U)
+
+static const uint32_t ov5647_gain_q16[OV5647_GAIN_LUT_SIZE] =
+{
+     65536,   73533,   82505,   92572,  103868,  116541,  130762,  146717,
+    164619,  184706,  207243,  232531,  260904,  292739,  328458,  368536,
+    413504,  463959,  520571,  584090,  655360,  735326,  825049,  925721,
+   1038676, 1165413, 1307615, 1467168, 1646190, 1847055, 2072430, 2325305,
+   2609035, 2927386, 3284581, 3685360, 4135042,
+};
+
+/* Longest run of consecutive registers sent in one I2C transaction.
+   The sensor auto-increments the register address during a write. */
+#define OV5647_BURST_MAX_LEN    32U
+#define OV5647_RESET_DELAY_MS   5
 
 /* ---- Private helpers ---- */
+static void OV5647_Delay(OV5647_Object_t *pObj, uint32_t Delay)
+{
+  uint32_t tickstart = (uint32_t)pObj->IO.GetTick();
+  while (((uint32_t)pObj->IO.GetTick() - tickstart) < Delay)
+  {
+  }
+}
+
+/* Registers that must be written in their own transaction */
+static int ov5647_is_standalone(uint16_t addr)
+{
+  return (addr == OV5647_REG_MODE_SELECT) || (addr == OV5647_REG_SW_RESET);
+}
+
+/* Write a register table, coalescing runs of consecutive addresses (in table
+   order) into burst writes: the 92 registers of the 1080p init (common and
+   mode registers) go out in 52 transactions. */
 static int32_t OV5647_WriteTable(OV5647_Object_t *pObj, const struct regval *regs, uint32_t size)
 {
-  for (uint32_t i = 0; i < size; ++i)
+  uint8_t  burst[OV5647_BURST_MAX_LEN];
+  uint32_t i = 0;
+
+  while (i < size)
   {
-    if (ov5647_write_reg(&pObj->Ctx, regs[i].addr, (uint8_t*)&regs[i].val, 1) != 0)
+    uint16_t start = regs[i].addr;
+    uint16_t len   = 0;
+
+    do
+    {
+      burst[len++] = regs[i++].val;
+    } while ((i < size) && (len < OV5647_BURST_MAX_LEN) &&
+             !ov5647_is_standalone(start) && !ov5647_is_standalone(regs[i].addr) &&
+             (regs[i].addr == (uint16_t)(start + len)));
+
+    if (ov5647_write_reg(&pObj->Ctx, start, burst, len) != 0)
       return OV5647_ERROR;
+
+    /* Let the sensor come out of software reset before the next access */
+    if (start == OV5647_REG_SW_RESET)
+      OV5647_Delay(pObj, OV5647_RESET_DELAY_MS);
   }
   return OV5647_OK;
 }
 
-static void ov5647_update_timing_cache(OV5647_Object_t *pObj, int32_t fps_nominal)
+/* Gain in mdB to the nearest gain code */
+static uint16_t ov5647_gain_mdb_to_code(int32_t gain_mdb)
 {
+  if (gain_mdb < OV5647_GAIN_MIN_MDB) gain_mdb = OV5647_GAIN_MIN_MDB;
+  if (gain_mdb > OV5647_GAIN_MAX_MDB) gain_mdb = OV5647_GAIN_MAX_MDB;
 
+  uint32_t idx  = (uint32_t)gain_mdb / OV5647_GAIN_LUT_STEP_MDB;
+  uint32_t frac = (uint32_t)gain_mdb % OV5647_GAIN_LUT_STEP_MDB;
+  uint32_t gain = ov5647_gain_q16[idx];
+  if (frac != 0U)
+    gain += ((ov5647_gain_q16[idx + 1U] - gain) * frac) / OV5647_GAIN_LUT_STEP_MDB;
+
+  /* code = gain * 16, rounded */
+  uint32_t code = (gain * OV5647_GAIN_CODE_UNITY + 0x8000U) >> 16;
+  if (code < OV5647_GAIN_CODE_UNITY) code = OV5647_GAIN_CODE_UNITY;
+  if (code > OV5647_GAIN_CODE_MAX)   code = OV5647_GAIN_CODE_MAX;
+  return (uint16_t)code;
 }
 
-static const struct regval ov5647_1920x1080_regs[] =
+/* Gain code back to mdB, inverse of ov5647_gain_mdb_to_code() */
+static int32_t ov5647_gain_code_to_mdb(uint16_t code)
+{
+  uint32_t gain = ((uint32_t)code << 16) / OV5647_GAIN_CODE_UNITY;
+  uint32_t idx  = 0;
+
+  if (gain <= ov5647_gain_q16[0])                        return OV5647_GAIN_MIN_MDB;
+  if (gain >= ov5647_gain_q16[OV5647_GAIN_LUT_SIZE - 1U]) return OV5647_GAIN_MAX_MDB;
+
+  while (gain >= ov5647_gain_q16[idx + 1U])
+    idx++;
+
+  uint32_t lo = ov5647_gain_q16[idx];
+  uint32_t hi = ov5647_gain_q16[idx + 1U];
+  return (int32_t)((idx * OV5647_GAIN_LUT_STEP_MDB) +
+                   (((gain - lo) * OV5647_GAIN_LUT_STEP_MDB) + ((hi - lo) / 2U)) / (hi - lo));
+}
+
+/* Exposure time to lines of the current timing, one line lasting HTS pixel clocks */
+static uint32_t ov5647_exposure_us_to_lines(int32_t exposure_us)
+{
+  uint64_t num   = (uint64_t)exposure_us * (uint64_t)s_pclk;
+  uint64_t denom = (uint64_t)s_hts * 1000000ULL;
+  uint32_t lines = (uint32_t)((num + (denom / 2ULL)) / denom);
+
+  if (lines == 0) lines = 1;
+  if ((s_vts != 0) && (lines > (uint32_t)(s_vts - OV5647_EXPOSURE_MARGIN_LINES)))
+    lines = (uint32_t)(s_vts - OV5647_EXPOSURE_MARGIN_LINES);
+  return lines;
+}
+
+/* Exposure lines back to microseconds */
+static int32_t ov5647_lines_to_exposure_us(uint32_t lines)
+{
+  uint64_t num = (uint64_t)lines * s_hts * 1000000ULL;
+  return (int32_t)((num + (s_pclk / 2U)) / s_pclk);
+}
+
+static void ov5647_update_timing_cache(const ov5647_mode_t *mode)
+{
+  s_mode = mode;
+  s_hts  = mode->Hts;
+  s_vts  = mode->Vts;
+  s_pclk = mode->Pclk;
+  s_fps  = (int32_t)(s_pclk / ((uint32_t)s_hts * s_vts));
+}
+
+static const ov5647_mode_t *ov5647_find_mode(uint32_t Resolution)
+{
+  for (uint32_t i = 0; i < ARRAY_SIZE(ov5647_modes); ++i)
+  {
+    if (ov5647_modes[i].Resolution == Resolution)
+      return &ov5647_modes[i];
+  }
+  return NULL;
+}
+
+/* Value of a mode register, with the current mirror/flip bits merged in */
+static uint8_t ov5647_mode_val(const ov5647_mode_t *mode, uint32_t i)
+{
+  uint8_t val = mode->Val[i];
+  if (ov5647_mode_addr[i] == OV5647_REG_TC_REG20)
+    val = (uint8_t)((val & ~OV5647_TC_MIRROR_FLIP_MASK) | s_tc20_flip);
+  else if (ov5647_mode_addr[i] == OV5647_REG_TC_REG21)
+    val = (uint8_t)((val & ~OV5647_TC_MIRROR_FLIP_MASK) | s_tc21_mirror);
+  return val;
+}
+
+/* Write the registers of 'mode' that differ from 'from' (all of them when from is NULL) */
+static int32_t ov5647_load_mode(OV5647_Object_t *pObj, const ov5647_mode_t *from, const ov5647_mode_t *mode)
+{
+  struct regval delta[OV5647_MODE_NB_REGS];
+  uint32_t n = 0;
+
+  for (uint32_t i = 0; i < OV5647_MODE_NB_REGS; ++i)
+  {
+    if ((from == NULL) || (from->Val[i] != mode->Val[i]))
+    {
+      delta[n].addr = ov5647_mode_addr[i];
+      delta[n].val  = ov5647_mode_val(mode, i);
+      n++;
+    }
+  }
+
+  if (OV5647_WriteTable(pObj, delta, n) != OV5647_OK)
+    return OV5647_ERROR;
+
+  ov5647_update_timing_cache(mode);
+  return OV5647_OK;
+}
+
+/* Registers common to all modes, written once at init before the mode registers */
+static const struct regval ov5647_common_regs[] =
 {
 
     {0x0100, 0x00},  /* Stream Off */
     {0x0103, 0x01},  /* SW reset  */
 
-    {0x3034, 0x1A},  /* RAW10 */
-    {0x3035, 0x21},  /* PLL: sys divider  */
-    {0x3036, 0x62},  /* PLL multiplier */
     {0x303C, 0x11},
     {0x3106, 0xF5},
 
-    {0x3820, 0x46},
-    {0x3821, 0x06},
-
     {0x3827, 0xEC},
     {0x370C, 0x03},
-    {0x3612, 0x5B},
-    {0x3618, 0x04},
 
     {0x5000, 0x06},
     {0x5002, 0x41},
@@ -90,26 +366,6 @@ static const struct regval ov5647_1920x1080_regs[] =
     {0x3C01, 0x80},
     {0x3B07, 0x0C},
 
-    {0x380C, 0x09}, {0x380D, 0x70},  /* HTS = 0x0970 = 2416 */
-    {0x380E, 0x04}, {0x380F, 0x50},  /* VTS = 0x0450 = 1104 */
-
-    {0x3814, 0x11},
-    {0x3815, 0x11},
-
-    {0x3708, 0x64},
-    {0x3709, 0x12},
-
-    {0x3808, 0x07}, {0x3809, 0x80},  /* X_OUT = 1920 */
-    {0x380A, 0x04}, {0x380B, 0x38},  /* Y_OUT = 1080 */
-
-    {0x3800, 0x01}, {0x3801, 0x5C},  /* X start */
-    {0x3802, 0x01}, {0x3803, 0xB2},  /* Y start */
-    {0x3804, 0x08}, {0x3805, 0xE3},  /* X end */
-    {0x3806, 0x05}, {0x3807, 0xF1},  /* Y end */
-
-    {0x3811, 0x04},
-    {0x3813, 0x02},
-
     {0x3630, 0x2E},
     {0x3632, 0xE2},
     {0x3633, 0x23},
@@ -129,12 +385,6 @@ static const struct regval ov5647_1920x1080_regs[] =
     {0x3F06, 0x10},
     {0x3F01, 0x0A},
 
-    {0x3A08, 0x01},
-    {0x3A09, 0x4B},
-    {0x3A0A, 0x01},
-    {0x3A0B, 0x13},
-    {0x3A0D, 0x04},
-    {0x3A0E, 0x03},
     {0x3A0F, 0x58},
     {0x3A10, 0x50},
     {0x3A1B, 0x58},
@@ -143,10 +393,8 @@ static const struct regval ov5647_1920x1080_regs[] =
     {0x3A1F, 0x28},
 
     {0x4001, 0x02},
-    {0x4004, 0x04},
     {0x4000, 0x09},
 
-    {0x4837, 0x19},
     {0x4800, 0x34},
 
     {0x3503, 0x00},
@@ -181,8 +429,8 @@ OV5647_CAMERA_Drv_t OV5647_CAMERA_Driver =
   .SetHueDegree    = NULL,
   .MirrorFlipConfig= OV5647_MirrorFlipConfig,
   .ZoomConfig      = NULL,
-  .SetResolution   = NULL,
-  .GetResolution   = NULL,
+  .SetResolution   = OV5647_SetResolution,
+  .GetResolution   = OV5647_GetResolution,
   .SetPixelFormat  = NULL,
   .GetPixelFormat  = NULL,
   .NightModeConfig = NULL,
@@ -227,7 +475,6 @@ int32_t OV5647_RegisterBusIO(OV5647_Object_t *pObj, OV5647_IO_t *pIO)
 
 #define OV5647_VERIFY_RETRIES   3
 #define OV5647_VERIFY_DELAY_MS  20
-#define OV5647_RESET_DELAY_MS   5
 
 
 static const uint16_t ov5647_verify_skip[] = {
@@ -300,32 +547,23 @@ int32_t OV5647_Init(OV5647_Object_t *pObj, uint32_t Resolution, uint32_t PixelFo
   if (ov5647_read_reg(&pObj->Ctx, OV5647_REG_CHIP_ID_LOW,  &idl, 1) != 0) return OV5647_ERROR;
   if (idh != 0x56 || idl != 0x47) return OV5647_ERROR;
 
-  /* Load mode (tables already include Stream On at the end) */
-  switch (Resolution)
-  {
-
-    case OV5647_R1920_1080:
+  const ov5647_mode_t *mode = ov5647_find_mode(Resolution);
+  if (mode == NULL) return OV5647_ERROR;
 
+  /* Common registers, then the full register set of the requested mode */
 #if 1
-        if (OV5647_WriteTable(pObj, ov5647_1920x1080_regs, ARRAY_SIZE(ov5647_1920x1080_regs)) != OV5647_OK)
-          return OV5647_ERROR;
+  if (OV5647_WriteTable(pObj, ov5647_common_regs, ARRAY_SIZE(ov5647_common_regs)) != OV5647_OK)
+    return OV5647_ERROR;
 #else
-    	if (OV5647_WriteTable_Verify(pObj,
-    	      ov5647_1920x1080_regs,
-    	      ARRAY_SIZE(ov5647_1920x1080_regs)) != OV5647_OK)
-    	{
-    	  return OV5647_ERROR;
-    	}
-
-    	//while(1);
+  if (OV5647_WriteTable_Verify(pObj, ov5647_common_regs, ARRAY_SIZE(ov5647_common_regs)) != OV5647_OK)
+    return OV5647_ERROR;
 #endif
-      break;
-
-    default:
-      return OV5647_ERROR;
-  }
+  if (ov5647_load_mode(pObj, NULL, mode) != OV5647_OK)
+    return OV5647_ERROR;
+  s_exposure_lines = OV5647_EXPOSURE_INIT_LINES;
+  s_gain_code      = OV5647_GAIN_CODE_UNITY;
 
-  /* Do NOT re-write Mode Select here (tables already turned streaming ON) */
+  /* Streaming is left off: the application starts it once the receiver is ready */
 
   pObj->IsInitialized = 1U;
   return OV5647_OK;
@@ -384,71 +622,202 @@ int32_t OV5647_GetSensorInfo(OV5647_Object_t *pObj, OV5647_SensorInfo_t *Info)
   strcpy(Info->name, name);
   Info->bayer_pattern = OV5647_BAYER_PATTERN;
   Info->color_depth   = OV5647_COLOR_DEPTH;
-  Info->width         = OV5647_WIDTH;
-  Info->height        = OV5647_HEIGHT;
+  Info->width         = (s_mode != NULL) ? s_mode->Width  : OV5647_WIDTH;
+  Info->height        = (s_mode != NULL) ? s_mode->Height : OV5647_HEIGHT;
   Info->gain_min      = OV5647_GAIN_MIN_MDB;
   Info->gain_max      = OV5647_GAIN_MAX_MDB;
   Info->exposure_min  = OV5647_EXPOSURE_MIN_US;
   Info->exposure_max  = OV5647_EXPOSURE_MAX_US;
+  if (s_pclk != 0)
+  {
+    /* Longest exposure that fits in the current frame */
+    Info->exposure_max = (uint32_t)ov5647_lines_to_exposure_us(s_vts - OV5647_EXPOSURE_MARGIN_LINES);
+  }
   return OV5647_OK;
 }
 
 /* ---- Controls ---- */
-int32_t OV5647_SetGain(OV5647_Object_t *pObj, int32_t gain_mdb)
+int32_t OV5647_GetGainRegs(OV5647_Object_t *pObj, int32_t gain_mdb, uint8_t *pRegs)
 {
-  /* Bring-up approximation: map 0..48 dB -> 0x10..0xF8 linearly. */
-  if (gain_mdb < OV5647_GAIN_MIN_MDB) gain_mdb = OV5647_GAIN_MIN_MDB;
-  if (gain_mdb > OV5647_GAIN_MAX_MDB) gain_mdb = OV5647_GAIN_MAX_MDB;
+  (void)pObj;
+  if (pRegs == NULL) return OV5647_ERROR;
+
+  uint16_t code = ov5647_gain_mdb_to_code(gain_mdb);
+  s_gain_code = code;
+
+  /* 0x350A/0x350B */
+  pRegs[0] = (code >> 8) & 0xFF;
+  pRegs[1] = code & 0xFF;
+  return OV5647_OK;
+}
 
-  uint16_t code = 0x10 + (uint16_t)(( (int64_t)gain_mdb * (int64_t)(0xF8 - 0x10) ) /
-                                    (int64_t)(OV5647_GAIN_MAX_MDB ? OV5647_GAIN_MAX_MDB : 1));
+int32_t OV5647_SetGain(OV5647_Object_t *pObj, int32_t gain_mdb)
+{
+  uint8_t g[OV5647_GAIN_NB_REGS];
 
-  uint8_t h = (code >> 8) & 0xFF;
-  uint8_t l = code & 0xFF;
+  if (OV5647_GetGainRegs(pObj, gain_mdb, g) != OV5647_OK) return OV5647_ERROR;
 
-  if (ov5647_write_reg(&pObj->Ctx, OV5647_REG_GAIN_H, &h, 1) != 0) return OV5647_ERROR;
-  if (ov5647_write_reg(&pObj->Ctx, OV5647_REG_GAIN_L, &l, 1) != 0) return OV5647_ERROR;
+  /* 0x350A/0x350B in a single burst */
+  if (ov5647_write_reg(&pObj->Ctx, OV5647_REG_GAIN_H, g, OV5647_GAIN_NB_REGS) != 0) return OV5647_ERROR;
   return OV5647_OK;
 }
 
-int32_t OV5647_SetExposure(OV5647_Object_t *pObj, int32_t exposure_us)
+int32_t OV5647_GetExposureRegs(OV5647_Object_t *pObj, int32_t exposure_us, uint8_t *pRegs)
 {
+  (void)pObj;
+  if (pRegs == NULL) return OV5647_ERROR;
   if (exposure_us < (int32_t)OV5647_EXPOSURE_MIN_US) exposure_us = OV5647_EXPOSURE_MIN_US;
 
-  /* Refresh timing cache if needed */
-  if (s_hts == 0 || s_vts == 0 || s_pclk == 0) ov5647_update_timing_cache(pObj, 30);
+  /* Timing cache is loaded with the mode */
+  if (s_mode == NULL) return OV5647_ERROR;
+  s_exposure_us = exposure_us;
 
-  /* lines = exposure_us * pclk / (HTS * 1e6) */
-  uint64_t num   = (uint64_t)exposure_us * (uint64_t)s_pclk;
-  uint64_t denom = (uint64_t)s_hts * 1000000ULL;
-  uint32_t lines = (uint32_t)((num + (denom/2ULL)) / denom);
-  if (lines == 0) lines = 1;
-
-  /* Ensure exposure lines fit into VTS with a margin */
-  const uint32_t margin = 8;
-  if (s_vts != 0 && lines > (uint32_t)(s_vts - margin))
-    lines = (uint32_t)(s_vts - margin);
+  /* Whole lines, fitting into VTS with a margin */
+  uint32_t lines = ov5647_exposure_us_to_lines(exposure_us);
+  s_exposure_lines = lines;
 
   /* OV5647 exposure format: [19:16]=H[3:0], [15:8]=M, [7:4]=L[7:4] (4 LSB are fractional) */
-  uint8_t h = (lines >> 12) & 0x0F;
-  uint8_t m = (lines >> 4)  & 0xFF;
-  uint8_t l = (lines << 4)  & 0xF0;
+  pRegs[0] = (lines >> 12) & 0x0F;
+  pRegs[1] = (lines >> 4)  & 0xFF;
+  pRegs[2] = (lines << 4)  & 0xF0;
+  return OV5647_OK;
+}
+
+int32_t OV5647_SetExposure(OV5647_Object_t *pObj, int32_t exposure_us)
+{
+  uint8_t e[OV5647_EXPOSURE_NB_REGS];
+
+  if (OV5647_GetExposureRegs(pObj, exposure_us, e) != OV5647_OK) return OV5647_ERROR;
 
-  if (ov5647_write_reg(&pObj->Ctx, OV5647_REG_EXPOSURE_H, &h, 1) != 0) return OV5647_ERROR;
-  if (ov5647_write_reg(&pObj->Ctx, OV5647_REG_EXPOSURE_M, &m, 1) != 0) return OV5647_ERROR;
-  if (ov5647_write_reg(&pObj->Ctx, OV5647_REG_EXPOSURE_L, &l, 1) != 0) return OV5647_ERROR;
+  /* 0x3500..0x3502 in a single burst */
+  if (ov5647_write_reg(&pObj->Ctx, OV5647_REG_EXPOSURE_H, e, OV5647_EXPOSURE_NB_REGS) != 0) return OV5647_ERROR;
 
   return OV5647_OK;
 }
 
+/* Gain applied by the sensor: the code last programmed, which is the requested
+   gain rounded to a code step */
+int32_t OV5647_GetGain(OV5647_Object_t *pObj, int32_t *gain_mdb)
+{
+  (void)pObj;
+  if (gain_mdb == NULL) return OV5647_ERROR;
+  *gain_mdb = ov5647_gain_code_to_mdb(s_gain_code);
+  return OV5647_OK;
+}
+
+/* Exposure applied by the sensor: the lines last programmed, in the current
+   line time */
+int32_t OV5647_GetExposure(OV5647_Object_t *pObj, int32_t *exposure_us)
+{
+  (void)pObj;
+  if ((exposure_us == NULL) || (s_mode == NULL)) return OV5647_ERROR;
+  *exposure_us = ov5647_lines_to_exposure_us(s_exposure_lines);
+  return OV5647_OK;
+}
+
 int32_t OV5647_SetFramerate(OV5647_Object_t *pObj, int32_t fps_target)
 {
+  if ((s_mode == NULL) || (fps_target <= 0)) return OV5647_ERROR;
+
+  /* Frame rate is set through VTS, the mode VTS being the shortest frame */
+  return OV5647_SetFrameLength(pObj, s_pclk / ((uint32_t)s_hts * (uint32_t)fps_target));
+}
+
+/* Frame length (VTS) registers, for a write queued by the application. The
+   timing cache is updated: the exposure computed afterwards is clamped against
+   the new frame length, so queue both in the same group hold. */
+int32_t OV5647_GetFrameLengthRegs(OV5647_Object_t *pObj, uint32_t vts, uint8_t *pRegs)
+{
+  (void)pObj;
+  if ((pRegs == NULL) || (s_mode == NULL)) return OV5647_ERROR;
+
+  /* The mode VTS is the shortest frame */
+  if (vts < s_mode->Vts) vts = s_mode->Vts;
+  if (vts > 0xFFFFU)     vts = 0xFFFFU;
+
+  s_vts = (uint16_t)vts;
+  s_fps = (int32_t)(s_pclk / ((uint32_t)s_hts * vts));
+
+  /* 0x380E/0x380F */
+  pRegs[0] = (vts >> 8) & 0xFF;
+  pRegs[1] = vts & 0xFF;
+  return OV5647_OK;
+}
+
+int32_t OV5647_SetFrameLength(OV5647_Object_t *pObj, uint32_t vts)
+{
+  uint8_t v[OV5647_VTS_NB_REGS];
+
+  if (OV5647_GetFrameLengthRegs(pObj, vts, v) != OV5647_OK) return OV5647_ERROR;
+  if (ov5647_write_reg(&pObj->Ctx, OV5647_REG_VTS_H, v, OV5647_VTS_NB_REGS) != 0) return OV5647_ERROR;
+
+  /* Exposure is clamped against VTS: re-apply it */
+  if (s_exposure_us != 0)
+    return OV5647_SetExposure(pObj, s_exposure_us);
+  return OV5647_OK;
+}
+
+/* Line time and frame length, to convert exposure times to lines */
+int32_t OV5647_GetFrameTiming(OV5647_Object_t *pObj, OV5647_FrameTiming_t *pTiming)
+{
+  (void)pObj;
+  if ((pTiming == NULL) || (s_mode == NULL)) return OV5647_ERROR;
 
+  pTiming->Hts    = s_hts;
+  pTiming->Vts    = s_vts;
+  pTiming->VtsMin = s_mode->Vts;
+  pTiming->Pclk   = s_pclk;
+  return OV5647_OK;
 }
 
 int32_t OV5647_MirrorFlipConfig(OV5647_Object_t *pObj, uint32_t Config)
 {
+  if ((s_mode == NULL) || ((Config & ~OV5647_MIRROR_FLIP) != 0U)) return OV5647_ERROR;
+
+  /* 0x3820 bits [2:1] flip vertically, 0x3821 bits [2:1] mirror horizontally,
+     kept for the mode registers written by a later SetResolution() */
+  s_tc20_flip   = ((Config & OV5647_FLIP) != 0U)   ? OV5647_TC_MIRROR_FLIP_MASK : 0x00U;
+  s_tc21_mirror = ((Config & OV5647_MIRROR) != 0U) ? OV5647_TC_MIRROR_FLIP_MASK : 0x00U;
+
+  uint8_t tc[2];
+  tc[0] = ov5647_mode_val(s_mode, OV5647_MODE_IDX_TC20);
+  tc[1] = ov5647_mode_val(s_mode, OV5647_MODE_IDX_TC21);
+
+  if (ov5647_write_reg(&pObj->Ctx, OV5647_REG_TC_REG20, tc, 2) != 0) return OV5647_ERROR;
+  return OV5647_OK;
+}
+
+/* Switch to another sensor mode while streaming. Reached through
+   BSP_CAMERA_SetResolution(); the application keeps the 1080p mode its DCMIPP
+   pipes are configured for and does not call it. */
+int32_t OV5647_SetResolution(OV5647_Object_t *pObj, uint32_t Resolution)
+{
+  const ov5647_mode_t *mode = ov5647_find_mode(Resolution);
+  uint8_t streaming = 0;
+  uint8_t standby = OV5647_MODE_STANDBY;
+
+  if ((mode == NULL) || (s_mode == NULL)) return OV5647_ERROR;
+  if (mode == s_mode) return OV5647_OK;
 
+  /* Stop streaming while the timing registers change, restore it afterwards */
+  if (ov5647_read_reg(&pObj->Ctx, OV5647_REG_MODE_SELECT, &streaming, 1) != 0) return OV5647_ERROR;
+  if (ov5647_write_reg(&pObj->Ctx, OV5647_REG_MODE_SELECT, &standby, 1) != 0) return OV5647_ERROR;
+
+  if (ov5647_load_mode(pObj, s_mode, mode) != OV5647_OK) return OV5647_ERROR;
+
+  /* Same exposure time in the new line timing */
+  if ((s_exposure_us != 0) && (OV5647_SetExposure(pObj, s_exposure_us) != OV5647_OK)) return OV5647_ERROR;
+
+  if (ov5647_write_reg(&pObj->Ctx, OV5647_REG_MODE_SELECT, &streaming, 1) != 0) return OV5647_ERROR;
+  return OV5647_OK;
+}
+
+int32_t OV5647_GetResolution(OV5647_Object_t *pObj, uint32_t *Resolution)
+{
+  (void)pObj;
+  if ((Resolution == NULL) || (s_mode == NULL)) return OV5647_ERROR;
+  *Resolution = s_mode->Resolution;
+  return OV5647_OK;
 }
 
 int32_t OV5647_SetTestPattern(OV5647_Object_t *pObj, int32_t mode)
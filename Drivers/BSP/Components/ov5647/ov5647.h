@@ -56,6 +56,15 @@ typedef struct
   uint32_t exposure_max;
 } OV5647_SensorInfo_t;
 
+/* Line and frame timing of the current mode */
+typedef struct
+{
+  uint32_t Hts;      /* Pixel clocks per line (0x380C/0x380D)         */
+  uint32_t Vts;      /* Lines per frame (0x380E/0x380F)               */
+  uint32_t VtsMin;   /* Lines per frame of the mode, at its full rate */
+  uint32_t Pclk;     /* Pixel clock (Hz)                              */
+} OV5647_FrameTiming_t;
+
 typedef struct
 {
   uint32_t Config_Resolution;
@@ -81,8 +90,10 @@ typedef struct
 #define OV5647_ERROR  (-1)
 
 /* Camera features (align naming with IMX335 headers so higher layers plug-in) */
-#define OV5647_R1920_1080          7U      /* 1920x1080 */
-#define OV5647_R2592_1944          6U      /* 2592x1944 */
+#define OV5647_R2592_1944          6U      /* 2592x1944 full array   */
+#define OV5647_R1920_1080          7U      /* 1920x1080 center crop  */
+#define OV5647_R1296_972           8U      /* 1296x972 2x2 binned    */
+#define OV5647_R640_480            9U      /* 640x480 up to 90 fps   */
 #define OV5647_RAW_RGGB10          10U     /* RAW10 */
 
 /* Mirror/Flip config (reusing same mask values as IMX335 for drop-in) */
@@ -127,8 +138,17 @@ int32_t OV5647_ReadID(OV5647_Object_t *pObj, uint32_t *Id);
 int32_t OV5647_GetCapabilities(OV5647_Object_t *pObj, OV5647_Capabilities_t *Capabilities);
 int32_t OV5647_SetGain(OV5647_Object_t *pObj, int32_t gain_mdb);
 int32_t OV5647_SetExposure(OV5647_Object_t *pObj, int32_t exposure_us);
+int32_t OV5647_GetGainRegs(OV5647_Object_t *pObj, int32_t gain_mdb, uint8_t *pRegs);
+int32_t OV5647_GetExposureRegs(OV5647_Object_t *pObj, int32_t exposure_us, uint8_t *pRegs);
+int32_t OV5647_GetGain(OV5647_Object_t *pObj, int32_t *gain_mdb);
+int32_t OV5647_GetExposure(OV5647_Object_t *pObj, int32_t *exposure_us);
 int32_t OV5647_SetFramerate(OV5647_Object_t *pObj, int32_t fps);
+int32_t OV5647_SetFrameLength(OV5647_Object_t *pObj, uint32_t vts);
+int32_t OV5647_GetFrameLengthRegs(OV5647_Object_t *pObj, uint32_t vts, uint8_t *pRegs);
+int32_t OV5647_GetFrameTiming(OV5647_Object_t *pObj, OV5647_FrameTiming_t *pTiming);
 int32_t OV5647_MirrorFlipConfig(OV5647_Object_t *pObj, uint32_t Config);
+int32_t OV5647_SetResolution(OV5647_Object_t *pObj, uint32_t Resolution);
+int32_t OV5647_GetResolution(OV5647_Object_t *pObj, uint32_t *Resolution);
 int32_t OV5647_GetSensorInfo(OV5647_Object_t *pObj, OV5647_SensorInfo_t *Info);
 int32_t OV5647_SetTestPattern(OV5647_Object_t *pObj, int32_t mode);
 
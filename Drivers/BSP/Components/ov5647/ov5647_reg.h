@@ -80,6 +80,15 @@ typedef struct
 #define OV5647_REG_EXPOSURE_L         0x3502  /* [7:4] fractional */
 #define OV5647_REG_GAIN_H             0x350A
 #define OV5647_REG_GAIN_L             0x350B
+#define OV5647_EXPOSURE_NB_REGS       3       /* 0x3500..0x3502 */
+#define OV5647_GAIN_NB_REGS           2       /* 0x350A..0x350B */
+#define OV5647_VTS_NB_REGS            2       /* 0x380E..0x380F */
+
+/* Group hold: registers written between start and end are latched together */
+#define OV5647_REG_GROUP_ACCESS       0x3208
+#define OV5647_GROUP_HOLD_START       0x00    /* Start recording group 0 */
+#define OV5647_GROUP_HOLD_END         0x10    /* End recording group 0   */
+#define OV5647_GROUP_LAUNCH           0xA0    /* Quick launch of group 0 */
 
 /* Test pattern */
 #define OV5647_REG_TEST_PATTERN       0x503D
@@ -90,12 +99,7 @@ typedef struct
 #define OV5647_MIPI_IDLE_LP11         (1u<<2)
 #define OV5647_MIPI_CLK_GATE          (1u<<5)
 #define REG_TEST_PATTERN           0x503D  /* 0x80=enable color bar */
-/* Resolutions */
-#define OV5647_R2592_1944             (0u)
-#define OV5647_R1920_1080             (1u)
-
-/* PixelFormat (RAW10 RGGB) — 값만 전달용 */
-#define OV5647_RAW_RGGB10             (0u)
+/* Resolutions and pixel formats are defined in ov5647.h */
 
 /* Info/Cap 구조체는 기존 IMX335과 동일하게 매핑해서 사용 */
 #define OV5647_NAME            "OV5647"
@@ -104,10 +108,16 @@ typedef struct
 #define OV5647_WIDTH           1920
 #define OV5647_HEIGHT          1080
 #define OV5647_GAIN_MIN_MDB    0
-#define OV5647_GAIN_MAX_MDB    4800
+#define OV5647_GAIN_MAX_MDB    36000   /* code 0x3F2, 63.1x */
 #define OV5647_EXPOSURE_MIN_US 50
 #define OV5647_EXPOSURE_MAX_US 1000000
 
+/* Analog gain code 0x350A[1:0]/0x350B is linear in gain: gain = code / 16 */
+#define OV5647_GAIN_CODE_UNITY 0x10
+#define OV5647_GAIN_CODE_MAX   0x3FF
+/* Exposure lines kept free at the end of the frame (VTS) */
+#define OV5647_EXPOSURE_MARGIN_LINES 8
+
 /* Low-level API */
 int32_t ov5647_write_reg(ov5647_ctx_t *ctx, uint16_t reg, uint8_t *pdata, uint16_t length);
 int32_t ov5647_read_reg (ov5647_ctx_t *ctx, uint16_t reg, uint8_t *pdata, uint16_t length);
@@ -82,6 +82,13 @@ typedef struct
   uint32_t sclh;       /* SCL high period */
   uint32_t scll;       /* SCL low period */
 } I2C_Timings_t;
+
+typedef struct
+{
+  uint32_t clock_src_freq; /* I2C kernel clock in Hz */
+  uint32_t i2c_freq;       /* I2C clock in Hz */
+  uint32_t timing;         /* TIMINGR value */
+} I2C_TimingEntry_t;
 /**
   * @}
   */
@@ -134,6 +141,19 @@ static const I2C_Charac_t I2C_Charac[] =
     .dnf = I2C_DIGITAL_FILTER_COEF,
   },
 };
+
+/* TIMINGR values of I2C_Compute_PRESC_SCLDEL_SDADEL() and I2C_Compute_SCLL_SCLH()
+   for the usual kernel clocks (HSI after reset, PCLK1 at 200 MHz), with the
+   analog filter on and I2C_DIGITAL_FILTER_COEF = 0. Other pairs are computed. */
+static const I2C_TimingEntry_t I2C_Timing_Table[] =
+{
+  {  64000000U,  100000U, 0x60702729U },
+  {  64000000U,  400000U, 0x10A11626U },
+  {  64000000U, 1000000U, 0x00610E1AU },
+  { 200000000U,  100000U, 0xE0B03C3DU },
+  { 200000000U,  400000U, 0x60911523U },
+  { 200000000U, 1000000U, 0x10A41A2CU },
+};
 /**
   * @}
   */
@@ -302,6 +322,17 @@ __weak HAL_StatusTypeDef MX_I2C1_Init(I2C_HandleTypeDef *hI2c, uint32_t timing)
       {
         status = HAL_ERROR;
       }
+#if (BUS_I2C1_FREQUENCY > 400000U)
+      /* Fast-mode Plus: 20 mA drive on SCL and SDA */
+      else if (HAL_I2CEx_ConfigFastModePlus(hI2c, I2C_FASTMODEPLUS_ENABLE) != HAL_OK)
+      {
+        status = HAL_ERROR;
+      }
+#endif /* BUS_I2C1_FREQUENCY > 400000U */
+      else
+      {
+        /* Nothing to do */
+      }
     }
   }
 
@@ -1053,8 +1084,23 @@ static uint32_t I2C_GetTiming(uint32_t clock_src_freq, uint32_t i2c_freq)
   uint32_t speed;
   uint32_t idx;
 
-  if ((clock_src_freq != 0U) && (i2c_freq != 0U))
+#if (I2C_DIGITAL_FILTER_COEF == 0U)
+  for (idx = 0; (idx < (sizeof(I2C_Timing_Table) / sizeof(I2C_Timing_Table[0]))) && (ret == 0U); idx++)
+  {
+    if ((I2C_Timing_Table[idx].clock_src_freq == clock_src_freq) &&
+        (I2C_Timing_Table[idx].i2c_freq == i2c_freq))
+    {
+      ret = I2C_Timing_Table[idx].timing;
+    }
+  }
+#endif /* I2C_DIGITAL_FILTER_COEF == 0U */
+
+  /* Fallback: search of the timings for the other clock pairs */
+  if ((ret == 0U) && (clock_src_freq != 0U) && (i2c_freq != 0U))
   {
+    /* The candidates of a previous computation are not valid for this one */
+    I2c_valid_timing_nbr = 0;
+
     for (speed = 0; speed <= (uint32_t)I2C_SPEED_FREQ_FAST_PLUS; speed++)
     {
       if ((i2c_freq >= I2C_Charac[speed].freq_min) &&
@@ -0,0 +1,110 @@
+/**
+  ******************************************************************************
+  * @file    capture_graph.h
+  * @brief   Header for capture_graph.c module: configuration of the DCMIPP
+  *          pixel pipes fed by the CSI receiver, one buffer ring per pipe.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __CAPTURE_GRAPH_H
+#define __CAPTURE_GRAPH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32n6xx_hal.h"
+#include "frame_ring.h"
+#include "pipe_roi.h"
+#include "pipe_slice.h"
+
+/* Exported types ------------------------------------------------------------*/
+struct __CaptureGraph_HandleTypeDef;
+
+/**
+  * @brief  Frame ready callback, called from the DCMIPP frame event when a
+  *         complete frame is published on the pipe ring
+  */
+typedef void (*CaptureGraph_FrameReadyCallbackTypeDef)(struct __CaptureGraph_HandleTypeDef *hgraph,
+                                                       uint32_t Pipe);
+
+/**
+  * @brief  Output configuration of one pixel pipe
+  */
+typedef struct
+{
+  uint32_t             Pipe;               /*!< DCMIPP_PIPE1 or DCMIPP_PIPE2                    */
+  uint32_t             Width;              /*!< Size written to memory                          */
+  uint32_t             Height;
+  uint32_t             PixelPackerFormat;  /*!< Value of @ref DCMIPP_Pixel_Packer_Format, YUV
+                                                formats are converted from RGB by PIPE1 only     */
+  uint32_t             BytesPerPixel;      /*!< Bytes per pixel of the packer format            */
+  LTDC_HandleTypeDef   *hltdc;             /*!< Display device, NULL for a capture only stream  */
+  uint32_t             LayerIdx;           /*!< LTDC layer, unused without display              */
+  const uint32_t       *pAddress;          /*!< Buffer addresses, 16 bytes aligned              */
+  uint32_t             NbBuffers;          /*!< 0 for a pipe writing into a line buffer, see
+                                                CaptureGraph_AttachWrapSlice()                   */
+  CaptureGraph_FrameReadyCallbackTypeDef FrameReadyCallback; /*!< Optional, may be NULL         */
+} CaptureGraph_PipeConfTypeDef;
+
+/**
+  * @brief  State of one pixel pipe
+  */
+typedef struct
+{
+  FrameRing_HandleTypeDef Ring;
+  PipeRoi_HandleTypeDef   Roi;
+  PipeSlice_HandleTypeDef *Slice;          /*!< Optional band delivery, may be NULL */
+  CaptureGraph_FrameReadyCallbackTypeDef FrameReadyCallback;
+  uint32_t                Pitch;           /*!< Bytes per output line               */
+  uint32_t                Height;          /*!< Output lines per frame              */
+  uint8_t                 HasRing;         /*!< 0 when writing into a line buffer   */
+  uint8_t                 Enabled;
+} CaptureGraph_PipeTypeDef;
+
+/**
+  * @brief  Capture graph handle
+  */
+typedef struct __CaptureGraph_HandleTypeDef
+{
+  DCMIPP_HandleTypeDef     *hdcmipp;
+  uint32_t                 InputWidth;     /*!< Frame size received from the sensor */
+  uint32_t                 InputHeight;
+  CaptureGraph_PipeTypeDef Pipe[DCMIPP_NUM_OF_PIPES];
+} CaptureGraph_HandleTypeDef;
+
+/* Exported functions ------------------------------------------------------- */
+HAL_StatusTypeDef CaptureGraph_Init(CaptureGraph_HandleTypeDef *hgraph, DCMIPP_HandleTypeDef *hdcmipp,
+                                    uint32_t InputWidth, uint32_t InputHeight);
+HAL_StatusTypeDef CaptureGraph_ConfigPipe(CaptureGraph_HandleTypeDef *hgraph,
+                                          const CaptureGraph_PipeConfTypeDef *pConf);
+HAL_StatusTypeDef CaptureGraph_AttachSlice(CaptureGraph_HandleTypeDef *hgraph, uint32_t Pipe,
+                                          PipeSlice_HandleTypeDef *hslice, uint32_t LinesPerBand);
+HAL_StatusTypeDef CaptureGraph_AttachWrapSlice(CaptureGraph_HandleTypeDef *hgraph, uint32_t Pipe,
+                                               PipeSlice_HandleTypeDef *hslice, uint32_t LinesPerBand,
+                                               uint32_t WrapAddress, uint32_t WrapLines);
+HAL_StatusTypeDef CaptureGraph_Start(CaptureGraph_HandleTypeDef *hgraph, uint32_t VirtualChannel);
+FrameRing_HandleTypeDef *CaptureGraph_GetRing(CaptureGraph_HandleTypeDef *hgraph, uint32_t Pipe);
+PipeRoi_HandleTypeDef *CaptureGraph_GetRoi(CaptureGraph_HandleTypeDef *hgraph, uint32_t Pipe);
+void CaptureGraph_FrameEventHandler(CaptureGraph_HandleTypeDef *hgraph, uint32_t Pipe);
+void CaptureGraph_LineEventHandler(CaptureGraph_HandleTypeDef *hgraph, uint32_t Pipe);
+void CaptureGraph_VsyncEventHandler(CaptureGraph_HandleTypeDef *hgraph, uint32_t Pipe);
+void CaptureGraph_ReloadEventHandler(CaptureGraph_HandleTypeDef *hgraph);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CAPTURE_GRAPH_H */
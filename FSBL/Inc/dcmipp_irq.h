@@ -0,0 +1,97 @@
+/**
+  ******************************************************************************
+  * @file    dcmipp_irq.h
+  * @brief   Header for dcmipp_irq.c module: DCMIPP and CSI interrupt
+  *          dispatch restricted to the capture events in use, an interrupt
+  *          with another source being served by the HAL handlers.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __DCMIPP_IRQ_H
+#define __DCMIPP_IRQ_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32n6xx_hal.h"
+
+/* Exported constants --------------------------------------------------------*/
+/* Pipe events the dispatcher can serve: frame, vsync and line of each pipe.
+   The overrun, limit and transfer errors are always in the table */
+#define DCMIPP_IRQ_PIPE_EVENTS      (DCMIPP_FLAG_PIPE0_FRAME | DCMIPP_FLAG_PIPE0_VSYNC | DCMIPP_FLAG_PIPE0_LINE | \
+                                     DCMIPP_FLAG_PIPE1_FRAME | DCMIPP_FLAG_PIPE1_VSYNC | DCMIPP_FLAG_PIPE1_LINE | \
+                                     DCMIPP_FLAG_PIPE2_FRAME | DCMIPP_FLAG_PIPE2_VSYNC | DCMIPP_FLAG_PIPE2_LINE)
+
+/* CSI events the dispatcher can serve: line/byte counters, timers, start and
+   end of frame of each virtual channel. The clock changer and protocol errors
+   are always in the table, the D-PHY errors are left to the HAL handler */
+#define DCMIPP_IRQ_CSI_EVENTS       (DCMIPP_CSI_FLAG_LB0 | DCMIPP_CSI_FLAG_LB1 | DCMIPP_CSI_FLAG_LB2 | DCMIPP_CSI_FLAG_LB3 | \
+                                     DCMIPP_CSI_FLAG_TIM0 | DCMIPP_CSI_FLAG_TIM1 | DCMIPP_CSI_FLAG_TIM2 | DCMIPP_CSI_FLAG_TIM3 | \
+                                     DCMIPP_CSI_FLAG_SOF0 | DCMIPP_CSI_FLAG_SOF1 | DCMIPP_CSI_FLAG_SOF2 | DCMIPP_CSI_FLAG_SOF3 | \
+                                     DCMIPP_CSI_FLAG_EOF0 | DCMIPP_CSI_FLAG_EOF1 | DCMIPP_CSI_FLAG_EOF2 | DCMIPP_CSI_FLAG_EOF3)
+
+#define DCMIPP_IRQ_MAX_PIPE_ENTRIES 15U
+#define DCMIPP_IRQ_MAX_CSI_ENTRIES  24U
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Dispatcher configuration
+  */
+typedef struct
+{
+  uint32_t PipeEvents;      /*!< Out of DCMIPP_IRQ_PIPE_EVENTS                                */
+  uint32_t CsiEvents;       /*!< Out of DCMIPP_IRQ_CSI_EVENTS                                 */
+} DcmippIrq_ConfTypeDef;
+
+/**
+  * @brief  Table entry: status flag, also the interrupt enable bit, and its handler
+  */
+typedef struct __DcmippIrq_EntryTypeDef
+{
+  uint32_t      Flag;
+  uint32_t      Param;          /*!< Pipe, virtual channel, counter or timer of the callback */
+  uint32_t      DisableIt;      /*!< Interrupts disabled by the event (snapshot end, error)  */
+  uint32_t      ErrorCode;      /*!< HAL error code of an error event                        */
+  __IO uint32_t *pFctcr;        /*!< Capture mode register of the pipe                       */
+  void          (*Handler)(DCMIPP_HandleTypeDef *hdcmipp, const struct __DcmippIrq_EntryTypeDef *pEntry);
+} DcmippIrq_EntryTypeDef;
+
+/**
+  * @brief  Dispatcher handle
+  */
+typedef struct
+{
+  DCMIPP_HandleTypeDef   *hdcmipp;
+  uint32_t               PipeFlags;      /*!< Flags of the pipe table                          */
+  uint32_t               CsiFlags;       /*!< Flags of the CSI table                           */
+  uint32_t               NbPipeEntries;
+  uint32_t               NbCsiEntries;
+  DcmippIrq_EntryTypeDef PipeEntry[DCMIPP_IRQ_MAX_PIPE_ENTRIES];   /*!< In the HAL handler order */
+  DcmippIrq_EntryTypeDef CsiEntry[DCMIPP_IRQ_MAX_CSI_ENTRIES];
+  uint32_t               FallbackCount;  /*!< Interrupts passed on to the HAL handlers         */
+} DcmippIrq_HandleTypeDef;
+
+/* Exported functions ------------------------------------------------------- */
+HAL_StatusTypeDef DcmippIrq_Init(DcmippIrq_HandleTypeDef *hirq, DCMIPP_HandleTypeDef *hdcmipp,
+                                 const DcmippIrq_ConfTypeDef *pConf);
+void DcmippIrq_IRQHandler(DcmippIrq_HandleTypeDef *hirq);
+void DcmippIrq_CSI_IRQHandler(DcmippIrq_HandleTypeDef *hirq);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DCMIPP_IRQ_H */
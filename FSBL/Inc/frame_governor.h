@@ -0,0 +1,68 @@
+/**
+  ******************************************************************************
+  * @file    frame_governor.h
+  * @brief   Header for frame_governor.c module: sensor frame length extended
+  *          in steps when the exposure needs more than the frame time, down
+  *          to a minimum frame rate, and restored when the light returns.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __FRAME_GOVERNOR_H
+#define __FRAME_GOVERNOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32n6xx_hal.h"
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Frame governor configuration, in sensor lines
+  */
+typedef struct
+{
+  uint32_t Hts;              /*!< Pixel clocks per line                             */
+  uint32_t Pclk;             /*!< Sensor pixel clock (Hz)                           */
+  uint32_t VtsMin;           /*!< Lines per frame at the full frame rate            */
+  uint32_t MarginLines;      /*!< Lines the sensor keeps free after the exposure    */
+  uint32_t MinFps;           /*!< Lowest frame rate the frame may be extended to    */
+  uint32_t StepLines;        /*!< Frame length change of one step                   */
+  uint32_t HysteresisLines;  /*!< Exposure headroom required before a step down     */
+} FrameGovernor_ConfTypeDef;
+
+/**
+  * @brief  Frame governor handle
+  */
+typedef struct
+{
+  FrameGovernor_ConfTypeDef Conf;
+  uint32_t                  VtsMax;        /*!< Lines per frame at MinFps                */
+  uint32_t                  Vts;           /*!< Lines per frame chosen                   */
+  __IO uint32_t             FramePeriod;   /*!< Frame period for Vts, in us              */
+  __IO uint32_t             ChangeCount;   /*!< Frame length changes                     */
+} FrameGovernor_HandleTypeDef;
+
+/* Exported functions ------------------------------------------------------- */
+HAL_StatusTypeDef FrameGovernor_Init(FrameGovernor_HandleTypeDef *hgov, const FrameGovernor_ConfTypeDef *pConf);
+uint32_t FrameGovernor_Update(FrameGovernor_HandleTypeDef *hgov, uint32_t Exposure);
+uint32_t FrameGovernor_GetExposureMax(const FrameGovernor_HandleTypeDef *hgov);
+uint32_t FrameGovernor_GetFramePeriod(const FrameGovernor_HandleTypeDef *hgov);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FRAME_GOVERNOR_H */
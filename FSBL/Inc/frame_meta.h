@@ -0,0 +1,87 @@
+/**
+  ******************************************************************************
+  * @file    frame_meta.h
+  * @brief   Header for frame_meta.c module: capture record of each frame,
+  *          staged at the frame start and carried with its ring buffer.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __FRAME_META_H
+#define __FRAME_META_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32n6xx_hal.h"
+#include "frame_ring.h"
+#include "pipe_roi.h"
+#include "isp_api.h"
+
+/* Exported constants --------------------------------------------------------*/
+/* Longest sensor delay followed, in frames */
+#define FRAME_META_MAX_DELAY        4U
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Frame record configuration
+  */
+typedef struct
+{
+  uint32_t SensorDelay;     /*!< Starts of frame from the one a sensor update is sent
+                                 at to the first frame exposed with it, up to
+                                 FRAME_META_MAX_DELAY                              */
+  int32_t  Gain;            /*!< Sensor gain at start, in mdB                      */
+  int32_t  Exposure;        /*!< Sensor exposure at start, in us                   */
+} FrameMeta_ConfTypeDef;
+
+/**
+  * @brief  Sensor settings
+  */
+typedef struct
+{
+  int32_t Gain;
+  int32_t Exposure;
+} FrameMeta_SensorTypeDef;
+
+/**
+  * @brief  Frame record handle
+  */
+typedef struct
+{
+  ISP_HandleTypeDef       *hIsp;
+  FrameMeta_ConfTypeDef   Conf;
+  FrameMeta_SensorTypeDef Requested;      /*!< Last values handed to the sensor control  */
+  FrameMeta_SensorTypeDef Sent[FRAME_META_MAX_DELAY + 1U];  /*!< Values sent to the sensor,
+                                               [0] as of the last start of frame         */
+  uint32_t                SofCount;       /*!< Sensor starts of frame                    */
+  uint32_t                SofCycles;      /*!< Last start of frame, DWT cycles           */
+  uint32_t                SofTick;        /*!< Last start of frame, HAL tick             */
+} FrameMeta_HandleTypeDef;
+
+/* Exported functions ------------------------------------------------------- */
+HAL_StatusTypeDef FrameMeta_Init(FrameMeta_HandleTypeDef *hmeta, ISP_HandleTypeDef *hIsp,
+                                 const FrameMeta_ConfTypeDef *pConf);
+void FrameMeta_SetGain(FrameMeta_HandleTypeDef *hmeta, int32_t Gain);
+void FrameMeta_SetExposure(FrameMeta_HandleTypeDef *hmeta, int32_t Exposure);
+void FrameMeta_StartOfFrameHandler(FrameMeta_HandleTypeDef *hmeta, uint8_t Sent);
+void FrameMeta_VsyncEventHandler(FrameMeta_HandleTypeDef *hmeta, FrameRing_HandleTypeDef *hring,
+                                 const PipeRoi_HandleTypeDef *hroi);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FRAME_META_H */
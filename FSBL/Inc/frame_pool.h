@@ -0,0 +1,86 @@
+/**
+  ******************************************************************************
+  * @file    frame_pool.h
+  * @brief   Header for frame_pool.c module: pool of cache-line aligned frame
+  *          buffers in internal SRAM or memory-mapped PSRAM, shared by
+  *          reference between the processing stages.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __FRAME_POOL_H
+#define __FRAME_POOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32n6xx_hal.h"
+
+/* Exported constants --------------------------------------------------------*/
+/* D-Cache line size: buffer start and size granularity */
+#define FRAME_POOL_ALIGN            32U
+
+/* Maximum number of buffers handled by one pool */
+#define FRAME_POOL_MAX_BUFFERS      16U
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Bus master allowed to access a pool buffer
+  */
+typedef enum
+{
+  FRAME_POOL_OWNER_CPU = 0U,      /*!< Read and written through the D-Cache          */
+  FRAME_POOL_OWNER_DEVICE_READ,   /*!< Read by a DMA master (LTDC, DMA2D, JPEG, ...) */
+  FRAME_POOL_OWNER_DEVICE_WRITE   /*!< Written by a DMA master (DCMIPP, JPEG, ...)    */
+} FramePool_OwnerTypeDef;
+
+/**
+  * @brief  Pool buffer descriptor
+  */
+typedef struct
+{
+  uint32_t                         Address;   /*!< Buffer start, FRAME_POOL_ALIGN aligned */
+  __IO uint32_t                    RefCount;  /*!< 0 when the buffer is free              */
+  __IO FramePool_OwnerTypeDef      Owner;
+} FramePool_BufferTypeDef;
+
+/**
+  * @brief  Frame pool handle
+  */
+typedef struct
+{
+  uint32_t                BufferSize;         /*!< Multiple of FRAME_POOL_ALIGN           */
+  uint32_t                NbBuffers;          /*!< Buffers carved from the regions        */
+  FramePool_BufferTypeDef Buffer[FRAME_POOL_MAX_BUFFERS];
+  __IO uint32_t           FailCount;          /*!< Allocations refused, pool exhausted    */
+} FramePool_HandleTypeDef;
+
+/* Exported functions ------------------------------------------------------- */
+HAL_StatusTypeDef FramePool_Init(FramePool_HandleTypeDef *hpool, uint32_t BufferSize);
+HAL_StatusTypeDef FramePool_AddRegion(FramePool_HandleTypeDef *hpool, uint32_t Address, uint32_t Size);
+HAL_StatusTypeDef FramePool_Alloc(FramePool_HandleTypeDef *hpool, uint32_t *pAddress);
+HAL_StatusTypeDef FramePool_Retain(FramePool_HandleTypeDef *hpool, uint32_t Address);
+HAL_StatusTypeDef FramePool_Release(FramePool_HandleTypeDef *hpool, uint32_t Address);
+uint32_t FramePool_GetRefCount(FramePool_HandleTypeDef *hpool, uint32_t Address);
+uint32_t FramePool_GetFreeCount(FramePool_HandleTypeDef *hpool);
+HAL_StatusTypeDef FramePool_BeginDeviceAccess(FramePool_HandleTypeDef *hpool, uint32_t Address,
+                                              FramePool_OwnerTypeDef Owner);
+HAL_StatusTypeDef FramePool_EndDeviceAccess(FramePool_HandleTypeDef *hpool, uint32_t Address);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FRAME_POOL_H */
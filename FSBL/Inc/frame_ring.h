@@ -0,0 +1,129 @@
+/**
+  ******************************************************************************
+  * @file    frame_ring.h
+  * @brief   Header for frame_ring.c module: capture-to-display frame buffer
+  *          ring built on the DCMIPP double buffer mode and LTDC reload.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __FRAME_RING_H
+#define __FRAME_RING_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32n6xx_hal.h"
+
+/* Exported constants --------------------------------------------------------*/
+/* Maximum number of buffers handled by one ring (2 = double, 3+ = triple) */
+#define FRAME_RING_MAX_BUFFERS      4U
+
+/* Index value used when no buffer is attached to a slot / state */
+#define FRAME_RING_NO_BUFFER        0xFFU
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Current owner of a frame buffer
+  */
+typedef enum
+{
+  FRAME_BUF_FREE = 0U,        /*!< Not used, may be handed to the DCMIPP         */
+  FRAME_BUF_CAPTURE,          /*!< Programmed in one of the DCMIPP DBM slots     */
+  FRAME_BUF_READY,            /*!< Complete frame, not yet claimed               */
+  FRAME_BUF_PROCESS,          /*!< Claimed by the application for processing     */
+  FRAME_BUF_DISPLAY_PENDING,  /*!< Written to the LTDC shadow, waiting reload    */
+  FRAME_BUF_DISPLAY           /*!< Currently scanned out by the LTDC             */
+} FrameBuf_OwnerTypeDef;
+
+/**
+  * @brief  Capture record of a frame: when it started and the sensor, ISP and
+  *         pipe settings it was produced with
+  */
+typedef struct
+{
+  uint32_t FrameId;           /*!< Ring frame counter, as FrameBuf_TypeDef FrameId    */
+  uint32_t SofCount;          /*!< Sensor start of frame counter                      */
+  uint32_t SofCycles;         /*!< DWT cycle counter at the sensor start of frame     */
+  uint32_t SofTick;           /*!< HAL tick at the sensor start of frame              */
+  int32_t  SensorGain;        /*!< Sensor gain exposing the frame, in mdB             */
+  int32_t  SensorExposure;    /*!< Sensor exposure of the frame, in us                */
+  uint32_t IspGain[3];        /*!< ISP R, G, B gains, 100000000 for x1.0              */
+  int32_t  ColorConv[3][3];   /*!< ISP color conversion, 100000000 for x1.0           */
+  uint32_t ColorTemp;         /*!< Last AWB color temperature estimate, in K          */
+  uint8_t  AverageL;          /*!< Last AEC luminance measure                         */
+  uint8_t  Decimation;        /*!< ISP decimation factor                              */
+  uint8_t  Valid;             /*!< 0 if no record was captured at the frame start     */
+  uint16_t CropX;             /*!< Crop window, in the pipe input referential         */
+  uint16_t CropY;
+  uint16_t CropWidth;
+  uint16_t CropHeight;
+  uint16_t OutputWidth;       /*!< Crop window downsized to the pipe output           */
+  uint16_t OutputHeight;
+} FrameBuf_MetaTypeDef;
+
+/**
+  * @brief  Frame buffer descriptor
+  */
+typedef struct
+{
+  uint32_t                        Address;  /*!< Buffer start address             */
+  __IO FrameBuf_OwnerTypeDef      Owner;    /*!< Current owner of the buffer      */
+  __IO uint32_t                   FrameId;  /*!< Id of the last frame captured    */
+  FrameBuf_MetaTypeDef            Meta;     /*!< Record of the last frame captured*/
+} FrameBuf_TypeDef;
+
+/**
+  * @brief  Frame buffer ring handle
+  */
+typedef struct
+{
+  DCMIPP_HandleTypeDef *hdcmipp;                      /*!< Capture device              */
+  LTDC_HandleTypeDef   *hltdc;                        /*!< Display device, NULL if none*/
+  uint32_t             Pipe;                          /*!< DCMIPP pipe feeding the ring*/
+  uint32_t             LayerIdx;                      /*!< LTDC layer showing the ring */
+  uint32_t             NbBuffers;                     /*!< Number of buffers in use    */
+  FrameBuf_TypeDef     Buffer[FRAME_RING_MAX_BUFFERS];
+  FrameBuf_MetaTypeDef NextMeta;                      /*!< Record of the frame captured*/
+  __IO uint8_t         Slot[2];                       /*!< Buffer in DBM slot 0 and 1  */
+  __IO uint8_t         ActiveSlot;                    /*!< Slot being written          */
+  __IO uint8_t         Ready;                         /*!< Latest complete buffer      */
+  __IO uint8_t         Pending;                       /*!< Buffer waiting LTDC reload  */
+  __IO uint8_t         Display;                       /*!< Buffer scanned out          */
+  __IO uint32_t        FrameCount;                    /*!< Frames captured             */
+  __IO uint32_t        DropCount;                     /*!< Frames never displayed      */
+  __IO uint32_t        SkipCount;                     /*!< Frames dropped in the DCMIPP,
+                                                           no free buffer              */
+  __IO uint32_t        FlipCount;                     /*!< LTDC address reloads        */
+} FrameRing_HandleTypeDef;
+
+/* Exported functions ------------------------------------------------------- */
+HAL_StatusTypeDef FrameRing_Init(FrameRing_HandleTypeDef *hring, DCMIPP_HandleTypeDef *hdcmipp,
+                                 LTDC_HandleTypeDef *hltdc, uint32_t Pipe, uint32_t LayerIdx,
+                                 const uint32_t *pAddress, uint32_t NbBuffers);
+HAL_StatusTypeDef FrameRing_Start(FrameRing_HandleTypeDef *hring, uint32_t VirtualChannel);
+HAL_StatusTypeDef FrameRing_GetReadyBuffer(FrameRing_HandleTypeDef *hring, uint32_t *pAddress);
+HAL_StatusTypeDef FrameRing_PresentBuffer(FrameRing_HandleTypeDef *hring, uint32_t Address);
+HAL_StatusTypeDef FrameRing_ReleaseBuffer(FrameRing_HandleTypeDef *hring, uint32_t Address);
+const FrameBuf_MetaTypeDef *FrameRing_GetMeta(const FrameRing_HandleTypeDef *hring, uint32_t Address);
+void FrameRing_SetFrameMeta(FrameRing_HandleTypeDef *hring, const FrameBuf_MetaTypeDef *pMeta);
+void FrameRing_FrameEventHandler(FrameRing_HandleTypeDef *hring);
+void FrameRing_ReloadEventHandler(FrameRing_HandleTypeDef *hring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FRAME_RING_H */
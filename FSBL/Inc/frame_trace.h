@@ -0,0 +1,135 @@
+/**
+  ******************************************************************************
+  * @file    frame_trace.h
+  * @brief   Header for frame_trace.c module: cycle accurate timestamps of the
+  *          capture and display events, frame rate, dropped frames, interrupt
+  *          duration and capture-to-display latency histograms.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __FRAME_TRACE_H
+#define __FRAME_TRACE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32n6xx_hal.h"
+
+/* Exported constants --------------------------------------------------------*/
+/* Number of records between the interrupt handlers and FrameTrace_Process(), power of 2 */
+#define FRAME_TRACE_RING_SIZE       256U
+
+/* Frames followed from their start of frame to their display, power of 2 */
+#define FRAME_TRACE_MAX_INFLIGHT    8U
+
+/* Histogram bins: log2 of microseconds for the interrupt durations (bin 0 below
+ * 1 us, bin n from 2^(n-1) us), FRAME_TRACE_LATENCY_BIN_MS wide for the latency */
+#define FRAME_TRACE_HIST_BINS       16U
+#define FRAME_TRACE_LATENCY_BIN_MS  8U
+
+/* Exported macro ------------------------------------------------------------*/
+/* Timestamp source, DWT cycle counter started by the application */
+#define FRAME_TRACE_TIMESTAMP()     (DWT->CYCCNT)
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Traced events, with the meaning of the record argument
+  */
+typedef enum
+{
+  FRAME_TRACE_CSI_SOF = 0U,     /*!< CSI start of frame, id of the frame starting          */
+  FRAME_TRACE_VSYNC,            /*!< DCMIPP VSYNC of the traced pipe, last frame id        */
+  FRAME_TRACE_FRAME_COMPLETE,   /*!< Frame written by the traced pipe, frame id            */
+  FRAME_TRACE_STAT_READY,       /*!< ISP statistics delivered, ISP main frame id           */
+  FRAME_TRACE_AEC_APPLY,        /*!< Sensor gain or exposure updated, ISP main frame id    */
+  FRAME_TRACE_AWB_APPLY,        /*!< ISP color conversion updated, ISP main frame id       */
+  FRAME_TRACE_LTDC_RELOAD,      /*!< LTDC reload, id of the frame scanned out              */
+  FRAME_TRACE_ISR_CSI,          /*!< CSI interrupt handler, duration in cycles             */
+  FRAME_TRACE_ISR_DCMIPP,       /*!< DCMIPP interrupt handler, duration in cycles          */
+  FRAME_TRACE_ISR_LTDC,         /*!< LTDC interrupt handler, duration in cycles            */
+  FRAME_TRACE_NB_EVENTS
+} FrameTrace_EventTypeDef;
+
+#define FRAME_TRACE_NB_ISR          (FRAME_TRACE_NB_EVENTS - FRAME_TRACE_ISR_CSI)
+
+/**
+  * @brief  Event record
+  */
+typedef struct
+{
+  __IO uint32_t Seq;            /*!< Ring position + 1 once the record is written */
+  uint32_t      Cycles;         /*!< Timestamp                                    */
+  uint32_t      Arg;
+  uint32_t      Event;
+} FrameTrace_RecordTypeDef;
+
+/**
+  * @brief  Histogram of durations
+  */
+typedef struct
+{
+  uint32_t Bin[FRAME_TRACE_HIST_BINS];
+  uint32_t BinWidthUs;          /*!< 0 for log2 bins                              */
+  uint32_t Count;
+  uint32_t MinNs;
+  uint32_t MaxNs;
+  uint64_t SumNs;
+} FrameTrace_HistogramTypeDef;
+
+/**
+  * @brief  Frame followed from the sensor to the display
+  */
+typedef struct
+{
+  uint32_t FrameId;
+  uint32_t SofCycles;
+  uint8_t  Valid;               /*!< Cleared once the frame is displayed          */
+} FrameTrace_InflightTypeDef;
+
+/**
+  * @brief  Frame trace handle
+  */
+typedef struct
+{
+  DCMIPP_HandleTypeDef        *hdcmipp;                          /*!< Hardware frame counter         */
+  uint32_t                    Pipe;
+  FrameTrace_RecordTypeDef    Ring[FRAME_TRACE_RING_SIZE];
+  __IO uint32_t               Head;                              /*!< Next slot claimed by a producer */
+  __IO uint32_t               Tail;                              /*!< Next slot read by the consumer  */
+  __IO uint32_t               LostCount;                         /*!< Records dropped, ring full      */
+  FrameTrace_InflightTypeDef  Inflight[FRAME_TRACE_MAX_INFLIGHT];
+  uint32_t                    EventCount[FRAME_TRACE_NB_EVENTS]; /*!< Events of the current window    */
+  uint32_t                    LastFrameCycles;                   /*!< Previous frame complete         */
+  uint32_t                    FramePeriodCount;
+  uint64_t                    FramePeriodSum;                    /*!< Cycles between frame completes  */
+  uint32_t                    FramePeriodMax;
+  uint32_t                    HwFrameCount;                      /*!< DCMIPP counter at the last report */
+  uint32_t                    DroppedCount;                      /*!< Frames lost since the start     */
+  FrameTrace_HistogramTypeDef Isr[FRAME_TRACE_NB_ISR];
+  FrameTrace_HistogramTypeDef Latency;                           /*!< Start of frame to LTDC reload   */
+} FrameTrace_HandleTypeDef;
+
+/* Exported functions ------------------------------------------------------- */
+HAL_StatusTypeDef FrameTrace_Init(FrameTrace_HandleTypeDef *htrace, DCMIPP_HandleTypeDef *hdcmipp, uint32_t Pipe);
+void FrameTrace_Record(FrameTrace_HandleTypeDef *htrace, FrameTrace_EventTypeDef Event, uint32_t Arg);
+void FrameTrace_Process(FrameTrace_HandleTypeDef *htrace);
+void FrameTrace_Report(FrameTrace_HandleTypeDef *htrace);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FRAME_TRACE_H */
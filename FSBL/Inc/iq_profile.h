@@ -0,0 +1,104 @@
+/**
+  ******************************************************************************
+  * @file    iq_profile.h
+  * @brief   Header for iq_profile.c module: versioned, CRC protected IQ
+  *          parameter profiles stored in the XSPI NOR and used in place
+  *          through the memory-mapped mode.
+  *
+  *          Image layout (little endian, shared with the host tool):
+  *          - IQProfile_HeaderTypeDef
+  *          - NbEntries x IQProfile_EntryTypeDef
+  *          - the payloads, each one an ISP_IQParamTypeDef as laid out by
+  *            the firmware, at IQ_PROFILE_ALIGN aligned offsets
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __IQ_PROFILE_H
+#define __IQ_PROFILE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32n6xx_hal.h"
+#include "isp_core.h"
+
+/* Exported constants --------------------------------------------------------*/
+#define IQ_PROFILE_MAGIC            0x46505149U   /* "IQPF" */
+#define IQ_PROFILE_VERSION          1U            /* Header and directory layout */
+#define IQ_PROFILE_MAX_ENTRIES      16U
+#define IQ_PROFILE_SENSOR_LENGTH    16U
+#define IQ_PROFILE_ALIGN            8U            /* Payload offset alignment */
+#define IQ_PROFILE_PARAM_SIZE       596U          /* sizeof(ISP_IQParamTypeDef), short enums */
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Image header
+  */
+typedef struct
+{
+  uint32_t Magic;           /*!< IQ_PROFILE_MAGIC                                   */
+  uint16_t Version;         /*!< IQ_PROFILE_VERSION                                 */
+  uint16_t NbEntries;       /*!< Directory entries, up to IQ_PROFILE_MAX_ENTRIES    */
+  uint32_t ParamSize;       /*!< sizeof(ISP_IQParamTypeDef) of the payloads         */
+  uint32_t TotalSize;       /*!< Header, directory and payloads, in bytes           */
+  uint32_t DirCrc;          /*!< CRC-32 of the directory                            */
+  uint32_t HeaderCrc;       /*!< CRC-32 of the fields above                         */
+} IQProfile_HeaderTypeDef;
+
+/**
+  * @brief  Directory entry: one profile per sensor and mode
+  */
+typedef struct
+{
+  char     Sensor[IQ_PROFILE_SENSOR_LENGTH]; /*!< Sensor name, as reported by the driver, NUL padded */
+  uint32_t Mode;            /*!< Sensor resolution (driver mode id)                 */
+  uint32_t Revision;        /*!< Tuning revision, free for the tuning flow          */
+  uint32_t Offset;          /*!< Payload offset from the header                     */
+  uint32_t Size;            /*!< Payload size, ParamSize                            */
+  uint32_t Crc;             /*!< CRC-32 of the payload                              */
+} IQProfile_EntryTypeDef;
+
+/**
+  * @brief  Profile image handle
+  */
+typedef struct
+{
+  const IQProfile_HeaderTypeDef *pHeader;   /*!< Image, memory-mapped            */
+  const IQProfile_EntryTypeDef  *pEntry;    /*!< Directory                       */
+} IQProfile_HandleTypeDef;
+
+/* The payloads are used in place: the host tool lays ISP_IQParamTypeDef out as
+   the firmware, with the enums in the smallest integer type of the ARM EABI
+   (-fshort-enums on the host) */
+_Static_assert(sizeof(ISP_IQParamTypeDef) == IQ_PROFILE_PARAM_SIZE, "IQ profile payload layout");
+
+/* Exported functions ------------------------------------------------------- */
+HAL_StatusTypeDef IQProfile_Init(IQProfile_HandleTypeDef *hprof, const void *pImage, uint32_t MaxSize);
+HAL_StatusTypeDef IQProfile_Find(const IQProfile_HandleTypeDef *hprof, const char *Sensor, uint32_t Mode,
+                                 const ISP_IQParamTypeDef **ppParam);
+HAL_StatusTypeDef IQProfile_Check(const uint8_t *pImage, uint32_t Size);
+uint32_t IQProfile_Crc32(uint32_t Crc, const void *pData, uint32_t Size);
+#ifndef IQ_PROFILE_HOST
+HAL_StatusTypeDef IQProfile_Apply(const IQProfile_HandleTypeDef *hprof, ISP_HandleTypeDef *hIsp, const char *Sensor,
+                                  uint32_t Mode);
+HAL_StatusTypeDef IQProfile_Program(uint32_t Instance, uint32_t Offset, const uint8_t *pImage, uint32_t Size);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __IQ_PROFILE_H */
@@ -0,0 +1,118 @@
+/**
+  ******************************************************************************
+  * @file    jpeg_encoder.h
+  * @brief   Header for jpeg_encoder.c module: hardware JPEG encoding of the
+  *          YUV422 bands of a DCMIPP pixel pipe (snapshot and Motion-JPEG).
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __JPEG_ENCODER_H
+#define __JPEG_ENCODER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32n6xx_hal.h"
+#include "pipe_slice.h"
+
+/* Exported constants --------------------------------------------------------*/
+/* YCbCr 4:2:2 MCU: two 8x8 luma blocks, one Cb and one Cr block */
+#define JPEG_ENC_MCU_WIDTH          16U
+#define JPEG_ENC_MCU_HEIGHT         8U
+#define JPEG_ENC_MCU_SIZE           256U
+
+/* Largest number of slots in the output ring */
+#define JPEG_ENC_MAX_SLOTS          4U
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Encoder configuration
+  */
+typedef struct
+{
+  uint32_t Width;       /*!< Multiple of JPEG_ENC_MCU_WIDTH                                  */
+  uint32_t Height;      /*!< Multiple of JPEG_ENC_MCU_HEIGHT                                 */
+  uint32_t Quality;     /*!< 1 to 100                                                        */
+  uint32_t McuAddress;  /*!< Two MCU rows of Width * 16 bytes each, 32 bytes aligned         */
+  uint32_t OutAddress;  /*!< NbSlots output slots of SlotSize bytes, 32 bytes aligned        */
+  uint32_t SlotSize;    /*!< Multiple of 32, a frame larger than a slot is dropped           */
+  uint32_t NbSlots;     /*!< 1 to JPEG_ENC_MAX_SLOTS                                         */
+} JpegEnc_ConfTypeDef;
+
+/**
+  * @brief  Encoded frame
+  */
+typedef struct
+{
+  uint32_t Address;     /*!< JPEG stream start, SOI marker included */
+  uint32_t Size;        /*!< JPEG stream size in bytes               */
+  uint32_t FrameId;     /*!< Pipe frame the stream was encoded from  */
+} JpegEnc_FrameTypeDef;
+
+/**
+  * @brief  Encoder handle
+  */
+typedef struct
+{
+  JPEG_HandleTypeDef      *hjpeg;
+  PipeSlice_HandleTypeDef *hslice;        /*!< YUV422 (YUYV) bands of JPEG_ENC_MCU_HEIGHT lines    */
+  uint32_t                Width;
+  uint32_t                McuRows;        /*!< MCU rows per frame                                  */
+  uint32_t                McuRowSize;     /*!< Bytes per MCU row                                   */
+  uint32_t                McuAddress;
+  uint32_t                OutAddress;
+  uint32_t                SlotSize;
+  uint32_t                NbSlots;
+  JpegEnc_FrameTypeDef    Frame[JPEG_ENC_MAX_SLOTS];
+  __IO uint32_t           Head;           /*!< Frames encoded (written by the ISR)                 */
+  __IO uint32_t           Tail;           /*!< Frames released                                     */
+  __IO uint8_t            Record;         /*!< Encode every frame                                  */
+  __IO uint8_t            SnapshotPending;/*!< Encode the next frame only                          */
+  __IO uint8_t            Active;         /*!< A frame is being encoded                            */
+  uint8_t                 Started;        /*!< The codec has been given the first MCU row          */
+  uint32_t                FrameId;        /*!< Frame being encoded                                 */
+  uint32_t                RowsTiled;      /*!< MCU rows written by the CPU                         */
+  __IO uint32_t           RowsFed;        /*!< MCU rows handed to the codec input DMA              */
+  __IO uint32_t           RowsConsumed;   /*!< MCU rows read by the codec                          */
+  __IO uint8_t            InputPaused;    /*!< Codec input waiting for the next MCU row            */
+  uint32_t                InAddress;      /*!< Part of the MCU row not yet read by the codec       */
+  uint32_t                InLength;
+  __IO uint32_t           OutSize;        /*!< Bytes written in the current slot                   */
+  __IO uint8_t            Overflow;       /*!< The frame does not fit in its slot                  */
+  __IO uint32_t           EncodedCount;
+  __IO uint32_t           DropCount;      /*!< Frames abandoned: overflow, missing band or error   */
+  __IO uint32_t           SkipCount;      /*!< Frames not encoded because the output ring was full */
+} JpegEnc_HandleTypeDef;
+
+/* Exported functions ------------------------------------------------------- */
+HAL_StatusTypeDef JpegEnc_Init(JpegEnc_HandleTypeDef *hjenc, JPEG_HandleTypeDef *hjpeg,
+                               PipeSlice_HandleTypeDef *hslice, const JpegEnc_ConfTypeDef *pConf);
+void JpegEnc_Record(JpegEnc_HandleTypeDef *hjenc, uint8_t Enable);
+void JpegEnc_Snapshot(JpegEnc_HandleTypeDef *hjenc);
+void JpegEnc_Process(JpegEnc_HandleTypeDef *hjenc);
+HAL_StatusTypeDef JpegEnc_GetFrame(JpegEnc_HandleTypeDef *hjenc, JpegEnc_FrameTypeDef *pFrame);
+HAL_StatusTypeDef JpegEnc_ReleaseFrame(JpegEnc_HandleTypeDef *hjenc);
+void JpegEnc_TileMcuRow(const uint8_t *pSrc, uint32_t Pitch, uint32_t Width, uint8_t *pDst);
+void JpegEnc_GetDataHandler(JpegEnc_HandleTypeDef *hjenc, uint32_t NbEncodedData);
+void JpegEnc_DataReadyHandler(JpegEnc_HandleTypeDef *hjenc, uint32_t OutDataLength);
+void JpegEnc_EncodeCpltHandler(JpegEnc_HandleTypeDef *hjenc);
+void JpegEnc_ErrorHandler(JpegEnc_HandleTypeDef *hjenc);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __JPEG_ENCODER_H */
@@ -65,10 +65,92 @@ typedef funcptr funcptr_NS;
 /* Exported macro ------------------------------------------------------------*/
 /* USER CODE BEGIN EM */
 #define CAMERA_IMX335_ADDRESS 0x34U
+#define CAMERA_WIDTH  1920
+#define CAMERA_HEIGHT 1080
 #define FRAME_WIDTH  800
 #define FRAME_HEIGHT 480
 #define FRAME_BUFFER_SIZE (FRAME_WIDTH * FRAME_HEIGHT*2)
 #define BUFFER_ADDRESS  0x34200000
+/* Capture-to-display ring: two buffers in AXISRAM3..6, the third one in AXISRAM1 */
+#define BUFFER_ADDRESS_1  (BUFFER_ADDRESS + FRAME_BUFFER_SIZE)
+#define BUFFER_ADDRESS_2  0x34000000
+#define FRAME_RING_NB_BUFFERS 3U
+/* Analytics stream on PIPE2: RGB888, one buffer after each display buffer region */
+#define ANALYTICS_WIDTH  224
+#define ANALYTICS_HEIGHT 224
+#define ANALYTICS_BUFFER_SIZE (ANALYTICS_WIDTH * ANALYTICS_HEIGHT*3)
+#define ANALYTICS_BUFFER_ADDRESS    (BUFFER_ADDRESS_1 + FRAME_BUFFER_SIZE)
+#define ANALYTICS_BUFFER_ADDRESS_1  (BUFFER_ADDRESS_2 + FRAME_BUFFER_SIZE)
+#define ANALYTICS_NB_BUFFERS 2U
+/* Analytics frames are also delivered in bands of ANALYTICS_SLICE_LINES lines */
+#define ANALYTICS_SLICE_LINES 32U
+/* Display ring taken from the PSRAM mapped by XSPI1 instead of AXISRAM, the
+ * buffers above are then left to the other stages */
+#define USE_PSRAM_FRAME_POOL 0U
+#define PSRAM_POOL_ADDRESS   XSPI1_BASE
+#define PSRAM_POOL_SIZE      (FRAME_RING_NB_BUFFERS * FRAME_BUFFER_SIZE)
+/* UI overlay on LTDC layer 2, composed by DMA2D. ARGB4444, full width and
+ * OVERLAY_HEIGHT lines centered on the display: the buffer sits in the end of
+ * AXISRAM1 and the start of AXISRAM2, below the FSBL image */
+#define USE_DISPLAY_OVERLAY    1U
+#define OVERLAY_WIDTH          FRAME_WIDTH
+#define OVERLAY_HEIGHT         400
+#define OVERLAY_X              0
+#define OVERLAY_Y              ((FRAME_HEIGHT - OVERLAY_HEIGHT) / 2)
+#define OVERLAY_BUFFER_ADDRESS (ANALYTICS_BUFFER_ADDRESS_1 + ANALYTICS_BUFFER_SIZE)
+/* Motion-JPEG recording: PIPE1 writes YUV422 lines for the JPEG codec and
+ * PIPE2 takes over the display, the analytics stream is then not available.
+ * The line buffer and MCU rows use the first analytics buffer, the encoded
+ * frames the second one. */
+#define USE_JPEG_RECORDING 0U
+#define JPEG_QUALITY       75U
+#define JPEG_WRAP_LINES    64U
+#define JPEG_WRAP_ADDRESS  ANALYTICS_BUFFER_ADDRESS
+#define JPEG_MCU_ADDRESS   (JPEG_WRAP_ADDRESS + (FRAME_WIDTH * 2 * JPEG_WRAP_LINES))
+#define JPEG_OUT_ADDRESS   ANALYTICS_BUFFER_ADDRESS_1
+#define JPEG_OUT_SLOT_SIZE 73728U
+#define JPEG_OUT_NB_SLOTS  2U
+/* Sensor gain and exposure queued by the ISP and sent by interrupt driven I2C
+ * transfers after the start of frame, in one OV5647 group hold */
+#define USE_SENSOR_QUEUE      1U
+/* Per-frame timing of the capture and display events, summary printed on the
+ * COM log every FRAME_TRACE_REPORT_MS */
+#define USE_FRAME_TRACE       1U
+#define FRAME_TRACE_REPORT_MS 5000U
+/* Low light: the sensor frame is extended in steps of 1/FRAME_GOVERNOR_STEP_DIV
+ * of the full rate frame so the AEC can expose longer, down to
+ * FRAME_GOVERNOR_MIN_FPS, and the full rate is restored with the light */
+#define USE_FRAME_GOVERNOR      1U
+#define FRAME_GOVERNOR_MIN_FPS  10U
+#define FRAME_GOVERNOR_STEP_DIV 4U
+/* IQ parameters taken from a profile image in the XSPI2 NOR, selected by sensor
+ * and mode, instead of the compiled-in ones which stay as the fallback */
+#define USE_IQ_PROFILE          1U
+#define IQ_PROFILE_NOR_OFFSET   0x07F00000U
+#define IQ_PROFILE_MAX_SIZE     (256U * 1024U)
+/* Frames recorded as raw blocks on the SD card (SDMMC2): the JPEG stream with
+ * USE_JPEG_RECORDING, the analytics frames otherwise. The extent is erased at
+ * start; the staging buffers follow the first analytics buffer in AXISRAM6 */
+#define USE_SD_RECORDER             0U
+#define SD_RECORDER_START_BLOCK     0x00100000U   /* 512 MB from the card start */
+#define SD_RECORDER_NB_BLOCKS       0x00200000U   /* 1 GB                       */
+#define SD_RECORDER_MAX_FRAMES      65536U
+#define SD_RECORDER_STAGING_ADDRESS (ANALYTICS_BUFFER_ADDRESS + ANALYTICS_BUFFER_SIZE)
+#define SD_RECORDER_STAGING_SIZE    (64U * 1024U)
+#define SD_RECORDER_NB_STAGING      2U
+#define SD_RECORDER_REPORT_MS       5000U
+/* DCMIPP and CSI interrupts dispatched from a table of the capture events in
+ * use instead of the HAL handlers testing every source. The dispatcher and the
+ * frame callbacks are run from the ITCM with the STM32CubeIDE linker script */
+#define USE_DCMIPP_IRQ_DISPATCH     1U
+/* AEC/AWB metered on the spot tapped on the preview (GT911 touch panel) */
+#define USE_TOUCH_METER             1U
+#define TOUCH_METER_SPOT_SIZE       96U
+#define TOUCH_METER_POLL_MS         20U
+/* Capture record (sensor, ISP and pipe settings) attached to each ring buffer.
+ * A sensor update sent at a start of frame exposes the frame after it */
+#define USE_FRAME_META              1U
+#define FRAME_META_SENSOR_DELAY     1U
 
 #define CAMERA_OV5647_ADDRESS  (0x6CU)
 /* USER CODE END EM */
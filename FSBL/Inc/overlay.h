@@ -0,0 +1,125 @@
+/**
+  ******************************************************************************
+  * @file    overlay.h
+  * @brief   Header for overlay.c module: UI overlay composed by DMA2D on a
+  *          LTDC layer above the video, redrawn by dirty rectangles.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __OVERLAY_H
+#define __OVERLAY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32n6xx_hal.h"
+
+/* Exported constants --------------------------------------------------------*/
+/* Number of items, drawn in increasing id order (id 0 at the bottom) */
+#define OVERLAY_MAX_ITEMS           16U
+
+/* Number of dirty rectangles tracked between two updates */
+#define OVERLAY_MAX_DIRTY           16U
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Rectangle in overlay coordinates
+  */
+typedef struct
+{
+  uint32_t X;
+  uint32_t Y;
+  uint32_t Width;
+  uint32_t Height;
+} Overlay_RectTypeDef;
+
+/**
+  * @brief  Kind of item
+  */
+typedef enum
+{
+  OVERLAY_ITEM_NONE = 0U,     /*!< Hidden                                            */
+  OVERLAY_ITEM_FILL,          /*!< Filled rectangle, replaces the items below        */
+  OVERLAY_ITEM_FRAME,         /*!< Rectangle outline (bounding box)                  */
+  OVERLAY_ITEM_BITMAP         /*!< Image blended over the items below (text, graphs) */
+} Overlay_ItemKindTypeDef;
+
+/**
+  * @brief  Overlay item
+  */
+typedef struct
+{
+  Overlay_ItemKindTypeDef Kind;
+  Overlay_RectTypeDef     Rect;
+  uint32_t                Color;      /*!< ARGB8888, FILL, FRAME and A8 BITMAP          */
+  uint32_t                Thickness;  /*!< FRAME line width                             */
+  uint32_t                Address;    /*!< BITMAP pixels, Rect.Width pixels per line    */
+  uint32_t                ColorMode;  /*!< BITMAP DMA2D_INPUT_xxx: ARGB8888, RGB888,
+                                           RGB565, ARGB1555, ARGB4444 or A8             */
+} Overlay_ItemTypeDef;
+
+/**
+  * @brief  Overlay configuration
+  */
+typedef struct
+{
+  uint32_t Address;       /*!< Layer buffer, Width * Height pixels                 */
+  uint32_t X;             /*!< Layer window position on the display                */
+  uint32_t Y;
+  uint32_t Width;
+  uint32_t Height;
+  uint32_t PixelFormat;   /*!< LTDC_PIXEL_FORMAT_ARGB4444 or LTDC_PIXEL_FORMAT_ARGB8888 */
+} Overlay_ConfTypeDef;
+
+/**
+  * @brief  Overlay handle
+  */
+typedef struct
+{
+  DMA2D_HandleTypeDef *hdma2d;
+  LTDC_HandleTypeDef  *hltdc;
+  uint32_t            LayerIdx;
+  uint32_t            Address;
+  uint32_t            Width;
+  uint32_t            Height;
+  uint32_t            OutputColorMode;              /*!< DMA2D_OUTPUT_xxx of the layer buffer */
+  uint32_t            InputColorMode;               /*!< Same format as a DMA2D input         */
+  uint32_t            BytesPerPixel;
+  Overlay_ItemTypeDef Item[OVERLAY_MAX_ITEMS];
+  Overlay_RectTypeDef Dirty[OVERLAY_MAX_DIRTY];
+  uint32_t            NbDirty;
+  uint32_t            BlitCount;                    /*!< DMA2D transfers of the last update   */
+  uint32_t            PixelCount;                   /*!< Pixels written by the last update    */
+} Overlay_HandleTypeDef;
+
+/* Exported functions ------------------------------------------------------- */
+HAL_StatusTypeDef Overlay_Init(Overlay_HandleTypeDef *hovl, DMA2D_HandleTypeDef *hdma2d,
+                               LTDC_HandleTypeDef *hltdc, uint32_t LayerIdx, const Overlay_ConfTypeDef *pConf);
+HAL_StatusTypeDef Overlay_SetFill(Overlay_HandleTypeDef *hovl, uint32_t Id, const Overlay_RectTypeDef *pRect,
+                                  uint32_t Color);
+HAL_StatusTypeDef Overlay_SetFrame(Overlay_HandleTypeDef *hovl, uint32_t Id, const Overlay_RectTypeDef *pRect,
+                                   uint32_t Thickness, uint32_t Color);
+HAL_StatusTypeDef Overlay_SetBitmap(Overlay_HandleTypeDef *hovl, uint32_t Id, const Overlay_RectTypeDef *pRect,
+                                    uint32_t Address, uint32_t ColorMode, uint32_t Color);
+HAL_StatusTypeDef Overlay_Touch(Overlay_HandleTypeDef *hovl, uint32_t Id);
+HAL_StatusTypeDef Overlay_Hide(Overlay_HandleTypeDef *hovl, uint32_t Id);
+HAL_StatusTypeDef Overlay_Update(Overlay_HandleTypeDef *hovl);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __OVERLAY_H */
@@ -0,0 +1,76 @@
+/**
+  ******************************************************************************
+  * @file    pipe_roi.h
+  * @brief   Header for pipe_roi.c module: region of interest (pan/zoom) on a
+  *          DCMIPP pixel pipe through its crop and downsize stages.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __PIPE_ROI_H
+#define __PIPE_ROI_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32n6xx_hal.h"
+
+/* Exported constants --------------------------------------------------------*/
+/* Zoom factor unit: PIPE_ROI_ZOOM_1X shows the whole input frame */
+#define PIPE_ROI_ZOOM_1X      256U
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Crop and downsize settings of one region of interest
+  */
+typedef struct
+{
+  DCMIPP_CropConfTypeDef Crop;
+  DCMIPP_DownsizeTypeDef Downsize;
+} PipeRoi_ConfTypeDef;
+
+/**
+  * @brief  Region of interest handle
+  */
+typedef struct
+{
+  DCMIPP_HandleTypeDef *hdcmipp;
+  uint32_t             Pipe;           /*!< PIPE1 or PIPE2 (both have crop and downsize) */
+  uint32_t             InputWidth;     /*!< Frame size entering the pipe                 */
+  uint32_t             InputHeight;
+  uint32_t             OutputWidth;    /*!< Size written to memory                       */
+  uint32_t             OutputHeight;
+  PipeRoi_ConfTypeDef  Current;        /*!< Settings programmed in the pipe              */
+  PipeRoi_ConfTypeDef  Next;           /*!< Settings waiting for the next frame boundary */
+  __IO uint8_t         UpdatePending;
+} PipeRoi_HandleTypeDef;
+
+/* Exported functions ------------------------------------------------------- */
+HAL_StatusTypeDef PipeRoi_Init(PipeRoi_HandleTypeDef *hroi, DCMIPP_HandleTypeDef *hdcmipp, uint32_t Pipe,
+                               uint32_t InputWidth, uint32_t InputHeight,
+                               uint32_t OutputWidth, uint32_t OutputHeight);
+HAL_StatusTypeDef PipeRoi_ComputeConfig(const PipeRoi_HandleTypeDef *hroi, uint32_t X, uint32_t Y,
+                                        uint32_t Width, uint32_t Height, PipeRoi_ConfTypeDef *pConf);
+HAL_StatusTypeDef PipeRoi_SetWindow(PipeRoi_HandleTypeDef *hroi, uint32_t X, uint32_t Y,
+                                    uint32_t Width, uint32_t Height);
+HAL_StatusTypeDef PipeRoi_SetPanZoom(PipeRoi_HandleTypeDef *hroi, uint32_t CenterX, uint32_t CenterY,
+                                     uint32_t Zoom);
+void PipeRoi_VsyncEventHandler(PipeRoi_HandleTypeDef *hroi);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PIPE_ROI_H */
@@ -0,0 +1,86 @@
+/**
+  ******************************************************************************
+  * @file    pipe_slice.h
+  * @brief   Header for pipe_slice.c module: delivery of N-line bands of a
+  *          DCMIPP pixel pipe as soon as they are written to memory.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __PIPE_SLICE_H
+#define __PIPE_SLICE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32n6xx_hal.h"
+#include "frame_ring.h"
+
+/* Exported constants --------------------------------------------------------*/
+/* Depth of the band queue (power of 2) */
+#define PIPE_SLICE_MAX_BANDS        16U
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Band of lines written by the pipe
+  */
+typedef struct
+{
+  uint32_t Address;    /*!< Address of the first line of the band */
+  uint32_t FirstLine;  /*!< Index of the first line in the frame  */
+  uint32_t NbLines;    /*!< Number of lines in the band           */
+  uint32_t FrameId;    /*!< Frame the band belongs to             */
+  uint32_t Seq;        /*!< Band sequence number                  */
+} PipeSlice_BandTypeDef;
+
+/**
+  * @brief  Slice handle
+  */
+typedef struct
+{
+  DCMIPP_HandleTypeDef    *hdcmipp;
+  uint32_t                Pipe;
+  uint32_t                Pitch;          /*!< Bytes per line                                   */
+  uint32_t                Height;         /*!< Lines per frame                                  */
+  uint32_t                LinesPerBand;   /*!< Line event period                                */
+  uint32_t                WrapAddress;    /*!< Line buffer start, 0 in frame mode               */
+  uint32_t                WrapBands;      /*!< Bands held by the line buffer, 0 in frame mode   */
+  FrameRing_HandleTypeDef *hring;         /*!< Frame mode: ring the pipe is writing             */
+  uint32_t                Depth;          /*!< Bands that can be queued before being overwritten*/
+  PipeSlice_BandTypeDef   Band[PIPE_SLICE_MAX_BANDS];
+  __IO uint32_t           Head;           /*!< Bands published (written by the ISR)             */
+  __IO uint32_t           Tail;           /*!< Bands released                                   */
+  __IO uint32_t           Line;           /*!< Lines already published in the current frame     */
+  __IO uint32_t           FrameId;
+  __IO uint32_t           OverrunCount;   /*!< Bands overwritten before being released          */
+} PipeSlice_HandleTypeDef;
+
+/* Exported functions ------------------------------------------------------- */
+HAL_StatusTypeDef PipeSlice_Init(PipeSlice_HandleTypeDef *hslice, FrameRing_HandleTypeDef *hring,
+                                 uint32_t Pitch, uint32_t Height, uint32_t LinesPerBand);
+HAL_StatusTypeDef PipeSlice_InitWrap(PipeSlice_HandleTypeDef *hslice, DCMIPP_HandleTypeDef *hdcmipp,
+                                     uint32_t Pipe, uint32_t Pitch, uint32_t Height,
+                                     uint32_t LinesPerBand, uint32_t WrapAddress, uint32_t WrapLines);
+HAL_StatusTypeDef PipeSlice_Start(PipeSlice_HandleTypeDef *hslice, uint32_t VirtualChannel);
+HAL_StatusTypeDef PipeSlice_GetBand(PipeSlice_HandleTypeDef *hslice, PipeSlice_BandTypeDef *pBand);
+HAL_StatusTypeDef PipeSlice_ReleaseBand(PipeSlice_HandleTypeDef *hslice, const PipeSlice_BandTypeDef *pBand);
+void PipeSlice_LineEventHandler(PipeSlice_HandleTypeDef *hslice);
+void PipeSlice_FrameEventHandler(PipeSlice_HandleTypeDef *hslice);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PIPE_SLICE_H */
@@ -0,0 +1,163 @@
+/**
+  ******************************************************************************
+  * @file    sd_recorder.h
+  * @brief   Header for sd_recorder.c module: frames streamed to a pre-erased
+  *          extent of the SD card through a ring of staging buffers, in an
+  *          append-only container with a frame index.
+  *
+  *          Container layout, in blocks from the extent start:
+  *          - 0: SDRec_HeaderTypeDef, rewritten when the recording stops
+  *          - 1 to IndexBlocks: SDRec_IndexEntryTypeDef per frame, written
+  *            one block at a time as it fills. The list ends on an entry of
+  *            Size 0, or 0xFFFFFFFF on the cards erasing to ones
+  *          - DataBlock onwards: the frames, each one starting on a block
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SD_RECORDER_H
+#define __SD_RECORDER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32n6xx_hal.h"
+
+/* Exported constants --------------------------------------------------------*/
+#define SD_REC_MAGIC                0x43455253U   /* "SREC" */
+#define SD_REC_VERSION              1U
+#define SD_REC_BLOCK_SIZE           512U
+#define SD_REC_MAX_STAGING          4U
+
+/* Frame formats recorded in the header */
+#define SD_REC_FORMAT_RAW10         0U
+#define SD_REC_FORMAT_RGB565        1U
+#define SD_REC_FORMAT_RGB888        2U
+#define SD_REC_FORMAT_JPEG          3U
+
+/* Header NbFrames of a recording not stopped, the index then tells */
+#define SD_REC_NB_FRAMES_OPEN       0xFFFFFFFFU
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Container header, block 0 of the extent
+  */
+typedef struct
+{
+  uint32_t Magic;           /*!< SD_REC_MAGIC                                       */
+  uint32_t Version;         /*!< SD_REC_VERSION                                     */
+  uint32_t Format;          /*!< SD_REC_FORMAT_xxx                                  */
+  uint32_t Width;
+  uint32_t Height;
+  uint32_t IndexBlocks;     /*!< Index blocks, from block 1                         */
+  uint32_t DataBlock;       /*!< First frame block, from the extent start           */
+  uint32_t NbFrames;        /*!< Frames recorded, SD_REC_NB_FRAMES_OPEN if running  */
+  uint32_t DataBlocks;      /*!< Blocks used by the frames                          */
+} SDRec_HeaderTypeDef;
+
+/**
+  * @brief  Frame index entry
+  */
+typedef struct
+{
+  uint32_t Block;           /*!< First block, from the extent start                 */
+  uint32_t Size;            /*!< Frame size in bytes, padded to a block on the card */
+  uint32_t FrameId;         /*!< Capture frame number                               */
+  uint32_t Timestamp;       /*!< HAL tick of the frame submission                   */
+} SDRec_IndexEntryTypeDef;
+
+#define SD_REC_INDEX_PER_BLOCK      (SD_REC_BLOCK_SIZE / sizeof(SDRec_IndexEntryTypeDef))
+
+/**
+  * @brief  Recorder configuration
+  */
+typedef struct
+{
+  uint32_t Instance;        /*!< BSP SD instance                                     */
+  uint32_t StartBlock;      /*!< Extent reserved on the card, erased at start        */
+  uint32_t NbBlocks;
+  uint32_t MaxFrames;       /*!< Index capacity                                      */
+  uint32_t StagingAddress;  /*!< NbStaging buffers of StagingSize, 32 bytes aligned  */
+  uint32_t StagingSize;     /*!< Bytes per write command, multiple of the block size */
+  uint32_t NbStaging;       /*!< 2 (ping-pong) to SD_REC_MAX_STAGING                 */
+} SDRec_ConfTypeDef;
+
+/**
+  * @brief  Recorder statistics
+  */
+typedef struct
+{
+  uint32_t FrameCount;      /*!< Frames written                                      */
+  uint32_t DropCount;       /*!< Frames refused: recorder busy or extent full        */
+  uint32_t KBytesPerSec;    /*!< Frame data written per second of write commands     */
+  uint32_t WorstWriteUs;    /*!< Longest write command, card programming included    */
+  uint32_t WorstStallUs;    /*!< Longest wait of a full staging buffer for the card  */
+} SDRec_StatsTypeDef;
+
+/**
+  * @brief  Recorder handle
+  */
+typedef struct
+{
+  SDRec_ConfTypeDef        Conf;
+  SDRec_HeaderTypeDef      Header;
+  uint8_t                  State;          /*!< Recording started                             */
+  __IO uint8_t             Error;          /*!< Card error, the recording is aborted          */
+  /* Staging ring: filled by the CPU at Head, written to the card from Tail */
+  uint32_t                 Head;
+  uint32_t                 Tail;
+  uint32_t                 FillOffset;     /*!< Bytes copied in the buffer at Head            */
+  uint32_t                 NextBlock;      /*!< Card block of the buffer at Head              */
+  uint32_t                 Block[SD_REC_MAX_STAGING];   /*!< Card block of each buffer        */
+  uint32_t                 Blocks[SD_REC_MAX_STAGING];  /*!< Blocks to write of each buffer   */
+  uint32_t                 ReadyCycles[SD_REC_MAX_STAGING]; /*!< Buffer queued, DWT cycles    */
+  /* Card write in progress */
+  __IO uint8_t             DmaBusy;        /*!< Cleared by the write complete callback        */
+  uint8_t                  Writing;        /*!< Waiting for the card to program the data      */
+  uint8_t                  WritingIndex;   /*!< The write in progress is an index block       */
+  uint32_t                 WriteCycles;    /*!< Write command start, DWT cycles               */
+  /* Frame being copied to the staging ring */
+  const uint8_t            *pFrame;
+  uint32_t                 FrameSize;
+  uint32_t                 FrameCopied;
+  /* Index block being filled and the last full one, waiting to be written */
+  SDRec_IndexEntryTypeDef  Entry;          /*!< Frame being copied                            */
+  SDRec_IndexEntryTypeDef  Index[SD_REC_INDEX_PER_BLOCK];
+  SDRec_IndexEntryTypeDef  IndexPending[SD_REC_INDEX_PER_BLOCK] __ALIGNED(32);  /*!< DMA source */
+  uint32_t                 IndexPendingBlock;  /*!< 0 when no index block is waiting          */
+  uint32_t                 FrameCount;
+  __IO uint32_t            DropCount;
+  uint64_t                 BytesWritten;
+  uint64_t                 DataWriteCycles;  /*!< Time spent in frame data write commands    */
+  uint32_t                 WorstWriteCycles;
+  uint32_t                 WorstStallCycles;
+} SDRec_HandleTypeDef;
+
+/* Exported functions ------------------------------------------------------- */
+HAL_StatusTypeDef SDRec_Init(SDRec_HandleTypeDef *hrec, const SDRec_ConfTypeDef *pConf);
+HAL_StatusTypeDef SDRec_Start(SDRec_HandleTypeDef *hrec, uint32_t Format, uint32_t Width, uint32_t Height);
+HAL_StatusTypeDef SDRec_Stop(SDRec_HandleTypeDef *hrec);
+HAL_StatusTypeDef SDRec_WriteFrame(SDRec_HandleTypeDef *hrec, uint32_t Address, uint32_t Size, uint32_t FrameId);
+uint8_t SDRec_IsReady(const SDRec_HandleTypeDef *hrec);
+void SDRec_Process(SDRec_HandleTypeDef *hrec);
+void SDRec_GetStats(const SDRec_HandleTypeDef *hrec, SDRec_StatsTypeDef *pStats);
+void SDRec_WriteCpltHandler(SDRec_HandleTypeDef *hrec);
+void SDRec_ErrorHandler(SDRec_HandleTypeDef *hrec);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SD_RECORDER_H */
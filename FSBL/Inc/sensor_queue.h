@@ -0,0 +1,101 @@
+/**
+  ******************************************************************************
+  * @file    sensor_queue.h
+  * @brief   Header for sensor_queue.c module: sensor register writes queued
+  *          by the background and sent by interrupt driven I2C transfers at
+  *          the start of frame, wrapped in a sensor group hold.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __SENSOR_QUEUE_H
+#define __SENSOR_QUEUE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32n6xx_hal.h"
+
+/* Exported constants --------------------------------------------------------*/
+/* Register writes of one group, hold start/end and launch not included */
+#define SENSOR_QUEUE_MAX_WRITES     8U
+
+/* Bytes of one register write (auto-incremented register address) */
+#define SENSOR_QUEUE_MAX_LENGTH     4U
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  One register write, burst on consecutive registers
+  */
+typedef struct
+{
+  uint16_t Reg;
+  uint16_t Length;
+  uint8_t  Data[SENSOR_QUEUE_MAX_LENGTH];
+} SensorQueue_WriteTypeDef;
+
+/**
+  * @brief  Group of writes latched by the sensor on the same frame
+  */
+typedef struct
+{
+  SensorQueue_WriteTypeDef Write[SENSOR_QUEUE_MAX_WRITES + 3U];
+  uint32_t                 NbWrites;
+} SensorQueue_GroupTypeDef;
+
+/**
+  * @brief  Sensor queue configuration
+  */
+typedef struct
+{
+  I2C_HandleTypeDef *hi2c;        /*!< Bus, event and error interrupts enabled       */
+  uint16_t          DevAddr;      /*!< 8-bit sensor address                          */
+  uint16_t          HoldReg;      /*!< Group hold register                           */
+  uint8_t           HoldStart;    /*!< HoldReg values: start and end of the group,   */
+  uint8_t           HoldEnd;      /*!<   then launch at the next frame boundary      */
+  uint8_t           Launch;
+} SensorQueue_ConfTypeDef;
+
+/**
+  * @brief  Sensor queue handle
+  */
+typedef struct
+{
+  SensorQueue_ConfTypeDef  Conf;
+  SensorQueue_GroupTypeDef Next;          /*!< Filled by the background                 */
+  SensorQueue_GroupTypeDef Active;        /*!< Being sent by the I2C interrupts         */
+  __IO uint32_t            Step;          /*!< Write of Active in progress              */
+  __IO uint8_t             Busy;          /*!< Active group in progress                 */
+  __IO uint8_t             Open;          /*!< Next group being built, not sent yet     */
+  __IO uint32_t            GroupCount;    /*!< Groups applied                           */
+  __IO uint32_t            DeferCount;    /*!< Start of frames with the group deferred  */
+  __IO uint32_t            ErrorCount;    /*!< Groups aborted on a bus error            */
+} SensorQueue_HandleTypeDef;
+
+/* Exported functions ------------------------------------------------------- */
+HAL_StatusTypeDef SensorQueue_Init(SensorQueue_HandleTypeDef *hqueue, const SensorQueue_ConfTypeDef *pConf);
+HAL_StatusTypeDef SensorQueue_Write(SensorQueue_HandleTypeDef *hqueue, uint16_t Reg, const uint8_t *pData,
+                                    uint32_t Length);
+void SensorQueue_BeginGroup(SensorQueue_HandleTypeDef *hqueue);
+void SensorQueue_EndGroup(SensorQueue_HandleTypeDef *hqueue);
+void SensorQueue_StartOfFrameHandler(SensorQueue_HandleTypeDef *hqueue);
+void SensorQueue_TxCpltHandler(SensorQueue_HandleTypeDef *hqueue);
+void SensorQueue_ErrorHandler(SensorQueue_HandleTypeDef *hqueue);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SENSOR_QUEUE_H */
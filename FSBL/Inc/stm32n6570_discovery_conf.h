@@ -62,6 +62,10 @@ extern "C" {
 /* Default Audio IN internal buffer size */
 #define DEFAULT_AUDIO_IN_BUFFER_SIZE        2048U
 
+/* Camera bus (I2C1) clock: 100000U, 400000U or 1000000U (Fast-mode Plus, for
+   the sensors rated for it, the OV5647 SCCB is specified up to 400 kHz) */
+#define BUS_I2C1_FREQUENCY                  400000U
+
 /* IRQ priorities (Default is 15 as lowest priority level) */
 #define BSP_BUTTON_USER1_IT_PRIORITY        15U
 #define BSP_BUTTON_USER2_IT_PRIORITY        15U
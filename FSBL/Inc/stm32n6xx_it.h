@@ -59,6 +59,10 @@ void SysTick_Handler(void);
 /* USER CODE BEGIN EFP */
 void CSI_IRQHandler(void);
 void DCMIPP_IRQHandler(void);
+void LTDC_LO_IRQHandler(void);
+void JPEG_IRQHandler(void);
+void HPDMA1_Channel0_IRQHandler(void);
+void HPDMA1_Channel1_IRQHandler(void);
 /* USER CODE END EFP */
 
 #ifdef __cplusplus
@@ -0,0 +1,105 @@
+/**
+  ******************************************************************************
+  * @file    touch_meter.h
+  * @brief   Header for touch_meter.c module: AEC/AWB metering spot moved by
+  *          a tap on the preview.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __TOUCH_METER_H
+#define __TOUCH_METER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32n6xx_hal.h"
+#include "isp_api.h"
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Display to sensor transform of the previewed pipe
+  */
+typedef struct
+{
+  uint32_t DisplayX;        /*!< Video window on the display, pipe output 1:1     */
+  uint32_t DisplayY;
+  uint32_t DisplayWidth;
+  uint32_t DisplayHeight;
+  uint32_t CropX;           /*!< Pipe crop window, downsized to the video window  */
+  uint32_t CropY;
+  uint32_t CropWidth;
+  uint32_t CropHeight;
+  uint32_t Decimation;      /*!< ISP decimation factor before the crop            */
+  uint32_t SensorWidth;     /*!< Sensor frame, referential of the statistic area  */
+  uint32_t SensorHeight;
+} TouchMeter_MapTypeDef;
+
+/**
+  * @brief  Rectangle on the display
+  */
+typedef struct
+{
+  uint32_t X;
+  uint32_t Y;
+  uint32_t Width;
+  uint32_t Height;
+} TouchMeter_RectTypeDef;
+
+/**
+  * @brief  Touch metering configuration
+  */
+typedef struct
+{
+  uint32_t Instance;        /*!< BSP TS instance, initialized by the caller       */
+  uint32_t SpotWidth;       /*!< Metering spot size on the display                */
+  uint32_t SpotHeight;
+  uint32_t PollPeriod;      /*!< Touch panel poll period, in ms                   */
+} TouchMeter_ConfTypeDef;
+
+/**
+  * @brief  Touch metering handle
+  */
+typedef struct
+{
+  ISP_HandleTypeDef      *hIsp;
+  TouchMeter_ConfTypeDef Conf;
+  TouchMeter_MapTypeDef  Map;
+  TouchMeter_RectTypeDef Spot;           /*!< Metered area, on the display             */
+  uint32_t               LastPollTick;
+  uint8_t                Touched;        /*!< Panel touched at the last poll           */
+  uint32_t               TapCount;       /*!< Taps metered                             */
+  uint32_t               ErrorCount;     /*!< Taps refused by the ISP                  */
+} TouchMeter_HandleTypeDef;
+
+/* Exported functions ------------------------------------------------------- */
+HAL_StatusTypeDef TouchMeter_Init(TouchMeter_HandleTypeDef *hmeter, ISP_HandleTypeDef *hIsp,
+                                  const TouchMeter_ConfTypeDef *pConf, const TouchMeter_MapTypeDef *pMap);
+HAL_StatusTypeDef TouchMeter_SetMap(TouchMeter_HandleTypeDef *hmeter, const TouchMeter_MapTypeDef *pMap);
+HAL_StatusTypeDef TouchMeter_MeterAt(TouchMeter_HandleTypeDef *hmeter, uint32_t X, uint32_t Y);
+uint8_t TouchMeter_Process(TouchMeter_HandleTypeDef *hmeter);
+/* Transforms, without hardware access */
+HAL_StatusTypeDef TouchMeter_MapPoint(const TouchMeter_MapTypeDef *pMap, uint32_t X, uint32_t Y,
+                                      uint32_t *pSensorX, uint32_t *pSensorY);
+HAL_StatusTypeDef TouchMeter_ComputeArea(const TouchMeter_MapTypeDef *pMap, uint32_t X, uint32_t Y,
+                                         uint32_t Width, uint32_t Height, ISP_StatAreaTypeDef *pArea);
+void TouchMeter_AreaToDisplay(const TouchMeter_MapTypeDef *pMap, const ISP_StatAreaTypeDef *pArea,
+                              TouchMeter_RectTypeDef *pRect);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TOUCH_METER_H */
@@ -0,0 +1,409 @@
+/**
+  ******************************************************************************
+  * @file    capture_graph.c
+  * @brief   Configuration of the DCMIPP pixel pipes fed by the CSI receiver.
+  *
+  *          PIPE1 and PIPE2 both process the frame received on the CSI
+  *          virtual channel: PIPE2 is put in share mode so that it takes the
+  *          PIPE1 input instead of its own CSI data type selection. Each pipe
+  *          then has its own crop/downsize (region of interest), output
+  *          format and buffer ring, e.g. PIPE1 feeding the LTDC while PIPE2
+  *          writes a small RGB frame for an inference engine. The scaling is
+  *          done by the DCMIPP, no CPU resize is needed.
+  *
+  *          A pipe may also deliver N-line bands of the frame being captured
+  *          (see pipe_slice.c) to consumers that do not need to wait for the
+  *          whole frame, or write into a wrapping line buffer only, for
+  *          consumers that never need a whole frame in memory.
+  *
+  *          YUV output formats are produced by the PIPE1 RGB to YUV
+  *          conversion stage (full range BT.601), PIPE2 has no such stage.
+  *
+  *          The DCMIPP and LTDC event callbacks are forwarded to the graph,
+  *          which dispatches them to the ring and region of interest of the
+  *          pipe concerned.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "capture_graph.h"
+
+/* Private define ------------------------------------------------------------*/
+/* Pixel pipe pitch must be a multiple of 16 bytes */
+#define CAPTURE_GRAPH_PITCH_ALIGN   16U
+
+/* Private constants ---------------------------------------------------------*/
+/* RGB to full range BT.601 YCbCr, coefficients in 1/256 units: the R, G and B
+ * outputs of the stage carry Cr, Y and Cb */
+static const DCMIPP_ColorConversionConfTypeDef CaptureGraph_RgbToYuv =
+{
+  .ClampOutputSamples = DISABLE,
+  .OutputSamplesType  = DCMIPP_CLAMP_YUV,
+  .RR = 128, .RG = -107, .RB = -21, .RA = 128,
+  .GR = 77,  .GG = 150,  .GB = 29,  .GA = 0,
+  .BR = -43, .BG = -85,  .BB = 128, .BA = 128,
+};
+
+/* Private function prototypes -----------------------------------------------*/
+static uint8_t CaptureGraph_IsYuvFormat(uint32_t PixelPackerFormat);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Initialize an empty capture graph
+  * @param  hgraph       Graph handle
+  * @param  hdcmipp      DCMIPP handle, CSI and PIPE1 CSI data type already configured
+  * @param  InputWidth   Width of the frame received from the sensor
+  * @param  InputHeight  Height of the frame received from the sensor
+  * @retval HAL status
+  */
+HAL_StatusTypeDef CaptureGraph_Init(CaptureGraph_HandleTypeDef *hgraph, DCMIPP_HandleTypeDef *hdcmipp,
+                                    uint32_t InputWidth, uint32_t InputHeight)
+{
+  uint32_t i;
+
+  if ((hgraph == NULL) || (hdcmipp == NULL))
+  {
+    return HAL_ERROR;
+  }
+
+  hgraph->hdcmipp     = hdcmipp;
+  hgraph->InputWidth  = InputWidth;
+  hgraph->InputHeight = InputHeight;
+
+  for (i = 0; i < DCMIPP_NUM_OF_PIPES; i++)
+  {
+    hgraph->Pipe[i].Slice = NULL;
+    hgraph->Pipe[i].FrameReadyCallback = NULL;
+    hgraph->Pipe[i].HasRing = 0;
+    hgraph->Pipe[i].Enabled = 0;
+  }
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Configure the output of one pixel pipe and its buffer ring
+  * @note   To be called before CaptureGraph_Start(). The pipe region of
+  *         interest is initialized to the whole input frame. Without buffer
+  *         (NbBuffers 0) the pipe must then be given a line buffer with
+  *         CaptureGraph_AttachWrapSlice().
+  * @param  hgraph  Graph handle
+  * @param  pConf   Pipe output configuration
+  * @retval HAL status
+  */
+HAL_StatusTypeDef CaptureGraph_ConfigPipe(CaptureGraph_HandleTypeDef *hgraph,
+                                          const CaptureGraph_PipeConfTypeDef *pConf)
+{
+  DCMIPP_PipeConfTypeDef pipe_conf = {0};
+  CaptureGraph_PipeTypeDef *pipe;
+
+  if ((pConf == NULL) || ((pConf->Pipe != DCMIPP_PIPE1) && (pConf->Pipe != DCMIPP_PIPE2)))
+  {
+    return HAL_ERROR;
+  }
+
+  pipe_conf.FrameRate         = DCMIPP_FRAME_RATE_ALL;
+  pipe_conf.PixelPackerFormat = pConf->PixelPackerFormat;
+  pipe_conf.PixelPipePitch    = pConf->Width * pConf->BytesPerPixel;
+  if ((pipe_conf.PixelPipePitch % CAPTURE_GRAPH_PITCH_ALIGN) != 0U)
+  {
+    return HAL_ERROR;
+  }
+
+  if (CaptureGraph_IsYuvFormat(pConf->PixelPackerFormat) != 0U)
+  {
+    if (pConf->Pipe != DCMIPP_PIPE1)
+    {
+      return HAL_ERROR;
+    }
+    if (HAL_DCMIPP_PIPE_SetYUVConversionConfig(hgraph->hdcmipp, pConf->Pipe, &CaptureGraph_RgbToYuv) != HAL_OK)
+    {
+      return HAL_ERROR;
+    }
+    if (HAL_DCMIPP_PIPE_EnableYUVConversion(hgraph->hdcmipp, pConf->Pipe) != HAL_OK)
+    {
+      return HAL_ERROR;
+    }
+  }
+
+  if (pConf->Pipe == DCMIPP_PIPE2)
+  {
+    /* PIPE2 processes the same CSI stream as PIPE1 */
+    if (HAL_DCMIPP_PIPE_CSI_EnableShare(hgraph->hdcmipp, DCMIPP_PIPE2) != HAL_OK)
+    {
+      return HAL_ERROR;
+    }
+  }
+
+  if (HAL_DCMIPP_PIPE_SetConfig(hgraph->hdcmipp, pConf->Pipe, &pipe_conf) != HAL_OK)
+  {
+    return HAL_ERROR;
+  }
+
+  pipe = &hgraph->Pipe[pConf->Pipe];
+  if (PipeRoi_Init(&pipe->Roi, hgraph->hdcmipp, pConf->Pipe, hgraph->InputWidth, hgraph->InputHeight,
+                   pConf->Width, pConf->Height) != HAL_OK)
+  {
+    return HAL_ERROR;
+  }
+  if ((pConf->NbBuffers != 0U) &&
+      (FrameRing_Init(&pipe->Ring, hgraph->hdcmipp, pConf->hltdc, pConf->Pipe, pConf->LayerIdx,
+                      pConf->pAddress, pConf->NbBuffers) != HAL_OK))
+  {
+    return HAL_ERROR;
+  }
+
+  pipe->Slice              = NULL;
+  pipe->FrameReadyCallback = pConf->FrameReadyCallback;
+  pipe->Pitch              = pipe_conf.PixelPipePitch;
+  pipe->Height             = pConf->Height;
+  pipe->HasRing            = (pConf->NbBuffers != 0U) ? 1U : 0U;
+  pipe->Enabled            = 1;
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Deliver the frames of a configured pipe as bands of lines
+  * @note   To be called before CaptureGraph_Start()
+  * @param  hgraph        Graph handle
+  * @param  Pipe          DCMIPP pipe
+  * @param  hslice        Slice handle
+  * @param  LinesPerBand  Band height, power of 2 from 1 to 128
+  * @retval HAL status
+  */
+HAL_StatusTypeDef CaptureGraph_AttachSlice(CaptureGraph_HandleTypeDef *hgraph, uint32_t Pipe,
+                                          PipeSlice_HandleTypeDef *hslice, uint32_t LinesPerBand)
+{
+  CaptureGraph_PipeTypeDef *pipe;
+
+  if ((Pipe >= DCMIPP_NUM_OF_PIPES) || (hgraph->Pipe[Pipe].Enabled == 0U) ||
+      (hgraph->Pipe[Pipe].HasRing == 0U))
+  {
+    return HAL_ERROR;
+  }
+
+  pipe = &hgraph->Pipe[Pipe];
+  if (PipeSlice_Init(hslice, &pipe->Ring, pipe->Pitch, pipe->Height, LinesPerBand) != HAL_OK)
+  {
+    return HAL_ERROR;
+  }
+  pipe->Slice = hslice;
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Deliver the frames of a pipe configured without buffer as bands of
+  *         a wrapping line buffer
+  * @note   To be called before CaptureGraph_Start()
+  * @param  hgraph        Graph handle
+  * @param  Pipe          DCMIPP pipe
+  * @param  hslice        Slice handle
+  * @param  LinesPerBand  Band height, power of 2 from 1 to 128
+  * @param  WrapAddress   Line buffer start address, 16 bytes aligned
+  * @param  WrapLines     Line buffer height, power of 2 up to 128, at least
+  *                       twice LinesPerBand
+  * @retval HAL status
+  */
+HAL_StatusTypeDef CaptureGraph_AttachWrapSlice(CaptureGraph_HandleTypeDef *hgraph, uint32_t Pipe,
+                                               PipeSlice_HandleTypeDef *hslice, uint32_t LinesPerBand,
+                                               uint32_t WrapAddress, uint32_t WrapLines)
+{
+  CaptureGraph_PipeTypeDef *pipe;
+
+  if ((Pipe >= DCMIPP_NUM_OF_PIPES) || (hgraph->Pipe[Pipe].Enabled == 0U) ||
+      (hgraph->Pipe[Pipe].HasRing != 0U))
+  {
+    return HAL_ERROR;
+  }
+
+  pipe = &hgraph->Pipe[Pipe];
+  if (PipeSlice_InitWrap(hslice, hgraph->hdcmipp, Pipe, pipe->Pitch, pipe->Height, LinesPerBand,
+                         WrapAddress, WrapLines) != HAL_OK)
+  {
+    return HAL_ERROR;
+  }
+  pipe->Slice = hslice;
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Start the capture on all configured pipes
+  * @param  hgraph          Graph handle
+  * @param  VirtualChannel  CSI virtual channel carrying the sensor frames
+  * @retval HAL status
+  */
+HAL_StatusTypeDef CaptureGraph_Start(CaptureGraph_HandleTypeDef *hgraph, uint32_t VirtualChannel)
+{
+  uint32_t i;
+
+  for (i = 0; i < DCMIPP_NUM_OF_PIPES; i++)
+  {
+    if (hgraph->Pipe[i].Enabled == 0U)
+    {
+      continue;
+    }
+    if (hgraph->Pipe[i].HasRing != 0U)
+    {
+      if (FrameRing_Start(&hgraph->Pipe[i].Ring, VirtualChannel) != HAL_OK)
+      {
+        return HAL_ERROR;
+      }
+    }
+    else if ((hgraph->Pipe[i].Slice == NULL) ||
+             (PipeSlice_Start(hgraph->Pipe[i].Slice, VirtualChannel) != HAL_OK))
+    {
+      return HAL_ERROR;
+    }
+  }
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Get the buffer ring of a pipe
+  * @param  hgraph  Graph handle
+  * @param  Pipe    DCMIPP pipe
+  * @retval Ring handle, NULL if the pipe is not configured or has no ring
+  */
+FrameRing_HandleTypeDef *CaptureGraph_GetRing(CaptureGraph_HandleTypeDef *hgraph, uint32_t Pipe)
+{
+  if ((Pipe >= DCMIPP_NUM_OF_PIPES) || (hgraph->Pipe[Pipe].HasRing == 0U))
+  {
+    return NULL;
+  }
+
+  return &hgraph->Pipe[Pipe].Ring;
+}
+
+/**
+  * @brief  Get the region of interest of a pipe
+  * @param  hgraph  Graph handle
+  * @param  Pipe    DCMIPP pipe
+  * @retval ROI handle, NULL if the pipe is not configured
+  */
+PipeRoi_HandleTypeDef *CaptureGraph_GetRoi(CaptureGraph_HandleTypeDef *hgraph, uint32_t Pipe)
+{
+  if ((Pipe >= DCMIPP_NUM_OF_PIPES) || (hgraph->Pipe[Pipe].Enabled == 0U))
+  {
+    return NULL;
+  }
+
+  return &hgraph->Pipe[Pipe].Roi;
+}
+
+/**
+  * @brief  To be called from HAL_DCMIPP_PIPE_FrameEventCallback()
+  * @param  hgraph  Graph handle
+  * @param  Pipe    Pipe receiving the event
+  * @retval None
+  */
+void CaptureGraph_FrameEventHandler(CaptureGraph_HandleTypeDef *hgraph, uint32_t Pipe)
+{
+  CaptureGraph_PipeTypeDef *pipe;
+
+  if ((Pipe >= DCMIPP_NUM_OF_PIPES) || (hgraph->Pipe[Pipe].Enabled == 0U))
+  {
+    return;
+  }
+
+  pipe = &hgraph->Pipe[Pipe];
+  if (pipe->Slice != NULL)
+  {
+    /* Flush the last band while the ring still points to the completed buffer */
+    PipeSlice_FrameEventHandler(pipe->Slice);
+  }
+  if (pipe->HasRing == 0U)
+  {
+    return;
+  }
+  FrameRing_FrameEventHandler(&pipe->Ring);
+
+  if ((pipe->FrameReadyCallback != NULL) && (pipe->Ring.Ready != FRAME_RING_NO_BUFFER))
+  {
+    pipe->FrameReadyCallback(hgraph, Pipe);
+  }
+}
+
+/**
+  * @brief  To be called from HAL_DCMIPP_PIPE_LineEventCallback()
+  * @param  hgraph  Graph handle
+  * @param  Pipe    Pipe receiving the event
+  * @retval None
+  */
+void CaptureGraph_LineEventHandler(CaptureGraph_HandleTypeDef *hgraph, uint32_t Pipe)
+{
+  if ((Pipe >= DCMIPP_NUM_OF_PIPES) || (hgraph->Pipe[Pipe].Slice == NULL))
+  {
+    return;
+  }
+
+  PipeSlice_LineEventHandler(hgraph->Pipe[Pipe].Slice);
+}
+
+/**
+  * @brief  To be called from HAL_DCMIPP_PIPE_VsyncEventCallback()
+  * @param  hgraph  Graph handle
+  * @param  Pipe    Pipe receiving the event
+  * @retval None
+  */
+void CaptureGraph_VsyncEventHandler(CaptureGraph_HandleTypeDef *hgraph, uint32_t Pipe)
+{
+  if ((Pipe >= DCMIPP_NUM_OF_PIPES) || (hgraph->Pipe[Pipe].Enabled == 0U))
+  {
+    return;
+  }
+
+  PipeRoi_VsyncEventHandler(&hgraph->Pipe[Pipe].Roi);
+}
+
+/**
+  * @brief  To be called from HAL_LTDC_ReloadEventCallback()
+  * @param  hgraph  Graph handle
+  * @retval None
+  */
+void CaptureGraph_ReloadEventHandler(CaptureGraph_HandleTypeDef *hgraph)
+{
+  uint32_t i;
+
+  for (i = 0; i < DCMIPP_NUM_OF_PIPES; i++)
+  {
+    if ((hgraph->Pipe[i].HasRing != 0U) && (hgraph->Pipe[i].Ring.hltdc != NULL))
+    {
+      FrameRing_ReloadEventHandler(&hgraph->Pipe[i].Ring);
+    }
+  }
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  Check whether a pixel packer format holds YUV samples
+  * @retval 1 for a YUV format, 0 otherwise
+  */
+static uint8_t CaptureGraph_IsYuvFormat(uint32_t PixelPackerFormat)
+{
+  switch (PixelPackerFormat)
+  {
+    case DCMIPP_PIXEL_PACKER_FORMAT_YUV444_1:
+    case DCMIPP_PIXEL_PACKER_FORMAT_YUV422_1:
+    case DCMIPP_PIXEL_PACKER_FORMAT_YUV422_2:
+    case DCMIPP_PIXEL_PACKER_FORMAT_YUV420_2:
+    case DCMIPP_PIXEL_PACKER_FORMAT_YUV420_3:
+    case DCMIPP_PIXEL_PACKER_FORMAT_YUV422_1_UYVY:
+      return 1;
+    default:
+      return 0;
+  }
+}
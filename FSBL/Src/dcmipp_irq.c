@@ -0,0 +1,533 @@
+/**
+  ******************************************************************************
+  * @file    dcmipp_irq.c
+  * @brief   DCMIPP and CSI interrupt dispatch for the capture hot path.
+  *
+  *          HAL_DCMIPP_IRQHandler() and HAL_DCMIPP_CSI_IRQHandler() test
+  *          every source of the peripheral on each interrupt. The dispatcher
+  *          is configured once with the events the application uses and
+  *          builds a table of them, in the HAL handler order, each entry
+  *          holding its flag and handler. An interrupt then walks the table
+  *          only until the pending served events are handled.
+  *
+  *          Each event is handled as the HAL does it (snapshot mode end,
+  *          flag clear, HAL callback). The error sources are always in the
+  *          tables, at their HAL position, so that the callbacks come in the
+  *          same order. An interrupt with a source out of the tables, a CSI
+  *          D-PHY error or an event enabled but not configured, is served
+  *          by the HAL handler as a whole.
+  *
+  *          The STM32CubeIDE linker script places the dispatcher, the
+  *          callbacks of the served events and the frame swap and trace
+  *          handlers they call in the ITCM.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "dcmipp_irq.h"
+#include <string.h>
+
+/* Private types -------------------------------------------------------------*/
+typedef enum
+{
+  DCMIPP_IRQ_PIPE_FRAME,
+  DCMIPP_IRQ_PIPE_VSYNC,
+  DCMIPP_IRQ_PIPE_LINE,
+  DCMIPP_IRQ_PIPE_LIMIT,
+  DCMIPP_IRQ_PIPE_OVR,
+  DCMIPP_IRQ_ERROR,
+  DCMIPP_IRQ_CSI_CCFIFO,
+  DCMIPP_IRQ_CSI_LB,
+  DCMIPP_IRQ_CSI_EOF,
+  DCMIPP_IRQ_CSI_SOF,
+  DCMIPP_IRQ_CSI_TIM,
+  DCMIPP_IRQ_CSI_ERROR,
+} DcmippIrq_EventTypeDef;
+
+typedef struct
+{
+  uint32_t               Flag;
+  DcmippIrq_EventTypeDef Event;
+  uint32_t               Param;       /*!< Callback parameter */
+  uint32_t               ErrorCode;
+} DcmippIrq_SourceTypeDef;
+
+/* Private constants ---------------------------------------------------------*/
+/* Sources in the order of HAL_DCMIPP_IRQHandler() */
+static const DcmippIrq_SourceTypeDef DcmippIrq_PipeSource[DCMIPP_IRQ_MAX_PIPE_ENTRIES] =
+{
+  {DCMIPP_FLAG_PIPE0_LIMIT,          DCMIPP_IRQ_PIPE_LIMIT, DCMIPP_PIPE0, HAL_DCMIPP_ERROR_PIPE0_LIMIT},
+  {DCMIPP_FLAG_PIPE0_VSYNC,          DCMIPP_IRQ_PIPE_VSYNC, DCMIPP_PIPE0, 0},
+  {DCMIPP_FLAG_PIPE0_FRAME,          DCMIPP_IRQ_PIPE_FRAME, DCMIPP_PIPE0, 0},
+  {DCMIPP_FLAG_PIPE0_LINE,           DCMIPP_IRQ_PIPE_LINE,  DCMIPP_PIPE0, 0},
+  {DCMIPP_FLAG_PIPE0_OVR,            DCMIPP_IRQ_PIPE_OVR,   DCMIPP_PIPE0, HAL_DCMIPP_ERROR_PIPE0_OVR},
+  {DCMIPP_FLAG_PIPE1_LINE,           DCMIPP_IRQ_PIPE_LINE,  DCMIPP_PIPE1, 0},
+  {DCMIPP_FLAG_PIPE1_VSYNC,          DCMIPP_IRQ_PIPE_VSYNC, DCMIPP_PIPE1, 0},
+  {DCMIPP_FLAG_PIPE1_FRAME,          DCMIPP_IRQ_PIPE_FRAME, DCMIPP_PIPE1, 0},
+  {DCMIPP_FLAG_PIPE1_OVR,            DCMIPP_IRQ_PIPE_OVR,   DCMIPP_PIPE1, HAL_DCMIPP_ERROR_PIPE1_OVR},
+  {DCMIPP_FLAG_PIPE2_LINE,           DCMIPP_IRQ_PIPE_LINE,  DCMIPP_PIPE2, 0},
+  {DCMIPP_FLAG_PIPE2_VSYNC,          DCMIPP_IRQ_PIPE_VSYNC, DCMIPP_PIPE2, 0},
+  {DCMIPP_FLAG_PIPE2_FRAME,          DCMIPP_IRQ_PIPE_FRAME, DCMIPP_PIPE2, 0},
+  {DCMIPP_FLAG_PIPE2_OVR,            DCMIPP_IRQ_PIPE_OVR,   DCMIPP_PIPE2, HAL_DCMIPP_ERROR_PIPE2_OVR},
+  {DCMIPP_FLAG_PARALLEL_SYNC_ERROR,  DCMIPP_IRQ_ERROR,      0,            HAL_DCMIPP_ERROR_PARALLEL_SYNC},
+  {DCMIPP_FLAG_AXI_TRANSFER_ERROR,   DCMIPP_IRQ_ERROR,      0,            HAL_DCMIPP_ERROR_AXI_TRANSFER},
+};
+
+/* Interrupts of a pipe disabled when its snapshot capture ends */
+static const uint32_t DcmippIrq_SnapshotIt[DCMIPP_NUM_OF_PIPES] =
+{
+  DCMIPP_IT_PIPE0_FRAME | DCMIPP_IT_PIPE0_VSYNC | DCMIPP_IT_PIPE0_OVR,
+  DCMIPP_IT_PIPE1_FRAME | DCMIPP_IT_PIPE1_VSYNC | DCMIPP_IT_PIPE1_OVR,
+  DCMIPP_IT_PIPE2_FRAME | DCMIPP_IT_PIPE2_VSYNC | DCMIPP_IT_PIPE2_OVR,
+};
+
+/* SR0 sources in the order of HAL_DCMIPP_CSI_IRQHandler() */
+static const DcmippIrq_SourceTypeDef DcmippIrq_CsiSource[DCMIPP_IRQ_MAX_CSI_ENTRIES] =
+{
+  {DCMIPP_CSI_FLAG_CCFIFO,  DCMIPP_IRQ_CSI_CCFIFO, 0,                       0},
+  {DCMIPP_CSI_FLAG_LB3,     DCMIPP_IRQ_CSI_LB,     DCMIPP_CSI_COUNTER3,     0},
+  {DCMIPP_CSI_FLAG_LB2,     DCMIPP_IRQ_CSI_LB,     DCMIPP_CSI_COUNTER2,     0},
+  {DCMIPP_CSI_FLAG_LB1,     DCMIPP_IRQ_CSI_LB,     DCMIPP_CSI_COUNTER1,     0},
+  {DCMIPP_CSI_FLAG_LB0,     DCMIPP_IRQ_CSI_LB,     DCMIPP_CSI_COUNTER0,     0},
+  {DCMIPP_CSI_FLAG_EOF3,    DCMIPP_IRQ_CSI_EOF,    DCMIPP_VIRTUAL_CHANNEL3, 0},
+  {DCMIPP_CSI_FLAG_EOF2,    DCMIPP_IRQ_CSI_EOF,    DCMIPP_VIRTUAL_CHANNEL2, 0},
+  {DCMIPP_CSI_FLAG_EOF1,    DCMIPP_IRQ_CSI_EOF,    DCMIPP_VIRTUAL_CHANNEL1, 0},
+  {DCMIPP_CSI_FLAG_EOF0,    DCMIPP_IRQ_CSI_EOF,    DCMIPP_VIRTUAL_CHANNEL0, 0},
+  {DCMIPP_CSI_FLAG_SOF3,    DCMIPP_IRQ_CSI_SOF,    DCMIPP_VIRTUAL_CHANNEL3, 0},
+  {DCMIPP_CSI_FLAG_SOF2,    DCMIPP_IRQ_CSI_SOF,    DCMIPP_VIRTUAL_CHANNEL2, 0},
+  {DCMIPP_CSI_FLAG_SOF1,    DCMIPP_IRQ_CSI_SOF,    DCMIPP_VIRTUAL_CHANNEL1, 0},
+  {DCMIPP_CSI_FLAG_SOF0,    DCMIPP_IRQ_CSI_SOF,    DCMIPP_VIRTUAL_CHANNEL0, 0},
+  {DCMIPP_CSI_FLAG_TIM3,    DCMIPP_IRQ_CSI_TIM,    DCMIPP_CSI_TIMER3,       0},
+  {DCMIPP_CSI_FLAG_TIM2,    DCMIPP_IRQ_CSI_TIM,    DCMIPP_CSI_TIMER2,       0},
+  {DCMIPP_CSI_FLAG_TIM1,    DCMIPP_IRQ_CSI_TIM,    DCMIPP_CSI_TIMER1,       0},
+  {DCMIPP_CSI_FLAG_TIM0,    DCMIPP_IRQ_CSI_TIM,    DCMIPP_CSI_TIMER0,       0},
+  {DCMIPP_CSI_FLAG_SYNCERR, DCMIPP_IRQ_CSI_ERROR,  0,                       HAL_DCMIPP_CSI_ERROR_SYNC},
+  {DCMIPP_CSI_FLAG_WDERR,   DCMIPP_IRQ_CSI_ERROR,  0,                       HAL_DCMIPP_CSI_ERROR_WDG},
+  {DCMIPP_CSI_FLAG_SPKTERR, DCMIPP_IRQ_CSI_ERROR,  0,                       HAL_DCMIPP_CSI_ERROR_SPKT},
+  {DCMIPP_CSI_FLAG_IDERR,   DCMIPP_IRQ_CSI_ERROR,  0,                       HAL_DCMIPP_CSI_ERROR_DATA_ID},
+  {DCMIPP_CSI_FLAG_CECCERR, DCMIPP_IRQ_CSI_ERROR,  0,                       HAL_DCMIPP_CSI_ERROR_CECC},
+  {DCMIPP_CSI_FLAG_ECCERR,  DCMIPP_IRQ_CSI_ERROR,  0,                       HAL_DCMIPP_CSI_ERROR_ECC},
+  {DCMIPP_CSI_FLAG_CRCERR,  DCMIPP_IRQ_CSI_ERROR,  0,                       HAL_DCMIPP_CSI_ERROR_CRC},
+};
+
+/* Private function prototypes -----------------------------------------------*/
+static void DcmippIrq_PipeFrame(DCMIPP_HandleTypeDef *hdcmipp, const DcmippIrq_EntryTypeDef *pEntry);
+static void DcmippIrq_PipeVsync(DCMIPP_HandleTypeDef *hdcmipp, const DcmippIrq_EntryTypeDef *pEntry);
+static void DcmippIrq_PipeLine(DCMIPP_HandleTypeDef *hdcmipp, const DcmippIrq_EntryTypeDef *pEntry);
+static void DcmippIrq_PipeLimit(DCMIPP_HandleTypeDef *hdcmipp, const DcmippIrq_EntryTypeDef *pEntry);
+static void DcmippIrq_PipeOverrun(DCMIPP_HandleTypeDef *hdcmipp, const DcmippIrq_EntryTypeDef *pEntry);
+static void DcmippIrq_Error(DCMIPP_HandleTypeDef *hdcmipp, const DcmippIrq_EntryTypeDef *pEntry);
+static void DcmippIrq_CsiFifoFull(DCMIPP_HandleTypeDef *hdcmipp, const DcmippIrq_EntryTypeDef *pEntry);
+static void DcmippIrq_CsiLineByte(DCMIPP_HandleTypeDef *hdcmipp, const DcmippIrq_EntryTypeDef *pEntry);
+static void DcmippIrq_CsiEndOfFrame(DCMIPP_HandleTypeDef *hdcmipp, const DcmippIrq_EntryTypeDef *pEntry);
+static void DcmippIrq_CsiStartOfFrame(DCMIPP_HandleTypeDef *hdcmipp, const DcmippIrq_EntryTypeDef *pEntry);
+static void DcmippIrq_CsiTimer(DCMIPP_HandleTypeDef *hdcmipp, const DcmippIrq_EntryTypeDef *pEntry);
+static void DcmippIrq_CsiError(DCMIPP_HandleTypeDef *hdcmipp, const DcmippIrq_EntryTypeDef *pEntry);
+static void DcmippIrq_CsiClear(const DcmippIrq_EntryTypeDef *pEntry);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Build the tables of the served events
+  * @note   To be called before the DCMIPP and CSI interrupts are enabled.
+  * @param  hirq     Dispatcher handle
+  * @param  hdcmipp  DCMIPP device handle
+  * @param  pConf    Events to serve
+  * @retval HAL status
+  */
+HAL_StatusTypeDef DcmippIrq_Init(DcmippIrq_HandleTypeDef *hirq, DCMIPP_HandleTypeDef *hdcmipp,
+                                 const DcmippIrq_ConfTypeDef *pConf)
+{
+  DcmippIrq_EntryTypeDef *entry;
+  __IO uint32_t *fctcr[DCMIPP_NUM_OF_PIPES];
+  uint32_t i;
+
+  if ((hirq == NULL) || (hdcmipp == NULL) || (pConf == NULL) ||
+      ((pConf->PipeEvents & ~DCMIPP_IRQ_PIPE_EVENTS) != 0U) ||
+      ((pConf->CsiEvents & ~DCMIPP_IRQ_CSI_EVENTS) != 0U))
+  {
+    return HAL_ERROR;
+  }
+
+  memset(hirq, 0, sizeof(*hirq));
+  hirq->hdcmipp = hdcmipp;
+
+  fctcr[0] = &hdcmipp->Instance->P0FCTCR;
+  fctcr[1] = &hdcmipp->Instance->P1FCTCR;
+  fctcr[2] = &hdcmipp->Instance->P2FCTCR;
+
+  for (i = 0; i < DCMIPP_IRQ_MAX_PIPE_ENTRIES; i++)
+  {
+    const DcmippIrq_SourceTypeDef *source = &DcmippIrq_PipeSource[i];
+
+    if ((source->ErrorCode != 0U) || ((pConf->PipeEvents & source->Flag) != 0U))
+    {
+      entry = &hirq->PipeEntry[hirq->NbPipeEntries];
+      entry->Flag      = source->Flag;
+      entry->Param     = source->Param;
+      entry->DisableIt = source->Flag;
+      entry->ErrorCode = source->ErrorCode;
+      entry->pFctcr    = fctcr[source->Param];
+      switch (source->Event)
+      {
+        case DCMIPP_IRQ_PIPE_FRAME:
+          entry->DisableIt = DcmippIrq_SnapshotIt[source->Param];
+          entry->Handler   = DcmippIrq_PipeFrame;
+          break;
+        case DCMIPP_IRQ_PIPE_VSYNC:
+          entry->Handler = DcmippIrq_PipeVsync;
+          break;
+        case DCMIPP_IRQ_PIPE_LINE:
+          entry->Handler = DcmippIrq_PipeLine;
+          break;
+        case DCMIPP_IRQ_PIPE_LIMIT:
+          entry->Handler = DcmippIrq_PipeLimit;
+          break;
+        case DCMIPP_IRQ_PIPE_OVR:
+          entry->Handler = DcmippIrq_PipeOverrun;
+          break;
+        default:
+          entry->Handler = DcmippIrq_Error;
+          break;
+      }
+      hirq->PipeFlags |= entry->Flag;
+      hirq->NbPipeEntries++;
+    }
+  }
+
+  for (i = 0; i < DCMIPP_IRQ_MAX_CSI_ENTRIES; i++)
+  {
+    const DcmippIrq_SourceTypeDef *source = &DcmippIrq_CsiSource[i];
+
+    if ((source->Event == DCMIPP_IRQ_CSI_CCFIFO) || (source->Event == DCMIPP_IRQ_CSI_ERROR) ||
+        ((pConf->CsiEvents & source->Flag) != 0U))
+    {
+      entry = &hirq->CsiEntry[hirq->NbCsiEntries];
+      entry->Flag      = source->Flag;
+      entry->Param     = source->Param;
+      entry->DisableIt = source->Flag;
+      entry->ErrorCode = source->ErrorCode;
+      /* The CSI events stop with the snapshot capture of PIPE0, as in the HAL */
+      entry->pFctcr    = fctcr[0];
+      switch (source->Event)
+      {
+        case DCMIPP_IRQ_CSI_CCFIFO:
+          entry->Handler = DcmippIrq_CsiFifoFull;
+          break;
+        case DCMIPP_IRQ_CSI_LB:
+          entry->Handler = DcmippIrq_CsiLineByte;
+          break;
+        case DCMIPP_IRQ_CSI_EOF:
+          entry->Handler = DcmippIrq_CsiEndOfFrame;
+          break;
+        case DCMIPP_IRQ_CSI_SOF:
+          entry->Handler = DcmippIrq_CsiStartOfFrame;
+          break;
+        case DCMIPP_IRQ_CSI_TIM:
+          entry->Handler = DcmippIrq_CsiTimer;
+          break;
+        default:
+          entry->Handler = DcmippIrq_CsiError;
+          break;
+      }
+      hirq->CsiFlags |= entry->Flag;
+      hirq->NbCsiEntries++;
+    }
+  }
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  DCMIPP interrupt, in place of HAL_DCMIPP_IRQHandler()
+  * @param  hirq Dispatcher handle
+  * @retval None
+  */
+void DcmippIrq_IRQHandler(DcmippIrq_HandleTypeDef *hirq)
+{
+  DCMIPP_HandleTypeDef *hdcmipp = hirq->hdcmipp;
+  const DcmippIrq_EntryTypeDef *entry = hirq->PipeEntry;
+  /* Flags and enable bits share their positions */
+  uint32_t pending = READ_REG(hdcmipp->Instance->CMSR2) & READ_REG(hdcmipp->Instance->CMIER);
+
+  /* Events enabled out of the configuration: the HAL serves the whole
+     interrupt, in its order */
+  if ((pending & ~hirq->PipeFlags) != 0U)
+  {
+    hirq->FallbackCount++;
+    HAL_DCMIPP_IRQHandler(hdcmipp);
+    return;
+  }
+
+  while (pending != 0U)
+  {
+    if ((pending & entry->Flag) != 0U)
+    {
+      pending &= ~entry->Flag;
+      entry->Handler(hdcmipp, entry);
+    }
+    entry++;
+  }
+}
+
+/**
+  * @brief  CSI interrupt, in place of HAL_DCMIPP_CSI_IRQHandler()
+  * @param  hirq Dispatcher handle
+  * @retval None
+  */
+void DcmippIrq_CSI_IRQHandler(DcmippIrq_HandleTypeDef *hirq)
+{
+  const DcmippIrq_EntryTypeDef *entry = hirq->CsiEntry;
+  uint32_t pending = READ_REG(CSI->SR0) & READ_REG(CSI->IER0);
+
+  /* D-PHY errors or events out of the configuration: the HAL serves the
+     whole interrupt, in its order */
+  if (((pending & ~hirq->CsiFlags) != 0U) || ((READ_REG(CSI->SR1) & READ_REG(CSI->IER1)) != 0U))
+  {
+    hirq->FallbackCount++;
+    HAL_DCMIPP_CSI_IRQHandler(hirq->hdcmipp);
+    return;
+  }
+
+  while (pending != 0U)
+  {
+    if ((pending & entry->Flag) != 0U)
+    {
+      pending &= ~entry->Flag;
+      entry->Handler(hirq->hdcmipp, entry);
+    }
+    entry++;
+  }
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  End of frame of a pipe
+  * @param  hdcmipp DCMIPP device handle
+  * @param  pEntry  Table entry
+  * @retval None
+  */
+static void DcmippIrq_PipeFrame(DCMIPP_HandleTypeDef *hdcmipp, const DcmippIrq_EntryTypeDef *pEntry)
+{
+  if ((*pEntry->pFctcr & DCMIPP_P0FCTCR_CPTMODE) == DCMIPP_MODE_SNAPSHOT)
+  {
+    __HAL_DCMIPP_DISABLE_IT(hdcmipp, pEntry->DisableIt);
+    hdcmipp->PipeState[pEntry->Param] = HAL_DCMIPP_PIPE_STATE_READY;
+  }
+  __HAL_DCMIPP_CLEAR_FLAG(hdcmipp, pEntry->Flag);
+#if (USE_HAL_DCMIPP_REGISTER_CALLBACKS == 1)
+  hdcmipp->PIPE_FrameEventCallback(hdcmipp, pEntry->Param);
+#else
+  HAL_DCMIPP_PIPE_FrameEventCallback(hdcmipp, pEntry->Param);
+#endif /* USE_HAL_DCMIPP_REGISTER_CALLBACKS */
+}
+
+/**
+  * @brief  Vertical sync of a pipe
+  * @param  hdcmipp DCMIPP device handle
+  * @param  pEntry  Table entry
+  * @retval None
+  */
+static void DcmippIrq_PipeVsync(DCMIPP_HandleTypeDef *hdcmipp, const DcmippIrq_EntryTypeDef *pEntry)
+{
+  __HAL_DCMIPP_CLEAR_FLAG(hdcmipp, pEntry->Flag);
+#if (USE_HAL_DCMIPP_REGISTER_CALLBACKS == 1)
+  hdcmipp->PIPE_VsyncEventCallback(hdcmipp, pEntry->Param);
+#else
+  HAL_DCMIPP_PIPE_VsyncEventCallback(hdcmipp, pEntry->Param);
+#endif /* USE_HAL_DCMIPP_REGISTER_CALLBACKS */
+}
+
+/**
+  * @brief  Multiline event of a pipe
+  * @param  hdcmipp DCMIPP device handle
+  * @param  pEntry  Table entry
+  * @retval None
+  */
+static void DcmippIrq_PipeLine(DCMIPP_HandleTypeDef *hdcmipp, const DcmippIrq_EntryTypeDef *pEntry)
+{
+  __HAL_DCMIPP_CLEAR_FLAG(hdcmipp, pEntry->Flag);
+#if (USE_HAL_DCMIPP_REGISTER_CALLBACKS == 1)
+  hdcmipp->PIPE_LineEventCallback(hdcmipp, pEntry->Param);
+#else
+  HAL_DCMIPP_PIPE_LineEventCallback(hdcmipp, pEntry->Param);
+#endif /* USE_HAL_DCMIPP_REGISTER_CALLBACKS */
+}
+
+/**
+  * @brief  Limit error of PIPE0
+  * @param  hdcmipp DCMIPP device handle
+  * @param  pEntry  Table entry
+  * @retval None
+  */
+static void DcmippIrq_PipeLimit(DCMIPP_HandleTypeDef *hdcmipp, const DcmippIrq_EntryTypeDef *pEntry)
+{
+  __HAL_DCMIPP_DISABLE_IT(hdcmipp, pEntry->DisableIt);
+  hdcmipp->ErrorCode |= pEntry->ErrorCode;
+  __HAL_DCMIPP_CLEAR_FLAG(hdcmipp, pEntry->Flag);
+#if (USE_HAL_DCMIPP_REGISTER_CALLBACKS == 1)
+  hdcmipp->PIPE_LimitEventCallback(hdcmipp, pEntry->Param);
+#else
+  HAL_DCMIPP_PIPE_LimitEventCallback(hdcmipp, pEntry->Param);
+#endif /* USE_HAL_DCMIPP_REGISTER_CALLBACKS */
+}
+
+/**
+  * @brief  Overrun of a pipe
+  * @param  hdcmipp DCMIPP device handle
+  * @param  pEntry  Table entry
+  * @retval None
+  */
+static void DcmippIrq_PipeOverrun(DCMIPP_HandleTypeDef *hdcmipp, const DcmippIrq_EntryTypeDef *pEntry)
+{
+  __HAL_DCMIPP_DISABLE_IT(hdcmipp, pEntry->DisableIt);
+  hdcmipp->ErrorCode |= pEntry->ErrorCode;
+  __HAL_DCMIPP_CLEAR_FLAG(hdcmipp, pEntry->Flag);
+  hdcmipp->PipeState[pEntry->Param] = HAL_DCMIPP_PIPE_STATE_ERROR;
+#if (USE_HAL_DCMIPP_REGISTER_CALLBACKS == 1)
+  hdcmipp->PIPE_ErrorCallback(hdcmipp, pEntry->Param);
+#else
+  HAL_DCMIPP_PIPE_ErrorCallback(hdcmipp, pEntry->Param);
+#endif /* USE_HAL_DCMIPP_REGISTER_CALLBACKS */
+}
+
+/**
+  * @brief  Parallel interface synchronization or AXI transfer error
+  * @param  hdcmipp DCMIPP device handle
+  * @param  pEntry  Table entry
+  * @retval None
+  */
+static void DcmippIrq_Error(DCMIPP_HandleTypeDef *hdcmipp, const DcmippIrq_EntryTypeDef *pEntry)
+{
+  __HAL_DCMIPP_DISABLE_IT(hdcmipp, pEntry->DisableIt);
+  hdcmipp->ErrorCode |= pEntry->ErrorCode;
+  __HAL_DCMIPP_CLEAR_FLAG(hdcmipp, pEntry->Flag);
+  hdcmipp->State = HAL_DCMIPP_STATE_ERROR;
+#if (USE_HAL_DCMIPP_REGISTER_CALLBACKS == 1)
+  hdcmipp->ErrorCallback(hdcmipp);
+#else
+  HAL_DCMIPP_ErrorCallback(hdcmipp);
+#endif /* USE_HAL_DCMIPP_REGISTER_CALLBACKS */
+}
+
+/**
+  * @brief  CSI clock changer FIFO full
+  * @param  hdcmipp DCMIPP device handle
+  * @param  pEntry  Table entry
+  * @retval None
+  */
+static void DcmippIrq_CsiFifoFull(DCMIPP_HandleTypeDef *hdcmipp, const DcmippIrq_EntryTypeDef *pEntry)
+{
+  __HAL_DCMIPP_CSI_DISABLE_IT(CSI, pEntry->DisableIt);
+  __HAL_DCMIPP_CSI_CLEAR_FLAG(CSI, pEntry->Flag);
+#if (USE_HAL_DCMIPP_REGISTER_CALLBACKS == 1)
+  hdcmipp->ClockChangerFifoFullEventCallback(hdcmipp);
+#else
+  HAL_DCMIPP_CSI_ClockChangerFifoFullEventCallback(hdcmipp);
+#endif /* USE_HAL_DCMIPP_REGISTER_CALLBACKS */
+}
+
+/**
+  * @brief  CSI line/byte counter
+  * @param  hdcmipp DCMIPP device handle
+  * @param  pEntry  Table entry
+  * @retval None
+  */
+static void DcmippIrq_CsiLineByte(DCMIPP_HandleTypeDef *hdcmipp, const DcmippIrq_EntryTypeDef *pEntry)
+{
+  DcmippIrq_CsiClear(pEntry);
+#if (USE_HAL_DCMIPP_REGISTER_CALLBACKS == 1)
+  hdcmipp->LineByteEventCallback(hdcmipp, pEntry->Param);
+#else
+  HAL_DCMIPP_CSI_LineByteEventCallback(hdcmipp, pEntry->Param);
+#endif /* USE_HAL_DCMIPP_REGISTER_CALLBACKS */
+}
+
+/**
+  * @brief  CSI end of frame
+  * @param  hdcmipp DCMIPP device handle
+  * @param  pEntry  Table entry
+  * @retval None
+  */
+static void DcmippIrq_CsiEndOfFrame(DCMIPP_HandleTypeDef *hdcmipp, const DcmippIrq_EntryTypeDef *pEntry)
+{
+  DcmippIrq_CsiClear(pEntry);
+#if (USE_HAL_DCMIPP_REGISTER_CALLBACKS == 1)
+  hdcmipp->EndOfFrameEventCallback(hdcmipp, pEntry->Param);
+#else
+  HAL_DCMIPP_CSI_EndOfFrameEventCallback(hdcmipp, pEntry->Param);
+#endif /* USE_HAL_DCMIPP_REGISTER_CALLBACKS */
+}
+
+/**
+  * @brief  CSI start of frame
+  * @param  hdcmipp DCMIPP device handle
+  * @param  pEntry  Table entry
+  * @retval None
+  */
+static void DcmippIrq_CsiStartOfFrame(DCMIPP_HandleTypeDef *hdcmipp, const DcmippIrq_EntryTypeDef *pEntry)
+{
+  DcmippIrq_CsiClear(pEntry);
+#if (USE_HAL_DCMIPP_REGISTER_CALLBACKS == 1)
+  hdcmipp->StartOfFrameEventCallback(hdcmipp, pEntry->Param);
+#else
+  HAL_DCMIPP_CSI_StartOfFrameEventCallback(hdcmipp, pEntry->Param);
+#endif /* USE_HAL_DCMIPP_REGISTER_CALLBACKS */
+}
+
+/**
+  * @brief  CSI timer
+  * @param  hdcmipp DCMIPP device handle
+  * @param  pEntry  Table entry
+  * @retval None
+  */
+static void DcmippIrq_CsiTimer(DCMIPP_HandleTypeDef *hdcmipp, const DcmippIrq_EntryTypeDef *pEntry)
+{
+  DcmippIrq_CsiClear(pEntry);
+#if (USE_HAL_DCMIPP_REGISTER_CALLBACKS == 1)
+  hdcmipp->TimerCounterEventCallback(hdcmipp, pEntry->Param);
+#else
+  HAL_DCMIPP_CSI_TimerCounterEventCallback(hdcmipp, pEntry->Param);
+#endif /* USE_HAL_DCMIPP_REGISTER_CALLBACKS */
+}
+
+/**
+  * @brief  CSI protocol error
+  * @param  hdcmipp DCMIPP device handle
+  * @param  pEntry  Table entry
+  * @retval None
+  */
+static void DcmippIrq_CsiError(DCMIPP_HandleTypeDef *hdcmipp, const DcmippIrq_EntryTypeDef *pEntry)
+{
+  __HAL_DCMIPP_CSI_DISABLE_IT(CSI, pEntry->DisableIt);
+  __HAL_DCMIPP_CSI_CLEAR_FLAG(CSI, pEntry->Flag);
+  hdcmipp->ErrorCode |= pEntry->ErrorCode;
+#if (USE_HAL_DCMIPP_REGISTER_CALLBACKS == 1)
+  hdcmipp->ErrorCallback(hdcmipp);
+#else
+  HAL_DCMIPP_ErrorCallback(hdcmipp);
+#endif /* USE_HAL_DCMIPP_REGISTER_CALLBACKS */
+}
+
+/**
+  * @brief  Clear a CSI event flag, the event being disabled in snapshot mode
+  * @param  pEntry Table entry
+  * @retval None
+  */
+static void DcmippIrq_CsiClear(const DcmippIrq_EntryTypeDef *pEntry)
+{
+  if ((*pEntry->pFctcr & DCMIPP_P0FCTCR_CPTMODE) == DCMIPP_MODE_SNAPSHOT)
+  {
+    __HAL_DCMIPP_CSI_DISABLE_IT(CSI, pEntry->DisableIt);
+  }
+  __HAL_DCMIPP_CSI_CLEAR_FLAG(CSI, pEntry->Flag);
+}
@@ -0,0 +1,153 @@
+/**
+  ******************************************************************************
+  * @file    frame_governor.c
+  * @brief   Frame rate governor.
+  *
+  *          The sensor exposure cannot exceed the frame length (VTS) minus a
+  *          margin, so at a fixed frame rate the AEC can only raise the gain
+  *          in low light. The governor trades frame rate for exposure: when
+  *          the requested exposure does not fit in the frame, the frame is
+  *          extended by one step, down to the minimum frame rate. When the
+  *          exposure fits in a frame one step shorter, with some headroom,
+  *          the frame is shortened again, back to the full frame rate.
+  *
+  *          The AEC ceiling is the exposure of the next longer step: the AEC
+  *          can ask for a bit more than the frame holds, which extends it,
+  *          and never for more than the next step can give.
+  *
+  *          The frame length is given in lines; it is up to the caller to
+  *          program it with the exposure, in the same sensor group hold.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "frame_governor.h"
+#include <string.h>
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t FrameGovernor_LinesToUs(const FrameGovernor_HandleTypeDef *hgov, uint32_t Lines);
+static uint32_t FrameGovernor_UsToLines(const FrameGovernor_HandleTypeDef *hgov, uint32_t Us);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Initialize the governor at the full frame rate
+  * @param  hgov   Governor handle
+  * @param  pConf  Sensor timing and governor configuration
+  * @retval HAL status
+  */
+HAL_StatusTypeDef FrameGovernor_Init(FrameGovernor_HandleTypeDef *hgov, const FrameGovernor_ConfTypeDef *pConf)
+{
+  if ((hgov == NULL) || (pConf == NULL) || (pConf->Hts == 0U) || (pConf->Pclk == 0U) || (pConf->MinFps == 0U) ||
+      (pConf->StepLines == 0U) || (pConf->VtsMin <= pConf->MarginLines))
+  {
+    return HAL_ERROR;
+  }
+
+  memset(hgov, 0, sizeof(*hgov));
+  hgov->Conf = *pConf;
+
+  /* Longest frame allowed, never shorter than the full rate one */
+  hgov->VtsMax = pConf->Pclk / (pConf->Hts * pConf->MinFps);
+  if (hgov->VtsMax < pConf->VtsMin)
+  {
+    hgov->VtsMax = pConf->VtsMin;
+  }
+
+  hgov->Vts = pConf->VtsMin;
+  hgov->FramePeriod = FrameGovernor_LinesToUs(hgov, hgov->Vts);
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Choose the frame length for an exposure request
+  * @note   To be called each time the AEC sets a new exposure, before the
+  *         exposure is converted to sensor registers.
+  * @param  hgov      Governor handle
+  * @param  Exposure  Exposure requested by the AEC, in us
+  * @retval Lines per frame to program
+  */
+uint32_t FrameGovernor_Update(FrameGovernor_HandleTypeDef *hgov, uint32_t Exposure)
+{
+  const FrameGovernor_ConfTypeDef *conf = &hgov->Conf;
+  uint32_t need = FrameGovernor_UsToLines(hgov, Exposure) + conf->MarginLines;
+  uint32_t vts = hgov->Vts;
+
+  if ((need > vts) && (vts < hgov->VtsMax))
+  {
+    /* Exposure longer than the frame: one step slower */
+    vts = ((vts + conf->StepLines) < hgov->VtsMax) ? (vts + conf->StepLines) : hgov->VtsMax;
+  }
+  else if ((vts > conf->VtsMin) && ((need + conf->HysteresisLines + conf->StepLines) <= vts))
+  {
+    /* Exposure fits in a shorter frame: one step faster */
+    vts = ((vts - conf->StepLines) > conf->VtsMin) ? (vts - conf->StepLines) : conf->VtsMin;
+  }
+
+  if (vts != hgov->Vts)
+  {
+    hgov->Vts = vts;
+    hgov->FramePeriod = FrameGovernor_LinesToUs(hgov, vts);
+    hgov->ChangeCount++;
+  }
+
+  return vts;
+}
+
+/**
+  * @brief  Longest exposure the AEC may request, to be passed to ISP_SetExposureMax()
+  * @param  hgov  Governor handle
+  * @retval Exposure in us
+  */
+uint32_t FrameGovernor_GetExposureMax(const FrameGovernor_HandleTypeDef *hgov)
+{
+  uint32_t vts = hgov->Vts + hgov->Conf.StepLines;
+
+  if (vts > hgov->VtsMax)
+  {
+    vts = hgov->VtsMax;
+  }
+
+  return FrameGovernor_LinesToUs(hgov, vts - hgov->Conf.MarginLines);
+}
+
+/**
+  * @brief  Frame period of the chosen frame length, for the frame consumers
+  * @param  hgov  Governor handle
+  * @retval Frame period in us
+  */
+uint32_t FrameGovernor_GetFramePeriod(const FrameGovernor_HandleTypeDef *hgov)
+{
+  return hgov->FramePeriod;
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  Duration of sensor lines, rounded down
+  * @retval Duration in us
+  */
+static uint32_t FrameGovernor_LinesToUs(const FrameGovernor_HandleTypeDef *hgov, uint32_t Lines)
+{
+  return (uint32_t)(((uint64_t)Lines * hgov->Conf.Hts * 1000000U) / hgov->Conf.Pclk);
+}
+
+/**
+  * @brief  Sensor lines of an exposure, rounded as the sensor driver does
+  * @retval Lines
+  */
+static uint32_t FrameGovernor_UsToLines(const FrameGovernor_HandleTypeDef *hgov, uint32_t Us)
+{
+  uint64_t denom = (uint64_t)hgov->Conf.Hts * 1000000U;
+
+  return (uint32_t)((((uint64_t)Us * hgov->Conf.Pclk) + (denom / 2U)) / denom);
+}
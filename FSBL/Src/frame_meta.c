@@ -0,0 +1,184 @@
+/**
+  ******************************************************************************
+  * @file    frame_meta.c
+  * @brief   Capture record of each frame.
+  *
+  *          The ISP keeps the last values it computed only, and the sensor
+  *          exposes a frame with the gain and exposure sent some frames
+  *          earlier. This module builds, at the start of each frame, the
+  *          record of the settings the frame is produced with, and stages it
+  *          in the pipe ring which attaches it to the buffer the frame lands
+  *          in (see frame_ring.c).
+  *
+  *          - Sensor: the gain and exposure handed to the sensor control are
+  *            marked sent at the start of frame they go out at, and are put
+  *            in the record of the frame SensorDelay starts of frame later.
+  *          - ISP: the gains and the color conversion are read back from the
+  *            pipe registers latched at the frame start, with the last AEC
+  *            luminance and AWB color temperature.
+  *          - Pipe: the crop and downsize geometry is the one in force before
+  *            the VSYNC event programs a pending region of interest, which
+  *            takes effect on the next frame only.
+  *
+  *          The start of frame handler and the VSYNC handler run from the
+  *          DCMIPP interrupt; the sensor setters run from the background.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "frame_meta.h"
+#include <string.h>
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Initialize the frame records with the sensor settings at start
+  * @note   To be called before the ISP is initialized, the ISP initialization
+  *         may already update the sensor settings.
+  * @param  hmeta  Frame record handle
+  * @param  hIsp   ISP handle
+  * @param  pConf  Sensor delay and settings at start
+  * @retval HAL status
+  */
+HAL_StatusTypeDef FrameMeta_Init(FrameMeta_HandleTypeDef *hmeta, ISP_HandleTypeDef *hIsp,
+                                 const FrameMeta_ConfTypeDef *pConf)
+{
+  uint32_t i;
+
+  if ((hmeta == NULL) || (hIsp == NULL) || (pConf == NULL) || (pConf->SensorDelay > FRAME_META_MAX_DELAY))
+  {
+    return HAL_ERROR;
+  }
+
+  memset(hmeta, 0, sizeof(*hmeta));
+  hmeta->hIsp = hIsp;
+  hmeta->Conf = *pConf;
+
+  hmeta->Requested.Gain     = pConf->Gain;
+  hmeta->Requested.Exposure = pConf->Exposure;
+  for (i = 0; i <= FRAME_META_MAX_DELAY; i++)
+  {
+    hmeta->Sent[i] = hmeta->Requested;
+  }
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Note a sensor gain update
+  * @note   To be called once the update is handed to the sensor control, from
+  *         the ISP gain setter helper.
+  * @param  hmeta  Frame record handle
+  * @param  Gain   Sensor gain, in mdB
+  * @retval None
+  */
+void FrameMeta_SetGain(FrameMeta_HandleTypeDef *hmeta, int32_t Gain)
+{
+  hmeta->Requested.Gain = Gain;
+}
+
+/**
+  * @brief  Note a sensor exposure update
+  * @note   To be called once the update is handed to the sensor control, from
+  *         the ISP exposure setter helper.
+  * @param  hmeta     Frame record handle
+  * @param  Exposure  Sensor exposure, in us
+  * @retval None
+  */
+void FrameMeta_SetExposure(FrameMeta_HandleTypeDef *hmeta, int32_t Exposure)
+{
+  hmeta->Requested.Exposure = Exposure;
+}
+
+/**
+  * @brief  To be called from the CSI start of frame callback
+  * @param  hmeta  Frame record handle
+  * @param  Sent   1 when the sensor control has nothing left to send, the last
+  *                requested values being on their way to the sensor
+  * @retval None
+  */
+void FrameMeta_StartOfFrameHandler(FrameMeta_HandleTypeDef *hmeta, uint8_t Sent)
+{
+  uint32_t i;
+
+  hmeta->SofCycles = DWT->CYCCNT;
+  hmeta->SofTick = HAL_GetTick();
+  hmeta->SofCount++;
+
+  /* One more frame for the values already sent */
+  for (i = FRAME_META_MAX_DELAY; i > 0U; i--)
+  {
+    hmeta->Sent[i] = hmeta->Sent[i - 1U];
+  }
+  if (Sent != 0U)
+  {
+    hmeta->Sent[0] = hmeta->Requested;
+  }
+}
+
+/**
+  * @brief  Stage the record of the frame starting on a pipe
+  * @note   To be called from HAL_DCMIPP_PIPE_VsyncEventCallback(), before the
+  *         pipe region of interest is updated.
+  * @param  hmeta  Frame record handle
+  * @param  hring  Ring of the pipe, NULL for a pipe without ring
+  * @param  hroi   Region of interest of the pipe
+  * @retval None
+  */
+void FrameMeta_VsyncEventHandler(FrameMeta_HandleTypeDef *hmeta, FrameRing_HandleTypeDef *hring,
+                                 const PipeRoi_HandleTypeDef *hroi)
+{
+  FrameBuf_MetaTypeDef meta = {0};
+  ISP_FrameMetaTypeDef isp;
+  ISP_DecimationTypeDef decimation = {ISP_DECIM_FACTOR_1};
+  const FrameMeta_SensorTypeDef *sensor = &hmeta->Sent[hmeta->Conf.SensorDelay];
+  uint32_t i;
+  uint32_t j;
+
+  if ((hring == NULL) || (hroi == NULL))
+  {
+    return;
+  }
+
+  meta.SofCount       = hmeta->SofCount;
+  meta.SofCycles      = hmeta->SofCycles;
+  meta.SofTick        = hmeta->SofTick;
+  meta.SensorGain     = sensor->Gain;
+  meta.SensorExposure = sensor->Exposure;
+
+  if (ISP_GetFrameMeta(hmeta->hIsp, &isp) == ISP_OK)
+  {
+    meta.IspGain[0] = isp.ispGain.ispGainR;
+    meta.IspGain[1] = isp.ispGain.ispGainG;
+    meta.IspGain[2] = isp.ispGain.ispGainB;
+    for (i = 0; i < 3U; i++)
+    {
+      for (j = 0; j < 3U; j++)
+      {
+        meta.ColorConv[i][j] = isp.colorConv.coeff[i][j];
+      }
+    }
+    meta.ColorTemp = isp.colorTemp;
+    meta.AverageL  = isp.averageL;
+  }
+  (void)ISP_GetDecimationFactor(hmeta->hIsp, &decimation);
+  meta.Decimation = (uint8_t)decimation.factor;
+
+  meta.CropX        = (uint16_t)hroi->Current.Crop.HStart;
+  meta.CropY        = (uint16_t)hroi->Current.Crop.VStart;
+  meta.CropWidth    = (uint16_t)hroi->Current.Crop.HSize;
+  meta.CropHeight   = (uint16_t)hroi->Current.Crop.VSize;
+  meta.OutputWidth  = (uint16_t)hroi->OutputWidth;
+  meta.OutputHeight = (uint16_t)hroi->OutputHeight;
+
+  FrameRing_SetFrameMeta(hring, &meta);
+}
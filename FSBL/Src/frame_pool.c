@@ -0,0 +1,299 @@
+/**
+  ******************************************************************************
+  * @file    frame_pool.c
+  * @brief   Pool of frame buffers shared by reference between the stages.
+  *
+  *          The pool carves fixed size buffers from one or more memory
+  *          regions: AXISRAM or the PSRAM mapped by the XSPI. Each buffer
+  *          starts and ends on a D-Cache line, so the cache maintenance of
+  *          one buffer never touches a neighbour.
+  *
+  *          - A buffer is allocated with one reference. A stage handed the
+  *            buffer takes its own reference with FramePool_Retain() and
+  *            drops it with FramePool_Release(), so frames are passed by
+  *            address and never copied. The buffer returns to the pool
+  *            when the last reference is dropped.
+  *          - The cache maintenance is done at the ownership transitions
+  *            only: FramePool_BeginDeviceAccess() cleans the lines before a
+  *            master reads the buffer and invalidates them before a master
+  *            writes it. FramePool_EndDeviceAccess() invalidates the lines
+  *            a master has written before the CPU reads them.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "frame_pool.h"
+
+/* Private macro -------------------------------------------------------------*/
+#define FRAME_POOL_ROUND_UP(x)   (((x) + (FRAME_POOL_ALIGN - 1U)) & ~(FRAME_POOL_ALIGN - 1U))
+
+/* Private function prototypes -----------------------------------------------*/
+static FramePool_BufferTypeDef *FramePool_Find(FramePool_HandleTypeDef *hpool, uint32_t Address);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Initialize an empty pool
+  * @param  hpool       Pool handle
+  * @param  BufferSize  Bytes per buffer, rounded up to a D-Cache line
+  * @retval HAL status
+  */
+HAL_StatusTypeDef FramePool_Init(FramePool_HandleTypeDef *hpool, uint32_t BufferSize)
+{
+  if ((hpool == NULL) || (BufferSize == 0U))
+  {
+    return HAL_ERROR;
+  }
+
+  hpool->BufferSize = FRAME_POOL_ROUND_UP(BufferSize);
+  hpool->NbBuffers  = 0;
+  hpool->FailCount  = 0;
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Carve as many buffers as fit in a memory region
+  * @note   A memory-mapped PSRAM region can only be added once the XSPI is in
+  *         memory-mapped mode.
+  * @param  hpool    Pool handle
+  * @param  Address  Region start, rounded up to a D-Cache line
+  * @param  Size     Region size in bytes
+  * @retval HAL_ERROR if no buffer fits or the pool is full
+  */
+HAL_StatusTypeDef FramePool_AddRegion(FramePool_HandleTypeDef *hpool, uint32_t Address, uint32_t Size)
+{
+  uint32_t start = FRAME_POOL_ROUND_UP(Address);
+  uint32_t end   = Address + Size;
+  uint32_t count = 0;
+
+  if ((hpool == NULL) || (start < Address) || (end < Address))
+  {
+    return HAL_ERROR;
+  }
+
+  while ((start <= end) && ((end - start) >= hpool->BufferSize) &&
+         (hpool->NbBuffers < FRAME_POOL_MAX_BUFFERS))
+  {
+    hpool->Buffer[hpool->NbBuffers].Address  = start;
+    hpool->Buffer[hpool->NbBuffers].RefCount = 0;
+    hpool->Buffer[hpool->NbBuffers].Owner    = FRAME_POOL_OWNER_CPU;
+    hpool->NbBuffers++;
+    count++;
+    start += hpool->BufferSize;
+  }
+
+  return (count != 0U) ? HAL_OK : HAL_ERROR;
+}
+
+/**
+  * @brief  Take a free buffer, owned by the CPU with one reference
+  * @param  hpool     Pool handle
+  * @param  pAddress  Buffer address
+  * @retval HAL_OK, HAL_BUSY if all the buffers are in use
+  */
+HAL_StatusTypeDef FramePool_Alloc(FramePool_HandleTypeDef *hpool, uint32_t *pAddress)
+{
+  HAL_StatusTypeDef status = HAL_BUSY;
+  uint32_t primask = __get_PRIMASK();
+  uint32_t i;
+
+  __disable_irq();
+  for (i = 0; i < hpool->NbBuffers; i++)
+  {
+    if (hpool->Buffer[i].RefCount == 0U)
+    {
+      hpool->Buffer[i].RefCount = 1;
+      hpool->Buffer[i].Owner    = FRAME_POOL_OWNER_CPU;
+      *pAddress = hpool->Buffer[i].Address;
+      status = HAL_OK;
+      break;
+    }
+  }
+  if (status != HAL_OK)
+  {
+    hpool->FailCount++;
+  }
+  __set_PRIMASK(primask);
+
+  return status;
+}
+
+/**
+  * @brief  Take one more reference on an allocated buffer
+  * @param  hpool    Pool handle
+  * @param  Address  Buffer address
+  * @retval HAL_ERROR if the address is not an allocated buffer of the pool
+  */
+HAL_StatusTypeDef FramePool_Retain(FramePool_HandleTypeDef *hpool, uint32_t Address)
+{
+  HAL_StatusTypeDef status = HAL_ERROR;
+  FramePool_BufferTypeDef *buffer = FramePool_Find(hpool, Address);
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+  if ((buffer != NULL) && (buffer->RefCount != 0U))
+  {
+    buffer->RefCount++;
+    status = HAL_OK;
+  }
+  __set_PRIMASK(primask);
+
+  return status;
+}
+
+/**
+  * @brief  Drop one reference, the buffer returns to the pool with the last one
+  * @param  hpool    Pool handle
+  * @param  Address  Buffer address
+  * @retval HAL_ERROR if the address is not an allocated buffer of the pool
+  */
+HAL_StatusTypeDef FramePool_Release(FramePool_HandleTypeDef *hpool, uint32_t Address)
+{
+  HAL_StatusTypeDef status = HAL_ERROR;
+  FramePool_BufferTypeDef *buffer = FramePool_Find(hpool, Address);
+  uint8_t stale = 0;
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+  if ((buffer != NULL) && (buffer->RefCount != 0U))
+  {
+    buffer->RefCount--;
+    if (buffer->RefCount == 0U)
+    {
+      /* The next user starts as CPU owner: drop what a master may have written */
+      stale = (buffer->Owner == FRAME_POOL_OWNER_DEVICE_WRITE) ? 1U : 0U;
+      buffer->Owner = FRAME_POOL_OWNER_CPU;
+    }
+    status = HAL_OK;
+  }
+  __set_PRIMASK(primask);
+
+  if (stale != 0U)
+  {
+    SCB_InvalidateDCache_by_Addr((uint32_t *)Address, (int32_t)hpool->BufferSize);
+  }
+
+  return status;
+}
+
+/**
+  * @brief  Get the number of references held on a buffer
+  * @param  hpool    Pool handle
+  * @param  Address  Buffer address
+  * @retval References, 0 for a free buffer or an unknown address
+  */
+uint32_t FramePool_GetRefCount(FramePool_HandleTypeDef *hpool, uint32_t Address)
+{
+  FramePool_BufferTypeDef *buffer = FramePool_Find(hpool, Address);
+
+  return (buffer != NULL) ? buffer->RefCount : 0U;
+}
+
+/**
+  * @brief  Get the number of buffers available for allocation
+  * @param  hpool  Pool handle
+  * @retval Free buffers
+  */
+uint32_t FramePool_GetFreeCount(FramePool_HandleTypeDef *hpool)
+{
+  uint32_t count = 0;
+  uint32_t i;
+
+  for (i = 0; i < hpool->NbBuffers; i++)
+  {
+    if (hpool->Buffer[i].RefCount == 0U)
+    {
+      count++;
+    }
+  }
+
+  return count;
+}
+
+/**
+  * @brief  Hand a buffer owned by the CPU to a bus master
+  * @param  hpool    Pool handle
+  * @param  Address  Buffer address
+  * @param  Owner    FRAME_POOL_OWNER_DEVICE_READ or FRAME_POOL_OWNER_DEVICE_WRITE
+  * @retval HAL_ERROR if the buffer is free or already owned by a master
+  */
+HAL_StatusTypeDef FramePool_BeginDeviceAccess(FramePool_HandleTypeDef *hpool, uint32_t Address,
+                                              FramePool_OwnerTypeDef Owner)
+{
+  FramePool_BufferTypeDef *buffer = FramePool_Find(hpool, Address);
+
+  if ((buffer == NULL) || (buffer->RefCount == 0U) || (buffer->Owner != FRAME_POOL_OWNER_CPU) ||
+      (Owner == FRAME_POOL_OWNER_CPU))
+  {
+    return HAL_ERROR;
+  }
+
+  if (Owner == FRAME_POOL_OWNER_DEVICE_READ)
+  {
+    /* The master reads the memory: write back what the CPU has produced */
+    SCB_CleanDCache_by_Addr((uint32_t *)Address, (int32_t)hpool->BufferSize);
+  }
+  else
+  {
+    /* No dirty line may be evicted over the data written by the master */
+    SCB_InvalidateDCache_by_Addr((uint32_t *)Address, (int32_t)hpool->BufferSize);
+  }
+  buffer->Owner = Owner;
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Give a buffer back to the CPU once the bus master is done with it
+  * @param  hpool    Pool handle
+  * @param  Address  Buffer address
+  * @retval HAL_ERROR if the buffer is free or not owned by a master
+  */
+HAL_StatusTypeDef FramePool_EndDeviceAccess(FramePool_HandleTypeDef *hpool, uint32_t Address)
+{
+  FramePool_BufferTypeDef *buffer = FramePool_Find(hpool, Address);
+
+  if ((buffer == NULL) || (buffer->RefCount == 0U) || (buffer->Owner == FRAME_POOL_OWNER_CPU))
+  {
+    return HAL_ERROR;
+  }
+
+  if (buffer->Owner == FRAME_POOL_OWNER_DEVICE_WRITE)
+  {
+    /* Lines speculatively fetched while the master was writing are stale */
+    SCB_InvalidateDCache_by_Addr((uint32_t *)Address, (int32_t)hpool->BufferSize);
+  }
+  buffer->Owner = FRAME_POOL_OWNER_CPU;
+
+  return HAL_OK;
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  Get the descriptor of a buffer from its start address
+  * @retval NULL if the address is not a buffer of the pool
+  */
+static FramePool_BufferTypeDef *FramePool_Find(FramePool_HandleTypeDef *hpool, uint32_t Address)
+{
+  uint32_t i;
+
+  for (i = 0; i < hpool->NbBuffers; i++)
+  {
+    if (hpool->Buffer[i].Address == Address)
+    {
+      return &hpool->Buffer[i];
+    }
+  }
+
+  return NULL;
+}
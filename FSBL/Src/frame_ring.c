@@ -0,0 +1,453 @@
+/**
+  ******************************************************************************
+  * @file    frame_ring.c
+  * @brief   Capture-to-display frame buffer ring.
+  *
+  *          The DCMIPP pipe runs in double buffer mode (DBM): it alternates
+  *          between the two addresses programmed in its memory address
+  *          registers (slot 0 and slot 1). Each buffer of the ring has a
+  *          single owner at a time: the DCMIPP (capture), the application
+  *          (processing) or the LTDC (scan-out).
+  *
+  *          - With 2 buffers, the ring is a plain ping-pong: the completed
+  *            buffer is flipped to the LTDC at the next vertical blanking
+  *            while the DCMIPP fills the other one.
+  *          - With 3 or more buffers, the completed buffer is published as
+  *            READY and the slot it leaves is refilled with a FREE buffer,
+  *            either immediately from the frame event or, when none is
+  *            available, as soon as the LTDC releases the buffer it was
+  *            scanning out (reload event).
+  *          - A slot left without FREE buffer is given the buffer the DCMIPP
+  *            is writing: the DCMIPP never writes a buffer owned elsewhere,
+  *            the next frame is captured in place of the current one and the
+  *            current one is dropped (SkipCount) until a buffer is freed.
+  *
+  *          A ring created without LTDC handle is a capture only stream (for
+  *          instance feeding an inference engine): complete frames are
+  *          published as READY and given back with FrameRing_ReleaseBuffer().
+  *          With 2 buffers, frames are dropped from the claim of a frame
+  *          until it is released.
+  *
+  *          Each buffer carries the record of the frame it holds. The record
+  *          staged at the frame start with FrameRing_SetFrameMeta() is copied
+  *          into the buffer at the frame event, before the buffer is published
+  *          as READY: the record is only written while the DCMIPP owns the
+  *          buffer, so the owner of a claimed buffer reads it without lock.
+  *
+  *          Frame and reload events are expected to be handled at the same
+  *          interrupt priority. Application side calls mask interrupts while
+  *          they update the ring.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "frame_ring.h"
+#include <string.h>
+
+/* Private function prototypes -----------------------------------------------*/
+static uint8_t FrameRing_FindBuffer(const FrameRing_HandleTypeDef *hring, uint32_t Address);
+static void FrameRing_Recycle(FrameRing_HandleTypeDef *hring, uint8_t Index);
+static void FrameRing_Refill(FrameRing_HandleTypeDef *hring);
+static void FrameRing_AttachMeta(FrameRing_HandleTypeDef *hring, uint8_t Index);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Initialize a frame buffer ring
+  * @param  hring      Ring handle
+  * @param  hdcmipp    DCMIPP handle, pipe already configured
+  * @param  hltdc      LTDC handle, layer already configured, NULL for a
+  *                    capture only ring
+  * @param  Pipe       DCMIPP pipe filling the ring
+  * @param  LayerIdx   LTDC layer scanning out the ring
+  * @param  pAddress   Array of NbBuffers buffer addresses
+  * @param  NbBuffers  Number of buffers (2 up to FRAME_RING_MAX_BUFFERS)
+  * @retval HAL status
+  */
+HAL_StatusTypeDef FrameRing_Init(FrameRing_HandleTypeDef *hring, DCMIPP_HandleTypeDef *hdcmipp,
+                                 LTDC_HandleTypeDef *hltdc, uint32_t Pipe, uint32_t LayerIdx,
+                                 const uint32_t *pAddress, uint32_t NbBuffers)
+{
+  uint32_t i;
+
+  if ((hring == NULL) || (hdcmipp == NULL) || (pAddress == NULL) ||
+      (NbBuffers < 2U) || (NbBuffers > FRAME_RING_MAX_BUFFERS))
+  {
+    return HAL_ERROR;
+  }
+
+  hring->hdcmipp   = hdcmipp;
+  hring->hltdc     = hltdc;
+  hring->Pipe      = Pipe;
+  hring->LayerIdx  = LayerIdx;
+  hring->NbBuffers = NbBuffers;
+
+  for (i = 0; i < FRAME_RING_MAX_BUFFERS; i++)
+  {
+    hring->Buffer[i].Address = (i < NbBuffers) ? pAddress[i] : 0U;
+    hring->Buffer[i].Owner   = FRAME_BUF_FREE;
+    hring->Buffer[i].FrameId = 0;
+    memset(&hring->Buffer[i].Meta, 0, sizeof(hring->Buffer[i].Meta));
+  }
+  memset(&hring->NextMeta, 0, sizeof(hring->NextMeta));
+
+  /* First two buffers are handed to the DCMIPP */
+  hring->Slot[0]          = 0;
+  hring->Slot[1]          = 1;
+  hring->Buffer[0].Owner  = FRAME_BUF_CAPTURE;
+  hring->Buffer[1].Owner  = FRAME_BUF_CAPTURE;
+  hring->ActiveSlot       = 0;
+  hring->Ready            = FRAME_RING_NO_BUFFER;
+  hring->Pending          = FRAME_RING_NO_BUFFER;
+  hring->Display          = FRAME_RING_NO_BUFFER;
+
+  hring->FrameCount = 0;
+  hring->DropCount  = 0;
+  hring->SkipCount  = 0;
+  hring->FlipCount  = 0;
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Start the capture in double buffer mode and scan out the spare buffer
+  * @param  hring           Ring handle
+  * @param  VirtualChannel  CSI virtual channel feeding the pipe
+  * @retval HAL status
+  */
+HAL_StatusTypeDef FrameRing_Start(FrameRing_HandleTypeDef *hring, uint32_t VirtualChannel)
+{
+  if ((hring->hltdc != NULL) && (hring->NbBuffers > 2U))
+  {
+    /* The LTDC owns the third buffer until the first frame is presented */
+    hring->Buffer[2].Owner = FRAME_BUF_DISPLAY;
+    hring->Display         = 2;
+
+    if (HAL_LTDC_SetAddress_NoReload(hring->hltdc, hring->Buffer[2].Address, hring->LayerIdx) != HAL_OK)
+    {
+      return HAL_ERROR;
+    }
+    if (HAL_LTDC_Reload(hring->hltdc, LTDC_RELOAD_IMMEDIATE) != HAL_OK)
+    {
+      return HAL_ERROR;
+    }
+  }
+
+  return HAL_DCMIPP_CSI_PIPE_DoubleBufferStart(hring->hdcmipp, hring->Pipe, VirtualChannel,
+                                               hring->Buffer[0].Address, hring->Buffer[1].Address,
+                                               DCMIPP_MODE_CONTINUOUS);
+}
+
+/**
+  * @brief  Claim the latest complete frame for processing
+  * @note   The caller owns the buffer until FrameRing_PresentBuffer() or
+  *         FrameRing_ReleaseBuffer(). D-Cache maintenance is left to the caller.
+  * @param  hring     Ring handle
+  * @param  pAddress  Address of the claimed buffer
+  * @retval HAL_OK if a frame was claimed, HAL_BUSY if none is ready
+  */
+HAL_StatusTypeDef FrameRing_GetReadyBuffer(FrameRing_HandleTypeDef *hring, uint32_t *pAddress)
+{
+  HAL_StatusTypeDef status = HAL_BUSY;
+  uint32_t primask = __get_PRIMASK();
+  uint8_t index;
+
+  __disable_irq();
+  index = hring->Ready;
+  if (index != FRAME_RING_NO_BUFFER)
+  {
+    hring->Buffer[index].Owner = FRAME_BUF_PROCESS;
+    hring->Ready = FRAME_RING_NO_BUFFER;
+    *pAddress = hring->Buffer[index].Address;
+    status = HAL_OK;
+  }
+  __set_PRIMASK(primask);
+
+  return status;
+}
+
+/**
+  * @brief  Queue a processed buffer for scan-out at the next vertical blanking
+  * @param  hring    Ring handle
+  * @param  Address  Buffer previously claimed with FrameRing_GetReadyBuffer()
+  * @retval HAL_OK, HAL_BUSY if a flip is already pending, HAL_ERROR otherwise
+  */
+HAL_StatusTypeDef FrameRing_PresentBuffer(FrameRing_HandleTypeDef *hring, uint32_t Address)
+{
+  HAL_StatusTypeDef status = HAL_ERROR;
+  uint32_t primask = __get_PRIMASK();
+  uint8_t index = FrameRing_FindBuffer(hring, Address);
+
+  if ((index == FRAME_RING_NO_BUFFER) || (hring->hltdc == NULL))
+  {
+    return HAL_ERROR;
+  }
+
+  __disable_irq();
+  if (hring->Buffer[index].Owner != FRAME_BUF_PROCESS)
+  {
+    status = HAL_ERROR;
+  }
+  else if (hring->Pending != FRAME_RING_NO_BUFFER)
+  {
+    status = HAL_BUSY;
+  }
+  else if (HAL_LTDC_SetAddress_NoReload(hring->hltdc, Address, hring->LayerIdx) != HAL_OK)
+  {
+    status = HAL_ERROR;
+  }
+  else
+  {
+    hring->Buffer[index].Owner = FRAME_BUF_DISPLAY_PENDING;
+    hring->Pending = index;
+    status = HAL_LTDC_Reload(hring->hltdc, LTDC_RELOAD_VERTICAL_BLANKING);
+  }
+  __set_PRIMASK(primask);
+
+  return status;
+}
+
+/**
+  * @brief  Give back a claimed buffer without displaying it
+  * @param  hring    Ring handle
+  * @param  Address  Buffer previously claimed with FrameRing_GetReadyBuffer()
+  * @retval HAL status
+  */
+HAL_StatusTypeDef FrameRing_ReleaseBuffer(FrameRing_HandleTypeDef *hring, uint32_t Address)
+{
+  HAL_StatusTypeDef status = HAL_ERROR;
+  uint32_t primask = __get_PRIMASK();
+  uint8_t index = FrameRing_FindBuffer(hring, Address);
+
+  if (index == FRAME_RING_NO_BUFFER)
+  {
+    return HAL_ERROR;
+  }
+
+  __disable_irq();
+  if (hring->Buffer[index].Owner == FRAME_BUF_PROCESS)
+  {
+    hring->DropCount++;
+    FrameRing_Recycle(hring, index);
+    FrameRing_Refill(hring);
+    status = HAL_OK;
+  }
+  __set_PRIMASK(primask);
+
+  return status;
+}
+
+/**
+  * @brief  Get the record of the frame held by a buffer
+  * @note   The record does not change while the caller owns the buffer, from
+  *         FrameRing_GetReadyBuffer() to FrameRing_PresentBuffer() or
+  *         FrameRing_ReleaseBuffer().
+  * @param  hring    Ring handle
+  * @param  Address  Buffer claimed with FrameRing_GetReadyBuffer()
+  * @retval Frame record, NULL if the address is not in the ring
+  */
+const FrameBuf_MetaTypeDef *FrameRing_GetMeta(const FrameRing_HandleTypeDef *hring, uint32_t Address)
+{
+  uint8_t index = FrameRing_FindBuffer(hring, Address);
+
+  if (index == FRAME_RING_NO_BUFFER)
+  {
+    return NULL;
+  }
+
+  return &hring->Buffer[index].Meta;
+}
+
+/**
+  * @brief  Stage the record of the frame starting, attached to its buffer at the frame event
+  * @note   To be called from HAL_DCMIPP_PIPE_VsyncEventCallback() for the ring
+  *         pipe, at the priority of the frame event.
+  * @param  hring  Ring handle
+  * @param  pMeta  Frame record, FrameId is set by the ring
+  * @retval None
+  */
+void FrameRing_SetFrameMeta(FrameRing_HandleTypeDef *hring, const FrameBuf_MetaTypeDef *pMeta)
+{
+  hring->NextMeta = *pMeta;
+  hring->NextMeta.Valid = 1;
+}
+
+/**
+  * @brief  To be called from HAL_DCMIPP_PIPE_FrameEventCallback() for the ring pipe
+  * @param  hring  Ring handle
+  * @retval None
+  */
+void FrameRing_FrameEventHandler(FrameRing_HandleTypeDef *hring)
+{
+  uint8_t slot = hring->ActiveSlot;
+  uint8_t index = hring->Slot[slot];
+
+  /* The DCMIPP has switched to the other slot */
+  hring->ActiveSlot = slot ^ 1U;
+  hring->FrameCount++;
+
+  if ((hring->hltdc != NULL) && (hring->NbBuffers == 2U))
+  {
+    /* Ping-pong: scan out the buffer just completed */
+    hring->Buffer[index].FrameId = hring->FrameCount;
+    FrameRing_AttachMeta(hring, index);
+    (void)HAL_LTDC_SetAddress_NoReload(hring->hltdc, hring->Buffer[index].Address, hring->LayerIdx);
+    (void)HAL_LTDC_Reload(hring->hltdc, LTDC_RELOAD_VERTICAL_BLANKING);
+    return;
+  }
+
+  if (hring->Slot[slot ^ 1U] == index)
+  {
+    /* No free buffer was left for the slot: the DCMIPP writes the same buffer
+       again, the frame just captured is dropped */
+    hring->NextMeta.Valid = 0;
+    hring->SkipCount++;
+    FrameRing_Refill(hring);
+    return;
+  }
+
+  /* Latest frame wins: an unclaimed older frame goes back to the pool */
+  if (hring->Ready != FRAME_RING_NO_BUFFER)
+  {
+    hring->DropCount++;
+    FrameRing_Recycle(hring, hring->Ready);
+  }
+
+  /* Record first: the buffer changes hands when published */
+  hring->Buffer[index].FrameId = hring->FrameCount;
+  FrameRing_AttachMeta(hring, index);
+  hring->Buffer[index].Owner   = FRAME_BUF_READY;
+  hring->Ready = index;
+
+  FrameRing_Refill(hring);
+}
+
+/**
+  * @brief  To be called from HAL_LTDC_ReloadEventCallback()
+  * @param  hring  Ring handle
+  * @retval None
+  */
+void FrameRing_ReloadEventHandler(FrameRing_HandleTypeDef *hring)
+{
+  hring->FlipCount++;
+
+  if (hring->Pending == FRAME_RING_NO_BUFFER)
+  {
+    return;
+  }
+
+  /* The pending buffer is now scanned out, the previous one is released */
+  if (hring->Display != FRAME_RING_NO_BUFFER)
+  {
+    FrameRing_Recycle(hring, hring->Display);
+  }
+  hring->Buffer[hring->Pending].Owner = FRAME_BUF_DISPLAY;
+  hring->Display = hring->Pending;
+  hring->Pending = FRAME_RING_NO_BUFFER;
+
+  FrameRing_Refill(hring);
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  Get the ring index of a buffer address
+  * @retval Index or FRAME_RING_NO_BUFFER
+  */
+static uint8_t FrameRing_FindBuffer(const FrameRing_HandleTypeDef *hring, uint32_t Address)
+{
+  uint8_t i;
+
+  for (i = 0; i < hring->NbBuffers; i++)
+  {
+    if (hring->Buffer[i].Address == Address)
+    {
+      return i;
+    }
+  }
+
+  return FRAME_RING_NO_BUFFER;
+}
+
+/**
+  * @brief  Return a buffer to the pool. A buffer still programmed in a DBM
+  *         slot goes back to the DCMIPP instead of the free list.
+  * @retval None
+  */
+static void FrameRing_Recycle(FrameRing_HandleTypeDef *hring, uint8_t Index)
+{
+  if ((hring->Slot[0] == Index) || (hring->Slot[1] == Index))
+  {
+    hring->Buffer[Index].Owner = FRAME_BUF_CAPTURE;
+  }
+  else
+  {
+    hring->Buffer[Index].Owner = FRAME_BUF_FREE;
+  }
+}
+
+/**
+  * @brief  Program a free buffer in the DBM slot written next, if its buffer
+  *         was handed over or if it shares the buffer of the slot being written.
+  *         With no free buffer, the slot is given the buffer being written.
+  * @retval None
+  */
+static void FrameRing_Refill(FrameRing_HandleTypeDef *hring)
+{
+  uint8_t active = hring->ActiveSlot;
+  uint8_t slot = active ^ 1U;
+  uint8_t index = hring->Slot[active];
+  uint8_t i;
+
+  if ((hring->Buffer[hring->Slot[slot]].Owner == FRAME_BUF_CAPTURE) && (hring->Slot[slot] != index))
+  {
+    return;
+  }
+
+  for (i = 0; i < hring->NbBuffers; i++)
+  {
+    if (hring->Buffer[i].Owner == FRAME_BUF_FREE)
+    {
+      index = i;
+      break;
+    }
+  }
+
+  if ((index != hring->Slot[slot]) &&
+      (HAL_DCMIPP_PIPE_SetMemoryAddress(hring->hdcmipp, hring->Pipe,
+                                        (slot == 0U) ? DCMIPP_MEMORY_ADDRESS_0 : DCMIPP_MEMORY_ADDRESS_1,
+                                        hring->Buffer[index].Address) == HAL_OK))
+  {
+    hring->Slot[slot] = index;
+    hring->Buffer[index].Owner = FRAME_BUF_CAPTURE;
+  }
+}
+
+/**
+  * @brief  Move the staged frame record to the buffer just completed
+  * @retval None
+  */
+static void FrameRing_AttachMeta(FrameRing_HandleTypeDef *hring, uint8_t Index)
+{
+  FrameBuf_MetaTypeDef *meta = &hring->Buffer[Index].Meta;
+
+  if (hring->NextMeta.Valid != 0U)
+  {
+    *meta = hring->NextMeta;
+  }
+  else
+  {
+    /* No record captured at this frame start */
+    memset(meta, 0, sizeof(*meta));
+  }
+  meta->FrameId = hring->FrameCount;
+  hring->NextMeta.Valid = 0;
+}
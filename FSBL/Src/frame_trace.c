@@ -0,0 +1,358 @@
+/**
+  ******************************************************************************
+  * @file    frame_trace.c
+  * @brief   Per-frame timing instrumentation.
+  *
+  *          The interrupt handlers and the ISP background process timestamp
+  *          their events with the DWT cycle counter into a ring of records.
+  *          A producer claims its slot with an exclusive access on the ring
+  *          head, so a handler preempting another producer never blocks nor
+  *          masks the interrupts, and publishes the record once written.
+  *          When the ring is full the record is dropped and counted.
+  *
+  *          FrameTrace_Process() drains the ring from the main loop and
+  *          builds the statistics: frame period, interrupt handler
+  *          durations and start-of-frame to LTDC reload latency.
+  *          FrameTrace_Report() prints them on the COM log with the frames
+  *          dropped according to the DCMIPP frame counter, then starts a
+  *          new measurement window.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "frame_trace.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Private constants ---------------------------------------------------------*/
+static const char *const FrameTrace_IsrName[FRAME_TRACE_NB_ISR] = {"CSI", "DCMIPP", "LTDC"};
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t FrameTrace_CyclesToNs(uint32_t Cycles);
+static void FrameTrace_HistInit(FrameTrace_HistogramTypeDef *hist, uint32_t BinWidthUs);
+static void FrameTrace_HistAdd(FrameTrace_HistogramTypeDef *hist, uint32_t Cycles);
+static void FrameTrace_HistPrint(const char *pName, const FrameTrace_HistogramTypeDef *hist);
+static void FrameTrace_Handle(FrameTrace_HandleTypeDef *htrace, const FrameTrace_RecordTypeDef *pRecord);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Initialize the trace
+  * @note   The DWT cycle counter must be running.
+  * @param  htrace   Trace handle
+  * @param  hdcmipp  DCMIPP device handle, for the hardware frame counter
+  * @param  Pipe     Pipe whose frames are followed up to the display
+  * @retval HAL status
+  */
+HAL_StatusTypeDef FrameTrace_Init(FrameTrace_HandleTypeDef *htrace, DCMIPP_HandleTypeDef *hdcmipp, uint32_t Pipe)
+{
+  uint32_t i;
+
+  if ((htrace == NULL) || (hdcmipp == NULL))
+  {
+    return HAL_ERROR;
+  }
+
+  memset(htrace, 0, sizeof(*htrace));
+  htrace->hdcmipp = hdcmipp;
+  htrace->Pipe    = Pipe;
+
+  for (i = 0; i < FRAME_TRACE_NB_ISR; i++)
+  {
+    FrameTrace_HistInit(&htrace->Isr[i], 0);
+  }
+  FrameTrace_HistInit(&htrace->Latency, FRAME_TRACE_LATENCY_BIN_MS * 1000U);
+
+  (void)HAL_DCMIPP_PIPE_ReadFrameCounter(hdcmipp, Pipe, &htrace->HwFrameCount);
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Timestamp an event, from any interrupt handler or the background
+  * @param  htrace  Trace handle
+  * @param  Event   Event that occurred
+  * @param  Arg     Frame id or duration, see @ref FrameTrace_EventTypeDef
+  * @retval None
+  */
+void FrameTrace_Record(FrameTrace_HandleTypeDef *htrace, FrameTrace_EventTypeDef Event, uint32_t Arg)
+{
+  uint32_t cycles = FRAME_TRACE_TIMESTAMP();
+  FrameTrace_RecordTypeDef *record;
+  uint32_t head;
+
+  /* Claim a slot: a preempting producer makes the store fail and the claim is retried */
+  do
+  {
+    head = __LDREXW(&htrace->Head);
+    if ((head - htrace->Tail) >= FRAME_TRACE_RING_SIZE)
+    {
+      __CLREX();
+      htrace->LostCount++;
+      return;
+    }
+  } while (__STREXW(head + 1U, &htrace->Head) != 0U);
+
+  record = &htrace->Ring[head & (FRAME_TRACE_RING_SIZE - 1U)];
+  record->Cycles = cycles;
+  record->Arg    = Arg;
+  record->Event  = (uint32_t)Event;
+
+  /* Publish the record once fully written */
+  __DMB();
+  record->Seq = head + 1U;
+}
+
+/**
+  * @brief  Drain the records, to be called from the main loop
+  * @param  htrace  Trace handle
+  * @retval None
+  */
+void FrameTrace_Process(FrameTrace_HandleTypeDef *htrace)
+{
+  FrameTrace_RecordTypeDef record;
+  FrameTrace_RecordTypeDef *slot;
+  uint32_t tail = htrace->Tail;
+
+  for (;;)
+  {
+    slot = &htrace->Ring[tail & (FRAME_TRACE_RING_SIZE - 1U)];
+    if (slot->Seq != (tail + 1U))
+    {
+      /* Empty, or the slot is claimed but not yet written */
+      break;
+    }
+    __DMB();
+    record = *slot;
+
+    /* Give the slot back to the producers */
+    __DMB();
+    tail++;
+    htrace->Tail = tail;
+
+    FrameTrace_Handle(htrace, &record);
+  }
+}
+
+/**
+  * @brief  Print the statistics of the current window and start a new one
+  * @param  htrace  Trace handle
+  * @retval None
+  */
+void FrameTrace_Report(FrameTrace_HandleTypeDef *htrace)
+{
+  uint32_t frames, hwFrames;
+  uint32_t dropped = 0;
+  uint32_t fps100 = 0;
+  uint32_t i;
+
+  FrameTrace_Process(htrace);
+  frames = htrace->EventCount[FRAME_TRACE_FRAME_COMPLETE];
+
+  /* Frames received by the DCMIPP but never completed on the pipe */
+  if (HAL_DCMIPP_PIPE_ReadFrameCounter(htrace->hdcmipp, htrace->Pipe, &hwFrames) == HAL_OK)
+  {
+    if ((hwFrames - htrace->HwFrameCount) > frames)
+    {
+      dropped = (hwFrames - htrace->HwFrameCount) - frames;
+    }
+    htrace->HwFrameCount = hwFrames;
+  }
+  htrace->DroppedCount += dropped;
+
+  if (htrace->FramePeriodSum != 0U)
+  {
+    fps100 = (uint32_t)(((uint64_t)SystemCoreClock * 100U * htrace->FramePeriodCount) / htrace->FramePeriodSum);
+  }
+
+  printf("\r\n[trace] %lu.%02lu fps, %lu frames, %lu dropped (%lu total), period max %lu us, %lu records lost\r\n",
+         fps100 / 100U, fps100 % 100U, frames, dropped, htrace->DroppedCount,
+         FrameTrace_CyclesToNs(htrace->FramePeriodMax) / 1000U, htrace->LostCount);
+  printf("[trace] events: sof %lu vsync %lu stat %lu aec %lu awb %lu reload %lu\r\n",
+         htrace->EventCount[FRAME_TRACE_CSI_SOF], htrace->EventCount[FRAME_TRACE_VSYNC],
+         htrace->EventCount[FRAME_TRACE_STAT_READY], htrace->EventCount[FRAME_TRACE_AEC_APPLY],
+         htrace->EventCount[FRAME_TRACE_AWB_APPLY], htrace->EventCount[FRAME_TRACE_LTDC_RELOAD]);
+  for (i = 0; i < FRAME_TRACE_NB_ISR; i++)
+  {
+    FrameTrace_HistPrint(FrameTrace_IsrName[i], &htrace->Isr[i]);
+  }
+  FrameTrace_HistPrint("latency", &htrace->Latency);
+
+  /* New window */
+  memset(htrace->EventCount, 0, sizeof(htrace->EventCount));
+  htrace->FramePeriodCount = 0;
+  htrace->FramePeriodSum   = 0;
+  htrace->FramePeriodMax   = 0;
+  htrace->LostCount        = 0;
+  for (i = 0; i < FRAME_TRACE_NB_ISR; i++)
+  {
+    FrameTrace_HistInit(&htrace->Isr[i], 0);
+  }
+  FrameTrace_HistInit(&htrace->Latency, FRAME_TRACE_LATENCY_BIN_MS * 1000U);
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  Update the statistics with one record
+  * @retval None
+  */
+static void FrameTrace_Handle(FrameTrace_HandleTypeDef *htrace, const FrameTrace_RecordTypeDef *pRecord)
+{
+  FrameTrace_InflightTypeDef *frame;
+  uint32_t period;
+
+  if (pRecord->Event >= FRAME_TRACE_NB_EVENTS)
+  {
+    return;
+  }
+  htrace->EventCount[pRecord->Event]++;
+
+  switch (pRecord->Event)
+  {
+    case FRAME_TRACE_CSI_SOF:
+      frame = &htrace->Inflight[pRecord->Arg & (FRAME_TRACE_MAX_INFLIGHT - 1U)];
+      frame->FrameId   = pRecord->Arg;
+      frame->SofCycles = pRecord->Cycles;
+      frame->Valid     = 1;
+      break;
+
+    case FRAME_TRACE_FRAME_COMPLETE:
+      /* The records of concurrent producers may land slightly out of order */
+      period = pRecord->Cycles - htrace->LastFrameCycles;
+      if ((htrace->LastFrameCycles != 0U) && ((int32_t)period > 0))
+      {
+        htrace->FramePeriodSum += period;
+        htrace->FramePeriodCount++;
+        if (period > htrace->FramePeriodMax)
+        {
+          htrace->FramePeriodMax = period;
+        }
+      }
+      htrace->LastFrameCycles = pRecord->Cycles;
+      break;
+
+    case FRAME_TRACE_LTDC_RELOAD:
+      /* Reloads without a new buffer show the same frame again */
+      frame = &htrace->Inflight[pRecord->Arg & (FRAME_TRACE_MAX_INFLIGHT - 1U)];
+      if ((frame->Valid != 0U) && (frame->FrameId == pRecord->Arg))
+      {
+        FrameTrace_HistAdd(&htrace->Latency, pRecord->Cycles - frame->SofCycles);
+        frame->Valid = 0;
+      }
+      break;
+
+    case FRAME_TRACE_ISR_CSI:
+    case FRAME_TRACE_ISR_DCMIPP:
+    case FRAME_TRACE_ISR_LTDC:
+      FrameTrace_HistAdd(&htrace->Isr[pRecord->Event - FRAME_TRACE_ISR_CSI], pRecord->Arg);
+      break;
+
+    default:
+      /* Counted only */
+      break;
+  }
+}
+
+/**
+  * @brief  Convert cycle counter ticks into nanoseconds
+  * @retval Duration, saturated to 4.29 s
+  */
+static uint32_t FrameTrace_CyclesToNs(uint32_t Cycles)
+{
+  uint64_t ns = ((uint64_t)Cycles * 1000000000U) / SystemCoreClock;
+
+  return (ns > UINT32_MAX) ? UINT32_MAX : (uint32_t)ns;
+}
+
+/**
+  * @brief  Empty a histogram
+  * @retval None
+  */
+static void FrameTrace_HistInit(FrameTrace_HistogramTypeDef *hist, uint32_t BinWidthUs)
+{
+  memset(hist, 0, sizeof(*hist));
+  hist->BinWidthUs = BinWidthUs;
+  hist->MinNs      = UINT32_MAX;
+}
+
+/**
+  * @brief  Add a duration to a histogram
+  * @retval None
+  */
+static void FrameTrace_HistAdd(FrameTrace_HistogramTypeDef *hist, uint32_t Cycles)
+{
+  uint32_t ns = FrameTrace_CyclesToNs(Cycles);
+  uint32_t us = ns / 1000U;
+  uint32_t bin;
+
+  if (hist->BinWidthUs == 0U)
+  {
+    bin = (us == 0U) ? 0U : (32U - (uint32_t)__CLZ(us));
+  }
+  else
+  {
+    bin = us / hist->BinWidthUs;
+  }
+  if (bin >= FRAME_TRACE_HIST_BINS)
+  {
+    bin = FRAME_TRACE_HIST_BINS - 1U;
+  }
+
+  hist->Bin[bin]++;
+  hist->Count++;
+  hist->SumNs += ns;
+  if (ns < hist->MinNs)
+  {
+    hist->MinNs = ns;
+  }
+  if (ns > hist->MaxNs)
+  {
+    hist->MaxNs = ns;
+  }
+}
+
+/**
+  * @brief  Print a histogram: summary line then the non empty bins
+  * @retval None
+  */
+static void FrameTrace_HistPrint(const char *pName, const FrameTrace_HistogramTypeDef *hist)
+{
+  uint32_t avg, low, i;
+
+  if (hist->Count == 0U)
+  {
+    printf("[trace] %-7s: none\r\n", pName);
+    return;
+  }
+
+  avg = (uint32_t)(hist->SumNs / hist->Count);
+  printf("[trace] %-7s: %lu, min %lu.%01lu avg %lu.%01lu max %lu.%01lu us |", pName, hist->Count,
+         hist->MinNs / 1000U, (hist->MinNs % 1000U) / 100U, avg / 1000U, (avg % 1000U) / 100U,
+         hist->MaxNs / 1000U, (hist->MaxNs % 1000U) / 100U);
+  for (i = 0; i < FRAME_TRACE_HIST_BINS; i++)
+  {
+    if (hist->Bin[i] == 0U)
+    {
+      continue;
+    }
+    if (hist->BinWidthUs == 0U)
+    {
+      low = (i == 0U) ? 0U : (1UL << (i - 1U));
+    }
+    else
+    {
+      low = i * hist->BinWidthUs;
+    }
+    printf(" %s%lu:%lu", (i == (FRAME_TRACE_HIST_BINS - 1U)) ? ">=" : "", low, hist->Bin[i]);
+  }
+  printf("\r\n");
+}
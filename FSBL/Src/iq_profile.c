@@ -0,0 +1,312 @@
+/**
+  ******************************************************************************
+  * @file    iq_profile.c
+  * @brief   IQ parameter profiles in the XSPI NOR.
+  *
+  *          The IQ parameters given to ISP_Init() come from a profile image
+  *          written in the NOR flash instead of being compiled in, so a new
+  *          tuning only needs the image to be written again.
+  *
+  *          The image is used in place through the memory-mapped mode: the
+  *          payloads are ISP_IQParamTypeDef structures as laid out by the
+  *          firmware, ISP_Init() gets a pointer into the NOR and copies it
+  *          into its cache. At boot only the header and the directory are
+  *          checked; the payload CRC is checked when a profile is selected.
+  *
+  *          The same file builds the host tool (IQ_PROFILE_HOST defined), the
+  *          NOR programming is then left out.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "iq_profile.h"
+#include <stddef.h>
+#include <string.h>
+#ifndef IQ_PROFILE_HOST
+#include "isp_api.h"
+#include "stm32n6570_discovery_xspi.h"
+#endif
+
+/* Private constants ---------------------------------------------------------*/
+/* Reflected CRC-32 (IEEE 802.3) polynomial, one nibble at a time */
+static const uint32_t IQProfile_CrcTable[16] =
+{
+  0x00000000U, 0x1DB71064U, 0x3B6E20C8U, 0x26D930ACU, 0x76DC4190U, 0x6B6B51F4U, 0x4DB26158U, 0x5005713CU,
+  0xEDB88320U, 0xF00F9344U, 0xD6D6A3E8U, 0xCB61B38CU, 0x9B64C2B0U, 0x86D3D2D4U, 0xA00AE278U, 0xBDBDF21CU,
+};
+
+#ifndef IQ_PROFILE_HOST
+/* Erase granularity of the profile area */
+#define IQ_PROFILE_BLOCK_SIZE       (64U * 1024U)
+#endif
+
+/* Private function prototypes -----------------------------------------------*/
+static HAL_StatusTypeDef IQProfile_CheckDirectory(const IQProfile_HeaderTypeDef *pHeader, uint32_t MaxSize);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Attach a profile image, checking its header and directory
+  * @param  hprof    Profile image handle
+  * @param  pImage   Image, in the memory-mapped NOR
+  * @param  MaxSize  Size of the profile area
+  * @retval HAL_ERROR if there is no valid image at pImage
+  */
+HAL_StatusTypeDef IQProfile_Init(IQProfile_HandleTypeDef *hprof, const void *pImage, uint32_t MaxSize)
+{
+  const IQProfile_HeaderTypeDef *header = (const IQProfile_HeaderTypeDef *)pImage;
+
+  if ((hprof == NULL) || (pImage == NULL))
+  {
+    return HAL_ERROR;
+  }
+
+  hprof->pHeader = NULL;
+  hprof->pEntry  = NULL;
+  if (IQProfile_CheckDirectory(header, MaxSize) != HAL_OK)
+  {
+    return HAL_ERROR;
+  }
+
+  hprof->pHeader = header;
+  hprof->pEntry  = (const IQProfile_EntryTypeDef *)&header[1];
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Select the profile of a sensor mode
+  * @param  hprof    Profile image handle
+  * @param  Sensor   Sensor name
+  * @param  Mode     Sensor resolution
+  * @param  ppParam  IQ parameters, in place in the image (output parameter)
+  * @retval HAL_ERROR if the profile is missing or corrupted
+  */
+HAL_StatusTypeDef IQProfile_Find(const IQProfile_HandleTypeDef *hprof, const char *Sensor, uint32_t Mode,
+                                 const ISP_IQParamTypeDef **ppParam)
+{
+  const IQProfile_EntryTypeDef *entry;
+  const uint8_t *payload;
+  uint32_t i;
+
+  if ((hprof == NULL) || (hprof->pHeader == NULL) || (Sensor == NULL) || (ppParam == NULL))
+  {
+    return HAL_ERROR;
+  }
+
+  for (i = 0; i < hprof->pHeader->NbEntries; i++)
+  {
+    entry = &hprof->pEntry[i];
+    if ((entry->Mode == Mode) && (strncmp(entry->Sensor, Sensor, IQ_PROFILE_SENSOR_LENGTH) == 0))
+    {
+      payload = (const uint8_t *)hprof->pHeader + entry->Offset;
+      if (IQProfile_Crc32(0, payload, entry->Size) != entry->Crc)
+      {
+        return HAL_ERROR;
+      }
+      *ppParam = (const ISP_IQParamTypeDef *)payload;
+      return HAL_OK;
+    }
+  }
+
+  return HAL_ERROR;
+}
+
+/**
+  * @brief  Check a whole image: header, directory and payloads
+  * @param  pImage  Image
+  * @param  Size    Image buffer size
+  * @retval HAL status
+  */
+HAL_StatusTypeDef IQProfile_Check(const uint8_t *pImage, uint32_t Size)
+{
+  const IQProfile_HeaderTypeDef *header = (const IQProfile_HeaderTypeDef *)pImage;
+  const IQProfile_EntryTypeDef *entry;
+  uint32_t i;
+
+  if ((pImage == NULL) || (IQProfile_CheckDirectory(header, Size) != HAL_OK))
+  {
+    return HAL_ERROR;
+  }
+
+  entry = (const IQProfile_EntryTypeDef *)&header[1];
+  for (i = 0; i < header->NbEntries; i++)
+  {
+    if (IQProfile_Crc32(0, &pImage[entry[i].Offset], entry[i].Size) != entry[i].Crc)
+    {
+      return HAL_ERROR;
+    }
+  }
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  CRC-32 (IEEE 802.3, as zlib crc32()), chained over several buffers
+  * @param  Crc    CRC of the previous buffers, 0 for the first one
+  * @param  pData  Buffer
+  * @param  Size   Buffer size
+  * @retval CRC
+  */
+uint32_t IQProfile_Crc32(uint32_t Crc, const void *pData, uint32_t Size)
+{
+  const uint8_t *data = (const uint8_t *)pData;
+  uint32_t i;
+
+  Crc = ~Crc;
+  for (i = 0; i < Size; i++)
+  {
+    Crc ^= data[i];
+    Crc = (Crc >> 4) ^ IQProfile_CrcTable[Crc & 0x0FU];
+    Crc = (Crc >> 4) ^ IQProfile_CrcTable[Crc & 0x0FU];
+  }
+
+  return ~Crc;
+}
+
+#ifndef IQ_PROFILE_HOST
+/**
+  * @brief  Switch a running ISP to the profile of another sensor mode
+  * @note   The ISP is initialized again with the new parameters and started,
+  *         the algorithms restart from their initial state.
+  * @param  hprof   Profile image handle
+  * @param  hIsp    ISP handle, initialized
+  * @param  Sensor  Sensor name
+  * @param  Mode    Sensor resolution
+  * @retval HAL_ERROR if the profile is missing or the ISP failed to restart
+  */
+HAL_StatusTypeDef IQProfile_Apply(const IQProfile_HandleTypeDef *hprof, ISP_HandleTypeDef *hIsp, const char *Sensor,
+                                  uint32_t Mode)
+{
+  const ISP_IQParamTypeDef *param;
+  ISP_AppliHelpersTypeDef helpers;
+  uint32_t cameraInstance;
+  void *hDcmipp;
+
+  if ((hIsp == NULL) || (IQProfile_Find(hprof, Sensor, Mode, &param) != HAL_OK))
+  {
+    return HAL_ERROR;
+  }
+
+  /* ISP_DeInit() clears the handle */
+  hDcmipp = hIsp->hDcmipp;
+  cameraInstance = hIsp->cameraInstance;
+  helpers = hIsp->appliHelpers;
+  if ((ISP_DeInit(hIsp) != ISP_OK) || (ISP_Init(hIsp, hDcmipp, cameraInstance, &helpers, param) != ISP_OK) ||
+      (ISP_Start(hIsp) != ISP_OK))
+  {
+    return HAL_ERROR;
+  }
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Write a profile image in the NOR
+  * @note   The NOR memory-mapped mode is left during the update and enabled
+  *         again afterwards; no profile of the area may be in use meanwhile.
+  * @param  Instance  XSPI NOR instance
+  * @param  Offset    Profile area offset in the NOR, 64 KB aligned
+  * @param  pImage    Image, checked before the NOR is erased
+  * @param  Size      Image size
+  * @retval HAL status
+  */
+HAL_StatusTypeDef IQProfile_Program(uint32_t Instance, uint32_t Offset, const uint8_t *pImage, uint32_t Size)
+{
+  HAL_StatusTypeDef status = HAL_OK;
+  uint32_t block;
+
+  if (((Offset % IQ_PROFILE_BLOCK_SIZE) != 0U) || (IQProfile_Check(pImage, Size) != HAL_OK))
+  {
+    return HAL_ERROR;
+  }
+  Size = ((const IQProfile_HeaderTypeDef *)pImage)->TotalSize;
+
+  if (BSP_XSPI_NOR_DisableMemoryMappedMode(Instance) != BSP_ERROR_NONE)
+  {
+    return HAL_ERROR;
+  }
+
+  for (block = 0; (block < Size) && (status == HAL_OK); block += IQ_PROFILE_BLOCK_SIZE)
+  {
+    if (BSP_XSPI_NOR_Erase_Block(Instance, Offset + block, BSP_XSPI_NOR_ERASE_64K) != BSP_ERROR_NONE)
+    {
+      status = HAL_ERROR;
+    }
+    else
+    {
+      while (BSP_XSPI_NOR_GetStatus(Instance) == BSP_ERROR_BUSY)
+      {
+      }
+    }
+  }
+  if ((status == HAL_OK) && (BSP_XSPI_NOR_Write(Instance, pImage, Offset, Size) != BSP_ERROR_NONE))
+  {
+    status = HAL_ERROR;
+  }
+
+  if (BSP_XSPI_NOR_EnableMemoryMappedMode(Instance) != BSP_ERROR_NONE)
+  {
+    return HAL_ERROR;
+  }
+
+  /* Read back through the memory-mapped window */
+  SCB_InvalidateDCache_by_Addr((uint32_t *)(XSPI2_BASE + Offset), (int32_t)Size);
+  if ((status == HAL_OK) && (memcmp((const void *)(XSPI2_BASE + Offset), pImage, Size) != 0))
+  {
+    status = HAL_ERROR;
+  }
+
+  return status;
+}
+#endif
+
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  Check the header and the directory of an image
+  * @retval HAL status
+  */
+static HAL_StatusTypeDef IQProfile_CheckDirectory(const IQProfile_HeaderTypeDef *pHeader, uint32_t MaxSize)
+{
+  const IQProfile_EntryTypeDef *entry = (const IQProfile_EntryTypeDef *)&pHeader[1];
+  uint32_t dirEnd;
+  uint32_t i;
+
+  if ((MaxSize < sizeof(IQProfile_HeaderTypeDef)) || (pHeader->Magic != IQ_PROFILE_MAGIC) ||
+      (IQProfile_Crc32(0, pHeader, offsetof(IQProfile_HeaderTypeDef, HeaderCrc)) != pHeader->HeaderCrc))
+  {
+    return HAL_ERROR;
+  }
+
+  /* Payloads laid out by another firmware are not usable in place */
+  dirEnd = sizeof(IQProfile_HeaderTypeDef) + (pHeader->NbEntries * sizeof(IQProfile_EntryTypeDef));
+  if ((pHeader->Version != IQ_PROFILE_VERSION) || (pHeader->ParamSize != sizeof(ISP_IQParamTypeDef)) ||
+      (pHeader->NbEntries > IQ_PROFILE_MAX_ENTRIES) || (pHeader->TotalSize > MaxSize) ||
+      (pHeader->TotalSize < dirEnd) ||
+      (IQProfile_Crc32(0, entry, pHeader->NbEntries * sizeof(IQProfile_EntryTypeDef)) != pHeader->DirCrc))
+  {
+    return HAL_ERROR;
+  }
+
+  for (i = 0; i < pHeader->NbEntries; i++)
+  {
+    if ((entry[i].Size != pHeader->ParamSize) || ((entry[i].Offset % IQ_PROFILE_ALIGN) != 0U) ||
+        (entry[i].Offset < dirEnd) || (entry[i].Offset > pHeader->TotalSize) ||
+        (entry[i].Size > (pHeader->TotalSize - entry[i].Offset)) ||
+        (entry[i].Sensor[IQ_PROFILE_SENSOR_LENGTH - 1U] != '\0'))
+    {
+      return HAL_ERROR;
+    }
+  }
+
+  return HAL_OK;
+}
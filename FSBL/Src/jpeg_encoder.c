@@ -0,0 +1,497 @@
+/**
+  ******************************************************************************
+  * @file    jpeg_encoder.c
+  * @brief   Hardware JPEG encoding of the YUV422 bands of a DCMIPP pixel pipe.
+  *
+  *          The pipe converts the ISP output to YUV422 (YUYV) and writes it
+  *          into a wrapping line buffer, one band per MCU row (8 lines). Each
+  *          band is reordered by the CPU into 16x8 MCUs (Y0, Y1, Cb, Cr blocks)
+  *          in one of two MCU row buffers, with no color conversion, and the
+  *          codec reads the MCU rows by DMA while the next one is tiled: the
+  *          codec input is paused when it gets ahead of the CPU.
+  *
+  *          The encoded streams are written by DMA in a bounded ring of
+  *          output slots. A frame is skipped when no slot is free, and is
+  *          dropped when it does not fit in its slot or when one of its
+  *          bands was overwritten before being tiled. Recording encodes
+  *          every frame (Motion-JPEG), a snapshot the next frame only.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "jpeg_encoder.h"
+
+/* Private define ------------------------------------------------------------*/
+/* D-Cache line size, alignment of the buffers shared with the DMA */
+#define JPEG_ENC_CACHE_LINE         32U
+
+/* Offsets of the blocks in a 4:2:2 MCU */
+#define JPEG_ENC_Y0_OFFSET          0U
+#define JPEG_ENC_Y1_OFFSET          64U
+#define JPEG_ENC_CB_OFFSET          128U
+#define JPEG_ENC_CR_OFFSET          192U
+
+/* Private function prototypes -----------------------------------------------*/
+static HAL_StatusTypeDef JpegEnc_ProcessBand(JpegEnc_HandleTypeDef *hjenc, const PipeSlice_BandTypeDef *pBand);
+static void JpegEnc_StartFrame(JpegEnc_HandleTypeDef *hjenc, uint32_t FrameId);
+static void JpegEnc_DropFrame(JpegEnc_HandleTypeDef *hjenc);
+static void JpegEnc_FeedRow(JpegEnc_HandleTypeDef *hjenc);
+static uint32_t JpegEnc_RowAddress(const JpegEnc_HandleTypeDef *hjenc, uint32_t Row);
+static uint32_t JpegEnc_SlotAddress(const JpegEnc_HandleTypeDef *hjenc);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Initialize the encoder and configure the codec
+  * @note   The codec must be initialized with HAL_JPEG_Init() beforehand and
+  *         the slice must deliver bands of JPEG_ENC_MCU_HEIGHT lines.
+  * @param  hjenc   Encoder handle
+  * @param  hjpeg   JPEG codec handle
+  * @param  hslice  Slice of the YUV422 pipe
+  * @param  pConf   Encoder configuration
+  * @retval HAL status
+  */
+HAL_StatusTypeDef JpegEnc_Init(JpegEnc_HandleTypeDef *hjenc, JPEG_HandleTypeDef *hjpeg,
+                               PipeSlice_HandleTypeDef *hslice, const JpegEnc_ConfTypeDef *pConf)
+{
+  JPEG_ConfTypeDef jpeg_conf = {0};
+
+  if ((hjenc == NULL) || (hjpeg == NULL) || (hslice == NULL) || (pConf == NULL) ||
+      (hslice->LinesPerBand != JPEG_ENC_MCU_HEIGHT) || (hslice->Height != pConf->Height) ||
+      ((pConf->Width % JPEG_ENC_MCU_WIDTH) != 0U) || ((pConf->Height % JPEG_ENC_MCU_HEIGHT) != 0U) ||
+      (pConf->NbSlots == 0U) || (pConf->NbSlots > JPEG_ENC_MAX_SLOTS) ||
+      ((pConf->SlotSize % JPEG_ENC_CACHE_LINE) != 0U) ||
+      ((pConf->McuAddress % JPEG_ENC_CACHE_LINE) != 0U) || ((pConf->OutAddress % JPEG_ENC_CACHE_LINE) != 0U))
+  {
+    return HAL_ERROR;
+  }
+
+  jpeg_conf.ColorSpace        = JPEG_YCBCR_COLORSPACE;
+  jpeg_conf.ChromaSubsampling = JPEG_422_SUBSAMPLING;
+  jpeg_conf.ImageWidth        = pConf->Width;
+  jpeg_conf.ImageHeight       = pConf->Height;
+  jpeg_conf.ImageQuality      = pConf->Quality;
+  if (HAL_JPEG_ConfigEncoding(hjpeg, &jpeg_conf) != HAL_OK)
+  {
+    return HAL_ERROR;
+  }
+
+  hjenc->hjpeg           = hjpeg;
+  hjenc->hslice          = hslice;
+  hjenc->Width           = pConf->Width;
+  hjenc->McuRows         = pConf->Height / JPEG_ENC_MCU_HEIGHT;
+  hjenc->McuRowSize      = (pConf->Width / JPEG_ENC_MCU_WIDTH) * JPEG_ENC_MCU_SIZE;
+  hjenc->McuAddress      = pConf->McuAddress;
+  hjenc->OutAddress      = pConf->OutAddress;
+  hjenc->SlotSize        = pConf->SlotSize;
+  hjenc->NbSlots         = pConf->NbSlots;
+  hjenc->Head            = 0;
+  hjenc->Tail            = 0;
+  hjenc->Record          = 0;
+  hjenc->SnapshotPending = 0;
+  hjenc->Active          = 0;
+  hjenc->Started         = 0;
+  hjenc->EncodedCount    = 0;
+  hjenc->DropCount       = 0;
+  hjenc->SkipCount       = 0;
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Start or stop encoding every frame (Motion-JPEG)
+  * @note   A frame being encoded when recording stops is completed.
+  * @param  hjenc   Encoder handle
+  * @param  Enable  1 to record, 0 to stop
+  * @retval None
+  */
+void JpegEnc_Record(JpegEnc_HandleTypeDef *hjenc, uint8_t Enable)
+{
+  hjenc->Record = Enable;
+}
+
+/**
+  * @brief  Encode the next frame starting on the pipe
+  * @param  hjenc  Encoder handle
+  * @retval None
+  */
+void JpegEnc_Snapshot(JpegEnc_HandleTypeDef *hjenc)
+{
+  hjenc->SnapshotPending = 1;
+}
+
+/**
+  * @brief  Tile the pending bands and feed the codec, to be called from the
+  *         main loop
+  * @note   A band is kept in the slice queue while both MCU row buffers are
+  *         in use, the pipe keeps writing the following bands meanwhile.
+  * @param  hjenc  Encoder handle
+  * @retval None
+  */
+void JpegEnc_Process(JpegEnc_HandleTypeDef *hjenc)
+{
+  PipeSlice_BandTypeDef band;
+
+  while (PipeSlice_GetBand(hjenc->hslice, &band) == HAL_OK)
+  {
+    if (JpegEnc_ProcessBand(hjenc, &band) != HAL_OK)
+    {
+      break;
+    }
+    /* The band was overwritten while being tiled: the MCU row is corrupted */
+    if ((PipeSlice_ReleaseBand(hjenc->hslice, &band) != HAL_OK) &&
+        (hjenc->Active != 0U) && (band.FrameId == hjenc->FrameId))
+    {
+      JpegEnc_DropFrame(hjenc);
+    }
+  }
+}
+
+/**
+  * @brief  Get the oldest encoded frame not yet released
+  * @note   The stream is written by DMA: D-Cache maintenance is left to the
+  *         caller.
+  * @param  hjenc   Encoder handle
+  * @param  pFrame  Encoded frame
+  * @retval HAL_OK if a frame is available, HAL_BUSY otherwise
+  */
+HAL_StatusTypeDef JpegEnc_GetFrame(JpegEnc_HandleTypeDef *hjenc, JpegEnc_FrameTypeDef *pFrame)
+{
+  if (hjenc->Head == hjenc->Tail)
+  {
+    return HAL_BUSY;
+  }
+
+  *pFrame = hjenc->Frame[hjenc->Tail % hjenc->NbSlots];
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Release the frame returned by JpegEnc_GetFrame(), its slot can
+  *         then be reused by the encoder
+  * @param  hjenc  Encoder handle
+  * @retval HAL status
+  */
+HAL_StatusTypeDef JpegEnc_ReleaseFrame(JpegEnc_HandleTypeDef *hjenc)
+{
+  if (hjenc->Head == hjenc->Tail)
+  {
+    return HAL_ERROR;
+  }
+
+  hjenc->Tail++;
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Reorder 8 lines of YUYV pixels into a row of 16x8 4:2:2 MCUs
+  * @note   Each 32-bit word holds two pixels: Y0, Cb, Y1, Cr from the lowest
+  *         byte. Samples are only moved, the codec expects YCbCr already.
+  * @param  pSrc   First line of the band
+  * @param  Pitch  Bytes per line of the band
+  * @param  Width  Pixels per line, multiple of JPEG_ENC_MCU_WIDTH
+  * @param  pDst   MCU row, (Width / 16) * JPEG_ENC_MCU_SIZE bytes
+  * @retval None
+  */
+void JpegEnc_TileMcuRow(const uint8_t *pSrc, uint32_t Pitch, uint32_t Width, uint8_t *pDst)
+{
+  const uint32_t *src;
+  uint32_t *y0;
+  uint32_t *y1;
+  uint32_t *cb;
+  uint32_t *cr;
+  uint32_t mcu;
+  uint32_t line;
+  uint32_t i;
+  uint32_t p[8];
+
+  for (mcu = 0; mcu < (Width / JPEG_ENC_MCU_WIDTH); mcu++)
+  {
+    for (line = 0; line < JPEG_ENC_MCU_HEIGHT; line++)
+    {
+      src = (const uint32_t *)(const void *)&pSrc[(line * Pitch) + (mcu * JPEG_ENC_MCU_WIDTH * 2U)];
+      for (i = 0; i < 8U; i++)
+      {
+        p[i] = src[i];
+      }
+
+      y0 = (uint32_t *)(void *)&pDst[JPEG_ENC_Y0_OFFSET + (line * 8U)];
+      y1 = (uint32_t *)(void *)&pDst[JPEG_ENC_Y1_OFFSET + (line * 8U)];
+      cb = (uint32_t *)(void *)&pDst[JPEG_ENC_CB_OFFSET + (line * 8U)];
+      cr = (uint32_t *)(void *)&pDst[JPEG_ENC_CR_OFFSET + (line * 8U)];
+
+      /* Luma: pixels 0 to 7 in the first block, 8 to 15 in the second one */
+      y0[0] = (p[0] & 0xFFU) | ((p[0] >> 8) & 0xFF00U) | ((p[1] & 0xFFU) << 16) | ((p[1] & 0xFF0000U) << 8);
+      y0[1] = (p[2] & 0xFFU) | ((p[2] >> 8) & 0xFF00U) | ((p[3] & 0xFFU) << 16) | ((p[3] & 0xFF0000U) << 8);
+      y1[0] = (p[4] & 0xFFU) | ((p[4] >> 8) & 0xFF00U) | ((p[5] & 0xFFU) << 16) | ((p[5] & 0xFF0000U) << 8);
+      y1[1] = (p[6] & 0xFFU) | ((p[6] >> 8) & 0xFF00U) | ((p[7] & 0xFFU) << 16) | ((p[7] & 0xFF0000U) << 8);
+
+      /* Chroma: one sample per pixel pair, 8 per MCU line */
+      cb[0] = ((p[0] >> 8) & 0xFFU) | (p[1] & 0xFF00U) | ((p[2] & 0xFF00U) << 8) | ((p[3] & 0xFF00U) << 16);
+      cb[1] = ((p[4] >> 8) & 0xFFU) | (p[5] & 0xFF00U) | ((p[6] & 0xFF00U) << 8) | ((p[7] & 0xFF00U) << 16);
+      cr[0] = (p[0] >> 24) | ((p[1] >> 16) & 0xFF00U) | ((p[2] >> 8) & 0xFF0000U) | (p[3] & 0xFF000000U);
+      cr[1] = (p[4] >> 24) | ((p[5] >> 16) & 0xFF00U) | ((p[6] >> 8) & 0xFF0000U) | (p[7] & 0xFF000000U);
+    }
+    pDst += JPEG_ENC_MCU_SIZE;
+  }
+}
+
+/**
+  * @brief  To be called from HAL_JPEG_GetDataCallback()
+  * @param  hjenc          Encoder handle
+  * @param  NbEncodedData  Bytes of the input buffer read by the codec
+  * @retval None
+  */
+void JpegEnc_GetDataHandler(JpegEnc_HandleTypeDef *hjenc, uint32_t NbEncodedData)
+{
+  if (NbEncodedData < hjenc->InLength)
+  {
+    /* Input DMA stopped early: resume on the rest of the MCU row */
+    hjenc->InAddress += NbEncodedData;
+    hjenc->InLength  -= NbEncodedData;
+    (void)HAL_JPEG_ConfigInputBuffer(hjenc->hjpeg, (uint8_t *)hjenc->InAddress, hjenc->InLength);
+    return;
+  }
+
+  hjenc->RowsConsumed++;
+  if (hjenc->RowsConsumed == hjenc->McuRows)
+  {
+    /* All the MCUs are in the codec, the end of conversion follows */
+    hjenc->InLength = 0;
+    (void)HAL_JPEG_ConfigInputBuffer(hjenc->hjpeg, (uint8_t *)hjenc->InAddress, 0);
+  }
+  else if (hjenc->RowsFed < hjenc->RowsTiled)
+  {
+    JpegEnc_FeedRow(hjenc);
+  }
+  else
+  {
+    /* The CPU is tiling the next MCU row */
+    (void)HAL_JPEG_Pause(hjenc->hjpeg, JPEG_PAUSE_RESUME_INPUT);
+    hjenc->InputPaused = 1;
+  }
+}
+
+/**
+  * @brief  To be called from HAL_JPEG_DataReadyCallback()
+  * @param  hjenc          Encoder handle
+  * @param  OutDataLength  Bytes written in the output buffer
+  * @retval None
+  */
+void JpegEnc_DataReadyHandler(JpegEnc_HandleTypeDef *hjenc, uint32_t OutDataLength)
+{
+  uint32_t slot = JpegEnc_SlotAddress(hjenc);
+
+  hjenc->OutSize += OutDataLength;
+  if ((hjenc->Overflow == 0U) && (hjenc->OutSize < hjenc->SlotSize))
+  {
+    (void)HAL_JPEG_ConfigOutputBuffer(hjenc->hjpeg, (uint8_t *)(slot + hjenc->OutSize),
+                                      hjenc->SlotSize - hjenc->OutSize);
+  }
+  else
+  {
+    /* Slot full: the rest of the stream is discarded and the frame dropped */
+    hjenc->Overflow = 1;
+    (void)HAL_JPEG_ConfigOutputBuffer(hjenc->hjpeg, (uint8_t *)slot, hjenc->SlotSize);
+  }
+}
+
+/**
+  * @brief  To be called from HAL_JPEG_EncodeCpltCallback()
+  * @param  hjenc  Encoder handle
+  * @retval None
+  */
+void JpegEnc_EncodeCpltHandler(JpegEnc_HandleTypeDef *hjenc)
+{
+  JpegEnc_FrameTypeDef *frame;
+
+  if (hjenc->Overflow == 0U)
+  {
+    frame = &hjenc->Frame[hjenc->Head % hjenc->NbSlots];
+    frame->Address = JpegEnc_SlotAddress(hjenc);
+    frame->Size    = hjenc->OutSize;
+    frame->FrameId = hjenc->FrameId;
+    hjenc->Head++;
+    hjenc->EncodedCount++;
+  }
+  else
+  {
+    hjenc->DropCount++;
+  }
+  hjenc->Active = 0;
+}
+
+/**
+  * @brief  To be called from HAL_JPEG_ErrorCallback()
+  * @param  hjenc  Encoder handle
+  * @retval None
+  */
+void JpegEnc_ErrorHandler(JpegEnc_HandleTypeDef *hjenc)
+{
+  if (hjenc->Active != 0U)
+  {
+    hjenc->DropCount++;
+    hjenc->Active = 0;
+  }
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  Tile one band into a free MCU row buffer and hand it to the codec
+  * @retval HAL_OK when the band can be released, HAL_BUSY to retry later
+  */
+static HAL_StatusTypeDef JpegEnc_ProcessBand(JpegEnc_HandleTypeDef *hjenc, const PipeSlice_BandTypeDef *pBand)
+{
+  uint32_t row;
+  uint32_t primask;
+
+  if (pBand->FirstLine == 0U)
+  {
+    if ((hjenc->Active != 0U) && (hjenc->RowsTiled == hjenc->McuRows))
+    {
+      /* The codec is completing the previous frame */
+      return HAL_BUSY;
+    }
+    if (hjenc->Active != 0U)
+    {
+      /* The previous frame lost its last bands */
+      JpegEnc_DropFrame(hjenc);
+    }
+    if ((hjenc->Record != 0U) || (hjenc->SnapshotPending != 0U))
+    {
+      if ((hjenc->Head - hjenc->Tail) < hjenc->NbSlots)
+      {
+        hjenc->SnapshotPending = 0;
+        JpegEnc_StartFrame(hjenc, pBand->FrameId);
+      }
+      else
+      {
+        hjenc->SkipCount++;
+      }
+    }
+  }
+
+  if ((hjenc->Active == 0U) || (pBand->FrameId != hjenc->FrameId))
+  {
+    return HAL_OK;
+  }
+  if ((pBand->FirstLine != (hjenc->RowsTiled * JPEG_ENC_MCU_HEIGHT)) || (pBand->NbLines != JPEG_ENC_MCU_HEIGHT))
+  {
+    /* A band was overwritten before being tiled */
+    JpegEnc_DropFrame(hjenc);
+    return HAL_OK;
+  }
+  if ((hjenc->RowsTiled - hjenc->RowsConsumed) >= 2U)
+  {
+    return HAL_BUSY;
+  }
+
+  row = JpegEnc_RowAddress(hjenc, hjenc->RowsTiled);
+  SCB_InvalidateDCache_by_Addr((uint32_t *)pBand->Address, (int32_t)(pBand->NbLines * hjenc->hslice->Pitch));
+  JpegEnc_TileMcuRow((const uint8_t *)pBand->Address, hjenc->hslice->Pitch,
+                     hjenc->Width, (uint8_t *)row);
+  SCB_CleanDCache_by_Addr((uint32_t *)row, (int32_t)hjenc->McuRowSize);
+  hjenc->RowsTiled++;
+
+  if (hjenc->Started == 0U)
+  {
+    hjenc->Started   = 1;
+    hjenc->RowsFed   = 1;
+    hjenc->InAddress = row;
+    hjenc->InLength  = hjenc->McuRowSize;
+    if (HAL_JPEG_Encode_DMA(hjenc->hjpeg, (uint8_t *)row, hjenc->McuRowSize,
+                            (uint8_t *)JpegEnc_SlotAddress(hjenc), hjenc->SlotSize) != HAL_OK)
+    {
+      hjenc->Active = 0;
+      hjenc->DropCount++;
+    }
+    return HAL_OK;
+  }
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  if (hjenc->InputPaused != 0U)
+  {
+    hjenc->InputPaused = 0;
+    JpegEnc_FeedRow(hjenc);
+    (void)HAL_JPEG_Resume(hjenc->hjpeg, JPEG_PAUSE_RESUME_INPUT);
+  }
+  __set_PRIMASK(primask);
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Reset the encoding state for a new frame
+  * @retval None
+  */
+static void JpegEnc_StartFrame(JpegEnc_HandleTypeDef *hjenc, uint32_t FrameId)
+{
+  hjenc->FrameId      = FrameId;
+  hjenc->Started      = 0;
+  hjenc->RowsTiled    = 0;
+  hjenc->RowsFed      = 0;
+  hjenc->RowsConsumed = 0;
+  hjenc->InputPaused  = 0;
+  hjenc->OutSize      = 0;
+  hjenc->Overflow     = 0;
+  hjenc->Active       = 1;
+}
+
+/**
+  * @brief  Abandon the frame being encoded
+  * @retval None
+  */
+static void JpegEnc_DropFrame(JpegEnc_HandleTypeDef *hjenc)
+{
+  if (hjenc->Started != 0U)
+  {
+    (void)HAL_JPEG_Abort(hjenc->hjpeg);
+  }
+  if (hjenc->Active != 0U)
+  {
+    hjenc->Active = 0;
+    hjenc->DropCount++;
+  }
+}
+
+/**
+  * @brief  Hand the next tiled MCU row to the codec input
+  * @retval None
+  */
+static void JpegEnc_FeedRow(JpegEnc_HandleTypeDef *hjenc)
+{
+  hjenc->InAddress = JpegEnc_RowAddress(hjenc, hjenc->RowsFed);
+  hjenc->InLength  = hjenc->McuRowSize;
+  hjenc->RowsFed++;
+  (void)HAL_JPEG_ConfigInputBuffer(hjenc->hjpeg, (uint8_t *)hjenc->InAddress, hjenc->InLength);
+}
+
+/**
+  * @brief  Address of the buffer holding an MCU row
+  * @retval Buffer address
+  */
+static uint32_t JpegEnc_RowAddress(const JpegEnc_HandleTypeDef *hjenc, uint32_t Row)
+{
+  return hjenc->McuAddress + ((Row % 2U) * hjenc->McuRowSize);
+}
+
+/**
+  * @brief  Address of the output slot of the frame being encoded
+  * @retval Slot address
+  */
+static uint32_t JpegEnc_SlotAddress(const JpegEnc_HandleTypeDef *hjenc)
+{
+  return hjenc->OutAddress + ((hjenc->Head % hjenc->NbSlots) * hjenc->SlotSize);
+}
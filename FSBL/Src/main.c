@@ -25,6 +25,31 @@
 #include "imx335_E27_isp_param_conf.h"
 
 #include "ov5647.h"
+#include "capture_graph.h"
+#include "jpeg_encoder.h"
+#include "frame_pool.h"
+#include "overlay.h"
+#include "frame_trace.h"
+#include "sensor_queue.h"
+#include "frame_governor.h"
+#include "iq_profile.h"
+#if (USE_PSRAM_FRAME_POOL || USE_IQ_PROFILE)
+#include "stm32n6570_discovery_xspi.h"
+#endif
+#if USE_SD_RECORDER
+#include "sd_recorder.h"
+#include "stm32n6570_discovery_sd.h"
+#endif
+#if USE_DCMIPP_IRQ_DISPATCH
+#include "dcmipp_irq.h"
+#endif
+#if USE_FRAME_META
+#include "frame_meta.h"
+#endif
+#if USE_TOUCH_METER
+#include "touch_meter.h"
+#include "stm32n6570_discovery_ts.h"
+#endif
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -34,7 +59,8 @@
 
 /* Private define ------------------------------------------------------------*/
 /* USER CODE BEGIN PD */
-
+/* Overlay items, in drawing order */
+#define OVERLAY_ID_SPOT   0U
 /* USER CODE END PD */
 
 /* Private macro -------------------------------------------------------------*/
@@ -47,18 +73,70 @@
 DCMIPP_HandleTypeDef hdcmipp;
 LTDC_HandleTypeDef hltdc;
 ISP_HandleTypeDef  hcamera_isp;
+JPEG_HandleTypeDef hjpeg;
+DMA2D_HandleTypeDef hdma2d;
 /* USER CODE BEGIN PV */
+#if USE_FRAME_TRACE
+FrameTrace_HandleTypeDef htrace;
+static uint32_t TraceReportTick;
+#endif
+#if USE_DCMIPP_IRQ_DISPATCH
+DcmippIrq_HandleTypeDef hdcmipp_irq;
+#endif
 static __IO uint32_t NbMainFrames = 0;
 static IMX335_Object_t   IMX335Obj;
-static int32_t isp_gain;
-static int32_t isp_exposure;
 
 static OV5647_Object_t   OV5647Obj;
+#if USE_SENSOR_QUEUE
+static SensorQueue_HandleTypeDef SensorQueue;
+#endif
+#if USE_FRAME_GOVERNOR
+static FrameGovernor_HandleTypeDef FrameGovernor;
+static uint32_t FramePeriod;
+#endif
+#if USE_IQ_PROFILE
+static IQProfile_HandleTypeDef IQProfile;
+#endif
+#if USE_SD_RECORDER
+static SDRec_HandleTypeDef Recorder;
+static uint32_t RecorderFrame = 0;
+static uint32_t RecorderReportTick;
+#endif
+#if USE_FRAME_META
+static FrameMeta_HandleTypeDef FrameMeta;
+#endif
+#if USE_TOUCH_METER
+static TouchMeter_HandleTypeDef TouchMeter;
+static uint8_t TouchPanel = 0;
+#endif
+
+static CaptureGraph_HandleTypeDef CaptureGraph;
+static FrameRing_HandleTypeDef *FrameRing;
+#if USE_JPEG_RECORDING
+static PipeSlice_HandleTypeDef JpegSlice;
+static JpegEnc_HandleTypeDef JpegEncoder;
+#else
+static __IO uint32_t NbAnalyticsFrames = 0;
+static FrameRing_HandleTypeDef *AnalyticsRing;
+static PipeSlice_HandleTypeDef AnalyticsSlice;
+#endif
+#if USE_DISPLAY_OVERLAY
+static Overlay_HandleTypeDef Overlay;
+#endif
+static FramePool_HandleTypeDef DisplayPool;
+static uint32_t FrameRingAddress[FRAME_RING_NB_BUFFERS];
+#if (USE_JPEG_RECORDING == 0U)
+static FramePool_HandleTypeDef AnalyticsPool;
+static uint32_t AnalyticsRingAddress[ANALYTICS_NB_BUFFERS];
+static uint32_t AnalyticsFrame = 0;
+#endif
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
 void SystemClock_Config(void);
 static void MX_DCMIPP_Init(void);
+static void MX_JPEG_Init(void);
+static void MX_DMA2D_Init(void);
 static void LCD_Init(uint32_t Width, uint32_t Height);
 /* USER CODE BEGIN PFP */
 static void IMX335_Probe(uint32_t Resolution, uint32_t PixelFormat);
@@ -69,6 +147,37 @@ static ISP_StatusTypeDef SetSensorExposureHelper(uint32_t Instance, int32_t Expo
 static ISP_StatusTypeDef GetSensorExposureHelper(uint32_t Instance, int32_t *Exposure);
 
 static void OV5647_Probe(uint32_t Resolution, uint32_t PixelFormat);
+static void FramePools_Init(void);
+#if USE_SENSOR_QUEUE
+static void SensorQueue_Start(void);
+#endif
+#if USE_FRAME_GOVERNOR
+static void FrameGovernor_Start(void);
+#endif
+#if USE_DISPLAY_OVERLAY
+static void Overlay_Start(void);
+#endif
+#if USE_PSRAM_FRAME_POOL
+static void PSRAM_Init(void);
+#endif
+#if USE_IQ_PROFILE
+static const ISP_IQParamTypeDef *IQProfile_Start(const char *Sensor, uint32_t Mode);
+#endif
+#if USE_SD_RECORDER
+static void SDRecorder_Start(void);
+#endif
+#if USE_FRAME_META
+static void FrameMeta_Start(void);
+#endif
+#if USE_TOUCH_METER
+static void TouchMeter_Start(void);
+#endif
+#if (USE_JPEG_RECORDING == 0U)
+static void AnalyticsFrameReady(CaptureGraph_HandleTypeDef *hgraph, uint32_t Pipe);
+#endif
+#if USE_FRAME_TRACE
+static void TraceEventHelper(uint32_t Instance, ISP_TraceEventTypeDef Event, uint32_t FrameId);
+#endif
 uint8_t data_tmp = 0;
 /* USER CODE END PFP */
 
@@ -118,6 +227,17 @@ int main(void)
 
   /* USER CODE BEGIN 1 */
   ISP_AppliHelpersTypeDef appliHelpers = {0};
+  const ISP_IQParamTypeDef *iqParam = ISP_IQParamCacheInit[0];
+  uint32_t frame_address;
+#if USE_JPEG_RECORDING
+  JpegEnc_ConfTypeDef jpegConf = {0};
+  JpegEnc_FrameTypeDef jpeg_frame;
+#else
+  PipeSlice_BandTypeDef band;
+#endif
+#if USE_DCMIPP_IRQ_DISPATCH
+  DcmippIrq_ConfTypeDef irqConf = {0};
+#endif
   /* USER CODE END 1 */
 
   /* Enable the CPU Cache */
@@ -132,7 +252,10 @@ int main(void)
   HAL_Init();
 
   /* USER CODE BEGIN Init */
-
+  /* Start the DWT cycle counter used to profile the interrupt handlers */
+  DCB->DEMCR |= DCB_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
   /* USER CODE END Init */
 
   /* Configure the system clock */
@@ -161,6 +284,7 @@ int main(void)
 
   printf("\r\n Start OV5647 Bring Up \r\n");
 #endif
+  FramePools_Init();
   /* USER CODE END SysInit */
 
   /* Initialize all configured peripherals */
@@ -170,10 +294,30 @@ int main(void)
 
   //IMX335_Probe(IMX335_R2592_1944, IMX335_RAW_RGGB10);
   OV5647_Probe(OV5647_R1920_1080, OV5647_RAW_RGGB10);
+#if USE_SENSOR_QUEUE
+  SensorQueue_Start();
+#endif
+#if USE_FRAME_GOVERNOR
+  FrameGovernor_Start();
+#endif
   MX_DCMIPP_Init();
 
   /* USER CODE BEGIN 2 */
+#if USE_DCMIPP_IRQ_DISPATCH
+  /* Frame, vsync and line events of the pipes, start and end of frame of the
+     virtual channel: the events enabled by the capture start */
+  irqConf.PipeEvents = DCMIPP_IRQ_PIPE_EVENTS;
+  irqConf.CsiEvents  = DCMIPP_CSI_FLAG_SOF0 | DCMIPP_CSI_FLAG_EOF0;
+  if (DcmippIrq_Init(&hdcmipp_irq, &hdcmipp, &irqConf) != HAL_OK)
+  {
+    Error_Handler();
+  }
+#endif
   LCD_Init(FRAME_WIDTH, FRAME_HEIGHT);
+#if USE_DISPLAY_OVERLAY
+  MX_DMA2D_Init();
+  Overlay_Start();
+#endif
 
   /* Fill init struct with Camera driver helpers */
   appliHelpers.GetSensorInfo = GetSensorInfoHelper;
@@ -181,14 +325,51 @@ int main(void)
   appliHelpers.GetSensorGain = GetSensorGainHelper;
   appliHelpers.SetSensorExposure = SetSensorExposureHelper;
   appliHelpers.GetSensorExposure = GetSensorExposureHelper;
+#if USE_FRAME_TRACE
+  appliHelpers.TraceEvent = TraceEventHelper;
+#endif
 
+#if USE_IQ_PROFILE
+  iqParam = IQProfile_Start(OV5647_NAME, OV5647_R1920_1080);
+#endif
+
+#if USE_FRAME_META
+  FrameMeta_Start();
+#endif
   /* Initialize the Image Signal Processing middleware */
-  if(ISP_Init(&hcamera_isp, &hdcmipp, 0, &appliHelpers, ISP_IQParamCacheInit[0]) != ISP_OK)
+  if(ISP_Init(&hcamera_isp, &hdcmipp, 0, &appliHelpers, iqParam) != ISP_OK)
   {
     //Error_Handler();
   }
   HAL_Delay(10);
-  if (HAL_DCMIPP_CSI_PIPE_Start(&hdcmipp, DCMIPP_PIPE1, DCMIPP_VIRTUAL_CHANNEL0 , BUFFER_ADDRESS, DCMIPP_MODE_CONTINUOUS) != HAL_OK)
+#if USE_JPEG_RECORDING
+  /* Motion-JPEG of the PIPE1 frames, encoded while they are captured */
+  MX_JPEG_Init();
+  jpegConf.Width      = FRAME_WIDTH;
+  jpegConf.Height     = FRAME_HEIGHT;
+  jpegConf.Quality    = JPEG_QUALITY;
+  jpegConf.McuAddress = JPEG_MCU_ADDRESS;
+  jpegConf.OutAddress = JPEG_OUT_ADDRESS;
+  jpegConf.SlotSize   = JPEG_OUT_SLOT_SIZE;
+  jpegConf.NbSlots    = JPEG_OUT_NB_SLOTS;
+  if (JpegEnc_Init(&JpegEncoder, &hjpeg, &JpegSlice, &jpegConf) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  JpegEnc_Record(&JpegEncoder, 1);
+#endif
+#if USE_FRAME_TRACE
+  /* Follow the displayed pipe from the sensor start of frame to the LTDC reload */
+  if (FrameTrace_Init(&htrace, &hdcmipp, FrameRing->Pipe) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  TraceReportTick = HAL_GetTick();
+#endif
+#if USE_SD_RECORDER
+  SDRecorder_Start();
+#endif
+  if (CaptureGraph_Start(&CaptureGraph, DCMIPP_VIRTUAL_CHANNEL0) != HAL_OK)
   {
     Error_Handler();
   }
@@ -209,6 +390,9 @@ int main(void)
   {
     Error_Handler();
   }
+#if USE_TOUCH_METER
+  TouchMeter_Start();
+#endif
   /* USER CODE END 2 */
 
   /* Infinite loop */
@@ -216,12 +400,175 @@ int main(void)
   while (1)
   {
     /* USER CODE END WHILE */
-    BSP_LED_Toggle(LED_GREEN);
+#if USE_SENSOR_QUEUE
+    /* Sensor updates of one ISP pass are applied together at a start of frame */
+    SensorQueue_BeginGroup(&SensorQueue);
+#endif
+#if USE_FRAME_GOVERNOR
+    /* The AEC may ask for the exposure of the next longer frame */
+    (void)ISP_SetExposureMax(&hcamera_isp, FrameGovernor_GetExposureMax(&FrameGovernor));
+#endif
     if (ISP_BackgroundProcess(&hcamera_isp) != ISP_OK)
     {
       BSP_LED_Toggle(LED_RED);
     }
+#if USE_SENSOR_QUEUE
+    SensorQueue_EndGroup(&SensorQueue);
+#endif
+#if USE_FRAME_GOVERNOR
+    /* Frame period published to the frame consumers */
+    if (FrameGovernor_GetFramePeriod(&FrameGovernor) != FramePeriod)
+    {
+      FramePeriod = FrameGovernor_GetFramePeriod(&FrameGovernor);
+      printf("[governor] frame period %lu us\r\n", FramePeriod);
+    }
+#endif
     /* USER CODE BEGIN 3 */
+    /* Hand the latest complete frame to the display */
+    if (FrameRing_GetReadyBuffer(FrameRing, &frame_address) == HAL_OK)
+    {
+      if (FrameRing_PresentBuffer(FrameRing, frame_address) != HAL_OK)
+      {
+        (void)FrameRing_ReleaseBuffer(FrameRing, frame_address);
+      }
+      BSP_LED_Toggle(LED_GREEN);
+    }
+
+#if USE_TOUCH_METER
+    /* A tap moves the AEC/AWB statistic area, applied at the next frame start */
+    if ((TouchPanel != 0U) && (TouchMeter_Process(&TouchMeter) != 0U))
+    {
+#if USE_DISPLAY_OVERLAY
+      Overlay_RectTypeDef spot;
+      uint32_t y0 = (TouchMeter.Spot.Y > OVERLAY_Y) ? (TouchMeter.Spot.Y - OVERLAY_Y) : 0U;
+      uint32_t y1 = TouchMeter.Spot.Y + TouchMeter.Spot.Height - OVERLAY_Y;
+
+      /* Marker on the metered area, the part of it inside the overlay */
+      y1 = (y1 < OVERLAY_HEIGHT) ? y1 : OVERLAY_HEIGHT;
+      if ((y1 > (y0 + 4U)) && (TouchMeter.Spot.Width > 4U))
+      {
+        spot.X      = TouchMeter.Spot.X - OVERLAY_X;
+        spot.Y      = y0;
+        spot.Width  = TouchMeter.Spot.Width;
+        spot.Height = y1 - y0;
+        (void)Overlay_SetFrame(&Overlay, OVERLAY_ID_SPOT, &spot, 2, 0xC0FFFFFFU);
+      }
+#endif
+      printf("[touch] metering %lu,%lu %lux%lu\r\n", TouchMeter.Spot.X, TouchMeter.Spot.Y,
+             TouchMeter.Spot.Width, TouchMeter.Spot.Height);
+    }
+#endif
+
+#if USE_DISPLAY_OVERLAY
+    /* Redraw the overlay areas changed since the last pass, no-op otherwise */
+    (void)Overlay_Update(&Overlay);
+#endif
+
+#if USE_JPEG_RECORDING
+    /* MCU rows are tiled and encoded as soon as PIPE1 has written the lines */
+    JpegEnc_Process(&JpegEncoder);
+
+    /* Encoded frame: to be stored or streamed, then released to free its slot */
+#if USE_SD_RECORDER
+    if ((RecorderFrame != 0U) && (SDRec_IsReady(&Recorder) != 0U))
+    {
+      (void)JpegEnc_ReleaseFrame(&JpegEncoder);
+      RecorderFrame = 0;
+    }
+    if ((RecorderFrame == 0U) && (JpegEnc_GetFrame(&JpegEncoder, &jpeg_frame) == HAL_OK))
+    {
+      SCB_InvalidateDCache_by_Addr((uint32_t *)jpeg_frame.Address, (int32_t)jpeg_frame.Size);
+      /* The slot is kept until the recorder has copied the stream */
+      if (SDRec_WriteFrame(&Recorder, jpeg_frame.Address, jpeg_frame.Size, jpeg_frame.FrameId) == HAL_OK)
+      {
+        RecorderFrame = jpeg_frame.Address;
+      }
+      else
+      {
+        (void)JpegEnc_ReleaseFrame(&JpegEncoder);
+      }
+    }
+#else
+    if (JpegEnc_GetFrame(&JpegEncoder, &jpeg_frame) == HAL_OK)
+    {
+      SCB_InvalidateDCache_by_Addr((uint32_t *)jpeg_frame.Address, (int32_t)jpeg_frame.Size);
+      (void)JpegEnc_ReleaseFrame(&JpegEncoder);
+    }
+#endif
+#else
+    /* Analytics bands: pre-processing can start as soon as the lines are written */
+    while (PipeSlice_GetBand(&AnalyticsSlice, &band) == HAL_OK)
+    {
+      SCB_InvalidateDCache_by_Addr((uint32_t *)band.Address, (int32_t)(band.NbLines * ANALYTICS_WIDTH * 3));
+      (void)PipeSlice_ReleaseBand(&AnalyticsSlice, &band);
+    }
+
+    /* Analytics frame: handed by reference to the inference engine, each stage
+     * holding it takes a pool reference. The ring keeps its own reference and
+     * gets the buffer back when all the stages have dropped theirs. */
+    if ((AnalyticsFrame == 0U) && (FrameRing_GetReadyBuffer(AnalyticsRing, &frame_address) == HAL_OK))
+    {
+      (void)FramePool_EndDeviceAccess(&AnalyticsPool, frame_address);
+      (void)FramePool_Retain(&AnalyticsPool, frame_address);
+      AnalyticsFrame = frame_address;
+
+#if USE_SD_RECORDER
+      /* The recorder keeps the main loop reference until it has copied the frame */
+      if (SDRec_WriteFrame(&Recorder, frame_address, ANALYTICS_BUFFER_SIZE, NbAnalyticsFrames) == HAL_OK)
+      {
+        RecorderFrame = frame_address;
+      }
+      else
+      {
+        (void)FramePool_Release(&AnalyticsPool, frame_address);
+      }
+#else
+      /* No consumer yet: the main loop reference is dropped right away */
+      (void)FramePool_Release(&AnalyticsPool, frame_address);
+#endif
+    }
+#if USE_SD_RECORDER
+    if ((RecorderFrame != 0U) && (SDRec_IsReady(&Recorder) != 0U))
+    {
+      (void)FramePool_Release(&AnalyticsPool, RecorderFrame);
+      RecorderFrame = 0;
+    }
+#endif
+    if ((AnalyticsFrame != 0U) && (FramePool_GetRefCount(&AnalyticsPool, AnalyticsFrame) == 1U))
+    {
+      (void)FramePool_BeginDeviceAccess(&AnalyticsPool, AnalyticsFrame, FRAME_POOL_OWNER_DEVICE_WRITE);
+      (void)FrameRing_ReleaseBuffer(AnalyticsRing, AnalyticsFrame);
+      AnalyticsFrame = 0;
+    }
+#endif
+
+#if USE_SD_RECORDER
+    /* Staging copy and SD card writes, throughput printed periodically */
+    SDRec_Process(&Recorder);
+    if ((HAL_GetTick() - RecorderReportTick) >= SD_RECORDER_REPORT_MS)
+    {
+      SDRec_StatsTypeDef recStats;
+
+      RecorderReportTick = HAL_GetTick();
+      SDRec_GetStats(&Recorder, &recStats);
+      printf("[recorder] %lu frames, %lu dropped, %lu KB/s, worst write %lu us, worst stall %lu us\r\n",
+             recStats.FrameCount, recStats.DropCount, recStats.KBytesPerSec, recStats.WorstWriteUs,
+             recStats.WorstStallUs);
+    }
+#endif
+
+#if USE_FRAME_TRACE
+    /* Timing statistics built out of the interrupt handlers, printed periodically */
+    FrameTrace_Process(&htrace);
+    if ((HAL_GetTick() - TraceReportTick) >= FRAME_TRACE_REPORT_MS)
+    {
+      TraceReportTick = HAL_GetTick();
+      FrameTrace_Report(&htrace);
+    }
+#endif
+
+    /* All the work is triggered by the DCMIPP, LTDC, JPEG and SysTick interrupts */
+    __WFI();
   }
   /* USER CODE END 3 */
 }
@@ -328,10 +675,9 @@ static void MX_DCMIPP_Init(void)
 {
   /* USER CODE BEGIN DCMIPP_Init 0 */
   /* USER CODE END DCMIPP_Init 0 */
-  DCMIPP_PipeConfTypeDef pPipeConf = {0};
   DCMIPP_CSI_PIPE_ConfTypeDef pCSIPipeConf = {0};
   DCMIPP_CSI_ConfTypeDef csiconf = {0};
-  DCMIPP_DownsizeTypeDef DonwsizeConf ={0};
+  CaptureGraph_PipeConfTypeDef graphConf = {0};
 
   /* Set DCMIPP instance */
   hdcmipp.Instance = DCMIPP;
@@ -370,47 +716,126 @@ static void MX_DCMIPP_Init(void)
     Error_Handler();
   }
 
-  pPipeConf.FrameRate  = DCMIPP_FRAME_RATE_ALL;
-  pPipeConf.PixelPackerFormat = DCMIPP_PIXEL_PACKER_FORMAT_RGB565_1;
+  /* Configure the pixel pipes: whole sensor frame scaled by each pipe */
+  if (CaptureGraph_Init(&CaptureGraph, &hdcmipp, CAMERA_WIDTH, CAMERA_HEIGHT) != HAL_OK)
+  {
+    Error_Handler();
+  }
 
-  /* Set Pitch for Main and Ancillary Pipes */
-  pPipeConf.PixelPipePitch  = 1600 ; /* Number of bytes */
+#if USE_JPEG_RECORDING
+  /* Main pipe: YUV422 lines for the JPEG codec, no frame buffer */
+  graphConf.Pipe               = DCMIPP_PIPE1;
+  graphConf.Width              = FRAME_WIDTH;
+  graphConf.Height             = FRAME_HEIGHT;
+  graphConf.PixelPackerFormat  = DCMIPP_PIXEL_PACKER_FORMAT_YUV422_1;
+  graphConf.BytesPerPixel      = 2;
+  graphConf.hltdc              = NULL;
+  graphConf.LayerIdx           = 0;
+  graphConf.pAddress           = NULL;
+  graphConf.NbBuffers          = 0;
+  graphConf.FrameReadyCallback = NULL;
+  if (CaptureGraph_ConfigPipe(&CaptureGraph, &graphConf) != HAL_OK)
+  {
+    Error_Handler();
+  }
 
-  /* Configure Pipe */
-  if (HAL_DCMIPP_PIPE_SetConfig(&hdcmipp, DCMIPP_PIPE1, &pPipeConf) != HAL_OK)
+  if (CaptureGraph_AttachWrapSlice(&CaptureGraph, DCMIPP_PIPE1, &JpegSlice, JPEG_ENC_MCU_HEIGHT,
+                                   JPEG_WRAP_ADDRESS, JPEG_WRAP_LINES) != HAL_OK)
   {
     Error_Handler();
   }
 
-#if 0
-  /* Configure the downsize */
-  DonwsizeConf.HRatio      = 25656;
-  DonwsizeConf.VRatio      = 33161;
-  DonwsizeConf.HSize       = 800;
-  DonwsizeConf.VSize       = 480;
-  DonwsizeConf.HDivFactor  = 316;
-  DonwsizeConf.VDivFactor  = 253;
+  /* Ancillary pipe: RGB565 frames shown on the LTDC layer 1 */
+  graphConf.Pipe               = DCMIPP_PIPE2;
+  graphConf.Width              = FRAME_WIDTH;
+  graphConf.Height             = FRAME_HEIGHT;
+  graphConf.PixelPackerFormat  = DCMIPP_PIXEL_PACKER_FORMAT_RGB565_1;
+  graphConf.BytesPerPixel      = 2;
+  graphConf.hltdc              = &hltdc;
+  graphConf.LayerIdx           = LTDC_LAYER_1;
+  graphConf.pAddress           = FrameRingAddress;
+  graphConf.NbBuffers          = FRAME_RING_NB_BUFFERS;
+  graphConf.FrameReadyCallback = NULL;
+  if (CaptureGraph_ConfigPipe(&CaptureGraph, &graphConf) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  FrameRing = CaptureGraph_GetRing(&CaptureGraph, DCMIPP_PIPE2);
 #else
-  DonwsizeConf.HRatio      = (uint32_t)((((float)(1920)) / ((float)(FRAME_WIDTH))) * 8192.F);
-  DonwsizeConf.VRatio      = (uint32_t)((((float)(1080 )) / ((float)(FRAME_HEIGHT ))) * 8192.F);
-  DonwsizeConf.HSize       = FRAME_WIDTH;
-  DonwsizeConf.VSize       = FRAME_HEIGHT;
+  /* Main pipe: RGB565 frames shown on the LTDC layer 1 */
+  graphConf.Pipe               = DCMIPP_PIPE1;
+  graphConf.Width              = FRAME_WIDTH;
+  graphConf.Height             = FRAME_HEIGHT;
+  graphConf.PixelPackerFormat  = DCMIPP_PIXEL_PACKER_FORMAT_RGB565_1;
+  graphConf.BytesPerPixel      = 2;
+  graphConf.hltdc              = &hltdc;
+  graphConf.LayerIdx           = LTDC_LAYER_1;
+  graphConf.pAddress           = FrameRingAddress;
+  graphConf.NbBuffers          = FRAME_RING_NB_BUFFERS;
+  graphConf.FrameReadyCallback = NULL;
+  if (CaptureGraph_ConfigPipe(&CaptureGraph, &graphConf) != HAL_OK)
+  {
+    Error_Handler();
+  }
 
-  DonwsizeConf.HDivFactor  = (uint32_t)floor((1024 * 8192 -1) / DonwsizeConf.HRatio);
-  DonwsizeConf.VDivFactor  = (uint32_t)floor((1024 * 8192 -1) / DonwsizeConf.VRatio);
+  /* Ancillary pipe: small RGB888 frames for the analytics, no display */
+  graphConf.Pipe               = DCMIPP_PIPE2;
+  graphConf.Width              = ANALYTICS_WIDTH;
+  graphConf.Height             = ANALYTICS_HEIGHT;
+  graphConf.PixelPackerFormat  = DCMIPP_PIXEL_PACKER_FORMAT_RGB888_YUV444_1;
+  graphConf.BytesPerPixel      = 3;
+  graphConf.hltdc              = NULL;
+  graphConf.LayerIdx           = 0;
+  graphConf.pAddress           = AnalyticsRingAddress;
+  graphConf.NbBuffers          = ANALYTICS_NB_BUFFERS;
+  graphConf.FrameReadyCallback = AnalyticsFrameReady;
+  if (CaptureGraph_ConfigPipe(&CaptureGraph, &graphConf) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  if (CaptureGraph_AttachSlice(&CaptureGraph, DCMIPP_PIPE2, &AnalyticsSlice, ANALYTICS_SLICE_LINES) != HAL_OK)
+  {
+    Error_Handler();
+  }
 
+  FrameRing     = CaptureGraph_GetRing(&CaptureGraph, DCMIPP_PIPE1);
+  AnalyticsRing = CaptureGraph_GetRing(&CaptureGraph, DCMIPP_PIPE2);
 #endif
+  /* USER CODE BEGIN DCMIPP_Init 2 */
+  /* USER CODE END DCMIPP_Init 2 */
+}
 
-  if(HAL_DCMIPP_PIPE_SetDownsizeConfig(&hdcmipp, DCMIPP_PIPE1, &DonwsizeConf) != HAL_OK)
+/**
+  * @brief DMA2D Initialization Function
+  * @param None
+  * @retval None
+  */
+static void MX_DMA2D_Init(void)
+{
+  hdma2d.Instance          = DMA2D;
+  hdma2d.Init.Mode         = DMA2D_R2M;
+  hdma2d.Init.ColorMode    = DMA2D_OUTPUT_ARGB4444;
+  hdma2d.Init.OutputOffset = 0;
+  if (HAL_DMA2D_Init(&hdma2d) != HAL_OK)
   {
     Error_Handler();
   }
-  if(HAL_DCMIPP_PIPE_EnableDownsize(&hdcmipp, DCMIPP_PIPE1) != HAL_OK)
+}
+
+/**
+  * @brief JPEG Initialization Function
+  * @param None
+  * @retval None
+  */
+static void MX_JPEG_Init(void)
+{
+  hjpeg.Instance = JPEG;
+  if (HAL_JPEG_Init(&hjpeg) != HAL_OK)
   {
     Error_Handler();
   }
-  /* USER CODE BEGIN DCMIPP_Init 2 */
-  /* USER CODE END DCMIPP_Init 2 */
 }
 
 static void LCD_Init(uint32_t Width, uint32_t Height)
@@ -448,7 +873,7 @@ static void LCD_Init(uint32_t Width, uint32_t Height)
   pLayerCfg.WindowY0       = 0;
   pLayerCfg.WindowY1       = Height;
   pLayerCfg.PixelFormat    = LTDC_PIXEL_FORMAT_RGB565;
-  pLayerCfg.FBStartAdress  = BUFFER_ADDRESS;
+  pLayerCfg.FBStartAdress  = FrameRingAddress[0];
   pLayerCfg.Alpha = LTDC_LxCACR_CONSTA;
   pLayerCfg.Alpha0 = 0;
   pLayerCfg.BlendingFactor1 = LTDC_BLENDING_FACTOR1_PAxCA;
@@ -465,6 +890,351 @@ static void LCD_Init(uint32_t Width, uint32_t Height)
 }
 
 /* USER CODE BEGIN 4 */
+/**
+ * @brief  Allocate the frame ring buffers from the frame pools
+ * @param  None
+ * @retval None
+ */
+static void FramePools_Init(void)
+{
+  uint32_t i;
+
+  /* Display ring: DCMIPP writes, LTDC reads, the CPU never touches the pixels */
+  if (FramePool_Init(&DisplayPool, FRAME_BUFFER_SIZE) != HAL_OK)
+  {
+    Error_Handler();
+  }
+#if USE_PSRAM_FRAME_POOL
+  PSRAM_Init();
+  if (FramePool_AddRegion(&DisplayPool, PSRAM_POOL_ADDRESS, PSRAM_POOL_SIZE) != HAL_OK)
+  {
+    Error_Handler();
+  }
+#else
+  if ((FramePool_AddRegion(&DisplayPool, BUFFER_ADDRESS, 2U * FRAME_BUFFER_SIZE) != HAL_OK) ||
+      (FramePool_AddRegion(&DisplayPool, BUFFER_ADDRESS_2, FRAME_BUFFER_SIZE) != HAL_OK))
+  {
+    Error_Handler();
+  }
+#endif
+  for (i = 0; i < FRAME_RING_NB_BUFFERS; i++)
+  {
+    if ((FramePool_Alloc(&DisplayPool, &FrameRingAddress[i]) != HAL_OK) ||
+        (FramePool_BeginDeviceAccess(&DisplayPool, FrameRingAddress[i], FRAME_POOL_OWNER_DEVICE_WRITE) != HAL_OK))
+    {
+      Error_Handler();
+    }
+  }
+
+#if (USE_JPEG_RECORDING == 0U)
+  /* Analytics ring: DCMIPP writes, the CPU reads each frame it claims */
+  if ((FramePool_Init(&AnalyticsPool, ANALYTICS_BUFFER_SIZE) != HAL_OK) ||
+      (FramePool_AddRegion(&AnalyticsPool, ANALYTICS_BUFFER_ADDRESS, ANALYTICS_BUFFER_SIZE) != HAL_OK) ||
+      (FramePool_AddRegion(&AnalyticsPool, ANALYTICS_BUFFER_ADDRESS_1, ANALYTICS_BUFFER_SIZE) != HAL_OK))
+  {
+    Error_Handler();
+  }
+  for (i = 0; i < ANALYTICS_NB_BUFFERS; i++)
+  {
+    if ((FramePool_Alloc(&AnalyticsPool, &AnalyticsRingAddress[i]) != HAL_OK) ||
+        (FramePool_BeginDeviceAccess(&AnalyticsPool, AnalyticsRingAddress[i], FRAME_POOL_OWNER_DEVICE_WRITE) != HAL_OK))
+    {
+      Error_Handler();
+    }
+  }
+#endif
+}
+
+#if USE_DISPLAY_OVERLAY
+/**
+ * @brief  Show the UI overlay above the video on the LTDC layer 2
+ * @param  None
+ * @retval None
+ */
+static void Overlay_Start(void)
+{
+  Overlay_ConfTypeDef overlayConf = {0};
+  Overlay_RectTypeDef spot;
+
+  overlayConf.Address     = OVERLAY_BUFFER_ADDRESS;
+  overlayConf.X           = OVERLAY_X;
+  overlayConf.Y           = OVERLAY_Y;
+  overlayConf.Width       = OVERLAY_WIDTH;
+  overlayConf.Height      = OVERLAY_HEIGHT;
+  overlayConf.PixelFormat = LTDC_PIXEL_FORMAT_ARGB4444;
+  if (Overlay_Init(&Overlay, &hdma2d, &hltdc, LTDC_LAYER_2, &overlayConf) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  /* Metering spot marker at the center of the picture */
+  spot.Width  = 96;
+  spot.Height = 96;
+  spot.X      = (OVERLAY_WIDTH - spot.Width) / 2U;
+  spot.Y      = (OVERLAY_HEIGHT - spot.Height) / 2U;
+  if (Overlay_SetFrame(&Overlay, OVERLAY_ID_SPOT, &spot, 2, 0xC0FFFFFFU) != HAL_OK)
+  {
+    Error_Handler();
+  }
+}
+#endif
+
+#if USE_SENSOR_QUEUE
+/**
+ * @brief  Route the sensor updates of the ISP through the asynchronous queue
+ * @param  None
+ * @retval None
+ */
+static void SensorQueue_Start(void)
+{
+  SensorQueue_ConfTypeDef queueConf = {0};
+
+  queueConf.hi2c      = &hbus_i2c1;
+  queueConf.DevAddr   = CAMERA_OV5647_ADDRESS;
+  queueConf.HoldReg   = OV5647_REG_GROUP_ACCESS;
+  queueConf.HoldStart = OV5647_GROUP_HOLD_START;
+  queueConf.HoldEnd   = OV5647_GROUP_HOLD_END;
+  queueConf.Launch    = OV5647_GROUP_LAUNCH;
+  if (SensorQueue_Init(&SensorQueue, &queueConf) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  /* Same level as the CSI interrupt starting the transfers */
+  HAL_NVIC_SetPriority(I2C1_EV_IRQn, 0x07, 0);
+  HAL_NVIC_EnableIRQ(I2C1_EV_IRQn);
+  HAL_NVIC_SetPriority(I2C1_ER_IRQn, 0x07, 0);
+  HAL_NVIC_EnableIRQ(I2C1_ER_IRQn);
+}
+#endif
+
+#if USE_FRAME_GOVERNOR
+/**
+ * @brief  Let the sensor frame grow in low light, from the timing of its mode
+ * @param  None
+ * @retval None
+ */
+static void FrameGovernor_Start(void)
+{
+  FrameGovernor_ConfTypeDef govConf = {0};
+  OV5647_FrameTiming_t timing;
+
+  if (OV5647_GetFrameTiming(&OV5647Obj, &timing) != OV5647_OK)
+  {
+    Error_Handler();
+  }
+
+  govConf.Hts             = timing.Hts;
+  govConf.Pclk            = timing.Pclk;
+  govConf.VtsMin          = timing.VtsMin;
+  govConf.MarginLines     = OV5647_EXPOSURE_MARGIN_LINES;
+  govConf.MinFps          = FRAME_GOVERNOR_MIN_FPS;
+  govConf.StepLines       = timing.VtsMin / FRAME_GOVERNOR_STEP_DIV;
+  govConf.HysteresisLines = govConf.StepLines / 2U;
+  if (FrameGovernor_Init(&FrameGovernor, &govConf) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  FramePeriod = FrameGovernor_GetFramePeriod(&FrameGovernor);
+}
+#endif
+
+#if USE_IQ_PROFILE
+/**
+ * @brief  Map the NOR on XSPI2 and select the IQ profile of the sensor mode
+ * @note   IQProfile_Apply() switches to another profile of the image later on.
+ * @param  Sensor  Sensor name
+ * @param  Mode    Sensor resolution
+ * @retval IQ parameters for ISP_Init(), the compiled-in ones without profile
+ */
+static const ISP_IQParamTypeDef *IQProfile_Start(const char *Sensor, uint32_t Mode)
+{
+  RCC_PeriphCLKInitTypeDef PeriphClkInitStruct = {0};
+  BSP_XSPI_NOR_Init_t norInit;
+  const ISP_IQParamTypeDef *param;
+
+  /* XSPI2 kernel clock: PLL1 1200 MHz / 6 = 200 MHz */
+  PeriphClkInitStruct.PeriphClockSelection = RCC_PERIPHCLK_XSPI2;
+  PeriphClkInitStruct.Xspi2ClockSelection = RCC_XSPI2CLKSOURCE_IC3;
+  PeriphClkInitStruct.ICSelection[RCC_IC3].ClockSelection = RCC_ICCLKSOURCE_PLL1;
+  PeriphClkInitStruct.ICSelection[RCC_IC3].ClockDivider = 6;
+  if (HAL_RCCEx_PeriphCLKConfig(&PeriphClkInitStruct) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  norInit.InterfaceMode = BSP_XSPI_NOR_OPI_MODE;
+  norInit.TransferRate  = BSP_XSPI_NOR_DTR_TRANSFER;
+  if ((BSP_XSPI_NOR_Init(0, &norInit) != BSP_ERROR_NONE) ||
+      (BSP_XSPI_NOR_EnableMemoryMappedMode(0) != BSP_ERROR_NONE) ||
+      (IQProfile_Init(&IQProfile, (const void *)(XSPI2_BASE + IQ_PROFILE_NOR_OFFSET), IQ_PROFILE_MAX_SIZE) != HAL_OK) ||
+      (IQProfile_Find(&IQProfile, Sensor, Mode, &param) != HAL_OK))
+  {
+    printf("[iq] no profile for %s mode %lu, built-in parameters\r\n", Sensor, Mode);
+    return ISP_IQParamCacheInit[0];
+  }
+
+  printf("[iq] %s mode %lu, NOR profile\r\n", Sensor, Mode);
+  return param;
+}
+#endif
+
+#if USE_SD_RECORDER
+/**
+ * @brief  Bring up the SD card on SDMMC2 and start a recording
+ * @note   Without card the recording is not started and the frames are dropped.
+ * @param  None
+ * @retval None
+ */
+static void SDRecorder_Start(void)
+{
+  RCC_PeriphCLKInitTypeDef PeriphClkInitStruct = {0};
+  SDRec_ConfTypeDef recConf = {0};
+
+  /* SDMMC2 kernel clock: PLL1 1200 MHz / 6 = 200 MHz */
+  PeriphClkInitStruct.PeriphClockSelection = RCC_PERIPHCLK_SDMMC2;
+  PeriphClkInitStruct.Sdmmc2ClockSelection = RCC_SDMMC2CLKSOURCE_IC4;
+  PeriphClkInitStruct.ICSelection[RCC_IC4].ClockSelection = RCC_ICCLKSOURCE_PLL1;
+  PeriphClkInitStruct.ICSelection[RCC_IC4].ClockDivider = 6;
+  if (HAL_RCCEx_PeriphCLKConfig(&PeriphClkInitStruct) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  recConf.Instance       = 0;
+  recConf.StartBlock     = SD_RECORDER_START_BLOCK;
+  recConf.NbBlocks       = SD_RECORDER_NB_BLOCKS;
+  recConf.MaxFrames      = SD_RECORDER_MAX_FRAMES;
+  recConf.StagingAddress = SD_RECORDER_STAGING_ADDRESS;
+  recConf.StagingSize    = SD_RECORDER_STAGING_SIZE;
+  recConf.NbStaging      = SD_RECORDER_NB_STAGING;
+  if (SDRec_Init(&Recorder, &recConf) != HAL_OK)
+  {
+    Error_Handler();
+  }
+  RecorderReportTick = HAL_GetTick();
+
+  if (BSP_SD_Init(0) != BSP_ERROR_NONE)
+  {
+    printf("[recorder] no SD card\r\n");
+    return;
+  }
+#if USE_JPEG_RECORDING
+  if (SDRec_Start(&Recorder, SD_REC_FORMAT_JPEG, FRAME_WIDTH, FRAME_HEIGHT) != HAL_OK)
+#else
+  if (SDRec_Start(&Recorder, SD_REC_FORMAT_RGB888, ANALYTICS_WIDTH, ANALYTICS_HEIGHT) != HAL_OK)
+#endif
+  {
+    printf("[recorder] SD card erase failed\r\n");
+  }
+}
+#endif
+
+#if USE_FRAME_META
+/**
+ * @brief  Record the settings of each frame in its ring buffer, from the sensor
+ *         settings at start
+ * @param  None
+ * @retval None
+ */
+static void FrameMeta_Start(void)
+{
+  FrameMeta_ConfTypeDef metaConf = {0};
+
+  metaConf.SensorDelay = FRAME_META_SENSOR_DELAY;
+  if ((OV5647_GetGain(&OV5647Obj, &metaConf.Gain) != OV5647_OK) ||
+      (OV5647_GetExposure(&OV5647Obj, &metaConf.Exposure) != OV5647_OK) ||
+      (FrameMeta_Init(&FrameMeta, &hcamera_isp, &metaConf) != HAL_OK))
+  {
+    Error_Handler();
+  }
+}
+#endif
+
+#if USE_TOUCH_METER
+/**
+ * @brief  Bring up the touch panel and meter on the spot tapped on the preview
+ * @note   Without touch panel the statistic area stays the one of the IQ
+ *         parameters.
+ * @param  None
+ * @retval None
+ */
+static void TouchMeter_Start(void)
+{
+  TS_Init_t tsInit = {0};
+  TouchMeter_ConfTypeDef meterConf = {0};
+  TouchMeter_MapTypeDef map = {0};
+  ISP_DecimationTypeDef decimation = {ISP_DECIM_FACTOR_1};
+  const PipeRoi_HandleTypeDef *roi = CaptureGraph_GetRoi(&CaptureGraph, FrameRing->Pipe);
+
+  (void)ISP_GetDecimationFactor(&hcamera_isp, &decimation);
+
+  /* Preview: crop window of the displayed pipe downsized to the LTDC layer 1 */
+  map.DisplayX      = 0;
+  map.DisplayY      = 0;
+  map.DisplayWidth  = FRAME_WIDTH;
+  map.DisplayHeight = FRAME_HEIGHT;
+  map.CropX         = roi->Current.Crop.HStart;
+  map.CropY         = roi->Current.Crop.VStart;
+  map.CropWidth     = roi->Current.Crop.HSize;
+  map.CropHeight    = roi->Current.Crop.VSize;
+  map.Decimation    = (uint32_t)decimation.factor;
+  map.SensorWidth   = CAMERA_WIDTH;
+  map.SensorHeight  = CAMERA_HEIGHT;
+
+  meterConf.Instance   = 0;
+  meterConf.SpotWidth  = TOUCH_METER_SPOT_SIZE;
+  meterConf.SpotHeight = TOUCH_METER_SPOT_SIZE;
+  meterConf.PollPeriod = TOUCH_METER_POLL_MS;
+  if (TouchMeter_Init(&TouchMeter, &hcamera_isp, &meterConf, &map) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  tsInit.Width       = FRAME_WIDTH;
+  tsInit.Height      = FRAME_HEIGHT;
+  tsInit.Orientation = TS_SWAP_NONE;
+  tsInit.Accuracy    = 0;
+  if (BSP_TS_Init(meterConf.Instance, &tsInit) != BSP_ERROR_NONE)
+  {
+    printf("[touch] no touch panel\r\n");
+    return;
+  }
+  TouchPanel = 1;
+}
+#endif
+
+#if USE_PSRAM_FRAME_POOL
+/**
+ * @brief  Bring up the PSRAM on XSPI1 in memory-mapped mode
+ * @param  None
+ * @retval None
+ */
+static void PSRAM_Init(void)
+{
+  RCC_PeriphCLKInitTypeDef PeriphClkInitStruct = {0};
+
+  /* XSPI1 kernel clock: PLL1 1200 MHz / 6 = 200 MHz */
+  PeriphClkInitStruct.PeriphClockSelection = RCC_PERIPHCLK_XSPI1;
+  PeriphClkInitStruct.Xspi1ClockSelection = RCC_XSPI1CLKSOURCE_IC3;
+  PeriphClkInitStruct.ICSelection[RCC_IC3].ClockSelection = RCC_ICCLKSOURCE_PLL1;
+  PeriphClkInitStruct.ICSelection[RCC_IC3].ClockDivider = 6;
+  if (HAL_RCCEx_PeriphCLKConfig(&PeriphClkInitStruct) != HAL_OK)
+  {
+    Error_Handler();
+  }
+
+  if (BSP_XSPI_RAM_Init(0) != BSP_ERROR_NONE)
+  {
+    Error_Handler();
+  }
+  if (BSP_XSPI_RAM_EnableMemoryMappedMode(0) != BSP_ERROR_NONE)
+  {
+    Error_Handler();
+  }
+}
+#endif
+
 
 static void OV5647_Probe(uint32_t Resolution, uint32_t PixelFormat)
 {
@@ -579,9 +1349,25 @@ static ISP_StatusTypeDef GetSensorInfoHelper(uint32_t Instance, ISP_SensorInfoTy
 static ISP_StatusTypeDef SetSensorGainHelper(uint32_t Instance, int32_t Gain)
 {
   UNUSED(Instance);
-  isp_gain = Gain;
   //return (ISP_StatusTypeDef) IMX335_SetGain(&IMX335Obj, Gain);
-  return (ISP_StatusTypeDef) OV5647_SetGain(&OV5647Obj, Gain);
+#if USE_SENSOR_QUEUE
+  uint8_t regs[OV5647_GAIN_NB_REGS];
+
+  if ((OV5647_GetGainRegs(&OV5647Obj, Gain, regs) != OV5647_OK) ||
+      (SensorQueue_Write(&SensorQueue, OV5647_REG_GAIN_H, regs, OV5647_GAIN_NB_REGS) != HAL_OK))
+  {
+    return ISP_ERR_SENSORGAIN;
+  }
+#else
+  if (OV5647_SetGain(&OV5647Obj, Gain) != OV5647_OK)
+  {
+    return ISP_ERR_SENSORGAIN;
+  }
+#endif
+#if USE_FRAME_META
+  FrameMeta_SetGain(&FrameMeta, Gain);
+#endif
+  return ISP_OK;
 }
 
 /**
@@ -591,8 +1377,8 @@ static ISP_StatusTypeDef SetSensorGainHelper(uint32_t Instance, int32_t Gain)
 static ISP_StatusTypeDef GetSensorGainHelper(uint32_t Instance, int32_t *Gain)
 {
   UNUSED(Instance);
-  *Gain = isp_gain;
-  return ISP_OK;
+  /* Gain applied by the sensor, rounded to its gain step */
+  return (ISP_StatusTypeDef) OV5647_GetGain(&OV5647Obj, Gain);
 }
 
 /**
@@ -602,9 +1388,45 @@ static ISP_StatusTypeDef GetSensorGainHelper(uint32_t Instance, int32_t *Gain)
 static ISP_StatusTypeDef SetSensorExposureHelper(uint32_t Instance, int32_t Exposure)
 {
   UNUSED(Instance);
-  isp_exposure = Exposure;
   //return (ISP_StatusTypeDef) IMX335_SetExposure(&IMX335Obj, Exposure);
-  return (ISP_StatusTypeDef) OV5647_SetExposure(&OV5647Obj, Exposure);
+#if USE_FRAME_GOVERNOR
+  /* Frame length first: the exposure is clamped against it */
+  uint32_t vts = FrameGovernor.Vts;
+  uint8_t changed = (FrameGovernor_Update(&FrameGovernor, (uint32_t)Exposure) != vts) ? 1U : 0U;
+#endif
+#if USE_SENSOR_QUEUE
+  uint8_t regs[OV5647_EXPOSURE_NB_REGS];
+
+#if USE_FRAME_GOVERNOR
+  /* Same group as the exposure: both latched on the same frame */
+  if ((changed != 0U) &&
+      ((OV5647_GetFrameLengthRegs(&OV5647Obj, FrameGovernor.Vts, regs) != OV5647_OK) ||
+       (SensorQueue_Write(&SensorQueue, OV5647_REG_VTS_H, regs, OV5647_VTS_NB_REGS) != HAL_OK)))
+  {
+    return ISP_ERR_SENSOREXPOSURE;
+  }
+#endif
+  if ((OV5647_GetExposureRegs(&OV5647Obj, Exposure, regs) != OV5647_OK) ||
+      (SensorQueue_Write(&SensorQueue, OV5647_REG_EXPOSURE_H, regs, OV5647_EXPOSURE_NB_REGS) != HAL_OK))
+  {
+    return ISP_ERR_SENSOREXPOSURE;
+  }
+#else
+#if USE_FRAME_GOVERNOR
+  if ((changed != 0U) && (OV5647_SetFrameLength(&OV5647Obj, FrameGovernor.Vts) != OV5647_OK))
+  {
+    return ISP_ERR_SENSOREXPOSURE;
+  }
+#endif
+  if (OV5647_SetExposure(&OV5647Obj, Exposure) != OV5647_OK)
+  {
+    return ISP_ERR_SENSOREXPOSURE;
+  }
+#endif
+#if USE_FRAME_META
+  FrameMeta_SetExposure(&FrameMeta, Exposure);
+#endif
+  return ISP_OK;
 }
 
 /**
@@ -614,13 +1436,122 @@ static ISP_StatusTypeDef SetSensorExposureHelper(uint32_t Instance, int32_t Expo
 static ISP_StatusTypeDef GetSensorExposureHelper(uint32_t Instance, int32_t *Exposure)
 {
   UNUSED(Instance);
-  *Exposure = isp_exposure;
-  return ISP_OK;
+  /* Exposure applied by the sensor, rounded to whole lines */
+  return (ISP_StatusTypeDef) OV5647_GetExposure(&OV5647Obj, Exposure);
 }
 
+/**
+ * @brief  Frame Event callback on pipe
+ * @param  hdcmipp DCMIPP device handle
+ *         Pipe    Pipe receiving the callback
+ * @retval None
+ */
 void HAL_DCMIPP_PIPE_FrameEventCallback(DCMIPP_HandleTypeDef *hdcmipp, uint32_t Pipe)
 {
-  NbMainFrames++;
+  UNUSED(hdcmipp);
+  if (Pipe == DCMIPP_PIPE1)
+  {
+    NbMainFrames++;
+  }
+  CaptureGraph_FrameEventHandler(&CaptureGraph, Pipe);
+#if USE_FRAME_TRACE
+  if (Pipe == FrameRing->Pipe)
+  {
+    FrameTrace_Record(&htrace, FRAME_TRACE_FRAME_COMPLETE, FrameRing->FrameCount);
+  }
+#endif
+}
+
+/**
+ * @brief  Line Event callback on pipe
+ * @param  hdcmipp DCMIPP device handle
+ *         Pipe    Pipe receiving the callback
+ * @retval None
+ */
+void HAL_DCMIPP_PIPE_LineEventCallback(DCMIPP_HandleTypeDef *hdcmipp, uint32_t Pipe)
+{
+  UNUSED(hdcmipp);
+  CaptureGraph_LineEventHandler(&CaptureGraph, Pipe);
+}
+
+#if USE_JPEG_RECORDING
+/**
+ * @brief  JPEG codec ready for the next input buffer
+ * @param  hjpeg         JPEG device handle
+ *         NbEncodedData Bytes of the current input buffer already read
+ * @retval None
+ */
+void HAL_JPEG_GetDataCallback(JPEG_HandleTypeDef *hjpeg, uint32_t NbEncodedData)
+{
+  UNUSED(hjpeg);
+  JpegEnc_GetDataHandler(&JpegEncoder, NbEncodedData);
+}
+
+/**
+ * @brief  JPEG codec output buffer filled
+ * @param  hjpeg         JPEG device handle
+ *         pDataOut      Output buffer
+ *         OutDataLength Bytes written
+ * @retval None
+ */
+void HAL_JPEG_DataReadyCallback(JPEG_HandleTypeDef *hjpeg, uint8_t *pDataOut, uint32_t OutDataLength)
+{
+  UNUSED(hjpeg);
+  UNUSED(pDataOut);
+  JpegEnc_DataReadyHandler(&JpegEncoder, OutDataLength);
+}
+
+/**
+ * @brief  JPEG encoding of a frame completed
+ * @param  hjpeg JPEG device handle
+ * @retval None
+ */
+void HAL_JPEG_EncodeCpltCallback(JPEG_HandleTypeDef *hjpeg)
+{
+  UNUSED(hjpeg);
+  JpegEnc_EncodeCpltHandler(&JpegEncoder);
+}
+
+/**
+ * @brief  JPEG codec or DMA error
+ * @param  hjpeg JPEG device handle
+ * @retval None
+ */
+void HAL_JPEG_ErrorCallback(JPEG_HandleTypeDef *hjpeg)
+{
+  UNUSED(hjpeg);
+  JpegEnc_ErrorHandler(&JpegEncoder);
+}
+#else
+/**
+ * @brief  Frame ready callback of the analytics pipe
+ * @param  hgraph Capture graph handle
+ *         Pipe   Pipe having published a frame
+ * @retval None
+ */
+static void AnalyticsFrameReady(CaptureGraph_HandleTypeDef *hgraph, uint32_t Pipe)
+{
+  UNUSED(hgraph);
+  UNUSED(Pipe);
+  NbAnalyticsFrames++;
+}
+#endif
+
+/**
+ * @brief  Reload Event callback: a new frame buffer address is scanned out
+ * @param  hltdc LTDC device handle
+ * @retval None
+ */
+void HAL_LTDC_ReloadEventCallback(LTDC_HandleTypeDef *hltdc)
+{
+  UNUSED(hltdc);
+  CaptureGraph_ReloadEventHandler(&CaptureGraph);
+#if USE_FRAME_TRACE
+  if (FrameRing->Display != FRAME_RING_NO_BUFFER)
+  {
+    FrameTrace_Record(&htrace, FRAME_TRACE_LTDC_RELOAD, FrameRing->Buffer[FrameRing->Display].FrameId);
+  }
+#endif
 }
 
 /**
@@ -632,6 +1563,17 @@ void HAL_DCMIPP_PIPE_FrameEventCallback(DCMIPP_HandleTypeDef *hdcmipp, uint32_t
 void HAL_DCMIPP_PIPE_VsyncEventCallback(DCMIPP_HandleTypeDef *hdcmipp, uint32_t Pipe)
 {
   UNUSED(hdcmipp);
+#if USE_FRAME_TRACE
+  if (Pipe == FrameRing->Pipe)
+  {
+    FrameTrace_Record(&htrace, FRAME_TRACE_VSYNC, FrameRing->FrameCount);
+  }
+#endif
+#if USE_FRAME_META
+  /* Record of the frame starting, before a new region of interest is programmed */
+  FrameMeta_VsyncEventHandler(&FrameMeta, CaptureGraph_GetRing(&CaptureGraph, Pipe),
+                              CaptureGraph_GetRoi(&CaptureGraph, Pipe));
+#endif
   /* Update the frame counter and call the ISP statistics handler */
   switch (Pipe)
   {
@@ -639,14 +1581,136 @@ void HAL_DCMIPP_PIPE_VsyncEventCallback(DCMIPP_HandleTypeDef *hdcmipp, uint32_t
       //ISP_IncDumpFrameId(&hcamera_isp);
       break;
     case DCMIPP_PIPE1 :
-      //ISP_IncMainFrameId(&hcamera_isp);
-      //ISP_GatherStatistics(&hcamera_isp);
+      CaptureGraph_VsyncEventHandler(&CaptureGraph, Pipe);
+      ISP_IncMainFrameId(&hcamera_isp);
+      ISP_GatherStatistics(&hcamera_isp);
       break;
     case DCMIPP_PIPE2 :
-      //ISP_IncAncillaryFrameId(&hcamera_isp);
+      CaptureGraph_VsyncEventHandler(&CaptureGraph, Pipe);
+      ISP_IncAncillaryFrameId(&hcamera_isp);
+      break;
+  }
+}
+
+/**
+ * @brief  Start of frame on a CSI virtual channel
+ * @param  hdcmipp        DCMIPP device handle
+ *         VirtualChannel Virtual channel receiving the frame
+ * @retval None
+ */
+void HAL_DCMIPP_CSI_StartOfFrameEventCallback(DCMIPP_HandleTypeDef *hdcmipp, uint32_t VirtualChannel)
+{
+  UNUSED(hdcmipp);
+  UNUSED(VirtualChannel);
+#if USE_FRAME_TRACE
+  /* The frame starting gets the next id of the displayed pipe */
+  FrameTrace_Record(&htrace, FRAME_TRACE_CSI_SOF, FrameRing->FrameCount + 1U);
+#endif
+#if USE_SENSOR_QUEUE
+  /* Send the sensor updates while the frame is read out, latched for the next one */
+  SensorQueue_StartOfFrameHandler(&SensorQueue);
+#endif
+#if USE_FRAME_META
+#if USE_SENSOR_QUEUE
+  /* Nothing left in the queue: the last values noted are on their way to the sensor */
+  FrameMeta_StartOfFrameHandler(&FrameMeta, (SensorQueue.Next.NbWrites == 0U) ? 1U : 0U);
+#else
+  FrameMeta_StartOfFrameHandler(&FrameMeta, 1U);
+#endif
+#endif
+}
+
+#if USE_SENSOR_QUEUE
+/**
+ * @brief  I2C register write completed
+ * @param  hi2c I2C device handle
+ * @retval None
+ */
+void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+  if (hi2c == SensorQueue.Conf.hi2c)
+  {
+    SensorQueue_TxCpltHandler(&SensorQueue);
+  }
+}
+
+/**
+ * @brief  I2C transfer error
+ * @param  hi2c I2C device handle
+ * @retval None
+ */
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
+{
+  if (hi2c == SensorQueue.Conf.hi2c)
+  {
+    SensorQueue_ErrorHandler(&SensorQueue);
+  }
+}
+#endif
+
+#if USE_SD_RECORDER
+/**
+ * @brief  SD card write DMA completed
+ * @param  Instance BSP SD instance
+ * @retval None
+ */
+void BSP_SD_WriteCpltCallback(uint32_t Instance)
+{
+  UNUSED(Instance);
+  SDRec_WriteCpltHandler(&Recorder);
+}
+
+/**
+ * @brief  SD card transfer aborted
+ * @param  Instance BSP SD instance
+ * @retval None
+ */
+void BSP_SD_AbortCallback(uint32_t Instance)
+{
+  UNUSED(Instance);
+  SDRec_ErrorHandler(&Recorder);
+}
+
+/**
+ * @brief  SD card transfer error
+ * @param  hsd SD handle
+ * @retval None
+ */
+void HAL_SD_ErrorCallback(SD_HandleTypeDef *hsd)
+{
+  UNUSED(hsd);
+  SDRec_ErrorHandler(&Recorder);
+}
+#endif
+
+#if USE_FRAME_TRACE
+
+/**
+ * @brief  ISP event helper: timestamp the statistics and control updates
+ * @param  Instance Camera instance
+ *         Event    ISP event
+ *         FrameId  ISP main frame id
+ * @retval None
+ */
+static void TraceEventHelper(uint32_t Instance, ISP_TraceEventTypeDef Event, uint32_t FrameId)
+{
+  UNUSED(Instance);
+  switch (Event)
+  {
+    case ISP_TRACE_STAT_READY:
+      FrameTrace_Record(&htrace, FRAME_TRACE_STAT_READY, FrameId);
+      break;
+    case ISP_TRACE_AEC_APPLY:
+      FrameTrace_Record(&htrace, FRAME_TRACE_AEC_APPLY, FrameId);
+      break;
+    case ISP_TRACE_AWB_APPLY:
+      FrameTrace_Record(&htrace, FRAME_TRACE_AWB_APPLY, FrameId);
+      break;
+    default:
       break;
   }
 }
+#endif
 
 /* USER CODE END 4 */
 
@@ -0,0 +1,619 @@
+/**
+  ******************************************************************************
+  * @file    overlay.c
+  * @brief   UI overlay composed by DMA2D on a LTDC layer above the video.
+  *
+  *          The overlay has its own ARGB buffer shown on a LTDC layer that
+  *          the LTDC blends over the video layer, so the camera buffers are
+  *          never written and stay zero-copy.
+  *
+  *          The overlay is a list of items (filled rectangles, bounding
+  *          boxes, bitmaps) drawn in id order. Changing an item only marks
+  *          its former and new areas as dirty; a bounding box marks its four
+  *          edges only. Overlay_Update() then clears each dirty rectangle and
+  *          redraws the items crossing it, clipped to the rectangle, with one
+  *          DMA2D transfer per item part. The CPU never loops over pixels and
+  *          the cost follows the changed area, not the screen size.
+  *
+  *          The layer buffer is only accessed by the DMA2D and the LTDC, no
+  *          D-Cache maintenance is needed on it. Bitmaps written by the CPU
+  *          are cleaned when set or touched.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "overlay.h"
+
+/* Private define ------------------------------------------------------------*/
+/* Longest DMA2D transfer: full layer fill */
+#define OVERLAY_DMA2D_TIMEOUT   50U
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t Overlay_InputBytesPerPixel(uint32_t ColorMode);
+static uint8_t Overlay_CheckRect(const Overlay_HandleTypeDef *hovl, const Overlay_RectTypeDef *pRect);
+static uint8_t Overlay_Intersect(const Overlay_RectTypeDef *pA, const Overlay_RectTypeDef *pB,
+                                 Overlay_RectTypeDef *pOut);
+static void Overlay_Union(const Overlay_RectTypeDef *pA, const Overlay_RectTypeDef *pB, Overlay_RectTypeDef *pOut);
+static uint32_t Overlay_GetParts(const Overlay_ItemTypeDef *pItem, Overlay_RectTypeDef *pPart);
+static void Overlay_MarkDirty(Overlay_HandleTypeDef *hovl, const Overlay_RectTypeDef *pRect);
+static void Overlay_MarkItem(Overlay_HandleTypeDef *hovl, const Overlay_ItemTypeDef *pItem);
+static HAL_StatusTypeDef Overlay_SetItem(Overlay_HandleTypeDef *hovl, uint32_t Id, const Overlay_ItemTypeDef *pItem);
+static HAL_StatusTypeDef Overlay_Fill(Overlay_HandleTypeDef *hovl, const Overlay_RectTypeDef *pRect, uint32_t Color);
+static HAL_StatusTypeDef Overlay_Blend(Overlay_HandleTypeDef *hovl, const Overlay_ItemTypeDef *pItem,
+                                       const Overlay_RectTypeDef *pRect);
+static HAL_StatusTypeDef Overlay_DrawItem(Overlay_HandleTypeDef *hovl, const Overlay_ItemTypeDef *pItem,
+                                          const Overlay_RectTypeDef *pClip);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Clear the overlay buffer and show it on a LTDC layer
+  * @note   The LTDC must be initialized beforehand.
+  * @param  hovl      Overlay handle
+  * @param  hdma2d    DMA2D handle, Instance set
+  * @param  hltdc     LTDC handle
+  * @param  LayerIdx  LTDC layer above the video, LTDC_LAYER_2
+  * @param  pConf     Overlay configuration
+  * @retval HAL status
+  */
+HAL_StatusTypeDef Overlay_Init(Overlay_HandleTypeDef *hovl, DMA2D_HandleTypeDef *hdma2d,
+                               LTDC_HandleTypeDef *hltdc, uint32_t LayerIdx, const Overlay_ConfTypeDef *pConf)
+{
+  LTDC_LayerCfgTypeDef layerCfg = {0};
+  Overlay_RectTypeDef all;
+  uint32_t i;
+
+  if ((hovl == NULL) || (hdma2d == NULL) || (hltdc == NULL) || (pConf == NULL) ||
+      (pConf->Width == 0U) || (pConf->Height == 0U))
+  {
+    return HAL_ERROR;
+  }
+
+  if (pConf->PixelFormat == LTDC_PIXEL_FORMAT_ARGB4444)
+  {
+    hovl->OutputColorMode = DMA2D_OUTPUT_ARGB4444;
+    hovl->InputColorMode  = DMA2D_INPUT_ARGB4444;
+    hovl->BytesPerPixel   = 2;
+  }
+  else if (pConf->PixelFormat == LTDC_PIXEL_FORMAT_ARGB8888)
+  {
+    hovl->OutputColorMode = DMA2D_OUTPUT_ARGB8888;
+    hovl->InputColorMode  = DMA2D_INPUT_ARGB8888;
+    hovl->BytesPerPixel   = 4;
+  }
+  else
+  {
+    return HAL_ERROR;
+  }
+
+  hovl->hdma2d     = hdma2d;
+  hovl->hltdc      = hltdc;
+  hovl->LayerIdx   = LayerIdx;
+  hovl->Address    = pConf->Address;
+  hovl->Width      = pConf->Width;
+  hovl->Height     = pConf->Height;
+  hovl->NbDirty    = 0;
+  hovl->BlitCount  = 0;
+  hovl->PixelCount = 0;
+  for (i = 0; i < OVERLAY_MAX_ITEMS; i++)
+  {
+    hovl->Item[i].Kind = OVERLAY_ITEM_NONE;
+  }
+
+  /* Fully transparent before the layer is enabled */
+  all.X      = 0;
+  all.Y      = 0;
+  all.Width  = hovl->Width;
+  all.Height = hovl->Height;
+  if (Overlay_Fill(hovl, &all, 0x00000000U) != HAL_OK)
+  {
+    return HAL_ERROR;
+  }
+
+  /* Blended over the video with the pixel alpha */
+  layerCfg.WindowX0        = pConf->X;
+  layerCfg.WindowX1        = pConf->X + pConf->Width;
+  layerCfg.WindowY0        = pConf->Y;
+  layerCfg.WindowY1        = pConf->Y + pConf->Height;
+  layerCfg.PixelFormat     = pConf->PixelFormat;
+  layerCfg.FBStartAdress   = pConf->Address;
+  layerCfg.Alpha           = LTDC_LxCACR_CONSTA;
+  layerCfg.Alpha0          = 0;
+  layerCfg.BlendingFactor1 = LTDC_BLENDING_FACTOR1_PAxCA;
+  layerCfg.BlendingFactor2 = LTDC_BLENDING_FACTOR2_PAxCA;
+  layerCfg.ImageWidth      = pConf->Width;
+  layerCfg.ImageHeight     = pConf->Height;
+
+  return HAL_LTDC_ConfigLayer(hltdc, &layerCfg, LayerIdx);
+}
+
+/**
+  * @brief  Set an item to a filled rectangle
+  * @param  hovl   Overlay handle
+  * @param  Id     Item, 0 to OVERLAY_MAX_ITEMS - 1
+  * @param  pRect  Rectangle, inside the overlay
+  * @param  Color  ARGB8888 color, the alpha is kept in the layer buffer
+  * @retval HAL status
+  */
+HAL_StatusTypeDef Overlay_SetFill(Overlay_HandleTypeDef *hovl, uint32_t Id, const Overlay_RectTypeDef *pRect,
+                                  uint32_t Color)
+{
+  Overlay_ItemTypeDef item = {0};
+
+  item.Kind  = OVERLAY_ITEM_FILL;
+  item.Rect  = *pRect;
+  item.Color = Color;
+
+  return Overlay_SetItem(hovl, Id, &item);
+}
+
+/**
+  * @brief  Set an item to a rectangle outline
+  * @param  hovl       Overlay handle
+  * @param  Id         Item, 0 to OVERLAY_MAX_ITEMS - 1
+  * @param  pRect      Outer bounds, inside the overlay
+  * @param  Thickness  Line width in pixels
+  * @param  Color      ARGB8888 color
+  * @retval HAL status
+  */
+HAL_StatusTypeDef Overlay_SetFrame(Overlay_HandleTypeDef *hovl, uint32_t Id, const Overlay_RectTypeDef *pRect,
+                                   uint32_t Thickness, uint32_t Color)
+{
+  Overlay_ItemTypeDef item = {0};
+
+  if (Thickness == 0U)
+  {
+    return HAL_ERROR;
+  }
+
+  item.Kind      = OVERLAY_ITEM_FRAME;
+  item.Rect      = *pRect;
+  item.Color     = Color;
+  item.Thickness = Thickness;
+
+  return Overlay_SetItem(hovl, Id, &item);
+}
+
+/**
+  * @brief  Set an item to a bitmap blended over the items below
+  * @param  hovl       Overlay handle
+  * @param  Id         Item, 0 to OVERLAY_MAX_ITEMS - 1
+  * @param  pRect      Position and size of the bitmap, inside the overlay
+  * @param  Address    Bitmap pixels, pRect->Width pixels per line
+  * @param  ColorMode  DMA2D_INPUT_ARGB8888, RGB888, RGB565, ARGB1555, ARGB4444
+  *                    or A8 (glyphs, alpha only)
+  * @param  Color      ARGB8888 color of an A8 bitmap, unused otherwise
+  * @retval HAL status
+  */
+HAL_StatusTypeDef Overlay_SetBitmap(Overlay_HandleTypeDef *hovl, uint32_t Id, const Overlay_RectTypeDef *pRect,
+                                    uint32_t Address, uint32_t ColorMode, uint32_t Color)
+{
+  Overlay_ItemTypeDef item = {0};
+
+  if (Overlay_InputBytesPerPixel(ColorMode) == 0U)
+  {
+    return HAL_ERROR;
+  }
+
+  item.Kind      = OVERLAY_ITEM_BITMAP;
+  item.Rect      = *pRect;
+  item.Color     = Color;
+  item.Address   = Address;
+  item.ColorMode = ColorMode;
+
+  return Overlay_SetItem(hovl, Id, &item);
+}
+
+/**
+  * @brief  Redraw an item whose bitmap content has been rewritten by the CPU
+  * @param  hovl  Overlay handle
+  * @param  Id    Item
+  * @retval HAL status
+  */
+HAL_StatusTypeDef Overlay_Touch(Overlay_HandleTypeDef *hovl, uint32_t Id)
+{
+  Overlay_ItemTypeDef *item;
+
+  if (Id >= OVERLAY_MAX_ITEMS)
+  {
+    return HAL_ERROR;
+  }
+
+  item = &hovl->Item[Id];
+  if (item->Kind == OVERLAY_ITEM_BITMAP)
+  {
+    SCB_CleanDCache_by_Addr((uint32_t *)item->Address,
+                            (int32_t)(item->Rect.Width * item->Rect.Height *
+                                      Overlay_InputBytesPerPixel(item->ColorMode)));
+  }
+  Overlay_MarkItem(hovl, item);
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Remove an item from the overlay
+  * @param  hovl  Overlay handle
+  * @param  Id    Item
+  * @retval HAL status
+  */
+HAL_StatusTypeDef Overlay_Hide(Overlay_HandleTypeDef *hovl, uint32_t Id)
+{
+  Overlay_ItemTypeDef item = {0};
+
+  item.Kind = OVERLAY_ITEM_NONE;
+
+  return Overlay_SetItem(hovl, Id, &item);
+}
+
+/**
+  * @brief  Redraw the dirty rectangles of the overlay
+  * @note   Blocking, one DMA2D transfer per dirty rectangle and per item part
+  *         crossing it. Best called right after the LTDC reload so the
+  *         transfers run ahead of the scan-out.
+  * @param  hovl  Overlay handle
+  * @retval HAL status
+  */
+HAL_StatusTypeDef Overlay_Update(Overlay_HandleTypeDef *hovl)
+{
+  HAL_StatusTypeDef status = HAL_OK;
+  uint32_t d;
+  uint32_t i;
+
+  hovl->BlitCount  = 0;
+  hovl->PixelCount = 0;
+
+  for (d = 0; (d < hovl->NbDirty) && (status == HAL_OK); d++)
+  {
+    status = Overlay_Fill(hovl, &hovl->Dirty[d], 0x00000000U);
+    for (i = 0; (i < OVERLAY_MAX_ITEMS) && (status == HAL_OK); i++)
+    {
+      status = Overlay_DrawItem(hovl, &hovl->Item[i], &hovl->Dirty[d]);
+    }
+  }
+  hovl->NbDirty = 0;
+
+  return status;
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  Get the size of a supported bitmap pixel
+  * @retval Bytes per pixel, 0 for a format not supported as a bitmap
+  */
+static uint32_t Overlay_InputBytesPerPixel(uint32_t ColorMode)
+{
+  switch (ColorMode)
+  {
+    case DMA2D_INPUT_ARGB8888:
+      return 4U;
+    case DMA2D_INPUT_RGB888:
+      return 3U;
+    case DMA2D_INPUT_RGB565:
+    case DMA2D_INPUT_ARGB1555:
+    case DMA2D_INPUT_ARGB4444:
+      return 2U;
+    case DMA2D_INPUT_A8:
+      return 1U;
+    default:
+      /* CLUT and 4-bit formats cannot be clipped on any pixel */
+      return 0U;
+  }
+}
+
+/**
+  * @brief  Check that a rectangle is not empty and lies inside the overlay
+  * @retval 1 if valid
+  */
+static uint8_t Overlay_CheckRect(const Overlay_HandleTypeDef *hovl, const Overlay_RectTypeDef *pRect)
+{
+  return ((pRect->Width != 0U) && (pRect->Height != 0U) &&
+          (pRect->X < hovl->Width) && (pRect->Width <= (hovl->Width - pRect->X)) &&
+          (pRect->Y < hovl->Height) && (pRect->Height <= (hovl->Height - pRect->Y))) ? 1U : 0U;
+}
+
+/**
+  * @brief  Intersection of two rectangles
+  * @retval 1 if not empty
+  */
+static uint8_t Overlay_Intersect(const Overlay_RectTypeDef *pA, const Overlay_RectTypeDef *pB,
+                                 Overlay_RectTypeDef *pOut)
+{
+  uint32_t x0 = (pA->X > pB->X) ? pA->X : pB->X;
+  uint32_t y0 = (pA->Y > pB->Y) ? pA->Y : pB->Y;
+  uint32_t x1 = ((pA->X + pA->Width) < (pB->X + pB->Width)) ? (pA->X + pA->Width) : (pB->X + pB->Width);
+  uint32_t y1 = ((pA->Y + pA->Height) < (pB->Y + pB->Height)) ? (pA->Y + pA->Height) : (pB->Y + pB->Height);
+
+  if ((x0 >= x1) || (y0 >= y1))
+  {
+    return 0U;
+  }
+
+  pOut->X      = x0;
+  pOut->Y      = y0;
+  pOut->Width  = x1 - x0;
+  pOut->Height = y1 - y0;
+
+  return 1U;
+}
+
+/**
+  * @brief  Bounding box of two rectangles
+  * @retval None
+  */
+static void Overlay_Union(const Overlay_RectTypeDef *pA, const Overlay_RectTypeDef *pB, Overlay_RectTypeDef *pOut)
+{
+  uint32_t x0 = (pA->X < pB->X) ? pA->X : pB->X;
+  uint32_t y0 = (pA->Y < pB->Y) ? pA->Y : pB->Y;
+  uint32_t x1 = ((pA->X + pA->Width) > (pB->X + pB->Width)) ? (pA->X + pA->Width) : (pB->X + pB->Width);
+  uint32_t y1 = ((pA->Y + pA->Height) > (pB->Y + pB->Height)) ? (pA->Y + pA->Height) : (pB->Y + pB->Height);
+
+  pOut->X      = x0;
+  pOut->Y      = y0;
+  pOut->Width  = x1 - x0;
+  pOut->Height = y1 - y0;
+}
+
+/**
+  * @brief  Split an item into the rectangles it covers
+  * @param  pItem  Visible item
+  * @param  pPart  Four rectangles
+  * @retval Number of rectangles: 4 for an outline, 1 otherwise
+  */
+static uint32_t Overlay_GetParts(const Overlay_ItemTypeDef *pItem, Overlay_RectTypeDef *pPart)
+{
+  const Overlay_RectTypeDef *r = &pItem->Rect;
+  uint32_t t = pItem->Thickness;
+
+  if ((pItem->Kind != OVERLAY_ITEM_FRAME) || ((2U * t) >= r->Width) || ((2U * t) >= r->Height))
+  {
+    pPart[0] = *r;
+    return 1U;
+  }
+
+  /* Top, bottom, left and right edges */
+  pPart[0].X = r->X;                  pPart[0].Y = r->Y;
+  pPart[0].Width = r->Width;          pPart[0].Height = t;
+  pPart[1].X = r->X;                  pPart[1].Y = r->Y + r->Height - t;
+  pPart[1].Width = r->Width;          pPart[1].Height = t;
+  pPart[2].X = r->X;                  pPart[2].Y = r->Y + t;
+  pPart[2].Width = t;                 pPart[2].Height = r->Height - (2U * t);
+  pPart[3].X = r->X + r->Width - t;   pPart[3].Y = r->Y + t;
+  pPart[3].Width = t;                 pPart[3].Height = r->Height - (2U * t);
+
+  return 4U;
+}
+
+/**
+  * @brief  Add a rectangle to the dirty list
+  * @note   A rectangle overlapping a dirty one is merged with it. When the list
+  *         is full, it is merged with the dirty rectangle growing the least.
+  * @retval None
+  */
+static void Overlay_MarkDirty(Overlay_HandleTypeDef *hovl, const Overlay_RectTypeDef *pRect)
+{
+  Overlay_RectTypeDef merged;
+  Overlay_RectTypeDef common;
+  uint32_t best = 0;
+  uint32_t best_growth = 0xFFFFFFFFU;
+  uint32_t growth;
+  uint32_t d;
+
+  for (d = 0; d < hovl->NbDirty; d++)
+  {
+    if (Overlay_Intersect(&hovl->Dirty[d], pRect, &common) != 0U)
+    {
+      Overlay_Union(&hovl->Dirty[d], pRect, &hovl->Dirty[d]);
+      return;
+    }
+  }
+
+  if (hovl->NbDirty < OVERLAY_MAX_DIRTY)
+  {
+    hovl->Dirty[hovl->NbDirty] = *pRect;
+    hovl->NbDirty++;
+    return;
+  }
+
+  for (d = 0; d < hovl->NbDirty; d++)
+  {
+    Overlay_Union(&hovl->Dirty[d], pRect, &merged);
+    growth = (merged.Width * merged.Height) - (hovl->Dirty[d].Width * hovl->Dirty[d].Height);
+    if (growth < best_growth)
+    {
+      best_growth = growth;
+      best = d;
+    }
+  }
+  Overlay_Union(&hovl->Dirty[best], pRect, &hovl->Dirty[best]);
+}
+
+/**
+  * @brief  Mark the area covered by an item as dirty
+  * @retval None
+  */
+static void Overlay_MarkItem(Overlay_HandleTypeDef *hovl, const Overlay_ItemTypeDef *pItem)
+{
+  Overlay_RectTypeDef part[4];
+  uint32_t nb;
+  uint32_t p;
+
+  if (pItem->Kind == OVERLAY_ITEM_NONE)
+  {
+    return;
+  }
+
+  nb = Overlay_GetParts(pItem, part);
+  for (p = 0; p < nb; p++)
+  {
+    Overlay_MarkDirty(hovl, &part[p]);
+  }
+}
+
+/**
+  * @brief  Replace an item, marking its former and new areas as dirty
+  * @retval HAL status
+  */
+static HAL_StatusTypeDef Overlay_SetItem(Overlay_HandleTypeDef *hovl, uint32_t Id, const Overlay_ItemTypeDef *pItem)
+{
+  Overlay_ItemTypeDef *item;
+
+  if ((Id >= OVERLAY_MAX_ITEMS) ||
+      ((pItem->Kind != OVERLAY_ITEM_NONE) && (Overlay_CheckRect(hovl, &pItem->Rect) == 0U)))
+  {
+    return HAL_ERROR;
+  }
+
+  item = &hovl->Item[Id];
+  if ((item->Kind == pItem->Kind) && (item->Rect.X == pItem->Rect.X) && (item->Rect.Y == pItem->Rect.Y) &&
+      (item->Rect.Width == pItem->Rect.Width) && (item->Rect.Height == pItem->Rect.Height) &&
+      (item->Color == pItem->Color) && (item->Thickness == pItem->Thickness) &&
+      (item->Address == pItem->Address) && (item->ColorMode == pItem->ColorMode))
+  {
+    /* Unchanged: nothing to redraw */
+    return HAL_OK;
+  }
+
+  Overlay_MarkItem(hovl, item);
+  *item = *pItem;
+  if (item->Kind == OVERLAY_ITEM_BITMAP)
+  {
+    SCB_CleanDCache_by_Addr((uint32_t *)item->Address,
+                            (int32_t)(item->Rect.Width * item->Rect.Height *
+                                      Overlay_InputBytesPerPixel(item->ColorMode)));
+  }
+  Overlay_MarkItem(hovl, item);
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Fill a rectangle of the layer buffer with a color (DMA2D R2M)
+  * @retval HAL status
+  */
+static HAL_StatusTypeDef Overlay_Fill(Overlay_HandleTypeDef *hovl, const Overlay_RectTypeDef *pRect, uint32_t Color)
+{
+  DMA2D_HandleTypeDef *hdma2d = hovl->hdma2d;
+  uint32_t dst = hovl->Address + (((pRect->Y * hovl->Width) + pRect->X) * hovl->BytesPerPixel);
+
+  hdma2d->Init.Mode           = DMA2D_R2M;
+  hdma2d->Init.ColorMode      = hovl->OutputColorMode;
+  hdma2d->Init.OutputOffset   = hovl->Width - pRect->Width;
+  hdma2d->Init.AlphaInverted  = DMA2D_REGULAR_ALPHA;
+  hdma2d->Init.RedBlueSwap    = DMA2D_RB_REGULAR;
+  hdma2d->Init.BytesSwap      = DMA2D_BYTES_REGULAR;
+  hdma2d->Init.LineOffsetMode = DMA2D_LOM_PIXELS;
+
+  if ((HAL_DMA2D_Init(hdma2d) != HAL_OK) ||
+      (HAL_DMA2D_Start(hdma2d, Color, dst, pRect->Width, pRect->Height) != HAL_OK))
+  {
+    return HAL_ERROR;
+  }
+
+  hovl->BlitCount++;
+  hovl->PixelCount += pRect->Width * pRect->Height;
+
+  return HAL_DMA2D_PollForTransfer(hdma2d, OVERLAY_DMA2D_TIMEOUT);
+}
+
+/**
+  * @brief  Blend the part of a bitmap item inside a rectangle over the layer
+  *         buffer (DMA2D M2M blending, the layer buffer is the background)
+  * @retval HAL status
+  */
+static HAL_StatusTypeDef Overlay_Blend(Overlay_HandleTypeDef *hovl, const Overlay_ItemTypeDef *pItem,
+                                       const Overlay_RectTypeDef *pRect)
+{
+  DMA2D_HandleTypeDef *hdma2d = hovl->hdma2d;
+  DMA2D_LayerCfgTypeDef *fg = &hdma2d->LayerCfg[DMA2D_FOREGROUND_LAYER];
+  DMA2D_LayerCfgTypeDef *bg = &hdma2d->LayerCfg[DMA2D_BACKGROUND_LAYER];
+  uint32_t src = pItem->Address + ((((pRect->Y - pItem->Rect.Y) * pItem->Rect.Width) + (pRect->X - pItem->Rect.X)) *
+                                   Overlay_InputBytesPerPixel(pItem->ColorMode));
+  uint32_t dst = hovl->Address + (((pRect->Y * hovl->Width) + pRect->X) * hovl->BytesPerPixel);
+
+  hdma2d->Init.Mode           = DMA2D_M2M_BLEND;
+  hdma2d->Init.ColorMode      = hovl->OutputColorMode;
+  hdma2d->Init.OutputOffset   = hovl->Width - pRect->Width;
+  hdma2d->Init.AlphaInverted  = DMA2D_REGULAR_ALPHA;
+  hdma2d->Init.RedBlueSwap    = DMA2D_RB_REGULAR;
+  hdma2d->Init.BytesSwap      = DMA2D_BYTES_REGULAR;
+  hdma2d->Init.LineOffsetMode = DMA2D_LOM_PIXELS;
+
+  fg->InputOffset       = pItem->Rect.Width - pRect->Width;
+  fg->InputColorMode    = pItem->ColorMode;
+  fg->AlphaInverted     = DMA2D_REGULAR_ALPHA;
+  fg->RedBlueSwap       = DMA2D_RB_REGULAR;
+  fg->ChromaSubSampling = DMA2D_NO_CSS;
+  if (pItem->ColorMode == DMA2D_INPUT_A8)
+  {
+    /* Glyph coverage scaled by the alpha of the item color */
+    fg->AlphaMode  = DMA2D_COMBINE_ALPHA;
+    fg->InputAlpha = pItem->Color;
+  }
+  else
+  {
+    fg->AlphaMode  = DMA2D_NO_MODIF_ALPHA;
+    fg->InputAlpha = 0xFFU;
+  }
+
+  bg->InputOffset       = hovl->Width - pRect->Width;
+  bg->InputColorMode    = hovl->InputColorMode;
+  bg->AlphaMode         = DMA2D_NO_MODIF_ALPHA;
+  bg->InputAlpha        = 0xFFU;
+  bg->AlphaInverted     = DMA2D_REGULAR_ALPHA;
+  bg->RedBlueSwap       = DMA2D_RB_REGULAR;
+  bg->ChromaSubSampling = DMA2D_NO_CSS;
+
+  if ((HAL_DMA2D_Init(hdma2d) != HAL_OK) ||
+      (HAL_DMA2D_ConfigLayer(hdma2d, DMA2D_FOREGROUND_LAYER) != HAL_OK) ||
+      (HAL_DMA2D_ConfigLayer(hdma2d, DMA2D_BACKGROUND_LAYER) != HAL_OK) ||
+      (HAL_DMA2D_BlendingStart(hdma2d, src, dst, dst, pRect->Width, pRect->Height) != HAL_OK))
+  {
+    return HAL_ERROR;
+  }
+
+  hovl->BlitCount++;
+  hovl->PixelCount += pRect->Width * pRect->Height;
+
+  return HAL_DMA2D_PollForTransfer(hdma2d, OVERLAY_DMA2D_TIMEOUT);
+}
+
+/**
+  * @brief  Draw the parts of an item inside a clip rectangle
+  * @retval HAL status
+  */
+static HAL_StatusTypeDef Overlay_DrawItem(Overlay_HandleTypeDef *hovl, const Overlay_ItemTypeDef *pItem,
+                                          const Overlay_RectTypeDef *pClip)
+{
+  HAL_StatusTypeDef status = HAL_OK;
+  Overlay_RectTypeDef part[4];
+  Overlay_RectTypeDef clipped;
+  uint32_t nb;
+  uint32_t p;
+
+  if (pItem->Kind == OVERLAY_ITEM_NONE)
+  {
+    return HAL_OK;
+  }
+
+  nb = Overlay_GetParts(pItem, part);
+  for (p = 0; (p < nb) && (status == HAL_OK); p++)
+  {
+    if (Overlay_Intersect(&part[p], pClip, &clipped) != 0U)
+    {
+      status = (pItem->Kind == OVERLAY_ITEM_BITMAP) ? Overlay_Blend(hovl, pItem, &clipped)
+                                                    : Overlay_Fill(hovl, &clipped, pItem->Color);
+    }
+  }
+
+  return status;
+}
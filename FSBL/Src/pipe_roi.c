@@ -0,0 +1,229 @@
+/**
+  ******************************************************************************
+  * @file    pipe_roi.c
+  * @brief   Region of interest (digital pan/zoom) on a DCMIPP pixel pipe.
+  *
+  *          The crop stage selects a window of the input frame and the
+  *          downsize stage scales it to the pipe output size, so only the
+  *          region of interest is processed and written to memory.
+  *          New settings are computed in thread context and programmed from
+  *          the pipe VSYNC event, between two frames, without stopping the
+  *          capture.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "pipe_roi.h"
+
+/* Private define ------------------------------------------------------------*/
+/* Downsize ratio unit (1.0) and largest downsize ratio supported (8.0) */
+#define PIPE_ROI_RATIO_ONE    8192U
+#define PIPE_ROI_RATIO_MAX    65535U
+
+/* Private function prototypes -----------------------------------------------*/
+static HAL_StatusTypeDef PipeRoi_Apply(PipeRoi_HandleTypeDef *hroi, const PipeRoi_ConfTypeDef *pConf);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Initialize the region of interest to the whole input frame and
+  *         enable the crop and downsize stages. To be called before the pipe
+  *         is started.
+  * @param  hroi          ROI handle
+  * @param  hdcmipp       DCMIPP handle
+  * @param  Pipe          DCMIPP_PIPE1 or DCMIPP_PIPE2
+  * @param  InputWidth    Width of the frame entering the pipe
+  * @param  InputHeight   Height of the frame entering the pipe
+  * @param  OutputWidth   Width written to memory
+  * @param  OutputHeight  Height written to memory
+  * @retval HAL status
+  */
+HAL_StatusTypeDef PipeRoi_Init(PipeRoi_HandleTypeDef *hroi, DCMIPP_HandleTypeDef *hdcmipp, uint32_t Pipe,
+                               uint32_t InputWidth, uint32_t InputHeight,
+                               uint32_t OutputWidth, uint32_t OutputHeight)
+{
+  if ((hroi == NULL) || (hdcmipp == NULL) || ((Pipe != DCMIPP_PIPE1) && (Pipe != DCMIPP_PIPE2)) ||
+      (OutputWidth == 0U) || (OutputHeight == 0U) ||
+      (InputWidth < OutputWidth) || (InputHeight < OutputHeight))
+  {
+    return HAL_ERROR;
+  }
+
+  hroi->hdcmipp       = hdcmipp;
+  hroi->Pipe          = Pipe;
+  hroi->InputWidth    = InputWidth;
+  hroi->InputHeight   = InputHeight;
+  hroi->OutputWidth   = OutputWidth;
+  hroi->OutputHeight  = OutputHeight;
+  hroi->UpdatePending = 0;
+
+  if (PipeRoi_ComputeConfig(hroi, 0, 0, InputWidth, InputHeight, &hroi->Current) != HAL_OK)
+  {
+    return HAL_ERROR;
+  }
+  if (PipeRoi_Apply(hroi, &hroi->Current) != HAL_OK)
+  {
+    return HAL_ERROR;
+  }
+  if (HAL_DCMIPP_PIPE_EnableCrop(hdcmipp, Pipe) != HAL_OK)
+  {
+    return HAL_ERROR;
+  }
+
+  return HAL_DCMIPP_PIPE_EnableDownsize(hdcmipp, Pipe);
+}
+
+/**
+  * @brief  Compute the crop and downsize settings of a window of the input frame
+  * @note   The downsize stage cannot upscale: the window must be at least the
+  *         output size and at most 8 times the output size in each direction.
+  * @param  hroi    ROI handle
+  * @param  X       Window left column in the input frame
+  * @param  Y       Window top line in the input frame
+  * @param  Width   Window width
+  * @param  Height  Window height
+  * @param  pConf   Computed settings
+  * @retval HAL status
+  */
+HAL_StatusTypeDef PipeRoi_ComputeConfig(const PipeRoi_HandleTypeDef *hroi, uint32_t X, uint32_t Y,
+                                        uint32_t Width, uint32_t Height, PipeRoi_ConfTypeDef *pConf)
+{
+  uint32_t hratio;
+  uint32_t vratio;
+
+  if (((X + Width) > hroi->InputWidth) || ((Y + Height) > hroi->InputHeight) ||
+      (Width < hroi->OutputWidth) || (Height < hroi->OutputHeight))
+  {
+    return HAL_ERROR;
+  }
+
+  hratio = (Width * PIPE_ROI_RATIO_ONE) / hroi->OutputWidth;
+  vratio = (Height * PIPE_ROI_RATIO_ONE) / hroi->OutputHeight;
+  if ((hratio > PIPE_ROI_RATIO_MAX) || (vratio > PIPE_ROI_RATIO_MAX))
+  {
+    return HAL_ERROR;
+  }
+
+  pConf->Crop.HStart   = X;
+  pConf->Crop.VStart   = Y;
+  pConf->Crop.HSize    = Width;
+  pConf->Crop.VSize    = Height;
+  pConf->Crop.PipeArea = DCMIPP_POSITIVE_AREA;
+
+  pConf->Downsize.HRatio     = hratio;
+  pConf->Downsize.VRatio     = vratio;
+  pConf->Downsize.HSize      = hroi->OutputWidth;
+  pConf->Downsize.VSize      = hroi->OutputHeight;
+  pConf->Downsize.HDivFactor = ((1024U * PIPE_ROI_RATIO_ONE) - 1U) / hratio;
+  pConf->Downsize.VDivFactor = ((1024U * PIPE_ROI_RATIO_ONE) - 1U) / vratio;
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Request a new region of interest, applied at the next frame boundary
+  * @param  hroi    ROI handle
+  * @param  X       Window left column in the input frame
+  * @param  Y       Window top line in the input frame
+  * @param  Width   Window width
+  * @param  Height  Window height
+  * @retval HAL status
+  */
+HAL_StatusTypeDef PipeRoi_SetWindow(PipeRoi_HandleTypeDef *hroi, uint32_t X, uint32_t Y,
+                                    uint32_t Width, uint32_t Height)
+{
+  PipeRoi_ConfTypeDef conf;
+  uint32_t primask;
+
+  if (PipeRoi_ComputeConfig(hroi, X, Y, Width, Height, &conf) != HAL_OK)
+  {
+    return HAL_ERROR;
+  }
+
+  primask = __get_PRIMASK();
+  __disable_irq();
+  hroi->Next = conf;
+  hroi->UpdatePending = 1;
+  __set_PRIMASK(primask);
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Request a pan/zoom position, applied at the next frame boundary
+  * @note   The window keeps the input frame aspect ratio, is clamped to the
+  *         output size (largest zoom) and kept inside the input frame.
+  * @param  hroi     ROI handle
+  * @param  CenterX  Window center column in the input frame
+  * @param  CenterY  Window center line in the input frame
+  * @param  Zoom     Zoom factor, PIPE_ROI_ZOOM_1X for the whole frame
+  * @retval HAL status
+  */
+HAL_StatusTypeDef PipeRoi_SetPanZoom(PipeRoi_HandleTypeDef *hroi, uint32_t CenterX, uint32_t CenterY,
+                                     uint32_t Zoom)
+{
+  uint32_t width;
+  uint32_t height;
+  uint32_t x;
+  uint32_t y;
+
+  if (Zoom < PIPE_ROI_ZOOM_1X)
+  {
+    Zoom = PIPE_ROI_ZOOM_1X;
+  }
+
+  width  = (hroi->InputWidth * PIPE_ROI_ZOOM_1X) / Zoom;
+  height = (hroi->InputHeight * PIPE_ROI_ZOOM_1X) / Zoom;
+  width  = (width < hroi->OutputWidth) ? hroi->OutputWidth : width;
+  height = (height < hroi->OutputHeight) ? hroi->OutputHeight : height;
+
+  x = (CenterX > (width / 2U)) ? (CenterX - (width / 2U)) : 0U;
+  y = (CenterY > (height / 2U)) ? (CenterY - (height / 2U)) : 0U;
+  x = ((x + width) > hroi->InputWidth) ? (hroi->InputWidth - width) : x;
+  y = ((y + height) > hroi->InputHeight) ? (hroi->InputHeight - height) : y;
+
+  return PipeRoi_SetWindow(hroi, x, y, width, height);
+}
+
+/**
+  * @brief  To be called from HAL_DCMIPP_PIPE_VsyncEventCallback() for the ROI pipe
+  * @param  hroi  ROI handle
+  * @retval None
+  */
+void PipeRoi_VsyncEventHandler(PipeRoi_HandleTypeDef *hroi)
+{
+  if (hroi->UpdatePending == 0U)
+  {
+    return;
+  }
+
+  if (PipeRoi_Apply(hroi, &hroi->Next) == HAL_OK)
+  {
+    hroi->Current = hroi->Next;
+  }
+  hroi->UpdatePending = 0;
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  Program the crop and downsize stages of the pipe
+  * @retval HAL status
+  */
+static HAL_StatusTypeDef PipeRoi_Apply(PipeRoi_HandleTypeDef *hroi, const PipeRoi_ConfTypeDef *pConf)
+{
+  if (HAL_DCMIPP_PIPE_SetCropConfig(hroi->hdcmipp, hroi->Pipe, &pConf->Crop) != HAL_OK)
+  {
+    return HAL_ERROR;
+  }
+
+  return HAL_DCMIPP_PIPE_SetDownsizeConfig(hroi->hdcmipp, hroi->Pipe, &pConf->Downsize);
+}
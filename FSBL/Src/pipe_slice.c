@@ -0,0 +1,299 @@
+/**
+  ******************************************************************************
+  * @file    pipe_slice.c
+  * @brief   Delivery of N-line bands of a DCMIPP pixel pipe.
+  *
+  *          The pipe line event is raised each time LinesPerBand lines have
+  *          been written to memory. Each event publishes a band in a queue
+  *          that the consumer drains with PipeSlice_GetBand() and
+  *          PipeSlice_ReleaseBand(), so processing can start long before the
+  *          frame event.
+  *
+  *          - Frame mode: the pipe writes whole frames in a frame buffer ring
+  *            and the bands point into the buffer being captured.
+  *          - Wrap mode: the pipe writes into a line buffer of WrapLines
+  *            lines and wraps back to its start, so no frame buffer is
+  *            needed. A band must be released before the pipe wraps back
+  *            onto it, otherwise it is counted as an overrun.
+  *
+  *          The last band of a frame, when the frame height is not a
+  *          multiple of LinesPerBand, is published by the frame event.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "pipe_slice.h"
+
+/* Private define ------------------------------------------------------------*/
+/* Largest line event period and line buffer supported by the pipe */
+#define PIPE_SLICE_MAX_LINES   128U
+
+/* Private function prototypes -----------------------------------------------*/
+static HAL_StatusTypeDef PipeSlice_LinesToCode(uint32_t Lines, uint32_t *pCode);
+static void PipeSlice_Publish(PipeSlice_HandleTypeDef *hslice, uint32_t NbLines);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Initialize band delivery on a pipe writing into a frame buffer ring
+  * @param  hslice        Slice handle
+  * @param  hring         Ring filled by the pipe, already initialized
+  * @param  Pitch         Bytes per line
+  * @param  Height        Lines per frame
+  * @param  LinesPerBand  Band height, power of 2 from 1 to 128
+  * @retval HAL status
+  */
+HAL_StatusTypeDef PipeSlice_Init(PipeSlice_HandleTypeDef *hslice, FrameRing_HandleTypeDef *hring,
+                                 uint32_t Pitch, uint32_t Height, uint32_t LinesPerBand)
+{
+  uint32_t code;
+
+  if ((hslice == NULL) || (hring == NULL) || (PipeSlice_LinesToCode(LinesPerBand, &code) != HAL_OK))
+  {
+    return HAL_ERROR;
+  }
+
+  hslice->hdcmipp      = hring->hdcmipp;
+  hslice->Pipe         = hring->Pipe;
+  hslice->Pitch        = Pitch;
+  hslice->Height       = Height;
+  hslice->LinesPerBand = LinesPerBand;
+  hslice->WrapAddress  = 0;
+  hslice->WrapBands    = 0;
+  hslice->hring        = hring;
+  hslice->Depth        = PIPE_SLICE_MAX_BANDS;
+  hslice->Head         = 0;
+  hslice->Tail         = 0;
+  hslice->Line         = 0;
+  hslice->FrameId      = 0;
+  hslice->OverrunCount = 0;
+
+  return HAL_DCMIPP_PIPE_EnableLineEvent(hslice->hdcmipp, hslice->Pipe,
+                                         code << DCMIPP_P1PPCR_LINEMULT_Pos);
+}
+
+/**
+  * @brief  Initialize band delivery on a pipe writing into a wrapping line buffer
+  * @note   The pipe output configuration must be set beforehand. The capture
+  *         is started with PipeSlice_Start().
+  * @param  hslice        Slice handle
+  * @param  hdcmipp       DCMIPP handle
+  * @param  Pipe          DCMIPP_PIPE1 or DCMIPP_PIPE2
+  * @param  Pitch         Bytes per line
+  * @param  Height        Lines per frame
+  * @param  LinesPerBand  Band height, power of 2 from 1 to 128
+  * @param  WrapAddress   Line buffer start address, 16 bytes aligned
+  * @param  WrapLines     Line buffer height, power of 2 up to 128, at least
+  *                       twice LinesPerBand
+  * @retval HAL status
+  */
+HAL_StatusTypeDef PipeSlice_InitWrap(PipeSlice_HandleTypeDef *hslice, DCMIPP_HandleTypeDef *hdcmipp,
+                                     uint32_t Pipe, uint32_t Pitch, uint32_t Height,
+                                     uint32_t LinesPerBand, uint32_t WrapAddress, uint32_t WrapLines)
+{
+  uint32_t line_code;
+  uint32_t wrap_code;
+
+  if ((hslice == NULL) || (hdcmipp == NULL) || ((Pipe != DCMIPP_PIPE1) && (Pipe != DCMIPP_PIPE2)) ||
+      (PipeSlice_LinesToCode(LinesPerBand, &line_code) != HAL_OK) ||
+      (PipeSlice_LinesToCode(WrapLines, &wrap_code) != HAL_OK) ||
+      (WrapLines < (2U * LinesPerBand)) || ((WrapAddress & 0xFU) != 0U))
+  {
+    return HAL_ERROR;
+  }
+
+  hslice->hdcmipp      = hdcmipp;
+  hslice->Pipe         = Pipe;
+  hslice->Pitch        = Pitch;
+  hslice->Height       = Height;
+  hslice->LinesPerBand = LinesPerBand;
+  hslice->WrapAddress  = WrapAddress;
+  hslice->WrapBands    = WrapLines / LinesPerBand;
+  hslice->hring        = NULL;
+  /* The pipe is already writing the band following the newest one */
+  hslice->Depth        = hslice->WrapBands - 1U;
+  hslice->Head         = 0;
+  hslice->Tail         = 0;
+  hslice->Line         = 0;
+  hslice->FrameId      = 0;
+  hslice->OverrunCount = 0;
+
+  if (hslice->Depth > PIPE_SLICE_MAX_BANDS)
+  {
+    hslice->Depth = PIPE_SLICE_MAX_BANDS;
+  }
+
+  if (HAL_DCMIPP_PIPE_SetLineWrappingConfig(hdcmipp, Pipe, wrap_code << DCMIPP_P1PPCR_LMAWM_Pos) != HAL_OK)
+  {
+    return HAL_ERROR;
+  }
+  if (HAL_DCMIPP_PIPE_EnableLineWrapping(hdcmipp, Pipe) != HAL_OK)
+  {
+    return HAL_ERROR;
+  }
+
+  return HAL_DCMIPP_PIPE_EnableLineEvent(hdcmipp, Pipe, line_code << DCMIPP_P1PPCR_LINEMULT_Pos);
+}
+
+/**
+  * @brief  Start the capture into the line buffer (wrap mode only)
+  * @param  hslice          Slice handle
+  * @param  VirtualChannel  CSI virtual channel feeding the pipe
+  * @retval HAL status
+  */
+HAL_StatusTypeDef PipeSlice_Start(PipeSlice_HandleTypeDef *hslice, uint32_t VirtualChannel)
+{
+  if (hslice->WrapBands == 0U)
+  {
+    return HAL_ERROR;
+  }
+
+  return HAL_DCMIPP_CSI_PIPE_Start(hslice->hdcmipp, hslice->Pipe, VirtualChannel, hslice->WrapAddress,
+                                   DCMIPP_MODE_CONTINUOUS);
+}
+
+/**
+  * @brief  Get the oldest band not yet released
+  * @note   D-Cache maintenance of the band lines is left to the caller.
+  * @param  hslice  Slice handle
+  * @param  pBand   Band description
+  * @retval HAL_OK if a band is available, HAL_BUSY otherwise
+  */
+HAL_StatusTypeDef PipeSlice_GetBand(PipeSlice_HandleTypeDef *hslice, PipeSlice_BandTypeDef *pBand)
+{
+  HAL_StatusTypeDef status = HAL_BUSY;
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+  if (hslice->Head != hslice->Tail)
+  {
+    *pBand = hslice->Band[hslice->Tail % PIPE_SLICE_MAX_BANDS];
+    status = HAL_OK;
+  }
+  __set_PRIMASK(primask);
+
+  return status;
+}
+
+/**
+  * @brief  Release a band returned by PipeSlice_GetBand()
+  * @param  hslice  Slice handle
+  * @param  pBand   Band to release
+  * @retval HAL_OK, HAL_ERROR if the band was overwritten in the meantime
+  */
+HAL_StatusTypeDef PipeSlice_ReleaseBand(PipeSlice_HandleTypeDef *hslice, const PipeSlice_BandTypeDef *pBand)
+{
+  HAL_StatusTypeDef status = HAL_ERROR;
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+  if ((hslice->Head != hslice->Tail) && (pBand->Seq == hslice->Tail))
+  {
+    hslice->Tail++;
+    status = HAL_OK;
+  }
+  __set_PRIMASK(primask);
+
+  return status;
+}
+
+/**
+  * @brief  To be called from HAL_DCMIPP_PIPE_LineEventCallback() for the slice pipe
+  * @param  hslice  Slice handle
+  * @retval None
+  */
+void PipeSlice_LineEventHandler(PipeSlice_HandleTypeDef *hslice)
+{
+  if ((hslice->Line + hslice->LinesPerBand) <= hslice->Height)
+  {
+    PipeSlice_Publish(hslice, hslice->LinesPerBand);
+  }
+}
+
+/**
+  * @brief  To be called from HAL_DCMIPP_PIPE_FrameEventCallback() for the slice
+  *         pipe, before the frame buffer ring handler
+  * @param  hslice  Slice handle
+  * @retval None
+  */
+void PipeSlice_FrameEventHandler(PipeSlice_HandleTypeDef *hslice)
+{
+  if (hslice->Line < hslice->Height)
+  {
+    PipeSlice_Publish(hslice, hslice->Height - hslice->Line);
+  }
+
+  hslice->Line = 0;
+  hslice->FrameId++;
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  Convert a number of lines into the pipe log2 encoding
+  * @retval HAL_ERROR if Lines is not a power of 2 up to PIPE_SLICE_MAX_LINES
+  */
+static HAL_StatusTypeDef PipeSlice_LinesToCode(uint32_t Lines, uint32_t *pCode)
+{
+  uint32_t code = 0;
+
+  if ((Lines == 0U) || (Lines > PIPE_SLICE_MAX_LINES) || ((Lines & (Lines - 1U)) != 0U))
+  {
+    return HAL_ERROR;
+  }
+
+  while ((1UL << code) != Lines)
+  {
+    code++;
+  }
+  *pCode = code;
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Queue the band following the lines already published
+  * @retval None
+  */
+static void PipeSlice_Publish(PipeSlice_HandleTypeDef *hslice, uint32_t NbLines)
+{
+  PipeSlice_BandTypeDef *band;
+  uint32_t base;
+  uint32_t offset;
+
+  if (hslice->WrapBands != 0U)
+  {
+    base   = hslice->WrapAddress;
+    offset = ((hslice->Line / hslice->LinesPerBand) % hslice->WrapBands) * hslice->LinesPerBand;
+  }
+  else
+  {
+    base   = hslice->hring->Buffer[hslice->hring->Slot[hslice->hring->ActiveSlot]].Address;
+    offset = hslice->Line;
+  }
+
+  /* Queue full: the oldest band is overwritten */
+  if ((hslice->Head - hslice->Tail) >= hslice->Depth)
+  {
+    hslice->OverrunCount++;
+    hslice->Tail++;
+  }
+
+  band = &hslice->Band[hslice->Head % PIPE_SLICE_MAX_BANDS];
+  band->Address   = base + (offset * hslice->Pitch);
+  band->FirstLine = hslice->Line;
+  band->NbLines   = NbLines;
+  band->FrameId   = hslice->FrameId;
+  band->Seq       = hslice->Head;
+
+  hslice->Line += NbLines;
+  hslice->Head++;
+}
@@ -0,0 +1,539 @@
+/**
+  ******************************************************************************
+  * @file    sd_recorder.c
+  * @brief   Frame recorder on the SD card.
+  *
+  *          The frames are written as raw blocks in an extent of the card
+  *          reserved for the recording and erased when it starts, so that
+  *          the card does not erase while it is being written. There is no
+  *          file system: the extent starts with a container header and a
+  *          frame index, see sd_recorder.h.
+  *
+  *          A frame is copied by the CPU into a ring of staging buffers and
+  *          each full buffer is written by one multi-block DMA command. With
+  *          two buffers or more, the next buffer is filled while the card
+  *          writes the previous one, and the card only waits for the CPU when
+  *          no frame is given. A frame starts in a new buffer: its last one is
+  *          padded to a block and written without waiting for the next frame.
+  *
+  *          Only one write command is issued at a time. The write complete
+  *          callback ends the transfer and the card is then polled out of
+  *          programming in SDRec_Process(), before the next command.
+  *
+  *          The longest write command and the longest wait of a full buffer
+  *          are measured with the DWT cycle counter, which must be running.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sd_recorder.h"
+#include "stm32n6570_discovery_sd.h"
+#include <string.h>
+
+/* Private constants ---------------------------------------------------------*/
+#define SD_REC_WRITE_TIMEOUT        1000U     /* ms, one command and its programming */
+#define SD_REC_ERASE_TIMEOUT        60000U    /* ms, whole extent                    */
+
+/* Private function prototypes -----------------------------------------------*/
+static void SDRec_PollCard(SDRec_HandleTypeDef *hrec);
+static void SDRec_Fill(SDRec_HandleTypeDef *hrec);
+static void SDRec_Queue(SDRec_HandleTypeDef *hrec);
+static void SDRec_Kick(SDRec_HandleTypeDef *hrec);
+static void SDRec_StartWrite(SDRec_HandleTypeDef *hrec, uint32_t Address, uint32_t Block, uint32_t NbBlocks);
+static HAL_StatusTypeDef SDRec_WriteBlock(SDRec_HandleTypeDef *hrec, uint32_t Block, const void *pData,
+                                          uint32_t Size);
+static HAL_StatusTypeDef SDRec_WaitCard(const SDRec_HandleTypeDef *hrec, uint32_t Timeout);
+static uint8_t *SDRec_Staging(const SDRec_HandleTypeDef *hrec, uint32_t Buffer);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Initialize the recorder
+  * @note   The card must have been initialized with BSP_SD_Init().
+  * @param  hrec   Recorder handle
+  * @param  pConf  Extent and staging buffers
+  * @retval HAL status
+  */
+HAL_StatusTypeDef SDRec_Init(SDRec_HandleTypeDef *hrec, const SDRec_ConfTypeDef *pConf)
+{
+  uint32_t indexBlocks;
+
+  if ((hrec == NULL) || (pConf == NULL) || (pConf->Instance >= SD_INSTANCES_NBR) || (pConf->MaxFrames == 0U) ||
+      (pConf->NbStaging < 2U) || (pConf->NbStaging > SD_REC_MAX_STAGING) || (pConf->StagingSize == 0U) ||
+      ((pConf->StagingSize % SD_REC_BLOCK_SIZE) != 0U) || ((pConf->StagingAddress % 32U) != 0U))
+  {
+    return HAL_ERROR;
+  }
+
+  indexBlocks = (pConf->MaxFrames + SD_REC_INDEX_PER_BLOCK - 1U) / SD_REC_INDEX_PER_BLOCK;
+  if (pConf->NbBlocks <= (1U + indexBlocks))
+  {
+    return HAL_ERROR;
+  }
+
+  memset(hrec, 0, sizeof(*hrec));
+  hrec->Conf = *pConf;
+  hrec->Header.Magic       = SD_REC_MAGIC;
+  hrec->Header.Version     = SD_REC_VERSION;
+  hrec->Header.IndexBlocks = indexBlocks;
+  hrec->Header.DataBlock   = 1U + indexBlocks;
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Erase the extent and start a recording
+  * @note   Blocking: the erase of a large extent takes seconds on some cards.
+  * @param  hrec    Recorder handle
+  * @param  Format  SD_REC_FORMAT_xxx, for the reader
+  * @param  Width   Frame width, for the reader
+  * @param  Height  Frame height, for the reader
+  * @retval HAL status
+  */
+HAL_StatusTypeDef SDRec_Start(SDRec_HandleTypeDef *hrec, uint32_t Format, uint32_t Width, uint32_t Height)
+{
+  const SDRec_ConfTypeDef *conf = &hrec->Conf;
+
+  if (hrec->State != 0U)
+  {
+    return HAL_ERROR;
+  }
+
+  /* BSP_SD_Erase() erases up to BlockIdx + NbrOfBlocks included */
+  if ((SDRec_WaitCard(hrec, SD_REC_WRITE_TIMEOUT) != HAL_OK) ||
+      (BSP_SD_Erase(conf->Instance, conf->StartBlock, conf->NbBlocks - 1U) != BSP_ERROR_NONE) ||
+      (SDRec_WaitCard(hrec, SD_REC_ERASE_TIMEOUT) != HAL_OK))
+  {
+    return HAL_ERROR;
+  }
+
+  hrec->Header.Format     = Format;
+  hrec->Header.Width      = Width;
+  hrec->Header.Height     = Height;
+  hrec->Header.NbFrames   = SD_REC_NB_FRAMES_OPEN;
+  hrec->Header.DataBlocks = 0;
+  hrec->Error = 0;
+  if (SDRec_WriteBlock(hrec, conf->StartBlock, &hrec->Header, sizeof(hrec->Header)) != HAL_OK)
+  {
+    return HAL_ERROR;
+  }
+
+  hrec->Head = 0;
+  hrec->Tail = 0;
+  hrec->FillOffset = 0;
+  hrec->NextBlock = conf->StartBlock + hrec->Header.DataBlock;
+  hrec->pFrame = NULL;
+  hrec->IndexPendingBlock = 0;
+  hrec->FrameCount = 0;
+  hrec->DropCount = 0;
+  hrec->BytesWritten = 0;
+  hrec->DataWriteCycles = 0;
+  hrec->WorstWriteCycles = 0;
+  hrec->WorstStallCycles = 0;
+  memset(hrec->Index, 0, sizeof(hrec->Index));
+  hrec->State = 1;
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Write the pending frame and the index, then close the container
+  * @note   Blocking, the frame being copied is completed.
+  * @param  hrec  Recorder handle
+  * @retval HAL_ERROR if the card failed, the index then ends the recording
+  */
+HAL_StatusTypeDef SDRec_Stop(SDRec_HandleTypeDef *hrec)
+{
+  const SDRec_ConfTypeDef *conf = &hrec->Conf;
+  uint32_t tickstart = HAL_GetTick();
+  uint32_t tail = hrec->Tail;
+
+  if (hrec->State == 0U)
+  {
+    return HAL_ERROR;
+  }
+
+  while ((hrec->Error == 0U) &&
+         ((hrec->pFrame != NULL) || (hrec->Head != hrec->Tail) || (hrec->Writing != 0U) ||
+          (hrec->IndexPendingBlock != 0U)))
+  {
+    SDRec_Process(hrec);
+    if (hrec->Tail != tail)
+    {
+      tail = hrec->Tail;
+      tickstart = HAL_GetTick();
+    }
+    else if ((HAL_GetTick() - tickstart) > SD_REC_WRITE_TIMEOUT)
+    {
+      hrec->Error = 1;
+    }
+    else
+    {
+      /* Write in progress */
+    }
+  }
+  hrec->State = 0;
+  hrec->pFrame = NULL;
+  if (hrec->Error != 0U)
+  {
+    return HAL_ERROR;
+  }
+
+  /* Last index block, partly filled */
+  if (((hrec->FrameCount % SD_REC_INDEX_PER_BLOCK) != 0U) &&
+      (SDRec_WriteBlock(hrec, conf->StartBlock + 1U + (hrec->FrameCount / SD_REC_INDEX_PER_BLOCK), hrec->Index,
+                        sizeof(hrec->Index)) != HAL_OK))
+  {
+    return HAL_ERROR;
+  }
+
+  hrec->Header.NbFrames   = hrec->FrameCount;
+  hrec->Header.DataBlocks = hrec->NextBlock - conf->StartBlock - hrec->Header.DataBlock;
+
+  return SDRec_WriteBlock(hrec, conf->StartBlock, &hrec->Header, sizeof(hrec->Header));
+}
+
+/**
+  * @brief  Submit a frame
+  * @note   The frame is read by the CPU from SDRec_Process(): it must be
+  *         coherent for the CPU and kept until SDRec_IsReady() returns 1.
+  * @param  hrec     Recorder handle
+  * @param  Address  Frame address
+  * @param  Size     Frame size in bytes
+  * @param  FrameId  Capture frame number, stored in the index
+  * @retval HAL_BUSY if the previous frame is still being copied, HAL_ERROR if
+  *         the recording is stopped or full; the frame is dropped
+  */
+HAL_StatusTypeDef SDRec_WriteFrame(SDRec_HandleTypeDef *hrec, uint32_t Address, uint32_t Size, uint32_t FrameId)
+{
+  const SDRec_ConfTypeDef *conf = &hrec->Conf;
+  uint32_t blocks = (Size + SD_REC_BLOCK_SIZE - 1U) / SD_REC_BLOCK_SIZE;
+
+  if ((hrec->State == 0U) || (hrec->Error != 0U) || (Size == 0U))
+  {
+    return HAL_ERROR;
+  }
+
+  /* The index block this frame completes must have a free pending slot */
+  if ((hrec->pFrame != NULL) ||
+      (((hrec->FrameCount % SD_REC_INDEX_PER_BLOCK) == (SD_REC_INDEX_PER_BLOCK - 1U)) &&
+       (hrec->IndexPendingBlock != 0U)))
+  {
+    hrec->DropCount++;
+    return HAL_BUSY;
+  }
+
+  if ((hrec->FrameCount >= conf->MaxFrames) ||
+      (blocks > ((conf->StartBlock + conf->NbBlocks) - hrec->NextBlock)))
+  {
+    hrec->DropCount++;
+    return HAL_ERROR;
+  }
+
+  hrec->Entry.Block     = hrec->NextBlock - conf->StartBlock;
+  hrec->Entry.Size      = Size;
+  hrec->Entry.FrameId   = FrameId;
+  hrec->Entry.Timestamp = HAL_GetTick();
+  hrec->FrameSize   = Size;
+  hrec->FrameCopied = 0;
+  hrec->pFrame      = (const uint8_t *)Address;
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Whether the recorder can take a new frame
+  * @param  hrec  Recorder handle
+  * @retval 1 when the previous frame has been copied and may be released
+  */
+uint8_t SDRec_IsReady(const SDRec_HandleTypeDef *hrec)
+{
+  return (hrec->pFrame == NULL) ? 1U : 0U;
+}
+
+/**
+  * @brief  Recorder background: card polling, staging copy and next write
+  * @note   To be called from the main loop; each call copies the frame into
+  *         all the free staging buffers.
+  * @param  hrec  Recorder handle
+  * @retval None
+  */
+void SDRec_Process(SDRec_HandleTypeDef *hrec)
+{
+  if (hrec->State == 0U)
+  {
+    return;
+  }
+
+  SDRec_PollCard(hrec);
+  if (hrec->Error != 0U)
+  {
+    /* Aborted recording: the frame is given back */
+    hrec->pFrame = NULL;
+    return;
+  }
+  SDRec_Fill(hrec);
+  SDRec_Kick(hrec);
+}
+
+/**
+  * @brief  Recorder statistics
+  * @param  hrec    Recorder handle
+  * @param  pStats  Statistics (output parameter)
+  * @retval None
+  */
+void SDRec_GetStats(const SDRec_HandleTypeDef *hrec, SDRec_StatsTypeDef *pStats)
+{
+  uint32_t cyclesPerUs = SystemCoreClock / 1000000U;
+
+  pStats->FrameCount   = hrec->FrameCount;
+  pStats->DropCount    = hrec->DropCount;
+  pStats->KBytesPerSec = (hrec->DataWriteCycles == 0U) ? 0U :
+                         (uint32_t)((hrec->BytesWritten * SystemCoreClock) / (1024U * hrec->DataWriteCycles));
+  pStats->WorstWriteUs = hrec->WorstWriteCycles / cyclesPerUs;
+  pStats->WorstStallUs = hrec->WorstStallCycles / cyclesPerUs;
+}
+
+/**
+  * @brief  Write command completed, to be called from BSP_SD_WriteCpltCallback()
+  * @param  hrec  Recorder handle
+  * @retval None
+  */
+void SDRec_WriteCpltHandler(SDRec_HandleTypeDef *hrec)
+{
+  hrec->DmaBusy = 0;
+}
+
+/**
+  * @brief  Card error, to be called from the SD error and abort callbacks
+  * @param  hrec  Recorder handle
+  * @retval None
+  */
+void SDRec_ErrorHandler(SDRec_HandleTypeDef *hrec)
+{
+  hrec->Error = 1;
+  hrec->DmaBusy = 0;
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  End the write in progress once the card has programmed the data
+  * @retval None
+  */
+static void SDRec_PollCard(SDRec_HandleTypeDef *hrec)
+{
+  uint32_t cycles;
+
+  if ((hrec->Writing == 0U) || (hrec->DmaBusy != 0U) ||
+      (BSP_SD_GetCardState(hrec->Conf.Instance) != (int32_t)SD_TRANSFER_OK))
+  {
+    return;
+  }
+
+  cycles = DWT->CYCCNT - hrec->WriteCycles;
+  if (cycles > hrec->WorstWriteCycles)
+  {
+    hrec->WorstWriteCycles = cycles;
+  }
+
+  if (hrec->WritingIndex != 0U)
+  {
+    hrec->IndexPendingBlock = 0;
+  }
+  else
+  {
+    hrec->BytesWritten += (uint64_t)hrec->Blocks[hrec->Tail % hrec->Conf.NbStaging] * SD_REC_BLOCK_SIZE;
+    hrec->DataWriteCycles += cycles;
+    hrec->Tail++;
+  }
+  hrec->Writing = 0;
+}
+
+/**
+  * @brief  Copy the frame into the free staging buffers
+  * @retval None
+  */
+static void SDRec_Fill(SDRec_HandleTypeDef *hrec)
+{
+  uint32_t chunk;
+  uint32_t pad;
+  uint8_t *buffer;
+
+  while ((hrec->pFrame != NULL) && ((hrec->Head - hrec->Tail) < hrec->Conf.NbStaging))
+  {
+    buffer = SDRec_Staging(hrec, hrec->Head);
+    chunk = hrec->FrameSize - hrec->FrameCopied;
+    if (chunk > (hrec->Conf.StagingSize - hrec->FillOffset))
+    {
+      chunk = hrec->Conf.StagingSize - hrec->FillOffset;
+    }
+    memcpy(&buffer[hrec->FillOffset], &hrec->pFrame[hrec->FrameCopied], chunk);
+    hrec->FillOffset  += chunk;
+    hrec->FrameCopied += chunk;
+
+    if (hrec->FrameCopied == hrec->FrameSize)
+    {
+      /* Frame end: the last block is padded and written right away */
+      pad = (SD_REC_BLOCK_SIZE - (hrec->FillOffset % SD_REC_BLOCK_SIZE)) % SD_REC_BLOCK_SIZE;
+      memset(&buffer[hrec->FillOffset], 0, pad);
+      hrec->FillOffset += pad;
+      SDRec_Queue(hrec);
+
+      hrec->Index[hrec->FrameCount % SD_REC_INDEX_PER_BLOCK] = hrec->Entry;
+      hrec->FrameCount++;
+      if ((hrec->FrameCount % SD_REC_INDEX_PER_BLOCK) == 0U)
+      {
+        memcpy(hrec->IndexPending, hrec->Index, sizeof(hrec->IndexPending));
+        memset(hrec->Index, 0, sizeof(hrec->Index));
+        hrec->IndexPendingBlock = hrec->Conf.StartBlock + (hrec->FrameCount / SD_REC_INDEX_PER_BLOCK);
+      }
+      hrec->pFrame = NULL;
+    }
+    else if (hrec->FillOffset == hrec->Conf.StagingSize)
+    {
+      SDRec_Queue(hrec);
+    }
+    else
+    {
+      /* Not reached: the copy stops at the frame end or at the buffer end */
+    }
+  }
+}
+
+/**
+  * @brief  Hand the staging buffer at Head to the card writes
+  * @retval None
+  */
+static void SDRec_Queue(SDRec_HandleTypeDef *hrec)
+{
+  uint32_t i = hrec->Head % hrec->Conf.NbStaging;
+
+  SCB_CleanDCache_by_Addr((uint32_t *)SDRec_Staging(hrec, hrec->Head), (int32_t)hrec->FillOffset);
+  hrec->Block[i] = hrec->NextBlock;
+  hrec->Blocks[i] = hrec->FillOffset / SD_REC_BLOCK_SIZE;
+  hrec->ReadyCycles[i] = DWT->CYCCNT;
+  hrec->NextBlock += hrec->Blocks[i];
+  hrec->FillOffset = 0;
+  hrec->Head++;
+}
+
+/**
+  * @brief  Start the next write command when the card is free
+  * @note   A full index block goes first, it is a single block.
+  * @retval None
+  */
+static void SDRec_Kick(SDRec_HandleTypeDef *hrec)
+{
+  uint32_t i = hrec->Tail % hrec->Conf.NbStaging;
+  uint32_t cycles;
+
+  if (hrec->Writing != 0U)
+  {
+    return;
+  }
+
+  if (hrec->IndexPendingBlock != 0U)
+  {
+    SCB_CleanDCache_by_Addr((uint32_t *)hrec->IndexPending, (int32_t)sizeof(hrec->IndexPending));
+    hrec->WritingIndex = 1;
+    SDRec_StartWrite(hrec, (uint32_t)hrec->IndexPending, hrec->IndexPendingBlock, 1U);
+  }
+  else if (hrec->Head != hrec->Tail)
+  {
+    cycles = DWT->CYCCNT - hrec->ReadyCycles[i];
+    if (cycles > hrec->WorstStallCycles)
+    {
+      hrec->WorstStallCycles = cycles;
+    }
+    hrec->WritingIndex = 0;
+    SDRec_StartWrite(hrec, (uint32_t)SDRec_Staging(hrec, hrec->Tail), hrec->Block[i], hrec->Blocks[i]);
+  }
+  else
+  {
+    /* Nothing to write */
+  }
+}
+
+/**
+  * @brief  Issue a multi-block DMA write command
+  * @retval None
+  */
+static void SDRec_StartWrite(SDRec_HandleTypeDef *hrec, uint32_t Address, uint32_t Block, uint32_t NbBlocks)
+{
+  hrec->DmaBusy = 1;
+  hrec->Writing = 1;
+  hrec->WriteCycles = DWT->CYCCNT;
+  if (BSP_SD_WriteBlocks_DMA(hrec->Conf.Instance, (uint32_t *)Address, Block, NbBlocks) != BSP_ERROR_NONE)
+  {
+    hrec->DmaBusy = 0;
+    hrec->Writing = 0;
+    hrec->Error = 1;
+  }
+}
+
+/**
+  * @brief  Write one block through the first staging buffer and wait for it
+  * @note   Only while no frame write is queued.
+  * @retval HAL status
+  */
+static HAL_StatusTypeDef SDRec_WriteBlock(SDRec_HandleTypeDef *hrec, uint32_t Block, const void *pData,
+                                          uint32_t Size)
+{
+  uint8_t *buffer = SDRec_Staging(hrec, 0);
+  uint32_t tickstart;
+
+  memset(buffer, 0, SD_REC_BLOCK_SIZE);
+  memcpy(buffer, pData, Size);
+  SCB_CleanDCache_by_Addr((uint32_t *)buffer, (int32_t)SD_REC_BLOCK_SIZE);
+
+  SDRec_StartWrite(hrec, (uint32_t)buffer, Block, 1U);
+  tickstart = HAL_GetTick();
+  while ((hrec->DmaBusy != 0U) && ((HAL_GetTick() - tickstart) < SD_REC_WRITE_TIMEOUT))
+  {
+  }
+  hrec->Writing = 0;
+  if ((hrec->DmaBusy != 0U) || (hrec->Error != 0U))
+  {
+    return HAL_ERROR;
+  }
+
+  return SDRec_WaitCard(hrec, SD_REC_WRITE_TIMEOUT);
+}
+
+/**
+  * @brief  Wait for the card to be ready for a new command
+  * @retval HAL status
+  */
+static HAL_StatusTypeDef SDRec_WaitCard(const SDRec_HandleTypeDef *hrec, uint32_t Timeout)
+{
+  uint32_t tickstart = HAL_GetTick();
+
+  while (BSP_SD_GetCardState(hrec->Conf.Instance) != (int32_t)SD_TRANSFER_OK)
+  {
+    if ((HAL_GetTick() - tickstart) > Timeout)
+    {
+      return HAL_TIMEOUT;
+    }
+  }
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Address of a staging buffer
+  * @param  Buffer  Buffer count, taken modulo the number of buffers
+  * @retval Buffer address
+  */
+static uint8_t *SDRec_Staging(const SDRec_HandleTypeDef *hrec, uint32_t Buffer)
+{
+  return (uint8_t *)(hrec->Conf.StagingAddress + ((Buffer % hrec->Conf.NbStaging) * hrec->Conf.StagingSize));
+}
@@ -0,0 +1,240 @@
+/**
+  ******************************************************************************
+  * @file    sensor_queue.c
+  * @brief   Asynchronous sensor control.
+  *
+  *          The background (AEC, frame rate, ...) queues register writes
+  *          instead of running polled I2C transfers. The writes queued
+  *          between SensorQueue_BeginGroup() and SensorQueue_EndGroup()
+  *          form one group; a later write to the same register replaces
+  *          the queued one.
+  *
+  *          At the next start of frame the group is sent by interrupt
+  *          driven I2C transfers, one per register burst, chained from the
+  *          transfer complete interrupt. It is wrapped in the sensor group
+  *          hold so all its registers are latched on the same frame: an
+  *          exposure and a gain update never tear across two frames, and
+  *          the background never waits on the bus.
+  *
+  *          A group still open, or a bus still busy with the previous
+  *          group, defers the group to the following start of frame.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sensor_queue.h"
+#include <string.h>
+
+/* Private function prototypes -----------------------------------------------*/
+static void SensorQueue_SetWrite(SensorQueue_WriteTypeDef *pWrite, uint16_t Reg, const uint8_t *pData,
+                                 uint32_t Length);
+static HAL_StatusTypeDef SensorQueue_Send(SensorQueue_HandleTypeDef *hqueue);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Initialize an empty queue
+  * @note   The I2C event and error interrupts must be enabled, their
+  *         callbacks forwarded to SensorQueue_TxCpltHandler() and
+  *         SensorQueue_ErrorHandler().
+  * @param  hqueue  Queue handle
+  * @param  pConf   Bus and group hold configuration
+  * @retval HAL status
+  */
+HAL_StatusTypeDef SensorQueue_Init(SensorQueue_HandleTypeDef *hqueue, const SensorQueue_ConfTypeDef *pConf)
+{
+  if ((hqueue == NULL) || (pConf == NULL) || (pConf->hi2c == NULL))
+  {
+    return HAL_ERROR;
+  }
+
+  memset(hqueue, 0, sizeof(*hqueue));
+  hqueue->Conf = *pConf;
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Queue a register write, sent at a start of frame
+  * @param  hqueue  Queue handle
+  * @param  Reg     First register
+  * @param  pData   Values of Reg and the following registers
+  * @param  Length  Number of registers, up to SENSOR_QUEUE_MAX_LENGTH
+  * @retval HAL_BUSY if the group is full
+  */
+HAL_StatusTypeDef SensorQueue_Write(SensorQueue_HandleTypeDef *hqueue, uint16_t Reg, const uint8_t *pData,
+                                    uint32_t Length)
+{
+  HAL_StatusTypeDef status = HAL_BUSY;
+  SensorQueue_GroupTypeDef *next = &hqueue->Next;
+  uint32_t primask;
+  uint32_t i;
+
+  if ((pData == NULL) || (Length == 0U) || (Length > SENSOR_QUEUE_MAX_LENGTH))
+  {
+    return HAL_ERROR;
+  }
+
+  /* The start of frame handler takes the group when it is not open */
+  primask = __get_PRIMASK();
+  __disable_irq();
+  for (i = 0; i < next->NbWrites; i++)
+  {
+    if ((next->Write[i].Reg == Reg) && (next->Write[i].Length == Length))
+    {
+      /* Latest value wins */
+      SensorQueue_SetWrite(&next->Write[i], Reg, pData, Length);
+      status = HAL_OK;
+      break;
+    }
+  }
+  if ((status != HAL_OK) && (next->NbWrites < SENSOR_QUEUE_MAX_WRITES))
+  {
+    SensorQueue_SetWrite(&next->Write[next->NbWrites], Reg, pData, Length);
+    next->NbWrites++;
+    status = HAL_OK;
+  }
+  __set_PRIMASK(primask);
+
+  return status;
+}
+
+/**
+  * @brief  Open a group: the following writes are sent together
+  * @param  hqueue  Queue handle
+  * @retval None
+  */
+void SensorQueue_BeginGroup(SensorQueue_HandleTypeDef *hqueue)
+{
+  hqueue->Open = 1;
+}
+
+/**
+  * @brief  Close a group, sent at the next start of frame
+  * @param  hqueue  Queue handle
+  * @retval None
+  */
+void SensorQueue_EndGroup(SensorQueue_HandleTypeDef *hqueue)
+{
+  hqueue->Open = 0;
+}
+
+/**
+  * @brief  To be called from the CSI start of frame callback
+  * @param  hqueue  Queue handle
+  * @retval None
+  */
+void SensorQueue_StartOfFrameHandler(SensorQueue_HandleTypeDef *hqueue)
+{
+  SensorQueue_GroupTypeDef *next = &hqueue->Next;
+  SensorQueue_GroupTypeDef *active = &hqueue->Active;
+  uint32_t i;
+
+  if (next->NbWrites == 0U)
+  {
+    return;
+  }
+  if ((hqueue->Busy != 0U) || (hqueue->Open != 0U))
+  {
+    hqueue->DeferCount++;
+    return;
+  }
+
+  /* Hold start, the queued writes, hold end and launch */
+  SensorQueue_SetWrite(&active->Write[0], hqueue->Conf.HoldReg, &hqueue->Conf.HoldStart, 1);
+  for (i = 0; i < next->NbWrites; i++)
+  {
+    active->Write[i + 1U] = next->Write[i];
+  }
+  SensorQueue_SetWrite(&active->Write[i + 1U], hqueue->Conf.HoldReg, &hqueue->Conf.HoldEnd, 1);
+  SensorQueue_SetWrite(&active->Write[i + 2U], hqueue->Conf.HoldReg, &hqueue->Conf.Launch, 1);
+  active->NbWrites = next->NbWrites + 3U;
+
+  hqueue->Step = 0;
+  hqueue->Busy = 1;
+  if (SensorQueue_Send(hqueue) != HAL_OK)
+  {
+    /* Bus used by a polled transfer: keep the group for the next frame */
+    hqueue->Busy = 0;
+    hqueue->DeferCount++;
+    return;
+  }
+  next->NbWrites = 0;
+}
+
+/**
+  * @brief  To be called from HAL_I2C_MemTxCpltCallback() for the queue bus
+  * @param  hqueue  Queue handle
+  * @retval None
+  */
+void SensorQueue_TxCpltHandler(SensorQueue_HandleTypeDef *hqueue)
+{
+  if (hqueue->Busy == 0U)
+  {
+    return;
+  }
+
+  hqueue->Step++;
+  if (hqueue->Step >= hqueue->Active.NbWrites)
+  {
+    hqueue->Busy = 0;
+    hqueue->GroupCount++;
+    return;
+  }
+
+  if (SensorQueue_Send(hqueue) != HAL_OK)
+  {
+    hqueue->Busy = 0;
+    hqueue->ErrorCount++;
+  }
+}
+
+/**
+  * @brief  To be called from HAL_I2C_ErrorCallback() for the queue bus
+  * @note   The rest of the group is dropped, the sensor keeps its previous
+  *         values until the background queues new ones.
+  * @param  hqueue  Queue handle
+  * @retval None
+  */
+void SensorQueue_ErrorHandler(SensorQueue_HandleTypeDef *hqueue)
+{
+  if (hqueue->Busy != 0U)
+  {
+    hqueue->Busy = 0;
+    hqueue->ErrorCount++;
+  }
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  Fill a register write
+  * @retval None
+  */
+static void SensorQueue_SetWrite(SensorQueue_WriteTypeDef *pWrite, uint16_t Reg, const uint8_t *pData,
+                                 uint32_t Length)
+{
+  pWrite->Reg    = Reg;
+  pWrite->Length = (uint16_t)Length;
+  memcpy(pWrite->Data, pData, Length);
+}
+
+/**
+  * @brief  Start the transfer of the current write of the active group
+  * @retval HAL status
+  */
+static HAL_StatusTypeDef SensorQueue_Send(SensorQueue_HandleTypeDef *hqueue)
+{
+  SensorQueue_WriteTypeDef *write = &hqueue->Active.Write[hqueue->Step];
+
+  return HAL_I2C_Mem_Write_IT(hqueue->Conf.hi2c, hqueue->Conf.DevAddr, write->Reg, I2C_MEMADD_SIZE_16BIT,
+                              write->Data, write->Length);
+}
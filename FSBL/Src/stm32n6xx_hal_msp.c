@@ -189,17 +189,25 @@ void HAL_DCMIPP_MspInit(DCMIPP_HandleTypeDef* hdcmipp)
 
     HAL_Delay(200);
 #endif
-    /* SRAM3 and SRAM4 memories clock enable */
+    /* SRAM3 to SRAM6 memories clock enable (capture frame buffers) */
     LL_MEM_EnableClock(LL_MEM_AXISRAM3);
     LL_MEM_EnableClock(LL_MEM_AXISRAM4);
+    LL_MEM_EnableClock(LL_MEM_AXISRAM5);
+    LL_MEM_EnableClock(LL_MEM_AXISRAM6);
 
-    /* Power On AXSRAM3 and AXISRAM4 */
+    /* Power On AXSRAM3 to AXISRAM6 */
     hramcfg.Instance = RAMCFG_SRAM3_AXI;
     HAL_RAMCFG_EnableAXISRAM(&hramcfg);
 
     hramcfg.Instance = RAMCFG_SRAM4_AXI;
     HAL_RAMCFG_EnableAXISRAM(&hramcfg);
 
+    hramcfg.Instance = RAMCFG_SRAM5_AXI;
+    HAL_RAMCFG_EnableAXISRAM(&hramcfg);
+
+    hramcfg.Instance = RAMCFG_SRAM6_AXI;
+    HAL_RAMCFG_EnableAXISRAM(&hramcfg);
+
     __HAL_RCC_RIFSC_CLK_ENABLE();
 
     RIMC_master.MasterCID = RIF_CID_1;
@@ -352,6 +360,127 @@ void HAL_LTDC_MspInit(LTDC_HandleTypeDef *hltdc)
 
     HAL_RIF_RIMC_ConfigMasterAttributes(RIF_MASTER_INDEX_LTDC1 , &RIMC_master);
     HAL_RIF_RISC_SetSlaveSecureAttributes(RIF_RISC_PERIPH_INDEX_LTDCL1 , RIF_ATTRIBUTE_SEC | RIF_ATTRIBUTE_PRIV);
+    HAL_RIF_RISC_SetSlaveSecureAttributes(RIF_RISC_PERIPH_INDEX_LTDCL2 , RIF_ATTRIBUTE_SEC | RIF_ATTRIBUTE_PRIV);
+
+    /* NVIC configuration for LTDC reload interrupt, same priority as DCMIPP */
+    HAL_NVIC_SetPriority(LTDC_LO_IRQn, 0x07, 0);
+    HAL_NVIC_EnableIRQ(LTDC_LO_IRQn);
+  }
+}
+
+/**
+* @brief JPEG MSP Initialization
+* This function configures the hardware resources used in this example:
+* codec clock and interrupt, HPDMA1 channels feeding the MCUs and reading
+* the encoded stream
+* @param hjpeg: JPEG handle pointer
+* @retval None
+*/
+void HAL_JPEG_MspInit(JPEG_HandleTypeDef *hjpeg)
+{
+  static DMA_HandleTypeDef hdma_jpeg_in;
+  static DMA_HandleTypeDef hdma_jpeg_out;
+
+  if (hjpeg->Instance == JPEG)
+  {
+    /* USER CODE BEGIN JPEG_MspInit 0 */
+    __HAL_RCC_JPEG_CLK_ENABLE();
+
+    __HAL_RCC_JPEG_FORCE_RESET();
+    __HAL_RCC_JPEG_RELEASE_RESET();
+
+    __HAL_RCC_HPDMA1_CLK_ENABLE();
+
+    /* Input channel: MCU rows from memory to the codec input FIFO */
+    hdma_jpeg_in.Instance                   = HPDMA1_Channel0;
+    hdma_jpeg_in.Init.Request               = HPDMA1_REQUEST_JPEG_RX;
+    hdma_jpeg_in.Init.BlkHWRequest          = DMA_BREQ_SINGLE_BURST;
+    hdma_jpeg_in.Init.Direction             = DMA_MEMORY_TO_PERIPH;
+    hdma_jpeg_in.Init.SrcInc                = DMA_SINC_INCREMENTED;
+    hdma_jpeg_in.Init.DestInc               = DMA_DINC_FIXED;
+    hdma_jpeg_in.Init.SrcDataWidth          = DMA_SRC_DATAWIDTH_WORD;
+    hdma_jpeg_in.Init.DestDataWidth         = DMA_DEST_DATAWIDTH_WORD;
+    hdma_jpeg_in.Init.Priority              = DMA_HIGH_PRIORITY;
+    hdma_jpeg_in.Init.SrcBurstLength        = 8;
+    hdma_jpeg_in.Init.DestBurstLength       = 8;
+    hdma_jpeg_in.Init.TransferAllocatedPort = DMA_SRC_ALLOCATED_PORT0 | DMA_DEST_ALLOCATED_PORT1;
+    hdma_jpeg_in.Init.TransferEventMode     = DMA_TCEM_BLOCK_TRANSFER;
+    hdma_jpeg_in.Init.Mode                  = DMA_NORMAL;
+    if (HAL_DMA_Init(&hdma_jpeg_in) != HAL_OK)
+    {
+      Error_Handler();
+    }
+    if (HAL_DMA_ConfigChannelAttributes(&hdma_jpeg_in, DMA_CHANNEL_PRIV | DMA_CHANNEL_SEC |
+                                        DMA_CHANNEL_SRC_SEC | DMA_CHANNEL_DEST_SEC) != HAL_OK)
+    {
+      Error_Handler();
+    }
+    __HAL_LINKDMA(hjpeg, hdmain, hdma_jpeg_in);
+
+    /* Output channel: encoded stream from the codec output FIFO to memory */
+    hdma_jpeg_out.Instance                   = HPDMA1_Channel1;
+    hdma_jpeg_out.Init.Request               = HPDMA1_REQUEST_JPEG_TX;
+    hdma_jpeg_out.Init.BlkHWRequest          = DMA_BREQ_SINGLE_BURST;
+    hdma_jpeg_out.Init.Direction             = DMA_PERIPH_TO_MEMORY;
+    hdma_jpeg_out.Init.SrcInc                = DMA_SINC_FIXED;
+    hdma_jpeg_out.Init.DestInc               = DMA_DINC_INCREMENTED;
+    hdma_jpeg_out.Init.SrcDataWidth          = DMA_SRC_DATAWIDTH_WORD;
+    hdma_jpeg_out.Init.DestDataWidth         = DMA_DEST_DATAWIDTH_WORD;
+    hdma_jpeg_out.Init.Priority              = DMA_HIGH_PRIORITY;
+    hdma_jpeg_out.Init.SrcBurstLength        = 8;
+    hdma_jpeg_out.Init.DestBurstLength       = 8;
+    hdma_jpeg_out.Init.TransferAllocatedPort = DMA_SRC_ALLOCATED_PORT1 | DMA_DEST_ALLOCATED_PORT0;
+    hdma_jpeg_out.Init.TransferEventMode     = DMA_TCEM_BLOCK_TRANSFER;
+    hdma_jpeg_out.Init.Mode                  = DMA_NORMAL;
+    if (HAL_DMA_Init(&hdma_jpeg_out) != HAL_OK)
+    {
+      Error_Handler();
+    }
+    if (HAL_DMA_ConfigChannelAttributes(&hdma_jpeg_out, DMA_CHANNEL_PRIV | DMA_CHANNEL_SEC |
+                                        DMA_CHANNEL_SRC_SEC | DMA_CHANNEL_DEST_SEC) != HAL_OK)
+    {
+      Error_Handler();
+    }
+    __HAL_LINKDMA(hjpeg, hdmaout, hdma_jpeg_out);
+
+    HAL_RIF_RISC_SetSlaveSecureAttributes(RIF_RISC_PERIPH_INDEX_JPEG, RIF_ATTRIBUTE_SEC | RIF_ATTRIBUTE_PRIV);
+
+    /* NVIC configuration for the codec and its DMA channels, same priority as DCMIPP */
+    HAL_NVIC_SetPriority(HPDMA1_Channel0_IRQn, 0x07, 0);
+    HAL_NVIC_EnableIRQ(HPDMA1_Channel0_IRQn);
+    HAL_NVIC_SetPriority(HPDMA1_Channel1_IRQn, 0x07, 0);
+    HAL_NVIC_EnableIRQ(HPDMA1_Channel1_IRQn);
+    HAL_NVIC_SetPriority(JPEG_IRQn, 0x07, 0);
+    HAL_NVIC_EnableIRQ(JPEG_IRQn);
+    /* USER CODE END JPEG_MspInit 0 */
+  }
+}
+
+/**
+* @brief DMA2D MSP Initialization
+* This function configures the hardware resources used in this example
+* @param hdma2d: DMA2D handle pointer
+* @retval None
+*/
+void HAL_DMA2D_MspInit(DMA2D_HandleTypeDef *hdma2d)
+{
+  RIMC_MasterConfig_t RIMC_master = {0};
+
+  if (hdma2d->Instance == DMA2D)
+  {
+    /* USER CODE BEGIN DMA2D_MspInit 0 */
+    __HAL_RCC_DMA2D_CLK_ENABLE();
+
+    __HAL_RCC_DMA2D_FORCE_RESET();
+    __HAL_RCC_DMA2D_RELEASE_RESET();
+
+    /* The overlay compositor uses the DMA2D in polling mode, no interrupt */
+    RIMC_master.MasterCID = RIF_CID_1;
+    RIMC_master.SecPriv = RIF_ATTRIBUTE_SEC | RIF_ATTRIBUTE_PRIV;
+
+    HAL_RIF_RIMC_ConfigMasterAttributes(RIF_MASTER_INDEX_DMA2D, &RIMC_master);
+    HAL_RIF_RISC_SetSlaveSecureAttributes(RIF_RISC_PERIPH_INDEX_DMA2D, RIF_ATTRIBUTE_SEC | RIF_ATTRIBUTE_PRIV);
+    /* USER CODE END DMA2D_MspInit 0 */
   }
 }
 
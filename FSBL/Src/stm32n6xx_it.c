@@ -22,6 +22,13 @@
 #include "stm32n6xx_it.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "frame_trace.h"
+#if USE_DCMIPP_IRQ_DISPATCH
+#include "dcmipp_irq.h"
+#endif
+#if USE_SD_RECORDER
+#include "stm32n6570_discovery_sd.h"
+#endif
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -42,6 +49,14 @@
 /* Private variables ---------------------------------------------------------*/
 /* USER CODE BEGIN PV */
 extern DCMIPP_HandleTypeDef hdcmipp;
+extern LTDC_HandleTypeDef hltdc;
+extern JPEG_HandleTypeDef hjpeg;
+#if USE_FRAME_TRACE
+extern FrameTrace_HandleTypeDef htrace;
+#endif
+#if USE_DCMIPP_IRQ_DISPATCH
+extern DcmippIrq_HandleTypeDef hdcmipp_irq;
+#endif
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
@@ -208,14 +223,79 @@ void SysTick_Handler(void)
 
 void CSI_IRQHandler(void)
 {
+#if USE_FRAME_TRACE
+  uint32_t start = FRAME_TRACE_TIMESTAMP();
+#endif
+#if USE_DCMIPP_IRQ_DISPATCH
+  DcmippIrq_CSI_IRQHandler(&hdcmipp_irq);
+#else
   HAL_DCMIPP_CSI_IRQHandler(&hdcmipp);
+#endif
+#if USE_FRAME_TRACE
+  FrameTrace_Record(&htrace, FRAME_TRACE_ISR_CSI, FRAME_TRACE_TIMESTAMP() - start);
+#endif
 }
 
 void DCMIPP_IRQHandler(void)
 {
+#if USE_FRAME_TRACE
+  uint32_t start = FRAME_TRACE_TIMESTAMP();
+#endif
+#if USE_DCMIPP_IRQ_DISPATCH
+  DcmippIrq_IRQHandler(&hdcmipp_irq);
+#else
   HAL_DCMIPP_IRQHandler(&hdcmipp);
+#endif
+#if USE_FRAME_TRACE
+  FrameTrace_Record(&htrace, FRAME_TRACE_ISR_DCMIPP, FRAME_TRACE_TIMESTAMP() - start);
+#endif
 }
 
+void LTDC_LO_IRQHandler(void)
+{
+#if USE_FRAME_TRACE
+  uint32_t start = FRAME_TRACE_TIMESTAMP();
+#endif
+  HAL_LTDC_IRQHandler(&hltdc);
+#if USE_FRAME_TRACE
+  FrameTrace_Record(&htrace, FRAME_TRACE_ISR_LTDC, FRAME_TRACE_TIMESTAMP() - start);
+#endif
+}
+
+void JPEG_IRQHandler(void)
+{
+  HAL_JPEG_IRQHandler(&hjpeg);
+}
+
+void HPDMA1_Channel0_IRQHandler(void)
+{
+  HAL_DMA_IRQHandler(hjpeg.hdmain);
+}
+
+void HPDMA1_Channel1_IRQHandler(void)
+{
+  HAL_DMA_IRQHandler(hjpeg.hdmaout);
+}
+
+#if USE_SENSOR_QUEUE
+void I2C1_EV_IRQHandler(void)
+{
+  HAL_I2C_EV_IRQHandler(&hbus_i2c1);
+}
+
+void I2C1_ER_IRQHandler(void)
+{
+  HAL_I2C_ER_IRQHandler(&hbus_i2c1);
+}
+#endif
+
+#if USE_SD_RECORDER
+void SDMMC2_IRQHandler(void)
+{
+  BSP_SD_IRQHandler(0);
+}
+#endif
+
 /******************************************************************************/
 /* STM32N6xx Peripheral Interrupt Handlers                                    */
 /* Add here the Interrupt Handlers for the used peripherals.                  */
@@ -0,0 +1,341 @@
+/**
+  ******************************************************************************
+  * @file    touch_meter.c
+  * @brief   AEC/AWB metering spot moved by a tap on the preview.
+  *
+  *          The displayed pipe decimates the sensor frame in the ISP, crops
+  *          the result and downsizes the crop to the video window. A tap on
+  *          the video window is mapped back through these three steps to a
+  *          point of the sensor frame, the referential of the ISP statistic
+  *          area. The metering spot, sized on the display, is centered on
+  *          that point and kept inside the sensor frame.
+  *
+  *          The new statistic area is applied by the ISP at the next frame
+  *          start, then the AEC/AWB convergence restarts from the current
+  *          exposure, gain and white balance, on the measures of the new
+  *          area only.
+  *
+  *          The transforms have no hardware access and can be built on the
+  *          host to check the mapping.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "touch_meter.h"
+#include "stm32n6570_discovery_ts.h"
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define TOUCH_METER_AREA_MIN      ISP_STATWINDOW_MIN
+#define TOUCH_METER_AREA_MAX      ISP_STATWINDOW_MAX
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t TouchMeter_ScaleSize(uint32_t Size, uint32_t Num, uint32_t Den, uint32_t Max);
+static uint32_t TouchMeter_Center(uint32_t Center, uint32_t Size, uint32_t Max);
+static uint32_t TouchMeter_ToDisplay(int32_t Pos, uint32_t Crop, uint32_t CropSize, uint32_t Origin,
+                                    uint32_t Size);
+static uint8_t TouchMeter_IsMapValid(const TouchMeter_MapTypeDef *pMap);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Initialize the touch metering
+  * @note   The touch panel instance is initialized by the caller, in the
+  *         display orientation and size.
+  * @param  hmeter  Touch metering handle
+  * @param  hIsp    ISP handle of the displayed pipe
+  * @param  pConf   Touch metering configuration
+  * @param  pMap    Display to sensor transform
+  * @retval HAL status
+  */
+HAL_StatusTypeDef TouchMeter_Init(TouchMeter_HandleTypeDef *hmeter, ISP_HandleTypeDef *hIsp,
+                                  const TouchMeter_ConfTypeDef *pConf, const TouchMeter_MapTypeDef *pMap)
+{
+  if ((hmeter == NULL) || (hIsp == NULL) || (pConf == NULL) || (pConf->SpotWidth == 0U) ||
+      (pConf->SpotHeight == 0U))
+  {
+    return HAL_ERROR;
+  }
+
+  memset(hmeter, 0, sizeof(*hmeter));
+  hmeter->hIsp = hIsp;
+  hmeter->Conf = *pConf;
+
+  return TouchMeter_SetMap(hmeter, pMap);
+}
+
+/**
+  * @brief  Update the display to sensor transform, after a crop or decimation change
+  * @param  hmeter  Touch metering handle
+  * @param  pMap    Display to sensor transform
+  * @retval HAL status
+  */
+HAL_StatusTypeDef TouchMeter_SetMap(TouchMeter_HandleTypeDef *hmeter, const TouchMeter_MapTypeDef *pMap)
+{
+  if ((hmeter == NULL) || (TouchMeter_IsMapValid(pMap) == 0U))
+  {
+    return HAL_ERROR;
+  }
+
+  hmeter->Map = *pMap;
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Meter AEC/AWB on a spot of the display
+  * @param  hmeter  Touch metering handle
+  * @param  X       Spot center on the display
+  * @param  Y       Spot center on the display
+  * @retval HAL status, HAL_ERROR out of the video window
+  */
+HAL_StatusTypeDef TouchMeter_MeterAt(TouchMeter_HandleTypeDef *hmeter, uint32_t X, uint32_t Y)
+{
+  ISP_StatAreaTypeDef area;
+
+  if (TouchMeter_ComputeArea(&hmeter->Map, X, Y, hmeter->Conf.SpotWidth, hmeter->Conf.SpotHeight,
+                             &area) != HAL_OK)
+  {
+    return HAL_ERROR;
+  }
+
+  /* Applied by the ISP at the next frame start */
+  if (ISP_SetStatArea(hmeter->hIsp, &area) != ISP_OK)
+  {
+    hmeter->ErrorCount++;
+    return HAL_ERROR;
+  }
+
+  /* Converge again from the current state, on the new area */
+  if (ISP_RestartConvergence(hmeter->hIsp) != ISP_OK)
+  {
+    hmeter->ErrorCount++;
+    return HAL_ERROR;
+  }
+
+  TouchMeter_AreaToDisplay(&hmeter->Map, &area, &hmeter->Spot);
+  hmeter->TapCount++;
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Poll the touch panel and meter on a new tap
+  * @note   To be called from the main loop. A touch held down is metered
+  *         once, when it starts.
+  * @param  hmeter  Touch metering handle
+  * @retval 1 when the spot moved, hmeter->Spot then gives it on the display
+  */
+uint8_t TouchMeter_Process(TouchMeter_HandleTypeDef *hmeter)
+{
+  TS_State_t state = {0};
+  uint32_t tick = HAL_GetTick();
+  uint8_t moved = 0;
+
+  if ((tick - hmeter->LastPollTick) < hmeter->Conf.PollPeriod)
+  {
+    return 0;
+  }
+  hmeter->LastPollTick = tick;
+
+  if (BSP_TS_GetState(hmeter->Conf.Instance, &state) != BSP_ERROR_NONE)
+  {
+    return 0;
+  }
+
+  if ((state.TouchDetected != 0U) && (hmeter->Touched == 0U))
+  {
+    moved = (TouchMeter_MeterAt(hmeter, state.TouchX, state.TouchY) == HAL_OK) ? 1U : 0U;
+  }
+  hmeter->Touched = (state.TouchDetected != 0U) ? 1U : 0U;
+
+  return moved;
+}
+
+/**
+  * @brief  Map a point of the display to the sensor frame
+  * @param  pMap      Display to sensor transform
+  * @param  X         Point on the display
+  * @param  Y         Point on the display
+  * @param  pSensorX  Point in the sensor frame
+  * @param  pSensorY  Point in the sensor frame
+  * @retval HAL status, HAL_ERROR out of the video window
+  */
+HAL_StatusTypeDef TouchMeter_MapPoint(const TouchMeter_MapTypeDef *pMap, uint32_t X, uint32_t Y,
+                                      uint32_t *pSensorX, uint32_t *pSensorY)
+{
+  uint32_t x;
+  uint32_t y;
+
+  if ((TouchMeter_IsMapValid(pMap) == 0U) || (pSensorX == NULL) || (pSensorY == NULL) ||
+      (X < pMap->DisplayX) || (X >= (pMap->DisplayX + pMap->DisplayWidth)) ||
+      (Y < pMap->DisplayY) || (Y >= (pMap->DisplayY + pMap->DisplayHeight)))
+  {
+    return HAL_ERROR;
+  }
+
+  /* Downsize: center of the display pixel in the crop window */
+  x = pMap->CropX + (((2U * (X - pMap->DisplayX) + 1U) * pMap->CropWidth) / (2U * pMap->DisplayWidth));
+  y = pMap->CropY + (((2U * (Y - pMap->DisplayY) + 1U) * pMap->CropHeight) / (2U * pMap->DisplayHeight));
+
+  /* ISP decimation */
+  x *= pMap->Decimation;
+  y *= pMap->Decimation;
+
+  *pSensorX = (x < pMap->SensorWidth) ? x : (pMap->SensorWidth - 1U);
+  *pSensorY = (y < pMap->SensorHeight) ? y : (pMap->SensorHeight - 1U);
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Statistic area of a spot of the display
+  * @param  pMap    Display to sensor transform
+  * @param  X       Spot center on the display
+  * @param  Y       Spot center on the display
+  * @param  Width   Spot size on the display
+  * @param  Height  Spot size on the display
+  * @param  pArea   Statistic area, inside the sensor frame
+  * @retval HAL status, HAL_ERROR out of the video window
+  */
+HAL_StatusTypeDef TouchMeter_ComputeArea(const TouchMeter_MapTypeDef *pMap, uint32_t X, uint32_t Y,
+                                         uint32_t Width, uint32_t Height, ISP_StatAreaTypeDef *pArea)
+{
+  uint32_t x;
+  uint32_t y;
+
+  if ((pArea == NULL) || (TouchMeter_MapPoint(pMap, X, Y, &x, &y) != HAL_OK))
+  {
+    return HAL_ERROR;
+  }
+
+  pArea->XSize = TouchMeter_ScaleSize(Width, pMap->CropWidth * pMap->Decimation, pMap->DisplayWidth,
+                                      pMap->SensorWidth);
+  pArea->YSize = TouchMeter_ScaleSize(Height, pMap->CropHeight * pMap->Decimation, pMap->DisplayHeight,
+                                      pMap->SensorHeight);
+  pArea->X0 = TouchMeter_Center(x, pArea->XSize, pMap->SensorWidth);
+  pArea->Y0 = TouchMeter_Center(y, pArea->YSize, pMap->SensorHeight);
+
+  return HAL_OK;
+}
+
+/**
+  * @brief  Part of a statistic area shown on the display
+  * @param  pMap   Display to sensor transform
+  * @param  pArea  Statistic area, in the sensor frame
+  * @param  pRect  Area on the display, clipped to the video window
+  * @retval None
+  */
+void TouchMeter_AreaToDisplay(const TouchMeter_MapTypeDef *pMap, const ISP_StatAreaTypeDef *pArea,
+                              TouchMeter_RectTypeDef *pRect)
+{
+  uint32_t x0 = TouchMeter_ToDisplay((int32_t)(pArea->X0 / pMap->Decimation), pMap->CropX, pMap->CropWidth,
+                                     pMap->DisplayX, pMap->DisplayWidth);
+  uint32_t x1 = TouchMeter_ToDisplay((int32_t)((pArea->X0 + pArea->XSize) / pMap->Decimation), pMap->CropX,
+                                     pMap->CropWidth, pMap->DisplayX, pMap->DisplayWidth);
+  uint32_t y0 = TouchMeter_ToDisplay((int32_t)(pArea->Y0 / pMap->Decimation), pMap->CropY, pMap->CropHeight,
+                                     pMap->DisplayY, pMap->DisplayHeight);
+  uint32_t y1 = TouchMeter_ToDisplay((int32_t)((pArea->Y0 + pArea->YSize) / pMap->Decimation), pMap->CropY,
+                                     pMap->CropHeight, pMap->DisplayY, pMap->DisplayHeight);
+
+  pRect->X = x0;
+  pRect->Y = y0;
+  pRect->Width = x1 - x0;
+  pRect->Height = y1 - y0;
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  Scale a spot size to the sensor frame, within the statistic area limits
+  * @param  Size  Size on the display
+  * @param  Num   Sensor pixels for Den display pixels
+  * @param  Den   Display pixels
+  * @param  Max   Sensor frame size
+  * @retval Size in the sensor frame
+  */
+static uint32_t TouchMeter_ScaleSize(uint32_t Size, uint32_t Num, uint32_t Den, uint32_t Max)
+{
+  uint32_t size = (uint32_t)(((uint64_t)Size * Num) / Den);
+
+  if (Max > TOUCH_METER_AREA_MAX)
+  {
+    Max = TOUCH_METER_AREA_MAX;
+  }
+
+  if (size > Max)
+  {
+    size = Max;
+  }
+  if (size < TOUCH_METER_AREA_MIN)
+  {
+    size = TOUCH_METER_AREA_MIN;
+  }
+
+  return size;
+}
+
+/**
+  * @brief  Start of a window centered on a point, kept inside the frame
+  * @param  Center  Window center
+  * @param  Size    Window size, not larger than the frame
+  * @param  Max     Frame size
+  * @retval Window start
+  */
+static uint32_t TouchMeter_Center(uint32_t Center, uint32_t Size, uint32_t Max)
+{
+  uint32_t start = (Center > (Size / 2U)) ? (Center - (Size / 2U)) : 0U;
+
+  return ((start + Size) <= Max) ? start : (Max - Size);
+}
+
+/**
+  * @brief  Position of a crop window coordinate on the display, clipped to the video window
+  * @param  Pos       Coordinate after the ISP decimation
+  * @param  Crop      Crop window start
+  * @param  CropSize  Crop window size
+  * @param  Origin    Video window start on the display
+  * @param  Size      Video window size
+  * @retval Display coordinate
+  */
+static uint32_t TouchMeter_ToDisplay(int32_t Pos, uint32_t Crop, uint32_t CropSize, uint32_t Origin,
+                                    uint32_t Size)
+{
+  int32_t pos = (int32_t)(((int64_t)(Pos - (int32_t)Crop) * (int32_t)Size) / (int32_t)CropSize);
+
+  if (pos < 0)
+  {
+    pos = 0;
+  }
+  if (pos > (int32_t)Size)
+  {
+    pos = (int32_t)Size;
+  }
+
+  return Origin + (uint32_t)pos;
+}
+
+/**
+  * @brief  Check a display to sensor transform
+  * @param  pMap  Display to sensor transform
+  * @retval 1 if valid
+  */
+static uint8_t TouchMeter_IsMapValid(const TouchMeter_MapTypeDef *pMap)
+{
+  if ((pMap == NULL) || (pMap->DisplayWidth == 0U) || (pMap->DisplayHeight == 0U) || (pMap->CropWidth == 0U) ||
+      (pMap->CropHeight == 0U) || (pMap->Decimation == 0U) || (pMap->SensorWidth < TOUCH_METER_AREA_MIN) ||
+      (pMap->SensorHeight < TOUCH_METER_AREA_MIN))
+  {
+    return 0;
+  }
+
+  return 1;
+}
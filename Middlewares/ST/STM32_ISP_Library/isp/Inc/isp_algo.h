@@ -30,6 +30,7 @@
 ISP_StatusTypeDef ISP_Algo_Init(ISP_HandleTypeDef *hIsp);
 ISP_StatusTypeDef ISP_Algo_DeInit(ISP_HandleTypeDef *hIsp);
 ISP_StatusTypeDef ISP_Algo_Process(ISP_HandleTypeDef *hIsp);
+ISP_StatusTypeDef ISP_Algo_Restart(ISP_HandleTypeDef *hIsp);
 
 /* Exported variables --------------------------------------------------------*/
 
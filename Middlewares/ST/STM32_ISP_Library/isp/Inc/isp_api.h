@@ -39,6 +39,7 @@ ISP_StatusTypeDef ISP_BackgroundProcess(ISP_HandleTypeDef *hIsp);
 ISP_StatusTypeDef ISP_SetExposureTarget(ISP_HandleTypeDef *hIsp, ISP_ExposureCompTypeDef ExposureCompensation);
 ISP_StatusTypeDef ISP_GetExposureTarget(ISP_HandleTypeDef *hIsp, ISP_ExposureCompTypeDef *pExposureCompensation, uint32_t *pExposureTarget);
 ISP_StatusTypeDef ISP_ListWBRefModes(ISP_HandleTypeDef *hIsp, uint32_t RefColorTemp[]);
+ISP_StatusTypeDef ISP_SetExposureMax(ISP_HandleTypeDef *hIsp, uint32_t ExposureMax);
 ISP_StatusTypeDef ISP_SetAECState(ISP_HandleTypeDef *hIsp, uint8_t enable);
 ISP_StatusTypeDef ISP_GetAECState(ISP_HandleTypeDef *hIsp, uint8_t *pEnable);
 ISP_StatusTypeDef ISP_SetWBRefMode(ISP_HandleTypeDef *hIsp, uint8_t Automatic, uint32_t RefColorTemp);
@@ -46,6 +47,7 @@ ISP_StatusTypeDef ISP_GetWBRefMode(ISP_HandleTypeDef *hIsp, uint8_t *pAutomatic,
 ISP_StatusTypeDef ISP_GetDecimationFactor(ISP_HandleTypeDef *hIsp, ISP_DecimationTypeDef *pDecimation);
 ISP_StatusTypeDef ISP_SetStatArea(ISP_HandleTypeDef *hIsp, ISP_StatAreaTypeDef *pStatArea);
 ISP_StatusTypeDef ISP_GetStatArea(ISP_HandleTypeDef *hIsp, ISP_StatAreaTypeDef *pStatArea);
+ISP_StatusTypeDef ISP_RestartConvergence(ISP_HandleTypeDef *hIsp);
 
 void ISP_GatherStatistics(ISP_HandleTypeDef *hIsp);
 void ISP_IncMainFrameId(ISP_HandleTypeDef *hIsp);
@@ -55,5 +57,6 @@ uint32_t ISP_GetAncillaryFrameId(ISP_HandleTypeDef *hIsp);
 void ISP_IncDumpFrameId(ISP_HandleTypeDef *hIsp);
 uint32_t ISP_GetDumpFrameId(ISP_HandleTypeDef *hIsp);
 void ISP_OutputMeta(ISP_HandleTypeDef *hIsp);
+ISP_StatusTypeDef ISP_GetFrameMeta(ISP_HandleTypeDef *hIsp, ISP_FrameMetaTypeDef *pFrameMeta);
 
 #endif /* __ISP_API__H */
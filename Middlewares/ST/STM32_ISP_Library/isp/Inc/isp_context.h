@@ -0,0 +1,245 @@
+/**
+ ******************************************************************************
+ * @file    isp_context.h
+ * @author  AIS Application Team
+ * @brief   Header file of ISP middleware per instance state.
+ *          The services and algorithms keep all their state in the ISP
+ *          device handle, so that several ISP instances (one per camera or
+ *          per pipe) run independently. Included by isp_core.h before the
+ *          ISP device handle definition, not to be included directly.
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __ISP_CONTEXT__H
+#define __ISP_CONTEXT__H
+
+/* Includes ------------------------------------------------------------------*/
+#ifdef ISP_MW_SW_AEC_ALGO_SUPPORT
+#include "evision-api-st-ae.h"
+#endif /* ISP_MW_SW_AEC_ALGO_SUPPORT */
+#ifdef ISP_MW_SW_AWB_ALGO_SUPPORT
+#include "evision-api-awb.h"
+#endif /* ISP_MW_SW_AWB_ALGO_SUPPORT */
+
+/* Exported types ------------------------------------------------------------*/
+/* Statistics services -------------------------------------------------------*/
+typedef enum {
+  ISP_STAT_LOC_NONE          = 0x00U,
+  ISP_STAT_LOC_UP            = 0x01U << 0,
+  ISP_STAT_LOC_DOWN          = 0x01U << 1,
+  ISP_STAT_LOC_UP_AND_DOWN   = (ISP_STAT_LOC_UP | ISP_STAT_LOC_DOWN),
+} ISP_SVC_StatLocation;
+
+typedef enum {
+  ISP_STAT_TYPE_NONE         = 0x00U,
+  ISP_STAT_TYPE_AVG          = 0x01U << 0,
+  ISP_STAT_TYPE_BINS         = 0x01U << 1,
+  ISP_STAT_TYPE_AVG_AND_BINS = (ISP_STAT_TYPE_AVG | ISP_STAT_TYPE_BINS),
+  ISP_STAT_TYPE_ALL_TMP      = 0x01U << 2, /* special value for IQTuningTool usage */
+} ISP_SVC_StatType;
+
+typedef struct {
+  ISP_StatisticsTypeDef up;   /* Statistics collected at the up side of the ISP pipeline */
+  ISP_StatisticsTypeDef down; /* Statistics collected at the down side of the ISP pipeline */
+  uint32_t upFrameIdStart;    /* Frame id of the first frame of the gather cycle at up side */
+  uint32_t upFrameIdEnd;      /* Frame id of the last frame of the gather cycle at up side */
+  uint32_t downFrameIdStart;  /* Frame id of the first frame of the gather cycle at down side */
+  uint32_t downFrameIdEnd;    /* Frame id of the last frame of the gather cycle at down side */
+} ISP_SVC_StatStateTypeDef;
+
+typedef ISP_StatusTypeDef (*ISP_stat_ready_cb)(ISP_AlgoTypeDef *pAlgo);
+
+typedef struct {
+  uint32_t gatherCycles;      /* Duration of the last ISP_SVC_Stats_Gather() call, in CPU cycles */
+  uint32_t gatherCyclesMax;   /* Longest ISP_SVC_Stats_Gather() call */
+  uint32_t overBudgetCount;   /* Calls exceeding ISP_SVC_STAT_GATHER_BUDGET_CYCLES */
+  uint32_t droppedCount;      /* Samples lost because the background did not drain the ring */
+  uint32_t avgLatency;        /* Frames between the requested frame and the delivery, last AVG request */
+  uint32_t avgLatencyMax;     /* Longest AVG request latency */
+  uint32_t binsLatency;       /* Frames between the requested frame and the delivery, last BINS request */
+  uint32_t binsLatencyMax;    /* Longest BINS request latency */
+} ISP_SVC_StatProfileTypeDef;
+
+typedef enum {
+  ISP_STAT_CFG_UP_AVG = 0,      /* Configure @Up   for average    */
+  ISP_STAT_CFG_UP_BINS_0_2,     /* Configure @Up   for bins[0:2]  */
+  ISP_STAT_CFG_UP_BINS_3_5,     /* Configure @Up   for bins[3:5]  */
+  ISP_STAT_CFG_UP_BINS_6_8,     /* Configure @Up   for bins[6:8]  */
+  ISP_STAT_CFG_UP_BINS_9_11,    /* Configure @Up   for bins[9:11] */
+  ISP_STAT_CFG_DOWN_AVG,        /* Configure @Down for average    */
+  ISP_STAT_CFG_DOWN_BINS_0_2,   /* Configure @Down for bins[0:2]  */
+  ISP_STAT_CFG_DOWN_BINS_3_5,   /* Configure @Down for bins[3:5]  */
+  ISP_STAT_CFG_DOWN_BINS_6_8,   /* Configure @Down for bins[6:8]  */
+  ISP_STAT_CFG_DOWN_BINS_9_11,  /* Configure @Down for bins[9:11] */
+  ISP_STAT_CFG_LAST = ISP_STAT_CFG_DOWN_BINS_9_11,
+  ISP_STAT_CFG_CYCLE_SIZE,
+  ISP_STAT_CFG_NONE = ISP_STAT_CFG_CYCLE_SIZE, /* Statistic modules not configured yet */
+} ISP_SVC_StatEngineStage;
+
+/* Index of the up / down location in the per location decoding state */
+#define ISP_SVC_STAT_IDX_UP       (0U)
+#define ISP_SVC_STAT_IDX_DOWN     (1U)
+#define ISP_SVC_STAT_NB_LOC       (2U)
+
+typedef struct {
+  ISP_stat_ready_cb callback;           /* Callback to inform that stats are ready */
+  ISP_AlgoTypeDef *pAlgo;               /* Callback context parameter */
+  ISP_SVC_StatStateTypeDef *pStats;     /* Output statistics */
+  uint32_t refFrameId;                  /* Frame reference for which stats are requested */
+  ISP_SVC_StatLocation location;        /* Location where stats are requested */
+  ISP_SVC_StatType type;                /* Type of requested stats */
+} ISP_SVC_StatRegisteredClient;
+
+/* Configuration applied to the statistic modules, whose result is read 2 VSYNC later */
+typedef struct {
+  ISP_SVC_StatEngineStage stage;        /* Stage the statistic modules are configured for */
+  uint32_t areaPixels;                  /* Pixels in the statistic area (decimated referential) */
+  uint8_t areaSeq;                      /* Statistic area generation */
+} ISP_SVC_StatTagTypeDef;
+
+/* Accumulators read by the VSYNC interrupt, decoded in the background */
+typedef struct {
+  ISP_SVC_StatEngineStage stage;        /* Stage the statistic modules were configured for */
+  uint32_t areaPixels;                  /* Pixels in the statistic area the accumulators refer to */
+  uint8_t areaSeq;                      /* Statistic area generation */
+  uint32_t frameId;                     /* Main pipe frame id when the accumulators were read */
+  uint32_t accu[3];                     /* DCMIPP_STATEXT_MODULE1..3 accumulators */
+  uint8_t resync;                       /* Samples were dropped just before this one */
+} ISP_SVC_StatSampleTypeDef;
+
+/* Statistic area, requested by the thread and programmed at a frame boundary by the VSYNC interrupt */
+typedef struct {
+  DCMIPP_StatisticExtractionAreaConfTypeDef next; /* Area waiting to be applied */
+  uint32_t nextPixels;                  /* Pixels in the area waiting to be applied */
+  volatile uint8_t pending;             /* Set by the thread once 'next' is written, cleared by the interrupt */
+  uint32_t pixels;                      /* Pixels in the area in effect, 0 until the first configuration */
+  uint8_t seq;                          /* Incremented each time a new area is applied */
+} ISP_SVC_StatAreaTypeDef;
+
+/* Single producer (VSYNC interrupt) / single consumer (background) ring */
+#define ISP_SVC_STAT_RING_SIZE    (8U)
+typedef struct {
+  ISP_SVC_StatSampleTypeDef sample[ISP_SVC_STAT_RING_SIZE];
+  volatile uint32_t head;               /* Written by the producer only */
+  volatile uint32_t tail;               /* Written by the consumer only */
+  uint8_t overflow;                     /* Producer side: a sample was dropped */
+} ISP_SVC_StatRingTypeDef;
+
+#define ISP_SVC_STAT_MAX_CB       (5U)
+typedef struct {
+  ISP_SVC_StatEngineStage stage;        /* Internal processing stage */
+  ISP_SVC_StatStateTypeDef last;        /* Last available statistics */
+  ISP_SVC_StatStateTypeDef ongoing;     /* Statistics being updated */
+  ISP_SVC_StatRegisteredClient client[ISP_SVC_STAT_MAX_CB]; /* Client waiting for stats */
+  ISP_SVC_StatType upRequest;           /* Type of statistics request at Up location */
+  ISP_SVC_StatType downRequest;         /* Type of statistics request at Down location */
+  uint32_t requestAllCounter;           /* Counter for the temporary "request all stats" mode */
+  ISP_SVC_StatRingTypeDef ring;         /* Accumulators waiting to be decoded */
+  ISP_SVC_StatProfileTypeDef profile;   /* Interrupt handler profiling */
+  ISP_SVC_StatAreaTypeDef area;         /* Statistic area */
+  /* Scheduling (VSYNC interrupt) */
+  ISP_SVC_StatTagTypeDef tagPrevious1;  /* Configuration applied at the previous VSYNC */
+  ISP_SVC_StatTagTypeDef tagPrevious2;  /* Configuration applied two VSYNC ago */
+  ISP_SVC_StatEngineStage lastAvgStage; /* Last average stage scheduled */
+  ISP_SVC_StatEngineStage lastBinsStage;/* Last histogram part scheduled */
+  uint32_t binsSinceAvg;                /* Histogram parts scheduled since the last average stage */
+  /* Decoding (background) */
+  uint32_t avgFrameId[ISP_SVC_STAT_NB_LOC];       /* Frame of the last average measure */
+  uint32_t binsFrameId[ISP_SVC_STAT_NB_LOC];      /* First frame of the last complete histogram */
+  uint32_t binsFrameIdStart[ISP_SVC_STAT_NB_LOC]; /* First frame of the histogram being collected */
+  uint8_t binsMask[ISP_SVC_STAT_NB_LOC];          /* Parts of the histogram being collected */
+  uint8_t areaSeq;                      /* Statistic area of the last decoded sample */
+} ISP_SVC_StatEngineTypeDef;
+
+/* State of the ISP services of one ISP instance */
+typedef struct {
+  ISP_IQParamTypeDef IQParamCache;      /* IQ parameters in use */
+  ISP_SVC_StatEngineTypeDef statEngine; /* Statistic engine */
+  ISP_DecimationTypeDef decimation;     /* Decimation factor in use */
+  uint32_t manualWBRefColorTemp;        /* Manual white balance reference color temperature */
+  bool sensorDelayMeasureRun;           /* Sensor delay measure in progress */
+  ISP_MetaTypeDef meta;                 /* Meta data reported by ISP_OutputMeta() */
+} ISP_SVC_ContextTypeDef;
+
+/* Algorithms ----------------------------------------------------------------*/
+/* Maximum number of algorithms registered on one ISP instance */
+#define ISP_ALGO_MAX_NB           (4U)
+
+/* Number of sensor delay test configurations */
+#define ISP_ALGO_DELAY_NB_CONFIG  (12U)
+
+typedef struct {
+  uint32_t badPixelCount;               /* Sum of the bad pixels counted during the measure */
+  uint32_t lastFrameId;                 /* Frame of the last measure */
+  int8_t step;                          /* Measure in progress, -1 while the hardware updates */
+} ISP_Algo_BadPixelContextTypeDef;
+
+#ifdef ISP_MW_SW_AEC_ALGO_SUPPORT
+typedef struct {
+  evision_st_ae_process_t *pProcess;    /* evision AE instance */
+  ISP_SVC_StatStateTypeDef stats;       /* Statistics requested by the algorithm */
+  uint32_t currentL;                    /* Last luminance logged (ALGO_AEC_DBG_LOGS) */
+} ISP_Algo_AECContextTypeDef;
+#endif /* ISP_MW_SW_AEC_ALGO_SUPPORT */
+
+#ifdef ISP_MW_SW_AWB_ALGO_SUPPORT
+typedef struct {
+  evision_awb_estimator_t *pEstimator;  /* evision AWB instance */
+  ISP_SVC_StatStateTypeDef stats;       /* Statistics requested by the algorithm */
+  uint8_t enableCurrent;                /* Algorithm running */
+  uint8_t reconfigureRequest;           /* Apply a profile at the next estimation */
+  uint32_t currentColorTemp;            /* Color temperature of the profile applied */
+  uint32_t currentProfId;               /* Index of the profile applied */
+  evision_awb_profile_t profiles[ISP_AWB_COLORTEMP_REF];
+  float colorTempThresholds[ISP_AWB_COLORTEMP_REF - 1];
+  uint32_t statsHistory[3][3];          /* Up average R, G, B of the last measures */
+  uint32_t colorTempHistory[2];         /* Color temperature of the last measures */
+  uint8_t skipStatCheckCount;           /* Estimations left before the stable statistics check */
+} ISP_Algo_AWBContextTypeDef;
+#endif /* ISP_MW_SW_AWB_ALGO_SUPPORT */
+
+#ifdef ISP_MW_TUNING_TOOL_SUPPORT
+typedef struct {
+  int32_t refL;                         /* Luminance before the configuration change */
+  int32_t delay;                        /* Frames since the configuration change */
+  int32_t delays[ISP_ALGO_DELAY_NB_CONFIG - 1]; /* Delay measured for each configuration change */
+  int32_t configId;                     /* Configuration under test */
+  ISP_SensorExposureTypeDef configExposure[ISP_ALGO_DELAY_NB_CONFIG];
+  ISP_SensorGainTypeDef configGain[ISP_ALGO_DELAY_NB_CONFIG];
+  ISP_SensorExposureTypeDef prevExposureConfig; /* Sensor configuration restored at the end */
+  ISP_SensorGainTypeDef prevGainConfig;
+  uint8_t prevAECStatus;                /* Algorithm states restored at the end */
+  uint8_t prevAWBStatus;
+  ISP_SVC_StatStateTypeDef stats;       /* Statistics requested by the algorithm */
+} ISP_Algo_SensorDelayContextTypeDef;
+#endif /* ISP_MW_TUNING_TOOL_SUPPORT */
+
+/* State of the algorithms of one ISP instance */
+typedef struct {
+  ISP_AlgoTypeDef instance[ISP_ALGO_MAX_NB]; /* Algorithm handles, copied from the registered list */
+  ISP_AlgoTypeDef *list[ISP_ALGO_MAX_NB];    /* Pointed to by the ISP device handle 'algorithm' field */
+  uint32_t nb;                               /* Number of algorithms */
+  ISP_Algo_BadPixelContextTypeDef badPixel;
+#ifdef ISP_MW_SW_AEC_ALGO_SUPPORT
+  ISP_Algo_AECContextTypeDef aec;
+#endif /* ISP_MW_SW_AEC_ALGO_SUPPORT */
+#ifdef ISP_MW_SW_AWB_ALGO_SUPPORT
+  ISP_Algo_AWBContextTypeDef awb;
+#endif /* ISP_MW_SW_AWB_ALGO_SUPPORT */
+#ifdef ISP_MW_TUNING_TOOL_SUPPORT
+  ISP_Algo_SensorDelayContextTypeDef sensorDelay;
+#endif /* ISP_MW_TUNING_TOOL_SUPPORT */
+} ISP_Algo_ContextTypeDef;
+
+#endif /* __ISP_CONTEXT__H */
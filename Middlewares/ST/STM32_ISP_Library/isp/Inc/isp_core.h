@@ -114,7 +114,7 @@ typedef struct
   ISP_StatusTypeDef (*Init)(void *hIsp, void *pAlgo);
   ISP_StatusTypeDef (*DeInit)(void *hIsp, void *pAlgo);
   ISP_StatusTypeDef (*Process)(void *hIsp, void *pAlgo);
-  /* Use for performance measurement */
+  /* Use for performance measurement (cycle counter ticks, ALGO_PERF_DBG_LOGS) */
   uint32_t perf_meas[NB_PERF_MEASURES];
   uint32_t iter;
 } ISP_AlgoTypeDef;
@@ -147,6 +147,14 @@ typedef enum
   ISP_DUMP_CFG_DUMP_PIPE_SENSOR  = 0x02U,
 } ISP_DumpCfgTypeDef;
 
+/* ISP events reported to the application trace */
+typedef enum
+{
+  ISP_TRACE_STAT_READY = 0x00U,   /* Statistics delivered to an algorithm */
+  ISP_TRACE_AEC_APPLY  = 0x01U,   /* New sensor gain or exposure applied */
+  ISP_TRACE_AWB_APPLY  = 0x02U,   /* New color conversion and ISP gains applied */
+} ISP_TraceEventTypeDef;
+
 #define ISP_SENSOR_INFO_MAX_LENGTH      (32U)
 
 typedef struct
@@ -194,22 +202,15 @@ typedef struct
   ISP_StatusTypeDef (*GetSensorExposure)(uint32_t Instance, int32_t *Exposure);
   /* [OPTIONAL] Set sensor test pattern */
   ISP_StatusTypeDef (*SetSensorTestPattern)(uint32_t Instance, int32_t mode);
+  /* [OPTIONAL] Timestamp an ISP event. The parameters are:
+  *    Instance:  Camera instance.
+  *    Event:     Event that occurred.
+  *    FrameId:   Id of the last frame output on the main pipe.
+  *  Called from the background process, must return quickly.
+  */
+  void (*TraceEvent)(uint32_t Instance, ISP_TraceEventTypeDef Event, uint32_t FrameId);
 } ISP_AppliHelpersTypeDef;
 
-/* ISP Device handle structure */
-typedef struct
-{
-  void *hDcmipp;
-  uint32_t cameraInstance;
-  ISP_StatAreaTypeDef statArea;
-  ISP_AlgoTypeDef **algorithm;
-  ISP_AppliHelpersTypeDef appliHelpers;
-  uint32_t MainPipe_FrameCount;
-  uint32_t AncillaryPipe_FrameCount;
-  uint32_t DumpPipe_FrameCount;
-  ISP_SensorInfoTypeDef sensorInfo;
-} ISP_HandleTypeDef;
-
 /* ISP Demosaicing type */
 typedef enum
 {
@@ -396,6 +397,15 @@ typedef struct
   uint32_t colorTemp;
 } ISP_MetaTypeDef;
 
+/* ISP settings of a frame, read back at its start */
+typedef struct
+{
+  ISP_ISPGainTypeDef ispGain;       /* ISP gains latched for the frame */
+  ISP_ColorConvTypeDef colorConv;   /* Color conversion latched for the frame */
+  uint8_t averageL;                 /* Last luminance measured by the AEC */
+  uint32_t colorTemp;               /* Last color temperature estimated by the AWB */
+} ISP_FrameMetaTypeDef;
+
 /* IQ parameter */
 typedef struct
 {
@@ -416,6 +426,25 @@ typedef struct
   ISP_SensorDelayTypeDef sensorDelay;
 } ISP_IQParamTypeDef;
 
+/* Per instance state of the services and algorithms */
+#include "isp_context.h"
+
+/* ISP Device handle structure */
+typedef struct
+{
+  void *hDcmipp;
+  uint32_t cameraInstance;
+  ISP_StatAreaTypeDef statArea;
+  ISP_AlgoTypeDef **algorithm;
+  ISP_AppliHelpersTypeDef appliHelpers;
+  uint32_t MainPipe_FrameCount;
+  uint32_t AncillaryPipe_FrameCount;
+  uint32_t DumpPipe_FrameCount;
+  ISP_SensorInfoTypeDef sensorInfo;
+  ISP_SVC_ContextTypeDef svcContext;     /* State of the services of this instance */
+  ISP_Algo_ContextTypeDef algoContext;   /* State of the algorithms of this instance */
+} ISP_HandleTypeDef;
+
 /* Exported constants --------------------------------------------------------*/
 #define ISP_DEMOS_STRENGTH_MAX              (7U)
 #define ISP_STATREMOVAL_HEADLINES_MAX       (7U)
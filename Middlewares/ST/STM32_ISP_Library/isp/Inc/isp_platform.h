@@ -28,4 +28,31 @@
 #error Add header files for your specific board
 #endif
 
+/* Cycle counter used to profile the interrupt handlers (DWT->CYCCNT, enabled by the application) */
+#ifndef ISP_PLATFORM_CYCLE_COUNT
+#if defined (STM32N657xx)
+#define ISP_PLATFORM_CYCLE_COUNT()      (DWT->CYCCNT)
+#else
+#define ISP_PLATFORM_CYCLE_COUNT()      (0U)
+#endif
+#endif
+
+/* Cycle counter frequency in MHz, converts the profiled durations into microseconds */
+#ifndef ISP_PLATFORM_CYCLES_PER_US
+#if defined (STM32N657xx)
+#define ISP_PLATFORM_CYCLES_PER_US()    (SystemCoreClock / 1000000U)
+#else
+#define ISP_PLATFORM_CYCLES_PER_US()    (1U)
+#endif
+#endif
+
+/* Memory barrier ordering the data exchanged between an interrupt handler and the background */
+#ifndef ISP_PLATFORM_MEMORY_BARRIER
+#if defined (STM32N657xx)
+#define ISP_PLATFORM_MEMORY_BARRIER()   __DMB()
+#else
+#define ISP_PLATFORM_MEMORY_BARRIER()   __sync_synchronize()
+#endif
+#endif
+
 #endif /* __ISP_PLATFORM_H */
@@ -0,0 +1,96 @@
+/**
+ ******************************************************************************
+ * @file    isp_raw.h
+ * @author  AIS Application Team
+ * @brief   Header file of the ISP software RAW pipeline.
+ *          Develops a RAW10 Bayer frame (e.g. a PIPE0 dump obtained with
+ *          ISP_DUMP_CFG_DUMP_PIPE_SENSOR) into RGB888 with the black level,
+ *          ISP gain and color conversion settings of the hardware pipeline.
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __ISP_RAW__H
+#define __ISP_RAW__H
+
+/* Includes ------------------------------------------------------------------*/
+#include "isp_core.h"
+
+/* Exported types ------------------------------------------------------------*/
+/* RAW10 frame layout in memory */
+typedef enum
+{
+  ISP_RAW_FORMAT_RAW10_PACKED = 0x00U, /* MIPI CSI-2 packing: 4 pixels in 5 bytes (MSBs, then the 2-bit LSBs) */
+  ISP_RAW_FORMAT_RAW16        = 0x01U, /* One little endian 16-bit word per pixel, value in bits [9:0] */
+} ISP_RAW_FormatTypeDef;
+
+/* Color filter array, colors of the first two pixels of the first two lines */
+typedef enum
+{
+  ISP_RAW_BAYER_RGGB = 0x00U,
+  ISP_RAW_BAYER_GRBG = 0x01U,
+  ISP_RAW_BAYER_GBRG = 0x02U,
+  ISP_RAW_BAYER_BGGR = 0x03U,
+} ISP_RAW_BayerTypeDef;
+
+/* Demosaicing method */
+typedef enum
+{
+  ISP_RAW_DEMOS_BILINEAR = 0x00U, /* Average of the nearest pixels of each color */
+  ISP_RAW_DEMOS_EDGE     = 0x01U, /* Green interpolated along the direction with the smallest gradient */
+} ISP_RAW_DemosaicTypeDef;
+
+/* Frame and processing configuration */
+typedef struct
+{
+  uint32_t width;                     /* Frame width in pixels, even and at least 8 */
+  uint32_t height;                    /* Frame height in lines, even and at least 2 */
+  uint32_t srcStride;                 /* Bytes between two RAW lines */
+  uint32_t dstStride;                 /* Bytes between two RGB888 lines */
+  ISP_RAW_FormatTypeDef format;
+  ISP_RAW_BayerTypeDef bayer;
+  ISP_RAW_DemosaicTypeDef demosaic;
+  ISP_BlackLevelTypeDef blackLevel;   /* Same unit as the hardware block: 8-bit level offsets */
+  ISP_ISPGainTypeDef ispGain;         /* Same unit as the hardware block (ISP_GAIN_PRECISION_FACTOR) */
+  ISP_ColorConvTypeDef colorConv;     /* Same unit as the hardware block (ISP_CCM_PRECISION_FACTOR) */
+  uint8_t gammaEnable;                /* Apply the 1/2.2 gamma of the hardware output stage */
+} ISP_RAW_ConfTypeDef;
+
+/* Software RAW pipeline handle */
+typedef struct
+{
+  ISP_RAW_ConfTypeDef conf;
+  uint16_t black[4];                  /* Black level of each CFA position, 10-bit */
+  uint32_t gain[3];                   /* R, G, B gains, hardware Shift/Multiplier quantization, Q7 */
+  int32_t ccm[3][3];                  /* Color conversion, hardware register quantization, Q8 */
+  uint8_t lut[1024];                  /* 10-bit to 8-bit output conversion, with or without gamma */
+  uint16_t *pBayer[3];                /* Rolling window of black level corrected lines, padded */
+  uint16_t *pPlane[3];                /* R, G, B planes of the line being developed */
+} ISP_RAW_HandleTypeDef;
+
+/* Exported constants --------------------------------------------------------*/
+/* Pixels of padding on each side of the Bayer lines (mirrored borders) */
+#define ISP_RAW_PAD                   (2U)
+
+/* Size in bytes of the work buffer for a frame width */
+#define ISP_RAW_WORK_SIZE(width)      ((3U * ((width) + 2U * ISP_RAW_PAD) + 3U * (width)) * sizeof(uint16_t))
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported functions ------------------------------------------------------- */
+ISP_StatusTypeDef ISP_RAW_Init(ISP_RAW_HandleTypeDef *hRaw, const ISP_RAW_ConfTypeDef *pConf, void *pWork, uint32_t WorkSize);
+ISP_StatusTypeDef ISP_RAW_Process(ISP_RAW_HandleTypeDef *hRaw, const uint8_t *pSrc, uint8_t *pDst);
+ISP_StatusTypeDef ISP_RAW_Benchmark(ISP_RAW_HandleTypeDef *hRaw, const uint8_t *pSrc, uint8_t *pDst, uint32_t NbFrames,
+                                    uint32_t *pKPixelPerSec);
+
+#endif /* __ISP_RAW__H */
@@ -24,37 +24,24 @@
 #include "isp_core.h"
 
 /* Exported types ------------------------------------------------------------*/
-typedef enum {
-  ISP_STAT_LOC_NONE          = 0x00U,
-  ISP_STAT_LOC_UP            = 0x01U << 0,
-  ISP_STAT_LOC_DOWN          = 0x01U << 1,
-  ISP_STAT_LOC_UP_AND_DOWN   = (ISP_STAT_LOC_UP | ISP_STAT_LOC_DOWN),
-} ISP_SVC_StatLocation;
-
-typedef enum {
-  ISP_STAT_TYPE_NONE         = 0x00U,
-  ISP_STAT_TYPE_AVG          = 0x01U << 0,
-  ISP_STAT_TYPE_BINS         = 0x01U << 1,
-  ISP_STAT_TYPE_AVG_AND_BINS = (ISP_STAT_TYPE_AVG | ISP_STAT_TYPE_BINS),
-  ISP_STAT_TYPE_ALL_TMP      = 0x01U << 2, /* special value for IQTuningTool usage */
-} ISP_SVC_StatType;
-
-typedef struct {
-  ISP_StatisticsTypeDef up;   /* Statistics collected at the up side of the ISP pipeline */
-  ISP_StatisticsTypeDef down; /* Statistics collected at the down side of the ISP pipeline */
-  uint32_t upFrameIdStart;    /* Frame id of the first frame of the gather cycle at up side */
-  uint32_t upFrameIdEnd;      /* Frame id of the last frame of the gather cycle at up side */
-  uint32_t downFrameIdStart;  /* Frame id of the first frame of the gather cycle at down side */
-  uint32_t downFrameIdEnd;    /* Frame id of the last frame of the gather cycle at down side */
-} ISP_SVC_StatStateTypeDef;
-
-typedef ISP_StatusTypeDef (*ISP_stat_ready_cb)(ISP_AlgoTypeDef *pAlgo);
+/* Statistics types are defined in isp_context.h */
 
 /* Exported constants --------------------------------------------------------*/
 /* Use a large precision factor to keep maximum precision on the ColorConv coeff and ISP gain values */
 #define ISP_CCM_PRECISION_FACTOR  100000000
 #define ISP_GAIN_PRECISION_FACTOR 100000000
 
+/* Cycle budget of ISP_SVC_Stats_Gather(), called from the VSYNC interrupt (10 us at 600 MHz) */
+#ifndef ISP_SVC_STAT_GATHER_BUDGET_CYCLES
+#define ISP_SVC_STAT_GATHER_BUDGET_CYCLES  (6000U)
+#endif
+
+/* Histogram parts measured between two average measures when both are requested: a low value favors
+ * the AEC/AWB convergence, a high value the histogram refresh rate */
+#ifndef ISP_SVC_STAT_BINS_PER_AVG
+#define ISP_SVC_STAT_BINS_PER_AVG          (1U)
+#endif
+
 /* Exported macro ------------------------------------------------------------*/
 /* Exported functions ------------------------------------------------------- */
 /* ISP services */
@@ -93,13 +80,14 @@ void ISP_SVC_Misc_IncDumpFrameId(ISP_HandleTypeDef *hIsp);
 uint32_t ISP_SVC_Misc_GetDumpFrameId(ISP_HandleTypeDef *hIsp);
 ISP_StatusTypeDef ISP_SVC_Misc_SetWBRefMode(ISP_HandleTypeDef *hIsp, uint32_t RefColorTemp);
 ISP_StatusTypeDef ISP_SVC_Misc_GetWBRefMode(ISP_HandleTypeDef *hIsp, uint32_t *pRefColorTemp);
-void ISP_SVC_Misc_SensorDelayMeasureStart();
-void ISP_SVC_Misc_SensorDelayMeasureStop();
-bool ISP_SVC_Misc_SensorDelayMeasureIsRunning();
+void ISP_SVC_Misc_SensorDelayMeasureStart(ISP_HandleTypeDef *hIsp);
+void ISP_SVC_Misc_SensorDelayMeasureStop(ISP_HandleTypeDef *hIsp);
+bool ISP_SVC_Misc_SensorDelayMeasureIsRunning(ISP_HandleTypeDef *hIsp);
 ISP_StatusTypeDef ISP_SVC_Misc_SendSensorDelayMeasure(ISP_HandleTypeDef *hIsp, ISP_SensorDelayTypeDef *pSensorDelay);
 ISP_StatusTypeDef ISP_SVC_Misc_StopPreview(ISP_HandleTypeDef *hIsp);
 ISP_StatusTypeDef ISP_SVC_Misc_StartPreview(ISP_HandleTypeDef *hIsp);
 bool ISP_SVC_Misc_IsGammaEnabled(ISP_HandleTypeDef *hIsp, uint32_t Pipe);
+void ISP_SVC_Misc_TraceEvent(ISP_HandleTypeDef *hIsp, ISP_TraceEventTypeDef Event);
 ISP_StatusTypeDef ISP_SVC_ISP_SetGamma(ISP_HandleTypeDef *hIsp, ISP_GammaTypeDef *pConfig);
 
 /* Dump services */
@@ -116,5 +104,7 @@ ISP_StatusTypeDef ISP_SVC_Stats_GetNext(ISP_HandleTypeDef *hIsp, ISP_stat_ready_
                                         ISP_SVC_StatLocation location, ISP_SVC_StatType type, uint32_t frameDelay);
 ISP_StatusTypeDef ISP_SVC_Stats_ProcessCallbacks(ISP_HandleTypeDef *hIsp);
 void ISP_SVC_Stats_Gather(ISP_HandleTypeDef *hIsp);
+void ISP_SVC_Stats_Process(ISP_HandleTypeDef *hIsp);
+ISP_StatusTypeDef ISP_SVC_Stats_GetProfile(ISP_HandleTypeDef *hIsp, ISP_SVC_StatProfileTypeDef *pProfile);
 
 #endif /* __ISP_SERVICES__H */
@@ -25,6 +25,9 @@
 #include "evision-api-utils.h"
 #include <limits.h>
 #include <math.h>
+#if defined(__ARM_FEATURE_MVE)
+#include <arm_mve.h>
+#endif
 
 /* Private types -------------------------------------------------------------*/
 /* ISP algorithms identifier */
@@ -50,10 +53,16 @@ typedef enum
 //#define ALGO_AEC_DBG_LOGS
 //#define ALGO_PERF_DBG_LOGS
 
+/* Fixed point precision of the AWB color pipeline */
+#define ALGO_AWB_GAMMA_LUT_SHIFT     16
+#define ALGO_AWB_CCM_SHIFT           15
+/* Color conversion coefficient unit of the ISP_CCM_PRECISION_FACTOR referential (hardware Q8 step) */
+#define ALGO_AWB_CCM_Q8_UNIT         (ISP_CCM_PRECISION_FACTOR / 256)
+
 /* Max acceptable sensor delay */
 #define ALGO_DELAY_MAX               10
 /* Number of delay test configurations */
-#define ALGO_DELAY_NB_CONFIG         12
+#define ALGO_DELAY_NB_CONFIG         ISP_ALGO_DELAY_NB_CONFIG
 /* Minimum Luminance update during delay test measurements */
 #define ALGO_DELAY_L_MARGIN          3
 
@@ -75,8 +84,9 @@ ISP_StatusTypeDef ISP_Algo_SensorDelay_Process(void *hIsp, void *pAlgo);
 #endif
 
 /* Private variables ---------------------------------------------------------*/
+/* The algorithm handles below are templates, copied into each ISP instance by ISP_Algo_Init() */
 /* Bad Pixel algorithm handle */
-ISP_AlgoTypeDef ISP_Algo_BadPixel = {
+static const ISP_AlgoTypeDef ISP_Algo_BadPixel = {
     .id = ISP_ALGO_ID_BADPIXEL,
     .Init = ISP_Algo_BadPixel_Init,
     .DeInit = ISP_Algo_BadPixel_DeInit,
@@ -85,7 +95,7 @@ ISP_AlgoTypeDef ISP_Algo_BadPixel = {
 
 #ifdef ISP_MW_SW_AEC_ALGO_SUPPORT
 /* AEC algorithm handle */
-ISP_AlgoTypeDef ISP_Algo_AEC = {
+static const ISP_AlgoTypeDef ISP_Algo_AEC = {
     .id = ISP_ALGO_ID_AEC,
     .Init = ISP_Algo_AEC_Init,
     .DeInit = ISP_Algo_AEC_DeInit,
@@ -95,7 +105,7 @@ ISP_AlgoTypeDef ISP_Algo_AEC = {
 
 #ifdef ISP_MW_SW_AWB_ALGO_SUPPORT
 /* AWB algorithm handle */
-ISP_AlgoTypeDef ISP_Algo_AWB = {
+static const ISP_AlgoTypeDef ISP_Algo_AWB = {
     .id = ISP_ALGO_ID_AWB,
     .Init = ISP_Algo_AWB_Init,
     .DeInit = ISP_Algo_AWB_DeInit,
@@ -105,7 +115,7 @@ ISP_AlgoTypeDef ISP_Algo_AWB = {
 
 #ifdef ISP_MW_TUNING_TOOL_SUPPORT
 /* Sensor Delay measurement algorithm handle */
-ISP_AlgoTypeDef ISP_Algo_SensorDelay = {
+static const ISP_AlgoTypeDef ISP_Algo_SensorDelay = {
     .id = ISP_ALGO_ID_SENSOR_DELAY,
     .Init = ISP_Algo_SensorDelay_Init,
     .DeInit = ISP_Algo_SensorDelay_DeInit,
@@ -113,15 +123,8 @@ ISP_AlgoTypeDef ISP_Algo_SensorDelay = {
 };
 #endif
 
-#ifdef ALGO_PERF_DBG_LOGS
-#define MEAS_ITERATION 10
-uint32_t tickstart;
-uint32_t duration[MEAS_ITERATION];
-uint32_t iter = 0;
-#endif
-
 /* Registered algorithm list */
-ISP_AlgoTypeDef *ISP_Algo_List[] = {
+static const ISP_AlgoTypeDef *const ISP_Algo_List[] = {
     &ISP_Algo_BadPixel,
 #ifdef ISP_MW_SW_AEC_ALGO_SUPPORT
     &ISP_Algo_AEC,
@@ -134,20 +137,6 @@ ISP_AlgoTypeDef *ISP_Algo_List[] = {
 #endif /* ISP_MW_TUNING_TOOL_SUPPORT */
 };
 
-#ifdef ISP_MW_SW_AEC_ALGO_SUPPORT
-/* Algo internal */
-static evision_st_ae_process_t *pIspAEprocess;
-#endif /* ISP_MW_SW_AEC_ALGO_SUPPORT */
-
-#ifdef ISP_MW_SW_AWB_ALGO_SUPPORT
-/* Algo internal */
-static evision_awb_estimator_t* pIspAWBestimator;
-#endif /* ISP_MW_SW_AWB_ALGO_SUPPORT */
-
-/* Global variables ----------------------------------------------------------*/
-uint32_t current_awb_profId = 0;
-ISP_MetaTypeDef Meta = {0};
-
 /* Private functions ---------------------------------------------------------*/
 /**
   * @brief  ISP_Algo_BadPixel_Init
@@ -189,10 +178,8 @@ ISP_StatusTypeDef ISP_Algo_BadPixel_DeInit(void *hIsp, void *pAlgo)
   */
 ISP_StatusTypeDef ISP_Algo_BadPixel_Process(void *hIsp, void *pAlgo)
 {
-  (void)hIsp; /* unused */
+  ISP_Algo_BadPixelContextTypeDef *ctx = &((ISP_HandleTypeDef *)hIsp)->algoContext.badPixel;
   (void)pAlgo; /* unused */
-  static uint32_t BadPixelCount, LastFrameId;
-  static int8_t Step;
   uint32_t CurrentFrameId;
   ISP_BadPixelTypeDef BadPixelConfig;
   ISP_IQParamTypeDef *IQParamConfig;
@@ -207,13 +194,13 @@ ISP_StatusTypeDef ISP_Algo_BadPixel_Process(void *hIsp, void *pAlgo)
 
   /* Wait for a new frame */
   CurrentFrameId = ISP_SVC_Misc_GetMainFrameId(hIsp);
-  if (CurrentFrameId == LastFrameId)
+  if (CurrentFrameId == ctx->lastFrameId)
   {
     return ISP_OK;
   }
-  LastFrameId = CurrentFrameId;
+  ctx->lastFrameId = CurrentFrameId;
 
-  if (Step++ >= 0)
+  if (ctx->step++ >= 0)
   {
     /* Measure the number of bad pixels */
     ret  = ISP_SVC_ISP_GetBadPixel(hIsp, &BadPixelConfig);
@@ -221,20 +208,20 @@ ISP_StatusTypeDef ISP_Algo_BadPixel_Process(void *hIsp, void *pAlgo)
     {
       return ret;
     }
-    BadPixelCount += BadPixelConfig.count;
+    ctx->badPixelCount += BadPixelConfig.count;
   }
 
-  if (Step == 10)
+  if (ctx->step == 10)
   {
     /* All measures done : make an average and compare with threshold */
-    BadPixelCount /= 10;
+    ctx->badPixelCount /= 10;
 
-    if ((BadPixelCount > IQParamConfig->badPixelAlgo.threshold) && (BadPixelConfig.strength > 0))
+    if ((ctx->badPixelCount > IQParamConfig->badPixelAlgo.threshold) && (BadPixelConfig.strength > 0))
     {
       /* Bad pixel is above target : decrease strength */
       BadPixelConfig.strength--;
     }
-    else if ((BadPixelCount < IQParamConfig->badPixelAlgo.threshold) && (BadPixelConfig.strength < ISP_BADPIXEL_STRENGTH_MAX - 1))
+    else if ((ctx->badPixelCount < IQParamConfig->badPixelAlgo.threshold) && (BadPixelConfig.strength < ISP_BADPIXEL_STRENGTH_MAX - 1))
     {
       /* Bad pixel is below target : increase strength. (exclude ISP_BADPIXEL_STRENGTH_MAX which gives weird results) */
       BadPixelConfig.strength++;
@@ -249,8 +236,8 @@ ISP_StatusTypeDef ISP_Algo_BadPixel_Process(void *hIsp, void *pAlgo)
     }
 
     /* Set Step to -1 to wait for an extra frame before a new measurement (the ISP HW needs one frame to update after reconfig) */
-    Step = -1;
-    BadPixelCount = 0;
+    ctx->step = -1;
+    ctx->badPixelCount = 0;
   }
 
   return ISP_OK;
@@ -275,6 +262,7 @@ static void log_cb(const char *const msg)
 ISP_StatusTypeDef ISP_Algo_AEC_Init(void *hIsp, void *pAlgo)
 {
   ISP_HandleTypeDef *pIsp_handle = (ISP_HandleTypeDef*) hIsp;
+  ISP_Algo_AECContextTypeDef *ctx = &pIsp_handle->algoContext.aec;
   ISP_AlgoTypeDef *algo = (ISP_AlgoTypeDef *)pAlgo;
   ISP_SensorExposureTypeDef exposureConfig;
   ISP_SensorGainTypeDef gainConfig;
@@ -290,28 +278,29 @@ ISP_StatusTypeDef ISP_Algo_AEC_Init(void *hIsp, void *pAlgo)
   }
 
   /* Create st_ae_process instance */
-  pIspAEprocess = evision_api_st_ae_new(log_cb);
-  if (pIspAEprocess == NULL)
+  ctx->pProcess = evision_api_st_ae_new(log_cb);
+  if (ctx->pProcess == NULL)
   {
     return ISP_ERR_ALGO;
   }
 
   /* Initialize st_ae_process instance */
-  e_ret = evision_api_st_ae_init(pIspAEprocess);
+  e_ret = evision_api_st_ae_init(ctx->pProcess);
   if (e_ret != EVISION_RET_SUCCESS)
   {
-    evision_api_st_ae_delete(pIspAEprocess);
+    evision_api_st_ae_delete(ctx->pProcess);
+    ctx->pProcess = NULL;
     return ISP_ERR_ALGO;
   }
 
   /* Configure algo (AEC target) */
-  pIspAEprocess->hyper_params.target = IQParamConfig->AECAlgo.exposureTarget;
+  ctx->pProcess->hyper_params.target = IQParamConfig->AECAlgo.exposureTarget;
 
   /* Configure algo (sensor config) */
-  pIspAEprocess->hyper_params.exposure_min = pIsp_handle->sensorInfo.exposure_min;
-  pIspAEprocess->hyper_params.exposure_max = pIsp_handle->sensorInfo.exposure_max;
-  pIspAEprocess->hyper_params.gain_min = pIsp_handle->sensorInfo.gain_min;
-  pIspAEprocess->hyper_params.gain_max = pIsp_handle->sensorInfo.gain_max;
+  ctx->pProcess->hyper_params.exposure_min = pIsp_handle->sensorInfo.exposure_min;
+  ctx->pProcess->hyper_params.exposure_max = pIsp_handle->sensorInfo.exposure_max;
+  ctx->pProcess->hyper_params.gain_min = pIsp_handle->sensorInfo.gain_min;
+  ctx->pProcess->hyper_params.gain_max = pIsp_handle->sensorInfo.gain_max;
 
   /* Initialize exposure and gain at min value */
   if (IQParamConfig->AECAlgo.enable == true)
@@ -339,12 +328,13 @@ ISP_StatusTypeDef ISP_Algo_AEC_Init(void *hIsp, void *pAlgo)
   */
 ISP_StatusTypeDef ISP_Algo_AEC_DeInit(void *hIsp, void *pAlgo)
 {
-  (void)hIsp; /* unused */
+  ISP_Algo_AECContextTypeDef *ctx = &((ISP_HandleTypeDef *)hIsp)->algoContext.aec;
   (void)pAlgo; /* unused */
 
-  if (pIspAEprocess != NULL)
+  if (ctx->pProcess != NULL)
   {
-    evision_api_st_ae_delete(pIspAEprocess);
+    evision_api_st_ae_delete(ctx->pProcess);
+    ctx->pProcess = NULL;
   }
   return ISP_OK;
 }
@@ -373,16 +363,15 @@ ISP_StatusTypeDef ISP_Algo_AEC_StatCb(ISP_AlgoTypeDef *pAlgo)
   */
 ISP_StatusTypeDef ISP_Algo_AEC_Process(void *hIsp, void *pAlgo)
 {
-  static ISP_SVC_StatStateTypeDef stats;
+  ISP_HandleTypeDef *pIsp_handle = (ISP_HandleTypeDef *)hIsp;
+  ISP_Algo_AECContextTypeDef *ctx = &pIsp_handle->algoContext.aec;
   ISP_AlgoTypeDef *algo = (ISP_AlgoTypeDef *)pAlgo;
   ISP_IQParamTypeDef *IQParamConfig;
   ISP_StatusTypeDef ret = ISP_OK;
   ISP_SensorGainTypeDef gainConfig;
   ISP_SensorExposureTypeDef exposureConfig;
   uint32_t avgL;
-#ifdef ALGO_AEC_DBG_LOGS
-  static uint32_t currentL;
-#endif
+  uint8_t applied;
   evision_return_t e_ret;
 
   IQParamConfig = ISP_SVC_IQParam_Get(hIsp);
@@ -396,7 +385,7 @@ ISP_StatusTypeDef ISP_Algo_AEC_Process(void *hIsp, void *pAlgo)
   case ISP_ALGO_STATE_INIT:
   case ISP_ALGO_STATE_NEED_STAT:
     /* Ask for stats */
-    ret = ISP_SVC_Stats_GetNext(hIsp, &ISP_Algo_AEC_StatCb, pAlgo, &stats, ISP_STAT_LOC_DOWN,
+    ret = ISP_SVC_Stats_GetNext(hIsp, &ISP_Algo_AEC_StatCb, pAlgo, &ctx->stats, ISP_STAT_LOC_DOWN,
                                 ISP_STAT_TYPE_AVG, IQParamConfig->sensorDelay.delay);
     if (ret != ISP_OK)
     {
@@ -413,13 +402,15 @@ ISP_StatusTypeDef ISP_Algo_AEC_Process(void *hIsp, void *pAlgo)
 
   case ISP_ALGO_STATE_STAT_READY:
     /* Align on the target update (may have been updated with ISP_SetExposureTarget()) */
-    pIspAEprocess->hyper_params.target = IQParamConfig->AECAlgo.exposureTarget;
-    avgL = stats.down.averageL;
+    ctx->pProcess->hyper_params.target = IQParamConfig->AECAlgo.exposureTarget;
+    /* Align on the exposure ceiling (may have been updated with ISP_SetExposureMax()) */
+    ctx->pProcess->hyper_params.exposure_max = pIsp_handle->sensorInfo.exposure_max;
+    avgL = ctx->stats.down.averageL;
 #ifdef ALGO_AEC_DBG_LOGS
-    if (avgL != currentL)
+    if (avgL != ctx->currentL)
     {
       printf("L = %ld\r\n", avgL);
-      currentL = avgL;
+      ctx->currentL = avgL;
     }
 #endif
     /* Read the current sensor gain */
@@ -436,48 +427,56 @@ ISP_StatusTypeDef ISP_Algo_AEC_Process(void *hIsp, void *pAlgo)
     }
 
     /* Store meta data */
-    Meta.averageL = avgL;
-    Meta.exposureTarget = IQParamConfig->AECAlgo.exposureTarget;
+    pIsp_handle->svcContext.meta.averageL = avgL;
+    pIsp_handle->svcContext.meta.exposureTarget = IQParamConfig->AECAlgo.exposureTarget;
 
     /* Run algo to calculate new gain and exposure */
-    e_ret = evision_api_st_ae_process(pIspAEprocess, gainConfig.gain, exposureConfig.exposure, avgL);
+    e_ret = evision_api_st_ae_process(ctx->pProcess, gainConfig.gain, exposureConfig.exposure, avgL);
     if (e_ret == EVISION_RET_SUCCESS)
     {
-      if (gainConfig.gain != pIspAEprocess->new_gain)
+      applied = 0;
+      if (gainConfig.gain != ctx->pProcess->new_gain)
       {
         /* Set new gain */
-        gainConfig.gain = pIspAEprocess->new_gain;
+        gainConfig.gain = ctx->pProcess->new_gain;
 
         ret = ISP_SVC_Sensor_SetGain(hIsp, &gainConfig);
         if (ret != ISP_OK)
         {
           return ret;
         }
+        applied = 1;
 
 #ifdef ALGO_AEC_DBG_LOGS
         printf("New gain = %ld\r\n", gainConfig.gain);
 #endif
       }
 
-      if (exposureConfig.exposure != pIspAEprocess->new_exposure)
+      if (exposureConfig.exposure != ctx->pProcess->new_exposure)
       {
         /* Set new exposure */
-        exposureConfig.exposure = pIspAEprocess->new_exposure;
+        exposureConfig.exposure = ctx->pProcess->new_exposure;
 
         ret = ISP_SVC_Sensor_SetExposure(hIsp, &exposureConfig);
         if (ret != ISP_OK)
         {
           return ret;
         }
+        applied = 1;
 
 #ifdef ALGO_AEC_DBG_LOGS
         printf("New exposure = %ld\r\n", exposureConfig.exposure);
 #endif
       }
+
+      if (applied)
+      {
+        ISP_SVC_Misc_TraceEvent(hIsp, ISP_TRACE_AEC_APPLY);
+      }
     }
 
     /* Ask for stats */
-    ret = ISP_SVC_Stats_GetNext(hIsp, &ISP_Algo_AEC_StatCb, pAlgo, &stats, ISP_STAT_LOC_DOWN,
+    ret = ISP_SVC_Stats_GetNext(hIsp, &ISP_Algo_AEC_StatCb, pAlgo, &ctx->stats, ISP_STAT_LOC_DOWN,
                                 ISP_STAT_TYPE_AVG, IQParamConfig->sensorDelay.delay);
 
     /* Wait for stats to be ready */
@@ -490,6 +489,43 @@ ISP_StatusTypeDef ISP_Algo_AEC_Process(void *hIsp, void *pAlgo)
 #endif /* ISP_MW_SW_AEC_ALGO_SUPPORT */
 
 #ifdef ISP_MW_SW_AWB_ALGO_SUPPORT
+/* 255 * pow(comp / 255, 1 / 2.2) in Q16 for comp in [0-255], computed offline with the float
+ * division of the former pow() based implementation. Max error vs pow(): 2^-17. */
+static const uint32_t ISP_Algo_GammaInverseLUT[256] = {
+         0U,  1346289U,  1844888U,  2218255U,  2528144U,  2798027U,  3039788U,  3260421U,
+   3464445U,  3654978U,  3834279U,  4004041U,  4165577U,  4319924U,  4467921U,  4610257U,
+   4747506U,  4880150U,  5008603U,  5133220U,  5254308U,  5372136U,  5486942U,  5598935U,
+   5708302U,  5815211U,  5919812U,  6022241U,  6122620U,  6221063U,  6317670U,  6412537U,
+   6505749U,  6597385U,  6687519U,  6776217U,  6863544U,  6949558U,  7034313U,  7117859U,
+   7200246U,  7281516U,  7361712U,  7440873U,  7519036U,  7596236U,  7672506U,  7747877U,
+   7822378U,  7896037U,  7968880U,  8040934U,  8112220U,  8182763U,  8252583U,  8321702U,
+   8390139U,  8457912U,  8525039U,  8591539U,  8657426U,  8722717U,  8787427U,  8851569U,
+   8915160U,  8978210U,  9040733U,  9102742U,  9164248U,  9225262U,  9285796U,  9345860U,
+   9405465U,  9464619U,  9523334U,  9581617U,  9639477U,  9696924U,  9753966U,  9810609U,
+   9866864U,  9922735U,  9978232U, 10033361U, 10088129U, 10142542U, 10196607U, 10250331U,
+  10303718U, 10356776U, 10409509U, 10461924U, 10514026U, 10565820U, 10617310U, 10668503U,
+  10719403U, 10770014U, 10820342U, 10870390U, 10920163U, 10969665U, 11018901U, 11067874U,
+  11116589U, 11165049U, 11213257U, 11261218U, 11308936U, 11356413U, 11403653U, 11450659U,
+  11497435U, 11543983U, 11590308U, 11636411U, 11682296U, 11727966U, 11773423U, 11818671U,
+  11863712U, 11908549U, 11953184U, 11997619U, 12041859U, 12085904U, 12129757U, 12173421U,
+  12216898U, 12260189U, 12303299U, 12346227U, 12388977U, 12431551U, 12473951U, 12516179U,
+  12558236U, 12600125U, 12641847U, 12683405U, 12724800U, 12766034U, 12807109U, 12848026U,
+  12888788U, 12929396U, 12969851U, 13010155U, 13050310U, 13090317U, 13130178U, 13169894U,
+  13209467U, 13248899U, 13288190U, 13327342U, 13366356U, 13405235U, 13443978U, 13482588U,
+  13521066U, 13559413U, 13597630U, 13635719U, 13673680U, 13711516U, 13749226U, 13786813U,
+  13824277U, 13861620U, 13898843U, 13935946U, 13972931U, 14009799U, 14046551U, 14083188U,
+  14119711U, 14156120U, 14192418U, 14228605U, 14264682U, 14300649U, 14336508U, 14372260U,
+  14407906U, 14443446U, 14478881U, 14514213U, 14549442U, 14584568U, 14619594U, 14654519U,
+  14689344U, 14724071U, 14758700U, 14793231U, 14827666U, 14862005U, 14896249U, 14930400U,
+  14964456U, 14998420U, 15032292U, 15066072U, 15099762U, 15133362U, 15166873U, 15200295U,
+  15233629U, 15266875U, 15300035U, 15333110U, 15366098U, 15399002U, 15431822U, 15464558U,
+  15497211U, 15529782U, 15562271U, 15594679U, 15627007U, 15659254U, 15691422U, 15723510U,
+  15755521U, 15787453U, 15819309U, 15851087U, 15882789U, 15914416U, 15945967U, 15977444U,
+  16008846U, 16040174U, 16071430U, 16102612U, 16133722U, 16164761U, 16195728U, 16226624U,
+  16257449U, 16288205U, 16318891U, 16349508U, 16380057U, 16410537U, 16440950U, 16471295U,
+  16501573U, 16531784U, 16561930U, 16592010U, 16622024U, 16651974U, 16681859U, 16711680U
+};
+
 /**
   * @brief  ISP_Algo_ApplyGammaInverse
   *         Apply Gamma 1/2.2 correction to a component value
@@ -503,7 +539,8 @@ double ISP_Algo_ApplyGammaInverse(ISP_HandleTypeDef *hIsp, uint32_t comp)
 
   /* Check if gamma is enabled */
   if (ISP_SVC_Misc_IsGammaEnabled(hIsp, 1 /*main pipe*/) != 0) {
-    out = 255 * pow((float)comp / 255, 1.0 / 2.2);
+    comp = (comp > 255) ? 255 : comp;
+    out = (double) ISP_Algo_GammaInverseLUT[comp] * (1.0 / (1 << ALGO_AWB_GAMMA_LUT_SHIFT));
   }
   else
   {
@@ -567,27 +604,50 @@ void ISP_Algo_GetUpStat(ISP_HandleTypeDef *hIsp, ISP_SVC_StatStateTypeDef *pStat
 void ISP_Algo_ApplyCConv(ISP_HandleTypeDef *hIsp, uint32_t inR, uint32_t inG, uint32_t inB, uint32_t *outR, uint32_t *outG, uint32_t *outB)
 {
   ISP_ColorConvTypeDef colorConv;
-  int64_t ccR, ccG, ccB;
+  int32_t ccm[3][4] = { 0 }; /* Q15 coefficients, one column per input component, padded to 4 */
+  int32_t cc[4];
+  uint32_t i, j;
 
   if ((ISP_SVC_ISP_GetColorConv(hIsp, &colorConv) == ISP_OK) && (colorConv.enable == 1))
   {
-    /* Apply ColorConversion matrix to the input components */
-    ccR = (int64_t) inR * colorConv.coeff[0][0] + (int64_t) inG * colorConv.coeff[0][1] + (int64_t) inB * colorConv.coeff[0][2];
-    ccG = (int64_t) inR * colorConv.coeff[1][0] + (int64_t) inG * colorConv.coeff[1][1] + (int64_t) inB * colorConv.coeff[1][2];
-    ccB = (int64_t) inR * colorConv.coeff[2][0] + (int64_t) inG * colorConv.coeff[2][1] + (int64_t) inB * colorConv.coeff[2][2];
-
-    ccR /= ISP_CCM_PRECISION_FACTOR;
-    ccG /= ISP_CCM_PRECISION_FACTOR;
-    ccB /= ISP_CCM_PRECISION_FACTOR;
-
-    /* Clamp values to 0-255 */
-    ccR = (ccR < 0) ? 0 : (ccR > 255) ? 255 : ccR;
-    ccG = (ccG < 0) ? 0 : (ccG > 255) ? 255 : ccG;
-    ccB = (ccB < 0) ? 0 : (ccB > 255) ? 255 : ccB;
-
-    *outR = (uint32_t) ccR;
-    *outG = (uint32_t) ccG;
-    *outB = (uint32_t) ccB;
+    /* Convert the coefficients to Q15. Those read back from the hardware are multiples of the Q8
+     * register step, so the conversion and the result are exact. */
+    for (i = 0; i < 3; i++)
+    {
+      for (j = 0; j < 3; j++)
+      {
+        ccm[j][i] = (colorConv.coeff[i][j] / ALGO_AWB_CCM_Q8_UNIT) * (1 << (ALGO_AWB_CCM_SHIFT - 8));
+      }
+    }
+
+    /* Apply ColorConversion matrix to the input components (|coeff| <= 4.0: no 32-bit overflow).
+     * A floor shift is used: it only differs from the division for negative values, clamped to 0 */
+#if defined(__ARM_FEATURE_MVE)
+    {
+      int32x4_t acc;
+
+      acc = vmulq_n_s32(vldrwq_s32(ccm[0]), (int32_t) inR);
+      acc = vmlaq_n_s32(acc, vldrwq_s32(ccm[1]), (int32_t) inG);
+      acc = vmlaq_n_s32(acc, vldrwq_s32(ccm[2]), (int32_t) inB);
+      acc = vshrq_n_s32(acc, ALGO_AWB_CCM_SHIFT);
+
+      /* Clamp values to 0-255 */
+      acc = vmaxq_s32(vminq_s32(acc, vdupq_n_s32(255)), vdupq_n_s32(0));
+      vstrwq_s32(cc, acc);
+    }
+#else
+    for (i = 0; i < 3; i++)
+    {
+      cc[i] = ((int32_t) inR * ccm[0][i] + (int32_t) inG * ccm[1][i] + (int32_t) inB * ccm[2][i]) >> ALGO_AWB_CCM_SHIFT;
+
+      /* Clamp values to 0-255 */
+      cc[i] = (cc[i] < 0) ? 0 : (cc[i] > 255) ? 255 : cc[i];
+    }
+#endif
+
+    *outR = (uint32_t) cc[0];
+    *outG = (uint32_t) cc[1];
+    *outB = (uint32_t) cc[2];
   }
   else
   {
@@ -606,15 +666,16 @@ void ISP_Algo_ApplyCConv(ISP_HandleTypeDef *hIsp, uint32_t inR, uint32_t inG, ui
   */
 ISP_StatusTypeDef ISP_Algo_AWB_Init(void *hIsp, void *pAlgo)
 {
-  (void)hIsp; /* unused */
+  ISP_Algo_AWBContextTypeDef *ctx = &((ISP_HandleTypeDef *)hIsp)->algoContext.awb;
   ISP_AlgoTypeDef *algo = (ISP_AlgoTypeDef *)pAlgo;
 
   /* Create estimator */
-  pIspAWBestimator = evision_api_awb_new(log_cb);
-  if (pIspAWBestimator == NULL)
+  ctx->pEstimator = evision_api_awb_new(log_cb);
+  if (ctx->pEstimator == NULL)
   {
     return ISP_ERR_ALGO;
   }
+  ctx->skipStatCheckCount = ALGO_AWB_STAT_CHECK_SKIP_AFTER_INIT;
 
   /* Continue the initialization in ISP_Algo_AWB_Process() function when state is ISP_ALGO_STATE_INIT.
    * This allows to read the IQ params after an algo stop/start cycle */
@@ -632,12 +693,13 @@ ISP_StatusTypeDef ISP_Algo_AWB_Init(void *hIsp, void *pAlgo)
   */
 ISP_StatusTypeDef ISP_Algo_AWB_DeInit(void *hIsp, void *pAlgo)
 {
-  (void)hIsp; /* unused */
+  ISP_Algo_AWBContextTypeDef *ctx = &((ISP_HandleTypeDef *)hIsp)->algoContext.awb;
   (void)pAlgo; /* unused */
 
-  if (pIspAWBestimator != NULL)
+  if (ctx->pEstimator != NULL)
   {
-    evision_api_awb_delete(pIspAWBestimator);
+    evision_api_awb_delete(ctx->pEstimator);
+    ctx->pEstimator = NULL;
   }
 
   return ISP_OK;
@@ -670,12 +732,8 @@ ISP_StatusTypeDef ISP_Algo_AWB_StatCb(ISP_AlgoTypeDef *pAlgo)
   */
 ISP_StatusTypeDef ISP_Algo_AWB_Process(void *hIsp, void *pAlgo)
 {
-  static ISP_SVC_StatStateTypeDef stats;
-  static uint8_t enableCurrent = false;
-  static uint8_t reconfigureRequest = false;
-  static uint32_t currentColorTemp = 0;
-  static evision_awb_profile_t awbProfiles[ISP_AWB_COLORTEMP_REF];
-  static float colorTempThresholds[ISP_AWB_COLORTEMP_REF - 1];
+  ISP_HandleTypeDef *pIsp_handle = (ISP_HandleTypeDef *)hIsp;
+  ISP_Algo_AWBContextTypeDef *ctx = &pIsp_handle->algoContext.awb;
   ISP_IQParamTypeDef *IQParamConfig;
   ISP_ColorConvTypeDef ColorConvConfig;
   ISP_ISPGainTypeDef ISPGainConfig;
@@ -685,24 +743,21 @@ ISP_StatusTypeDef ISP_Algo_AWB_Process(void *hIsp, void *pAlgo)
   uint32_t ccAvgR, ccAvgG, ccAvgB, colorTemp, i, j, profId, profNb;
   float cfaGains[4], ccmCoeffs[3][3], ccmOffsets[3] = { 0 };
   double meas[3];
-  static uint32_t statsHistory[3][3] = { 0 };
-  static uint32_t colorTempHistory[2] = { 0 };
-  static uint8_t skip_stat_check_count = ALGO_AWB_STAT_CHECK_SKIP_AFTER_INIT;
 
   IQParamConfig = ISP_SVC_IQParam_Get(hIsp);
 
   if (IQParamConfig->AWBAlgo.enable == false)
   {
-    enableCurrent = false;
+    ctx->enableCurrent = false;
     return ISP_OK;
   }
-  else if ((enableCurrent == false) || (IQParamConfig->AWBAlgo.enable == ISP_AWB_ENABLE_RECONFIGURE))
+  else if ((ctx->enableCurrent == false) || (IQParamConfig->AWBAlgo.enable == ISP_AWB_ENABLE_RECONFIGURE))
   {
     /* Start or resume algo : set state to INIT in order to read the IQ params */
     algo->state = ISP_ALGO_STATE_INIT;
     IQParamConfig->AWBAlgo.enable = true;
-    reconfigureRequest = true;
-    enableCurrent = true;
+    ctx->reconfigureRequest = true;
+    ctx->enableCurrent = true;
   }
 
   switch(algo->state)
@@ -719,7 +774,7 @@ ISP_StatusTypeDef ISP_Algo_AWB_Process(void *hIsp, void *pAlgo)
       if (profNb > 0)
       {
         /* Profile decision threshold = lowest ref. temperature + 1/4 of the distance between two reference temperatures */
-        colorTempThresholds[profNb - 1] = (float) ((colorTemp + 3 * IQParamConfig->AWBAlgo.referenceColorTemp[profId - 1]) /4 );
+        ctx->colorTempThresholds[profNb - 1] = (float) ((colorTemp + 3 * IQParamConfig->AWBAlgo.referenceColorTemp[profId - 1]) /4 );
       }
 
       /* Set cfa gains (RGGB) */
@@ -738,7 +793,7 @@ ISP_StatusTypeDef ISP_Algo_AWB_Process(void *hIsp, void *pAlgo)
       }
 
       /* Set profile */
-      evision_api_awb_set_profile(&awbProfiles[profId], (float) colorTemp, cfaGains, ccmCoeffs, ccmOffsets);
+      evision_api_awb_set_profile(&ctx->profiles[profId], (float) colorTemp, cfaGains, ccmCoeffs, ccmOffsets);
       profNb++;
     }
 
@@ -748,22 +803,22 @@ ISP_StatusTypeDef ISP_Algo_AWB_Process(void *hIsp, void *pAlgo)
     }
 
     /* Register profiles */
-    e_ret = evision_api_awb_init_profiles(pIspAWBestimator, (double) IQParamConfig->AWBAlgo.referenceColorTemp[0],
+    e_ret = evision_api_awb_init_profiles(ctx->pEstimator, (double) IQParamConfig->AWBAlgo.referenceColorTemp[0],
                                           (double) IQParamConfig->AWBAlgo.referenceColorTemp[profNb - 1], profNb,
-                                          colorTempThresholds, awbProfiles);
+                                          ctx->colorTempThresholds, ctx->profiles);
     if (e_ret != EVISION_RET_SUCCESS)
     {
       return ISP_ERR_ALGO;
     }
 
     /* Configure algo */
-    pIspAWBestimator->hyper_params.speed_p_min = 1.35;
-    pIspAWBestimator->hyper_params.speed_p_max = (profNb < 4)? 1.8 : 2.0;
-    pIspAWBestimator->hyper_params.gm_tolerance = 1;
-    pIspAWBestimator->hyper_params.conv_criterion = 3;
+    ctx->pEstimator->hyper_params.speed_p_min = 1.35;
+    ctx->pEstimator->hyper_params.speed_p_max = (profNb < 4)? 1.8 : 2.0;
+    ctx->pEstimator->hyper_params.gm_tolerance = 1;
+    ctx->pEstimator->hyper_params.conv_criterion = 3;
 
     /* Ask for stats */
-    ret = ISP_SVC_Stats_GetNext(hIsp, &ISP_Algo_AWB_StatCb, pAlgo, &stats, ISP_STAT_LOC_DOWN,
+    ret = ISP_SVC_Stats_GetNext(hIsp, &ISP_Algo_AWB_StatCb, pAlgo, &ctx->stats, ISP_STAT_LOC_DOWN,
                                 ISP_STAT_TYPE_AVG, ALGO_ISP_LATENCY + ALGO_AWB_ADDITIONAL_LATENCY);
     if (ret != ISP_OK)
     {
@@ -775,7 +830,7 @@ ISP_StatusTypeDef ISP_Algo_AWB_Process(void *hIsp, void *pAlgo)
     break;
 
   case ISP_ALGO_STATE_NEED_STAT:
-    ret = ISP_SVC_Stats_GetNext(hIsp, &ISP_Algo_AWB_StatCb, pAlgo, &stats, ISP_STAT_LOC_DOWN,
+    ret = ISP_SVC_Stats_GetNext(hIsp, &ISP_Algo_AWB_StatCb, pAlgo, &ctx->stats, ISP_STAT_LOC_DOWN,
                                 ISP_STAT_TYPE_AVG, ALGO_ISP_LATENCY + ALGO_AWB_ADDITIONAL_LATENCY);
     if (ret != ISP_OK)
     {
@@ -791,18 +846,18 @@ ISP_StatusTypeDef ISP_Algo_AWB_Process(void *hIsp, void *pAlgo)
     break;
 
   case ISP_ALGO_STATE_STAT_READY:
-    ISP_Algo_GetUpStat(hIsp, &stats);
+    ISP_Algo_GetUpStat(hIsp, &ctx->stats);
 
-    if (!(!skip_stat_check_count && (abs(stats.up.averageR - statsHistory[0][0]) <= 2) && (abs(stats.up.averageG - statsHistory[0][1]) <= 2) && (abs(stats.up.averageB - statsHistory[0][2]) <= 2)
-        && (abs(stats.up.averageR - statsHistory[1][0]) <= 2) && (abs(stats.up.averageG - statsHistory[1][1]) <= 2) && (abs(stats.up.averageB - statsHistory[1][2]) <= 2)
-        && (abs(stats.up.averageR - statsHistory[2][0]) <= 2) && (abs(stats.up.averageG - statsHistory[2][1]) <= 2) && (abs(stats.up.averageB - statsHistory[2][2]) <= 2)))
+    if (!(!ctx->skipStatCheckCount && (abs(ctx->stats.up.averageR - ctx->statsHistory[0][0]) <= 2) && (abs(ctx->stats.up.averageG - ctx->statsHistory[0][1]) <= 2) && (abs(ctx->stats.up.averageB - ctx->statsHistory[0][2]) <= 2)
+        && (abs(ctx->stats.up.averageR - ctx->statsHistory[1][0]) <= 2) && (abs(ctx->stats.up.averageG - ctx->statsHistory[1][1]) <= 2) && (abs(ctx->stats.up.averageB - ctx->statsHistory[1][2]) <= 2)
+        && (abs(ctx->stats.up.averageR - ctx->statsHistory[2][0]) <= 2) && (abs(ctx->stats.up.averageG - ctx->statsHistory[2][1]) <= 2) && (abs(ctx->stats.up.averageB - ctx->statsHistory[2][2]) <= 2)))
     {
-        statsHistory[2][0] = stats.up.averageR;
-        statsHistory[2][1] = stats.up.averageG;
-        statsHistory[2][2] = stats.up.averageB;
+        ctx->statsHistory[2][0] = ctx->stats.up.averageR;
+        ctx->statsHistory[2][1] = ctx->stats.up.averageG;
+        ctx->statsHistory[2][2] = ctx->stats.up.averageB;
 
         /* Get stats after color conversion */
-        ISP_Algo_ApplyCConv(hIsp, stats.down.averageR, stats.down.averageG, stats.down.averageB, &ccAvgR, &ccAvgG, &ccAvgB);
+        ISP_Algo_ApplyCConv(hIsp, ctx->stats.down.averageR, ctx->stats.down.averageG, ctx->stats.down.averageB, &ccAvgR, &ccAvgG, &ccAvgB);
 
         /* Apply gamma */
         meas[0] = ISP_Algo_ApplyGammaInverse(hIsp, ccAvgR);
@@ -810,7 +865,7 @@ ISP_StatusTypeDef ISP_Algo_AWB_Process(void *hIsp, void *pAlgo)
         meas[2] = ISP_Algo_ApplyGammaInverse(hIsp, ccAvgB);
 
         /* Run algo to estimate gain and color conversion to apply */
-        e_ret = evision_api_awb_run_average(pIspAWBestimator, NULL, 1, meas);
+        e_ret = evision_api_awb_run_average(ctx->pEstimator, NULL, 1, meas);
         if (e_ret == EVISION_RET_SUCCESS)
         {
 #ifdef ALGO_AWB_DBG_LOGS
@@ -818,10 +873,10 @@ ISP_StatusTypeDef ISP_Algo_AWB_Process(void *hIsp, void *pAlgo)
           static int nb_colortemp_change[ISP_AWB_COLORTEMP_REF];
 
           nb_meas++;
-          if (pIspAWBestimator->out_temp != currentColorTemp)
+          if (ctx->pEstimator->out_temp != ctx->currentColorTemp)
             nb_changes++;
           for (int i = 0; i < ISP_AWB_COLORTEMP_REF; i++) {
-            if (pIspAWBestimator->out_temp == IQParamConfig->AWBAlgo.referenceColorTemp[i])
+            if (ctx->pEstimator->out_temp == IQParamConfig->AWBAlgo.referenceColorTemp[i])
             {
               nb_colortemp_change[i]++;
               continue;
@@ -845,28 +900,28 @@ ISP_StatusTypeDef ISP_Algo_AWB_Process(void *hIsp, void *pAlgo)
             }
           }
 #endif
-          if (pIspAWBestimator->out_temp != currentColorTemp || reconfigureRequest == true)
+          if (ctx->pEstimator->out_temp != ctx->currentColorTemp || ctx->reconfigureRequest == true)
           {
             /* Force to apply a WB profile when reconfigureRequest is true */
-            reconfigureRequest = false;
+            ctx->reconfigureRequest = false;
 #ifdef ALGO_AWB_DBG_LOGS
-            printf("Color temperature = %ld\r\n", (uint32_t) pIspAWBestimator->out_temp);
+            printf("Color temperature = %ld\r\n", (uint32_t) ctx->pEstimator->out_temp);
 #endif
-            if (pIspAWBestimator->out_temp == colorTempHistory[1])
+            if (ctx->pEstimator->out_temp == ctx->colorTempHistory[1])
             {
-              skip_stat_check_count = 0; //oscillation detected
+              ctx->skipStatCheckCount = 0; //oscillation detected
             }
             else
             {
-              if (skip_stat_check_count <= ALGO_AWB_STAT_CHECK_SKIP_AFTER_CT_ESTIMATION) skip_stat_check_count = ALGO_AWB_STAT_CHECK_SKIP_AFTER_CT_ESTIMATION;
+              if (ctx->skipStatCheckCount <= ALGO_AWB_STAT_CHECK_SKIP_AFTER_CT_ESTIMATION) ctx->skipStatCheckCount = ALGO_AWB_STAT_CHECK_SKIP_AFTER_CT_ESTIMATION;
 
               /* Store meta data */
-              Meta.colorTemp = (uint32_t) pIspAWBestimator->out_temp;
+              pIsp_handle->svcContext.meta.colorTemp = (uint32_t) ctx->pEstimator->out_temp;
 
               /* Find the index profile for this referenceColorTemp */
               for (profId = 0; profId < ISP_AWB_COLORTEMP_REF; profId++)
               {
-                if (pIspAWBestimator->out_temp == IQParamConfig->AWBAlgo.referenceColorTemp[profId])
+                if (ctx->pEstimator->out_temp == IQParamConfig->AWBAlgo.referenceColorTemp[profId])
                   break;
               }
 
@@ -892,8 +947,9 @@ ISP_StatusTypeDef ISP_Algo_AWB_Process(void *hIsp, void *pAlgo)
                   ret = ISP_SVC_ISP_SetGain(hIsp, &ISPGainConfig);
                   if (ret == ISP_OK)
                   {
-                    currentColorTemp = (uint32_t) pIspAWBestimator->out_temp ;
-                    current_awb_profId = profId;
+                    ctx->currentColorTemp = (uint32_t) ctx->pEstimator->out_temp ;
+                    ctx->currentProfId = profId;
+                    ISP_SVC_Misc_TraceEvent(hIsp, ISP_TRACE_AWB_APPLY);
                   }
                 }
               }
@@ -907,20 +963,20 @@ ISP_StatusTypeDef ISP_Algo_AWB_Process(void *hIsp, void *pAlgo)
     }
 
     /* Decrease counter to limit the number of estimations before reaching convergence */
-    if (skip_stat_check_count > 0) skip_stat_check_count--;
+    if (ctx->skipStatCheckCount > 0) ctx->skipStatCheckCount--;
 
     /* Store history to be able to detect variations*/
-    statsHistory[1][0] = statsHistory[0][0];
-    statsHistory[1][1] = statsHistory[0][1];
-    statsHistory[1][2] = statsHistory[0][2];
-    statsHistory[0][0] = stats.up.averageR;
-    statsHistory[0][1] = stats.up.averageG;
-    statsHistory[0][2] = stats.up.averageB;
-    colorTempHistory[1] = colorTempHistory[0];
-    colorTempHistory[0] = currentColorTemp;
+    ctx->statsHistory[1][0] = ctx->statsHistory[0][0];
+    ctx->statsHistory[1][1] = ctx->statsHistory[0][1];
+    ctx->statsHistory[1][2] = ctx->statsHistory[0][2];
+    ctx->statsHistory[0][0] = ctx->stats.up.averageR;
+    ctx->statsHistory[0][1] = ctx->stats.up.averageG;
+    ctx->statsHistory[0][2] = ctx->stats.up.averageB;
+    ctx->colorTempHistory[1] = ctx->colorTempHistory[0];
+    ctx->colorTempHistory[0] = ctx->currentColorTemp;
 
     /* Ask for stats */
-    ret_stat = ISP_SVC_Stats_GetNext(hIsp, &ISP_Algo_AWB_StatCb, pAlgo, &stats, ISP_STAT_LOC_DOWN,
+    ret_stat = ISP_SVC_Stats_GetNext(hIsp, &ISP_Algo_AWB_StatCb, pAlgo, &ctx->stats, ISP_STAT_LOC_DOWN,
                                      ISP_STAT_TYPE_AVG, ALGO_ISP_LATENCY + ALGO_AWB_ADDITIONAL_LATENCY);
     ret = (ret != ISP_OK) ? ret : ret_stat;
 
@@ -996,15 +1052,9 @@ ISP_StatusTypeDef ISP_Algo_SensorDelay_Process(void *hIsp, void *pAlgo)
   ISP_StatusTypeDef ret = ISP_OK;
   uint8_t sensorDelay;
   int32_t avgL, i;
-  static int32_t refL, delay, delays[ALGO_DELAY_NB_CONFIG - 1], configId;
-  static ISP_SensorExposureTypeDef configExposure[ALGO_DELAY_NB_CONFIG];
-  static ISP_SensorGainTypeDef configGain[ALGO_DELAY_NB_CONFIG];
-  static ISP_SensorExposureTypeDef prevExposureConfig;
-  static ISP_SensorGainTypeDef prevGainConfig;
-  static uint8_t prevAECStatus, prevAWBStatus;
-  static ISP_SVC_StatStateTypeDef stats;
-
-  if (ISP_SVC_Misc_SensorDelayMeasureIsRunning() == false)
+  ISP_Algo_SensorDelayContextTypeDef *ctx = &((ISP_HandleTypeDef *)hIsp)->algoContext.sensorDelay;
+
+  if (ISP_SVC_Misc_SensorDelayMeasureIsRunning(hIsp) == false)
   {
     return ISP_OK;
   }
@@ -1015,14 +1065,14 @@ ISP_StatusTypeDef ISP_Algo_SensorDelay_Process(void *hIsp, void *pAlgo)
   {
   case ISP_ALGO_STATE_INIT:
     /* Get current AEC and AWB algo status and sensor configuration */
-    prevAECStatus = IQParamConfig->AECAlgo.enable;
-    prevAWBStatus = IQParamConfig->AWBAlgo.enable;
-    ret = ISP_SVC_Sensor_GetGain(hIsp, &prevGainConfig);
+    ctx->prevAECStatus = IQParamConfig->AECAlgo.enable;
+    ctx->prevAWBStatus = IQParamConfig->AWBAlgo.enable;
+    ret = ISP_SVC_Sensor_GetGain(hIsp, &ctx->prevGainConfig);
     if (ret != ISP_OK)
     {
       return ret;
     }
-    ret = ISP_SVC_Sensor_GetExposure(hIsp, &prevExposureConfig);
+    ret = ISP_SVC_Sensor_GetExposure(hIsp, &ctx->prevExposureConfig);
     if (ret != ISP_OK)
     {
       return ret;
@@ -1042,30 +1092,30 @@ ISP_StatusTypeDef ISP_Algo_SensorDelay_Process(void *hIsp, void *pAlgo)
      */
     for (i = 0; i < 6; i++)
     {
-      configExposure[i].exposure = i ? (pSensorInfo->exposure_max * 20 * i) / 100 : pSensorInfo->exposure_min;
-      configGain[i].gain = pSensorInfo->gain_min;
-      configExposure[i + 6].exposure = pSensorInfo->exposure_max;
-      configGain[i + 6].gain = (pSensorInfo->gain_max * 10 * (i + 1)) / 100;
+      ctx->configExposure[i].exposure = i ? (pSensorInfo->exposure_max * 20 * i) / 100 : pSensorInfo->exposure_min;
+      ctx->configGain[i].gain = pSensorInfo->gain_min;
+      ctx->configExposure[i + 6].exposure = pSensorInfo->exposure_max;
+      ctx->configGain[i + 6].gain = (pSensorInfo->gain_max * 10 * (i + 1)) / 100;
     }
 
     /* Apply first test configuration */
-    configId = 0;
-    ret = ISP_SVC_Sensor_SetGain(hIsp, &configGain[configId]);
+    ctx->configId = 0;
+    ret = ISP_SVC_Sensor_SetGain(hIsp, &ctx->configGain[ctx->configId]);
     if (ret != ISP_OK)
     {
       return ret;
     }
-    ret = ISP_SVC_Sensor_SetExposure(hIsp, &configExposure[configId]);
+    ret = ISP_SVC_Sensor_SetExposure(hIsp, &ctx->configExposure[ctx->configId]);
     if (ret != ISP_OK)
     {
       return ret;
     }
 
     /* Ask for stats lately (just to define a test starting point) */
-    delay = 0;
-    refL = 0;
-    memset(delays, 0, sizeof(delays));
-    ret = ISP_SVC_Stats_GetNext(hIsp, &ISP_Algo_SensorDelay_StatCb, pAlgo, &stats, ISP_STAT_LOC_DOWN, ISP_STAT_TYPE_AVG, ALGO_DELAY_MAX);
+    ctx->delay = 0;
+    ctx->refL = 0;
+    memset(ctx->delays, 0, sizeof(ctx->delays));
+    ret = ISP_SVC_Stats_GetNext(hIsp, &ISP_Algo_SensorDelay_StatCb, pAlgo, &ctx->stats, ISP_STAT_LOC_DOWN, ISP_STAT_TYPE_AVG, ALGO_DELAY_MAX);
     if (ret != ISP_OK)
     {
       return ret;
@@ -1083,44 +1133,44 @@ ISP_StatusTypeDef ISP_Algo_SensorDelay_Process(void *hIsp, void *pAlgo)
     break;
 
   case ISP_ALGO_STATE_STAT_READY:
-    avgL = (int32_t)stats.down.averageL;
-    if (configId > 0)
+    avgL = (int32_t)ctx->stats.down.averageL;
+    if (ctx->configId > 0)
     {
       /* New stat available, check if Luminance has changed */
-      delay++;
+      ctx->delay++;
 
-      if (abs(avgL- refL) <= ALGO_DELAY_L_MARGIN && delay != ALGO_DELAY_MAX)
+      if (abs(avgL- ctx->refL) <= ALGO_DELAY_L_MARGIN && ctx->delay != ALGO_DELAY_MAX)
       {
         /* No change, wait for next frame */
-        ret = ISP_SVC_Stats_GetNext(hIsp, &ISP_Algo_SensorDelay_StatCb, pAlgo, &stats, ISP_STAT_LOC_DOWN, ISP_STAT_TYPE_AVG, 1);
+        ret = ISP_SVC_Stats_GetNext(hIsp, &ISP_Algo_SensorDelay_StatCb, pAlgo, &ctx->stats, ISP_STAT_LOC_DOWN, ISP_STAT_TYPE_AVG, 1);
         algo->state = ISP_ALGO_STATE_WAITING_STAT;
         return ret;
       }
 
       /* Luminance was updated since we applied a new sensor configuration : store the result for this test.
        * Reaching ALGO_DELAY_MAX happens when we have a totally black or white frame. The measure shall be considered as invalid. */
-      delays[configId - 1] = delay;
+      ctx->delays[ctx->configId - 1] = ctx->delay;
     }
 
     /* New delay measure available */
-    if (++configId != ALGO_DELAY_NB_CONFIG)
+    if (++ctx->configId != ALGO_DELAY_NB_CONFIG)
     {
       /* Apply new sensor test configuration  */
-      ret = ISP_SVC_Sensor_SetGain(hIsp, &configGain[configId]);
+      ret = ISP_SVC_Sensor_SetGain(hIsp, &ctx->configGain[ctx->configId]);
       if (ret != ISP_OK)
       {
         return ret;
       }
-      ret = ISP_SVC_Sensor_SetExposure(hIsp, &configExposure[configId]);
+      ret = ISP_SVC_Sensor_SetExposure(hIsp, &ctx->configExposure[ctx->configId]);
       if (ret != ISP_OK)
       {
         return ret;
       }
 
       /* Ask for stats at next frame */
-      delay = 0;
-      refL = avgL;
-      ret = ISP_SVC_Stats_GetNext(hIsp, &ISP_Algo_SensorDelay_StatCb, pAlgo, &stats, ISP_STAT_LOC_DOWN, ISP_STAT_TYPE_AVG, 1);
+      ctx->delay = 0;
+      ctx->refL = avgL;
+      ret = ISP_SVC_Stats_GetNext(hIsp, &ISP_Algo_SensorDelay_StatCb, pAlgo, &ctx->stats, ISP_STAT_LOC_DOWN, ISP_STAT_TYPE_AVG, 1);
       if (ret != ISP_OK)
       {
         return ret;
@@ -1136,21 +1186,21 @@ ISP_StatusTypeDef ISP_Algo_SensorDelay_Process(void *hIsp, void *pAlgo)
       sensorDelay = 0;
       for (i = 0; i < ALGO_DELAY_NB_CONFIG - 1; i++)
       {
-        if ((delays[i] != ALGO_DELAY_MAX) && (delays[i] > sensorDelay))
+        if ((ctx->delays[i] != ALGO_DELAY_MAX) && (ctx->delays[i] > sensorDelay))
         {
-          sensorDelay = delays[i];
+          sensorDelay = ctx->delays[i];
         }
       }
 
       /* Restore initial AEC, AWB and sensor states */
-      IQParamConfig->AECAlgo.enable = prevAECStatus;
-      IQParamConfig->AWBAlgo.enable = prevAWBStatus;
-      ret = ISP_SVC_Sensor_SetGain(hIsp, &prevGainConfig);
+      IQParamConfig->AECAlgo.enable = ctx->prevAECStatus;
+      IQParamConfig->AWBAlgo.enable = ctx->prevAWBStatus;
+      ret = ISP_SVC_Sensor_SetGain(hIsp, &ctx->prevGainConfig);
       if (ret != ISP_OK)
       {
         return ret;
       }
-      ret = ISP_SVC_Sensor_SetExposure(hIsp, &prevExposureConfig);
+      ret = ISP_SVC_Sensor_SetExposure(hIsp, &ctx->prevExposureConfig);
       if (ret != ISP_OK)
       {
         return ret;
@@ -1164,7 +1214,7 @@ ISP_StatusTypeDef ISP_Algo_SensorDelay_Process(void *hIsp, void *pAlgo)
       ret = ISP_SVC_Misc_SendSensorDelayMeasure(hIsp, (ISP_SensorDelayTypeDef *)&sensorDelay);
 
       /* Stop delay algo */
-      ISP_SVC_Misc_SensorDelayMeasureStop();
+      ISP_SVC_Misc_SensorDelayMeasureStop(hIsp);
 
       algo->state = ISP_ALGO_STATE_INIT;
     }
@@ -1184,13 +1234,26 @@ ISP_StatusTypeDef ISP_Algo_SensorDelay_Process(void *hIsp, void *pAlgo)
   */
 ISP_StatusTypeDef ISP_Algo_Init(ISP_HandleTypeDef *hIsp)
 {
+  ISP_Algo_ContextTypeDef *ctx = &hIsp->algoContext;
   ISP_AlgoTypeDef *algo;
   ISP_StatusTypeDef ret;
   uint8_t i;
 
-  hIsp->algorithm = ISP_Algo_List;
+  if (sizeof(ISP_Algo_List) / sizeof(*ISP_Algo_List) > ISP_ALGO_MAX_NB)
+  {
+    return ISP_ERR_ALGO;
+  }
+
+  /* Each ISP instance runs its own copy of the registered algorithms */
+  ctx->nb = sizeof(ISP_Algo_List) / sizeof(*ISP_Algo_List);
+  for (i = 0; i < ctx->nb; i++)
+  {
+    ctx->instance[i] = *ISP_Algo_List[i];
+    ctx->list[i] = &ctx->instance[i];
+  }
+  hIsp->algorithm = ctx->list;
 
-  for (i = 0; i < sizeof(ISP_Algo_List) / sizeof(*ISP_Algo_List); i++)
+  for (i = 0; i < ctx->nb; i++)
   {
     algo = hIsp->algorithm[i];
     if ((algo != NULL) && (algo->Init != NULL))
@@ -1218,7 +1281,7 @@ ISP_StatusTypeDef ISP_Algo_DeInit(ISP_HandleTypeDef *hIsp)
   ISP_StatusTypeDef ret;
   uint8_t i;
 
-  for (i = 0; i < sizeof(ISP_Algo_List) / sizeof(*ISP_Algo_List); i++)
+  for (i = 0; i < hIsp->algoContext.nb; i++)
   {
     algo = hIsp->algorithm[i];
     if ((algo != NULL) && (algo->DeInit != NULL))
@@ -1246,13 +1309,13 @@ ISP_StatusTypeDef ISP_Algo_Process(ISP_HandleTypeDef *hIsp)
   ISP_StatusTypeDef ret;
   uint8_t i;
 
-  for (i = 0; i < sizeof(ISP_Algo_List) / sizeof(*ISP_Algo_List); i++)
+  for (i = 0; i < hIsp->algoContext.nb; i++)
   {
     algo = hIsp->algorithm[i];
     if ((algo != NULL) && (algo->Process != NULL))
     {
 #ifdef ALGO_PERF_DBG_LOGS
-      uint32_t tickstart = HAL_GetTick();
+      uint32_t cycles = ISP_PLATFORM_CYCLE_COUNT();
 #endif
       ret = algo->Process((void*)hIsp, (void*)algo);
       if (ret != ISP_OK)
@@ -1260,13 +1323,17 @@ ISP_StatusTypeDef ISP_Algo_Process(ISP_HandleTypeDef *hIsp)
         return ret;
       }
 #ifdef ALGO_PERF_DBG_LOGS
-      algo->perf_meas[iter] = HAL_GetTick() - tickstart;
+      algo->perf_meas[algo->iter] = ISP_PLATFORM_CYCLE_COUNT() - cycles;
       algo->iter++;
       if (algo->iter == NB_PERF_MEASURES) {
-        uint32_t sum = 0;
+        uint32_t sum = 0, max = 0;
         for(uint32_t j = 0; j < NB_PERF_MEASURES; j++)
         {
           sum += algo->perf_meas[j];
+          if (algo->perf_meas[j] > max)
+          {
+            max = algo->perf_meas[j];
+          }
         }
         switch (algo->id)
         {
@@ -1285,14 +1352,8 @@ ISP_StatusTypeDef ISP_Algo_Process(ISP_HandleTypeDef *hIsp)
 #endif /* ISP_MW_SW_AWB_ALGO_SUPPORT */
         }
         uint32_t meas = sum / NB_PERF_MEASURES;
-        if (meas == 0)
-        {
-          printf(" <1 ms\r\n");
-        }
-        else
-        {
-          printf(" %ld ms\r\n", meas);
-        }
+        printf(" avg %lu cycles (%lu us), max %lu cycles (%lu us)\r\n", meas, meas / ISP_PLATFORM_CYCLES_PER_US(),
+               max, max / ISP_PLATFORM_CYCLES_PER_US());
         algo->iter = 0;
       }
 #endif
@@ -1301,3 +1362,29 @@ ISP_StatusTypeDef ISP_Algo_Process(ISP_HandleTypeDef *hIsp)
 
   return ISP_OK;
 }
+
+/**
+  * @brief  ISP_Algo_Restart
+  *         Restart the convergence of the AEC and AWB algorithms from the sensor exposure,
+  *         sensor gain and white balance profile in use, e.g. after a statistic area change
+  * @param  hIsp: ISP device handle
+  * @retval operation result
+  */
+ISP_StatusTypeDef ISP_Algo_Restart(ISP_HandleTypeDef *hIsp)
+{
+#ifdef ISP_MW_SW_AWB_ALGO_SUPPORT
+  ISP_Algo_AWBContextTypeDef *awbCtx = &hIsp->algoContext.awb;
+
+  /* Estimate at each measure as after the initialization, the history of the former area
+   * being dropped so that it is neither seen as stable nor as an oscillation */
+  awbCtx->skipStatCheckCount = ALGO_AWB_STAT_CHECK_SKIP_AFTER_INIT;
+  memset(awbCtx->statsHistory, 0, sizeof(awbCtx->statsHistory));
+  memset(awbCtx->colorTempHistory, 0, sizeof(awbCtx->colorTempHistory));
+#endif /* ISP_MW_SW_AWB_ALGO_SUPPORT */
+
+  /* The AEC runs from the sensor state at each measure: the statistics of the new area, the
+   * only ones served once it is applied, are enough */
+  (void)hIsp;
+
+  return ISP_OK;
+}
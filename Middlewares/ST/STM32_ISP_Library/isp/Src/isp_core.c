@@ -72,6 +72,7 @@ ISP_StatusTypeDef ISP_Init(ISP_HandleTypeDef *hIsp,
   hIsp->MainPipe_FrameCount = 0;
   hIsp->AncillaryPipe_FrameCount = 0;
   hIsp->DumpPipe_FrameCount = 0;
+  hIsp->svcContext.decimation.factor = ISP_DECIM_FACTOR_1;
 
   hIsp->appliHelpers = *pAppliHelpers;
   /* Appli CB is mandatory for the sensor get/set exp/gain function */
@@ -334,6 +335,9 @@ ISP_StatusTypeDef ISP_BackgroundProcess(ISP_HandleTypeDef *hIsp)
   }
 #endif
 
+  /* Decode the statistics read by the VSYNC interrupt */
+  ISP_SVC_Stats_Process(hIsp);
+
   /* Check if a statistics gathering cycle has been completed to call the statistic callbacks */
   retStats = ISP_SVC_Stats_ProcessCallbacks(hIsp);
 
@@ -394,6 +398,27 @@ ISP_StatusTypeDef ISP_GetExposureTarget(ISP_HandleTypeDef *hIsp, ISP_ExposureCom
   return ISP_OK;
 }
 
+/**
+  * @brief  ISP_SetExposureMax
+  *         Update the longest exposure the AEC algorithm may request, e.g. when the
+  *         application changes the sensor frame length
+  * @param  hIsp: ISP device handle
+  * @param  ExposureMax: Exposure ceiling in micro seconds
+  * @retval Operation status
+  */
+ISP_StatusTypeDef ISP_SetExposureMax(ISP_HandleTypeDef *hIsp, uint32_t ExposureMax)
+{
+  if ((hIsp == NULL) || (ExposureMax < hIsp->sensorInfo.exposure_min))
+  {
+    return ISP_ERR_EINVAL;
+  }
+
+  /* Taken into account by the AEC algorithm at its next estimation */
+  hIsp->sensorInfo.exposure_max = ExposureMax;
+
+  return ISP_OK;
+}
+
 /**
   * @brief  ISP_SetAECState
   *         Set AEC algorithm state
@@ -578,6 +603,23 @@ ISP_StatusTypeDef ISP_GetStatArea(ISP_HandleTypeDef *hIsp, ISP_StatAreaTypeDef *
   return ISP_SVC_ISP_GetStatArea(hIsp, pStatArea);
 }
 
+/**
+  * @brief  ISP_RestartConvergence
+  *         Restart the AEC and AWB convergence from the current exposure, gain and white
+  *         balance, e.g. after ISP_SetStatArea()
+  * @param  hIsp: ISP device handle
+  * @retval Operation status
+  */
+ISP_StatusTypeDef ISP_RestartConvergence(ISP_HandleTypeDef *hIsp)
+{
+  if (hIsp == NULL)
+  {
+    return ISP_ERR_EINVAL;
+  }
+
+  return ISP_Algo_Restart(hIsp);
+}
+
 /**
   * @brief  ISP_GatherStatistics
   *         Gather statistics
@@ -663,10 +705,47 @@ uint32_t ISP_GetDumpFrameId(ISP_HandleTypeDef *hIsp)
   */
 void ISP_OutputMeta(ISP_HandleTypeDef *hIsp)
 {
-  extern ISP_MetaTypeDef Meta;
+  ISP_MetaTypeDef *pMeta = &hIsp->svcContext.meta;
 
-  if (Meta.outputEnable)
+  if (pMeta->outputEnable)
   {
-    printf("Meta[%ld]: L = %d, TG = %ld, G = %ld, E = %ld, CT = %ld\r\n", hIsp->MainPipe_FrameCount, Meta.averageL, Meta.exposureTarget, Meta.gain, Meta.exposure, Meta.colorTemp);
+    printf("Meta[%ld]: L = %d, TG = %ld, G = %ld, E = %ld, CT = %ld\r\n", hIsp->MainPipe_FrameCount, pMeta->averageL, pMeta->exposureTarget, pMeta->gain, pMeta->exposure, pMeta->colorTemp);
   }
 }
+
+/**
+  * @brief  ISP_GetFrameMeta
+  *         Get the ISP settings of the frame starting. To be called from the main pipe VSYNC
+  *         event: the ISP gains and the color conversion read back from the registers are the
+  *         ones latched for the frame, the luminance and color temperature are the last ones
+  *         measured by the algorithms
+  * @param  hIsp: ISP device handle
+  * @param  pFrameMeta: Pointer to the frame meta data
+  * @retval Operation status
+  */
+ISP_StatusTypeDef ISP_GetFrameMeta(ISP_HandleTypeDef *hIsp, ISP_FrameMetaTypeDef *pFrameMeta)
+{
+  ISP_StatusTypeDef ret;
+
+  if ((hIsp == NULL) || (hIsp->hDcmipp == NULL) || (pFrameMeta == NULL))
+  {
+    return ISP_ERR_EINVAL;
+  }
+
+  ret = ISP_SVC_ISP_GetGain(hIsp, &pFrameMeta->ispGain);
+  if (ret != ISP_OK)
+  {
+    return ret;
+  }
+
+  ret = ISP_SVC_ISP_GetColorConv(hIsp, &pFrameMeta->colorConv);
+  if (ret != ISP_OK)
+  {
+    return ret;
+  }
+
+  pFrameMeta->averageL = hIsp->svcContext.meta.averageL;
+  pFrameMeta->colorTemp = hIsp->svcContext.meta.colorTemp;
+
+  return ISP_OK;
+}
@@ -0,0 +1,530 @@
+/**
+ ******************************************************************************
+ * @file    isp_raw.c
+ * @author  AIS Application Team
+ * @brief   Software RAW pipeline of the ISP middleware.
+ *          The frame is developed line by line, in the order of the hardware
+ *          pipeline:
+ *          - RAW10 unpack and black level, in the Bayer domain
+ *          - demosaicing (bilinear or edge directed), 10-bit RGB
+ *          - ISP gain, color conversion, 10-bit to 8-bit output (gamma)
+ *          The settings are quantized as the hardware registers are (gain
+ *          Shift/Multiplier, Q8 color conversion coefficients), so that the
+ *          output can be compared with the hardware pipe output.
+ *          Each stage has an Arm MVE (Helium) implementation and a portable
+ *          scalar one, with identical integer arithmetic: the host build
+ *          develops the same frame bit for bit.
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+
+/* Includes ------------------------------------------------------------------*/
+#include "isp_raw.h"
+#include "isp_services.h"
+#include <math.h>
+#include <string.h>
+#if defined(__ARM_FEATURE_MVE)
+#include <arm_mve.h>
+#endif
+
+/* Private types -------------------------------------------------------------*/
+typedef enum
+{
+  ISP_RAW_R = 0,
+  ISP_RAW_G = 1,
+  ISP_RAW_B = 2,
+} ISP_RAW_ComponentTypeDef;
+
+/* Private constants ---------------------------------------------------------*/
+#define ISP_RAW_MAX                  (1023U)
+#define ISP_RAW_GAIN_SHIFT           (7U)
+#define ISP_RAW_CCM_SHIFT            (8U)
+#define ISP_RAW_GAMMA                (2.2f)
+
+/* Colors of the CFA positions [line & 1][column & 1] */
+static const uint8_t ISP_RAW_Cfa[4][2][2] = {
+  [ISP_RAW_BAYER_RGGB] = {{ISP_RAW_R, ISP_RAW_G}, {ISP_RAW_G, ISP_RAW_B}},
+  [ISP_RAW_BAYER_GRBG] = {{ISP_RAW_G, ISP_RAW_R}, {ISP_RAW_B, ISP_RAW_G}},
+  [ISP_RAW_BAYER_GBRG] = {{ISP_RAW_G, ISP_RAW_B}, {ISP_RAW_R, ISP_RAW_G}},
+  [ISP_RAW_BAYER_BGGR] = {{ISP_RAW_B, ISP_RAW_G}, {ISP_RAW_G, ISP_RAW_R}},
+};
+
+#if defined(__ARM_FEATURE_MVE)
+/* RAW10 packed: byte offsets of the MSBs and of the LSBs of 8 pixels (10 bytes), LSBs position */
+static const uint16_t ISP_RAW_MsbOffset[8] = {0, 1, 2, 3, 5, 6, 7, 8};
+static const uint16_t ISP_RAW_LsbOffset[8] = {4, 4, 4, 4, 9, 9, 9, 9};
+static const int16_t ISP_RAW_LsbShift[8] = {0, -2, -4, -6, 0, -2, -4, -6};
+/* RGB888 output: byte offsets of the even and odd pixels of a group of 8 */
+static const uint32_t ISP_RAW_EvenOffset[4] = {0, 6, 12, 18};
+static const uint32_t ISP_RAW_OddOffset[4] = {3, 9, 15, 21};
+/* Predicate of the even / odd 16-bit lanes */
+#define ISP_RAW_PRED_EVEN            ((mve_pred16_t) 0x3333U)
+#define ISP_RAW_PRED_ODD             ((mve_pred16_t) 0xCCCCU)
+#endif
+
+/* Private macro -------------------------------------------------------------*/
+#define ISP_RAW_ABS_DIFF(a, b)       (((a) > (b)) ? ((a) - (b)) : ((b) - (a)))
+
+/* Private function prototypes -----------------------------------------------*/
+static void ISP_RAW_UnpackLine(const ISP_RAW_HandleTypeDef *hRaw, const uint8_t *pSrc, uint16_t *pLine, uint32_t y);
+static void ISP_RAW_DemosaicLine(const ISP_RAW_HandleTypeDef *hRaw, const uint16_t *pUp, const uint16_t *pCur,
+                                 const uint16_t *pDown, uint32_t y);
+static void ISP_RAW_ColorLine(const ISP_RAW_HandleTypeDef *hRaw, uint8_t *pDst);
+
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  Unpack a RAW10 line and subtract the black level
+  * @param  hRaw: software RAW pipeline handle
+  * @param  pSrc: RAW line
+  * @param  pLine: padded Bayer line, first pixel at index ISP_RAW_PAD
+  * @param  y: line number
+  * @retval None
+  */
+static void ISP_RAW_UnpackLine(const ISP_RAW_HandleTypeDef *hRaw, const uint8_t *pSrc, uint16_t *pLine, uint32_t y)
+{
+  const uint32_t width = hRaw->conf.width;
+  const uint16_t blackEven = hRaw->black[(y & 1U) * 2U];
+  const uint16_t blackOdd = hRaw->black[(y & 1U) * 2U + 1U];
+  uint16_t *pOut = &pLine[ISP_RAW_PAD];
+  uint32_t x = 0, raw, black;
+
+#if defined(__ARM_FEATURE_MVE)
+  const uint16x8_t vblack = vpselq_u16(vdupq_n_u16(blackEven), vdupq_n_u16(blackOdd), ISP_RAW_PRED_EVEN);
+  uint16x8_t pix;
+
+  if (hRaw->conf.format == ISP_RAW_FORMAT_RAW10_PACKED)
+  {
+    const uint16x8_t msbOffset = vldrhq_u16(ISP_RAW_MsbOffset);
+    const uint16x8_t lsbOffset = vldrhq_u16(ISP_RAW_LsbOffset);
+    const int16x8_t lsbShift = vldrhq_s16(ISP_RAW_LsbShift);
+    const uint8_t *pIn;
+
+    for (; x + 8U <= width; x += 8U)
+    {
+      pIn = &pSrc[(x / 4U) * 5U];
+      pix = vshlq_n_u16(vldrbq_gather_offset_u16(pIn, msbOffset), 2);
+      pix = vorrq_u16(pix, vandq_u16(vshlq_u16(vldrbq_gather_offset_u16(pIn, lsbOffset), lsbShift), vdupq_n_u16(3U)));
+      vstrhq_u16(&pOut[x], vqsubq_u16(pix, vblack));
+    }
+  }
+  else
+  {
+    for (; x + 8U <= width; x += 8U)
+    {
+      pix = vandq_u16(vldrhq_u16(&((const uint16_t *) pSrc)[x]), vdupq_n_u16(ISP_RAW_MAX));
+      vstrhq_u16(&pOut[x], vqsubq_u16(pix, vblack));
+    }
+  }
+#endif
+
+  /* Scalar path, or remaining pixels */
+  for (; x < width; x++)
+  {
+    if (hRaw->conf.format == ISP_RAW_FORMAT_RAW10_PACKED)
+    {
+      raw = ((uint32_t) pSrc[(x / 4U) * 5U + (x % 4U)] << 2) | ((pSrc[(x / 4U) * 5U + 4U] >> (2U * (x % 4U))) & 3U);
+    }
+    else
+    {
+      raw = ((const uint16_t *) pSrc)[x] & ISP_RAW_MAX;
+    }
+    black = ((x & 1U) != 0U) ? blackOdd : blackEven;
+    pOut[x] = (uint16_t) ((raw > black) ? raw - black : 0U);
+  }
+
+  /* Mirror the borders, keeping the CFA phase */
+  pOut[-1] = pOut[1];
+  pOut[-2] = pOut[2];
+  pOut[width] = pOut[width - 2U];
+  pOut[width + 1U] = pOut[width - 3U];
+}
+
+/**
+  * @brief  Demosaic a Bayer line into the R, G, B planes
+  * @param  hRaw: software RAW pipeline handle
+  * @param  pUp: Bayer line above (padded)
+  * @param  pCur: Bayer line to demosaic (padded)
+  * @param  pDown: Bayer line below (padded)
+  * @param  y: line number
+  * @retval None
+  */
+static void ISP_RAW_DemosaicLine(const ISP_RAW_HandleTypeDef *hRaw, const uint16_t *pUp, const uint16_t *pCur,
+                                 const uint16_t *pDown, uint32_t y)
+{
+  const uint8_t *cfa = ISP_RAW_Cfa[hRaw->conf.bayer][y & 1U];
+  /* On this line, green is on the columns of parity gPhase; the other color (X) has its horizontal
+   * neighbors of its own color, the third color (Y) is on the lines above and below */
+  const uint32_t gPhase = (cfa[0] == ISP_RAW_G) ? 0U : 1U;
+  uint16_t *pX = hRaw->pPlane[cfa[gPhase ^ 1U]];
+  uint16_t *pG = hRaw->pPlane[ISP_RAW_G];
+  uint16_t *pY = hRaw->pPlane[ISP_RAW_B - cfa[gPhase ^ 1U]];
+  const uint32_t edge = (hRaw->conf.demosaic == ISP_RAW_DEMOS_EDGE) ? 1U : 0U;
+  const uint32_t width = hRaw->conf.width;
+  /* Left and right neighbors, within the padding at the line ends */
+  const uint16_t *pUpL = &pUp[ISP_RAW_PAD - 1U], *pUpR = &pUp[ISP_RAW_PAD + 1U];
+  const uint16_t *pCurL = &pCur[ISP_RAW_PAD - 1U], *pCurR = &pCur[ISP_RAW_PAD + 1U];
+  const uint16_t *pDownL = &pDown[ISP_RAW_PAD - 1U], *pDownR = &pDown[ISP_RAW_PAD + 1U];
+  uint32_t x = 0, c, h, v, d, gh, gv, g;
+
+  pUp += ISP_RAW_PAD;
+  pCur += ISP_RAW_PAD;
+  pDown += ISP_RAW_PAD;
+
+#if defined(__ARM_FEATURE_MVE)
+  {
+    const mve_pred16_t gLanes = (gPhase == 0U) ? ISP_RAW_PRED_EVEN : ISP_RAW_PRED_ODD;
+    uint16x8_t vc, vl, vr, vu, vd, vh, vv, vdiag, vcross, vg;
+
+    for (; x + 8U <= width; x += 8U)
+    {
+      vc = vldrhq_u16(&pCur[x]);
+      vl = vldrhq_u16(&pCurL[x]);
+      vr = vldrhq_u16(&pCurR[x]);
+      vu = vldrhq_u16(&pUp[x]);
+      vd = vldrhq_u16(&pDown[x]);
+
+      /* Averages of the horizontal, vertical, cross and diagonal neighbors */
+      vh = vshrq_n_u16(vaddq_n_u16(vaddq_u16(vl, vr), 1U), 1);
+      vv = vshrq_n_u16(vaddq_n_u16(vaddq_u16(vu, vd), 1U), 1);
+      vcross = vshrq_n_u16(vaddq_n_u16(vaddq_u16(vaddq_u16(vl, vr), vaddq_u16(vu, vd)), 2U), 2);
+      vdiag = vaddq_u16(vaddq_u16(vldrhq_u16(&pUpL[x]), vldrhq_u16(&pUpR[x])),
+                        vaddq_u16(vldrhq_u16(&pDownL[x]), vldrhq_u16(&pDownR[x])));
+      vdiag = vshrq_n_u16(vaddq_n_u16(vdiag, 2U), 2);
+
+      vg = vcross;
+      if (edge != 0U)
+      {
+        /* Interpolate along the edge: the direction with the smallest gradient */
+        vg = vpselq_u16(vv, vg, vcmphiq_u16(vabdq_u16(vl, vr), vabdq_u16(vu, vd)));
+        vg = vpselq_u16(vh, vg, vcmphiq_u16(vabdq_u16(vu, vd), vabdq_u16(vl, vr)));
+      }
+
+      vstrhq_u16(&pG[x], vpselq_u16(vc, vg, gLanes));
+      vstrhq_u16(&pX[x], vpselq_u16(vh, vc, gLanes));
+      vstrhq_u16(&pY[x], vpselq_u16(vv, vdiag, gLanes));
+    }
+  }
+#endif
+
+  /* Scalar path, or remaining pixels */
+  for (; x < width; x++)
+  {
+    c = pCur[x];
+    h = (pCurL[x] + pCurR[x] + 1U) >> 1;
+    v = (pUp[x] + pDown[x] + 1U) >> 1;
+
+    if ((x & 1U) == gPhase)
+    {
+      pG[x] = (uint16_t) c;
+      pX[x] = (uint16_t) h;
+      pY[x] = (uint16_t) v;
+    }
+    else
+    {
+      d = (pUpL[x] + pUpR[x] + pDownL[x] + pDownR[x] + 2U) >> 2;
+      g = (pCurL[x] + pCurR[x] + pUp[x] + pDown[x] + 2U) >> 2;
+      if (edge != 0U)
+      {
+        gh = ISP_RAW_ABS_DIFF(pCurL[x], pCurR[x]);
+        gv = ISP_RAW_ABS_DIFF(pUp[x], pDown[x]);
+        g = (gv < gh) ? v : (gh < gv) ? h : g;
+      }
+      pG[x] = (uint16_t) g;
+      pX[x] = (uint16_t) c;
+      pY[x] = (uint16_t) d;
+    }
+  }
+}
+
+/**
+  * @brief  Apply the gain, the color conversion and the output conversion to the R, G, B planes
+  * @param  hRaw: software RAW pipeline handle
+  * @param  pDst: RGB888 line (B, G, R byte order, as the DCMIPP RGB888 pixel packer)
+  * @retval None
+  */
+static void ISP_RAW_ColorLine(const ISP_RAW_HandleTypeDef *hRaw, uint8_t *pDst)
+{
+  const uint32_t width = hRaw->conf.width;
+  const uint16_t *pR = hRaw->pPlane[ISP_RAW_R];
+  const uint16_t *pG = hRaw->pPlane[ISP_RAW_G];
+  const uint16_t *pB = hRaw->pPlane[ISP_RAW_B];
+  uint32_t x = 0, i, rgb[3];
+  int32_t acc;
+
+#if defined(__ARM_FEATURE_MVE)
+  {
+    const uint32x4_t evenOffset = vldrwq_u32(ISP_RAW_EvenOffset);
+    const uint32x4_t oddOffset = vldrwq_u32(ISP_RAW_OddOffset);
+    const uint32x4_t max = vdupq_n_u32(ISP_RAW_MAX);
+    uint16x8_t vR, vG, vB;
+    uint32x4_t in[3], out, offset;
+    int32x4_t vacc;
+    uint32_t half;
+
+    for (; x + 8U <= width; x += 8U)
+    {
+      vR = vldrhq_u16(&pR[x]);
+      vG = vldrhq_u16(&pG[x]);
+      vB = vldrhq_u16(&pB[x]);
+
+      /* Even pixels in the bottom 16-bit lanes, odd pixels in the top ones */
+      for (half = 0; half < 2U; half++)
+      {
+        in[0] = (half == 0U) ? vmovlbq_u16(vR) : vmovltq_u16(vR);
+        in[1] = (half == 0U) ? vmovlbq_u16(vG) : vmovltq_u16(vG);
+        in[2] = (half == 0U) ? vmovlbq_u16(vB) : vmovltq_u16(vB);
+        offset = (half == 0U) ? evenOffset : oddOffset;
+
+        /* ISP gain */
+        for (i = 0; i < 3U; i++)
+        {
+          in[i] = vminq_u32(vshrq_n_u32(vmulq_n_u32(in[i], hRaw->gain[i]), ISP_RAW_GAIN_SHIFT), max);
+        }
+
+        /* Color conversion, then output conversion */
+        for (i = 0; i < 3U; i++)
+        {
+          vacc = vmulq_n_s32(vreinterpretq_s32_u32(in[0]), hRaw->ccm[i][0]);
+          vacc = vmlaq_n_s32(vacc, vreinterpretq_s32_u32(in[1]), hRaw->ccm[i][1]);
+          vacc = vmlaq_n_s32(vacc, vreinterpretq_s32_u32(in[2]), hRaw->ccm[i][2]);
+          vacc = vshrq_n_s32(vaddq_n_s32(vacc, 1 << (ISP_RAW_CCM_SHIFT - 1U)), ISP_RAW_CCM_SHIFT);
+          vacc = vmaxq_s32(vminq_s32(vacc, vdupq_n_s32(ISP_RAW_MAX)), vdupq_n_s32(0));
+          out = vldrbq_gather_offset_u32(hRaw->lut, vreinterpretq_u32_s32(vacc));
+          /* B, G, R byte order */
+          vstrbq_scatter_offset_u32(&pDst[x * 3U + (2U - i)], offset, out);
+        }
+      }
+    }
+  }
+#endif
+
+  /* Scalar path, or remaining pixels */
+  for (; x < width; x++)
+  {
+    rgb[0] = ((uint32_t) pR[x] * hRaw->gain[0]) >> ISP_RAW_GAIN_SHIFT;
+    rgb[1] = ((uint32_t) pG[x] * hRaw->gain[1]) >> ISP_RAW_GAIN_SHIFT;
+    rgb[2] = ((uint32_t) pB[x] * hRaw->gain[2]) >> ISP_RAW_GAIN_SHIFT;
+    for (i = 0; i < 3U; i++)
+    {
+      rgb[i] = (rgb[i] > ISP_RAW_MAX) ? ISP_RAW_MAX : rgb[i];
+    }
+
+    for (i = 0; i < 3U; i++)
+    {
+      acc = (int32_t) rgb[0] * hRaw->ccm[i][0] + (int32_t) rgb[1] * hRaw->ccm[i][1] + (int32_t) rgb[2] * hRaw->ccm[i][2];
+      acc = (acc + (1 << (ISP_RAW_CCM_SHIFT - 1U))) >> ISP_RAW_CCM_SHIFT;
+      acc = (acc < 0) ? 0 : (acc > (int32_t) ISP_RAW_MAX) ? (int32_t) ISP_RAW_MAX : acc;
+      pDst[x * 3U + (2U - i)] = hRaw->lut[acc];
+    }
+  }
+}
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  ISP_RAW_Init
+  *         Initialize the software RAW pipeline: check the frame layout and quantize the settings
+  * @param  hRaw: software RAW pipeline handle
+  * @param  pConf: frame and processing configuration
+  * @param  pWork: work buffer (line buffers), 4-byte aligned
+  * @param  WorkSize: size of the work buffer, at least ISP_RAW_WORK_SIZE(pConf->width)
+  * @retval operation result
+  */
+ISP_StatusTypeDef ISP_RAW_Init(ISP_RAW_HandleTypeDef *hRaw, const ISP_RAW_ConfTypeDef *pConf, void *pWork, uint32_t WorkSize)
+{
+  const uint8_t (*cfa)[2];
+  uint16_t *pLine;
+  uint64_t val;
+  uint32_t i, j, shift, factor[3];
+
+  if ((hRaw == NULL) || (pConf == NULL) || (pWork == NULL) ||
+      (pConf->width < 8U) || ((pConf->width & 1U) != 0U) || (pConf->height < 2U) || ((pConf->height & 1U) != 0U) ||
+      (pConf->bayer > ISP_RAW_BAYER_BGGR) || (pConf->dstStride < pConf->width * 3U) ||
+      (WorkSize < ISP_RAW_WORK_SIZE(pConf->width)))
+  {
+    return ISP_ERR_EINVAL;
+  }
+
+  if (((pConf->format == ISP_RAW_FORMAT_RAW10_PACKED) && ((pConf->width & 3U) != 0U || pConf->srcStride < pConf->width * 5U / 4U)) ||
+      ((pConf->format == ISP_RAW_FORMAT_RAW16) && ((pConf->srcStride & 1U) != 0U || pConf->srcStride < pConf->width * 2U)))
+  {
+    return ISP_ERR_EINVAL;
+  }
+
+  memset(hRaw, 0, sizeof(*hRaw));
+  hRaw->conf = *pConf;
+
+  /* Black level: 8-bit offsets of the hardware block, applied to the 10-bit data */
+  cfa = ISP_RAW_Cfa[pConf->bayer];
+  for (i = 0; i < 4U; i++)
+  {
+    if (pConf->blackLevel.enable != 0U)
+    {
+      hRaw->black[i] = (uint16_t) ((cfa[i / 2U][i % 2U] == ISP_RAW_R) ? pConf->blackLevel.BLCR :
+                                   (cfa[i / 2U][i % 2U] == ISP_RAW_G) ? pConf->blackLevel.BLCG :
+                                                                        pConf->blackLevel.BLCB) << 2;
+    }
+  }
+
+  /* ISP gain: Shift + Multiplier (128 means "x1.0"), as programmed by ISP_SVC_ISP_SetGain() */
+  factor[0] = pConf->ispGain.ispGainR;
+  factor[1] = pConf->ispGain.ispGainG;
+  factor[2] = pConf->ispGain.ispGainB;
+  for (i = 0; i < 3U; i++)
+  {
+    if (pConf->ispGain.enable == 0U)
+    {
+      hRaw->gain[i] = 1U << ISP_RAW_GAIN_SHIFT;
+      continue;
+    }
+    val = ((uint64_t) factor[i] * 128U) / ISP_GAIN_PRECISION_FACTOR;
+    for (shift = 0; val >= 256U; shift++)
+    {
+      val /= 2U;
+    }
+    hRaw->gain[i] = (uint32_t) val << shift;
+  }
+
+  /* Color conversion: Q8 register format, as programmed by ISP_SVC_ISP_SetColorConv() */
+  for (i = 0; i < 3U; i++)
+  {
+    for (j = 0; j < 3U; j++)
+    {
+      if (pConf->colorConv.enable != 0U)
+      {
+        hRaw->ccm[i][j] = (int16_t) (((int64_t) pConf->colorConv.coeff[i][j] * 256) / ISP_CCM_PRECISION_FACTOR);
+      }
+      else
+      {
+        hRaw->ccm[i][j] = (i == j) ? (1 << ISP_RAW_CCM_SHIFT) : 0;
+      }
+    }
+  }
+
+  /* 10-bit to 8-bit output conversion */
+  for (i = 0; i <= ISP_RAW_MAX; i++)
+  {
+    if (pConf->gammaEnable != 0U)
+    {
+      hRaw->lut[i] = (uint8_t) (255.0f * powf((float) i / ISP_RAW_MAX, 1.0f / ISP_RAW_GAMMA) + 0.5f);
+    }
+    else
+    {
+      hRaw->lut[i] = (uint8_t) (i >> 2);
+    }
+  }
+
+  /* Line buffers */
+  pLine = (uint16_t *) pWork;
+  for (i = 0; i < 3U; i++)
+  {
+    hRaw->pBayer[i] = pLine;
+    pLine += pConf->width + 2U * ISP_RAW_PAD;
+  }
+  for (i = 0; i < 3U; i++)
+  {
+    hRaw->pPlane[i] = pLine;
+    pLine += pConf->width;
+  }
+
+  return ISP_OK;
+}
+
+/**
+  * @brief  ISP_RAW_Process
+  *         Develop a RAW frame into RGB888
+  * @param  hRaw: software RAW pipeline handle
+  * @param  pSrc: RAW frame, hRaw->conf.srcStride bytes per line
+  * @param  pDst: RGB888 frame, hRaw->conf.dstStride bytes per line
+  * @retval operation result
+  */
+ISP_StatusTypeDef ISP_RAW_Process(ISP_RAW_HandleTypeDef *hRaw, const uint8_t *pSrc, uint8_t *pDst)
+{
+  uint16_t *const *line;
+  uint32_t y, height;
+
+  if ((hRaw == NULL) || (pSrc == NULL) || (pDst == NULL) || (hRaw->pBayer[0] == NULL))
+  {
+    return ISP_ERR_EINVAL;
+  }
+
+  line = hRaw->pBayer;
+  height = hRaw->conf.height;
+
+  /* Rolling window of three Bayer lines: line n is in pBayer[n % 3] */
+  ISP_RAW_UnpackLine(hRaw, pSrc, line[0], 0);
+  ISP_RAW_UnpackLine(hRaw, &pSrc[hRaw->conf.srcStride], line[1], 1);
+
+  for (y = 0; y < height; y++)
+  {
+    if ((y > 0U) && (y + 1U < height))
+    {
+      ISP_RAW_UnpackLine(hRaw, &pSrc[(y + 1U) * hRaw->conf.srcStride], line[(y + 1U) % 3U], y + 1U);
+    }
+
+    /* Mirrored first and last lines, keeping the CFA phase */
+    ISP_RAW_DemosaicLine(hRaw, line[((y == 0U) ? 1U : y - 1U) % 3U], line[y % 3U],
+                         line[((y + 1U == height) ? y - 1U : y + 1U) % 3U], y);
+
+    ISP_RAW_ColorLine(hRaw, &pDst[y * hRaw->conf.dstStride]);
+  }
+
+  return ISP_OK;
+}
+
+/**
+  * @brief  ISP_RAW_Benchmark
+  *         Develop a RAW frame several times and report the throughput.
+  *         Uses the ISP_PLATFORM_CYCLE_COUNT() cycle counter (DWT->CYCCNT on target, to be
+  *         provided by the harness on host).
+  * @param  hRaw: software RAW pipeline handle
+  * @param  pSrc: RAW frame
+  * @param  pDst: RGB888 frame
+  * @param  NbFrames: number of times the frame is developed
+  * @param  pKPixelPerSec: throughput, in thousands of pixels per second (output parameter)
+  * @retval operation result
+  */
+ISP_StatusTypeDef ISP_RAW_Benchmark(ISP_RAW_HandleTypeDef *hRaw, const uint8_t *pSrc, uint8_t *pDst, uint32_t NbFrames,
+                                    uint32_t *pKPixelPerSec)
+{
+  ISP_StatusTypeDef ret;
+  uint64_t cycles = 0;
+  uint32_t i, start;
+
+  if ((hRaw == NULL) || (pKPixelPerSec == NULL) || (NbFrames == 0U))
+  {
+    return ISP_ERR_EINVAL;
+  }
+
+  /* One frame at a time: the 32-bit cycle counter wraps after a few seconds */
+  for (i = 0; i < NbFrames; i++)
+  {
+    start = ISP_PLATFORM_CYCLE_COUNT();
+    ret = ISP_RAW_Process(hRaw, pSrc, pDst);
+    cycles += (uint32_t) (ISP_PLATFORM_CYCLE_COUNT() - start);
+    if (ret != ISP_OK)
+    {
+      return ret;
+    }
+  }
+
+  if (cycles == 0U)
+  {
+    /* No cycle counter on this platform */
+    return ISP_ERR_EINVAL;
+  }
+
+  /* pixels / us = pixels * cycles per us / cycles, reported in kpixel/s */
+  *pKPixelPerSec = (uint32_t) (((uint64_t) hRaw->conf.width * hRaw->conf.height * NbFrames *
+                                ISP_PLATFORM_CYCLES_PER_US() * 1000U) / cycles);
+
+  return ISP_OK;
+}
@@ -24,20 +24,10 @@
 #endif
 
 /* Private types -------------------------------------------------------------*/
-typedef enum {
-  ISP_STAT_CFG_UP_AVG = 0,      /* Configure @Up   for average    */
-  ISP_STAT_CFG_UP_BINS_0_2,     /* Configure @Up   for bins[0:2]  */
-  ISP_STAT_CFG_UP_BINS_3_5,     /* Configure @Up   for bins[3:5]  */
-  ISP_STAT_CFG_UP_BINS_6_8,     /* Configure @Up   for bins[6:8]  */
-  ISP_STAT_CFG_UP_BINS_9_11,    /* Configure @Up   for bins[9:11] */
-  ISP_STAT_CFG_DOWN_AVG,        /* Configure @Down for average    */
-  ISP_STAT_CFG_DOWN_BINS_0_2,   /* Configure @Down for bins[0:2]  */
-  ISP_STAT_CFG_DOWN_BINS_3_5,   /* Configure @Down for bins[3:5]  */
-  ISP_STAT_CFG_DOWN_BINS_6_8,   /* Configure @Down for bins[6:8]  */
-  ISP_STAT_CFG_DOWN_BINS_9_11,  /* Configure @Down for bins[9:11] */
-  ISP_STAT_CFG_LAST = ISP_STAT_CFG_DOWN_BINS_9_11,
-  ISP_STAT_CFG_CYCLE_SIZE,
-} ISP_SVC_StatEngineStage;
+/* Statistic engine types are defined in isp_context.h */
+
+/* All the histogram parts of a location have been measured */
+#define ISP_SVC_STAT_BINS_COMPLETE (0x0FU)
 
 typedef enum {
   ISP_RED,
@@ -45,26 +35,6 @@ typedef enum {
   ISP_BLUE,
 } ISP_SVC_Component;
 
-typedef struct {
-  ISP_stat_ready_cb callback;           /* Callback to inform that stats are ready */
-  ISP_AlgoTypeDef *pAlgo;               /* Callback context parameter */
-  ISP_SVC_StatStateTypeDef *pStats;     /* Output statistics */
-  uint32_t refFrameId;                  /* Frame reference for which stats are requested */
-  ISP_SVC_StatLocation location;        /* Location where stats are requested */
-  ISP_SVC_StatType type;                /* Type of requested stats */
-} ISP_SVC_StatRegisteredClient;
-
-#define ISP_SVC_STAT_MAX_CB       (5U)
-typedef struct {
-  ISP_SVC_StatEngineStage stage;        /* Internal processing stage */
-  ISP_SVC_StatStateTypeDef last;        /* Last available statistics */
-  ISP_SVC_StatStateTypeDef ongoing;     /* Statistics being updated */
-  ISP_SVC_StatRegisteredClient client[ISP_SVC_STAT_MAX_CB]; /* Client waiting for stats */
-  ISP_SVC_StatType upRequest;           /* Type of statistics request at Up location */
-  ISP_SVC_StatType downRequest;         /* Type of statistics request at Down location */
-  uint32_t requestAllCounter;           /* Counter for the temporary "request all stats" mode */
-} ISP_SVC_StatEngineTypeDef;
-
 /* Private constants ---------------------------------------------------------*/
 /* Private macro -------------------------------------------------------------*/
 /* Private function prototypes -----------------------------------------------*/
@@ -74,12 +44,7 @@ static int16_t To_CConv_Reg(int32_t Coeff);
 static int32_t From_CConv_Reg(int16_t Reg);
 
 /* Private variables ---------------------------------------------------------*/
-static uint32_t ISP_ManualWBRefColorTemp = 0;
-static ISP_DecimationTypeDef ISP_DecimationValue = {ISP_DECIM_FACTOR_1};
-static ISP_IQParamTypeDef ISP_IQParamCache;
-static ISP_SVC_StatEngineTypeDef ISP_SVC_StatEngine;
-static bool ISP_SensorDelayMeasureRun;
-
+/* The services state is kept per ISP instance in hIsp->svcContext */
 static const uint32_t avgRGBUp[] = {
     DCMIPP_STAT_EXT_SOURCE_PRE_BLKLVL_R, DCMIPP_STAT_EXT_SOURCE_PRE_BLKLVL_G, DCMIPP_STAT_EXT_SOURCE_PRE_BLKLVL_B
 };
@@ -137,7 +102,6 @@ static const DCMIPP_StatisticExtractionConfTypeDef statConfDownBins_9_11 = {
 };
 
 /* Exported variables --------------------------------------------------------*/
-extern ISP_MetaTypeDef Meta;
 
 /* Private functions ---------------------------------------------------------*/
 static void To_Shift_Multiplier(uint32_t Factor, uint8_t *pShift, uint8_t *pMultiplier)
@@ -185,13 +149,12 @@ static int32_t From_CConv_Reg(int16_t Reg)
   return (int32_t) Val;
 }
 
-static uint8_t GetAvgStats(ISP_HandleTypeDef *hIsp, ISP_SVC_StatLocation location, ISP_SVC_Component component, uint32_t accu)
+static uint8_t GetAvgStats(ISP_SVC_StatLocation location, ISP_SVC_Component component, uint32_t accu, uint32_t areaPixels)
 {
   uint32_t nb_comp_pix, comp_divider;
 
-  /* Number of pixels computed from Stat Area and considering decimation */
-  nb_comp_pix = hIsp->statArea.XSize * hIsp->statArea.YSize;
-  nb_comp_pix /= ISP_DecimationValue.factor * ISP_DecimationValue.factor;
+  /* Number of pixels of the Stat Area the accumulator refers to, considering decimation */
+  nb_comp_pix = areaPixels;
 
   if (location == ISP_STAT_LOC_DOWN)
   {
@@ -217,11 +180,11 @@ static uint8_t GetAvgStats(ISP_HandleTypeDef *hIsp, ISP_SVC_StatLocation locatio
   return ((accu * 256) + (nb_comp_pix / 2)) / nb_comp_pix;
 }
 
-static void ReadStatHistogram(ISP_HandleTypeDef *hIsp, uint32_t *histogram)
+static void ReadStatHistogram(const ISP_SVC_StatSampleTypeDef *sample, uint32_t *histogram)
 {
-  for (uint32_t i = DCMIPP_STATEXT_MODULE1; i <= DCMIPP_STATEXT_MODULE3; i++)
+  for (uint32_t i = 0; i < 3U; i++)
   {
-    HAL_DCMIPP_PIPE_GetISPAccumulatedStatisticsCounter(hIsp->hDcmipp, DCMIPP_PIPE1, i, &(histogram[i - DCMIPP_STATEXT_MODULE1]));
+    histogram[i] = sample->accu[i];
   }
 }
 
@@ -233,195 +196,212 @@ static void SetStatConfig(DCMIPP_StatisticExtractionConfTypeDef *statConf, const
   }
 }
 
-static ISP_SVC_StatEngineStage GetNextStatStage(ISP_SVC_StatEngineStage current)
+static bool IsStatStageRequested(const ISP_SVC_StatEngineTypeDef *engine, ISP_SVC_StatEngineStage stage)
 {
-  ISP_SVC_StatEngineStage next = ISP_STAT_CFG_LAST;
+  ISP_SVC_StatType request, type;
 
-  /* Special mode for IQ tuning tool asking for all stats : go the the next step, no skip */
-  if ((ISP_SVC_StatEngine.upRequest & ISP_STAT_TYPE_ALL_TMP) ||
-      (ISP_SVC_StatEngine.downRequest & ISP_STAT_TYPE_ALL_TMP))
-  {
-    next = (ISP_SVC_StatEngineStage) ((current < ISP_STAT_CFG_LAST) ? current + 1 : ISP_STAT_CFG_UP_AVG);
-    return next;
-  }
+  request = (stage < ISP_STAT_CFG_DOWN_AVG) ? engine->upRequest : engine->downRequest;
+  type = ((stage == ISP_STAT_CFG_UP_AVG) || (stage == ISP_STAT_CFG_DOWN_AVG)) ? ISP_STAT_TYPE_AVG : ISP_STAT_TYPE_BINS;
 
-  /* Follow the below stage cycle, skipping steps where stats are not requested:
-   * - ISP_STAT_CFG_UP_AVG
-   * - ISP_STAT_CFG_UP_BINS_0_2 + BINS_3_5 + BINS_6_8 + BINS_9_11
-   * - ISP_STAT_CFG_DOWN_AVG
-   * - ISP_STAT_CFG_DOWN_BINS_0_2 + BINS_3_5 + BINS_6_8 + BINS_9_11
-  */
-  switch (current)
+  return ((request & type) != 0);
+}
+
+static ISP_SVC_StatEngineStage GetNextAvgStage(const ISP_SVC_StatEngineTypeDef *engine)
+{
+  /* Alternate between up and down averages when both are requested */
+  if (engine->lastAvgStage == ISP_STAT_CFG_UP_AVG)
   {
-  case ISP_STAT_CFG_UP_AVG:
-    /* Try Up Bins */
-    if (ISP_SVC_StatEngine.upRequest & ISP_STAT_TYPE_BINS)
+    if (IsStatStageRequested(engine, ISP_STAT_CFG_DOWN_AVG))
     {
-      next = ISP_STAT_CFG_UP_BINS_0_2;
+      return ISP_STAT_CFG_DOWN_AVG;
     }
-    /* Skip Up Bins : try Down Avg */
-    else if (ISP_SVC_StatEngine.downRequest &  ISP_STAT_TYPE_AVG)
+    if (IsStatStageRequested(engine, ISP_STAT_CFG_UP_AVG))
     {
-      next = ISP_STAT_CFG_DOWN_AVG;
+      return ISP_STAT_CFG_UP_AVG;
     }
-    /* Skip Down Avg : try Down Bins */
-    else if (ISP_SVC_StatEngine.downRequest & ISP_STAT_TYPE_BINS)
+  }
+  else
+  {
+    if (IsStatStageRequested(engine, ISP_STAT_CFG_UP_AVG))
     {
-      next = ISP_STAT_CFG_DOWN_BINS_0_2;
+      return ISP_STAT_CFG_UP_AVG;
     }
-    /* Skip Down Bins : try Up Avg */
-    else if (ISP_SVC_StatEngine.upRequest & ISP_STAT_TYPE_AVG)
+    if (IsStatStageRequested(engine, ISP_STAT_CFG_DOWN_AVG))
     {
-      next = ISP_STAT_CFG_UP_AVG;
+      return ISP_STAT_CFG_DOWN_AVG;
     }
-    break;
+  }
 
-  case ISP_STAT_CFG_UP_BINS_9_11:
-    /* Try Down Avg */
-    if (ISP_SVC_StatEngine.downRequest & ISP_STAT_TYPE_AVG)
-    {
-      next = ISP_STAT_CFG_DOWN_AVG;
-    }
-    /* Skip Down Avg : try Down Bins */
-    else if (ISP_SVC_StatEngine.downRequest & ISP_STAT_TYPE_BINS)
-    {
-      next = ISP_STAT_CFG_DOWN_BINS_0_2;
-    }
-    /* Skip Down Bins : try Up Avg */
-    else if (ISP_SVC_StatEngine.upRequest & ISP_STAT_TYPE_AVG)
-    {
-      next = ISP_STAT_CFG_UP_AVG;
-    }
-    /* Skip Up Avg : try on Up Bins */
-    else if (ISP_SVC_StatEngine.upRequest & ISP_STAT_TYPE_BINS)
-    {
-      next = ISP_STAT_CFG_UP_BINS_0_2;
-    }
-    break;
+  return ISP_STAT_CFG_NONE;
+}
 
-  case ISP_STAT_CFG_DOWN_AVG:
-    /* Try Down Bins */
-    if (ISP_SVC_StatEngine.downRequest & ISP_STAT_TYPE_BINS)
-    {
-      next = ISP_STAT_CFG_DOWN_BINS_0_2;
-    }
-    /* Skip Down Bins : try Up Avg */
-    else if (ISP_SVC_StatEngine.upRequest & ISP_STAT_TYPE_AVG)
-    {
-      next = ISP_STAT_CFG_UP_AVG;
-    }
-    /* Skip Up Avg : try Up Bins */
-    else if (ISP_SVC_StatEngine.upRequest & ISP_STAT_TYPE_BINS)
-    {
-      next = ISP_STAT_CFG_UP_BINS_0_2;
-    }
-    /* Skip Up Bins : try Down Avg */
-    else if (ISP_SVC_StatEngine.downRequest & ISP_STAT_TYPE_AVG)
-    {
-      next = ISP_STAT_CFG_DOWN_AVG;
-    }
-    break;
+static ISP_SVC_StatEngineStage GetNextBinsStage(const ISP_SVC_StatEngineTypeDef *engine)
+{
+  /* Histogram parts, up then down */
+  static const ISP_SVC_StatEngineStage binsStages[] = {
+    ISP_STAT_CFG_UP_BINS_0_2, ISP_STAT_CFG_UP_BINS_3_5, ISP_STAT_CFG_UP_BINS_6_8, ISP_STAT_CFG_UP_BINS_9_11,
+    ISP_STAT_CFG_DOWN_BINS_0_2, ISP_STAT_CFG_DOWN_BINS_3_5, ISP_STAT_CFG_DOWN_BINS_6_8, ISP_STAT_CFG_DOWN_BINS_9_11,
+  };
+  const uint32_t nbStages = sizeof(binsStages) / sizeof(binsStages[0]);
+  uint32_t i, last;
 
-  case ISP_STAT_CFG_DOWN_BINS_9_11:
-    /* Try Up Avg */
-    if (ISP_SVC_StatEngine.upRequest & ISP_STAT_TYPE_AVG)
-    {
-      next = ISP_STAT_CFG_UP_AVG;
-    }
-    /* Skip Up Avg : try Up Bins */
-    else if (ISP_SVC_StatEngine.upRequest & ISP_STAT_TYPE_BINS)
-    {
-      next = ISP_STAT_CFG_UP_BINS_0_2;
-    }
-    /* Skip Up Bins : try Down Avg */
-    else if (ISP_SVC_StatEngine.downRequest & ISP_STAT_TYPE_AVG)
+  for (last = 0; last < nbStages - 1; last++)
+  {
+    if (binsStages[last] == engine->lastBinsStage)
     {
-      next = ISP_STAT_CFG_DOWN_AVG;
+      break;
     }
-    /* Skip Down Avg : try Down Bins */
-    else if (ISP_SVC_StatEngine.downRequest & ISP_STAT_TYPE_BINS)
+  }
+
+  /* Continue with the part following the last one scheduled */
+  for (i = 1; i <= nbStages; i++)
+  {
+    if (IsStatStageRequested(engine, binsStages[(last + i) % nbStages]))
     {
-      next = ISP_STAT_CFG_DOWN_BINS_0_2;
+      return binsStages[(last + i) % nbStages];
     }
-    break;
+  }
 
-  default:
-    /* In the middle of the bins measurement: continue with the next bins part */
-    next = (ISP_SVC_StatEngineStage) (current + 1);
-    break;
+  return ISP_STAT_CFG_NONE;
+}
+
+static ISP_SVC_StatEngineStage GetNextStatStage(ISP_SVC_StatEngineTypeDef *engine, ISP_SVC_StatEngineStage current)
+{
+  ISP_SVC_StatEngineStage nextAvg, nextBins;
+
+  /* Special mode for IQ tuning tool asking for all stats : go the the next step, no skip */
+  if ((engine->upRequest & ISP_STAT_TYPE_ALL_TMP) ||
+      (engine->downRequest & ISP_STAT_TYPE_ALL_TMP))
+  {
+    return (ISP_SVC_StatEngineStage) ((current < ISP_STAT_CFG_LAST) ? current + 1 : ISP_STAT_CFG_UP_AVG);
+  }
+
+  /* The three statistic modules measure the R, G, B averages together, and each module can only
+   * count its own bins of a histogram part: the modules cannot be split between the AEC/AWB
+   * (averages) and the histogram consumers within a frame. Instead, an average stage is inserted
+   * every ISP_SVC_STAT_BINS_PER_AVG histogram parts, so that the averages are refreshed every
+   * few frames whatever the histogram requests, rather than once per full up + down cycle.
+   */
+  nextAvg = GetNextAvgStage(engine);
+  nextBins = GetNextBinsStage(engine);
+
+  if ((nextAvg == ISP_STAT_CFG_NONE) && (nextBins == ISP_STAT_CFG_NONE))
+  {
+    /* Nothing requested: keep the current configuration */
+    return current;
+  }
+
+  if ((nextBins == ISP_STAT_CFG_NONE) ||
+      ((nextAvg != ISP_STAT_CFG_NONE) && (engine->binsSinceAvg >= ISP_SVC_STAT_BINS_PER_AVG)))
+  {
+    engine->binsSinceAvg = 0;
+    engine->lastAvgStage = nextAvg;
+    return nextAvg;
   }
 
-  return next;
+  engine->binsSinceAvg++;
+  engine->lastBinsStage = nextBins;
+  return nextBins;
 }
 
-static ISP_SVC_StatEngineStage GetStatCycleStart(ISP_SVC_StatLocation location)
+static void PublishStats(ISP_SVC_StatEngineTypeDef *engine, uint32_t idx, ISP_SVC_StatType type, uint32_t frameId)
 {
-  ISP_SVC_StatEngineStage stage;
+  ISP_SVC_StatStateTypeDef *last = &engine->last;
+  ISP_StatisticsTypeDef *pLast, *pOngoing;
+  ISP_SVC_StatType request;
+  uint32_t frameIdStart;
 
-  if (location == ISP_STAT_LOC_UP)
+  if (idx == ISP_SVC_STAT_IDX_UP)
   {
-    if ((ISP_SVC_StatEngine.upRequest & ISP_STAT_TYPE_AVG) ||
-        (ISP_SVC_StatEngine.upRequest & ISP_STAT_TYPE_ALL_TMP))
-    {
-      /* Stat up cycle starts with AVG measurement */
-      stage = ISP_STAT_CFG_UP_AVG;
-    }
-    else
-    {
-      /* Stat up cycle starts with 1st BIN measurement */
-      stage = ISP_STAT_CFG_UP_BINS_0_2;
-    }
+    pLast = &last->up;
+    pOngoing = &engine->ongoing.up;
+    request = engine->upRequest;
   }
   else
   {
-    if ((ISP_SVC_StatEngine.downRequest & ISP_STAT_TYPE_AVG) ||
-        (ISP_SVC_StatEngine.downRequest & ISP_STAT_TYPE_ALL_TMP))
-    {
-      /* Stat down cycle starts with AVG measurement */
-      stage = ISP_STAT_CFG_DOWN_AVG;
-    }
-    else
-    {
-      /* Stat down cycle starts with 1st BIN measurement */
-      stage = ISP_STAT_CFG_DOWN_BINS_0_2;
-    }
+    pLast = &last->down;
+    pOngoing = &engine->ongoing.down;
+    request = engine->downRequest;
+  }
+
+  if (type == ISP_STAT_TYPE_AVG)
+  {
+    pLast->averageR = pOngoing->averageR;
+    pLast->averageG = pOngoing->averageG;
+    pLast->averageB = pOngoing->averageB;
+    pLast->averageL = pOngoing->averageL;
+    engine->avgFrameId[idx] = frameId;
+  }
+  else
+  {
+    memcpy(pLast->histogram, pOngoing->histogram, sizeof(pLast->histogram));
+    engine->binsFrameId[idx] = engine->binsFrameIdStart[idx];
+  }
+
+  /* The 'last' statistics of this location were measured from the oldest requested measure */
+  frameIdStart = frameId;
+  if ((request & (ISP_STAT_TYPE_AVG | ISP_STAT_TYPE_ALL_TMP)) && (engine->avgFrameId[idx] < frameIdStart))
+  {
+    frameIdStart = engine->avgFrameId[idx];
+  }
+  if ((request & (ISP_STAT_TYPE_BINS | ISP_STAT_TYPE_ALL_TMP)) && (engine->binsFrameId[idx] < frameIdStart))
+  {
+    frameIdStart = engine->binsFrameId[idx];
+  }
+
+  if (idx == ISP_SVC_STAT_IDX_UP)
+  {
+    last->upFrameIdStart = frameIdStart;
+    last->upFrameIdEnd = frameId;
+  }
+  else
+  {
+    last->downFrameIdStart = frameIdStart;
+    last->downFrameIdEnd = frameId;
   }
-  return stage;
 }
 
-static ISP_SVC_StatEngineStage GetStatCycleEnd(ISP_SVC_StatLocation location)
+static void CollectBins(ISP_SVC_StatEngineTypeDef *engine, uint32_t idx, uint32_t part, uint32_t frameId)
 {
-  ISP_SVC_StatEngineStage stage;
+  if (engine->binsMask[idx] == 0)
+  {
+    /* First part of a new histogram */
+    engine->binsFrameIdStart[idx] = frameId;
+  }
+
+  engine->binsMask[idx] |= (uint8_t) (1U << part);
 
-  if (location == ISP_STAT_LOC_UP)
+  if (engine->binsMask[idx] == ISP_SVC_STAT_BINS_COMPLETE)
   {
-    if ((ISP_SVC_StatEngine.upRequest & ISP_STAT_TYPE_BINS) ||
-        (ISP_SVC_StatEngine.upRequest & ISP_STAT_TYPE_ALL_TMP))
-    {
-      /* Stat up cycle ends with last BINS measurement */
-      stage = ISP_STAT_CFG_UP_BINS_9_11;
-    }
-    else
-    {
-      /* Stat up cycle ends with AVG measurement */
-      stage = ISP_STAT_CFG_UP_AVG;
-    }
+    PublishStats(engine, idx, ISP_STAT_TYPE_BINS, frameId);
+    engine->binsMask[idx] = 0;
   }
-  else
+}
+
+static bool IsClientStatReady(const ISP_SVC_StatEngineTypeDef *engine, const ISP_SVC_StatRegisteredClient *client)
+{
+  ISP_SVC_StatType type = client->type;
+  uint32_t idx;
+
+  if (type & ISP_STAT_TYPE_ALL_TMP)
   {
-    if ((ISP_SVC_StatEngine.downRequest & ISP_STAT_TYPE_BINS) ||
-        (ISP_SVC_StatEngine.downRequest & ISP_STAT_TYPE_ALL_TMP))
-    {
-      /* Stat down cycle ends with last BINS measurement */
-      stage = ISP_STAT_CFG_DOWN_BINS_9_11;
-    }
-    else
-    {
-      /* Stat down cycle ends with AVG measurement */
-      stage = ISP_STAT_CFG_DOWN_AVG;
-    }
+    type |= ISP_STAT_TYPE_AVG_AND_BINS;
   }
-  return stage;
+
+  /* Each requested measure must have been done from the requested frame on */
+  for (idx = 0; idx < ISP_SVC_STAT_NB_LOC; idx++)
+  {
+    if ((client->location & ((idx == ISP_SVC_STAT_IDX_UP) ? ISP_STAT_LOC_UP : ISP_STAT_LOC_DOWN)) == 0)
+      continue;
+
+    if ((type & ISP_STAT_TYPE_AVG) && (engine->avgFrameId[idx] < client->refFrameId))
+      return false;
+
+    if ((type & ISP_STAT_TYPE_BINS) && (engine->binsFrameId[idx] < client->refFrameId))
+      return false;
+  }
+
+  return true;
 }
 
 uint8_t LuminanceFromRGB(uint8_t r, uint8_t g, uint8_t b)
@@ -597,7 +577,7 @@ ISP_StatusTypeDef ISP_SVC_ISP_SetDecimation(ISP_HandleTypeDef *hIsp, ISP_Decimat
   }
 
   /* Save decimation value */
-  ISP_DecimationValue.factor = pConfig->factor;
+  hIsp->svcContext.decimation.factor = pConfig->factor;
 
   return ret;
 }
@@ -611,7 +591,13 @@ ISP_StatusTypeDef ISP_SVC_ISP_SetDecimation(ISP_HandleTypeDef *hIsp, ISP_Decimat
   */
 ISP_StatusTypeDef ISP_SVC_ISP_GetDecimation(ISP_HandleTypeDef *hIsp, ISP_DecimationTypeDef *pConfig)
 {
-  pConfig->factor = ISP_DecimationValue.factor;
+  /* Check handles validity */
+  if ((hIsp == NULL) || (pConfig == NULL))
+  {
+    return ISP_ERR_DECIMATION_EINVAL;
+  }
+
+  pConfig->factor = hIsp->svcContext.decimation.factor;
 
   return ISP_OK;
 }
@@ -681,7 +667,9 @@ ISP_StatusTypeDef ISP_SVC_ISP_SetStatArea(ISP_HandleTypeDef *hIsp, ISP_StatAreaT
 {
   HAL_StatusTypeDef halStatus;
   DCMIPP_StatisticExtractionAreaConfTypeDef currentStatAreaCfg;
+  ISP_SVC_StatAreaTypeDef *area;
   ISP_StatusTypeDef ret = ISP_OK;
+  uint32_t factor;
 
   if ((hIsp == NULL) || (pConfig == NULL) ||
       (pConfig->X0 > ISP_STATWINDOW_MAX) ||
@@ -696,25 +684,45 @@ ISP_StatusTypeDef ISP_SVC_ISP_SetStatArea(ISP_HandleTypeDef *hIsp, ISP_StatAreaT
     return ISP_ERR_STATAREA_EINVAL;
   }
 
+  area = &hIsp->svcContext.statEngine.area;
+  factor = hIsp->svcContext.decimation.factor;
+
   /* Set coordinates in the 'decimated' referential */
-  currentStatAreaCfg.HStart = pConfig->X0 / ISP_DecimationValue.factor;
-  currentStatAreaCfg.VStart = pConfig->Y0 / ISP_DecimationValue.factor;
-  currentStatAreaCfg.HSize = pConfig->XSize / ISP_DecimationValue.factor;
-  currentStatAreaCfg.VSize = pConfig->YSize / ISP_DecimationValue.factor;
+  currentStatAreaCfg.HStart = pConfig->X0 / factor;
+  currentStatAreaCfg.VStart = pConfig->Y0 / factor;
+  currentStatAreaCfg.HSize = pConfig->XSize / factor;
+  currentStatAreaCfg.VSize = pConfig->YSize / factor;
 
-  if (HAL_DCMIPP_PIPE_SetISPAreaStatisticExtractionConfig(hIsp->hDcmipp, DCMIPP_PIPE1,
-                                                          &currentStatAreaCfg) != HAL_OK)
+  if (area->pixels != 0)
   {
-    return ISP_ERR_STATAREA_HAL;
+    /* Statistics are being gathered: let ISP_SVC_Stats_Gather() apply the area at the next frame
+     * boundary, so that each measure is decoded with the area it was done on.
+     */
+    area->pending = 0;
+    ISP_PLATFORM_MEMORY_BARRIER();
+    area->next = currentStatAreaCfg;
+    area->nextPixels = currentStatAreaCfg.HSize * currentStatAreaCfg.VSize;
+    ISP_PLATFORM_MEMORY_BARRIER();
+    area->pending = 1;
   }
   else
   {
-    halStatus = HAL_DCMIPP_PIPE_EnableISPAreaStatisticExtraction(hIsp->hDcmipp, DCMIPP_PIPE1);
-  }
+    if (HAL_DCMIPP_PIPE_SetISPAreaStatisticExtractionConfig(hIsp->hDcmipp, DCMIPP_PIPE1,
+                                                            &currentStatAreaCfg) != HAL_OK)
+    {
+      return ISP_ERR_STATAREA_HAL;
+    }
+    else
+    {
+      halStatus = HAL_DCMIPP_PIPE_EnableISPAreaStatisticExtraction(hIsp->hDcmipp, DCMIPP_PIPE1);
+    }
 
-  if (halStatus != HAL_OK)
-  {
-    return ISP_ERR_STATAREA_HAL;
+    if (halStatus != HAL_OK)
+    {
+      return ISP_ERR_STATAREA_HAL;
+    }
+
+    area->pixels = currentStatAreaCfg.HSize * currentStatAreaCfg.VSize;
   }
 
   /* Update internal state */
@@ -740,7 +748,12 @@ ISP_StatusTypeDef ISP_SVC_ISP_GetStatArea(ISP_HandleTypeDef *hIsp, ISP_StatAreaT
     return ISP_ERR_STATAREA_EINVAL;
   }
 
-  if (HAL_DCMIPP_PIPE_IsEnabledISPAreaStatisticExtraction(hIsp->hDcmipp, DCMIPP_PIPE1) == 0)
+  if (hIsp->svcContext.statEngine.area.pending)
+  {
+    /* Area not applied yet */
+    *pConfig = hIsp->statArea;
+  }
+  else if (HAL_DCMIPP_PIPE_IsEnabledISPAreaStatisticExtraction(hIsp->hDcmipp, DCMIPP_PIPE1) == 0)
   {
     pConfig->X0 = 0;
     pConfig->Y0 = 0;
@@ -753,10 +766,10 @@ ISP_StatusTypeDef ISP_SVC_ISP_GetStatArea(ISP_HandleTypeDef *hIsp, ISP_StatAreaT
                                                         &currentStatAreaCfg);
 
     /* Consider decimation */
-    pConfig->X0 = currentStatAreaCfg.HStart * ISP_DecimationValue.factor;
-    pConfig->Y0 = currentStatAreaCfg.VStart * ISP_DecimationValue.factor;
-    pConfig->XSize = currentStatAreaCfg.HSize * ISP_DecimationValue.factor;
-    pConfig->YSize = currentStatAreaCfg.VSize * ISP_DecimationValue.factor;
+    pConfig->X0 = currentStatAreaCfg.HStart * hIsp->svcContext.decimation.factor;
+    pConfig->Y0 = currentStatAreaCfg.VStart * hIsp->svcContext.decimation.factor;
+    pConfig->XSize = currentStatAreaCfg.HSize * hIsp->svcContext.decimation.factor;
+    pConfig->YSize = currentStatAreaCfg.VSize * hIsp->svcContext.decimation.factor;
   }
 
   return ISP_OK;
@@ -1119,7 +1132,7 @@ ISP_StatusTypeDef ISP_SVC_Sensor_SetGain(ISP_HandleTypeDef *hIsp, ISP_SensorGain
     }
   }
 
-  Meta.gain = pConfig->gain;
+  hIsp->svcContext.meta.gain = pConfig->gain;
 
   return ISP_OK;
 }
@@ -1173,7 +1186,7 @@ ISP_StatusTypeDef ISP_SVC_Sensor_SetExposure(ISP_HandleTypeDef *hIsp, ISP_Sensor
     }
   }
 
-  Meta.exposure = pConfig->exposure;
+  hIsp->svcContext.meta.exposure = pConfig->exposure;
 
   return ISP_OK;
 }
@@ -1352,9 +1365,13 @@ uint32_t ISP_SVC_Misc_GetDumpFrameId(ISP_HandleTypeDef *hIsp)
   */
 ISP_StatusTypeDef ISP_SVC_Misc_SetWBRefMode(ISP_HandleTypeDef *hIsp, uint32_t RefColorTemp)
 {
-  (void)hIsp; /* unused */
+  /* Check handle validity */
+  if (hIsp == NULL)
+  {
+    return ISP_ERR_EINVAL;
+  }
 
-  ISP_ManualWBRefColorTemp = RefColorTemp;
+  hIsp->svcContext.manualWBRefColorTemp = RefColorTemp;
 
   return ISP_OK;
 }
@@ -1368,9 +1385,13 @@ ISP_StatusTypeDef ISP_SVC_Misc_SetWBRefMode(ISP_HandleTypeDef *hIsp, uint32_t Re
   */
 ISP_StatusTypeDef ISP_SVC_Misc_GetWBRefMode(ISP_HandleTypeDef *hIsp, uint32_t *pRefColorTemp)
 {
-  (void)hIsp; /* unused */
+  /* Check handle validity */
+  if ((hIsp == NULL) || (pRefColorTemp == NULL))
+  {
+    return ISP_ERR_EINVAL;
+  }
 
-  *pRefColorTemp = ISP_ManualWBRefColorTemp;
+  *pRefColorTemp = hIsp->svcContext.manualWBRefColorTemp;
 
   return ISP_OK;
 }
@@ -1378,34 +1399,34 @@ ISP_StatusTypeDef ISP_SVC_Misc_GetWBRefMode(ISP_HandleTypeDef *hIsp, uint32_t *p
 /**
   * @brief  ISP_SVC_Misc_SensorDelayMeasureStart
   *         Start the sensor delay measure
-  * @param  None
+  * @param  hIsp: ISP device handle
   * @retval None
   */
-void ISP_SVC_Misc_SensorDelayMeasureStart()
+void ISP_SVC_Misc_SensorDelayMeasureStart(ISP_HandleTypeDef *hIsp)
 {
-  ISP_SensorDelayMeasureRun = true;
+  hIsp->svcContext.sensorDelayMeasureRun = true;
 }
 
 /**
   * @brief  ISP_SVC_Misc_SensorDelayMeasureStop
   *         Stop the sensor delay measure
-  * @param  None
+  * @param  hIsp: ISP device handle
   * @retval None
   */
-void ISP_SVC_Misc_SensorDelayMeasureStop()
+void ISP_SVC_Misc_SensorDelayMeasureStop(ISP_HandleTypeDef *hIsp)
 {
-  ISP_SensorDelayMeasureRun = false;
+  hIsp->svcContext.sensorDelayMeasureRun = false;
 }
 
 /**
   * @brief  ISP_SVC_Misc_SensorDelayMeasureIsRunning
   *         Return the sensor delay measure status
-  * @param  None
+  * @param  hIsp: ISP device handle
   * @retval true if the sensor delay measure is running
   */
-bool ISP_SVC_Misc_SensorDelayMeasureIsRunning()
+bool ISP_SVC_Misc_SensorDelayMeasureIsRunning(ISP_HandleTypeDef *hIsp)
 {
-  return ISP_SensorDelayMeasureRun;
+  return hIsp->svcContext.sensorDelayMeasureRun;
 }
 
 /**
@@ -1500,6 +1521,21 @@ bool ISP_SVC_Misc_IsGammaEnabled(ISP_HandleTypeDef *hIsp, uint32_t Pipe)
   return ret;
 }
 
+/**
+  * @brief  ISP_SVC_Misc_TraceEvent
+  *         Report an event to the application trace, if any
+  * @param  hIsp: ISP device handle
+  * @param  Event: event that occurred
+  * @retval none
+  */
+void ISP_SVC_Misc_TraceEvent(ISP_HandleTypeDef *hIsp, ISP_TraceEventTypeDef Event)
+{
+  if (hIsp->appliHelpers.TraceEvent != NULL)
+  {
+    hIsp->appliHelpers.TraceEvent(hIsp->cameraInstance, Event, ISP_SVC_Misc_GetMainFrameId(hIsp));
+  }
+}
+
 /**
   * @brief  ISP_SVC_ISP_SetGamma
   *         Set the Gamma on Pipe1 and/or Pipe2
@@ -1597,9 +1633,7 @@ ISP_StatusTypeDef ISP_SVC_Dump_GetFrame(ISP_HandleTypeDef *hIsp, uint32_t **pBuf
   */
 ISP_StatusTypeDef ISP_SVC_IQParam_Init(ISP_HandleTypeDef *hIsp, const ISP_IQParamTypeDef *ISP_IQParamCacheInit)
 {
-  (void)hIsp; /* unused */
-
-  ISP_IQParamCache = *ISP_IQParamCacheInit;
+  hIsp->svcContext.IQParamCache = *ISP_IQParamCacheInit;
   return ISP_OK;
 }
 
@@ -1611,9 +1645,7 @@ ISP_StatusTypeDef ISP_SVC_IQParam_Init(ISP_HandleTypeDef *hIsp, const ISP_IQPara
   */
 ISP_IQParamTypeDef *ISP_SVC_IQParam_Get(ISP_HandleTypeDef *hIsp)
 {
-  (void)hIsp; /* unused */
-
-  return &ISP_IQParamCache;
+  return &hIsp->svcContext.IQParamCache;
 }
 
 /**
@@ -1624,22 +1656,36 @@ ISP_IQParamTypeDef *ISP_SVC_IQParam_Get(ISP_HandleTypeDef *hIsp)
   */
 void ISP_SVC_Stats_Init(ISP_HandleTypeDef *hIsp)
 {
-  memset(&ISP_SVC_StatEngine, 0, sizeof(ISP_SVC_StatEngineTypeDef));
+  ISP_SVC_StatEngineTypeDef *engine = &hIsp->svcContext.statEngine;
+
+  memset(engine, 0, sizeof(ISP_SVC_StatEngineTypeDef));
+
+  engine->tagPrevious1.stage = ISP_STAT_CFG_NONE;
+  engine->tagPrevious2.stage = ISP_STAT_CFG_NONE;
+  /* Schedule the down average first, then the first histogram part */
+  engine->lastAvgStage = ISP_STAT_CFG_UP_AVG;
+  engine->lastBinsStage = ISP_STAT_CFG_DOWN_BINS_9_11;
+  engine->binsSinceAvg = ISP_SVC_STAT_BINS_PER_AVG;
 }
 
 /**
   * @brief  ISP_SVC_Stats_Gather
-  *         Gather statistics
+  *         Gather statistics. Called from the main pipe VSYNC interrupt: the accumulators are only
+  *         read and queued, they are decoded by ISP_SVC_Stats_Process() in the background.
   * @param  hIsp: ISP device handle
   * @retval None
   */
 void ISP_SVC_Stats_Gather(ISP_HandleTypeDef *hIsp)
 {
-  static ISP_SVC_StatEngineStage stagePrevious1 = ISP_STAT_CFG_LAST, stagePrevious2 = ISP_STAT_CFG_LAST;
   DCMIPP_StatisticExtractionConfTypeDef statConf[3];
-  ISP_IQParamTypeDef *IQParamConfig;
-  ISP_SVC_StatStateTypeDef *ongoing;
-  uint32_t i, avgR, avgG, avgB, frameId;
+  ISP_SVC_StatEngineTypeDef *engine;
+  ISP_SVC_StatRingTypeDef *ring;
+  ISP_SVC_StatAreaTypeDef *area;
+  ISP_SVC_StatProfileTypeDef *profile;
+  ISP_SVC_StatSampleTypeDef *sample;
+  uint32_t i, head, cycles;
+
+  cycles = ISP_PLATFORM_CYCLE_COUNT();
 
   /* Check handle validity */
   if (hIsp == NULL)
@@ -1656,81 +1702,53 @@ void ISP_SVC_Stats_Gather(ISP_HandleTypeDef *hIsp)
     return;
   }
 
+  engine = &hIsp->svcContext.statEngine;
+  ring = &engine->ring;
+  area = &engine->area;
+  profile = &engine->profile;
+
   /* Read the stats according to the configuration applied 2 VSYNC (shadow register + stat computation)
    * stages earlier.
    */
-  ongoing = &ISP_SVC_StatEngine.ongoing;
-  switch(stagePrevious2)
-  {
-  case ISP_STAT_CFG_UP_AVG:
-    HAL_DCMIPP_PIPE_GetISPAccumulatedStatisticsCounter(hIsp->hDcmipp, DCMIPP_PIPE1, DCMIPP_STATEXT_MODULE1, &avgR);
-    HAL_DCMIPP_PIPE_GetISPAccumulatedStatisticsCounter(hIsp->hDcmipp, DCMIPP_PIPE1, DCMIPP_STATEXT_MODULE2, &avgG);
-    HAL_DCMIPP_PIPE_GetISPAccumulatedStatisticsCounter(hIsp->hDcmipp, DCMIPP_PIPE1, DCMIPP_STATEXT_MODULE3, &avgB);
-
-    ongoing->up.averageR = GetAvgStats(hIsp, ISP_STAT_LOC_UP, ISP_RED, avgR);
-    ongoing->up.averageG = GetAvgStats(hIsp, ISP_STAT_LOC_UP, ISP_GREEN, avgG);
-    ongoing->up.averageB = GetAvgStats(hIsp, ISP_STAT_LOC_UP, ISP_BLUE, avgB);
-    ongoing->up.averageL = LuminanceFromRGB(ongoing->up.averageR, ongoing->up.averageG, ongoing->up.averageB);
-    break;
-
-  case ISP_STAT_CFG_UP_BINS_0_2:
-    ReadStatHistogram(hIsp, &ongoing->up.histogram[0]);
-    break;
-
-  case ISP_STAT_CFG_UP_BINS_3_5:
-    ReadStatHistogram(hIsp, &ongoing->up.histogram[3]);
-    break;
-
-  case ISP_STAT_CFG_UP_BINS_6_8:
-    ReadStatHistogram(hIsp, &ongoing->up.histogram[6]);
-    break;
-
-  case ISP_STAT_CFG_UP_BINS_9_11:
-    ReadStatHistogram(hIsp, &ongoing->up.histogram[9]);
-    break;
-
-  case ISP_STAT_CFG_DOWN_AVG:
-    HAL_DCMIPP_PIPE_GetISPAccumulatedStatisticsCounter(hIsp->hDcmipp, DCMIPP_PIPE1, DCMIPP_STATEXT_MODULE1, &avgR);
-    HAL_DCMIPP_PIPE_GetISPAccumulatedStatisticsCounter(hIsp->hDcmipp, DCMIPP_PIPE1, DCMIPP_STATEXT_MODULE2, &avgG);
-    HAL_DCMIPP_PIPE_GetISPAccumulatedStatisticsCounter(hIsp->hDcmipp, DCMIPP_PIPE1, DCMIPP_STATEXT_MODULE3, &avgB);
-
-    ongoing->down.averageR = GetAvgStats(hIsp, ISP_STAT_LOC_DOWN, ISP_RED, avgR);
-    ongoing->down.averageG = GetAvgStats(hIsp, ISP_STAT_LOC_DOWN, ISP_GREEN, avgG);
-    ongoing->down.averageB = GetAvgStats(hIsp, ISP_STAT_LOC_DOWN, ISP_BLUE, avgB);
-    IQParamConfig = ISP_SVC_IQParam_Get(hIsp);
-    if ((hIsp->sensorInfo.bayer_pattern == ISP_DEMOS_TYPE_MONO) || (!IQParamConfig->demosaicing.enable))
-    {
-      ongoing->down.averageL = LuminanceFromRGBMono(ongoing->down.averageR, ongoing->down.averageG, ongoing->down.averageB);
-    }
-    else
+  head = ring->head;
+  if ((head - ring->tail) < ISP_SVC_STAT_RING_SIZE)
+  {
+    sample = &ring->sample[head % ISP_SVC_STAT_RING_SIZE];
+    sample->stage = engine->tagPrevious2.stage;
+    sample->areaPixels = engine->tagPrevious2.areaPixels;
+    sample->areaSeq = engine->tagPrevious2.areaSeq;
+    sample->frameId = ISP_SVC_Misc_GetMainFrameId(hIsp);
+    sample->resync = ring->overflow;
+    for (i = DCMIPP_STATEXT_MODULE1; i <= DCMIPP_STATEXT_MODULE3; i++)
     {
-      ongoing->down.averageL = LuminanceFromRGB(ongoing->down.averageR, ongoing->down.averageG, ongoing->down.averageB);
+      HAL_DCMIPP_PIPE_GetISPAccumulatedStatisticsCounter(hIsp->hDcmipp, DCMIPP_PIPE1, i, &sample->accu[i - DCMIPP_STATEXT_MODULE1]);
     }
-    break;
-
-  case ISP_STAT_CFG_DOWN_BINS_0_2:
-    ReadStatHistogram(hIsp, &ongoing->down.histogram[0]);
-    break;
-
-  case ISP_STAT_CFG_DOWN_BINS_3_5:
-    ReadStatHistogram(hIsp, &ongoing->down.histogram[3]);
-    break;
-
-  case ISP_STAT_CFG_DOWN_BINS_6_8:
-    ReadStatHistogram(hIsp, &ongoing->down.histogram[6]);
-    break;
+    ring->overflow = 0;
 
-  case ISP_STAT_CFG_DOWN_BINS_9_11:
-    ReadStatHistogram(hIsp, &ongoing->down.histogram[9]);
-    break;
+    /* Publish the sample once fully written */
+    ISP_PLATFORM_MEMORY_BARRIER();
+    ring->head = head + 1U;
+  }
+  else
+  {
+    /* Background late: drop this measure, the ongoing cycle is restarted */
+    ring->overflow = 1;
+    profile->droppedCount++;
+  }
 
-  default:
-    /* No Read */
-    break;
+  /* Apply a new statistic area together with the stage configuration */
+  if (area->pending)
+  {
+    if (HAL_DCMIPP_PIPE_SetISPAreaStatisticExtractionConfig(hIsp->hDcmipp, DCMIPP_PIPE1, &area->next) == HAL_OK)
+    {
+      area->pixels = area->nextPixels;
+      area->seq++;
+    }
+    area->pending = 0;
   }
 
   /* Configure stat for a new stage */
-  switch(ISP_SVC_StatEngine.stage)
+  switch(engine->stage)
   {
   case ISP_STAT_CFG_UP_AVG:
     for (i = 0; i < 3; i++)
@@ -1803,56 +1821,148 @@ void ISP_SVC_Stats_Gather(ISP_HandleTypeDef *hIsp)
     }
   }
 
-  /* Cycle start / end */
-  frameId = ISP_SVC_Misc_GetMainFrameId(hIsp);
+  /* Save the two last applied configurations and go to next stage */
+  engine->tagPrevious2 = engine->tagPrevious1;
+  engine->tagPrevious1.stage = engine->stage;
+  engine->tagPrevious1.areaPixels = area->pixels;
+  engine->tagPrevious1.areaSeq = area->seq;
+  engine->stage = GetNextStatStage(engine, engine->stage);
 
-  if (stagePrevious2 == GetStatCycleStart(ISP_STAT_LOC_UP))
+  /* Check the interrupt handler stays within its budget */
+  cycles = ISP_PLATFORM_CYCLE_COUNT() - cycles;
+  profile->gatherCycles = cycles;
+  if (cycles > profile->gatherCyclesMax)
   {
-    ongoing->upFrameIdStart = frameId;
+    profile->gatherCyclesMax = cycles;
   }
-
-  if (stagePrevious2 == GetStatCycleStart(ISP_STAT_LOC_DOWN))
+  if (cycles > ISP_SVC_STAT_GATHER_BUDGET_CYCLES)
   {
-    ongoing->downFrameIdStart = frameId;
+    profile->overBudgetCount++;
   }
+}
 
-  if ((stagePrevious2 == GetStatCycleEnd(ISP_STAT_LOC_UP)) && (ongoing->upFrameIdStart != 0))
-  {
-    /* Last measure of the up cycle : update the 'last' struct */
-    ISP_SVC_StatEngine.last.up = ongoing->up;
-    ISP_SVC_StatEngine.last.upFrameIdEnd = frameId;
-    ISP_SVC_StatEngine.last.upFrameIdStart = ongoing->upFrameIdStart;
+/**
+  * @brief  ISP_SVC_Stats_Process
+  *         Decode the accumulators queued by ISP_SVC_Stats_Gather() and update the statistics
+  *         gather cycles. Called from the background process.
+  * @param  hIsp: ISP device handle
+  * @retval None
+  */
+void ISP_SVC_Stats_Process(ISP_HandleTypeDef *hIsp)
+{
+  ISP_SVC_StatEngineTypeDef *engine = &hIsp->svcContext.statEngine;
+  ISP_SVC_StatRingTypeDef *ring = &engine->ring;
+  const ISP_SVC_StatSampleTypeDef *sample;
+  ISP_IQParamTypeDef *IQParamConfig;
+  ISP_SVC_StatStateTypeDef *ongoing;
+  uint32_t tail, frameId, part;
 
-    memset(&ongoing->up, 0, sizeof(ongoing->up));
-    ongoing->upFrameIdStart = 0;
-    ongoing->upFrameIdEnd = 0;
-  }
+  ongoing = &engine->ongoing;
 
-  if ((stagePrevious2 == GetStatCycleEnd(ISP_STAT_LOC_DOWN)) && (ongoing->downFrameIdStart != 0))
+  for (tail = ring->tail; tail != ring->head; tail++)
   {
-    /* Last measure of the down cycle : update the 'last' struct */
-    ISP_SVC_StatEngine.last.down = ongoing->down;
-    ISP_SVC_StatEngine.last.downFrameIdEnd = frameId;
-    ISP_SVC_StatEngine.last.downFrameIdStart = ongoing->downFrameIdStart;
+    /* Read the sample only after having seen it published */
+    ISP_PLATFORM_MEMORY_BARRIER();
+    sample = &ring->sample[tail % ISP_SVC_STAT_RING_SIZE];
+    frameId = sample->frameId;
+
+    if (sample->resync || (sample->areaSeq != engine->areaSeq))
+    {
+      /* Measures are missing or the statistic area changed: restart the histograms being collected */
+      engine->binsMask[ISP_SVC_STAT_IDX_UP] = 0;
+      engine->binsMask[ISP_SVC_STAT_IDX_DOWN] = 0;
+      if (sample->areaSeq != engine->areaSeq)
+      {
+        /* The measures of the former area no longer serve the pending requests */
+        memset(engine->avgFrameId, 0, sizeof(engine->avgFrameId));
+        memset(engine->binsFrameId, 0, sizeof(engine->binsFrameId));
+      }
+      engine->areaSeq = sample->areaSeq;
+    }
+
+    switch(sample->stage)
+    {
+    case ISP_STAT_CFG_UP_AVG:
+      ongoing->up.averageR = GetAvgStats(ISP_STAT_LOC_UP, ISP_RED, sample->accu[0], sample->areaPixels);
+      ongoing->up.averageG = GetAvgStats(ISP_STAT_LOC_UP, ISP_GREEN, sample->accu[1], sample->areaPixels);
+      ongoing->up.averageB = GetAvgStats(ISP_STAT_LOC_UP, ISP_BLUE, sample->accu[2], sample->areaPixels);
+      ongoing->up.averageL = LuminanceFromRGB(ongoing->up.averageR, ongoing->up.averageG, ongoing->up.averageB);
+      PublishStats(engine, ISP_SVC_STAT_IDX_UP, ISP_STAT_TYPE_AVG, frameId);
+      break;
 
-    memset(&ongoing->down, 0, sizeof(ongoing->down));
-    ongoing->downFrameIdStart = 0;
-    ongoing->downFrameIdEnd = 0;
+    case ISP_STAT_CFG_UP_BINS_0_2:
+    case ISP_STAT_CFG_UP_BINS_3_5:
+    case ISP_STAT_CFG_UP_BINS_6_8:
+    case ISP_STAT_CFG_UP_BINS_9_11:
+      part = sample->stage - ISP_STAT_CFG_UP_BINS_0_2;
+      ReadStatHistogram(sample, &ongoing->up.histogram[3 * part]);
+      CollectBins(engine, ISP_SVC_STAT_IDX_UP, part, frameId);
+      break;
+
+    case ISP_STAT_CFG_DOWN_AVG:
+      ongoing->down.averageR = GetAvgStats(ISP_STAT_LOC_DOWN, ISP_RED, sample->accu[0], sample->areaPixels);
+      ongoing->down.averageG = GetAvgStats(ISP_STAT_LOC_DOWN, ISP_GREEN, sample->accu[1], sample->areaPixels);
+      ongoing->down.averageB = GetAvgStats(ISP_STAT_LOC_DOWN, ISP_BLUE, sample->accu[2], sample->areaPixels);
+      IQParamConfig = ISP_SVC_IQParam_Get(hIsp);
+      if ((hIsp->sensorInfo.bayer_pattern == ISP_DEMOS_TYPE_MONO) || (!IQParamConfig->demosaicing.enable))
+      {
+        ongoing->down.averageL = LuminanceFromRGBMono(ongoing->down.averageR, ongoing->down.averageG, ongoing->down.averageB);
+      }
+      else
+      {
+        ongoing->down.averageL = LuminanceFromRGB(ongoing->down.averageR, ongoing->down.averageG, ongoing->down.averageB);
+      }
+      PublishStats(engine, ISP_SVC_STAT_IDX_DOWN, ISP_STAT_TYPE_AVG, frameId);
+      break;
+
+    case ISP_STAT_CFG_DOWN_BINS_0_2:
+    case ISP_STAT_CFG_DOWN_BINS_3_5:
+    case ISP_STAT_CFG_DOWN_BINS_6_8:
+    case ISP_STAT_CFG_DOWN_BINS_9_11:
+      part = sample->stage - ISP_STAT_CFG_DOWN_BINS_0_2;
+      ReadStatHistogram(sample, &ongoing->down.histogram[3 * part]);
+      CollectBins(engine, ISP_SVC_STAT_IDX_DOWN, part, frameId);
+      break;
+
+    default:
+      /* No Read */
+      break;
+    }
+
+    /* Give the slot back to the producer once decoded */
+    ISP_PLATFORM_MEMORY_BARRIER();
+    ring->tail = tail + 1U;
   }
 
-  if (((ISP_SVC_StatEngine.upRequest & ISP_STAT_TYPE_ALL_TMP) ||
-       (ISP_SVC_StatEngine.downRequest & ISP_STAT_TYPE_ALL_TMP)) &&
-      (frameId > ISP_SVC_StatEngine.requestAllCounter))
+  frameId = ISP_SVC_Misc_GetMainFrameId(hIsp);
+  if (((engine->upRequest & ISP_STAT_TYPE_ALL_TMP) ||
+       (engine->downRequest & ISP_STAT_TYPE_ALL_TMP)) &&
+      (frameId > engine->requestAllCounter))
   {
     /* Stop the special temporary mode "request all stats" when its delay expires */
-    ISP_SVC_StatEngine.upRequest &= ~ISP_STAT_TYPE_ALL_TMP;
-    ISP_SVC_StatEngine.downRequest &= ~ISP_STAT_TYPE_ALL_TMP;
+    engine->upRequest &= ~ISP_STAT_TYPE_ALL_TMP;
+    engine->downRequest &= ~ISP_STAT_TYPE_ALL_TMP;
   }
+}
 
-  /* Save the two last processed stages and go to next stage */
-  stagePrevious2 = stagePrevious1;
-  stagePrevious1 = ISP_SVC_StatEngine.stage;
-  ISP_SVC_StatEngine.stage = GetNextStatStage(ISP_SVC_StatEngine.stage);
+/**
+  * @brief  ISP_SVC_Stats_GetProfile
+  *         Get the profiling of the statistics interrupt handler
+  * @param  hIsp: ISP device handle
+  * @param  pProfile: pointer to the profiling counters (output parameter)
+  * @retval ISP status
+  */
+ISP_StatusTypeDef ISP_SVC_Stats_GetProfile(ISP_HandleTypeDef *hIsp, ISP_SVC_StatProfileTypeDef *pProfile)
+{
+  /* Check handle validity */
+  if ((hIsp == NULL) || (pProfile == NULL))
+  {
+    return ISP_ERR_EINVAL;
+  }
+
+  *pProfile = hIsp->svcContext.statEngine.profile;
+
+  return ISP_OK;
 }
 
 /**
@@ -1863,27 +1973,47 @@ void ISP_SVC_Stats_Gather(ISP_HandleTypeDef *hIsp)
   */
 ISP_StatusTypeDef ISP_SVC_Stats_ProcessCallbacks(ISP_HandleTypeDef *hIsp)
 {
-  (void)hIsp; /* unused */
+  ISP_SVC_StatEngineTypeDef *engine = &hIsp->svcContext.statEngine;
   ISP_SVC_StatStateTypeDef *pLastStat;
   ISP_SVC_StatRegisteredClient *client;
+  ISP_SVC_StatProfileTypeDef *profile = &engine->profile;
   ISP_StatusTypeDef retcb, ret = ISP_OK;
+  uint32_t latency;
 
-  pLastStat = &ISP_SVC_StatEngine.last;
+  pLastStat = &engine->last;
 
   for (uint32_t i = 0; i < ISP_SVC_STAT_MAX_CB; i++)
   {
-    client = &ISP_SVC_StatEngine.client[i];
+    client = &engine->client[i];
 
     if (client->callback == NULL)
       continue;
 
-    /* Check if stats are available for a client, comparing the location and the specified frameId */
-    if (((client->location == ISP_STAT_LOC_DOWN) && (client->refFrameId <= pLastStat->downFrameIdStart)) ||
-        ((client->location == ISP_STAT_LOC_UP) && (client->refFrameId <= pLastStat->upFrameIdStart)) ||
-        ((client->location == ISP_STAT_LOC_UP_AND_DOWN) && (client->refFrameId <= pLastStat->upFrameIdStart) && (client->refFrameId <= pLastStat->downFrameIdStart)))
+    /* Check if stats are available for a client, comparing the location, type and the specified frameId */
+    if (IsClientStatReady(engine, client))
     {
+      /* Report the number of frames the request waited for after the requested frame */
+      latency = ISP_SVC_Misc_GetMainFrameId(hIsp) - client->refFrameId;
+      if (client->type & (ISP_STAT_TYPE_BINS | ISP_STAT_TYPE_ALL_TMP))
+      {
+        profile->binsLatency = latency;
+        if (latency > profile->binsLatencyMax)
+        {
+          profile->binsLatencyMax = latency;
+        }
+      }
+      else
+      {
+        profile->avgLatency = latency;
+        if (latency > profile->avgLatencyMax)
+        {
+          profile->avgLatencyMax = latency;
+        }
+      }
+
       /* Copy the stats into the client buffer */
       *(client->pStats) = *pLastStat;
+      ISP_SVC_Misc_TraceEvent(hIsp, ISP_TRACE_STAT_READY);
 
       /* Call its callback */
       retcb = client->callback(client->pAlgo);
@@ -1915,7 +2045,7 @@ ISP_StatusTypeDef ISP_SVC_Stats_GetLatest(ISP_HandleTypeDef *hIsp, ISP_SVC_StatS
     return ISP_ERR_EINVAL;
   }
 
-  *pStats = ISP_SVC_StatEngine.last;
+  *pStats = hIsp->svcContext.statEngine.last;
 
   return ISP_OK;
 }
@@ -1936,6 +2066,7 @@ ISP_StatusTypeDef ISP_SVC_Stats_GetLatest(ISP_HandleTypeDef *hIsp, ISP_SVC_StatS
 ISP_StatusTypeDef ISP_SVC_Stats_GetNext(ISP_HandleTypeDef *hIsp, ISP_stat_ready_cb callback, ISP_AlgoTypeDef *pAlgo, ISP_SVC_StatStateTypeDef *pStats,
                                         ISP_SVC_StatLocation location, ISP_SVC_StatType type, uint32_t frameDelay)
 {
+  ISP_SVC_StatEngineTypeDef *engine;
   uint32_t i, refFrameId;
 
   /* Check handle validity */
@@ -1944,12 +2075,14 @@ ISP_StatusTypeDef ISP_SVC_Stats_GetNext(ISP_HandleTypeDef *hIsp, ISP_stat_ready_
     return ISP_ERR_EINVAL;
   }
 
+  engine = &hIsp->svcContext.statEngine;
+
   refFrameId = ISP_SVC_Misc_GetMainFrameId(hIsp) + frameDelay;
 
   /* Register the callback */
   for (i = 0; i < ISP_SVC_STAT_MAX_CB; i++)
   {
-    if (ISP_SVC_StatEngine.client[i].callback == NULL)
+    if (engine->client[i].callback == NULL)
       break;
   }
 
@@ -1962,26 +2095,26 @@ ISP_StatusTypeDef ISP_SVC_Stats_GetNext(ISP_HandleTypeDef *hIsp, ISP_stat_ready_
   /* Add this requested stat to the list of requested stats */
   if (location & ISP_STAT_LOC_UP)
   {
-    ISP_SVC_StatEngine.upRequest |= type;
+    engine->upRequest |= type;
   }
   if (location & ISP_STAT_LOC_DOWN)
   {
-    ISP_SVC_StatEngine.downRequest |= type;
+    engine->downRequest |= type;
   }
 
   if (type == ISP_STAT_TYPE_ALL_TMP)
   {
     /* Special case: request all stats for a short time (3 cycle) */
-    ISP_SVC_StatEngine.requestAllCounter = ISP_SVC_Misc_GetMainFrameId(hIsp) + 3 * ISP_STAT_CFG_CYCLE_SIZE;
+    engine->requestAllCounter = ISP_SVC_Misc_GetMainFrameId(hIsp) + 3 * ISP_STAT_CFG_CYCLE_SIZE;
   }
 
   /* Register client */
-  ISP_SVC_StatEngine.client[i].callback = callback;
-  ISP_SVC_StatEngine.client[i].pAlgo = pAlgo;
-  ISP_SVC_StatEngine.client[i].pStats = pStats;
-  ISP_SVC_StatEngine.client[i].location = location;
-  ISP_SVC_StatEngine.client[i].type = type;
-  ISP_SVC_StatEngine.client[i].refFrameId = refFrameId;
+  engine->client[i].callback = callback;
+  engine->client[i].pAlgo = pAlgo;
+  engine->client[i].pStats = pStats;
+  engine->client[i].location = location;
+  engine->client[i].type = type;
+  engine->client[i].refFrameId = refFrameId;
 
   return ISP_OK;
 }
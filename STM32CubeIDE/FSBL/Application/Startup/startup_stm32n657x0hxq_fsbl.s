@@ -42,6 +42,11 @@ defined in linker script */
 .word _sbss
 /* end address for the .bss section. defined in linker script */
 .word _ebss
+/* start address for the ITCM code, its initialization values and its end.
+defined in linker script */
+.word _siitcm
+.word _sitcm
+.word _eitcm
 
 /**
  * @brief  This is the code that gets called when the processor first
@@ -80,6 +85,31 @@ LoopCopyDataInit:
   cmp r4, r1
   bcc CopyDataInit
 
+/* Enable the ITCM (MEMSYSCTL->ITCMCR.EN) and copy the code placed there */
+  ldr r0, =0xE001E010
+  ldr r1, [r0]
+  orr r1, r1, #1
+  str r1, [r0]
+  dsb
+  isb
+  ldr r0, =_sitcm
+  ldr r1, =_eitcm
+  ldr r2, =_siitcm
+  movs r3, #0
+  b LoopCopyItcmInit
+
+CopyItcmInit:
+  ldr r4, [r2, r3]
+  str r4, [r0, r3]
+  adds r3, r3, #4
+
+LoopCopyItcmInit:
+  adds r4, r0, r3
+  cmp r4, r1
+  bcc CopyItcmInit
+  dsb
+  isb
+
 /* Zero fill the bss segment. */
   ldr r2, =_sbss
   ldr r4, =_ebss
@@ -0,0 +1,69 @@
+/**
+  ******************************************************************************
+  * @file    host_test.h
+  * @brief   Checks and report of the host tests. Each test is a program
+  *          returning 0 when all its checks passed.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __HOST_TEST_H
+#define __HOST_TEST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdio.h>
+
+/* Exported variables --------------------------------------------------------*/
+extern uint32_t HostTest_Checks;
+extern uint32_t HostTest_Failures;
+
+/* Exported macro ------------------------------------------------------------*/
+/* Record a check, report it when it fails */
+#define CHECK(cond)                                                              \
+  do {                                                                           \
+    HostTest_Checks++;                                                           \
+    if (!(cond))                                                                 \
+    {                                                                            \
+      HostTest_Failures++;                                                       \
+      (void)printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);      \
+    }                                                                            \
+  } while (0)
+
+/* Same, with the values compared */
+#define CHECK_EQ(a, b)                                                           \
+  do {                                                                           \
+    long long va_ = (long long)(a);                                              \
+    long long vb_ = (long long)(b);                                              \
+    HostTest_Checks++;                                                           \
+    if (va_ != vb_)                                                              \
+    {                                                                            \
+      HostTest_Failures++;                                                       \
+      (void)printf("%s:%d: check failed: %s == %s (%lld != %lld)\n",             \
+                   __FILE__, __LINE__, #a, #b, va_, vb_);                        \
+    }                                                                            \
+  } while (0)
+
+/* Exported functions ------------------------------------------------------- */
+int HostTest_Report(const char *name);
+uint64_t HostTest_NowNs(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HOST_TEST_H */
@@ -0,0 +1,96 @@
+/**
+  ******************************************************************************
+  * @file    isp_sim.h
+  * @brief   Simulated camera for the host build of the ISP middleware: a DCMIPP
+  *          register block the HAL driver programs, the statistic extraction
+  *          computed from synthetic RAW10 Bayer frames, and a sensor stand-in
+  *          behind the application helpers of the middleware.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __ISP_SIM_H
+#define __ISP_SIM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "isp_api.h"
+
+/* Exported constants --------------------------------------------------------*/
+#define ISP_SIM_MAX_INSTANCES     2U     /* Cameras simulated side by side */
+#define ISP_SIM_DELAY_MAX         4U     /* Longest sensor delay, in frames */
+
+/* Sensor stand-in: OV5647 1080p limits, black level of the RAW10 output */
+#define ISP_SIM_WIDTH             1920U
+#define ISP_SIM_HEIGHT            1080U
+#define ISP_SIM_GAIN_MAX          36000U /* mdB */
+#define ISP_SIM_EXPOSURE_MIN      50U    /* us */
+#define ISP_SIM_EXPOSURE_MAX      33000U /* us, 30 fps frame */
+#define ISP_SIM_BLACK_LEVEL       48U    /* RAW10 code */
+
+/* Exported types ------------------------------------------------------------*/
+/**
+  * @brief  Scene in front of the sensor
+  */
+typedef struct
+{
+  float Radiance;             /*!< RAW10 codes per us of exposure for a white patch at 0 dB */
+  float Response[3];          /*!< R, G, B channel response to the illuminant, G = 1 */
+} IspSim_SceneTypeDef;
+
+/**
+  * @brief  Registers latched by the DCMIPP at the frame start
+  */
+typedef struct
+{
+  uint32_t StatCr[3];
+  uint32_t StatStart;
+  uint32_t StatSize;
+  uint32_t BlackLevel;
+  uint32_t Exposure1;
+  uint32_t Exposure2;
+} IspSim_LatchTypeDef;
+
+/**
+  * @brief  Simulated camera
+  */
+typedef struct
+{
+  DCMIPP_TypeDef       Regs;                            /*!< Register block of the DCMIPP */
+  DCMIPP_HandleTypeDef hdcmipp;                         /*!< HAL handle on Regs, given to ISP_Init() */
+  IspSim_LatchTypeDef  Latch;                           /*!< Configuration of the frame being exposed */
+  IspSim_SceneTypeDef  Scene;
+  uint32_t             Delay;                           /*!< Frames before a sensor setting is applied */
+  int32_t              Gain;                            /*!< Gain set through the helper, mdB */
+  int32_t              Exposure;                        /*!< Exposure set through the helper, us */
+  int32_t              GainStage[ISP_SIM_DELAY_MAX];    /*!< Settings on their way to the sensor, */
+  int32_t              ExposureStage[ISP_SIM_DELAY_MAX];/*!< [0] being the one of the current frame */
+  uint32_t             FrameCount;
+  uint32_t             SetGainCount;
+  uint32_t             SetExposureCount;
+} IspSim_HandleTypeDef;
+
+/* Exported functions ------------------------------------------------------- */
+void IspSim_Init(IspSim_HandleTypeDef *hsim, uint32_t CameraInstance, const IspSim_SceneTypeDef *pScene,
+                 uint32_t Delay);
+void IspSim_GetHelpers(ISP_AppliHelpersTypeDef *pHelpers);
+void IspSim_Frame(IspSim_HandleTypeDef *hsim);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ISP_SIM_H */
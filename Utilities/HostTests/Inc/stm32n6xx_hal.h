@@ -0,0 +1,73 @@
+/**
+  ******************************************************************************
+  * @file    stm32n6xx_hal.h
+  * @brief   Host build of the firmware modules: the HAL and CMSIS headers of
+  *          the firmware are used as is, then the core intrinsics and the core
+  *          peripherals the modules use are redirected to host_hal.c.
+  *
+  *          The directory is searched before the HAL one, the firmware
+  *          sources include this file in place of the HAL header unchanged.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __HOST_STM32N6XX_HAL_H
+#define __HOST_STM32N6XX_HAL_H
+
+#include_next "stm32n6xx_hal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Exported variables --------------------------------------------------------*/
+/* Core and device peripherals, plain memory on the host */
+extern DWT_Type    HostDwt;
+extern CSI_TypeDef HostCsi;
+
+/* Tick, interrupt mask and D-Cache maintenance seen by the modules */
+extern uint32_t HostTick;
+extern uint32_t HostPrimask;
+extern uint32_t HostCleanCount;
+extern uint32_t HostInvalidateCount;
+extern uint32_t HostCacheLastAddress;
+extern int32_t  HostCacheLastSize;
+
+/* Exported functions ------------------------------------------------------- */
+void HostHal_Reset(void);
+void HostHal_CleanDCache(const volatile void *addr, int32_t dsize);
+void HostHal_InvalidateDCache(volatile void *addr, int32_t dsize);
+
+/* Core intrinsics -----------------------------------------------------------*/
+#define __get_PRIMASK()                       (HostPrimask)
+#define __set_PRIMASK(priMask)                ((void)(HostPrimask = (priMask)))
+#define __disable_irq()                       ((void)(HostPrimask = 1U))
+#define __enable_irq()                        ((void)(HostPrimask = 0U))
+#define __DSB()                               __sync_synchronize()
+#define __DMB()                               __sync_synchronize()
+#define __ISB()                               __sync_synchronize()
+
+#define SCB_CleanDCache_by_Addr(addr, dsize)      HostHal_CleanDCache((addr), (dsize))
+#define SCB_InvalidateDCache_by_Addr(addr, dsize) HostHal_InvalidateDCache((addr), (dsize))
+
+/* Peripherals at a fixed address */
+#undef  DWT
+#define DWT                                   (&HostDwt)
+#undef  CSI
+#define CSI                                   (&HostCsi)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __HOST_STM32N6XX_HAL_H */
@@ -0,0 +1,245 @@
+/**
+  ******************************************************************************
+  * @file    evision_stub.c
+  * @brief   Host stand-in of the evision AE and AWB libraries, which are only
+  *          delivered for Cortex-M. Same API and structures, simple
+  *          controllers behind them:
+  *           - AE: the exposure x gain product is scaled by target / luminance,
+  *             two stops per run at most, exposure first then gain, nothing
+  *             done within the tolerance of the target;
+  *           - AWB: the active profile moves one color temperature down when
+  *             the measure is red, up when it is blue.
+  *          The host tests check the middleware around them: statistics,
+  *          sensor delay, frame scheduling and register programming.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "evision-api-st-ae.h"
+#include "evision-api-awb.h"
+#include <math.h>
+#include <string.h>
+
+/* Private constants ---------------------------------------------------------*/
+/* Largest AE step, as a ratio of the exposure x gain product */
+#define EVISION_STUB_AE_STEP_MAX      4.0
+/* Red / blue balance, in log, beyond which the AWB changes of profile */
+#define EVISION_STUB_AWB_DRIFT        0.05
+
+/* Exported functions --------------------------------------------------------*/
+evision_st_ae_process_t *evision_api_st_ae_new(evision_api_log_callback log_cb)
+{
+  evision_st_ae_process_t *self = calloc(1, sizeof(*self));
+
+  if (self != NULL)
+  {
+    self->log_cb = log_cb;
+    self->state = EVISION_STATE_NONE;
+  }
+
+  return self;
+}
+
+evision_return_t evision_api_st_ae_delete(evision_st_ae_process_t *self)
+{
+  if (self == NULL)
+  {
+    return EVISION_RET_PARAM_ERR;
+  }
+
+  free(self);
+
+  return EVISION_RET_SUCCESS;
+}
+
+evision_return_t evision_api_st_ae_init(evision_st_ae_process_t *const self)
+{
+  evision_st_ae_hyper_param_t *hp;
+
+  if (self == NULL)
+  {
+    return EVISION_RET_PARAM_ERR;
+  }
+
+  hp = &self->hyper_params;
+  hp->target                    = EVISION_ST_AEC_LUM_TARGET;
+  hp->tolerance                 = EVISION_ST_AEC_TOLERANCE;
+  hp->gain_increment_coeff      = EVISION_ST_AEC_GAIN_INCREMENT_COEFF;
+  hp->gain_low_delta            = EVISION_ST_AEC_GAIN_LOW_DELTA;
+  hp->gain_high_delta           = EVISION_ST_AEC_GAIN_HIGH_DELTA;
+  hp->gain_low_increment_max    = EVISION_ST_AEC_GAIN_LOW_INC_MAX;
+  hp->gain_medium_increment_max = EVISION_ST_AEC_GAIN_MEDIUM_INC_MAX;
+  hp->gain_high_increment_max   = EVISION_ST_AEC_GAIN_HIGH_INC_MAX;
+  hp->exposure_up_ratio         = EVISION_ST_AEC_EXPOSURE_UP_RATIO;
+  hp->exposure_down_ratio       = EVISION_ST_AEC_EXPOSURE_DOWN_RATIO;
+  hp->exposure_min              = EVISION_ST_DEFAULT_EXPOSURE_MIN;
+  hp->exposure_max              = EVISION_ST_DEFAULT_EXPOSURE_MAX;
+  hp->gain_min                  = EVISION_ST_DEFAULT_GAIN_MIN;
+  hp->gain_max                  = EVISION_ST_DEFAULT_GAIN_MAX;
+  hp->dark_zone_lum_limit       = EVISION_ST_AEC_DARKZONE_LUM_LIMIT;
+  self->state = EVISION_STATE_INIT;
+
+  return EVISION_RET_SUCCESS;
+}
+
+evision_return_t evision_api_st_ae_process(evision_st_ae_process_t *const self, uint32_t current_gain,
+                                           uint32_t current_exposure, uint8_t average_lum)
+{
+  const evision_st_ae_hyper_param_t *hp;
+  double ratio, total, gain;
+
+  if ((self == NULL) || (self->state == EVISION_STATE_NONE))
+  {
+    return EVISION_RET_PARAM_ERR;
+  }
+
+  hp = &self->hyper_params;
+  self->state = EVISION_STATE_RUN;
+  self->new_gain = current_gain;
+  self->new_exposure = current_exposure;
+
+  if ((uint32_t)abs((int32_t)average_lum - (int32_t)hp->target) <= hp->tolerance)
+  {
+    return EVISION_RET_SUCCESS;
+  }
+
+  /* Exposure x linear gain, scaled towards the target */
+  ratio = (average_lum < hp->dark_zone_lum_limit) ? EVISION_STUB_AE_STEP_MAX :
+          ((double)hp->target / (double)average_lum);
+  ratio = EVISION_MIN(EVISION_MAX(ratio, 1.0 / EVISION_STUB_AE_STEP_MAX), EVISION_STUB_AE_STEP_MAX);
+  total = (double)current_exposure * pow(10.0, (double)current_gain / 20000.0) * ratio;
+
+  if (total <= (double)hp->exposure_max)
+  {
+    self->new_exposure = (uint32_t)EVISION_MAX(total, (double)hp->exposure_min);
+    self->new_gain = hp->gain_min;
+  }
+  else
+  {
+    self->new_exposure = hp->exposure_max;
+    gain = 20000.0 * log10(total / (double)hp->exposure_max);
+    self->new_gain = (uint32_t)EVISION_MIN(EVISION_MAX(gain, (double)hp->gain_min), (double)hp->gain_max);
+  }
+
+  return EVISION_RET_SUCCESS;
+}
+
+evision_awb_estimator_t *evision_api_awb_new(evision_api_log_callback log_cb)
+{
+  evision_awb_estimator_t *self = calloc(1, sizeof(*self));
+
+  if (self != NULL)
+  {
+    self->log_cb = log_cb;
+    self->state = EVISION_STATE_NONE;
+    self->awb_mode = EVISION_AWB_USE_PROFILE_SELECTION_AWB;
+  }
+
+  return self;
+}
+
+evision_return_t evision_api_awb_delete(evision_awb_estimator_t *self)
+{
+  if (self == NULL)
+  {
+    return EVISION_RET_PARAM_ERR;
+  }
+
+  free(self);
+
+  return EVISION_RET_SUCCESS;
+}
+
+void evision_api_awb_set_profile(evision_awb_profile_t *awb_profile, float color_temperature,
+                                 const float cfa_gains[EVISION_AWB_NB_DG_CFA_GAINS],
+                                 const float ccm_coefficients[EVISION_AWB_CCM_SIZE][EVISION_AWB_CCM_SIZE],
+                                 const float ccm_offsets[EVISION_AWB_CCM_SIZE])
+{
+  awb_profile->color_temperature = color_temperature;
+  memcpy(awb_profile->gain_values, cfa_gains, sizeof(awb_profile->gain_values));
+  memcpy(awb_profile->ccm_coefficients, ccm_coefficients, sizeof(awb_profile->ccm_coefficients));
+  memcpy(awb_profile->ccm_offsets, ccm_offsets, sizeof(awb_profile->ccm_offsets));
+}
+
+evision_return_t evision_api_awb_init_profiles(evision_awb_estimator_t *const self, double min_temp, double max_temp,
+                                               uint16_t nb_profiles,
+                                               float decision_thresholds[EVISION_AWB_MAX_PROFILE_COUNT - 1],
+                                               evision_awb_profile_t awb_profiles[EVISION_AWB_MAX_PROFILE_COUNT])
+{
+  evision_awb_calib_data_t *calib;
+  uint16_t i;
+
+  if ((self == NULL) || (nb_profiles == 0U) || (nb_profiles > EVISION_AWB_MAX_PROFILE_COUNT))
+  {
+    return EVISION_RET_PARAM_ERR;
+  }
+
+  calib = &self->calib_data;
+  calib->min_temp = min_temp;
+  calib->max_temp = max_temp;
+  calib->profiles_count = nb_profiles;
+  for (i = 0; i < nb_profiles; i++)
+  {
+    calib->profiles[i] = awb_profiles[i];
+    calib->temperatures[i] = awb_profiles[i].color_temperature;
+    if ((i + 1U) < nb_profiles)
+    {
+      calib->decision_thresholds[i] = decision_thresholds[i];
+    }
+  }
+  calib->active_profile = &calib->profiles[0];
+  self->state = EVISION_STATE_INIT;
+
+  return EVISION_RET_SUCCESS;
+}
+
+evision_return_t evision_api_awb_run_average(evision_awb_estimator_t *const self, const evision_image_t *const image,
+                                             uint8_t use_ext_meas, double ext_meas[EVISION_AWB_EXT_MEAS_SIZE])
+{
+  evision_awb_calib_data_t *calib;
+  double drift;
+  int32_t idx;
+
+  (void)image;
+
+  if ((self == NULL) || (self->state == EVISION_STATE_NONE) || (use_ext_meas == 0U) || (ext_meas == NULL))
+  {
+    return EVISION_RET_PARAM_ERR;
+  }
+
+  calib = &self->calib_data;
+  idx = (int32_t)(calib->active_profile - calib->profiles);
+
+  if ((ext_meas[0] > 0.0) && (ext_meas[2] > 0.0))
+  {
+    /* Red measure: lower color temperature, whose red gain is lower */
+    drift = log(ext_meas[0] / ext_meas[2]);
+    if ((drift > EVISION_STUB_AWB_DRIFT) && (idx > 0))
+    {
+      idx--;
+    }
+    else if ((drift < -EVISION_STUB_AWB_DRIFT) && (idx < ((int32_t)calib->profiles_count - 1)))
+    {
+      idx++;
+    }
+  }
+
+  calib->active_profile = &calib->profiles[idx];
+  self->out_temp = calib->active_profile->color_temperature;
+  memcpy(self->dg_cf, calib->active_profile->gain_values, sizeof(self->dg_cf));
+  memcpy(self->ccm, calib->active_profile->ccm_coefficients, sizeof(self->ccm));
+  memcpy(self->ccm_offsets, calib->active_profile->ccm_offsets, sizeof(self->ccm_offsets));
+  self->state = EVISION_STATE_RUN;
+
+  return EVISION_RET_SUCCESS;
+}
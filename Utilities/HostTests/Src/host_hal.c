@@ -0,0 +1,121 @@
+/**
+  ******************************************************************************
+  * @file    host_hal.c
+  * @brief   Host side of the HAL services and core peripherals used by the
+  *          firmware modules under test (see Inc/stm32n6xx_hal.h), and the
+  *          report of the host tests.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32n6xx_hal.h"
+#include "host_test.h"
+#include <string.h>
+#include <time.h>
+
+/* Exported variables --------------------------------------------------------*/
+DWT_Type    HostDwt;
+CSI_TypeDef HostCsi;
+
+uint32_t HostTick;
+uint32_t HostPrimask;
+uint32_t HostCleanCount;
+uint32_t HostInvalidateCount;
+uint32_t HostCacheLastAddress;
+int32_t  HostCacheLastSize;
+
+uint32_t HostTest_Checks;
+uint32_t HostTest_Failures;
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Back to the reset state of the host peripherals
+  * @retval None
+  */
+void HostHal_Reset(void)
+{
+  memset(&HostDwt, 0, sizeof(HostDwt));
+  memset(&HostCsi, 0, sizeof(HostCsi));
+  HostTick             = 0;
+  HostPrimask          = 0;
+  HostCleanCount       = 0;
+  HostInvalidateCount  = 0;
+  HostCacheLastAddress = 0;
+  HostCacheLastSize    = 0;
+}
+
+/**
+  * @brief  D-Cache clean by address, recorded
+  * @retval None
+  */
+void HostHal_CleanDCache(const volatile void *addr, int32_t dsize)
+{
+  HostCleanCount++;
+  HostCacheLastAddress = (uint32_t)(uintptr_t)addr;
+  HostCacheLastSize    = dsize;
+}
+
+/**
+  * @brief  D-Cache invalidate by address, recorded
+  * @retval None
+  */
+void HostHal_InvalidateDCache(volatile void *addr, int32_t dsize)
+{
+  HostInvalidateCount++;
+  HostCacheLastAddress = (uint32_t)(uintptr_t)addr;
+  HostCacheLastSize    = dsize;
+}
+
+/**
+  * @brief  HAL tick, advanced by the tests and by HAL_Delay()
+  * @retval Tick value, in ms
+  */
+uint32_t HAL_GetTick(void)
+{
+  return HostTick;
+}
+
+/**
+  * @brief  HAL delay, returns at once with the tick advanced
+  * @retval None
+  */
+void HAL_Delay(uint32_t Delay)
+{
+  HostTick += Delay;
+}
+
+/**
+  * @brief  Print the result of a test program
+  * @param  name  Test name
+  * @retval Program exit code, 0 if all the checks passed
+  */
+int HostTest_Report(const char *name)
+{
+  (void)printf("%s: %lu checks, %lu failed\n", name, (unsigned long)HostTest_Checks,
+               (unsigned long)HostTest_Failures);
+
+  return (HostTest_Failures == 0U) ? 0 : 1;
+}
+
+/**
+  * @brief  Monotonic time, for the benchmarks
+  * @retval Time in ns
+  */
+uint64_t HostTest_NowNs(void)
+{
+  struct timespec ts;
+
+  (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
@@ -0,0 +1,422 @@
+/**
+  ******************************************************************************
+  * @file    isp_sim.c
+  * @brief   Simulated camera for the host build of the ISP middleware.
+  *
+  *          The middleware programs the DCMIPP through the HAL driver built for
+  *          the host, on a register block in memory. At each frame:
+  *           - the statistic extraction registers latched at the start of the
+  *             frame (P1STxCR, P1STSTR, P1STSZR) are applied to a synthetic
+  *             RAW10 Bayer frame of the scene, and the accumulators are written
+  *             to P1STxSR as the DCMIPP does at the end of the frame, divided
+  *             by 256. The "post" sources see the black level (P1BLCCR) and
+  *             the exposure gains (P1EXCR1/2) latched with them;
+  *           - the registers written during the frame are latched for the next
+  *             one, so that a measure is read 2 VSYNC after its configuration
+  *             as on the device;
+  *           - the sensor gain and exposure set through the helpers after a
+  *             VSYNC are in the measures read Delay VSYNC later, the meaning
+  *             of sensorDelay in the IQ parameters.
+  *
+  *          The accumulators are computed on a grid of at most 64 x 48 Bayer
+  *          quads of the area and scaled to the area size, which keeps the
+  *          simulation at several thousand frames per second.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "isp_sim.h"
+#include <math.h>
+#include <string.h>
+
+/* Private constants ---------------------------------------------------------*/
+#define ISP_SIM_GRID_X        64U
+#define ISP_SIM_GRID_Y        48U
+
+/* Pixel kinds of a Bayer quad a statistic source is sampled on */
+#define ISP_SIM_R             0U
+#define ISP_SIM_G             1U
+#define ISP_SIM_B             2U
+#define ISP_SIM_L             3U
+
+/* Private macro -------------------------------------------------------------*/
+#define ISP_SIM_FIELD(reg, field)  (((reg) & field##_Msk) >> field##_Pos)
+
+/* Private variables ---------------------------------------------------------*/
+static IspSim_HandleTypeDef *IspSim_Instance[ISP_SIM_MAX_INSTANCES];
+
+/* Bins mode thresholds, per accumulator: lower / lowmid count the components
+ * below, upmid / up the components above */
+static const uint8_t IspSim_BinsThreshold[4][3] = {
+  {   4U,   8U,  16U },
+  {  32U,  64U, 128U },
+  { 127U, 191U, 224U },
+  { 239U, 247U, 251U },
+};
+
+/* Average mode range, [low, high[ */
+static const uint16_t IspSim_AverageRange[4][2] = {
+  {  0U, 256U },
+  { 16U, 240U },
+  { 32U, 224U },
+  { 64U, 192U },
+};
+
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  Reflectance of the scene: a horizontal gradient under a checkerboard
+  * @param  x  Column in the sensor frame
+  * @param  y  Line in the sensor frame
+  * @retval Reflectance, in [0, 1]
+  */
+static float IspSim_Reflectance(uint32_t x, uint32_t y)
+{
+  float refl = 0.08f + ((0.5f * (float)x) / (float)ISP_SIM_WIDTH);
+
+  if ((((x >> 7) + (y >> 7)) & 1U) != 0U)
+  {
+    refl += 0.25f;
+  }
+
+  return refl;
+}
+
+/**
+  * @brief  8-bit luminance, BT.601
+  * @retval Luminance
+  */
+static uint32_t IspSim_Luminance(const uint32_t *pRgb)
+{
+  return ((77U * pRgb[ISP_SIM_R]) + (150U * pRgb[ISP_SIM_G]) + (29U * pRgb[ISP_SIM_B]) + 128U) >> 8;
+}
+
+/**
+  * @brief  Component after the ISP exposure block
+  * @param  Value  Component, black level removed
+  * @param  Shift  Shift of the gain
+  * @param  Mult   Multiplier of the gain, 128 for x1
+  * @retval Component, saturated to 8 bits
+  */
+static uint32_t IspSim_ExposureGain(uint32_t Value, uint32_t Shift, uint32_t Mult)
+{
+  uint32_t out = ((Value * Mult) << Shift) >> 7;
+
+  return (out > 255U) ? 255U : out;
+}
+
+/**
+  * @brief  Expose the frame with the latched configuration and write the statistic
+  *         accumulators
+  * @param  hsim  Simulated camera
+  * @retval None
+  */
+static void IspSim_Expose(IspSim_HandleTypeDef *hsim)
+{
+  const IspSim_LatchTypeDef *latch = &hsim->Latch;
+  const IspSim_SceneTypeDef *scene = &hsim->Scene;
+  uint32_t hstart = ISP_SIM_FIELD(latch->StatStart, DCMIPP_P1STSTR_HSTART);
+  uint32_t vstart = ISP_SIM_FIELD(latch->StatStart, DCMIPP_P1STSTR_VSTART);
+  uint32_t hsize = ISP_SIM_FIELD(latch->StatSize, DCMIPP_P1STSZR_HSIZE);
+  uint32_t vsize = ISP_SIM_FIELD(latch->StatSize, DCMIPP_P1STSZR_VSIZE);
+  uint32_t blc[3], shift[3], mult[3];
+  uint32_t pre[4], post[4];
+  double accu[3] = { 0 };
+  double signal;
+  uint32_t nx, ny, i, j, c, m, x, y, raw, cr, src, value, kind, weight;
+  uint32_t nquads = 0;
+  volatile uint32_t *sr[3] = { &hsim->Regs.P1ST1SR, &hsim->Regs.P1ST2SR, &hsim->Regs.P1ST3SR };
+
+  /* Sensor: exposure and analog gain of this frame */
+  signal = scene->Radiance * (double)hsim->ExposureStage[0] * pow(10.0, (double)hsim->GainStage[0] / 20000.0);
+
+  /* Black level and exposure blocks, between the "pre" and "post" sources */
+  if ((latch->BlackLevel & DCMIPP_P1BLCCR_ENABLE) != 0U)
+  {
+    blc[ISP_SIM_R] = ISP_SIM_FIELD(latch->BlackLevel, DCMIPP_P1BLCCR_BLCR);
+    blc[ISP_SIM_G] = ISP_SIM_FIELD(latch->BlackLevel, DCMIPP_P1BLCCR_BLCG);
+    blc[ISP_SIM_B] = ISP_SIM_FIELD(latch->BlackLevel, DCMIPP_P1BLCCR_BLCB);
+  }
+  else
+  {
+    blc[ISP_SIM_R] = blc[ISP_SIM_G] = blc[ISP_SIM_B] = 0U;
+  }
+  if ((latch->Exposure1 & DCMIPP_P1EXCR1_ENABLE) != 0U)
+  {
+    shift[ISP_SIM_R] = ISP_SIM_FIELD(latch->Exposure1, DCMIPP_P1EXCR1_SHFR);
+    mult[ISP_SIM_R]  = ISP_SIM_FIELD(latch->Exposure1, DCMIPP_P1EXCR1_MULTR);
+    shift[ISP_SIM_G] = ISP_SIM_FIELD(latch->Exposure2, DCMIPP_P1EXCR2_SHFG);
+    mult[ISP_SIM_G]  = ISP_SIM_FIELD(latch->Exposure2, DCMIPP_P1EXCR2_MULTG);
+    shift[ISP_SIM_B] = ISP_SIM_FIELD(latch->Exposure2, DCMIPP_P1EXCR2_SHFB);
+    mult[ISP_SIM_B]  = ISP_SIM_FIELD(latch->Exposure2, DCMIPP_P1EXCR2_MULTB);
+  }
+  else
+  {
+    for (c = 0; c < 3U; c++)
+    {
+      shift[c] = 0U;
+      mult[c] = 128U;
+    }
+  }
+
+  nx = (hsize / 2U < ISP_SIM_GRID_X) ? (hsize / 2U) : ISP_SIM_GRID_X;
+  ny = (vsize / 2U < ISP_SIM_GRID_Y) ? (vsize / 2U) : ISP_SIM_GRID_Y;
+
+  for (j = 0; j < ny; j++)
+  {
+    y = (vstart + ((((2U * j) + 1U) * vsize) / (2U * ny))) & ~1U;
+    for (i = 0; i < nx; i++)
+    {
+      x = (hstart + ((((2U * i) + 1U) * hsize) / (2U * nx))) & ~1U;
+
+      /* RAW10 quad, both greens alike: the 8 MSB reach the statistics */
+      for (c = 0; c < 3U; c++)
+      {
+        raw = ISP_SIM_BLACK_LEVEL + (uint32_t)(signal * scene->Response[c] * IspSim_Reflectance(x, y));
+        raw = (raw > 1023U) ? 1023U : raw;
+        pre[c] = raw >> 2;
+        post[c] = IspSim_ExposureGain((pre[c] > blc[c]) ? (pre[c] - blc[c]) : 0U, shift[c], mult[c]);
+      }
+      pre[ISP_SIM_L] = IspSim_Luminance(pre);
+      post[ISP_SIM_L] = IspSim_Luminance(post);
+      nquads++;
+
+      for (m = 0; m < 3U; m++)
+      {
+        cr = latch->StatCr[m];
+        if ((cr & DCMIPP_P1ST1CR_ENABLE) == 0U)
+        {
+          continue;
+        }
+
+        /* R and B on 1 pixel of the quad, G on 2, demosaiced components and luminance on 4 */
+        src = ISP_SIM_FIELD(cr, DCMIPP_P1ST1CR_SRC);
+        kind = src & 3U;
+        value = (src < 4U) ? pre[kind] : post[kind];
+        weight = ((src >= 4U) || (kind == ISP_SIM_L)) ? 4U : ((kind == ISP_SIM_G) ? 2U : 1U);
+
+        if ((cr & DCMIPP_P1ST1CR_MODE) != 0U)
+        {
+          /* Bins: incremented of 256 per pixel in the bin of this accumulator */
+          uint32_t bins = ISP_SIM_FIELD(cr, DCMIPP_P1ST1CR_BINS);
+          const uint8_t *threshold = IspSim_BinsThreshold[bins];
+          if (((bins < 2U) && (value < threshold[m])) || ((bins >= 2U) && (value > threshold[m])))
+          {
+            accu[m] += 256.0 * (double)weight;
+          }
+        }
+        else
+        {
+          /* Average: incremented of the component */
+          const uint16_t *range = IspSim_AverageRange[ISP_SIM_FIELD(cr, DCMIPP_P1ST1CR_BINS)];
+          if ((value >= range[0]) && (value < range[1]))
+          {
+            accu[m] += (double)value * (double)weight;
+          }
+        }
+      }
+    }
+  }
+
+  /* Scale the grid to the area, the accumulators hold the sum divided by 256 */
+  for (m = 0; m < 3U; m++)
+  {
+    double total = (nquads != 0U) ? ((accu[m] * (double)(hsize * vsize)) / (4.0 * (double)nquads)) : 0.0;
+    *sr[m] = ((uint32_t)((total / 256.0) + 0.5)) & DCMIPP_P1ST1SR_ACCU;
+  }
+}
+
+/**
+  * @brief  Simulated camera of a middleware instance
+  * @retval Simulated camera, NULL if not registered
+  */
+static IspSim_HandleTypeDef *IspSim_Get(uint32_t Instance)
+{
+  return (Instance < ISP_SIM_MAX_INSTANCES) ? IspSim_Instance[Instance] : NULL;
+}
+
+/**
+  * @brief  Sensor info helper
+  */
+static ISP_StatusTypeDef IspSim_GetSensorInfo(uint32_t Instance, ISP_SensorInfoTypeDef *Info)
+{
+  if (IspSim_Get(Instance) == NULL)
+  {
+    return ISP_ERR_SENSORINFO;
+  }
+
+  memset(Info, 0, sizeof(*Info));
+  (void)strcpy(Info->name, "OV5647");
+  Info->bayer_pattern = ISP_DEMOS_TYPE_RGGB;
+  Info->color_depth   = 10U;
+  Info->width         = ISP_SIM_WIDTH;
+  Info->height        = ISP_SIM_HEIGHT;
+  Info->gain_min      = 0U;
+  Info->gain_max      = ISP_SIM_GAIN_MAX;
+  Info->exposure_min  = ISP_SIM_EXPOSURE_MIN;
+  Info->exposure_max  = ISP_SIM_EXPOSURE_MAX;
+
+  return ISP_OK;
+}
+
+/**
+  * @brief  Sensor gain setter helper, the gain is clamped to the sensor range
+  */
+static ISP_StatusTypeDef IspSim_SetSensorGain(uint32_t Instance, int32_t Gain)
+{
+  IspSim_HandleTypeDef *hsim = IspSim_Get(Instance);
+
+  if (hsim == NULL)
+  {
+    return ISP_ERR_SENSORGAIN;
+  }
+
+  hsim->Gain = (Gain < 0) ? 0 : ((Gain > (int32_t)ISP_SIM_GAIN_MAX) ? (int32_t)ISP_SIM_GAIN_MAX : Gain);
+  hsim->SetGainCount++;
+
+  return ISP_OK;
+}
+
+/**
+  * @brief  Sensor gain getter helper: the gain programmed, not yet in the frame
+  */
+static ISP_StatusTypeDef IspSim_GetSensorGain(uint32_t Instance, int32_t *Gain)
+{
+  IspSim_HandleTypeDef *hsim = IspSim_Get(Instance);
+
+  if (hsim == NULL)
+  {
+    return ISP_ERR_SENSORGAIN;
+  }
+
+  *Gain = hsim->Gain;
+
+  return ISP_OK;
+}
+
+/**
+  * @brief  Sensor exposure setter helper, the exposure is clamped to the sensor range
+  */
+static ISP_StatusTypeDef IspSim_SetSensorExposure(uint32_t Instance, int32_t Exposure)
+{
+  IspSim_HandleTypeDef *hsim = IspSim_Get(Instance);
+
+  if (hsim == NULL)
+  {
+    return ISP_ERR_SENSOREXPOSURE;
+  }
+
+  hsim->Exposure = (Exposure < (int32_t)ISP_SIM_EXPOSURE_MIN) ? (int32_t)ISP_SIM_EXPOSURE_MIN :
+                   ((Exposure > (int32_t)ISP_SIM_EXPOSURE_MAX) ? (int32_t)ISP_SIM_EXPOSURE_MAX : Exposure);
+  hsim->SetExposureCount++;
+
+  return ISP_OK;
+}
+
+/**
+  * @brief  Sensor exposure getter helper: the exposure programmed, not yet in the frame
+  */
+static ISP_StatusTypeDef IspSim_GetSensorExposure(uint32_t Instance, int32_t *Exposure)
+{
+  IspSim_HandleTypeDef *hsim = IspSim_Get(Instance);
+
+  if (hsim == NULL)
+  {
+    return ISP_ERR_SENSOREXPOSURE;
+  }
+
+  *Exposure = hsim->Exposure;
+
+  return ISP_OK;
+}
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  Initialize a simulated camera, used by the middleware instance whose
+  *         CameraInstance is the same
+  * @param  hsim            Simulated camera
+  * @param  CameraInstance  Camera instance given to ISP_Init()
+  * @param  pScene          Scene in front of the sensor
+  * @param  Delay           Frames before a sensor setting is applied, 1 for the next frame
+  * @retval None
+  */
+void IspSim_Init(IspSim_HandleTypeDef *hsim, uint32_t CameraInstance, const IspSim_SceneTypeDef *pScene,
+                 uint32_t Delay)
+{
+  uint32_t i;
+
+  memset(hsim, 0, sizeof(*hsim));
+  hsim->hdcmipp.Instance = &hsim->Regs;
+  hsim->hdcmipp.State = HAL_DCMIPP_STATE_READY;
+  hsim->Scene = *pScene;
+  hsim->Delay = (Delay == 0U) ? 1U : ((Delay > ISP_SIM_DELAY_MAX) ? ISP_SIM_DELAY_MAX : Delay);
+  hsim->Exposure = (int32_t)ISP_SIM_EXPOSURE_MIN;
+  for (i = 0; i < ISP_SIM_DELAY_MAX; i++)
+  {
+    hsim->ExposureStage[i] = hsim->Exposure;
+  }
+
+  if (CameraInstance < ISP_SIM_MAX_INSTANCES)
+  {
+    IspSim_Instance[CameraInstance] = hsim;
+  }
+}
+
+/**
+  * @brief  Application helpers of the middleware, on the sensor stand-in
+  * @param  pHelpers  Helpers given to ISP_Init()
+  * @retval None
+  */
+void IspSim_GetHelpers(ISP_AppliHelpersTypeDef *pHelpers)
+{
+  memset(pHelpers, 0, sizeof(*pHelpers));
+  pHelpers->GetSensorInfo     = IspSim_GetSensorInfo;
+  pHelpers->SetSensorGain     = IspSim_SetSensorGain;
+  pHelpers->GetSensorGain     = IspSim_GetSensorGain;
+  pHelpers->SetSensorExposure = IspSim_SetSensorExposure;
+  pHelpers->GetSensorExposure = IspSim_GetSensorExposure;
+}
+
+/**
+  * @brief  Capture a frame up to the VSYNC of the next one: the statistics of the frame
+  *         are written, then the registers and the sensor settings of the next frame are
+  *         latched. The caller then runs the VSYNC handlers of the middleware.
+  * @param  hsim  Simulated camera
+  * @retval None
+  */
+void IspSim_Frame(IspSim_HandleTypeDef *hsim)
+{
+  uint32_t i;
+
+  /* Settings of the sensor, the last one set reaching the frame Delay - 1 frames after */
+  hsim->GainStage[hsim->Delay - 1U] = hsim->Gain;
+  hsim->ExposureStage[hsim->Delay - 1U] = hsim->Exposure;
+
+  IspSim_Expose(hsim);
+
+  hsim->Latch.StatCr[0]  = hsim->Regs.P1ST1CR;
+  hsim->Latch.StatCr[1]  = hsim->Regs.P1ST2CR;
+  hsim->Latch.StatCr[2]  = hsim->Regs.P1ST3CR;
+  hsim->Latch.StatStart  = hsim->Regs.P1STSTR;
+  hsim->Latch.StatSize   = hsim->Regs.P1STSZR;
+  hsim->Latch.BlackLevel = hsim->Regs.P1BLCCR;
+  hsim->Latch.Exposure1  = hsim->Regs.P1EXCR1;
+  hsim->Latch.Exposure2  = hsim->Regs.P1EXCR2;
+
+  for (i = 0; (i + 1U) < hsim->Delay; i++)
+  {
+    hsim->GainStage[i] = hsim->GainStage[i + 1U];
+    hsim->ExposureStage[i] = hsim->ExposureStage[i + 1U];
+  }
+
+  hsim->FrameCount++;
+}
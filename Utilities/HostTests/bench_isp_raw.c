@@ -0,0 +1,109 @@
+/**
+  ******************************************************************************
+  * @file    bench_isp_raw.c
+  * @brief   Host benchmark of the software RAW pipeline (isp_raw.c).
+  *
+  *          ISP_RAW_Benchmark() develops a full OV5647 frame (2592x1944) and
+  *          a frame of the application (800x480) through the portable path,
+  *          for each RAW layout and demosaicing method, with the settings of
+  *          a daylight AWB profile and the output gamma. The host monotonic
+  *          clock stands for the device cycle counter (see the Makefile),
+  *          the throughput is printed in megapixels per second.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "isp_raw.h"
+#include "host_test.h"
+
+/* Private define ------------------------------------------------------------*/
+#define MAX_WIDTH         2592U
+#define MAX_HEIGHT        1944U
+
+/* Private types -------------------------------------------------------------*/
+typedef struct
+{
+  uint32_t Width;
+  uint32_t Height;
+  uint32_t Frames;         /*!< Frames developed per measure */
+} Size_TypeDef;
+
+/* Private variables ---------------------------------------------------------*/
+static const Size_TypeDef Sizes[] = { { 2592U, 1944U, 5U }, { 800U, 480U, 60U } };
+
+static uint8_t  Src[MAX_HEIGHT * MAX_WIDTH * 2U];
+static uint8_t  Dst[MAX_HEIGHT * MAX_WIDTH * 3U];
+static uint32_t Work[ISP_RAW_WORK_SIZE(MAX_WIDTH) / sizeof(uint32_t)];
+static ISP_RAW_HandleTypeDef hRaw;
+
+static uint32_t RandomState = 0x2545F491U;
+
+/* Private functions ---------------------------------------------------------*/
+static uint32_t Random(void)
+{
+  RandomState ^= RandomState << 13;
+  RandomState ^= RandomState >> 17;
+  RandomState ^= RandomState << 5;
+  return RandomState;
+}
+
+static void BenchFrame(const Size_TypeDef *pSize, ISP_RAW_FormatTypeDef Format, ISP_RAW_DemosaicTypeDef Demosaic)
+{
+  ISP_RAW_ConfTypeDef conf = {
+    .width = pSize->Width,
+    .height = pSize->Height,
+    .dstStride = pSize->Width * 3U,
+    .format = Format,
+    .bayer = ISP_RAW_BAYER_GBRG,
+    .demosaic = Demosaic,
+    .blackLevel = { 1, 16, 16, 16 },
+    .ispGain = { 1, 180000000U, 100000000U, 150000000U },
+    .colorConv = { 1, { { 160000000, -40000000, -20000000 },
+                        { -30000000, 150000000, -20000000 },
+                        { -10000000, -50000000, 160000000 } } },
+    .gammaEnable = 1,
+  };
+  uint32_t kpixel_per_s = 0;
+
+  conf.srcStride = (Format == ISP_RAW_FORMAT_RAW10_PACKED) ? ((conf.width * 5U) / 4U) : (conf.width * 2U);
+
+  CHECK_EQ(ISP_RAW_Init(&hRaw, &conf, Work, sizeof(Work)), ISP_OK);
+  CHECK_EQ(ISP_RAW_Benchmark(&hRaw, Src, Dst, pSize->Frames, &kpixel_per_s), ISP_OK);
+
+  (void)printf("  %4lux%-4lu %-6s %-8s %4lu.%01lu Mpix/s\n", (unsigned long)conf.width, (unsigned long)conf.height,
+               (Format == ISP_RAW_FORMAT_RAW10_PACKED) ? "RAW10" : "RAW16",
+               (Demosaic == ISP_RAW_DEMOS_EDGE) ? "edge" : "bilinear",
+               (unsigned long)(kpixel_per_s / 1000U), (unsigned long)((kpixel_per_s % 1000U) / 100U));
+}
+
+int main(void)
+{
+  uint32_t i, s;
+
+  /* 10-bit noise: RAW16 words, also read as packed RAW10 bytes */
+  for (i = 0; i < (sizeof(Src) / 2U); i++)
+  {
+    Src[2U * i] = (uint8_t)Random();
+    Src[(2U * i) + 1U] = (uint8_t)(Random() & 3U);
+  }
+
+  for (s = 0; s < (sizeof(Sizes) / sizeof(Sizes[0])); s++)
+  {
+    BenchFrame(&Sizes[s], ISP_RAW_FORMAT_RAW10_PACKED, ISP_RAW_DEMOS_BILINEAR);
+    BenchFrame(&Sizes[s], ISP_RAW_FORMAT_RAW10_PACKED, ISP_RAW_DEMOS_EDGE);
+    BenchFrame(&Sizes[s], ISP_RAW_FORMAT_RAW16, ISP_RAW_DEMOS_BILINEAR);
+    BenchFrame(&Sizes[s], ISP_RAW_FORMAT_RAW16, ISP_RAW_DEMOS_EDGE);
+  }
+
+  return HostTest_Report("bench_isp_raw");
+}
@@ -0,0 +1,452 @@
+/**
+  ******************************************************************************
+  * @file    test_dcmipp_irq.c
+  * @brief   Host test of FSBL/Src/dcmipp_irq.c against the HAL DCMIPP driver.
+  *
+  *          The DCMIPP and CSI registers are plain memory, the flag clear
+  *          registers being applied to the status registers at each callback
+  *          as the peripheral does. Each case sets the status, enable and
+  *          capture mode registers, runs HAL_DCMIPP_IRQHandler() and
+  *          HAL_DCMIPP_CSI_IRQHandler() on one copy and the dispatcher on
+  *          another, and checks that the same callbacks come in the same
+  *          order, each with the same flag cleared, interrupts enabled and
+  *          handle state, and that the registers and the handle end the same.
+  *          The cases are random, with the enabled events mostly in the
+  *          dispatcher configuration so that both its table walk and its
+  *          fallback to the HAL handlers are covered. The test reports the
+  *          time of a frame interrupt through each path.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "dcmipp_irq.h"
+#include "host_test.h"
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define LOG_SIZE        64U
+#define RANDOM_CASES    200000U
+#define BENCH_LOOPS     1000000U
+
+/* Every source of the two tables */
+#define PIPE_ALL_FLAGS  (DCMIPP_IRQ_PIPE_EVENTS | DCMIPP_FLAG_PIPE0_LIMIT | DCMIPP_FLAG_PIPE0_OVR | \
+                         DCMIPP_FLAG_PIPE1_OVR | DCMIPP_FLAG_PIPE2_OVR | DCMIPP_FLAG_PARALLEL_SYNC_ERROR | \
+                         DCMIPP_FLAG_AXI_TRANSFER_ERROR)
+#define CSI_ALL_FLAGS   (DCMIPP_IRQ_CSI_EVENTS | DCMIPP_CSI_FLAG_CCFIFO | DCMIPP_CSI_FLAG_SYNCERR | \
+                         DCMIPP_CSI_FLAG_WDERR | DCMIPP_CSI_FLAG_SPKTERR | DCMIPP_CSI_FLAG_IDERR | \
+                         DCMIPP_CSI_FLAG_CECCERR | DCMIPP_CSI_FLAG_ECCERR | DCMIPP_CSI_FLAG_CRCERR)
+
+/* Private types -------------------------------------------------------------*/
+typedef enum
+{
+  CB_PIPE_FRAME,
+  CB_PIPE_VSYNC,
+  CB_PIPE_LINE,
+  CB_PIPE_LIMIT,
+  CB_PIPE_ERROR,
+  CB_ERROR,
+  CB_CSI_LINE_ERROR,
+  CB_CSI_CCFIFO,
+  CB_CSI_SPKT,
+  CB_CSI_EOF,
+  CB_CSI_SOF,
+  CB_CSI_TIMER,
+  CB_CSI_LINE_BYTE,
+} Callback_TypeDef;
+
+/* Callback and the state it sees */
+typedef struct
+{
+  uint32_t Callback;
+  uint32_t Param;
+  uint32_t Cmfcr;           /* Flags cleared since the previous callback */
+  uint32_t Fcr0;
+  uint32_t Fcr1;
+  uint32_t Cmier;
+  uint32_t Ier0;
+  uint32_t Ier1;
+  uint32_t ErrorCode;
+  uint32_t State;
+  uint32_t PipeState[DCMIPP_NUM_OF_PIPES];
+} LogEntry_TypeDef;
+
+/* Registers and handle state of a case */
+typedef struct
+{
+  DCMIPP_TypeDef Regs;
+  CSI_TypeDef    Csi;
+  uint32_t       ErrorCode;
+  uint32_t       State;
+  uint32_t       PipeState[DCMIPP_NUM_OF_PIPES];
+} Device_TypeDef;
+
+/* Private variables ---------------------------------------------------------*/
+static DCMIPP_TypeDef          Regs;
+static DCMIPP_HandleTypeDef    Dcmipp = { .Instance = &Regs };
+static DcmippIrq_HandleTypeDef Irq;
+
+static LogEntry_TypeDef Log[LOG_SIZE];
+static uint32_t         LogCount;
+
+static uint32_t RandomState = 0x2545F491U;
+
+/* Private functions ---------------------------------------------------------*/
+static uint32_t Random(void)
+{
+  RandomState ^= RandomState << 13;
+  RandomState ^= RandomState >> 17;
+  RandomState ^= RandomState << 5;
+  return RandomState;
+}
+
+/**
+  * @brief  Record a callback, then clear the flags written to the clear registers
+  * @retval None
+  */
+static void LogCallback(Callback_TypeDef Callback, uint32_t Param)
+{
+  LogEntry_TypeDef *entry;
+  uint32_t i;
+
+  if (LogCount < LOG_SIZE)
+  {
+    entry = &Log[LogCount];
+    entry->Callback  = (uint32_t)Callback;
+    entry->Param     = Param;
+    entry->Cmfcr     = Regs.CMFCR;
+    entry->Fcr0      = CSI->FCR0;
+    entry->Fcr1      = CSI->FCR1;
+    entry->Cmier     = Regs.CMIER;
+    entry->Ier0      = CSI->IER0;
+    entry->Ier1      = CSI->IER1;
+    entry->ErrorCode = Dcmipp.ErrorCode;
+    entry->State     = (uint32_t)Dcmipp.State;
+    for (i = 0; i < DCMIPP_NUM_OF_PIPES; i++)
+    {
+      entry->PipeState[i] = (uint32_t)Dcmipp.PipeState[i];
+    }
+  }
+  LogCount++;
+
+  Regs.CMSR2 &= ~Regs.CMFCR;
+  Regs.CMFCR = 0;
+  CSI->SR0 &= ~CSI->FCR0;
+  CSI->FCR0 = 0;
+  CSI->SR1 &= ~CSI->FCR1;
+  CSI->FCR1 = 0;
+}
+
+static void Device_Load(const Device_TypeDef *pDevice)
+{
+  uint32_t i;
+
+  Regs = pDevice->Regs;
+  *CSI = pDevice->Csi;
+  Dcmipp.ErrorCode = pDevice->ErrorCode;
+  Dcmipp.State = (HAL_DCMIPP_StateTypeDef)pDevice->State;
+  for (i = 0; i < DCMIPP_NUM_OF_PIPES; i++)
+  {
+    Dcmipp.PipeState[i] = (HAL_DCMIPP_PipeStateTypeDef)pDevice->PipeState[i];
+  }
+  LogCount = 0;
+}
+
+static void Device_Save(Device_TypeDef *pDevice)
+{
+  uint32_t i;
+
+  memset(pDevice, 0, sizeof(*pDevice));
+  pDevice->Regs = Regs;
+  pDevice->Csi = *CSI;
+  pDevice->ErrorCode = Dcmipp.ErrorCode;
+  pDevice->State = (uint32_t)Dcmipp.State;
+  for (i = 0; i < DCMIPP_NUM_OF_PIPES; i++)
+  {
+    pDevice->PipeState[i] = (uint32_t)Dcmipp.PipeState[i];
+  }
+}
+
+/**
+  * @brief  Run one interrupt of each line through the HAL and the dispatcher
+  * @param  pStart  Registers and handle state before the interrupt
+  * @retval 1 if the callbacks, the registers and the handle state are the same
+  */
+static uint32_t CompareCase(const Device_TypeDef *pStart)
+{
+  static LogEntry_TypeDef hal_log[LOG_SIZE];
+  Device_TypeDef hal_end, irq_end;
+  uint32_t hal_count;
+
+  Device_Load(pStart);
+  HAL_DCMIPP_IRQHandler(&Dcmipp);
+  HAL_DCMIPP_CSI_IRQHandler(&Dcmipp);
+  Device_Save(&hal_end);
+  hal_count = LogCount;
+  memcpy(hal_log, Log, sizeof(hal_log));
+
+  Device_Load(pStart);
+  DcmippIrq_IRQHandler(&Irq);
+  DcmippIrq_CSI_IRQHandler(&Irq);
+  Device_Save(&irq_end);
+
+  return ((hal_count <= LOG_SIZE) && (LogCount == hal_count) &&
+          (memcmp(Log, hal_log, hal_count * sizeof(Log[0])) == 0) &&
+          (memcmp(&irq_end, &hal_end, sizeof(irq_end)) == 0)) ? 1U : 0U;
+}
+
+static void TestInit(void)
+{
+  DcmippIrq_ConfTypeDef conf = { 0 };
+
+  CHECK_EQ(DcmippIrq_Init(NULL, &Dcmipp, &conf), HAL_ERROR);
+  CHECK_EQ(DcmippIrq_Init(&Irq, NULL, &conf), HAL_ERROR);
+  CHECK_EQ(DcmippIrq_Init(&Irq, &Dcmipp, NULL), HAL_ERROR);
+  conf.PipeEvents = DCMIPP_FLAG_PIPE0_OVR;
+  CHECK_EQ(DcmippIrq_Init(&Irq, &Dcmipp, &conf), HAL_ERROR);
+  conf.PipeEvents = 0;
+  conf.CsiEvents = DCMIPP_CSI_FLAG_SPKT;
+  CHECK_EQ(DcmippIrq_Init(&Irq, &Dcmipp, &conf), HAL_ERROR);
+
+  /* Error sources only: limit, 3 overruns, 2 errors; FIFO full, 7 errors */
+  conf.CsiEvents = 0;
+  CHECK_EQ(DcmippIrq_Init(&Irq, &Dcmipp, &conf), HAL_OK);
+  CHECK_EQ(Irq.NbPipeEntries, 6U);
+  CHECK_EQ(Irq.NbCsiEntries, 8U);
+
+  conf.PipeEvents = DCMIPP_IRQ_PIPE_EVENTS;
+  conf.CsiEvents = DCMIPP_IRQ_CSI_EVENTS;
+  CHECK_EQ(DcmippIrq_Init(&Irq, &Dcmipp, &conf), HAL_OK);
+  CHECK_EQ(Irq.NbPipeEntries, DCMIPP_IRQ_MAX_PIPE_ENTRIES);
+  CHECK_EQ(Irq.NbCsiEntries, DCMIPP_IRQ_MAX_CSI_ENTRIES);
+  CHECK_EQ(Irq.PipeFlags, PIPE_ALL_FLAGS);
+  CHECK_EQ(Irq.CsiFlags, CSI_ALL_FLAGS);
+}
+
+static void TestSnapshot(void)
+{
+  DcmippIrq_ConfTypeDef conf = { DCMIPP_FLAG_PIPE0_FRAME | DCMIPP_FLAG_PIPE0_VSYNC, DCMIPP_CSI_FLAG_EOF0 };
+  Device_TypeDef start;
+
+  CHECK_EQ(DcmippIrq_Init(&Irq, &Dcmipp, &conf), HAL_OK);
+
+  /* End of a PIPE0 snapshot: VSYNC first, then the frame that stops the pipe */
+  memset(&start, 0, sizeof(start));
+  start.Regs.CMSR2 = DCMIPP_FLAG_PIPE0_FRAME | DCMIPP_FLAG_PIPE0_VSYNC;
+  start.Regs.CMIER = DCMIPP_IT_PIPE0_FRAME | DCMIPP_IT_PIPE0_VSYNC | DCMIPP_IT_PIPE0_OVR;
+  start.Regs.P0FCTCR = DCMIPP_MODE_SNAPSHOT;
+  start.Csi.SR0 = DCMIPP_CSI_FLAG_EOF0;
+  start.Csi.IER0 = DCMIPP_CSI_IT_EOF0;
+  start.PipeState[0] = (uint32_t)HAL_DCMIPP_PIPE_STATE_BUSY;
+  CHECK(CompareCase(&start) == 1U);
+
+  CHECK_EQ(LogCount, 3U);
+  CHECK_EQ(Log[0].Callback, CB_PIPE_VSYNC);
+  CHECK_EQ(Log[0].Cmfcr, DCMIPP_FLAG_PIPE0_VSYNC);
+  CHECK_EQ(Log[1].Callback, CB_PIPE_FRAME);
+  CHECK_EQ(Log[1].Cmfcr, DCMIPP_FLAG_PIPE0_FRAME);
+  CHECK_EQ(Log[1].Cmier, 0U);
+  CHECK_EQ(Log[1].PipeState[0], HAL_DCMIPP_PIPE_STATE_READY);
+  CHECK_EQ(Log[2].Callback, CB_CSI_EOF);
+  CHECK_EQ(Log[2].Param, DCMIPP_VIRTUAL_CHANNEL0);
+  CHECK_EQ(Log[2].Ier0, 0U);
+  CHECK_EQ(Regs.CMSR2, 0U);
+  CHECK_EQ(CSI->SR0, 0U);
+  CHECK_EQ(Irq.FallbackCount, 0U);
+}
+
+static void TestRandom(void)
+{
+  DcmippIrq_ConfTypeDef conf;
+  Device_TypeDef start;
+  uint32_t i, fallback, fast = 0, slow = 0, failures = 0;
+
+  for (i = 0; i < RANDOM_CASES; i++)
+  {
+    conf.PipeEvents = Random() & DCMIPP_IRQ_PIPE_EVENTS;
+    conf.CsiEvents  = Random() & DCMIPP_IRQ_CSI_EVENTS;
+    (void)DcmippIrq_Init(&Irq, &Dcmipp, &conf);
+
+    memset(&start, 0, sizeof(start));
+    start.Regs.CMSR2   = Random() & PIPE_ALL_FLAGS;
+    start.Regs.P0FCTCR = Random() & DCMIPP_P0FCTCR_CPTMODE;
+    start.Regs.P1FCTCR = Random() & DCMIPP_P1FCTCR_CPTMODE;
+    start.Regs.P2FCTCR = Random() & DCMIPP_P2FCTCR_CPTMODE;
+    start.Csi.SR0      = Random() & (CSI_ALL_FLAGS | DCMIPP_CSI_FLAG_SPKT);
+    start.ErrorCode    = Random() & 0xFU;
+    start.State        = (uint32_t)HAL_DCMIPP_STATE_READY;
+    start.PipeState[0] = (uint32_t)HAL_DCMIPP_PIPE_STATE_BUSY;
+    start.PipeState[1] = (uint32_t)HAL_DCMIPP_PIPE_STATE_BUSY;
+    start.PipeState[2] = (uint32_t)HAL_DCMIPP_PIPE_STATE_BUSY;
+
+    /* Mostly the configured events, else any event or a D-PHY error */
+    if ((Random() & 3U) != 0U)
+    {
+      start.Regs.CMIER = Random() & Irq.PipeFlags;
+      start.Csi.IER0   = Random() & Irq.CsiFlags;
+    }
+    else
+    {
+      start.Regs.CMIER = Random() & PIPE_ALL_FLAGS;
+      start.Csi.IER0   = Random() & (CSI_ALL_FLAGS | DCMIPP_CSI_FLAG_SPKT);
+      start.Csi.SR1    = Random() & (DCMIPP_CSI_FLAG_ESOTDL0 | DCMIPP_CSI_FLAG_ECTRLDL1);
+      start.Csi.IER1   = Random() & (DCMIPP_CSI_IT_ESOTDL0 | DCMIPP_CSI_IT_ECTRLDL1);
+    }
+
+    fallback = Irq.FallbackCount;
+    if (CompareCase(&start) == 0U)
+    {
+      failures++;
+    }
+    if (Irq.FallbackCount == fallback)
+    {
+      fast++;
+    }
+    else
+    {
+      slow++;
+    }
+  }
+
+  (void)printf("  %lu cases: %lu through the tables, %lu through the HAL handlers, %lu different\n",
+               (unsigned long)RANDOM_CASES, (unsigned long)fast, (unsigned long)slow, (unsigned long)failures);
+  CHECK_EQ(failures, 0U);
+  CHECK(fast > (RANDOM_CASES / 2U));
+  CHECK(slow > (RANDOM_CASES / 10U));
+}
+
+static void BenchFrame(void)
+{
+  /* Configuration of main.c; PIPE0 VSYNC and PIPE1 end of frame, continuous mode */
+  DcmippIrq_ConfTypeDef conf = { DCMIPP_IRQ_PIPE_EVENTS, DCMIPP_CSI_FLAG_SOF0 | DCMIPP_CSI_FLAG_EOF0 };
+  const uint32_t pending = DCMIPP_FLAG_PIPE0_VSYNC | DCMIPP_FLAG_PIPE1_FRAME;
+  uint64_t start, hal_ns, irq_ns;
+  uint32_t i;
+
+  CHECK_EQ(DcmippIrq_Init(&Irq, &Dcmipp, &conf), HAL_OK);
+  memset(&Regs, 0, sizeof(Regs));
+  Regs.CMIER = DCMIPP_IT_PIPE0_VSYNC | DCMIPP_IT_PIPE0_FRAME | DCMIPP_IT_PIPE0_OVR | DCMIPP_IT_PIPE1_FRAME |
+               DCMIPP_IT_PIPE1_VSYNC | DCMIPP_IT_PIPE1_OVR | DCMIPP_IT_AXI_TRANSFER_ERROR;
+
+  start = HostTest_NowNs();
+  for (i = 0; i < BENCH_LOOPS; i++)
+  {
+    Regs.CMSR2 = pending;
+    LogCount = 0;
+    HAL_DCMIPP_IRQHandler(&Dcmipp);
+  }
+  hal_ns = HostTest_NowNs() - start;
+
+  start = HostTest_NowNs();
+  for (i = 0; i < BENCH_LOOPS; i++)
+  {
+    Regs.CMSR2 = pending;
+    LogCount = 0;
+    DcmippIrq_IRQHandler(&Irq);
+  }
+  irq_ns = HostTest_NowNs() - start;
+
+  CHECK_EQ(Irq.FallbackCount, 0U);
+  (void)printf("  frame interrupt: HAL %lu ns, tables %lu ns on the host\n",
+               (unsigned long)(hal_ns / BENCH_LOOPS), (unsigned long)(irq_ns / BENCH_LOOPS));
+}
+
+/* HAL callbacks, recorded -------------------------------------------------*/
+void HAL_DCMIPP_PIPE_FrameEventCallback(DCMIPP_HandleTypeDef *hdcmipp, uint32_t Pipe)
+{
+  (void)hdcmipp;
+  LogCallback(CB_PIPE_FRAME, Pipe);
+}
+
+void HAL_DCMIPP_PIPE_VsyncEventCallback(DCMIPP_HandleTypeDef *hdcmipp, uint32_t Pipe)
+{
+  (void)hdcmipp;
+  LogCallback(CB_PIPE_VSYNC, Pipe);
+}
+
+void HAL_DCMIPP_PIPE_LineEventCallback(DCMIPP_HandleTypeDef *hdcmipp, uint32_t Pipe)
+{
+  (void)hdcmipp;
+  LogCallback(CB_PIPE_LINE, Pipe);
+}
+
+void HAL_DCMIPP_PIPE_LimitEventCallback(DCMIPP_HandleTypeDef *hdcmipp, uint32_t Pipe)
+{
+  (void)hdcmipp;
+  LogCallback(CB_PIPE_LIMIT, Pipe);
+}
+
+void HAL_DCMIPP_PIPE_ErrorCallback(DCMIPP_HandleTypeDef *hdcmipp, uint32_t Pipe)
+{
+  (void)hdcmipp;
+  LogCallback(CB_PIPE_ERROR, Pipe);
+}
+
+void HAL_DCMIPP_ErrorCallback(DCMIPP_HandleTypeDef *hdcmipp)
+{
+  (void)hdcmipp;
+  LogCallback(CB_ERROR, 0);
+}
+
+void HAL_DCMIPP_CSI_LineErrorCallback(DCMIPP_HandleTypeDef *hdcmipp, uint32_t DataLane)
+{
+  (void)hdcmipp;
+  LogCallback(CB_CSI_LINE_ERROR, DataLane);
+}
+
+void HAL_DCMIPP_CSI_ClockChangerFifoFullEventCallback(DCMIPP_HandleTypeDef *hdcmipp)
+{
+  (void)hdcmipp;
+  LogCallback(CB_CSI_CCFIFO, 0);
+}
+
+void HAL_DCMIPP_CSI_ShortPacketDetectionEventCallback(DCMIPP_HandleTypeDef *hdcmipp)
+{
+  (void)hdcmipp;
+  LogCallback(CB_CSI_SPKT, 0);
+}
+
+void HAL_DCMIPP_CSI_EndOfFrameEventCallback(DCMIPP_HandleTypeDef *hdcmipp, uint32_t VirtualChannel)
+{
+  (void)hdcmipp;
+  LogCallback(CB_CSI_EOF, VirtualChannel);
+}
+
+void HAL_DCMIPP_CSI_StartOfFrameEventCallback(DCMIPP_HandleTypeDef *hdcmipp, uint32_t VirtualChannel)
+{
+  (void)hdcmipp;
+  LogCallback(CB_CSI_SOF, VirtualChannel);
+}
+
+void HAL_DCMIPP_CSI_TimerCounterEventCallback(DCMIPP_HandleTypeDef *hdcmipp, uint32_t Timer)
+{
+  (void)hdcmipp;
+  LogCallback(CB_CSI_TIMER, Timer);
+}
+
+void HAL_DCMIPP_CSI_LineByteEventCallback(DCMIPP_HandleTypeDef *hdcmipp, uint32_t Counter)
+{
+  (void)hdcmipp;
+  LogCallback(CB_CSI_LINE_BYTE, Counter);
+}
+
+int main(void)
+{
+  HostHal_Reset();
+
+  TestInit();
+  TestSnapshot();
+  TestRandom();
+  BenchFrame();
+
+  return HostTest_Report("dcmipp_irq");
+}
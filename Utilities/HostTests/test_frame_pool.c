@@ -0,0 +1,293 @@
+/**
+  ******************************************************************************
+  * @file    test_frame_pool.c
+  * @brief   Host test of FSBL/Src/frame_pool.c.
+  *
+  *          The pool only handles buffer addresses, the regions are address
+  *          ranges of the device memory map. The D-Cache maintenance and the
+  *          interrupt mask are recorded by the host HAL. The test checks the
+  *          carving of the regions (alignment, no overlap, no overrun), the
+  *          exhaustion of the pool, the reference count lifetime of a buffer
+  *          and the cache maintenance at each ownership transition, then runs
+  *          random allocations, retains and releases against a model.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "frame_pool.h"
+#include "host_test.h"
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define AXISRAM_BASE       0x34200000U
+#define PSRAM_BASE         0x90000000U
+#define FRAME_SIZE         (800U * 480U * 2U + 5U)  /* Not a multiple of a cache line */
+#define RANDOM_STEPS       100000U
+
+/* Private variables ---------------------------------------------------------*/
+static FramePool_HandleTypeDef Pool;
+static uint32_t RandomState = 0x2545F491U;
+
+/* Private functions ---------------------------------------------------------*/
+static uint32_t Random(void)
+{
+  RandomState ^= RandomState << 13;
+  RandomState ^= RandomState >> 17;
+  RandomState ^= RandomState << 5;
+  return RandomState;
+}
+
+static void TestRegions(void)
+{
+  uint32_t i, j, region_end;
+
+  CHECK_EQ(FramePool_Init(&Pool, 0), HAL_ERROR);
+  CHECK_EQ(FramePool_Init(NULL, FRAME_SIZE), HAL_ERROR);
+
+  CHECK_EQ(FramePool_Init(&Pool, FRAME_SIZE), HAL_OK);
+  CHECK_EQ(Pool.BufferSize % FRAME_POOL_ALIGN, 0U);
+  CHECK(Pool.BufferSize >= FRAME_SIZE);
+  CHECK(Pool.BufferSize < (FRAME_SIZE + FRAME_POOL_ALIGN));
+
+  /* Unaligned start, room for 3 buffers but not for 4 */
+  region_end = AXISRAM_BASE + 5U + (4U * Pool.BufferSize) - 1U;
+  CHECK_EQ(FramePool_AddRegion(&Pool, AXISRAM_BASE + 5U, (4U * Pool.BufferSize) - 1U), HAL_OK);
+  CHECK_EQ(Pool.NbBuffers, 3U);
+
+  /* Too small for one buffer */
+  CHECK_EQ(FramePool_AddRegion(&Pool, PSRAM_BASE, Pool.BufferSize - 1U), HAL_ERROR);
+  CHECK_EQ(Pool.NbBuffers, 3U);
+
+  /* Wrapping past the end of the address space */
+  CHECK_EQ(FramePool_AddRegion(&Pool, 0xFFFFFF00U, Pool.BufferSize), HAL_ERROR);
+  CHECK_EQ(Pool.NbBuffers, 3U);
+
+  /* Second region, the pool stops at FRAME_POOL_MAX_BUFFERS */
+  CHECK_EQ(FramePool_AddRegion(&Pool, PSRAM_BASE, 32U * 1024U * 1024U), HAL_OK);
+  CHECK_EQ(Pool.NbBuffers, FRAME_POOL_MAX_BUFFERS);
+  CHECK_EQ(FramePool_AddRegion(&Pool, PSRAM_BASE + (16U * 1024U * 1024U), Pool.BufferSize), HAL_ERROR);
+
+  /* Aligned, inside their region, no overlap */
+  for (i = 0; i < Pool.NbBuffers; i++)
+  {
+    uint32_t start = Pool.Buffer[i].Address;
+    uint32_t end = start + Pool.BufferSize;
+
+    CHECK_EQ(start % FRAME_POOL_ALIGN, 0U);
+    CHECK(((start >= AXISRAM_BASE) && (end <= region_end)) ||
+          ((start >= PSRAM_BASE) && (end <= (PSRAM_BASE + (32U * 1024U * 1024U)))));
+    CHECK_EQ(Pool.Buffer[i].RefCount, 0U);
+    for (j = 0; j < i; j++)
+    {
+      CHECK((end <= Pool.Buffer[j].Address) || (start >= (Pool.Buffer[j].Address + Pool.BufferSize)));
+    }
+  }
+  CHECK_EQ(FramePool_GetFreeCount(&Pool), FRAME_POOL_MAX_BUFFERS);
+}
+
+static void TestExhaustion(void)
+{
+  uint32_t address[FRAME_POOL_MAX_BUFFERS];
+  uint32_t i, j, extra;
+
+  CHECK_EQ(FramePool_Init(&Pool, FRAME_SIZE), HAL_OK);
+  CHECK_EQ(FramePool_AddRegion(&Pool, AXISRAM_BASE, 4U * Pool.BufferSize), HAL_OK);
+
+  /* Distinct buffers until the pool is empty */
+  for (i = 0; i < 4U; i++)
+  {
+    CHECK_EQ(FramePool_Alloc(&Pool, &address[i]), HAL_OK);
+    CHECK_EQ(FramePool_GetRefCount(&Pool, address[i]), 1U);
+    for (j = 0; j < i; j++)
+    {
+      CHECK(address[i] != address[j]);
+    }
+  }
+  CHECK_EQ(FramePool_GetFreeCount(&Pool), 0U);
+
+  /* Refused and counted, the address left untouched */
+  extra = 0xDEADBEEFU;
+  CHECK_EQ(FramePool_Alloc(&Pool, &extra), HAL_BUSY);
+  CHECK_EQ(FramePool_Alloc(&Pool, &extra), HAL_BUSY);
+  CHECK_EQ(extra, 0xDEADBEEFU);
+  CHECK_EQ(Pool.FailCount, 2U);
+
+  /* A released buffer is the next one allocated */
+  CHECK_EQ(FramePool_Release(&Pool, address[2]), HAL_OK);
+  CHECK_EQ(FramePool_GetFreeCount(&Pool), 1U);
+  CHECK_EQ(FramePool_Alloc(&Pool, &extra), HAL_OK);
+  CHECK_EQ(extra, address[2]);
+  CHECK_EQ(Pool.FailCount, 2U);
+}
+
+static void TestRefCount(void)
+{
+  uint32_t address, primask;
+
+  CHECK_EQ(FramePool_Init(&Pool, FRAME_SIZE), HAL_OK);
+  CHECK_EQ(FramePool_AddRegion(&Pool, AXISRAM_BASE, 2U * Pool.BufferSize), HAL_OK);
+  CHECK_EQ(FramePool_Alloc(&Pool, &address), HAL_OK);
+
+  /* Passed to two more stages */
+  CHECK_EQ(FramePool_Retain(&Pool, address), HAL_OK);
+  CHECK_EQ(FramePool_Retain(&Pool, address), HAL_OK);
+  CHECK_EQ(FramePool_GetRefCount(&Pool, address), 3U);
+
+  /* Back to the pool with the last reference only */
+  CHECK_EQ(FramePool_Release(&Pool, address), HAL_OK);
+  CHECK_EQ(FramePool_Release(&Pool, address), HAL_OK);
+  CHECK_EQ(FramePool_GetFreeCount(&Pool), 1U);
+  CHECK_EQ(FramePool_Release(&Pool, address), HAL_OK);
+  CHECK_EQ(FramePool_GetRefCount(&Pool, address), 0U);
+  CHECK_EQ(FramePool_GetFreeCount(&Pool), 2U);
+
+  /* A free buffer can be neither retained nor released again */
+  CHECK_EQ(FramePool_Release(&Pool, address), HAL_ERROR);
+  CHECK_EQ(FramePool_Retain(&Pool, address), HAL_ERROR);
+  CHECK_EQ(FramePool_GetFreeCount(&Pool), 2U);
+
+  /* Unknown addresses, inside a buffer or out of the pool */
+  CHECK_EQ(FramePool_Retain(&Pool, address + FRAME_POOL_ALIGN), HAL_ERROR);
+  CHECK_EQ(FramePool_Release(&Pool, PSRAM_BASE), HAL_ERROR);
+  CHECK_EQ(FramePool_GetRefCount(&Pool, PSRAM_BASE), 0U);
+
+  /* The interrupt mask of the caller is restored */
+  for (primask = 0; primask < 2U; primask++)
+  {
+    HostPrimask = primask;
+    CHECK_EQ(FramePool_Alloc(&Pool, &address), HAL_OK);
+    CHECK_EQ(HostPrimask, primask);
+    CHECK_EQ(FramePool_Retain(&Pool, address), HAL_OK);
+    CHECK_EQ(HostPrimask, primask);
+    CHECK_EQ(FramePool_Release(&Pool, address), HAL_OK);
+    CHECK_EQ(FramePool_Release(&Pool, address), HAL_OK);
+    CHECK_EQ(HostPrimask, primask);
+  }
+  HostPrimask = 0;
+}
+
+static void TestDeviceAccess(void)
+{
+  uint32_t address;
+
+  HostHal_Reset();
+  CHECK_EQ(FramePool_Init(&Pool, FRAME_SIZE), HAL_OK);
+  CHECK_EQ(FramePool_AddRegion(&Pool, AXISRAM_BASE, Pool.BufferSize), HAL_OK);
+  CHECK_EQ(FramePool_Alloc(&Pool, &address), HAL_OK);
+
+  /* Read by a master: the CPU lines are cleaned, nothing to do at the end */
+  CHECK_EQ(FramePool_BeginDeviceAccess(&Pool, address, FRAME_POOL_OWNER_DEVICE_READ), HAL_OK);
+  CHECK_EQ(HostCleanCount, 1U);
+  CHECK_EQ(HostCacheLastAddress, address);
+  CHECK_EQ(HostCacheLastSize, (int32_t)Pool.BufferSize);
+  CHECK_EQ(FramePool_BeginDeviceAccess(&Pool, address, FRAME_POOL_OWNER_DEVICE_WRITE), HAL_ERROR);
+  CHECK_EQ(FramePool_EndDeviceAccess(&Pool, address), HAL_OK);
+  CHECK_EQ(HostCleanCount, 1U);
+  CHECK_EQ(HostInvalidateCount, 0U);
+  CHECK_EQ(FramePool_EndDeviceAccess(&Pool, address), HAL_ERROR);
+
+  /* Written by a master: invalidated before, and again before the CPU reads */
+  CHECK_EQ(FramePool_BeginDeviceAccess(&Pool, address, FRAME_POOL_OWNER_DEVICE_WRITE), HAL_OK);
+  CHECK_EQ(HostInvalidateCount, 1U);
+  CHECK_EQ(FramePool_EndDeviceAccess(&Pool, address), HAL_OK);
+  CHECK_EQ(HostInvalidateCount, 2U);
+  CHECK_EQ(HostCacheLastAddress, address);
+  CHECK_EQ(HostCacheLastSize, (int32_t)Pool.BufferSize);
+
+  /* Released while a master writes it: the next user gets no stale line */
+  CHECK_EQ(FramePool_BeginDeviceAccess(&Pool, address, FRAME_POOL_OWNER_DEVICE_WRITE), HAL_OK);
+  CHECK_EQ(FramePool_Retain(&Pool, address), HAL_OK);
+  CHECK_EQ(FramePool_Release(&Pool, address), HAL_OK);
+  CHECK_EQ(HostInvalidateCount, 3U);
+  CHECK_EQ(FramePool_Release(&Pool, address), HAL_OK);
+  CHECK_EQ(HostInvalidateCount, 4U);
+  CHECK_EQ(Pool.Buffer[0].Owner, FRAME_POOL_OWNER_CPU);
+
+  /* A free buffer is handed to no master, the CPU is not a master */
+  CHECK_EQ(FramePool_BeginDeviceAccess(&Pool, address, FRAME_POOL_OWNER_DEVICE_READ), HAL_ERROR);
+  CHECK_EQ(FramePool_Alloc(&Pool, &address), HAL_OK);
+  CHECK_EQ(FramePool_BeginDeviceAccess(&Pool, address, FRAME_POOL_OWNER_CPU), HAL_ERROR);
+  CHECK_EQ(HostCleanCount, 1U);
+  CHECK_EQ(HostInvalidateCount, 4U);
+}
+
+static void TestRandom(void)
+{
+  uint32_t refs[FRAME_POOL_MAX_BUFFERS] = { 0 };
+  uint32_t step, i, address, free_count, errors = 0;
+
+  CHECK_EQ(FramePool_Init(&Pool, FRAME_SIZE), HAL_OK);
+  CHECK_EQ(FramePool_AddRegion(&Pool, AXISRAM_BASE, 6U * Pool.BufferSize), HAL_OK);
+
+  for (step = 0; step < RANDOM_STEPS; step++)
+  {
+    i = Random() % Pool.NbBuffers;
+    switch (Random() % 3U)
+    {
+      case 0:
+        if (FramePool_Alloc(&Pool, &address) == HAL_OK)
+        {
+          for (i = 0; (i < Pool.NbBuffers) && (Pool.Buffer[i].Address != address); i++)
+          {
+          }
+          if ((i == Pool.NbBuffers) || (refs[i] != 0U))
+          {
+            errors++;
+          }
+          else
+          {
+            refs[i] = 1;
+          }
+        }
+        else
+        {
+          errors += (FramePool_GetFreeCount(&Pool) != 0U) ? 1U : 0U;
+        }
+        break;
+
+      case 1:
+        errors += ((FramePool_Retain(&Pool, Pool.Buffer[i].Address) == HAL_OK) != (refs[i] != 0U)) ? 1U : 0U;
+        refs[i] += (refs[i] != 0U) ? 1U : 0U;
+        break;
+
+      default:
+        errors += ((FramePool_Release(&Pool, Pool.Buffer[i].Address) == HAL_OK) != (refs[i] != 0U)) ? 1U : 0U;
+        refs[i] -= (refs[i] != 0U) ? 1U : 0U;
+        break;
+    }
+
+    /* Same references and free buffers as the model */
+    free_count = 0;
+    for (i = 0; i < Pool.NbBuffers; i++)
+    {
+      errors += (FramePool_GetRefCount(&Pool, Pool.Buffer[i].Address) != refs[i]) ? 1U : 0U;
+      free_count += (refs[i] == 0U) ? 1U : 0U;
+    }
+    errors += (FramePool_GetFreeCount(&Pool) != free_count) ? 1U : 0U;
+  }
+
+  CHECK_EQ(errors, 0U);
+}
+
+int main(void)
+{
+  HostHal_Reset();
+
+  TestRegions();
+  TestExhaustion();
+  TestRefCount();
+  TestDeviceAccess();
+  TestRandom();
+
+  return HostTest_Report("frame_pool");
+}
@@ -0,0 +1,342 @@
+/**
+  ******************************************************************************
+  * @file    test_frame_ring.c
+  * @brief   Host test of FSBL/Src/frame_ring.c.
+  *
+  *          The DCMIPP double buffer mode and the LTDC shadow reload are
+  *          simulated: the DCMIPP switches slot and latches the slot address
+  *          at each frame end, the LTDC takes the shadow address at vertical
+  *          blanking. Frame ends, vertical blankings and the application
+  *          (claim, present, release, sometimes late by several frames) are
+  *          interleaved at random, and after each event the test checks that
+  *          the DCMIPP only writes a buffer the ring gave it, that the LTDC
+  *          never scans out the buffer being written and that a claimed frame
+  *          is not overwritten before it is given back.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "frame_ring.h"
+#include "host_test.h"
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define BUFFER_BASE        0x34000000U
+#define BUFFER_STRIDE      0x00100000U
+#define FRAME_PERIOD       33U      /* Ticks between two frame ends         */
+#define VBLANK_PERIOD      16U      /* Ticks between two vertical blankings */
+#define RANDOM_STEPS       200000U
+
+/* Private types -------------------------------------------------------------*/
+typedef struct
+{
+  uint32_t Address[2];      /* DBM slot registers                            */
+  uint32_t Slot;            /* Slot being written                            */
+  uint32_t Writing;         /* Address latched for the frame being written   */
+  uint32_t Started;
+  uint32_t Shadow;          /* LTDC layer address register                   */
+  uint32_t ScanOut;         /* Address scanned out                           */
+  uint32_t ReloadPending;
+} Sim_TypeDef;
+
+/* Private variables ---------------------------------------------------------*/
+static DCMIPP_HandleTypeDef hdcmipp;
+static LTDC_HandleTypeDef hltdc;
+static FrameRing_HandleTypeDef Ring;
+static Sim_TypeDef Sim;
+static uint32_t Content[FRAME_RING_MAX_BUFFERS];   /* Frame number held by each buffer */
+static uint32_t RandomState = 0x12345678U;
+
+/* Simulated HAL -------------------------------------------------------------*/
+HAL_StatusTypeDef HAL_DCMIPP_CSI_PIPE_DoubleBufferStart(DCMIPP_HandleTypeDef *phdcmipp, uint32_t Pipe,
+                                                        uint32_t VirtualChannel, uint32_t DstAddress0,
+                                                        uint32_t DstAddress1, uint32_t CaptureMode)
+{
+  (void)phdcmipp;
+  (void)Pipe;
+  (void)VirtualChannel;
+  (void)CaptureMode;
+  Sim.Address[0] = DstAddress0;
+  Sim.Address[1] = DstAddress1;
+  Sim.Slot       = 0;
+  Sim.Writing    = DstAddress0;
+  Sim.Started    = 1;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DCMIPP_PIPE_SetMemoryAddress(DCMIPP_HandleTypeDef *phdcmipp, uint32_t Pipe, uint32_t Memory,
+                                                   uint32_t DstAddress)
+{
+  (void)phdcmipp;
+  (void)Pipe;
+  Sim.Address[(Memory == DCMIPP_MEMORY_ADDRESS_0) ? 0U : 1U] = DstAddress;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_LTDC_SetAddress_NoReload(LTDC_HandleTypeDef *phltdc, uint32_t Address, uint32_t LayerIdx)
+{
+  (void)phltdc;
+  (void)LayerIdx;
+  Sim.Shadow = Address;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_LTDC_Reload(LTDC_HandleTypeDef *phltdc, uint32_t ReloadType)
+{
+  (void)phltdc;
+  if (ReloadType == LTDC_RELOAD_IMMEDIATE)
+  {
+    Sim.ScanOut = Sim.Shadow;
+  }
+  else
+  {
+    Sim.ReloadPending = 1;
+  }
+  return HAL_OK;
+}
+
+/* Private functions ---------------------------------------------------------*/
+static uint32_t Random(void)
+{
+  RandomState ^= RandomState << 13;
+  RandomState ^= RandomState >> 17;
+  RandomState ^= RandomState << 5;
+  return RandomState;
+}
+
+static uint32_t BufferAddress(uint32_t Index)
+{
+  return BUFFER_BASE + (Index * BUFFER_STRIDE);
+}
+
+static uint32_t BufferIndex(uint32_t Address)
+{
+  return (Address - BUFFER_BASE) / BUFFER_STRIDE;
+}
+
+static void StartRing(uint32_t NbBuffers, uint32_t WithDisplay)
+{
+  uint32_t address[FRAME_RING_MAX_BUFFERS];
+  uint32_t i;
+
+  memset(&Sim, 0, sizeof(Sim));
+  memset(Content, 0, sizeof(Content));
+  for (i = 0; i < NbBuffers; i++)
+  {
+    address[i] = BufferAddress(i);
+  }
+
+  CHECK_EQ(FrameRing_Init(&Ring, &hdcmipp, (WithDisplay != 0U) ? &hltdc : NULL, DCMIPP_PIPE1, 0,
+                          address, NbBuffers), HAL_OK);
+  CHECK_EQ(FrameRing_Start(&Ring, 0), HAL_OK);
+  CHECK_EQ(Sim.Started, 1U);
+}
+
+/* Ownership invariants, checked after each event */
+static void CheckOwnership(uint32_t Claimed, uint32_t ClaimedContent)
+{
+  uint32_t writing = BufferIndex(Sim.Writing);
+
+  CHECK_EQ(Ring.Buffer[writing].Owner, FRAME_BUF_CAPTURE);
+  if (Claimed != 0U)
+  {
+    CHECK(Sim.Writing != Claimed);
+    CHECK_EQ(Content[BufferIndex(Claimed)], ClaimedContent);
+  }
+  if ((Ring.hltdc != NULL) && (Ring.NbBuffers > 2U) && (Sim.ScanOut != 0U))
+  {
+    CHECK(Sim.ScanOut != Sim.Writing);
+  }
+}
+
+static void FrameEnd(uint32_t *pFrame)
+{
+  (*pFrame)++;
+  Content[BufferIndex(Sim.Writing)] = *pFrame;
+
+  /* The DCMIPP switches slot, the address of the slot is latched */
+  Sim.Slot ^= 1U;
+  Sim.Writing = Sim.Address[Sim.Slot];
+
+  FrameRing_FrameEventHandler(&Ring);
+}
+
+static void VerticalBlanking(void)
+{
+  if (Sim.ReloadPending != 0U)
+  {
+    Sim.ReloadPending = 0;
+    Sim.ScanOut = Sim.Shadow;
+    FrameRing_ReloadEventHandler(&Ring);
+  }
+}
+
+/* Random interleaving of the capture, the display and a late application */
+static void TestRandom(uint32_t NbBuffers, uint32_t WithDisplay)
+{
+  uint32_t frame = 0;
+  uint32_t claimed = 0;
+  uint32_t claimed_content = 0;
+  uint32_t claimed_id = 0;
+  uint32_t last_id = 0;
+  uint32_t release_tick = 0;
+  uint32_t delivered = 0;
+  uint32_t tick;
+  uint32_t address;
+
+  StartRing(NbBuffers, WithDisplay);
+
+  for (tick = 1; tick <= RANDOM_STEPS; tick++)
+  {
+    if ((tick % FRAME_PERIOD) == 0U)
+    {
+      FrameEnd(&frame);
+      CheckOwnership(claimed, claimed_content);
+    }
+    if ((WithDisplay != 0U) && ((tick % VBLANK_PERIOD) == 0U))
+    {
+      VerticalBlanking();
+      CheckOwnership(claimed, claimed_content);
+    }
+
+    /* Application loop, sometimes holding a frame for several frame periods */
+    if ((Random() % 8U) != 0U)
+    {
+      continue;
+    }
+    if (claimed == 0U)
+    {
+      if (FrameRing_GetReadyBuffer(&Ring, &address) == HAL_OK)
+      {
+        claimed = address;
+        claimed_content = Content[BufferIndex(address)];
+        claimed_id = Ring.Buffer[BufferIndex(address)].FrameId;
+        CHECK(claimed_id > last_id);
+        CHECK_EQ(FrameRing_GetMeta(&Ring, address)->FrameId, claimed_id);
+        last_id = claimed_id;
+        release_tick = tick + (((Random() % 4U) == 0U) ? (Random() % (4U * FRAME_PERIOD)) : 0U);
+        delivered++;
+      }
+    }
+    else if (tick >= release_tick)
+    {
+      CHECK_EQ(Content[BufferIndex(claimed)], claimed_content);
+      if ((WithDisplay == 0U) || (FrameRing_PresentBuffer(&Ring, claimed) != HAL_OK))
+      {
+        CHECK_EQ(FrameRing_ReleaseBuffer(&Ring, claimed), HAL_OK);
+      }
+      claimed = 0;
+    }
+    CheckOwnership(claimed, claimed_content);
+    CHECK_EQ(HostPrimask, 0U);
+  }
+
+  /* Frames still flow: dropped ones are counted, none is lost track of */
+  CHECK(delivered > (frame / 4U));
+  CHECK_EQ(Ring.FrameCount, frame);
+  (void)printf("  %lu buffers%s: %lu frames, %lu claimed, %lu dropped, %lu skipped in the DCMIPP\n",
+               (unsigned long)NbBuffers, (WithDisplay != 0U) ? " + LTDC" : "", (unsigned long)frame,
+               (unsigned long)delivered, (unsigned long)Ring.DropCount, (unsigned long)Ring.SkipCount);
+}
+
+/* Triple buffering with the application one frame late: the frame is dropped
+   in the DCMIPP instead of being written in a buffer the application owns */
+static void TestLateByOneFrame(void)
+{
+  uint32_t frame = 0;
+  uint32_t address;
+  uint32_t content;
+
+  StartRing(3, 1);
+
+  /* Frame 1 published, buffer 2 scanned out: no buffer left for the slot */
+  FrameEnd(&frame);
+  CheckOwnership(0, 0);
+  CHECK_EQ(Ring.Ready, 0U);
+  CHECK_EQ(Sim.Address[0], Sim.Address[1]);
+
+  /* The application claims frame 1 while frame 2 is written */
+  CHECK_EQ(FrameRing_GetReadyBuffer(&Ring, &address), HAL_OK);
+  CHECK_EQ(address, BufferAddress(0));
+  content = Content[0];
+
+  /* Frame 2 ends before the application presents frame 1 */
+  FrameEnd(&frame);
+  CheckOwnership(address, content);
+  CHECK_EQ(Ring.SkipCount, 1U);
+  CHECK_EQ(Ring.Ready, FRAME_RING_NO_BUFFER);
+
+  /* Present, then the LTDC frees buffer 2 at the next vertical blanking */
+  CHECK_EQ(FrameRing_PresentBuffer(&Ring, address), HAL_OK);
+  VerticalBlanking();
+  CheckOwnership(0, 0);
+  CHECK_EQ(Sim.ScanOut, BufferAddress(0));
+  CHECK(Sim.Address[0] != Sim.Address[1]);
+
+  /* Next frame published again */
+  FrameEnd(&frame);
+  CheckOwnership(0, 0);
+  CHECK_EQ(Ring.Ready, 1U);
+  CHECK_EQ(Ring.SkipCount, 1U);
+}
+
+/* The record staged at the frame start follows its buffer */
+static void TestMeta(void)
+{
+  FrameBuf_MetaTypeDef meta = {0};
+  const FrameBuf_MetaTypeDef *pmeta;
+  uint32_t frame = 0;
+  uint32_t address;
+
+  StartRing(3, 0);
+
+  meta.SensorGain = 6000;
+  FrameRing_SetFrameMeta(&Ring, &meta);
+  FrameEnd(&frame);
+  CHECK_EQ(FrameRing_GetReadyBuffer(&Ring, &address), HAL_OK);
+  pmeta = FrameRing_GetMeta(&Ring, address);
+  CHECK(pmeta != NULL);
+  CHECK_EQ(pmeta->Valid, 1U);
+  CHECK_EQ(pmeta->FrameId, 1U);
+  CHECK_EQ(pmeta->SensorGain, 6000);
+
+  /* No record staged for the next frame */
+  CHECK_EQ(FrameRing_ReleaseBuffer(&Ring, address), HAL_OK);
+  FrameEnd(&frame);
+  CHECK_EQ(FrameRing_GetReadyBuffer(&Ring, &address), HAL_OK);
+  pmeta = FrameRing_GetMeta(&Ring, address);
+  CHECK_EQ(pmeta->Valid, 0U);
+  CHECK_EQ(pmeta->FrameId, 2U);
+
+  CHECK(FrameRing_GetMeta(&Ring, 0x1234U) == NULL);
+}
+
+int main(void)
+{
+  uint32_t nb;
+
+  HostHal_Reset();
+
+  TestLateByOneFrame();
+  TestMeta();
+  for (nb = 2; nb <= FRAME_RING_MAX_BUFFERS; nb++)
+  {
+    TestRandom(nb, 0);
+    if (nb > 2U)
+    {
+      TestRandom(nb, 1);
+    }
+  }
+
+  return HostTest_Report("frame_ring");
+}
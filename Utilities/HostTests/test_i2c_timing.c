@@ -0,0 +1,136 @@
+/**
+  ******************************************************************************
+  * @file    test_i2c_timing.c
+  * @brief   Host test of the I2C timings of stm32n6570_discovery_bus.c.
+  *
+  *          The BSP source is included to reach its private table and search
+  *          functions; the bus functions it also holds are not called, and
+  *          are dropped at link time with the HAL I2C, GPIO and RCC calls
+  *          they make. The test checks that each I2C_Timing_Table entry is
+  *          the TIMINGR value the PRESC/SCLDEL/SDADEL and SCLL/SCLH search
+  *          gives for its clock pair, that I2C_GetTiming() returns it, and
+  *          that the search of the other pairs gives the same value at each
+  *          bus init. It reports the time of a table lookup and of a search.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32n6570_discovery_bus.c"
+#include "host_test.h"
+
+/* Private define ------------------------------------------------------------*/
+#define TIMING_TABLE_SIZE  (sizeof(I2C_Timing_Table) / sizeof(I2C_Timing_Table[0]))
+#define BENCH_LOOPS        200U
+
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  TIMINGR value of the search alone, as the fallback of I2C_GetTiming()
+  * @retval TIMINGR value, 0 if none
+  */
+static uint32_t SolveTiming(uint32_t clock_src_freq, uint32_t i2c_freq)
+{
+  uint32_t speed, idx;
+
+  I2c_valid_timing_nbr = 0;
+  for (speed = 0; speed <= (uint32_t)I2C_SPEED_FREQ_FAST_PLUS; speed++)
+  {
+    if ((i2c_freq >= I2C_Charac[speed].freq_min) && (i2c_freq <= I2C_Charac[speed].freq_max))
+    {
+      I2C_Compute_PRESC_SCLDEL_SDADEL(clock_src_freq, speed);
+      idx = I2C_Compute_SCLL_SCLH(clock_src_freq, speed);
+      if (idx >= I2C_VALID_TIMING_NBR)
+      {
+        return 0;
+      }
+      return ((I2c_valid_timing[idx].presc & 0x0FU) << 28) | ((I2c_valid_timing[idx].tscldel & 0x0FU) << 20) |
+             ((I2c_valid_timing[idx].tsdadel & 0x0FU) << 16) | ((I2c_valid_timing[idx].sclh & 0xFFU) << 8) |
+             (I2c_valid_timing[idx].scll & 0xFFU);
+    }
+  }
+
+  return 0;
+}
+
+static void TestTable(void)
+{
+  uint32_t i, solved;
+
+  for (i = 0; i < TIMING_TABLE_SIZE; i++)
+  {
+    solved = SolveTiming(I2C_Timing_Table[i].clock_src_freq, I2C_Timing_Table[i].i2c_freq);
+    (void)printf("  %9lu Hz kernel, %7lu Hz bus: table 0x%08lX, search 0x%08lX\n",
+                 (unsigned long)I2C_Timing_Table[i].clock_src_freq, (unsigned long)I2C_Timing_Table[i].i2c_freq,
+                 (unsigned long)I2C_Timing_Table[i].timing, (unsigned long)solved);
+    CHECK(solved != 0U);
+    CHECK_EQ(I2C_Timing_Table[i].timing, solved);
+    CHECK_EQ(I2C_GetTiming(I2C_Timing_Table[i].clock_src_freq, I2C_Timing_Table[i].i2c_freq),
+             I2C_Timing_Table[i].timing);
+  }
+}
+
+static void TestFallback(void)
+{
+  static const uint32_t clocks[] = { 48000000U, 100000000U, 150000000U };
+  static const uint32_t buses[] = { 100000U, 400000U, 1000000U };
+  uint32_t c, b, first;
+
+  for (c = 0; c < (sizeof(clocks) / sizeof(clocks[0])); c++)
+  {
+    for (b = 0; b < (sizeof(buses) / sizeof(buses[0])); b++)
+    {
+      /* Same value at every bus init, the candidates of the previous one dropped */
+      first = I2C_GetTiming(clocks[c], buses[b]);
+      CHECK(first != 0U);
+      CHECK_EQ(I2C_GetTiming(clocks[c], buses[b]), first);
+      CHECK_EQ(SolveTiming(clocks[c], buses[b]), first);
+    }
+  }
+
+  /* No timing out of the I2C speed ranges */
+  CHECK_EQ(I2C_GetTiming(64000000U, 2000000U), 0U);
+  CHECK_EQ(I2C_GetTiming(0U, 400000U), 0U);
+}
+
+static void BenchLookup(void)
+{
+  volatile uint32_t sink = 0;
+  uint64_t start, table_ns, search_ns;
+  uint32_t i;
+
+  start = HostTest_NowNs();
+  for (i = 0; i < BENCH_LOOPS; i++)
+  {
+    sink += I2C_GetTiming(200000000U, 400000U);
+  }
+  table_ns = (HostTest_NowNs() - start) / BENCH_LOOPS;
+
+  start = HostTest_NowNs();
+  for (i = 0; i < BENCH_LOOPS; i++)
+  {
+    sink += SolveTiming(200000000U, 400000U);
+  }
+  search_ns = (HostTest_NowNs() - start) / BENCH_LOOPS;
+
+  (void)sink;
+  (void)printf("  200 MHz / 400 kHz: table %lu ns, search %lu ns on the host\n", (unsigned long)table_ns,
+               (unsigned long)search_ns);
+}
+
+int main(void)
+{
+  TestTable();
+  TestFallback();
+  BenchLookup();
+
+  return HostTest_Report("i2c_timing");
+}
@@ -0,0 +1,299 @@
+/**
+  ******************************************************************************
+  * @file    test_iq_profile.c
+  * @brief   Host test of the IQ profile images of iq_profile.c.
+  *
+  *          The tool source is included, its main() renamed, so the images
+  *          are packed and unpacked by the tool commands themselves. The
+  *          test reads an image back through IQProfile_Init(),
+  *          IQProfile_Find() and IQProfile_Check(), and checks that a
+  *          corrupted header, directory or payload, another version and
+  *          another parameter size are rejected. The CRC-32 is checked
+  *          against the IEEE 802.3 check value.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#define main IQProfileTool_Main
+#include "iq_profile_tool.c"
+#undef main
+#include "host_test.h"
+#include <unistd.h>
+
+/* Private define ------------------------------------------------------------*/
+#define MAX_IMAGE_SIZE    (64U * 1024U)
+#define NB_PROFILES       3U
+
+/* Private variables ---------------------------------------------------------*/
+static char Directory[] = "/tmp/iq_profile_XXXXXX";
+static char ImageName[64];
+static char ParamName[NB_PROFILES][64];
+
+static uint8_t Image[MAX_IMAGE_SIZE] __attribute__((aligned(8)));
+static uint8_t Corrupted[MAX_IMAGE_SIZE] __attribute__((aligned(8)));
+static uint32_t ImageSize;
+static ISP_IQParamTypeDef Param[NB_PROFILES];
+
+/* Sensor and mode of each profile, packed with revision 1 to NB_PROFILES */
+static const char Sensor[NB_PROFILES][IQ_PROFILE_SENSOR_LENGTH] = { "OV5647", "OV5647", "IMX335" };
+static const uint32_t Mode[NB_PROFILES] = { 7U, 1U, 7U };
+
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  Run a tool command
+  * @retval Exit status of the tool
+  */
+static int RunTool(const char *Command, const char *Arg1, const char *Arg2)
+{
+  char args[NB_PROFILES + 3U][128];
+  char *argv[NB_PROFILES + 3U];
+  int argc = 0;
+  uint32_t i;
+
+  (void)snprintf(args[argc++], sizeof(args[0]), "iq_profile_tool");
+  (void)snprintf(args[argc++], sizeof(args[0]), "%s", Command);
+  (void)snprintf(args[argc++], sizeof(args[0]), "%s", Arg1);
+  if (Arg2 != NULL)
+  {
+    (void)snprintf(args[argc++], sizeof(args[0]), "%s", Arg2);
+  }
+  else if (strcmp(Command, "pack") == 0)
+  {
+    /* Profile specs, edited in place by the tool */
+    for (i = 0; i < NB_PROFILES; i++)
+    {
+      (void)snprintf(args[argc++], sizeof(args[0]), "%s:%lu:%lu=%s", Sensor[i], (unsigned long)Mode[i],
+                     (unsigned long)(i + 1U), ParamName[i]);
+    }
+  }
+  for (i = 0; i < (uint32_t)argc; i++)
+  {
+    argv[i] = args[i];
+  }
+
+  return IQProfileTool_Main(argc, argv);
+}
+
+static uint32_t LoadFile(const char *pName, void *pData, uint32_t MaxSize)
+{
+  FILE *f = fopen(pName, "rb");
+  uint32_t size = 0;
+
+  if (f != NULL)
+  {
+    size = (uint32_t)fread(pData, 1, MaxSize, f);
+    (void)fclose(f);
+  }
+
+  return size;
+}
+
+static void SaveFile(const char *pName, const void *pData, uint32_t Size)
+{
+  FILE *f = fopen(pName, "wb");
+
+  CHECK(f != NULL);
+  if (f != NULL)
+  {
+    CHECK_EQ(fwrite(pData, 1, Size, f), Size);
+    (void)fclose(f);
+  }
+}
+
+/**
+  * @brief  Update the header CRC after a change of the header
+  */
+static void SealHeader(uint8_t *pImage)
+{
+  IQProfile_HeaderTypeDef *header = (IQProfile_HeaderTypeDef *)pImage;
+
+  header->HeaderCrc = IQProfile_Crc32(0, header, offsetof(IQProfile_HeaderTypeDef, HeaderCrc));
+}
+
+static void TestCrc(void)
+{
+  static const char check[] = "123456789";
+
+  CHECK_EQ(IQProfile_Crc32(0, check, 9U), 0xCBF43926U);
+  CHECK_EQ(IQProfile_Crc32(IQProfile_Crc32(0, check, 4U), &check[4], 5U), 0xCBF43926U);
+  CHECK_EQ(IQProfile_Crc32(0, check, 0U), 0U);
+}
+
+static void TestPack(void)
+{
+  uint32_t i;
+
+  /* Compiled-in parameters, and two tunings derived from them */
+  (void)snprintf(ImageName, sizeof(ImageName), "%s/profiles.bin", Directory);
+  for (i = 0; i < NB_PROFILES; i++)
+  {
+    (void)snprintf(ParamName[i], sizeof(ParamName[i]), "%s/param%lu.bin", Directory, (unsigned long)i);
+  }
+  CHECK_EQ(RunTool("default", ParamName[0], NULL), EXIT_SUCCESS);
+  CHECK_EQ(LoadFile(ParamName[0], &Param[0], sizeof(Param[0])), sizeof(ISP_IQParamTypeDef));
+  CHECK(memcmp(&Param[0], ISP_IQParamCacheInit[0], sizeof(Param[0])) == 0);
+  for (i = 1; i < NB_PROFILES; i++)
+  {
+    Param[i] = Param[0];
+    Param[i].AECAlgo.exposureTarget += i * 1000U;
+    Param[i].AECAlgo.exposureCompensation = EXPOSURE_TARGET_MINUS_0_5_EV;
+    Param[i].colorConvStatic.coeff[0][0] -= (int32_t)i;
+    SaveFile(ParamName[i], &Param[i], sizeof(Param[i]));
+  }
+
+  CHECK_EQ(RunTool("pack", ImageName, NULL), EXIT_SUCCESS);
+  ImageSize = LoadFile(ImageName, Image, sizeof(Image));
+  CHECK(ImageSize > (NB_PROFILES * sizeof(ISP_IQParamTypeDef)));
+  CHECK(ImageSize < sizeof(Image));
+  CHECK_EQ(RunTool("check", ImageName, NULL), EXIT_SUCCESS);
+  CHECK_EQ(RunTool("list", ImageName, NULL), EXIT_SUCCESS);
+
+  /* A parameter file of another size is refused */
+  SaveFile(ParamName[2], &Param[2], sizeof(Param[2]) - 4U);
+  CHECK_EQ(RunTool("pack", ImageName, NULL), EXIT_FAILURE);
+  SaveFile(ImageName, Image, ImageSize);
+}
+
+static void TestRead(void)
+{
+  const IQProfile_HeaderTypeDef *header = (const IQProfile_HeaderTypeDef *)Image;
+  const ISP_IQParamTypeDef *param;
+  IQProfile_HandleTypeDef hprof;
+  ISP_IQParamTypeDef unpacked;
+  char name[128];
+  uint32_t i;
+
+  CHECK_EQ(header->Version, IQ_PROFILE_VERSION);
+  CHECK_EQ(header->NbEntries, NB_PROFILES);
+  CHECK_EQ(header->ParamSize, IQ_PROFILE_PARAM_SIZE);
+  CHECK_EQ(header->TotalSize, ImageSize);
+  CHECK_EQ(IQProfile_Check(Image, ImageSize), HAL_OK);
+  CHECK_EQ(IQProfile_Init(&hprof, Image, sizeof(Image)), HAL_OK);
+
+  for (i = 0; i < NB_PROFILES; i++)
+  {
+    param = NULL;
+    CHECK_EQ(IQProfile_Find(&hprof, Sensor[i], Mode[i], &param), HAL_OK);
+    CHECK(param != NULL);
+    if (param != NULL)
+    {
+      CHECK(memcmp(param, &Param[i], sizeof(Param[i])) == 0);
+      CHECK_EQ(((uintptr_t)param % IQ_PROFILE_ALIGN), 0U);
+      CHECK_EQ(hprof.pEntry[i].Revision, i + 1U);
+    }
+  }
+
+  /* Unknown mode and sensor, and a prefix of a sensor name */
+  CHECK_EQ(IQProfile_Find(&hprof, "OV5647", 3U, &param), HAL_ERROR);
+  CHECK_EQ(IQProfile_Find(&hprof, "IMX219", 7U, &param), HAL_ERROR);
+  CHECK_EQ(IQProfile_Find(&hprof, "OV564", 7U, &param), HAL_ERROR);
+  CHECK_EQ(IQProfile_Init(&hprof, NULL, sizeof(Image)), HAL_ERROR);
+
+  /* The unpacked profiles are the packed parameter files */
+  CHECK_EQ(RunTool("unpack", ImageName, Directory), EXIT_SUCCESS);
+  for (i = 0; i < NB_PROFILES; i++)
+  {
+    (void)snprintf(name, sizeof(name), "%s/%s_%lu.bin", Directory, Sensor[i], (unsigned long)Mode[i]);
+    CHECK_EQ(LoadFile(name, &unpacked, sizeof(unpacked)), sizeof(unpacked));
+    CHECK(memcmp(&unpacked, &Param[i], sizeof(unpacked)) == 0);
+    (void)remove(name);
+  }
+}
+
+static void TestRejected(void)
+{
+  IQProfile_HeaderTypeDef *header = (IQProfile_HeaderTypeDef *)Corrupted;
+  IQProfile_EntryTypeDef *entry = (IQProfile_EntryTypeDef *)&header[1];
+  const ISP_IQParamTypeDef *param;
+  IQProfile_HandleTypeDef hprof;
+  uint32_t i;
+
+  /* Header CRC */
+  (void)memcpy(Corrupted, Image, ImageSize);
+  header->HeaderCrc ^= 0x00010000U;
+  CHECK_EQ(IQProfile_Init(&hprof, Corrupted, sizeof(Corrupted)), HAL_ERROR);
+  CHECK_EQ(IQProfile_Check(Corrupted, ImageSize), HAL_ERROR);
+  CHECK(hprof.pHeader == NULL);
+  CHECK_EQ(IQProfile_Find(&hprof, Sensor[0], Mode[0], &param), HAL_ERROR);
+
+  /* Header field behind a valid CRC of the original */
+  (void)memcpy(Corrupted, Image, ImageSize);
+  header->TotalSize += IQ_PROFILE_ALIGN;
+  CHECK_EQ(IQProfile_Init(&hprof, Corrupted, sizeof(Corrupted)), HAL_ERROR);
+
+  /* Directory CRC: an entry changed, then the CRC itself */
+  (void)memcpy(Corrupted, Image, ImageSize);
+  entry[1].Mode ^= 0x2U;
+  CHECK_EQ(IQProfile_Init(&hprof, Corrupted, sizeof(Corrupted)), HAL_ERROR);
+  CHECK_EQ(IQProfile_Check(Corrupted, ImageSize), HAL_ERROR);
+  (void)memcpy(Corrupted, Image, ImageSize);
+  header->DirCrc ^= 0x80000000U;
+  SealHeader(Corrupted);
+  CHECK_EQ(IQProfile_Init(&hprof, Corrupted, sizeof(Corrupted)), HAL_ERROR);
+
+  /* Payload CRC: the image is attached, only the corrupted profile is refused */
+  (void)memcpy(Corrupted, Image, ImageSize);
+  Corrupted[entry[1].Offset + offsetof(ISP_IQParamTypeDef, AECAlgo)] ^= 0x01U;
+  CHECK_EQ(IQProfile_Init(&hprof, Corrupted, sizeof(Corrupted)), HAL_OK);
+  CHECK_EQ(IQProfile_Find(&hprof, Sensor[1], Mode[1], &param), HAL_ERROR);
+  CHECK_EQ(IQProfile_Find(&hprof, Sensor[0], Mode[0], &param), HAL_OK);
+  CHECK_EQ(IQProfile_Check(Corrupted, ImageSize), HAL_ERROR);
+  SaveFile(ImageName, Corrupted, ImageSize);
+  CHECK_EQ(RunTool("check", ImageName, NULL), EXIT_FAILURE);
+  SaveFile(ImageName, Image, ImageSize);
+
+  /* Another version, with a valid header CRC */
+  (void)memcpy(Corrupted, Image, ImageSize);
+  header->Version = IQ_PROFILE_VERSION + 1U;
+  SealHeader(Corrupted);
+  CHECK_EQ(IQProfile_Init(&hprof, Corrupted, sizeof(Corrupted)), HAL_ERROR);
+  CHECK_EQ(IQProfile_Check(Corrupted, ImageSize), HAL_ERROR);
+
+  /* Parameters of another layout, the image being consistent otherwise */
+  (void)memcpy(Corrupted, Image, ImageSize);
+  header->ParamSize = IQ_PROFILE_PARAM_SIZE - 4U;
+  for (i = 0; i < NB_PROFILES; i++)
+  {
+    entry[i].Size = header->ParamSize;
+    entry[i].Crc = IQProfile_Crc32(0, &Corrupted[entry[i].Offset], entry[i].Size);
+  }
+  header->DirCrc = IQProfile_Crc32(0, entry, NB_PROFILES * sizeof(IQProfile_EntryTypeDef));
+  SealHeader(Corrupted);
+  CHECK_EQ(IQProfile_Init(&hprof, Corrupted, sizeof(Corrupted)), HAL_ERROR);
+  CHECK_EQ(IQProfile_Check(Corrupted, ImageSize), HAL_ERROR);
+
+  /* Image larger than the profile area */
+  CHECK_EQ(IQProfile_Init(&hprof, Image, ImageSize - 1U), HAL_ERROR);
+  CHECK_EQ(IQProfile_Init(&hprof, Image, ImageSize), HAL_OK);
+}
+
+int main(void)
+{
+  uint32_t i;
+
+  CHECK(mkdtemp(Directory) != NULL);
+
+  TestCrc();
+  TestPack();
+  TestRead();
+  TestRejected();
+
+  (void)remove(ImageName);
+  for (i = 0; i < NB_PROFILES; i++)
+  {
+    (void)remove(ParamName[i]);
+  }
+  (void)rmdir(Directory);
+
+  return HostTest_Report("iq_profile");
+}
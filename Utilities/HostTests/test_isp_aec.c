@@ -0,0 +1,325 @@
+/**
+  ******************************************************************************
+  * @file    test_isp_aec.c
+  * @brief   Host test of the ISP middleware (isp_core.c, isp_services.c,
+  *          isp_algo.c) on the simulated camera of Src/isp_sim.c.
+  *
+  *          Each frame runs as on the board: the DCMIPP captures the frame,
+  *          the main pipe VSYNC handler increments the frame id and gathers
+  *          the statistics, then the main loop calls ISP_BackgroundProcess().
+  *          The test checks that the AEC brings the luminance to the target
+  *          and stays there, for dark, indoor and bright scenes, after a
+  *          scene or target change and with a 2 frame sensor delay, that the
+  *          AWB selects the profile of the scene illuminant, and that two
+  *          cameras, one middleware instance each on its own simulated
+  *          camera, run side by side frame for frame as each of them alone.
+  *          It reports the number of frames simulated per second.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "isp_sim.h"
+#include "imx335_E27_isp_param_conf.h"
+#include "evision-api-st-ae.h"
+#include "host_test.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define CONVERGE_FRAMES    30U      /* Frames allowed to reach the target       */
+#define STABLE_FRAMES      60U      /* Frames the result must then hold         */
+#define RUN_FRAMES         (CONVERGE_FRAMES + STABLE_FRAMES)
+#define BENCH_FRAMES       20000U
+
+/* Private types -------------------------------------------------------------*/
+typedef struct
+{
+  ISP_HandleTypeDef    hIsp;
+  IspSim_HandleTypeDef Sim;
+  ISP_IQParamTypeDef   IQParam;
+  uint32_t             Errors;
+} Camera_TypeDef;
+
+/* State of a camera after a frame */
+typedef struct
+{
+  int32_t  Exposure;
+  int32_t  Gain;
+  uint32_t AverageL;
+  uint32_t ColorTemp;
+  uint32_t RegsHash;        /* DCMIPP registers programmed by the middleware */
+} Trace_TypeDef;
+
+/* Private variables ---------------------------------------------------------*/
+static Camera_TypeDef Camera;
+static Camera_TypeDef Camera2;
+static Trace_TypeDef  TraceAlone[2][RUN_FRAMES];
+static Trace_TypeDef  TracePair[2][RUN_FRAMES];
+
+/* Grey world under a D50 illuminant: the D50 profile gains balance it */
+static const IspSim_SceneTypeDef SceneIndoor = { 0.05f,    { 1.0f / 2.2f, 1.0f, 1.0f / 1.8f } };
+static const IspSim_SceneTypeDef SceneDark   = { 0.0005f,  { 1.0f / 2.2f, 1.0f, 1.0f / 1.8f } };
+static const IspSim_SceneTypeDef SceneBright = { 2.0f,     { 1.0f / 2.2f, 1.0f, 1.0f / 1.8f } };
+/* Warmer illuminant: red up, blue down */
+static const IspSim_SceneTypeDef SceneWarm   = { 0.5f,     { 1.0f / 1.6f, 1.0f, 1.0f / 2.6f } };
+
+/* Private functions ---------------------------------------------------------*/
+static void Camera_Start(Camera_TypeDef *cam, uint32_t Instance, const IspSim_SceneTypeDef *pScene,
+                         uint32_t Delay)
+{
+  ISP_AppliHelpersTypeDef helpers;
+  ISP_StatAreaTypeDef area = { ISP_SIM_WIDTH / 4U, ISP_SIM_HEIGHT / 4U, ISP_SIM_WIDTH / 2U, ISP_SIM_HEIGHT / 2U };
+
+  if (cam->hIsp.hDcmipp != NULL)
+  {
+    (void)ISP_DeInit(&cam->hIsp);
+  }
+  memset(cam, 0, sizeof(*cam));
+  IspSim_Init(&cam->Sim, Instance, pScene, Delay);
+  IspSim_GetHelpers(&helpers);
+
+  /* IQ parameters of the firmware, the sensor delay of the simulated sensor */
+  cam->IQParam = *ISP_IQParamCacheInit[0];
+  cam->IQParam.sensorDelay.delay = (uint8_t)Delay;
+
+  CHECK_EQ(ISP_Init(&cam->hIsp, &cam->Sim.hdcmipp, Instance, &helpers, &cam->IQParam), ISP_OK);
+  /* Centered area, the IQ one is for the larger IMX335 frame */
+  CHECK_EQ(ISP_SetStatArea(&cam->hIsp, &area), ISP_OK);
+  CHECK_EQ(ISP_Start(&cam->hIsp), ISP_OK);
+}
+
+static void Camera_Frame(Camera_TypeDef *cam)
+{
+  IspSim_Frame(&cam->Sim);
+
+  /* Main pipe VSYNC, as HAL_DCMIPP_PIPE_VsyncEventCallback() of the application */
+  ISP_IncMainFrameId(&cam->hIsp);
+  ISP_GatherStatistics(&cam->hIsp);
+
+  /* Main loop */
+  if (ISP_BackgroundProcess(&cam->hIsp) != ISP_OK)
+  {
+    cam->Errors++;
+  }
+}
+
+/**
+  * @brief  Record the state of a camera after a frame
+  * @param  cam     Camera
+  * @param  pTrace  State
+  * @retval None
+  */
+static void Camera_Trace(const Camera_TypeDef *cam, Trace_TypeDef *pTrace)
+{
+  const uint8_t *regs = (const uint8_t *)&cam->Sim.Regs;
+  ISP_FrameMetaTypeDef meta;
+  uint32_t hash = 2166136261U;
+  uint32_t i;
+
+  (void)ISP_GetFrameMeta((ISP_HandleTypeDef *)&cam->hIsp, &meta);
+
+  /* FNV-1a */
+  for (i = 0; i < sizeof(cam->Sim.Regs); i++)
+  {
+    hash = (hash ^ regs[i]) * 16777619U;
+  }
+
+  memset(pTrace, 0, sizeof(*pTrace));
+  pTrace->Exposure  = cam->Sim.Exposure;
+  pTrace->Gain      = cam->Sim.Gain;
+  pTrace->AverageL  = meta.averageL;
+  pTrace->ColorTemp = meta.colorTemp;
+  pTrace->RegsHash  = hash;
+}
+
+/**
+  * @brief  Run the camera and measure the AEC convergence: the luminance measured within
+  *         the tolerance of the target, and the sensor no longer written, until the end
+  * @param  cam     Camera
+  * @param  Frames  Frames to run, the last STABLE_FRAMES being the stability check
+  * @retval Frames to converge, Frames when not converged
+  */
+static uint32_t Camera_Converge(Camera_TypeDef *cam, uint32_t Frames)
+{
+  ISP_FrameMetaTypeDef meta;
+  ISP_ExposureCompTypeDef comp;
+  uint32_t target, writes, frame;
+  uint32_t converged = 0;
+
+  for (frame = 1; frame <= Frames; frame++)
+  {
+    writes = cam->Sim.SetGainCount + cam->Sim.SetExposureCount;
+    Camera_Frame(cam);
+
+    (void)ISP_GetExposureTarget(&cam->hIsp, &comp, &target);
+    (void)ISP_GetFrameMeta(&cam->hIsp, &meta);
+    if ((abs((int32_t)meta.averageL - (int32_t)target) > EVISION_ST_AEC_TOLERANCE) ||
+        (writes != (cam->Sim.SetGainCount + cam->Sim.SetExposureCount)))
+    {
+      converged = frame;
+    }
+  }
+
+  CHECK_EQ(cam->Errors, 0U);
+
+  return ((Frames - converged) >= STABLE_FRAMES) ? converged : Frames;
+}
+
+static void TestConvergence(const char *Name, const IspSim_SceneTypeDef *pScene, uint32_t Delay)
+{
+  ISP_FrameMetaTypeDef meta;
+  uint32_t frames;
+
+  Camera_Start(&Camera, 0, pScene, Delay);
+  frames = Camera_Converge(&Camera, RUN_FRAMES);
+  (void)ISP_GetFrameMeta(&Camera.hIsp, &meta);
+  (void)printf("  %-16s converged in %3lu frames: L %u, exposure %ld us, gain %ld mdB, %lu K\n", Name,
+               (unsigned long)frames, meta.averageL, (long)Camera.Sim.Exposure, (long)Camera.Sim.Gain,
+               (unsigned long)meta.colorTemp);
+
+  CHECK(frames <= CONVERGE_FRAMES);
+  /* D50 profile of the IQ parameters */
+  CHECK_EQ(meta.colorTemp, 5000U);
+}
+
+static void TestSceneChange(void)
+{
+  uint32_t exposure, frames;
+
+  Camera_Start(&Camera, 0, &SceneIndoor, 1);
+  CHECK(Camera_Converge(&Camera, RUN_FRAMES) <= CONVERGE_FRAMES);
+  exposure = (uint32_t)Camera.Sim.Exposure;
+
+  /* 8 times more light */
+  Camera.Sim.Scene.Radiance *= 8.0f;
+  frames = Camera_Converge(&Camera, RUN_FRAMES);
+  (void)printf("  %-16s converged in %3lu frames\n", "scene x8", (unsigned long)frames);
+  CHECK(frames <= CONVERGE_FRAMES);
+  CHECK(((uint32_t)Camera.Sim.Exposure > (exposure / 12U)) && ((uint32_t)Camera.Sim.Exposure < (exposure / 5U)));
+}
+
+static void TestTargetChange(void)
+{
+  ISP_FrameMetaTypeDef meta;
+  ISP_ExposureCompTypeDef comp;
+  uint32_t target, frames;
+
+  Camera_Start(&Camera, 0, &SceneIndoor, 1);
+  CHECK(Camera_Converge(&Camera, RUN_FRAMES) <= CONVERGE_FRAMES);
+
+  CHECK_EQ(ISP_SetExposureTarget(&Camera.hIsp, EXPOSURE_TARGET_PLUS_1_0_EV), ISP_OK);
+  (void)ISP_GetExposureTarget(&Camera.hIsp, &comp, &target);
+  CHECK_EQ(target, 2U * ISP_IDEAL_TARGET_EXPOSURE);
+
+  frames = Camera_Converge(&Camera, RUN_FRAMES);
+  (void)ISP_GetFrameMeta(&Camera.hIsp, &meta);
+  (void)printf("  %-16s converged in %3lu frames: L %u\n", "target +1 EV", (unsigned long)frames, meta.averageL);
+  CHECK(frames <= CONVERGE_FRAMES);
+}
+
+static void TestTwoCameras(void)
+{
+  uint32_t frame, cam, different = 0;
+
+  /* Each camera alone: dark scene; warm scene, 2 frame sensor delay, target changed once converged */
+  Camera_Start(&Camera, 0, &SceneDark, 1);
+  for (frame = 0; frame < RUN_FRAMES; frame++)
+  {
+    Camera_Frame(&Camera);
+    Camera_Trace(&Camera, &TraceAlone[0][frame]);
+  }
+  Camera_Start(&Camera2, 1, &SceneWarm, 2);
+  for (frame = 0; frame < RUN_FRAMES; frame++)
+  {
+    if (frame == CONVERGE_FRAMES)
+    {
+      CHECK_EQ(ISP_SetExposureTarget(&Camera2.hIsp, EXPOSURE_TARGET_PLUS_1_0_EV), ISP_OK);
+    }
+    Camera_Frame(&Camera2);
+    Camera_Trace(&Camera2, &TraceAlone[1][frame]);
+  }
+
+  /* Side by side, the frames of both cameras interleaved */
+  Camera_Start(&Camera, 0, &SceneDark, 1);
+  Camera_Start(&Camera2, 1, &SceneWarm, 2);
+  for (frame = 0; frame < RUN_FRAMES; frame++)
+  {
+    if (frame == CONVERGE_FRAMES)
+    {
+      CHECK_EQ(ISP_SetExposureTarget(&Camera2.hIsp, EXPOSURE_TARGET_PLUS_1_0_EV), ISP_OK);
+    }
+    Camera_Frame(&Camera);
+    Camera_Frame(&Camera2);
+    Camera_Trace(&Camera, &TracePair[0][frame]);
+    Camera_Trace(&Camera2, &TracePair[1][frame]);
+  }
+
+  for (cam = 0; cam < 2U; cam++)
+  {
+    for (frame = 0; frame < RUN_FRAMES; frame++)
+    {
+      if (memcmp(&TracePair[cam][frame], &TraceAlone[cam][frame], sizeof(Trace_TypeDef)) != 0)
+      {
+        different++;
+      }
+    }
+  }
+  (void)printf("  %-16s %lu frames each, %lu different from the camera alone: %ld us / %ld us, %lu K / %lu K\n",
+               "two cameras", (unsigned long)RUN_FRAMES, (unsigned long)different, (long)Camera.Sim.Exposure,
+               (long)Camera2.Sim.Exposure, (unsigned long)TracePair[0][RUN_FRAMES - 1U].ColorTemp,
+               (unsigned long)TracePair[1][RUN_FRAMES - 1U].ColorTemp);
+
+  CHECK_EQ(Camera.Errors, 0U);
+  CHECK_EQ(Camera2.Errors, 0U);
+  CHECK_EQ(different, 0U);
+  /* The cameras did end in different states */
+  CHECK(TracePair[0][RUN_FRAMES - 1U].Exposure != TracePair[1][RUN_FRAMES - 1U].Exposure);
+  CHECK(TracePair[0][RUN_FRAMES - 1U].RegsHash != TracePair[1][RUN_FRAMES - 1U].RegsHash);
+
+  (void)ISP_DeInit(&Camera2.hIsp);
+  memset(&Camera2, 0, sizeof(Camera2));
+}
+
+static void BenchFrames(void)
+{
+  uint64_t start, ns;
+  uint32_t frame;
+
+  Camera_Start(&Camera, 0, &SceneIndoor, 1);
+
+  start = HostTest_NowNs();
+  for (frame = 0; frame < BENCH_FRAMES; frame++)
+  {
+    Camera_Frame(&Camera);
+  }
+  ns = HostTest_NowNs() - start;
+
+  CHECK_EQ(Camera.Errors, 0U);
+  (void)printf("  %lu frames simulated per second\n", (unsigned long)(((uint64_t)BENCH_FRAMES * 1000000000ULL) / ns));
+}
+
+int main(void)
+{
+  HostHal_Reset();
+
+  TestConvergence("indoor", &SceneIndoor, 1);
+  TestConvergence("dark", &SceneDark, 1);
+  TestConvergence("bright", &SceneBright, 1);
+  TestConvergence("sensor delay 2", &SceneIndoor, 2);
+  TestSceneChange();
+  TestTargetChange();
+  TestTwoCameras();
+  BenchFrames();
+
+  return HostTest_Report("isp_aec");
+}
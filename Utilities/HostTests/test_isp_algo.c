@@ -0,0 +1,242 @@
+/**
+  ******************************************************************************
+  * @file    test_isp_algo.c
+  * @brief   Host test of the fixed point AWB color path of isp_algo.c.
+  *
+  *          ISP_Algo_ApplyGammaInverse() reads a Q16 table and
+  *          ISP_Algo_ApplyCConv() a Q15 matrix in place of pow() and of the
+  *          int64 product by coefficients in ISP_CCM_PRECISION_FACTOR units.
+  *          Both are run on the register block of a simulated DCMIPP and
+  *          checked against the former float and int64 code, kept here as
+  *          the golden reference: the gamma within 2^-17 for each 8-bit
+  *          component, the color conversion bit-exact over random
+  *          matrices and inputs. The test reports the time of the
+  *          statistics conversion of an AWB cycle through each path.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "isp_sim.h"
+#include "isp_services.h"
+#include "host_test.h"
+#include <math.h>
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define GAMMA_TOLERANCE   (1.0 / 131072.0)   /* 2^-17 */
+#define RANDOM_MATRICES   2000U
+#define RANDOM_INPUTS     100U
+#define BENCH_LOOPS       200000U
+
+/* Private variables ---------------------------------------------------------*/
+static IspSim_HandleTypeDef Sim;
+static ISP_HandleTypeDef    hIsp;
+
+static const IspSim_SceneTypeDef Scene = { 0.05f, { 1.0f, 1.0f, 1.0f } };
+
+static uint32_t RandomState = 0x2545F491U;
+
+/* Exported functions of isp_algo.c, not in its header -----------------------*/
+double ISP_Algo_ApplyGammaInverse(ISP_HandleTypeDef *hIsp, uint32_t comp);
+void ISP_Algo_ApplyCConv(ISP_HandleTypeDef *hIsp, uint32_t inR, uint32_t inG, uint32_t inB, uint32_t *outR,
+                         uint32_t *outG, uint32_t *outB);
+
+/* Private functions ---------------------------------------------------------*/
+static uint32_t Random(void)
+{
+  RandomState ^= RandomState << 13;
+  RandomState ^= RandomState >> 17;
+  RandomState ^= RandomState << 5;
+  return RandomState;
+}
+
+/**
+  * @brief  Former ISP_Algo_ApplyGammaInverse(), the golden reference
+  */
+static double GoldenGammaInverse(ISP_HandleTypeDef *pIsp, uint32_t comp)
+{
+  if (ISP_SVC_Misc_IsGammaEnabled(pIsp, 1) != 0)
+  {
+    return 255 * pow((float)comp / 255, 1.0 / 2.2);
+  }
+
+  return (double)comp;
+}
+
+/**
+  * @brief  Former ISP_Algo_ApplyCConv(), the golden reference
+  */
+static void GoldenCConv(ISP_HandleTypeDef *pIsp, uint32_t inR, uint32_t inG, uint32_t inB, uint32_t *outR,
+                        uint32_t *outG, uint32_t *outB)
+{
+  ISP_ColorConvTypeDef colorConv;
+  int64_t ccR, ccG, ccB;
+
+  if ((ISP_SVC_ISP_GetColorConv(pIsp, &colorConv) == ISP_OK) && (colorConv.enable == 1))
+  {
+    ccR = (int64_t) inR * colorConv.coeff[0][0] + (int64_t) inG * colorConv.coeff[0][1] +
+          (int64_t) inB * colorConv.coeff[0][2];
+    ccG = (int64_t) inR * colorConv.coeff[1][0] + (int64_t) inG * colorConv.coeff[1][1] +
+          (int64_t) inB * colorConv.coeff[1][2];
+    ccB = (int64_t) inR * colorConv.coeff[2][0] + (int64_t) inG * colorConv.coeff[2][1] +
+          (int64_t) inB * colorConv.coeff[2][2];
+
+    ccR /= ISP_CCM_PRECISION_FACTOR;
+    ccG /= ISP_CCM_PRECISION_FACTOR;
+    ccB /= ISP_CCM_PRECISION_FACTOR;
+
+    ccR = (ccR < 0) ? 0 : (ccR > 255) ? 255 : ccR;
+    ccG = (ccG < 0) ? 0 : (ccG > 255) ? 255 : ccG;
+    ccB = (ccB < 0) ? 0 : (ccB > 255) ? 255 : ccB;
+
+    *outR = (uint32_t) ccR;
+    *outG = (uint32_t) ccG;
+    *outB = (uint32_t) ccB;
+  }
+  else
+  {
+    *outR = inR;
+    *outG = inG;
+    *outB = inB;
+  }
+}
+
+static void SetGamma(uint8_t Enable)
+{
+  ISP_GammaTypeDef gamma = { Enable, Enable };
+
+  CHECK_EQ(ISP_SVC_ISP_SetGamma(&hIsp, &gamma), ISP_OK);
+}
+
+static void TestGamma(void)
+{
+  double out, golden, error, max_error = 0.0;
+  uint32_t comp;
+
+  SetGamma(1);
+  for (comp = 0; comp < 256U; comp++)
+  {
+    out = ISP_Algo_ApplyGammaInverse(&hIsp, comp);
+    golden = GoldenGammaInverse(&hIsp, comp);
+    error = fabs(out - golden);
+    max_error = (error > max_error) ? error : max_error;
+  }
+  (void)printf("  gamma: max error %.3g against pow() (2^-17 = %.3g)\n", max_error, GAMMA_TOLERANCE);
+  CHECK(max_error <= GAMMA_TOLERANCE);
+
+  /* Ends of the range exact, components above 255 saturated */
+  CHECK(ISP_Algo_ApplyGammaInverse(&hIsp, 0) == 0.0);
+  CHECK(ISP_Algo_ApplyGammaInverse(&hIsp, 255) == 255.0);
+  CHECK(ISP_Algo_ApplyGammaInverse(&hIsp, 1000) == 255.0);
+
+  /* Gamma off: unchanged */
+  SetGamma(0);
+  for (comp = 0; comp < 256U; comp++)
+  {
+    CHECK(ISP_Algo_ApplyGammaInverse(&hIsp, comp) == (double)comp);
+  }
+}
+
+static void TestCConv(void)
+{
+  ISP_ColorConvTypeDef conf = { 0 };
+  uint32_t m, n, i, j, in[3], out[3], golden[3];
+  uint32_t different = 0;
+
+  /* Off: unchanged */
+  CHECK_EQ(ISP_SVC_ISP_SetColorConv(&hIsp, &conf), ISP_OK);
+  ISP_Algo_ApplyCConv(&hIsp, 10, 20, 30, &out[0], &out[1], &out[2]);
+  CHECK((out[0] == 10U) && (out[1] == 20U) && (out[2] == 30U));
+
+  /* Random matrices over the whole coefficient range, random and extreme inputs */
+  conf.enable = 1;
+  for (m = 0; m < RANDOM_MATRICES; m++)
+  {
+    for (i = 0; i < 3U; i++)
+    {
+      for (j = 0; j < 3U; j++)
+      {
+        conf.coeff[i][j] = (int32_t)(Random() % (2U * ISP_COLORCONV_MAX + 1U)) - ISP_COLORCONV_MAX;
+      }
+    }
+    CHECK_EQ(ISP_SVC_ISP_SetColorConv(&hIsp, &conf), ISP_OK);
+
+    for (n = 0; n < RANDOM_INPUTS; n++)
+    {
+      for (i = 0; i < 3U; i++)
+      {
+        in[i] = (n < 8U) ? (((n >> i) & 1U) * 255U) : (Random() & 0xFFU);
+      }
+      ISP_Algo_ApplyCConv(&hIsp, in[0], in[1], in[2], &out[0], &out[1], &out[2]);
+      GoldenCConv(&hIsp, in[0], in[1], in[2], &golden[0], &golden[1], &golden[2]);
+      if (memcmp(out, golden, sizeof(out)) != 0)
+      {
+        different++;
+      }
+    }
+  }
+
+  (void)printf("  color conversion: %lu matrices x %lu inputs, %lu different from the int64 path\n",
+               (unsigned long)RANDOM_MATRICES, (unsigned long)RANDOM_INPUTS, (unsigned long)different);
+  CHECK_EQ(different, 0U);
+}
+
+static void BenchColor(void)
+{
+  ISP_ColorConvTypeDef conf = { 1, { { 160000000, -40000000, -20000000 },
+                                     { -30000000, 150000000, -20000000 },
+                                     { -10000000, -50000000, 160000000 } } };
+  volatile double sink = 0.0;
+  uint64_t start, fixed_ns, golden_ns;
+  uint32_t i, r, g, b;
+
+  SetGamma(1);
+  CHECK_EQ(ISP_SVC_ISP_SetColorConv(&hIsp, &conf), ISP_OK);
+
+  /* Conversion of the down statistics of an AWB cycle: color conversion, then gamma of each component */
+  start = HostTest_NowNs();
+  for (i = 0; i < BENCH_LOOPS; i++)
+  {
+    ISP_Algo_ApplyCConv(&hIsp, i & 0xFFU, (i >> 3) & 0xFFU, (i >> 6) & 0xFFU, &r, &g, &b);
+    sink += ISP_Algo_ApplyGammaInverse(&hIsp, r) + ISP_Algo_ApplyGammaInverse(&hIsp, g) +
+            ISP_Algo_ApplyGammaInverse(&hIsp, b);
+  }
+  fixed_ns = HostTest_NowNs() - start;
+
+  start = HostTest_NowNs();
+  for (i = 0; i < BENCH_LOOPS; i++)
+  {
+    GoldenCConv(&hIsp, i & 0xFFU, (i >> 3) & 0xFFU, (i >> 6) & 0xFFU, &r, &g, &b);
+    sink += GoldenGammaInverse(&hIsp, r) + GoldenGammaInverse(&hIsp, g) + GoldenGammaInverse(&hIsp, b);
+  }
+  golden_ns = HostTest_NowNs() - start;
+
+  (void)sink;
+  (void)printf("  AWB cycle: LUT + Q15 %lu ns, pow() + int64 %lu ns on the host\n",
+               (unsigned long)(fixed_ns / BENCH_LOOPS), (unsigned long)(golden_ns / BENCH_LOOPS));
+}
+
+int main(void)
+{
+  HostHal_Reset();
+
+  /* Middleware services on the register block of a simulated DCMIPP */
+  IspSim_Init(&Sim, 0, &Scene, 1);
+  hIsp.hDcmipp = &Sim.hdcmipp;
+
+  TestGamma();
+  TestCConv();
+  BenchColor();
+
+  return HostTest_Report("isp_algo");
+}
@@ -0,0 +1,410 @@
+/**
+  ******************************************************************************
+  * @file    test_isp_raw.c
+  * @brief   Host test of the portable path of the software RAW pipeline
+  *          (isp_raw.c).
+  *
+  *          Random RAW10 frames, packed or on 16 bits, are developed by
+  *          ISP_RAW_Process() and by a reference model of the pipeline
+  *          computed one pixel at a time. The model reads the 10-bit pixels
+  *          before packing, mirrors the borders of the frame, and takes the
+  *          black level, ISP gain and color conversion from the registers
+  *          the ISP services program in a simulated DCMIPP for the same
+  *          settings: the software output must match it bit for bit, for
+  *          each CFA order, demosaicing method and output conversion. The
+  *          bytes after the lines must be left untouched. The throughput is
+  *          measured by bench_isp_raw.c.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "isp_sim.h"
+#include "isp_raw.h"
+#include "isp_services.h"
+#include "host_test.h"
+#include <math.h>
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define MAX_WIDTH         256U
+#define MAX_HEIGHT        48U
+#define MAX_SRC_STRIDE    ((MAX_WIDTH * 2U) + 16U)
+#define MAX_DST_STRIDE    ((MAX_WIDTH * 3U) + 16U)
+#define GUARD_BYTE        0x5AU
+#define RANDOM_FRAMES     3000U
+
+/* Private types -------------------------------------------------------------*/
+/**
+  * @brief  Settings of the reference model, as read back from the registers
+  */
+typedef struct
+{
+  uint32_t Black[3];       /*!< R, G, B black level, 10-bit                    */
+  uint32_t Gain[3];        /*!< R, G, B Multiplier << Shift, 128 for x1.0      */
+  int32_t  Ccm[3][3];      /*!< Color conversion registers, 256 for x1.0       */
+  uint8_t  Lut[1024];      /*!< Output conversion                              */
+} Model_TypeDef;
+
+/* Private variables ---------------------------------------------------------*/
+static IspSim_HandleTypeDef Sim;
+static ISP_HandleTypeDef    hIsp;
+
+static const IspSim_SceneTypeDef Scene = { 0.05f, { 1.0f, 1.0f, 1.0f } };
+
+/* Colors of the CFA positions [line & 1][column & 1], 0 R, 1 G, 2 B */
+static const uint8_t Cfa[4][2][2] =
+{
+  { { 0, 1 }, { 1, 2 } },
+  { { 1, 0 }, { 2, 1 } },
+  { { 1, 2 }, { 0, 1 } },
+  { { 2, 1 }, { 1, 0 } },
+};
+
+static uint16_t Pixels[MAX_HEIGHT][MAX_WIDTH];
+static uint8_t  Src[MAX_HEIGHT * MAX_SRC_STRIDE];
+static uint8_t  Dst[MAX_HEIGHT * MAX_DST_STRIDE];
+static uint32_t Work[ISP_RAW_WORK_SIZE(MAX_WIDTH) / sizeof(uint32_t)];
+static ISP_RAW_HandleTypeDef hRaw;
+static Model_TypeDef Model;
+
+static uint32_t RandomState = 0x2545F491U;
+
+/* Private functions ---------------------------------------------------------*/
+static uint32_t Random(void)
+{
+  RandomState ^= RandomState << 13;
+  RandomState ^= RandomState >> 17;
+  RandomState ^= RandomState << 5;
+  return RandomState;
+}
+
+/**
+  * @brief  Program the settings in the simulated DCMIPP and read the model
+  *         settings back from its registers
+  */
+static void ProgramModel(const ISP_RAW_ConfTypeDef *pConf)
+{
+  DCMIPP_BlackLevelConfTypeDef black;
+  DCMIPP_ExposureConfTypeDef exposure;
+  DCMIPP_ColorConversionConfTypeDef ccm;
+  ISP_BlackLevelTypeDef blackLevel = pConf->blackLevel;
+  ISP_ISPGainTypeDef ispGain = pConf->ispGain;
+  ISP_ColorConvTypeDef colorConv = pConf->colorConv;
+  uint32_t i;
+
+  CHECK_EQ(ISP_SVC_ISP_SetBlackLevel(&hIsp, &blackLevel), ISP_OK);
+  CHECK_EQ(ISP_SVC_ISP_SetGain(&hIsp, &ispGain), ISP_OK);
+  CHECK_EQ(ISP_SVC_ISP_SetColorConv(&hIsp, &colorConv), ISP_OK);
+
+  HAL_DCMIPP_PIPE_GetISPBlackLevelCalibrationConfig(&Sim.hdcmipp, DCMIPP_PIPE1, &black);
+  HAL_DCMIPP_PIPE_GetISPExposureConfig(&Sim.hdcmipp, DCMIPP_PIPE1, &exposure);
+  HAL_DCMIPP_PIPE_GetISPColorConversionConfig(&Sim.hdcmipp, DCMIPP_PIPE1, &ccm);
+
+  (void)memset(&Model, 0, sizeof(Model));
+  if (HAL_DCMIPP_PIPE_IsEnabledISPBlackLevelCalibration(&Sim.hdcmipp, DCMIPP_PIPE1) != 0U)
+  {
+    Model.Black[0] = (uint32_t)black.RedCompBlackLevel << 2;
+    Model.Black[1] = (uint32_t)black.GreenCompBlackLevel << 2;
+    Model.Black[2] = (uint32_t)black.BlueCompBlackLevel << 2;
+  }
+  if (HAL_DCMIPP_PIPE_IsEnabledISPExposure(&Sim.hdcmipp, DCMIPP_PIPE1) != 0U)
+  {
+    Model.Gain[0] = (uint32_t)exposure.MultiplierRed << exposure.ShiftRed;
+    Model.Gain[1] = (uint32_t)exposure.MultiplierGreen << exposure.ShiftGreen;
+    Model.Gain[2] = (uint32_t)exposure.MultiplierBlue << exposure.ShiftBlue;
+  }
+  else
+  {
+    Model.Gain[0] = Model.Gain[1] = Model.Gain[2] = 128U;
+  }
+  if (HAL_DCMIPP_PIPE_IsEnabledISPColorConversion(&Sim.hdcmipp, DCMIPP_PIPE1) != 0U)
+  {
+    Model.Ccm[0][0] = ccm.RR; Model.Ccm[0][1] = ccm.RG; Model.Ccm[0][2] = ccm.RB;
+    Model.Ccm[1][0] = ccm.GR; Model.Ccm[1][1] = ccm.GG; Model.Ccm[1][2] = ccm.GB;
+    Model.Ccm[2][0] = ccm.BR; Model.Ccm[2][1] = ccm.BG; Model.Ccm[2][2] = ccm.BB;
+  }
+  else
+  {
+    Model.Ccm[0][0] = Model.Ccm[1][1] = Model.Ccm[2][2] = 256;
+  }
+
+  for (i = 0; i < 1024U; i++)
+  {
+    Model.Lut[i] = (pConf->gammaEnable != 0U) ? (uint8_t)lround(255.0 * pow(i / 1023.0, 1.0 / 2.2)) : (uint8_t)(i >> 2);
+  }
+}
+
+/**
+  * @brief  Black level corrected Bayer value, borders mirrored
+  */
+static uint32_t ModelBayer(const ISP_RAW_ConfTypeDef *pConf, int32_t x, int32_t y)
+{
+  int32_t w = (int32_t)pConf->width, h = (int32_t)pConf->height;
+  uint32_t raw, black;
+
+  x = (x < 0) ? -x : (x >= w) ? ((2 * w) - 2 - x) : x;
+  y = (y < 0) ? -y : (y >= h) ? ((2 * h) - 2 - y) : y;
+  raw = Pixels[y][x];
+  black = Model.Black[Cfa[pConf->bayer][y & 1][x & 1]];
+
+  return (raw > black) ? (raw - black) : 0U;
+}
+
+/**
+  * @brief  Floor of a / 256, whatever the sign
+  */
+static int32_t FloorDiv256(int32_t a)
+{
+  return (a >= 0) ? (a / 256) : -((-a + 255) / 256);
+}
+
+/**
+  * @brief  Reference development of one pixel, B, G, R bytes
+  */
+static void ModelPixel(const ISP_RAW_ConfTypeDef *pConf, int32_t x, int32_t y, uint8_t *pOut)
+{
+  uint32_t color = Cfa[pConf->bayer][y & 1][x & 1];
+  uint32_t c = ModelBayer(pConf, x, y);
+  uint32_t l = ModelBayer(pConf, x - 1, y), r = ModelBayer(pConf, x + 1, y);
+  uint32_t u = ModelBayer(pConf, x, y - 1), d = ModelBayer(pConf, x, y + 1);
+  uint32_t h = (l + r + 1U) / 2U, v = (u + d + 1U) / 2U;
+  uint32_t rgb[3], gh, gv, i;
+  int32_t acc;
+
+  if (color == 1U)
+  {
+    /* Green: the color of the same line from the left and right neighbors, the other one from above and below */
+    rgb[1] = c;
+    rgb[Cfa[pConf->bayer][y & 1][(x + 1) & 1]] = h;
+    rgb[2U - Cfa[pConf->bayer][y & 1][(x + 1) & 1]] = v;
+  }
+  else
+  {
+    /* Red or blue: the opposite color from the diagonals, green from the cross or along the edge */
+    rgb[color] = c;
+    rgb[2U - color] = (ModelBayer(pConf, x - 1, y - 1) + ModelBayer(pConf, x + 1, y - 1) +
+                       ModelBayer(pConf, x - 1, y + 1) + ModelBayer(pConf, x + 1, y + 1) + 2U) / 4U;
+    rgb[1] = (l + r + u + d + 2U) / 4U;
+    if (pConf->demosaic == ISP_RAW_DEMOS_EDGE)
+    {
+      gh = (l > r) ? (l - r) : (r - l);
+      gv = (u > d) ? (u - d) : (d - u);
+      rgb[1] = (gv < gh) ? v : (gh < gv) ? h : rgb[1];
+    }
+  }
+
+  for (i = 0; i < 3U; i++)
+  {
+    rgb[i] = (rgb[i] * Model.Gain[i]) / 128U;
+    rgb[i] = (rgb[i] > 1023U) ? 1023U : rgb[i];
+  }
+  for (i = 0; i < 3U; i++)
+  {
+    acc = FloorDiv256(((int32_t)rgb[0] * Model.Ccm[i][0]) + ((int32_t)rgb[1] * Model.Ccm[i][1]) +
+                      ((int32_t)rgb[2] * Model.Ccm[i][2]) + 128);
+    acc = (acc < 0) ? 0 : (acc > 1023) ? 1023 : acc;
+    pOut[2U - i] = Model.Lut[acc];
+  }
+}
+
+/**
+  * @brief  Random 10-bit frame, stored in the RAW layout of the configuration
+  */
+static void FillFrame(const ISP_RAW_ConfTypeDef *pConf)
+{
+  uint32_t x, y;
+  uint8_t *line;
+
+  (void)memset(Src, 0, sizeof(Src));
+  for (y = 0; y < pConf->height; y++)
+  {
+    line = &Src[y * pConf->srcStride];
+    for (x = 0; x < pConf->width; x++)
+    {
+      /* Flat areas and edges, with noise */
+      Pixels[y][x] = (uint16_t)(((Random() % 4U) == 0U) ? (Random() & 0x3FFU) : (x < (pConf->width / 2U)) ? 64U : 900U);
+      if (pConf->format == ISP_RAW_FORMAT_RAW10_PACKED)
+      {
+        /* MIPI CSI-2: 8 MSBs of 4 pixels, then their 2 LSBs from bit 0 */
+        line[((x / 4U) * 5U) + (x % 4U)] = (uint8_t)(Pixels[y][x] >> 2);
+        line[((x / 4U) * 5U) + 4U] |= (uint8_t)((Pixels[y][x] & 3U) << (2U * (x % 4U)));
+      }
+      else
+      {
+        /* Bits 15:10 are not part of the pixel */
+        line[2U * x] = (uint8_t)Pixels[y][x];
+        line[(2U * x) + 1U] = (uint8_t)((Pixels[y][x] >> 8) | (Random() & 0xFCU));
+      }
+    }
+  }
+}
+
+/**
+  * @brief  Develop a frame and compare it with the model
+  * @retval Number of pixels different from the model
+  */
+static uint32_t CheckFrame(const ISP_RAW_ConfTypeDef *pConf)
+{
+  uint32_t x, y, different = 0;
+  uint8_t expected[3];
+  const uint8_t *line;
+
+  FillFrame(pConf);
+  ProgramModel(pConf);
+  (void)memset(Dst, GUARD_BYTE, sizeof(Dst));
+
+  CHECK_EQ(ISP_RAW_Init(&hRaw, pConf, Work, sizeof(Work)), ISP_OK);
+  CHECK_EQ(ISP_RAW_Process(&hRaw, Src, Dst), ISP_OK);
+
+  for (y = 0; y < pConf->height; y++)
+  {
+    line = &Dst[y * pConf->dstStride];
+    for (x = 0; x < pConf->width; x++)
+    {
+      ModelPixel(pConf, (int32_t)x, (int32_t)y, expected);
+      if (memcmp(&line[3U * x], expected, sizeof(expected)) != 0)
+      {
+        different++;
+      }
+    }
+    for (x = 3U * pConf->width; x < pConf->dstStride; x++)
+    {
+      CHECK_EQ(line[x], GUARD_BYTE);
+    }
+  }
+
+  return different;
+}
+
+static void RandomConf(ISP_RAW_ConfTypeDef *pConf)
+{
+  uint32_t i, j;
+
+  (void)memset(pConf, 0, sizeof(*pConf));
+  pConf->format   = ((Random() & 1U) != 0U) ? ISP_RAW_FORMAT_RAW10_PACKED : ISP_RAW_FORMAT_RAW16;
+  pConf->bayer    = (ISP_RAW_BayerTypeDef)(Random() % 4U);
+  pConf->demosaic = ((Random() & 1U) != 0U) ? ISP_RAW_DEMOS_EDGE : ISP_RAW_DEMOS_BILINEAR;
+
+  /* Packed lines are made of 4-pixel groups */
+  if (pConf->format == ISP_RAW_FORMAT_RAW10_PACKED)
+  {
+    pConf->width     = 8U + (4U * (Random() % (((MAX_WIDTH - 8U) / 4U) + 1U)));
+    pConf->srcStride = ((pConf->width * 5U) / 4U) + (Random() % 16U);
+  }
+  else
+  {
+    pConf->width     = 8U + (2U * (Random() % (((MAX_WIDTH - 8U) / 2U) + 1U)));
+    pConf->srcStride = (pConf->width * 2U) + (2U * (Random() % 8U));
+  }
+  pConf->height    = 2U + (2U * (Random() % (MAX_HEIGHT / 2U)));
+  pConf->dstStride = (pConf->width * 3U) + (Random() % 16U);
+
+  pConf->blackLevel.enable = (uint8_t)(Random() & 1U);
+  pConf->blackLevel.BLCR   = (uint8_t)(Random() % 64U);
+  pConf->blackLevel.BLCG   = (uint8_t)(Random() % 64U);
+  pConf->blackLevel.BLCB   = (uint8_t)(Random() % 64U);
+
+  pConf->ispGain.enable   = (uint8_t)(Random() & 1U);
+  pConf->ispGain.ispGainR = Random() % (ISP_EXPOSURE_GAIN_MAX + 1U);
+  pConf->ispGain.ispGainG = Random() % (ISP_EXPOSURE_GAIN_MAX + 1U);
+  pConf->ispGain.ispGainB = Random() % (ISP_EXPOSURE_GAIN_MAX + 1U);
+  if ((Random() & 1U) != 0U)
+  {
+    /* AWB range, where most of the levels stay below saturation */
+    pConf->ispGain.ispGainR = 100000000U + (Random() % 200000000U);
+    pConf->ispGain.ispGainG = 100000000U;
+    pConf->ispGain.ispGainB = 100000000U + (Random() % 200000000U);
+  }
+
+  pConf->colorConv.enable = (uint8_t)(Random() & 1U);
+  for (i = 0; i < 3U; i++)
+  {
+    for (j = 0; j < 3U; j++)
+    {
+      pConf->colorConv.coeff[i][j] = (int32_t)(Random() % (2U * ISP_COLORCONV_MAX + 1U)) - ISP_COLORCONV_MAX;
+    }
+  }
+
+  pConf->gammaEnable = (uint8_t)(Random() & 1U);
+}
+
+static void TestInit(void)
+{
+  ISP_RAW_ConfTypeDef conf = { 0 };
+
+  conf.width     = 16U;
+  conf.height    = 4U;
+  conf.srcStride = 20U;
+  conf.dstStride = 48U;
+  conf.format    = ISP_RAW_FORMAT_RAW10_PACKED;
+  CHECK_EQ(ISP_RAW_Init(&hRaw, &conf, Work, sizeof(Work)), ISP_OK);
+
+  CHECK_EQ(ISP_RAW_Init(NULL, &conf, Work, sizeof(Work)), ISP_ERR_EINVAL);
+  CHECK_EQ(ISP_RAW_Init(&hRaw, &conf, NULL, sizeof(Work)), ISP_ERR_EINVAL);
+  CHECK_EQ(ISP_RAW_Init(&hRaw, &conf, Work, ISP_RAW_WORK_SIZE(16U) - 1U), ISP_ERR_EINVAL);
+  conf.srcStride = 19U;
+  CHECK_EQ(ISP_RAW_Init(&hRaw, &conf, Work, sizeof(Work)), ISP_ERR_EINVAL);
+  conf.srcStride = 20U;
+  conf.dstStride = 47U;
+  CHECK_EQ(ISP_RAW_Init(&hRaw, &conf, Work, sizeof(Work)), ISP_ERR_EINVAL);
+  conf.dstStride = 48U;
+  conf.height    = 3U;
+  CHECK_EQ(ISP_RAW_Init(&hRaw, &conf, Work, sizeof(Work)), ISP_ERR_EINVAL);
+  conf.height    = 4U;
+  conf.bayer     = (ISP_RAW_BayerTypeDef)4;
+  CHECK_EQ(ISP_RAW_Init(&hRaw, &conf, Work, sizeof(Work)), ISP_ERR_EINVAL);
+  conf.bayer     = ISP_RAW_BAYER_RGGB;
+
+  /* Packed lines of whole 4-pixel groups only */
+  conf.width     = 10U;
+  conf.dstStride = 30U;
+  CHECK_EQ(ISP_RAW_Init(&hRaw, &conf, Work, sizeof(Work)), ISP_ERR_EINVAL);
+  conf.format    = ISP_RAW_FORMAT_RAW16;
+  CHECK_EQ(ISP_RAW_Init(&hRaw, &conf, Work, sizeof(Work)), ISP_OK);
+  conf.srcStride = 21U;
+  CHECK_EQ(ISP_RAW_Init(&hRaw, &conf, Work, sizeof(Work)), ISP_ERR_EINVAL);
+
+  (void)memset(&hRaw, 0, sizeof(hRaw));
+  CHECK_EQ(ISP_RAW_Process(&hRaw, Src, Dst), ISP_ERR_EINVAL);
+}
+
+static void TestRandom(void)
+{
+  ISP_RAW_ConfTypeDef conf;
+  uint32_t f, different = 0, pixels = 0;
+
+  for (f = 0; f < RANDOM_FRAMES; f++)
+  {
+    RandomConf(&conf);
+    different += CheckFrame(&conf);
+    pixels += conf.width * conf.height;
+  }
+
+  (void)printf("  %lu frames, %lu pixels, %lu different from the reference model\n", (unsigned long)RANDOM_FRAMES,
+               (unsigned long)pixels, (unsigned long)different);
+  CHECK_EQ(different, 0U);
+}
+
+int main(void)
+{
+  HostHal_Reset();
+
+  /* ISP services on the register block of a simulated DCMIPP */
+  IspSim_Init(&Sim, 0, &Scene, 1);
+  hIsp.hDcmipp = &Sim.hdcmipp;
+
+  TestInit();
+  TestRandom();
+
+  return HostTest_Report("isp_raw");
+}
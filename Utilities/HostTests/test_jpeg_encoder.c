@@ -0,0 +1,255 @@
+/**
+  ******************************************************************************
+  * @file    test_jpeg_encoder.c
+  * @brief   Host test of the MCU tiling of jpeg_encoder.c.
+  *
+  *          JpegEnc_TileMcuRow() reorders the YUYV lines of a band into the
+  *          4:2:2 MCUs read by the codec. The test compares its output with
+  *          the data units of a reference encoder: the Y, Cb and Cr planes of
+  *          the frame are sampled as in a baseline interleaved scan (ITU-T
+  *          T.81 A.2.3, Y with H=2 V=1, Cb and Cr with H=1 V=1) one sample at
+  *          a time. Random frames are tiled band by band at several widths,
+  *          with and without padding at the end of the lines, and the bytes
+  *          after the MCU row are checked untouched. The test reports the
+  *          tiling time of a frame of the application.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "jpeg_encoder.h"
+#include "host_test.h"
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define MAX_WIDTH         1920U
+#define MAX_HEIGHT        64U
+#define MAX_PITCH         ((MAX_WIDTH * 2U) + 64U)
+#define MAX_ROW_SIZE      ((MAX_WIDTH / JPEG_ENC_MCU_WIDTH) * JPEG_ENC_MCU_SIZE)
+#define GUARD_SIZE        64U
+#define GUARD_BYTE        0xA5U
+#define RANDOM_FRAMES     200U
+
+/* Frame of the application */
+#define BENCH_WIDTH       800U
+#define BENCH_HEIGHT      480U
+#define BENCH_LOOPS       200U
+
+/* Private types -------------------------------------------------------------*/
+/**
+  * @brief  Component of the reference scan
+  */
+typedef struct
+{
+  uint32_t H;              /*!< Horizontal sampling factor */
+  uint32_t V;              /*!< Vertical sampling factor   */
+  uint32_t Offset;         /*!< Byte of the YUYV word      */
+  uint32_t Step;           /*!< Bytes between two samples  */
+} Component_TypeDef;
+
+/* Private variables ---------------------------------------------------------*/
+/* Y, Cb, Cr in scan order, Hmax = 2 */
+static const Component_TypeDef Components[] =
+{
+  { 2, 1, 0, 2 },
+  { 1, 1, 1, 4 },
+  { 1, 1, 3, 4 },
+};
+
+static uint8_t Frame[MAX_HEIGHT * MAX_PITCH] __attribute__((aligned(32)));
+static uint8_t Tiled[MAX_ROW_SIZE + GUARD_SIZE] __attribute__((aligned(32)));
+static uint8_t Reference[MAX_ROW_SIZE];
+static uint8_t BenchFrame[BENCH_HEIGHT * BENCH_WIDTH * 2U] __attribute__((aligned(32)));
+
+static uint32_t RandomState = 0x2545F491U;
+
+/* Private functions ---------------------------------------------------------*/
+static uint32_t Random(void)
+{
+  RandomState ^= RandomState << 13;
+  RandomState ^= RandomState >> 17;
+  RandomState ^= RandomState << 5;
+  return RandomState;
+}
+
+/**
+  * @brief  Data units of one MCU row as built by a reference encoder
+  * @note   Each component is a plane of the band, sampled one value at a
+  *         time; the MCU holds H x V blocks of each component in scan order,
+  *         each block in raster order.
+  */
+static void ReferenceMcuRow(const uint8_t *pSrc, uint32_t Pitch, uint32_t Width, uint8_t *pDst)
+{
+  const Component_TypeDef *comp;
+  uint32_t mcu, c, bx, by, u, v, x, y;
+
+  for (mcu = 0; mcu < (Width / JPEG_ENC_MCU_WIDTH); mcu++)
+  {
+    for (c = 0; c < (sizeof(Components) / sizeof(Components[0])); c++)
+    {
+      comp = &Components[c];
+      for (by = 0; by < comp->V; by++)
+      {
+        for (bx = 0; bx < comp->H; bx++)
+        {
+          for (v = 0; v < 8U; v++)
+          {
+            for (u = 0; u < 8U; u++)
+            {
+              x = (mcu * comp->H * 8U) + (bx * 8U) + u;
+              y = (by * 8U) + v;
+              *pDst++ = pSrc[(y * Pitch) + (x * comp->Step) + comp->Offset];
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+static void FillRandom(uint8_t *pBuffer, uint32_t Size)
+{
+  uint32_t i;
+
+  for (i = 0; i < Size; i++)
+  {
+    pBuffer[i] = (uint8_t)Random();
+  }
+}
+
+/**
+  * @brief  Tile a frame band by band and compare each MCU row
+  * @retval Number of MCU rows different from the reference
+  */
+static uint32_t CheckFrame(uint32_t Width, uint32_t Height, uint32_t Pitch)
+{
+  uint32_t row_size = (Width / JPEG_ENC_MCU_WIDTH) * JPEG_ENC_MCU_SIZE;
+  uint32_t band, i, different = 0;
+  const uint8_t *src;
+
+  FillRandom(Frame, Height * Pitch);
+  for (band = 0; band < (Height / JPEG_ENC_MCU_HEIGHT); band++)
+  {
+    src = &Frame[band * JPEG_ENC_MCU_HEIGHT * Pitch];
+    (void)memset(Tiled, GUARD_BYTE, sizeof(Tiled));
+    JpegEnc_TileMcuRow(src, Pitch, Width, Tiled);
+    ReferenceMcuRow(src, Pitch, Width, Reference);
+
+    if (memcmp(Tiled, Reference, row_size) != 0)
+    {
+      different++;
+    }
+    for (i = row_size; i < (row_size + GUARD_SIZE); i++)
+    {
+      CHECK_EQ(Tiled[i], GUARD_BYTE);
+    }
+  }
+
+  return different;
+}
+
+static void TestPattern(void)
+{
+  uint32_t x, y;
+
+  /* Each sample holds its own coordinates: the layout can be read in a failure */
+  for (y = 0; y < JPEG_ENC_MCU_HEIGHT; y++)
+  {
+    for (x = 0; x < 32U; x++)
+    {
+      Frame[(y * 64U) + (x * 2U)] = (uint8_t)((y << 5) | x);
+      Frame[(y * 64U) + (x * 2U) + 1U] = (uint8_t)(0x80U | (y << 4) | (x >> 1));
+    }
+  }
+  JpegEnc_TileMcuRow(Frame, 64U, 32U, Tiled);
+
+  /* First MCU: Y of pixels 0-7 and 8-15 of each line, then Cb and Cr of each pixel pair */
+  CHECK_EQ(Tiled[0], 0x00U);
+  CHECK_EQ(Tiled[7], 0x07U);
+  CHECK_EQ(Tiled[8], 0x20U);
+  CHECK_EQ(Tiled[64], 0x08U);
+  CHECK_EQ(Tiled[127], ((7U << 5) | 15U));
+  CHECK_EQ(Tiled[128], 0x80U);
+  CHECK_EQ(Tiled[129], 0x81U);
+  CHECK_EQ(Tiled[192], 0x80U);
+  CHECK_EQ(Tiled[255], (0x80U | (7U << 4) | 7U));
+  /* Second MCU: pixels 16 to 31 */
+  CHECK_EQ(Tiled[256], 0x10U);
+  CHECK_EQ(Tiled[256 + 128], 0x88U);
+}
+
+static void TestRandom(void)
+{
+  static const uint32_t widths[] = { 16U, 32U, 48U, 640U, 800U, 1280U, 1920U };
+  uint32_t w, f, width, pitch, different = 0, rows = 0;
+
+  for (w = 0; w < (sizeof(widths) / sizeof(widths[0])); w++)
+  {
+    for (f = 0; f < RANDOM_FRAMES; f++)
+    {
+      /* Lines packed, or padded up to 64 bytes in 4-byte steps */
+      width = widths[w];
+      pitch = (width * 2U) + (((f % 2U) != 0U) ? ((Random() % 17U) * 4U) : 0U);
+      different += CheckFrame(width, MAX_HEIGHT, pitch);
+      rows += MAX_HEIGHT / JPEG_ENC_MCU_HEIGHT;
+    }
+  }
+
+  (void)printf("  %lu MCU rows, %lu different from the reference encoder\n", (unsigned long)rows,
+               (unsigned long)different);
+  CHECK_EQ(different, 0U);
+}
+
+static void BenchTiling(void)
+{
+  static uint8_t row[(BENCH_WIDTH / JPEG_ENC_MCU_WIDTH) * JPEG_ENC_MCU_SIZE] __attribute__((aligned(32)));
+  uint32_t pitch = BENCH_WIDTH * 2U;
+  uint64_t start, tile_ns, reference_ns;
+  uint32_t i, band;
+
+  FillRandom(BenchFrame, sizeof(BenchFrame));
+
+  start = HostTest_NowNs();
+  for (i = 0; i < BENCH_LOOPS; i++)
+  {
+    for (band = 0; band < (BENCH_HEIGHT / JPEG_ENC_MCU_HEIGHT); band++)
+    {
+      JpegEnc_TileMcuRow(&BenchFrame[band * JPEG_ENC_MCU_HEIGHT * pitch], pitch, BENCH_WIDTH, row);
+    }
+    __asm__ volatile("" : : "r"(row) : "memory");
+  }
+  tile_ns = (HostTest_NowNs() - start) / BENCH_LOOPS;
+
+  start = HostTest_NowNs();
+  for (i = 0; i < BENCH_LOOPS; i++)
+  {
+    for (band = 0; band < (BENCH_HEIGHT / JPEG_ENC_MCU_HEIGHT); band++)
+    {
+      ReferenceMcuRow(&BenchFrame[band * JPEG_ENC_MCU_HEIGHT * pitch], pitch, BENCH_WIDTH, row);
+    }
+    __asm__ volatile("" : : "r"(row) : "memory");
+  }
+  reference_ns = (HostTest_NowNs() - start) / BENCH_LOOPS;
+
+  (void)printf("  %ux%u frame: tiling %lu us (%lu MB/s), reference %lu us on the host\n", BENCH_WIDTH, BENCH_HEIGHT,
+               (unsigned long)(tile_ns / 1000U), (unsigned long)((sizeof(BenchFrame) * 1000U) / tile_ns),
+               (unsigned long)(reference_ns / 1000U));
+}
+
+int main(void)
+{
+  TestPattern();
+  TestRandom();
+  BenchTiling();
+
+  return HostTest_Report("jpeg_encoder");
+}
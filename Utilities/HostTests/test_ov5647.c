@@ -0,0 +1,322 @@
+/**
+  ******************************************************************************
+  * @file    test_ov5647.c
+  * @brief   Host test of Drivers/BSP/Components/ov5647 on a mock I2C bus.
+  *
+  *          The bus records each write transaction (first register, length,
+  *          tick) and keeps a register map of the sensor, the register
+  *          address being incremented within a transaction as the sensor
+  *          does. The test checks how OV5647_Init() sends the 1080p register
+  *          set: the 92 registers in 52 transactions instead of one each,
+  *          software reset and mode select each on their own, a settle time
+  *          after the reset, and every register of the set written once.
+  *
+  *          The gain model is then checked over the whole range: the code is
+  *          monotonic in the requested gain, each code is within half a code
+  *          step of it, and code -> mdB -> code gives back every code.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "ov5647.h"
+#include "host_test.h"
+#include <math.h>
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define BUS_MAX_TRANSFERS   256U
+#define BURST_MAX_LEN       32U      /* OV5647_BURST_MAX_LEN of the driver     */
+#define RESET_DELAY_MS      5U       /* OV5647_RESET_DELAY_MS of the driver    */
+
+/* 1080p register set: common registers, then the mode registers */
+#define INIT_REGISTERS      92U
+#define INIT_TRANSFERS      52U
+
+/* Gain codes of the 0 - 36 dB range, gain = code / 16 */
+#define GAIN_CODE_MIN       0x010U
+#define GAIN_CODE_MAX       0x3F2U
+/* Interpolation error of the 1 dB table, within 0.2% of the gain */
+#define GAIN_LUT_ERROR_MDB  20.0
+
+/* Private types -------------------------------------------------------------*/
+typedef struct
+{
+  uint16_t Reg;
+  uint16_t Length;
+  uint32_t Tick;
+} Bus_TransferTypeDef;
+
+typedef struct
+{
+  uint8_t             Map[0x10000];      /* Sensor registers                  */
+  uint32_t            Written[0x10000];  /* Times each register was written   */
+  Bus_TransferTypeDef Transfer[BUS_MAX_TRANSFERS];
+  uint32_t            TransferCount;
+  uint32_t            ByteCount;
+  uint32_t            Tick;
+} Bus_TypeDef;
+
+/* Private variables ---------------------------------------------------------*/
+static Bus_TypeDef Bus;
+static OV5647_Object_t Sensor;
+static int32_t GainCodeMdb[GAIN_CODE_MAX + 1U];    /* First gain giving each code */
+
+/* Registers of the 1080p set, in the order of the tables of the driver */
+static const uint16_t InitRegs[INIT_REGISTERS] =
+{
+  /* ov5647_common_regs[] */
+  0x0100, 0x0103, 0x303C, 0x3106, 0x3827, 0x370C, 0x5000, 0x5002, 0x5003, 0x5A00,
+  0x3000, 0x3001, 0x3002, 0x3016, 0x3017, 0x3018, 0x301C, 0x301D, 0x3A18, 0x3A19,
+  0x3C01, 0x3B07, 0x3630, 0x3632, 0x3633, 0x3634, 0x3636, 0x3620, 0x3621, 0x3600,
+  0x3704, 0x3703, 0x3715, 0x3717, 0x3731, 0x370B, 0x3705, 0x3F05, 0x3F06, 0x3F01,
+  0x3A0F, 0x3A10, 0x3A1B, 0x3A1E, 0x3A11, 0x3A1F, 0x4001, 0x4000, 0x4800, 0x3503,
+  0x3500, 0x3501, 0x3502, 0x350A, 0x350B,
+  /* ov5647_mode_addr[] */
+  0x3034, 0x3035, 0x3036, 0x3612, 0x3618, 0x3708, 0x3709, 0x3800, 0x3801, 0x3802,
+  0x3803, 0x3804, 0x3805, 0x3806, 0x3807, 0x3808, 0x3809, 0x380A, 0x380B, 0x380C,
+  0x380D, 0x380E, 0x380F, 0x3811, 0x3813, 0x3814, 0x3815, 0x3820, 0x3821, 0x3A08,
+  0x3A09, 0x3A0A, 0x3A0B, 0x3A0D, 0x3A0E, 0x4004, 0x4837,
+};
+
+/* Mock bus ------------------------------------------------------------------*/
+static int32_t Bus_Init(void)
+{
+  return OV5647_OK;
+}
+
+static int32_t Bus_DeInit(void)
+{
+  return OV5647_OK;
+}
+
+/* One millisecond per call, so that the driver waits always end */
+static int32_t Bus_GetTick(void)
+{
+  return (int32_t)Bus.Tick++;
+}
+
+static int32_t Bus_WriteReg(uint16_t Address, uint16_t Reg, uint8_t *pData, uint16_t Length)
+{
+  uint16_t i;
+
+  (void)Address;
+  if (Bus.TransferCount < BUS_MAX_TRANSFERS)
+  {
+    Bus.Transfer[Bus.TransferCount].Reg    = Reg;
+    Bus.Transfer[Bus.TransferCount].Length = Length;
+    Bus.Transfer[Bus.TransferCount].Tick   = Bus.Tick;
+  }
+  Bus.TransferCount++;
+  Bus.ByteCount += Length;
+
+  /* Auto-incremented register address */
+  for (i = 0; i < Length; i++)
+  {
+    Bus.Map[(uint16_t)(Reg + i)] = pData[i];
+    Bus.Written[(uint16_t)(Reg + i)]++;
+  }
+
+  return OV5647_OK;
+}
+
+static int32_t Bus_ReadReg(uint16_t Address, uint16_t Reg, uint8_t *pData, uint16_t Length)
+{
+  uint16_t i;
+
+  (void)Address;
+  for (i = 0; i < Length; i++)
+  {
+    pData[i] = Bus.Map[(uint16_t)(Reg + i)];
+  }
+
+  return OV5647_OK;
+}
+
+/* Private functions ---------------------------------------------------------*/
+static void Sensor_Reset(void)
+{
+  OV5647_IO_t io = { Bus_Init, Bus_DeInit, 0x6C, Bus_WriteReg, Bus_ReadReg, Bus_GetTick };
+
+  memset(&Bus, 0, sizeof(Bus));
+  memset(&Sensor, 0, sizeof(Sensor));
+  Bus.Map[OV5647_REG_CHIP_ID_HIGH] = OV5647_CHIP_ID_VAL_H;
+  Bus.Map[OV5647_REG_CHIP_ID_LOW]  = OV5647_CHIP_ID_VAL_L;
+
+  CHECK_EQ(OV5647_RegisterBusIO(&Sensor, &io), OV5647_OK);
+}
+
+/* Index of the transfer starting at a register, BUS_MAX_TRANSFERS if none */
+static uint32_t Bus_FindTransfer(uint16_t Reg)
+{
+  uint32_t i;
+
+  for (i = 0; (i < Bus.TransferCount) && (i < BUS_MAX_TRANSFERS); i++)
+  {
+    if (Bus.Transfer[i].Reg == Reg)
+    {
+      return i;
+    }
+  }
+
+  return BUS_MAX_TRANSFERS;
+}
+
+static void TestInitTransfers(void)
+{
+  uint32_t i, reset, max_len = 0;
+
+  Sensor_Reset();
+  CHECK_EQ(OV5647_Init(&Sensor, OV5647_R1920_1080, 0), OV5647_OK);
+
+  /* One byte per register of the table, in fewer transactions */
+  CHECK_EQ(Bus.ByteCount, INIT_REGISTERS);
+  CHECK_EQ(Bus.TransferCount, INIT_TRANSFERS);
+  for (i = 0; i < Bus.TransferCount; i++)
+  {
+    max_len = (Bus.Transfer[i].Length > max_len) ? Bus.Transfer[i].Length : max_len;
+  }
+  CHECK(max_len <= BURST_MAX_LEN);
+
+  /* Each register written once, nothing else */
+  for (i = 0; i < INIT_REGISTERS; i++)
+  {
+    CHECK_EQ(Bus.Written[InitRegs[i]], 1U);
+  }
+
+  /* Mode select and software reset alone, the next access after the settle time */
+  i = Bus_FindTransfer(OV5647_REG_MODE_SELECT);
+  CHECK(i < BUS_MAX_TRANSFERS);
+  CHECK_EQ(Bus.Transfer[i].Length, 1U);
+  CHECK_EQ(Bus.Map[OV5647_REG_MODE_SELECT], 0x00U);
+
+  reset = Bus_FindTransfer(OV5647_REG_SW_RESET);
+  CHECK(reset < BUS_MAX_TRANSFERS);
+  CHECK_EQ(Bus.Transfer[reset].Length, 1U);
+  CHECK_EQ(Bus.Map[OV5647_REG_SW_RESET], 0x01U);
+  CHECK((Bus.Transfer[reset + 1U].Tick - Bus.Transfer[reset].Tick) >= RESET_DELAY_MS);
+
+  (void)printf("  1080p init: %lu registers in %lu transactions, longest %lu\n", (unsigned long)Bus.ByteCount,
+               (unsigned long)Bus.TransferCount, (unsigned long)max_len);
+}
+
+static void TestControlTransfers(void)
+{
+  uint32_t count;
+
+  Sensor_Reset();
+  CHECK_EQ(OV5647_Init(&Sensor, OV5647_R1920_1080, 0), OV5647_OK);
+
+  /* Gain pair and exposure triplet in one burst each */
+  count = Bus.TransferCount;
+  CHECK_EQ(OV5647_SetGain(&Sensor, 6000), OV5647_OK);
+  CHECK_EQ(Bus.TransferCount, count + 1U);
+  CHECK_EQ(Bus.Transfer[count].Reg, OV5647_REG_GAIN_H);
+  CHECK_EQ(Bus.Transfer[count].Length, OV5647_GAIN_NB_REGS);
+
+  count = Bus.TransferCount;
+  CHECK_EQ(OV5647_SetExposure(&Sensor, 10000), OV5647_OK);
+  CHECK_EQ(Bus.TransferCount, count + 1U);
+  CHECK_EQ(Bus.Transfer[count].Reg, OV5647_REG_EXPOSURE_H);
+  CHECK_EQ(Bus.Transfer[count].Length, OV5647_EXPOSURE_NB_REGS);
+}
+
+/* Gain code programmed for a gain */
+static uint32_t Sensor_GainCode(int32_t gain_mdb)
+{
+  uint8_t regs[OV5647_GAIN_NB_REGS];
+
+  CHECK_EQ(OV5647_GetGainRegs(&Sensor, gain_mdb, regs), OV5647_OK);
+  return ((uint32_t)regs[0] << 8) | regs[1];
+}
+
+static void TestGainMonotonic(void)
+{
+  uint32_t code, previous = 0;
+  int32_t gain_mdb, readback, previous_readback = -1;
+  double error, step;
+  uint32_t errors = 0;
+
+  Sensor_Reset();
+  memset(GainCodeMdb, 0xFF, sizeof(GainCodeMdb));
+
+  for (gain_mdb = OV5647_GAIN_MIN_MDB; gain_mdb <= OV5647_GAIN_MAX_MDB; gain_mdb++)
+  {
+    code = Sensor_GainCode(gain_mdb);
+    CHECK_EQ(OV5647_GetGain(&Sensor, &readback), OV5647_OK);
+
+    /* Code and read back gain never go down */
+    if ((code < previous) || (readback < previous_readback))
+    {
+      errors++;
+    }
+
+    /* Nearest code: half a code step away at most, plus the table error */
+    error = fabs((20000.0 * log10((double)code / (double)GAIN_CODE_MIN)) - (double)gain_mdb);
+    step = 20000.0 * log10(((double)code + 0.5) / (double)code);
+    if ((code < GAIN_CODE_MAX) && (error > (step + GAIN_LUT_ERROR_MDB)))
+    {
+      errors++;
+    }
+
+    if ((code <= GAIN_CODE_MAX) && (GainCodeMdb[code] < 0))
+    {
+      GainCodeMdb[code] = gain_mdb;
+    }
+    previous = code;
+    previous_readback = readback;
+  }
+
+  CHECK_EQ(errors, 0U);
+  CHECK_EQ(Sensor_GainCode(OV5647_GAIN_MIN_MDB), GAIN_CODE_MIN);
+  CHECK_EQ(Sensor_GainCode(OV5647_GAIN_MAX_MDB), GAIN_CODE_MAX);
+  /* Clamped out of range */
+  CHECK_EQ(Sensor_GainCode(-1000), GAIN_CODE_MIN);
+  CHECK_EQ(Sensor_GainCode(OV5647_GAIN_MAX_MDB + 1000), GAIN_CODE_MAX);
+}
+
+static void TestGainRoundTrip(void)
+{
+  uint32_t code, missing = 0, mismatch = 0;
+  int32_t gain_mdb;
+
+  /* Every code of the range is reached, its gain gives it back */
+  for (code = GAIN_CODE_MIN; code <= GAIN_CODE_MAX; code++)
+  {
+    if (GainCodeMdb[code] < 0)
+    {
+      missing++;
+      continue;
+    }
+    (void)Sensor_GainCode(GainCodeMdb[code]);
+    CHECK_EQ(OV5647_GetGain(&Sensor, &gain_mdb), OV5647_OK);
+    if (Sensor_GainCode(gain_mdb) != code)
+    {
+      mismatch++;
+      (void)printf("  code 0x%03lX -> %ld mdB -> code 0x%03lX\n", (unsigned long)code, (long)gain_mdb,
+                   (unsigned long)Sensor_GainCode(gain_mdb));
+    }
+  }
+
+  CHECK_EQ(missing, 0U);
+  CHECK_EQ(mismatch, 0U);
+}
+
+int main(void)
+{
+  TestInitTransfers();
+  TestControlTransfers();
+  TestGainMonotonic();
+  TestGainRoundTrip();
+
+  return HostTest_Report("ov5647");
+}
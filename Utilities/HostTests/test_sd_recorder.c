@@ -0,0 +1,504 @@
+/**
+  ******************************************************************************
+  * @file    test_sd_recorder.c
+  * @brief   Host test of the SD card recorder (sd_recorder.c).
+  *
+  *          The BSP SD calls are served by a block device backed by a
+  *          temporary file, with the timing of a card on the 4-bit high
+  *          speed bus of the board: 25 MB/s transfers, a programming time
+  *          after each write command and a longer busy time every few
+  *          megabytes, when the card reorganizes its flash. The transfer is
+  *          reported complete at once, the card then stays busy for the
+  *          transfer and programming time. The DWT cycle counter and the
+  *          HAL tick follow the simulated time, advanced by the card polls,
+  *          by the copies into the staging buffers and by each main loop.
+  *
+  *          The container written to the file is read back and checked
+  *          against the frames given: header, index, data, padding, erased
+  *          blocks, and no write out of the extent. Frame streams of the
+  *          application are then recorded at their frame rate, and the
+  *          throughput, the worst write command and the worst wait of a
+  *          full staging buffer reported by SDRec_GetStats() are printed.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sd_recorder.h"
+#include "stm32n6570_discovery_sd.h"
+#include "host_test.h"
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+/* Card: blocks before the extent are checked untouched */
+#define CARD_BLOCKS            0x20000U        /* 64 MB */
+#define EXTENT_START           0x100U
+#define EXTENT_BLOCKS          (CARD_BLOCKS - EXTENT_START)
+#define ERASED_BYTE            0x00U
+#define OUTSIDE_BYTE           0x11U
+
+/* Card timing model, ns */
+#define CARD_NS_PER_BLOCK      20480U          /* 512 bytes at 25 MB/s */
+#define CARD_PROGRAM_NS        250000U
+#define CARD_HOUSEKEEPING_NS   40000000U
+#define CARD_HOUSEKEEPING_BLOCKS 8192U         /* 4 MB */
+#define CARD_ERASE_NS          100000000U
+#define CARD_POLL_NS           1000U
+#define ERASE_CHUNK_BLOCKS     256U
+
+/* Device: 800 MHz CPU, staging copies from the frame buffers at 400 MB/s */
+#define CPU_HZ                 800000000U
+#define COPY_NS_PER_KB         2500U
+#define LOOP_NS                5000U
+
+/* Staging ring of the application */
+#define APP_STAGING_SIZE       (64U * 1024U)
+#define APP_NB_STAGING         2U
+
+#define RAW10_1080P_SIZE       ((1920U * 1080U * 10U) / 8U)
+#define MAX_STAGING_SIZE       (256U * 1024U)
+#define CONTAINER_FRAMES       100U
+#define CONTAINER_MAX_SIZE     (200U * 1024U)
+
+/* Private types -------------------------------------------------------------*/
+/**
+  * @brief  Frame stream recorded at its frame rate
+  */
+typedef struct
+{
+  const char *Name;
+  uint32_t   MinSize;          /*!< Frame sizes, uniform in [MinSize, MaxSize] */
+  uint32_t   MaxSize;
+  uint32_t   FrameRate;        /*!< Frames per second                          */
+  uint32_t   NbFrames;         /*!< Frames given to the recorder               */
+  uint32_t   StagingSize;
+  uint32_t   NbStaging;
+  uint8_t    NoDrop;           /*!< The stream must be recorded in full        */
+} Stream_TypeDef;
+
+/* Private variables ---------------------------------------------------------*/
+uint32_t SystemCoreClock = CPU_HZ;
+
+static FILE     *Card;
+static uint64_t Now;                   /* Simulated time, ns */
+static uint64_t CardBusyUntil;
+static uint32_t CardWritten;           /* Blocks written since the last housekeeping */
+static uint8_t  CardFail;              /* Fail the next write command */
+static uint8_t  CardOutside;           /* A command reached out of the extent */
+
+static SDRec_HandleTypeDef Recorder;
+
+static uint8_t Staging[SD_REC_MAX_STAGING * MAX_STAGING_SIZE] __attribute__((aligned(32)));
+static uint8_t Frames[RAW10_1080P_SIZE + CONTAINER_MAX_SIZE];
+static uint8_t Block[SD_REC_BLOCK_SIZE];
+static uint8_t Erased[ERASE_CHUNK_BLOCKS * SD_REC_BLOCK_SIZE];
+static uint32_t FrameOffset[CONTAINER_FRAMES];
+static uint32_t FrameSize[CONTAINER_FRAMES];
+
+static const Stream_TypeDef Streams[] =
+{
+  { "JPEG 800x480 30 fps", 30U * 1024U, 72U * 1024U, 30U, 300U, APP_STAGING_SIZE, APP_NB_STAGING, 1U },
+  { "RGB888 224x224 30 fps", 224U * 224U * 3U, 224U * 224U * 3U, 30U, 300U, APP_STAGING_SIZE, APP_NB_STAGING, 0U },
+  { "RGB888 224x224 30 fps", 224U * 224U * 3U, 224U * 224U * 3U, 30U, 300U, APP_STAGING_SIZE, 4U, 1U },
+  { "RAW10 1080p 5 fps", RAW10_1080P_SIZE, RAW10_1080P_SIZE, 5U, 20U, APP_STAGING_SIZE, APP_NB_STAGING, 1U },
+  { "RAW10 1080p 8 fps", RAW10_1080P_SIZE, RAW10_1080P_SIZE, 8U, 32U, MAX_STAGING_SIZE, 4U, 0U },
+  { "RAW10 1080p 30 fps", RAW10_1080P_SIZE, RAW10_1080P_SIZE, 30U, 60U, MAX_STAGING_SIZE, 4U, 0U },
+};
+
+static uint32_t RandomState = 0x2545F491U;
+
+/* Private functions ---------------------------------------------------------*/
+static uint32_t Random(void)
+{
+  RandomState ^= RandomState << 13;
+  RandomState ^= RandomState >> 17;
+  RandomState ^= RandomState << 5;
+  return RandomState;
+}
+
+/**
+  * @brief  Advance the simulated time, with the cycle counter and the tick
+  */
+static void Advance(uint64_t Ns)
+{
+  Now += Ns;
+  HostDwt.CYCCNT = (uint32_t)((Now * (CPU_HZ / 1000000U)) / 1000U);
+  HostTick = (uint32_t)(Now / 1000000U);
+}
+
+static void ReadBlock(uint32_t Index, uint8_t *pData)
+{
+  CHECK_EQ(fseek(Card, (long)Index * SD_REC_BLOCK_SIZE, SEEK_SET), 0);
+  CHECK_EQ(fread(pData, 1, SD_REC_BLOCK_SIZE, Card), SD_REC_BLOCK_SIZE);
+}
+
+static void WriteBlocks(uint32_t Index, const uint8_t *pData, uint32_t NbBlocks)
+{
+  CHECK_EQ(fseek(Card, (long)Index * SD_REC_BLOCK_SIZE, SEEK_SET), 0);
+  CHECK_EQ(fwrite(pData, SD_REC_BLOCK_SIZE, NbBlocks, Card), NbBlocks);
+}
+
+/**
+  * @brief  New card: the blocks out of the extent hold a pattern
+  */
+static void CardReset(void)
+{
+  uint32_t i;
+
+  if (Card != NULL)
+  {
+    (void)fclose(Card);
+  }
+  Card = tmpfile();
+  CHECK(Card != NULL);
+
+  (void)memset(Block, OUTSIDE_BYTE, sizeof(Block));
+  for (i = 0; i < EXTENT_START; i++)
+  {
+    WriteBlocks(i, Block, 1U);
+  }
+  CardBusyUntil = Now;
+  CardWritten = 0;
+  CardFail = 0;
+  CardOutside = 0;
+}
+
+static void RecorderInit(uint32_t StagingSize, uint32_t NbStaging, uint32_t MaxFrames)
+{
+  SDRec_ConfTypeDef conf = { 0 };
+
+  conf.Instance       = 0;
+  conf.StartBlock     = EXTENT_START;
+  conf.NbBlocks       = EXTENT_BLOCKS;
+  conf.MaxFrames      = MaxFrames;
+  conf.StagingAddress = (uint32_t)Staging;
+  conf.StagingSize    = StagingSize;
+  conf.NbStaging      = NbStaging;
+  CHECK_EQ(SDRec_Init(&Recorder, &conf), HAL_OK);
+}
+
+/**
+  * @brief  Main loop pass: recorder background, then the time it took
+  */
+static void Process(void)
+{
+  const uint8_t *frame = Recorder.pFrame;
+  uint32_t copied = Recorder.FrameCopied;
+
+  SDRec_Process(&Recorder);
+  if (frame != NULL)
+  {
+    copied = ((Recorder.pFrame == NULL) ? Recorder.FrameSize : Recorder.FrameCopied) - copied;
+  }
+  else
+  {
+    copied = 0;
+  }
+  Advance(LOOP_NS + (((uint64_t)copied * COPY_NS_PER_KB) / 1024U));
+}
+
+/**
+  * @brief  Copy the frame and wait for it to be taken by the recorder
+  */
+static void WriteFrameAndWait(uint32_t Offset, uint32_t Size, uint32_t FrameId)
+{
+  CHECK_EQ(SDRec_WriteFrame(&Recorder, (uint32_t)&Frames[Offset], Size, FrameId), HAL_OK);
+  while (SDRec_IsReady(&Recorder) == 0U)
+  {
+    Process();
+  }
+}
+
+static void TestContainer(void)
+{
+  SDRec_HeaderTypeDef header;
+  SDRec_IndexEntryTypeDef entry;
+  uint32_t f, i, block, offset;
+
+  HostHal_Reset();
+  Now = 0;
+  CardReset();
+  for (i = 0; i < sizeof(Frames); i++)
+  {
+    Frames[i] = (uint8_t)Random();
+  }
+
+  /* 3 staging buffers of 16 KB, frames from 1 byte to 200 KB, some of whole blocks */
+  RecorderInit(16U * 1024U, 3U, CONTAINER_FRAMES);
+  CHECK_EQ(SDRec_Start(&Recorder, SD_REC_FORMAT_RAW10, 1920U, 1080U), HAL_OK);
+  for (f = 0; f < CONTAINER_FRAMES; f++)
+  {
+    FrameSize[f] = ((f % 7U) == 3U) ? (SD_REC_BLOCK_SIZE * (1U + (Random() % 64U))) :
+                   (1U + (Random() % CONTAINER_MAX_SIZE));
+    FrameOffset[f] = Random() % (sizeof(Frames) - FrameSize[f]);
+    WriteFrameAndWait(FrameOffset[f], FrameSize[f], 1000U + (3U * f));
+
+    /* Open recording: the full index blocks are on the card once written */
+    if ((f == 40U) && (Recorder.IndexPendingBlock == 0U))
+    {
+      ReadBlock(EXTENT_START, Block);
+      (void)memcpy(&header, Block, sizeof(header));
+      CHECK_EQ(header.NbFrames, SD_REC_NB_FRAMES_OPEN);
+      ReadBlock(EXTENT_START + 1U, Block);
+      (void)memcpy(&entry, &Block[(SD_REC_INDEX_PER_BLOCK - 1U) * sizeof(entry)], sizeof(entry));
+      CHECK_EQ(entry.FrameId, 1000U + (3U * (SD_REC_INDEX_PER_BLOCK - 1U)));
+    }
+  }
+  CHECK_EQ(SDRec_Stop(&Recorder), HAL_OK);
+  CHECK_EQ(CardOutside, 0U);
+
+  /* Header */
+  ReadBlock(EXTENT_START, Block);
+  (void)memcpy(&header, Block, sizeof(header));
+  CHECK_EQ(header.Magic, SD_REC_MAGIC);
+  CHECK_EQ(header.Version, SD_REC_VERSION);
+  CHECK_EQ(header.Format, SD_REC_FORMAT_RAW10);
+  CHECK_EQ(header.Width, 1920U);
+  CHECK_EQ(header.Height, 1080U);
+  CHECK_EQ(header.IndexBlocks, (CONTAINER_FRAMES + SD_REC_INDEX_PER_BLOCK - 1U) / SD_REC_INDEX_PER_BLOCK);
+  CHECK_EQ(header.DataBlock, 1U + header.IndexBlocks);
+  CHECK_EQ(header.NbFrames, CONTAINER_FRAMES);
+
+  /* Index and frames, one after the other, each padded with zeros to a block */
+  block = header.DataBlock;
+  for (f = 0; f < CONTAINER_FRAMES; f++)
+  {
+    ReadBlock(EXTENT_START + 1U + (f / SD_REC_INDEX_PER_BLOCK), Block);
+    (void)memcpy(&entry, &Block[(f % SD_REC_INDEX_PER_BLOCK) * sizeof(entry)], sizeof(entry));
+    CHECK_EQ(entry.Block, block);
+    CHECK_EQ(entry.Size, FrameSize[f]);
+    CHECK_EQ(entry.FrameId, 1000U + (3U * f));
+
+    for (offset = 0; offset < FrameSize[f]; offset += SD_REC_BLOCK_SIZE)
+    {
+      ReadBlock(EXTENT_START + block, Block);
+      i = FrameSize[f] - offset;
+      i = (i > SD_REC_BLOCK_SIZE) ? SD_REC_BLOCK_SIZE : i;
+      CHECK(memcmp(Block, &Frames[FrameOffset[f] + offset], i) == 0);
+      for (; i < SD_REC_BLOCK_SIZE; i++)
+      {
+        CHECK_EQ(Block[i], 0U);
+      }
+      block++;
+    }
+  }
+  CHECK_EQ(header.DataBlocks, block - header.DataBlock);
+
+  /* Rest of the last index block cleared, the next data block still erased */
+  ReadBlock(EXTENT_START + header.IndexBlocks, Block);
+  for (i = (CONTAINER_FRAMES % SD_REC_INDEX_PER_BLOCK) * sizeof(entry); i < SD_REC_BLOCK_SIZE; i++)
+  {
+    CHECK_EQ(Block[i], 0U);
+  }
+  ReadBlock(EXTENT_START + block, Block);
+  for (i = 0; i < SD_REC_BLOCK_SIZE; i++)
+  {
+    CHECK_EQ(Block[i], ERASED_BYTE);
+  }
+
+  /* Blocks before the extent untouched */
+  for (block = 0; block < EXTENT_START; block++)
+  {
+    ReadBlock(block, Block);
+    for (i = 0; i < SD_REC_BLOCK_SIZE; i++)
+    {
+      CHECK_EQ(Block[i], OUTSIDE_BYTE);
+    }
+  }
+}
+
+static void TestRefused(void)
+{
+  HostHal_Reset();
+  CardReset();
+
+  RecorderInit(APP_STAGING_SIZE, APP_NB_STAGING, 3U);
+  CHECK_EQ(SDRec_WriteFrame(&Recorder, (uint32_t)Frames, 1000U, 0U), HAL_ERROR);
+  CHECK_EQ(SDRec_Stop(&Recorder), HAL_ERROR);
+
+  CHECK_EQ(SDRec_Start(&Recorder, SD_REC_FORMAT_JPEG, 800U, 480U), HAL_OK);
+  CHECK_EQ(SDRec_Start(&Recorder, SD_REC_FORMAT_JPEG, 800U, 480U), HAL_ERROR);
+  CHECK_EQ(SDRec_WriteFrame(&Recorder, (uint32_t)Frames, 0U, 0U), HAL_ERROR);
+
+  /* Previous frame not copied yet */
+  CHECK_EQ(SDRec_WriteFrame(&Recorder, (uint32_t)Frames, 200000U, 1U), HAL_OK);
+  CHECK_EQ(SDRec_WriteFrame(&Recorder, (uint32_t)Frames, 1000U, 2U), HAL_BUSY);
+  CHECK_EQ(Recorder.DropCount, 1U);
+  while (SDRec_IsReady(&Recorder) == 0U)
+  {
+    Process();
+  }
+
+  /* Frame larger than the rest of the extent, then index full */
+  CHECK_EQ(SDRec_WriteFrame(&Recorder, (uint32_t)Frames, EXTENT_BLOCKS * SD_REC_BLOCK_SIZE, 3U), HAL_ERROR);
+  WriteFrameAndWait(0U, 1000U, 4U);
+  WriteFrameAndWait(0U, 1000U, 5U);
+  CHECK_EQ(SDRec_WriteFrame(&Recorder, (uint32_t)Frames, 1000U, 6U), HAL_ERROR);
+  CHECK_EQ(Recorder.DropCount, 3U);
+  CHECK_EQ(SDRec_Stop(&Recorder), HAL_OK);
+  CHECK_EQ(Recorder.Header.NbFrames, 3U);
+}
+
+static void TestCardError(void)
+{
+  HostHal_Reset();
+  CardReset();
+
+  /* Write command refused in the middle of a frame: the recording is aborted */
+  RecorderInit(APP_STAGING_SIZE, APP_NB_STAGING, 16U);
+  CHECK_EQ(SDRec_Start(&Recorder, SD_REC_FORMAT_JPEG, 800U, 480U), HAL_OK);
+  WriteFrameAndWait(0U, 100000U, 0U);
+  CHECK_EQ(SDRec_WriteFrame(&Recorder, (uint32_t)Frames, 300000U, 1U), HAL_OK);
+  CardFail = 1;
+  while (SDRec_IsReady(&Recorder) == 0U)
+  {
+    Process();
+  }
+  CHECK_EQ(Recorder.Error, 1U);
+  CHECK_EQ(SDRec_WriteFrame(&Recorder, (uint32_t)Frames, 1000U, 2U), HAL_ERROR);
+  CHECK_EQ(SDRec_Stop(&Recorder), HAL_ERROR);
+
+  /* Transfer error reported by the SD callbacks */
+  CardReset();
+  CHECK_EQ(SDRec_Start(&Recorder, SD_REC_FORMAT_JPEG, 800U, 480U), HAL_OK);
+  CHECK_EQ(SDRec_WriteFrame(&Recorder, (uint32_t)Frames, 100000U, 0U), HAL_OK);
+  Process();
+  SDRec_ErrorHandler(&Recorder);
+  Process();
+  CHECK_EQ(SDRec_IsReady(&Recorder), 1U);
+  CHECK_EQ(SDRec_Stop(&Recorder), HAL_ERROR);
+}
+
+/**
+  * @brief  Record a stream at its frame rate and print the recorder statistics
+  */
+static void RunStream(const Stream_TypeDef *pStream)
+{
+  SDRec_StatsTypeDef stats;
+  uint64_t next;
+  uint32_t f = 0, size;
+
+  HostHal_Reset();
+  Now = 0;
+  CardReset();
+
+  RecorderInit(pStream->StagingSize, pStream->NbStaging, pStream->NbFrames);
+  CHECK_EQ(SDRec_Start(&Recorder, SD_REC_FORMAT_RAW10, 0U, 0U), HAL_OK);
+  next = Now;
+  while (f < pStream->NbFrames)
+  {
+    if (Now >= next)
+    {
+      /* A frame not taken is dropped by the capture */
+      size = pStream->MinSize + (Random() % (pStream->MaxSize - pStream->MinSize + 1U));
+      (void)SDRec_WriteFrame(&Recorder, (uint32_t)Frames, size, f);
+      f++;
+      next += 1000000000U / pStream->FrameRate;
+    }
+    Process();
+  }
+  CHECK_EQ(SDRec_Stop(&Recorder), HAL_OK);
+  CHECK_EQ(CardOutside, 0U);
+
+  SDRec_GetStats(&Recorder, &stats);
+  CHECK_EQ(stats.FrameCount + stats.DropCount, pStream->NbFrames);
+  CHECK_EQ(Recorder.Header.NbFrames, stats.FrameCount);
+  if (pStream->NoDrop != 0U)
+  {
+    CHECK_EQ(stats.DropCount, 0U);
+  }
+
+  (void)printf("  %-22s %lux%-3luKB: %3lu/%3lu frames, %2lu.%01lu MB/s, worst write %6lu us, worst stall %6lu us\n",
+               pStream->Name, (unsigned long)pStream->NbStaging, (unsigned long)(pStream->StagingSize / 1024U),
+               (unsigned long)stats.FrameCount, (unsigned long)pStream->NbFrames,
+               (unsigned long)(stats.KBytesPerSec / 1024U),
+               (unsigned long)(((stats.KBytesPerSec % 1024U) * 10U) / 1024U),
+               (unsigned long)stats.WorstWriteUs, (unsigned long)stats.WorstStallUs);
+}
+
+static void TestStreams(void)
+{
+  uint32_t s;
+
+  for (s = 0; s < (sizeof(Streams) / sizeof(Streams[0])); s++)
+  {
+    RunStream(&Streams[s]);
+  }
+}
+
+/* BSP SD, on the file ------------------------------------------------------*/
+int32_t BSP_SD_Erase(uint32_t Instance, uint32_t BlockIdx, uint32_t BlocksNbr)
+{
+  uint32_t i, n;
+
+  (void)Instance;
+  /* Up to BlockIdx + BlocksNbr included */
+  CardOutside |= ((BlockIdx < EXTENT_START) || ((BlockIdx + BlocksNbr) >= CARD_BLOCKS)) ? 1U : 0U;
+  (void)memset(Erased, ERASED_BYTE, sizeof(Erased));
+  for (i = BlockIdx; (i <= (BlockIdx + BlocksNbr)) && (i < CARD_BLOCKS); i += n)
+  {
+    n = (BlockIdx + BlocksNbr + 1U) - i;
+    n = (n > ERASE_CHUNK_BLOCKS) ? ERASE_CHUNK_BLOCKS : n;
+    n = ((i + n) > CARD_BLOCKS) ? (CARD_BLOCKS - i) : n;
+    WriteBlocks(i, Erased, n);
+  }
+  CardBusyUntil = Now + CARD_ERASE_NS;
+
+  return BSP_ERROR_NONE;
+}
+
+int32_t BSP_SD_WriteBlocks_DMA(uint32_t Instance, uint32_t *pData, uint32_t BlockIdx, uint32_t BlocksNbr)
+{
+  (void)Instance;
+  CHECK(Now >= CardBusyUntil);
+  if (CardFail != 0U)
+  {
+    CardFail = 0;
+    return BSP_ERROR_PERIPH_FAILURE;
+  }
+  CardOutside |= ((BlockIdx < EXTENT_START) || ((BlockIdx + BlocksNbr) > CARD_BLOCKS)) ? 1U : 0U;
+  WriteBlocks(BlockIdx, (const uint8_t *)pData, BlocksNbr);
+
+  /* Transfer, programming, and housekeeping every few megabytes */
+  CardBusyUntil = Now + ((uint64_t)BlocksNbr * CARD_NS_PER_BLOCK) + CARD_PROGRAM_NS;
+  CardWritten += BlocksNbr;
+  if (CardWritten >= CARD_HOUSEKEEPING_BLOCKS)
+  {
+    CardWritten -= CARD_HOUSEKEEPING_BLOCKS;
+    CardBusyUntil += CARD_HOUSEKEEPING_NS;
+  }
+
+  /* The data is sent at once, the write complete callback follows */
+  SDRec_WriteCpltHandler(&Recorder);
+
+  return BSP_ERROR_NONE;
+}
+
+int32_t BSP_SD_GetCardState(uint32_t Instance)
+{
+  (void)Instance;
+  Advance(CARD_POLL_NS);
+
+  return (int32_t)((Now >= CardBusyUntil) ? SD_TRANSFER_OK : SD_TRANSFER_BUSY);
+}
+
+int main(void)
+{
+  TestContainer();
+  TestRefused();
+  TestCardError();
+  TestStreams();
+
+  (void)fclose(Card);
+
+  return HostTest_Report("sd_recorder");
+}
@@ -0,0 +1,400 @@
+/**
+  ******************************************************************************
+  * @file    test_touch_meter.c
+  * @brief   Host test of FSBL/Src/touch_meter.c.
+  *
+  *          The display to sensor transforms are checked on the edges of the
+  *          video window, with each ISP decimation factor and with spots
+  *          running out of the sensor frame, then on random maps against
+  *          their definition: the sensor point is the decimated crop pixel
+  *          under the center of the tapped display pixel, the statistic area
+  *          is the spot scaled to the sensor frame, within the ISP limits,
+  *          centered on that point and kept inside the frame. The tap
+  *          handling runs on a recorded ISP and a simulated touch panel.
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "touch_meter.h"
+#include "stm32n6570_discovery_ts.h"
+#include "host_test.h"
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define RANDOM_MAPS     20000U
+#define RANDOM_TAPS     16U
+
+/* Private variables ---------------------------------------------------------*/
+/* 800x480 preview of the 1920x1080 frame decimated by 2, as main.c */
+static const TouchMeter_MapTypeDef MapPreview = { 0, 0, 800, 480, 0, 0, 960, 540, 2, 1920, 1080 };
+/* 640x360 window at 80,60 showing the center 1600x900 of the frame */
+static const TouchMeter_MapTypeDef MapWindow = { 80, 60, 640, 360, 160, 90, 1600, 900, 1, 1920, 1080 };
+
+static ISP_HandleTypeDef   hIsp;
+static ISP_StatAreaTypeDef IspArea;
+static ISP_StatusTypeDef   IspStatus;
+static uint32_t            IspSetCount;
+static uint32_t            IspRestartCount;
+static TS_State_t          Panel;
+
+static uint32_t RandomState = 0x2545F491U;
+
+/* Private functions ---------------------------------------------------------*/
+static uint32_t Random(void)
+{
+  RandomState ^= RandomState << 13;
+  RandomState ^= RandomState >> 17;
+  RandomState ^= RandomState << 5;
+  return RandomState;
+}
+
+/**
+  * @brief  Check a sensor coordinate against its definition
+  * @param  Pos        Display coordinate, in the video window
+  * @param  Sensor     Sensor coordinate given by TouchMeter_MapPoint()
+  * @param  Origin     Video window start
+  * @param  Size       Video window size
+  * @param  Crop       Crop window start
+  * @param  CropSize   Crop window size
+  * @param  Decim      ISP decimation
+  * @param  Max        Sensor frame size
+  * @retval 1 if the coordinate is right
+  */
+static uint32_t IsSensorPos(uint32_t Pos, uint32_t Sensor, uint32_t Origin, uint32_t Size, uint32_t Crop,
+                            uint32_t CropSize, uint32_t Decim, uint32_t Max)
+{
+  /* Crop pixel under the display pixel center: 2(c - Crop)Size <= (2i + 1)CropSize < 2(c - Crop + 1)Size */
+  uint64_t c = Crop + (((2U * (uint64_t)(Pos - Origin) + 1U) * CropSize) / (2U * (uint64_t)Size));
+  uint64_t center = (2U * (uint64_t)(Pos - Origin) + 1U) * CropSize;
+
+  if (((2U * (c - Crop) * Size) > center) || (center >= (2U * (c - Crop + 1U) * Size)))
+  {
+    return 0;
+  }
+
+  /* Decimated coordinate, the last pixel of the frame when the crop runs past it */
+  return (Sensor == (((c * Decim) < Max) ? (c * Decim) : (Max - 1U))) ? 1U : 0U;
+}
+
+/**
+  * @brief  Check a statistic area coordinate against its definition
+  * @param  Start   Area start
+  * @param  Size    Area size
+  * @param  Spot    Spot size on the display
+  * @param  Point   Sensor point of the spot center
+  * @param  Num     Sensor pixels for Den display pixels
+  * @param  Den     Display pixels
+  * @param  Max     Sensor frame size
+  * @retval 1 if the area is right
+  */
+static uint32_t IsAreaPos(uint32_t Start, uint32_t Size, uint32_t Spot, uint32_t Point, uint32_t Num,
+                          uint32_t Den, uint32_t Max)
+{
+  uint64_t size = ((uint64_t)Spot * Num) / Den;
+  uint32_t limit = (Max < ISP_STATWINDOW_MAX) ? Max : ISP_STATWINDOW_MAX;
+
+  size = (size > limit) ? limit : size;
+  size = (size < ISP_STATWINDOW_MIN) ? ISP_STATWINDOW_MIN : size;
+
+  if ((Size != size) || ((Start + Size) > Max) || (Point < Start) || (Point > (Start + Size)))
+  {
+    return 0;
+  }
+
+  /* Centered on the point unless an edge of the frame is in the way */
+  if ((Point >= (Size / 2U)) && ((Point - (Size / 2U) + Size) <= Max))
+  {
+    return (Start == (Point - (Size / 2U))) ? 1U : 0U;
+  }
+
+  return ((Start == 0U) || ((Start + Size) == Max)) ? 1U : 0U;
+}
+
+static void TestInvalid(void)
+{
+  TouchMeter_MapTypeDef map;
+  ISP_StatAreaTypeDef area;
+  uint32_t x, y;
+
+  CHECK_EQ(TouchMeter_MapPoint(NULL, 0, 0, &x, &y), HAL_ERROR);
+  CHECK_EQ(TouchMeter_MapPoint(&MapPreview, 0, 0, NULL, &y), HAL_ERROR);
+  CHECK_EQ(TouchMeter_MapPoint(&MapPreview, 0, 0, &x, NULL), HAL_ERROR);
+  CHECK_EQ(TouchMeter_ComputeArea(&MapPreview, 0, 0, 96, 96, NULL), HAL_ERROR);
+
+  map = MapPreview;
+  map.DisplayWidth = 0;
+  CHECK_EQ(TouchMeter_MapPoint(&map, 0, 0, &x, &y), HAL_ERROR);
+  map = MapPreview;
+  map.CropHeight = 0;
+  CHECK_EQ(TouchMeter_MapPoint(&map, 0, 0, &x, &y), HAL_ERROR);
+  map = MapPreview;
+  map.Decimation = 0;
+  CHECK_EQ(TouchMeter_ComputeArea(&map, 0, 0, 96, 96, &area), HAL_ERROR);
+  map = MapPreview;
+  map.SensorWidth = ISP_STATWINDOW_MIN - 1U;
+  CHECK_EQ(TouchMeter_ComputeArea(&map, 0, 0, 96, 96, &area), HAL_ERROR);
+}
+
+static void TestWindowEdges(void)
+{
+  const TouchMeter_MapTypeDef *map = &MapWindow;
+  uint32_t x0 = map->DisplayX, x1 = map->DisplayX + map->DisplayWidth - 1U;
+  uint32_t y0 = map->DisplayY, y1 = map->DisplayY + map->DisplayHeight - 1U;
+  ISP_StatAreaTypeDef area;
+  uint32_t x, y;
+
+  /* Just out of the video window */
+  CHECK_EQ(TouchMeter_MapPoint(map, x0 - 1U, y0, &x, &y), HAL_ERROR);
+  CHECK_EQ(TouchMeter_MapPoint(map, x1 + 1U, y0, &x, &y), HAL_ERROR);
+  CHECK_EQ(TouchMeter_MapPoint(map, x0, y0 - 1U, &x, &y), HAL_ERROR);
+  CHECK_EQ(TouchMeter_MapPoint(map, x0, y1 + 1U, &x, &y), HAL_ERROR);
+  CHECK_EQ(TouchMeter_ComputeArea(map, x1 + 1U, y1 + 1U, 96, 96, &area), HAL_ERROR);
+
+  /* Corners: 2.5 sensor pixels per display pixel, center of the first and last ones */
+  CHECK_EQ(TouchMeter_MapPoint(map, x0, y0, &x, &y), HAL_OK);
+  CHECK_EQ(x, map->CropX + 1U);
+  CHECK_EQ(y, map->CropY + 1U);
+  CHECK_EQ(TouchMeter_MapPoint(map, x1, y1, &x, &y), HAL_OK);
+  CHECK_EQ(x, map->CropX + map->CropWidth - 2U);
+  CHECK_EQ(y, map->CropY + map->CropHeight - 2U);
+
+  /* Window center */
+  CHECK_EQ(TouchMeter_MapPoint(map, x0 + (map->DisplayWidth / 2U), y0 + (map->DisplayHeight / 2U), &x, &y),
+           HAL_OK);
+  CHECK_EQ(x, 960U + 1U);
+  CHECK_EQ(y, 540U + 1U);
+
+  /* Corner spot: centered on the tap where the frame runs past the crop, pushed inside at the top */
+  CHECK_EQ(TouchMeter_ComputeArea(map, x0, y0, 96, 96, &area), HAL_OK);
+  CHECK_EQ(area.XSize, 240U);
+  CHECK_EQ(area.YSize, 240U);
+  CHECK_EQ(area.X0, (map->CropX + 1U) - 120U);
+  CHECK_EQ(area.Y0, 0U);
+}
+
+static void TestDecimation(void)
+{
+  static const uint32_t factors[] = { 1, 2, 4, 8 };
+  TouchMeter_MapTypeDef map = MapPreview;
+  ISP_StatAreaTypeDef area;
+  uint32_t f, x, sx, sy;
+
+  for (f = 0; f < (sizeof(factors) / sizeof(factors[0])); f++)
+  {
+    /* Whole decimated frame on the display */
+    map.Decimation = factors[f];
+    map.CropWidth  = map.SensorWidth / factors[f];
+    map.CropHeight = map.SensorHeight / factors[f];
+
+    for (x = 0; x < map.DisplayWidth; x++)
+    {
+      CHECK_EQ(TouchMeter_MapPoint(&map, x, map.DisplayHeight - 1U, &sx, &sy), HAL_OK);
+      CHECK_EQ(sx % factors[f], 0U);
+      CHECK(IsSensorPos(x, sx, 0, map.DisplayWidth, 0, map.CropWidth, factors[f], map.SensorWidth) == 1U);
+    }
+    /* Last line: in the last decimated line of the frame */
+    CHECK(sy < map.SensorHeight);
+    CHECK(sy >= (map.SensorHeight - (2U * factors[f])));
+
+    /* Same spot on the display, same part of the sensor frame */
+    CHECK_EQ(TouchMeter_ComputeArea(&map, 400, 240, 96, 96, &area), HAL_OK);
+    CHECK_EQ(area.XSize, (96U * 1920U) / 800U);
+    CHECK_EQ(area.YSize, (96U * 1080U) / 480U);
+    CHECK((area.X0 + (area.XSize / 2U)) >= (960U - factors[f]));
+    CHECK((area.X0 + (area.XSize / 2U)) <= (960U + factors[f]));
+  }
+
+  /* Crop running past the frame: kept on its last pixel */
+  map = MapPreview;
+  map.SensorWidth = 1900;
+  CHECK_EQ(TouchMeter_MapPoint(&map, map.DisplayWidth - 1U, 0, &sx, &sy), HAL_OK);
+  CHECK_EQ(sx, 1899U);
+}
+
+static void TestClamp(void)
+{
+  TouchMeter_MapTypeDef map = MapPreview;
+  ISP_StatAreaTypeDef area;
+
+  /* Corners of the frame: spot pushed inside */
+  CHECK_EQ(TouchMeter_ComputeArea(&map, 0, 0, 96, 96, &area), HAL_OK);
+  CHECK_EQ(area.X0, 0U);
+  CHECK_EQ(area.Y0, 0U);
+  CHECK_EQ(TouchMeter_ComputeArea(&map, 799, 479, 96, 96, &area), HAL_OK);
+  CHECK_EQ(area.X0 + area.XSize, map.SensorWidth);
+  CHECK_EQ(area.Y0 + area.YSize, map.SensorHeight);
+
+  /* Spot larger than the frame: the whole frame */
+  CHECK_EQ(TouchMeter_ComputeArea(&map, 400, 240, 2000, 2000, &area), HAL_OK);
+  CHECK_EQ(area.X0, 0U);
+  CHECK_EQ(area.Y0, 0U);
+  CHECK_EQ(area.XSize, map.SensorWidth);
+  CHECK_EQ(area.YSize, map.SensorHeight);
+
+  /* Spot of one display pixel: the smallest statistic area */
+  CHECK_EQ(TouchMeter_ComputeArea(&map, 400, 240, 1, 1, &area), HAL_OK);
+  CHECK_EQ(area.XSize, ISP_STATWINDOW_MIN);
+  CHECK_EQ(area.YSize, ISP_STATWINDOW_MIN);
+
+  /* Frame wider than the statistic window of the ISP */
+  map.SensorWidth = 5000;
+  map.CropWidth   = 2500;
+  CHECK_EQ(TouchMeter_ComputeArea(&map, 799, 240, 2000, 96, &area), HAL_OK);
+  CHECK_EQ(area.XSize, ISP_STATWINDOW_MAX);
+  CHECK_EQ(area.X0 + area.XSize, map.SensorWidth);
+}
+
+static void TestRandom(void)
+{
+  TouchMeter_MapTypeDef map;
+  TouchMeter_RectTypeDef rect;
+  ISP_StatAreaTypeDef area;
+  uint32_t i, t, x, y, sx, sy, w, h, failures = 0;
+  HAL_StatusTypeDef status;
+
+  for (i = 0; i < RANDOM_MAPS; i++)
+  {
+    map.SensorWidth   = ISP_STATWINDOW_MIN + (Random() % 5000U);
+    map.SensorHeight  = ISP_STATWINDOW_MIN + (Random() % 4000U);
+    map.Decimation    = 1U << (Random() % 4U);
+    map.CropWidth     = 1U + (Random() % ((map.SensorWidth + map.Decimation - 1U) / map.Decimation));
+    map.CropHeight    = 1U + (Random() % ((map.SensorHeight + map.Decimation - 1U) / map.Decimation));
+    map.CropX         = Random() % (((map.SensorWidth + map.Decimation - 1U) / map.Decimation) - map.CropWidth + 1U);
+    map.CropY         = Random() % (((map.SensorHeight + map.Decimation - 1U) / map.Decimation) - map.CropHeight + 1U);
+    map.DisplayWidth  = 1U + (Random() % 1024U);
+    map.DisplayHeight = 1U + (Random() % 600U);
+    map.DisplayX      = Random() % 256U;
+    map.DisplayY      = Random() % 256U;
+
+    for (t = 0; t < RANDOM_TAPS; t++)
+    {
+      /* A few taps just out of the window */
+      x = map.DisplayX + (Random() % (map.DisplayWidth + 2U)) - 1U;
+      y = map.DisplayY + (Random() % (map.DisplayHeight + 2U)) - 1U;
+      w = 1U + (Random() % 512U);
+      h = 1U + (Random() % 512U);
+
+      status = TouchMeter_ComputeArea(&map, x, y, w, h, &area);
+      if ((x < map.DisplayX) || (x >= (map.DisplayX + map.DisplayWidth)) ||
+          (y < map.DisplayY) || (y >= (map.DisplayY + map.DisplayHeight)))
+      {
+        failures += (status == HAL_ERROR) ? 0U : 1U;
+        continue;
+      }
+
+      (void)TouchMeter_MapPoint(&map, x, y, &sx, &sy);
+      TouchMeter_AreaToDisplay(&map, &area, &rect);
+      if ((status != HAL_OK) ||
+          (IsSensorPos(x, sx, map.DisplayX, map.DisplayWidth, map.CropX, map.CropWidth, map.Decimation,
+                       map.SensorWidth) == 0U) ||
+          (IsSensorPos(y, sy, map.DisplayY, map.DisplayHeight, map.CropY, map.CropHeight, map.Decimation,
+                       map.SensorHeight) == 0U) ||
+          (IsAreaPos(area.X0, area.XSize, w, sx, map.CropWidth * map.Decimation, map.DisplayWidth,
+                     map.SensorWidth) == 0U) ||
+          (IsAreaPos(area.Y0, area.YSize, h, sy, map.CropHeight * map.Decimation, map.DisplayHeight,
+                     map.SensorHeight) == 0U) ||
+          (rect.X < map.DisplayX) || ((rect.X + rect.Width) > (map.DisplayX + map.DisplayWidth)) ||
+          (rect.Y < map.DisplayY) || ((rect.Y + rect.Height) > (map.DisplayY + map.DisplayHeight)))
+      {
+        failures++;
+      }
+    }
+  }
+
+  (void)printf("  %lu maps, %lu taps: %lu wrong\n", (unsigned long)RANDOM_MAPS,
+               (unsigned long)(RANDOM_MAPS * RANDOM_TAPS), (unsigned long)failures);
+  CHECK_EQ(failures, 0U);
+}
+
+static void TestTap(void)
+{
+  TouchMeter_ConfTypeDef conf = { 0, 96, 96, 20 };
+  TouchMeter_HandleTypeDef meter;
+  ISP_StatAreaTypeDef area;
+
+  CHECK_EQ(TouchMeter_Init(&meter, &hIsp, &conf, &MapPreview), HAL_OK);
+  HostTick = 100;
+
+  /* Tap: the area of the spot applied, the convergence restarted, the spot shown around the tap */
+  Panel.TouchDetected = 1;
+  Panel.TouchX = 600;
+  Panel.TouchY = 120;
+  CHECK_EQ(TouchMeter_Process(&meter), 1U);
+  CHECK_EQ(TouchMeter_ComputeArea(&MapPreview, 600, 120, 96, 96, &area), HAL_OK);
+  CHECK_EQ(memcmp(&IspArea, &area, sizeof(area)), 0);
+  CHECK_EQ(IspSetCount, 1U);
+  CHECK_EQ(IspRestartCount, 1U);
+  CHECK((meter.Spot.X <= 600U) && ((meter.Spot.X + meter.Spot.Width) >= 600U));
+  CHECK((meter.Spot.Y <= 120U) && ((meter.Spot.Y + meter.Spot.Height) >= 120U));
+  CHECK((meter.Spot.Width >= 95U) && (meter.Spot.Width <= 97U));
+
+  /* Held down, then polled too early: metered once */
+  HostTick += 20;
+  CHECK_EQ(TouchMeter_Process(&meter), 0U);
+  Panel.TouchDetected = 0;
+  HostTick += 5;
+  CHECK_EQ(TouchMeter_Process(&meter), 0U);
+  CHECK_EQ(meter.Touched, 1U);
+  HostTick += 20;
+  CHECK_EQ(TouchMeter_Process(&meter), 0U);
+  CHECK_EQ(IspSetCount, 1U);
+
+  /* Area refused by the ISP */
+  IspStatus = ISP_ERR_EINVAL;
+  CHECK_EQ(TouchMeter_MeterAt(&meter, 100, 100), HAL_ERROR);
+  CHECK_EQ(meter.ErrorCount, 1U);
+  IspStatus = ISP_OK;
+
+  /* Tap out of the video window: nothing sent to the ISP */
+  meter.Map = MapWindow;
+  CHECK_EQ(TouchMeter_MeterAt(&meter, 10, 10), HAL_ERROR);
+  CHECK_EQ(IspSetCount, 2U);
+  CHECK_EQ(meter.TapCount, 1U);
+}
+
+/* ISP and touch panel, recorded -----------------------------------------*/
+ISP_StatusTypeDef ISP_SetStatArea(ISP_HandleTypeDef *hIsp, ISP_StatAreaTypeDef *pStatArea)
+{
+  (void)hIsp;
+  IspSetCount++;
+  IspArea = *pStatArea;
+  return IspStatus;
+}
+
+ISP_StatusTypeDef ISP_RestartConvergence(ISP_HandleTypeDef *hIsp)
+{
+  (void)hIsp;
+  IspRestartCount++;
+  return ISP_OK;
+}
+
+int32_t BSP_TS_GetState(uint32_t Instance, TS_State_t *TS_State)
+{
+  (void)Instance;
+  *TS_State = Panel;
+  return BSP_ERROR_NONE;
+}
+
+int main(void)
+{
+  HostHal_Reset();
+
+  TestInvalid();
+  TestWindowEdges();
+  TestDecimation();
+  TestClamp();
+  TestRandom();
+  TestTap();
+
+  return HostTest_Report("touch_meter");
+}
@@ -0,0 +1,379 @@
+/**
+  ******************************************************************************
+  * @file    iq_profile_tool.c
+  * @brief   Host tool for the IQ profile images of FSBL/Src/iq_profile.c.
+  *
+  *          Usage:
+  *          - iq_profile_tool list <image>
+  *          - iq_profile_tool check <image>
+  *          - iq_profile_tool pack <image> <sensor>:<mode>[:<revision>]=<param.bin> ...
+  *          - iq_profile_tool unpack <image> <directory>
+  *          - iq_profile_tool default <param.bin>
+  *
+  *          <mode> is the driver resolution id (OV5647_R1920_1080 is 7). A
+  *          param.bin file is one ISP_IQParamTypeDef; "default" writes the
+  *          compiled-in parameters of the firmware as a starting point.
+  *
+  *          The payloads are used in place by the firmware, so the tool must
+  *          be built with the firmware headers and the same structure layout,
+  *          short enums included (iq_profile.h checks the size, the image
+  *          records it and the firmware rejects a mismatch). Build, from the
+  *          repository root: make -C Utilities/IQProfileTool
+  *
+  *          The image is written in the NOR at IQ_PROFILE_NOR_OFFSET with
+  *          STM32CubeProgrammer, or by the firmware with IQProfile_Program().
+  ******************************************************************************
+  * @attention
+  *
+  * Copyright (c) 2024 STMicroelectronics.
+  * All rights reserved.
+  *
+  * This software is licensed under terms that can be found in the LICENSE file
+  * in the root directory of this software component.
+  * If no LICENSE file comes with this software, it is provided AS-IS.
+  *
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include "iq_profile.h"
+#include "imx335_E27_isp_param_conf.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Private macros ------------------------------------------------------------*/
+#define ALIGN_UP(x)   (((x) + (IQ_PROFILE_ALIGN - 1U)) & ~(IQ_PROFILE_ALIGN - 1U))
+
+/* The host compiler must lay the payload out as the firmware does */
+_Static_assert(sizeof(IQProfile_HeaderTypeDef) == 24U, "IQ profile header layout");
+_Static_assert(sizeof(IQProfile_EntryTypeDef) == 36U, "IQ profile entry layout");
+
+/* Private function prototypes -----------------------------------------------*/
+static uint8_t *ReadFile(const char *pName, uint32_t *pSize);
+static int WriteFile(const char *pName, const void *pData, uint32_t Size);
+static uint8_t *LoadImage(const char *pName, uint32_t *pSize);
+static int CmdList(int argc, char **argv);
+static int CmdCheck(int argc, char **argv);
+static int CmdPack(int argc, char **argv);
+static int CmdUnpack(int argc, char **argv);
+static int CmdDefault(int argc, char **argv);
+static int Usage(void);
+
+/* Functions -----------------------------------------------------------------*/
+int main(int argc, char **argv)
+{
+  if (argc < 3)
+  {
+    return Usage();
+  }
+
+  if (strcmp(argv[1], "list") == 0)
+  {
+    return CmdList(argc, argv);
+  }
+  if (strcmp(argv[1], "check") == 0)
+  {
+    return CmdCheck(argc, argv);
+  }
+  if (strcmp(argv[1], "pack") == 0)
+  {
+    return CmdPack(argc, argv);
+  }
+  if (strcmp(argv[1], "unpack") == 0)
+  {
+    return CmdUnpack(argc, argv);
+  }
+  if (strcmp(argv[1], "default") == 0)
+  {
+    return CmdDefault(argc, argv);
+  }
+
+  return Usage();
+}
+
+/**
+  * @brief  Print the image directory
+  */
+static int CmdList(int argc, char **argv)
+{
+  const IQProfile_HeaderTypeDef *header;
+  const IQProfile_EntryTypeDef *entry;
+  uint32_t size;
+  uint8_t *image;
+  uint32_t i;
+
+  if ((argc != 3) || ((image = LoadImage(argv[2], &size)) == NULL))
+  {
+    return EXIT_FAILURE;
+  }
+
+  header = (const IQProfile_HeaderTypeDef *)image;
+  entry = (const IQProfile_EntryTypeDef *)&header[1];
+  printf("version %u, %u profiles, %u bytes, parameters %u bytes\n", header->Version, header->NbEntries,
+         header->TotalSize, header->ParamSize);
+  for (i = 0; i < header->NbEntries; i++)
+  {
+    printf("  %-16s mode %-3u revision %-5u offset 0x%05x crc 0x%08x\n", entry[i].Sensor, entry[i].Mode,
+           entry[i].Revision, entry[i].Offset, entry[i].Crc);
+  }
+
+  free(image);
+  return EXIT_SUCCESS;
+}
+
+/**
+  * @brief  Check the image as the firmware does, payloads included
+  */
+static int CmdCheck(int argc, char **argv)
+{
+  uint32_t size;
+  uint8_t *image;
+
+  if ((argc != 3) || ((image = LoadImage(argv[2], &size)) == NULL))
+  {
+    return EXIT_FAILURE;
+  }
+
+  printf("%s: OK\n", argv[2]);
+  free(image);
+  return EXIT_SUCCESS;
+}
+
+/**
+  * @brief  Build an image from parameter files
+  */
+static int CmdPack(int argc, char **argv)
+{
+  IQProfile_HeaderTypeDef *header;
+  IQProfile_EntryTypeDef *entry;
+  uint32_t nbEntries = (uint32_t)argc - 3U;
+  uint32_t offset;
+  uint32_t size;
+  uint8_t *image;
+  uint8_t *param;
+  char *spec;
+  char *file;
+  char *field;
+  uint32_t i;
+  uint32_t j;
+
+  if ((argc < 4) || (nbEntries > IQ_PROFILE_MAX_ENTRIES))
+  {
+    return Usage();
+  }
+
+  offset = ALIGN_UP((uint32_t)(sizeof(IQProfile_HeaderTypeDef) + (nbEntries * sizeof(IQProfile_EntryTypeDef))));
+  size = offset + (nbEntries * ALIGN_UP((uint32_t)sizeof(ISP_IQParamTypeDef)));
+  image = calloc(1, size);
+  if (image == NULL)
+  {
+    return EXIT_FAILURE;
+  }
+  header = (IQProfile_HeaderTypeDef *)image;
+  entry = (IQProfile_EntryTypeDef *)&header[1];
+
+  for (i = 0; i < nbEntries; i++)
+  {
+    /* <sensor>:<mode>[:<revision>]=<param.bin> */
+    spec = argv[3U + i];
+    file = strchr(spec, '=');
+    if ((file == NULL) || (strchr(spec, ':') == NULL))
+    {
+      fprintf(stderr, "%s: expected <sensor>:<mode>[:<revision>]=<param.bin>\n", spec);
+      free(image);
+      return EXIT_FAILURE;
+    }
+    *file++ = '\0';
+    field = strchr(spec, ':');
+    *field++ = '\0';
+    if ((spec[0] == '\0') || (strlen(spec) >= IQ_PROFILE_SENSOR_LENGTH))
+    {
+      fprintf(stderr, "%s: sensor name empty or longer than %u characters\n", spec, IQ_PROFILE_SENSOR_LENGTH - 1U);
+      free(image);
+      return EXIT_FAILURE;
+    }
+    strncpy(entry[i].Sensor, spec, IQ_PROFILE_SENSOR_LENGTH);
+    entry[i].Mode = (uint32_t)strtoul(field, &field, 0);
+    entry[i].Revision = (*field == ':') ? (uint32_t)strtoul(&field[1], NULL, 0) : 0U;
+    for (j = 0; j < i; j++)
+    {
+      if ((entry[j].Mode == entry[i].Mode) && (strcmp(entry[j].Sensor, entry[i].Sensor) == 0))
+      {
+        fprintf(stderr, "%s mode %u: given twice\n", entry[i].Sensor, entry[i].Mode);
+        free(image);
+        return EXIT_FAILURE;
+      }
+    }
+
+    param = ReadFile(file, &entry[i].Size);
+    if ((param == NULL) || (entry[i].Size != sizeof(ISP_IQParamTypeDef)))
+    {
+      fprintf(stderr, "%s: expected %u bytes of ISP_IQParamTypeDef\n", file, (uint32_t)sizeof(ISP_IQParamTypeDef));
+      free(param);
+      free(image);
+      return EXIT_FAILURE;
+    }
+    memcpy(&image[offset], param, entry[i].Size);
+    free(param);
+    entry[i].Offset = offset;
+    entry[i].Crc = IQProfile_Crc32(0, &image[offset], entry[i].Size);
+    offset += ALIGN_UP(entry[i].Size);
+  }
+
+  header->Magic     = IQ_PROFILE_MAGIC;
+  header->Version   = IQ_PROFILE_VERSION;
+  header->NbEntries = (uint16_t)nbEntries;
+  header->ParamSize = (uint32_t)sizeof(ISP_IQParamTypeDef);
+  header->TotalSize = size;
+  header->DirCrc    = IQProfile_Crc32(0, entry, nbEntries * (uint32_t)sizeof(IQProfile_EntryTypeDef));
+  header->HeaderCrc = IQProfile_Crc32(0, header, (uint32_t)offsetof(IQProfile_HeaderTypeDef, HeaderCrc));
+
+  if ((IQProfile_Check(image, size) != HAL_OK) || (WriteFile(argv[2], image, size) != 0))
+  {
+    free(image);
+    return EXIT_FAILURE;
+  }
+
+  printf("%s: %u profiles, %u bytes\n", argv[2], nbEntries, size);
+  free(image);
+  return EXIT_SUCCESS;
+}
+
+/**
+  * @brief  Extract each profile as <directory>/<sensor>_<mode>.bin
+  */
+static int CmdUnpack(int argc, char **argv)
+{
+  const IQProfile_HeaderTypeDef *header;
+  const IQProfile_EntryTypeDef *entry;
+  char name[4096];
+  uint32_t size;
+  uint8_t *image;
+  uint32_t i;
+
+  if ((argc != 4) || ((image = LoadImage(argv[2], &size)) == NULL))
+  {
+    return EXIT_FAILURE;
+  }
+
+  header = (const IQProfile_HeaderTypeDef *)image;
+  entry = (const IQProfile_EntryTypeDef *)&header[1];
+  for (i = 0; i < header->NbEntries; i++)
+  {
+    (void)snprintf(name, sizeof(name), "%s/%s_%u.bin", argv[3], entry[i].Sensor, entry[i].Mode);
+    if (WriteFile(name, &image[entry[i].Offset], entry[i].Size) != 0)
+    {
+      free(image);
+      return EXIT_FAILURE;
+    }
+    printf("%s (revision %u)\n", name, entry[i].Revision);
+  }
+
+  free(image);
+  return EXIT_SUCCESS;
+}
+
+/**
+  * @brief  Write the compiled-in parameters of the firmware
+  */
+static int CmdDefault(int argc, char **argv)
+{
+  if (argc != 3)
+  {
+    return Usage();
+  }
+
+  return (WriteFile(argv[2], ISP_IQParamCacheInit[0], (uint32_t)sizeof(ISP_IQParamTypeDef)) == 0) ? EXIT_SUCCESS
+                                                                                                  : EXIT_FAILURE;
+}
+
+/**
+  * @brief  Read and check an image
+  * @retval Image, to be freed, NULL on error
+  */
+static uint8_t *LoadImage(const char *pName, uint32_t *pSize)
+{
+  uint8_t *image = ReadFile(pName, pSize);
+
+  if ((image != NULL) && (IQProfile_Check(image, *pSize) != HAL_OK))
+  {
+    fprintf(stderr, "%s: not a valid IQ profile image for this firmware\n", pName);
+    free(image);
+    image = NULL;
+  }
+
+  return image;
+}
+
+/**
+  * @brief  Read a whole file
+  * @retval Buffer, to be freed, NULL on error
+  */
+static uint8_t *ReadFile(const char *pName, uint32_t *pSize)
+{
+  uint8_t *data = NULL;
+  FILE *f = fopen(pName, "rb");
+  long size;
+
+  if (f == NULL)
+  {
+    perror(pName);
+    return NULL;
+  }
+
+  if ((fseek(f, 0, SEEK_END) == 0) && ((size = ftell(f)) >= 0) && (fseek(f, 0, SEEK_SET) == 0))
+  {
+    data = malloc((size_t)size + 1U);
+    if ((data != NULL) && (fread(data, 1, (size_t)size, f) != (size_t)size))
+    {
+      free(data);
+      data = NULL;
+    }
+    *pSize = (uint32_t)size;
+  }
+  if (data == NULL)
+  {
+    fprintf(stderr, "%s: read error\n", pName);
+  }
+
+  fclose(f);
+  return data;
+}
+
+/**
+  * @brief  Write a whole file
+  * @retval 0 on success
+  */
+static int WriteFile(const char *pName, const void *pData, uint32_t Size)
+{
+  FILE *f = fopen(pName, "wb");
+  int ret = 0;
+
+  if (f == NULL)
+  {
+    perror(pName);
+    return -1;
+  }
+  if (fwrite(pData, 1, Size, f) != Size)
+  {
+    fprintf(stderr, "%s: write error\n", pName);
+    ret = -1;
+  }
+  if (fclose(f) != 0)
+  {
+    ret = -1;
+  }
+
+  return ret;
+}
+
+static int Usage(void)
+{
+  fprintf(stderr, "usage: iq_profile_tool list|check <image>\n"
+                  "       iq_profile_tool pack <image> <sensor>:<mode>[:<revision>]=<param.bin> ...\n"
+                  "       iq_profile_tool unpack <image> <directory>\n"
+                  "       iq_profile_tool default <param.bin>\n");
+  return EXIT_FAILURE;
+}